@@ -31,6 +31,14 @@
 #define ASPECT_RATIO_FULLSCREEN (3) /* Resize camera image to NN input size and display a maximized image. See Doc/Build-Options.md#aspect-ratio-mode */
 #define ASPECT_RATIO_MODE ASPECT_RATIO_FULLSCREEN
 
+/* UVC screen, see Doc/Build-Options.md#uvc-screen-format */
+#define UVC_SCREEN_YUV422 (1) /* Uncompressed YUY2 frames */
+#define UVC_SCREEN_MJPEG  (2) /* Frames encoded by the JPEG codec, quality following UVC_MJPEG_BITRATE */
+#define UVC_SCREEN_FORMAT UVC_SCREEN_YUV422
+#define UVC_MJPEG_BITRATE (4000000)
+#define UVC_MJPEG_QUALITY (75)
+#define UVC_YUV_CACHE     (0) /* YUV422: convert only the changed rows, at the cost of twice the screen size in RAM */
+
 /* Model Related Info */
 #define POSTPROCESS_TYPE
 
@@ -119,6 +119,17 @@ static int lcd_fg_buffer_rd_idx;
 /* screen buffer */
 __attribute__ ((aligned (32)))
 static uint8_t screen_buffer[LCD_FG_WIDTH * LCD_FG_HEIGHT * 2];
+#if !defined(SCR_LIB_USE_SPI) && UVC_SCREEN_FORMAT == UVC_SCREEN_MJPEG
+/* JPEG codec input, then the compressed frames: one sent over USB while the next one is encoded */
+__attribute__ ((aligned (32)))
+static uint8_t mcu_buffer[LCD_FG_WIDTH * LCD_FG_HEIGHT * 2];
+__attribute__ ((aligned (32)))
+static uint8_t jpeg_buffer[2][SCRL_MJPEG_BUFFER_SIZE(LCD_FG_WIDTH, LCD_FG_HEIGHT)];
+#elif !defined(SCR_LIB_USE_SPI) && UVC_YUV_CACHE
+/* YUV422 frames sent over USB and the previous RGB565 frame their rows are compared to */
+__attribute__ ((aligned (32)))
+static uint8_t yuv_cache[SCRL_YUV_CACHE_SIZE(LCD_FG_WIDTH, LCD_FG_HEIGHT)];
+#endif
 
 static void SystemClock_Config(void);
 static void NPURam_enable(void);
@@ -476,16 +487,26 @@ static void Display_init(void)
     .size = {LCD_FG_WIDTH, LCD_FG_HEIGHT},
 #ifdef SCR_LIB_USE_SPI
     .format = SCRL_RGB565,
+#elif UVC_SCREEN_FORMAT == UVC_SCREEN_MJPEG
+    .format = SCRL_MJPEG,
 #else
     .format = SCRL_YUV422, /* Use SCRL_RGB565 if host support this format to reduce cpu load */
 #endif
     .address = screen_buffer,
     .fps = CAMERA_FPS,
   };
+#if !defined(SCR_LIB_USE_SPI) && UVC_SCREEN_FORMAT == UVC_SCREEN_MJPEG
+  SCRL_MjpegConfig mjpeg_config = {
+    .mcu_buffer = mcu_buffer,
+    .jpeg_buffer = {jpeg_buffer[0], jpeg_buffer[1]},
+    .bitrate = UVC_MJPEG_BITRATE,
+    .quality = UVC_MJPEG_QUALITY,
+  };
+#endif
   int ret;
 
-  /* Initialize the LCD to black */
-#ifdef SCR_LIB_USE_SPI
+  /* Initialize the LCD to black, the MJPEG screen is composed and encoded from RGB565 */
+#if defined(SCR_LIB_USE_SPI) || UVC_SCREEN_FORMAT == UVC_SCREEN_MJPEG
   memset(screen_buffer, 0, sizeof(screen_buffer));
   SCB_CleanDCache_by_Addr(screen_buffer, sizeof(screen_buffer));
 #else
@@ -499,6 +520,13 @@ static void Display_init(void)
 
   ret = SCRL_Init((SCRL_LayerConfig *[2]){&layers_config[0], &layers_config[1]}, &screen_config);
   assert(ret == 0);
+#if !defined(SCR_LIB_USE_SPI) && UVC_SCREEN_FORMAT == UVC_SCREEN_MJPEG
+  ret = SCRL_SetMjpegConfig(&mjpeg_config);
+  assert(ret == 0);
+#elif !defined(SCR_LIB_USE_SPI) && UVC_YUV_CACHE
+  ret = SCRL_SetYuvCache(yuv_cache);
+  assert(ret == 0);
+#endif
 
   UTIL_LCD_SetLayer(SCRL_LAYER_1);
   UTIL_LCD_Clear(UTIL_LCD_COLOR_TRANSPARENT);
@@ -18,6 +18,8 @@
 #ifndef APP_CAMERAPIPELINE
 #define APP_CAMERAPIPELINE
 
+#include "roi_tracker.h"
+
 #define SCREEN_HEIGHT (480)
 #define SCREEN_WIDTH  (800)
 
@@ -27,6 +29,12 @@ void CameraPipeline_Start(void);
 void CameraPipeline_DisplayPipe_Start(uint8_t *display_pipe_dst, uint32_t cam_mode);
 void CameraPipeline_DisplayPipe_Stop(void);
 void CameraPipeline_NNPipe_Start(uint8_t *nn_pipe_dst, uint32_t cam_mode);
+void CameraPipeline_NNPipe_DoubleBufferStart(uint8_t *nn_pipe_dst0, uint8_t *nn_pipe_dst1, uint32_t cam_mode);
+uint8_t *CameraPipeline_NNPipe_GetLastFrame(uint32_t *seq);
+uint8_t *CameraPipeline_NNPipe_GetLastFrameRoi(Roi_t *roi, uint32_t *seq);
+uint32_t CameraPipeline_NNPipe_GetFrameSeq(const uint8_t *frame);
+void CameraPipeline_NNPipe_SetRoi(const Roi_t *roi);
+float32_t CameraPipeline_NNPipe_GetMinRoiSize(void);
 void CameraPipeline_IspUpdate(void);
 
 #endif
\ No newline at end of file
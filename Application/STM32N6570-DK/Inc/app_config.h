@@ -45,11 +45,58 @@
 /* I/O configuration */
 #define AI_SPE_MOVENET_POSTPROC_HEATMAP_WIDTH        (NN_WIDTH/4)
 #define AI_SPE_MOVENET_POSTPROC_HEATMAP_HEIGHT       (NN_HEIGHT/4)
+#define AI_SPE_MOVENET_POSTPROC_REFINE               (AI_SPE_MOVENET_PP_REFINE_QUADRATIC) /* Sub-pixel keypoints, less jitter for gesture speeds */
 
 /* Post processing values */
 #define AI_POSE_PP_CONF_THRESHOLD           (0.5f)
 #define AI_POSE_PP_POSE_KEYPOINTS_NB        (13) /* Movenet: 13 or 17 keypoints ; YOLOv8 pose: 17 keypoints */
 
+/* Keypoints temporal filter (One-Euro), coordinates normalized to [0, 1] */
+#define KEYPOINT_FILTER_MIN_CUTOFF          (1.0f)  /* Hz, smoothing at rest */
+#define KEYPOINT_FILTER_BETA                (10.0f) /* Cutoff increase per unit/s of keypoint speed */
+#define KEYPOINT_FILTER_D_CUTOFF            (1.0f)  /* Hz, speed estimation smoothing */
+
+/* NN pipe zoom into the region of the keypoints of the previous frames, see Inc/roi_tracker.h. Keypoints are mapped
+ * back to full frame coordinates before the filter, the gesture detection and the display */
+#define NN_ROI_TRACKING                     (1)
+#define NN_ROI_MARGIN                       (0.25f) /* Added on each side, fraction of the keypoints bounding box */
+#define NN_ROI_MIN_SIZE                     (0.25f) /* Highest zoom x4, also limited by the sensor resolution */
+#define NN_ROI_SHRINK_RATE                  (0.2f)  /* Zoom in over several frames, zoom out at once */
+#define NN_ROI_MIN_KEYPOINTS                (4)     /* Fewer confident keypoints is a missed detection */
+#define NN_ROI_MAX_MISSED                   (3)     /* Missed detections before going back to the full frame */
+#define NN_ROI_DEAD_BAND                    (16)    /* Sensor pixels an edge must move by to reprogram the zoom */
+
+/* Copy of the frames into the NN input, see Inc/crop_img.h: IMG_CROP_MEMCPY, IMG_CROP_MVE or IMG_CROP_DMA2D
+ * (in the background, by the CPU with MVE while the DMA2D draws the overlay) */
+#define NN_CROP_BACKEND                     IMG_CROP_DMA2D
+
+/* Two NN input buffers, the next frame being copied into one while the NPU reads the other. Requires a model generated
+ * with --no-inputs-allocation: the default model allocates its input, the next frame then waits for the inference end */
+#define NN_INPUT_DOUBLE_BUFFER              (0)
+
+/* Fewer inferences while nothing moves, see Inc/inference_rate.h. The overlay follows the keypoints extrapolated by
+ * the keypoint filter over the frames skipped */
+#define NN_ADAPTIVE_RATE                    (1)
+#define NN_IDLE_PERIOD                      (4)     /* Camera frames per inference while static */
+#define NN_IDLE_HOLD_FRAMES                 (15)    /* Static frames still inferred before the rate drops */
+#define NN_MOTION_PIXEL_THRESHOLD           (24)    /* Luma difference of a changed thumbnail sample */
+#define NN_MOTION_SAMPLES                   (4)     /* Changed samples out of 24x24 of a moving scene */
+#define NN_MOTION_KEYPOINT_SPEED            (0.1f)  /* Keypoint speed of a moving person, unit/s */
+
+/* Per-stage latency report on the ST-LINK virtual COM port (USART1, 115200 8N1), 0 to disable */
+#define LATENCY_REPORT_PERIOD_MS            (2000)
+
+/* NPU cache profiling per epoch block and warming of the weights of the cold epoch blobs, see Inc/weight_prefetch.h:
+ * WEIGHT_PREFETCH_OFF, WEIGHT_PREFETCH_PROFILE or WEIGHT_PREFETCH_AUTO. Reported with the latency statistics */
+#define NN_WEIGHT_PREFETCH_MODE             WEIGHT_PREFETCH_AUTO
+/* Weights in the memory-mapped NOR: network_data.xSPI2.bin and where it is flashed */
+#define NN_WEIGHTS_ADDR                     (0x70380000UL)
+#define NN_WEIGHTS_SIZE                     (3065857)
+
+/* Per epoch block NPU performance counters, see Inc/npu_profiler.h: inferences profiled per counter group, 0 to disable.
+ * Sent once as CSV on the latency report port, requires NN_WEIGHT_PREFETCH_MODE set to WEIGHT_PREFETCH_OFF */
+#define NPU_PROFILER_RUNS                   (0)
+
 /* Display */
 #define WELCOME_MSG_1         "st_movenet_lightning_heatmaps_192_int8_pc.tflite"
 #define WELCOME_MSG_2         "STM EDGE AI contest entry Antonio Mendoza"
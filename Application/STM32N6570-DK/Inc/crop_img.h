@@ -19,9 +19,32 @@
 #define CROP_IMG
 #include "arm_math.h"
 
+/* Copy back-ends, all bit-exact */
+#define IMG_CROP_MEMCPY   (0) /* Reference: one memcpy() per line */
+#define IMG_CROP_MVE      (1) /* Helium 16 bytes loads and stores, memcpy() when built without MVE (host) */
+#define IMG_CROP_DMA2D    (2) /* DMA2D memory to memory transfer with line offsets, asynchronous */
+
+/* End of an asynchronous copy, 'error' non-zero when the destination was not written */
+typedef void (*img_crop_done_cb_t)(void *arg, int error);
 
 void img_crop(uint8_t *src_image, uint8_t *dst_img, const uint32_t src_width,
               const uint16_t dst_width, const uint16_t dst_height,
               const uint16_t bpp);
+void img_crop_mve(const uint8_t *src_image, uint8_t *dst_img, const uint32_t src_stride,
+                  const uint16_t dst_width, const uint16_t dst_height,
+                  const uint16_t bpp);
+
+/* DMA2D back-end (crop_img_dma2d.c), img_crop_dma2d_irq_handler() is called from DMA2D_IRQHandler() while a copy is
+ * in flight (interrupt enabled by OverlayDraw_Dma2d_Init()). The DMA2D is shared with the overlay drawing: a copy is
+ * only started while no flush is in progress, and a flush only once the copy is done */
+/* Starts the copy, 'done_cb' being called from the DMA2D interrupt once the destination is written, or with 'error'
+ * set on a transfer error: the caller then copies by CPU, out of the interrupt.
+ * Returns 0 if started, -1 if the layout cannot be transferred by the DMA2D (the caller then copies by CPU) */
+int img_crop_dma2d_start(const uint8_t *src_image, uint8_t *dst_img, const uint32_t src_stride,
+                         const uint16_t dst_width, const uint16_t dst_height, const uint16_t bpp,
+                         img_crop_done_cb_t done_cb, void *done_arg);
+int img_crop_dma2d_busy(void);
+void img_crop_dma2d_wait(void);
+void img_crop_dma2d_irq_handler(void);
 
 #endif
\ No newline at end of file
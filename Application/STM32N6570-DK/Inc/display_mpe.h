@@ -27,5 +27,7 @@ void Display_mpe_InitFunctions(int clamp_point_init(int *x, int *y),
                                void convert_point_init(float32_t xi, float32_t yi, int *xo, int *yo),
                                void Display_binding_line_init(int x0, int y0, int x1, int y1, uint32_t color));
 void Display_mpe_Detection(mpe_pp_outBuffer_t *detect);
+/* Bounding box (x1, y1 exclusive) of the last Display_mpe_Detection() drawing, box, bindings and keypoints */
+int Display_mpe_GetDrawnArea(int *x0, int *y0, int *x1, int *y1);
 
 #endif /*__DISPLAY_MPE_H */
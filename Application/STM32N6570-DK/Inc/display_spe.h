@@ -27,5 +27,7 @@ void Display_spe_InitFunctions(int clamp_point_init(int *x, int *y),
                                void convert_point_init(float32_t xi, float32_t yi, int *xo, int *yo),
                                void Display_binding_line_init(int x0, int y0, int x1, int y1, uint32_t color));
 void Display_spe_Detection(spe_pp_outBuffer_t *detect);
+/* Bounding box (x1, y1 exclusive) of the last Display_spe_Detection() drawing, returns 0 if nothing was drawn */
+int Display_spe_GetDrawnArea(int *x0, int *y0, int *x1, int *y1);
 
 #endif /*__DISPLAY_SPE_H */
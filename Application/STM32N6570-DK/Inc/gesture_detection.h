@@ -5,6 +5,7 @@
 #include <stdint.h>
 #include "app_config.h"
 #include "display_spe.h"
+#include "keypoint_history.h"
 
 // Keypoint indices for MoveNet
 #define KEYPOINT_NOSE           0
@@ -22,7 +23,6 @@
 #define KEYPOINT_RIGHT_ANKLE    12
 
 // Gesture detection parameters
-#define GESTURE_HISTORY_SIZE    40
 #define MIN_CONFIDENCE          0.45f
 #define SWIPE_MIN_DISTANCE      0.5f   // Minimum distance for swipe (normalized)
 #define SWIPE_MIN_SPEED         0.5f  // Minimum speed for swipe
@@ -40,16 +40,58 @@ typedef enum {
     GESTURE_SWORD_SIDE_SLASH
 } GestureType_t;
 
+/*
+ * Gesture rule engine: each gesture is a list of conditions on windowed
+ * features of the keypoint history. Features shared by several gestures are
+ * computed once per frame.
+ */
+typedef enum {
+    GESTURE_FEATURE_CONFIDENCE = 0,  // Confidence of kp_a in the latest frame
+    GESTURE_FEATURE_DX,              // x displacement of kp_a over the window
+    GESTURE_FEATURE_DY,              // y displacement of kp_a over the window
+    GESTURE_FEATURE_SPEED,           // Speed of kp_a over the window (per second)
+    GESTURE_FEATURE_DISTANCE,        // Distance between kp_a and kp_b in the latest frame
+    GESTURE_FEATURE_HEIGHT_ABOVE     // How much kp_a is above kp_b, window frames ago (y of kp_b - y of kp_a)
+} GestureFeatureType_t;
+
+typedef enum {
+    GESTURE_CMP_GT = 0,              // feature > threshold
+    GESTURE_CMP_LT,                  // feature < threshold
+    GESTURE_CMP_ABS_GT               // |feature| > threshold
+} GestureCmp_t;
+
+typedef struct {
+    uint8_t type;                    // GestureFeatureType_t
+    uint8_t kp_a;
+    uint8_t kp_b;
+    uint8_t window;                  // Frames back
+} GestureFeature_t;
+
+typedef struct {
+    GestureFeature_t feature;
+    uint8_t cmp;                     // GestureCmp_t
+    float32_t threshold;
+} GestureCondition_t;
+
+#define GESTURE_MAX_CONDITIONS  6
+#define GESTURE_MAX_FEATURES    24
+#define GESTURE_MAX_SPECS       8
+
 typedef struct {
-    float32_t x;
-    float32_t y;
-    float32_t confidence;
-    uint32_t timestamp;
-} KeypointHistory_t;
+    GestureType_t gesture;
+    uint32_t cooldown_ms;            // Minimum time since the last detected gesture
+    uint8_t nb_conditions;
+    GestureCondition_t conditions[GESTURE_MAX_CONDITIONS];
+} GestureSpec_t;
 
 typedef struct {
-    KeypointHistory_t history[AI_POSE_PP_POSE_KEYPOINTS_NB][GESTURE_HISTORY_SIZE];
-    uint8_t history_index;
+    KeypointHistory_t history;
+    // Rule engine: distinct features of all the specs, and which feature each condition reads
+    GestureFeature_t features[GESTURE_MAX_FEATURES];
+    float32_t feature_values[GESTURE_MAX_FEATURES];
+    uint8_t feature_valid[GESTURE_MAX_FEATURES];
+    uint8_t nb_features;
+    uint8_t condition_feature[GESTURE_MAX_SPECS][GESTURE_MAX_CONDITIONS];
     GestureType_t last_detected_gesture;
     uint32_t last_gesture_time;
     GestureType_t current_display_gesture;  // For visual feedback
@@ -61,6 +103,16 @@ void Gesture_Init(GestureDetector_t *detector);
 GestureType_t Gesture_Detect(GestureDetector_t *detector, spe_pp_outBuffer_t *keypoints);
 const char* Gesture_GetName(GestureType_t gesture);
 float32_t Gesture_CalculateDistance(float32_t x1, float32_t y1, float32_t x2, float32_t y2);
-float32_t Gesture_CalculateSpeed(KeypointHistory_t *history, uint8_t current_idx, uint8_t frames_back);
+// Speed of 'keypoint' between the latest frame and 'frames_back' frames before (per second)
+float32_t Gesture_CalculateSpeed(const GestureDetector_t *detector, uint32_t keypoint, uint32_t frames_back);
+// Speed of the fastest keypoint confident in both the latest frame and 'frames' frames before (per second)
+float32_t Gesture_MaxKeypointSpeed(const GestureDetector_t *detector, uint32_t frames);
+GestureType_t Gesture_GetCurrentDisplayGesture(GestureDetector_t *detector);
+void Gesture_GetKeypointDebugInfo(GestureDetector_t *detector, uint8_t keypoint_idx,
+                                  float32_t *current_x, float32_t *current_y,
+                                  float32_t *current_confidence, float32_t *current_speed);
+void Gesture_GetPastKeypointDebugInfo(GestureDetector_t *detector, uint8_t keypoint_idx,
+                                  float32_t *current_x, float32_t *current_y,
+                                  float32_t *current_confidence, float32_t *current_speed, uint8_t past_keypoint_offset);
 
 #endif /* GESTURE_DETECTION_H */
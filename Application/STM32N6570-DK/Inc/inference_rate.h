@@ -0,0 +1,60 @@
+/**
+ ******************************************************************************
+ * @file    inference_rate.h
+ * @brief   Inference rate following the motion: every camera frame is
+ *          inferred while the scene or the person moves, one in a few while
+ *          both are static
+ ******************************************************************************
+ * Scene motion is measured on a luma thumbnail of the NN pipe frames: the
+ * samples changed by more than a threshold since the last frame inferred. It
+ * only needs the frame itself, so a motion starting between two inferences is
+ * seen on its first frame, which is then inferred. A motion too slow to change
+ * enough samples from one frame to the next adds up over the frames skipped.
+ * Person motion is the speed of the fastest keypoint at the last inference.
+ ******************************************************************************
+ */
+
+#ifndef INFERENCE_RATE_H
+#define INFERENCE_RATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "app_config.h"
+
+// Luma thumbnail side, in samples
+#define INFERENCE_RATE_GRID     (24)
+
+typedef struct {
+    uint8_t idle_period;            // Camera frames per inference while static, 1 to infer them all
+    uint8_t hold_frames;            // Static frames still inferred before the rate drops
+    uint8_t pixel_threshold;        // Luma difference of a changed sample
+    uint16_t motion_samples;        // Changed samples of a moving scene
+    float32_t speed_threshold;      // Keypoint speed of a moving person (normalized coordinates per second)
+} InferenceRate_Params_t;
+
+typedef struct {
+    InferenceRate_Params_t params;
+    uint8_t thumbnail[INFERENCE_RATE_GRID * INFERENCE_RATE_GRID];  // Of the last frame inferred
+    uint8_t latest[INFERENCE_RATE_GRID * INFERENCE_RATE_GRID];     // Of the last frame measured
+    uint8_t has_thumbnail;
+    uint8_t static_frames;          // Consecutive static frames, saturated at hold_frames
+    uint8_t skipped;                // Frames skipped since the last inference
+    float32_t speed;
+    uint32_t frames;                // Frames decided on since the last report
+    uint32_t inferences;            // Of which inferred
+} InferenceRate_t;
+
+void InferenceRate_Init(InferenceRate_t *rate, const InferenceRate_Params_t *params);
+// Back to full rate, the next frame being compared to none
+void InferenceRate_Reset(InferenceRate_t *rate);
+// Samples of the frame changed since the last frame inferred, all of them for the first frame
+uint32_t InferenceRate_Motion(InferenceRate_t *rate, const uint8_t *frame, uint32_t pitch,
+                              uint16_t width, uint16_t height, uint16_t bpp);
+// Speed of the fastest confident keypoint of the last inference
+void InferenceRate_SetSpeed(InferenceRate_t *rate, float32_t speed);
+// Whether to infer the frame with 'motion' changed samples, the reference of the motion once inferred
+int InferenceRate_Decide(InferenceRate_t *rate, uint32_t motion);
+// Inferred and camera frames since the previous report, returns the length written
+int InferenceRate_Report(InferenceRate_t *rate, char *buffer, size_t size);
+
+#endif /* INFERENCE_RATE_H */
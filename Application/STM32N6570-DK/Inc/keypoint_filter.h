@@ -0,0 +1,84 @@
+/**
+ ******************************************************************************
+ * @file    keypoint_filter.h
+ * @brief   Temporal smoothing of the keypoints (One-Euro or constant velocity
+ *          Kalman filter), between post-processing and its consumers
+ ******************************************************************************
+ */
+
+#ifndef KEYPOINT_FILTER_H
+#define KEYPOINT_FILTER_H
+
+#include <stdint.h>
+#include "app_config.h"
+#include "spe_pp_output_if.h"
+
+/*
+ * Filter arithmetic: float32 by default, signed Q7.24 when
+ * KEYPOINT_FILTER_FIXED_POINT is defined. Keypoints are exchanged as float in
+ * both cases, only the filter state and its update use the selected format.
+ */
+#ifdef KEYPOINT_FILTER_FIXED_POINT
+typedef int32_t kpf_scalar_t;
+#define KPF_Q                 24
+#define KPF_FROM_FLOAT(f)     ((kpf_scalar_t) ((f) * (float32_t) (1 << KPF_Q)))
+#define KPF_TO_FLOAT(v)       ((float32_t) (v) * (1.0f / (float32_t) (1 << KPF_Q)))
+#define KPF_MUL(a, b)         ((kpf_scalar_t) (((int64_t) (a) * (int64_t) (b)) >> KPF_Q))
+#define KPF_DIV(a, b)         ((kpf_scalar_t) (((int64_t) (a) * (1LL << KPF_Q)) / (int64_t) (b)))
+#define KPF_FROM_MS(ms)       ((kpf_scalar_t) (((int64_t) (ms) << KPF_Q) / 1000))
+#else
+typedef float32_t kpf_scalar_t;
+#define KPF_FROM_FLOAT(f)     ((kpf_scalar_t) (f))
+#define KPF_TO_FLOAT(v)       ((float32_t) (v))
+#define KPF_MUL(a, b)         ((a) * (b))
+#define KPF_DIV(a, b)         ((a) / (b))
+#define KPF_FROM_MS(ms)       ((kpf_scalar_t) (ms) / 1000.0f)
+#endif
+#define KPF_ABS(a)            ((a) < 0 ? -(a) : (a))
+
+typedef enum {
+    KEYPOINT_FILTER_NONE = 0,
+    KEYPOINT_FILTER_ONE_EURO,       // Adaptive low-pass: smooth at rest, low lag when moving fast
+    KEYPOINT_FILTER_KALMAN          // Constant velocity model, also predicts over missed detections
+} KeypointFilterType_t;
+
+typedef struct {
+    float32_t min_cutoff;           // Cutoff frequency at rest (Hz)
+    float32_t beta;                 // Cutoff increase per unit of speed (normalized coordinates per second)
+    float32_t d_cutoff;             // Cutoff frequency of the speed estimation (Hz)
+} KeypointFilter_OneEuroParams_t;
+
+typedef struct {
+    float32_t process_noise;        // Acceleration spectral density (normalized coordinates^2 / s^3)
+    float32_t measurement_noise;    // Keypoint position variance (normalized coordinates^2)
+} KeypointFilter_KalmanParams_t;
+
+// State of one coordinate of one keypoint
+typedef struct {
+    kpf_scalar_t pos;               // Filtered position
+    kpf_scalar_t vel;               // Filtered speed
+    kpf_scalar_t p00, p01, p11;     // Kalman covariance (position, cross, velocity)
+} KeypointFilterAxis_t;
+
+typedef struct {
+    KeypointFilterType_t type;
+    kpf_scalar_t min_cutoff, beta, d_cutoff;
+    kpf_scalar_t cutoff_vel_limit;  // One-Euro speed above which the cutoff no longer increases
+    kpf_scalar_t process_noise, measurement_noise;
+    float32_t min_confidence;       // Keypoints below are not used as measurements
+    uint32_t last_timestamp;
+    uint8_t started;
+    uint8_t tracked[AI_POSE_PP_POSE_KEYPOINTS_NB];
+    uint8_t missed[AI_POSE_PP_POSE_KEYPOINTS_NB];
+    KeypointFilterAxis_t axis[AI_POSE_PP_POSE_KEYPOINTS_NB][2];
+} KeypointFilter_t;
+
+void KeypointFilter_InitOneEuro(KeypointFilter_t *filter, const KeypointFilter_OneEuroParams_t *params, float32_t min_confidence);
+void KeypointFilter_InitKalman(KeypointFilter_t *filter, const KeypointFilter_KalmanParams_t *params, float32_t min_confidence);
+void KeypointFilter_Reset(KeypointFilter_t *filter);
+// Filters the keypoints of a new frame in place
+void KeypointFilter_Apply(KeypointFilter_t *filter, spe_pp_outBuffer_t *keypoints, uint32_t timestamp_ms);
+// Moves in place the tracked keypoints to where their speed takes them at 'timestamp_ms', the state is not updated
+void KeypointFilter_Predict(const KeypointFilter_t *filter, spe_pp_outBuffer_t *keypoints, uint32_t timestamp_ms);
+
+#endif /* KEYPOINT_FILTER_H */
@@ -0,0 +1,75 @@
+/**
+ ******************************************************************************
+ * @file    keypoint_history.h
+ * @brief   Ring buffer of the last keypoint frames, structure-of-arrays layout
+ ******************************************************************************
+ */
+
+#ifndef KEYPOINT_HISTORY_H
+#define KEYPOINT_HISTORY_H
+
+#include <stdint.h>
+#include "app_config.h"
+#include "spe_pp_output_if.h"
+
+// Number of frames kept, must be a power of two
+#define KEYPOINT_HISTORY_SIZE   32
+#define KEYPOINT_HISTORY_MASK   (KEYPOINT_HISTORY_SIZE - 1)
+
+#if (KEYPOINT_HISTORY_SIZE & KEYPOINT_HISTORY_MASK) != 0
+#error "KEYPOINT_HISTORY_SIZE must be a power of two"
+#endif
+
+/*
+ * One plane per field, each frame row holding all keypoints contiguously so
+ * that queries over all keypoints are plain (auto-vectorizable) loops.
+ * The timestamp is shared by all the keypoints of a frame.
+ */
+typedef struct {
+    float32_t x[KEYPOINT_HISTORY_SIZE][AI_POSE_PP_POSE_KEYPOINTS_NB];
+    float32_t y[KEYPOINT_HISTORY_SIZE][AI_POSE_PP_POSE_KEYPOINTS_NB];
+    float32_t confidence[KEYPOINT_HISTORY_SIZE][AI_POSE_PP_POSE_KEYPOINTS_NB];
+    uint32_t timestamp[KEYPOINT_HISTORY_SIZE];
+    uint32_t head;   // Total number of frames pushed, latest frame is at slot head & MASK
+} KeypointHistory_t;
+
+void KeypointHistory_Init(KeypointHistory_t *history);
+void KeypointHistory_Push(KeypointHistory_t *history, const spe_pp_outBuffer_t *keypoints, uint32_t timestamp);
+
+// Slot of the frame 'frames_back' frames before the latest one
+static inline uint32_t KeypointHistory_Slot(const KeypointHistory_t *history, uint32_t frames_back)
+{
+    return (history->head - frames_back) & KEYPOINT_HISTORY_MASK;
+}
+
+// True if the frame 'frames_back' frames before the latest one is still stored
+static inline int KeypointHistory_Has(const KeypointHistory_t *history, uint32_t frames_back)
+{
+    return frames_back < KEYPOINT_HISTORY_SIZE && frames_back < history->head;
+}
+
+static inline float32_t KeypointHistory_X(const KeypointHistory_t *history, uint32_t keypoint, uint32_t frames_back)
+{
+    return history->x[KeypointHistory_Slot(history, frames_back)][keypoint];
+}
+
+static inline float32_t KeypointHistory_Y(const KeypointHistory_t *history, uint32_t keypoint, uint32_t frames_back)
+{
+    return history->y[KeypointHistory_Slot(history, frames_back)][keypoint];
+}
+
+static inline float32_t KeypointHistory_Confidence(const KeypointHistory_t *history, uint32_t keypoint, uint32_t frames_back)
+{
+    return history->confidence[KeypointHistory_Slot(history, frames_back)][keypoint];
+}
+
+// Single keypoint queries, 'from_back' frames before the latest one over the previous 'frames' frames
+float32_t KeypointHistory_Speed(const KeypointHistory_t *history, uint32_t keypoint, uint32_t from_back, uint32_t frames);
+
+// Bulk queries over all keypoints, between the latest frame and 'frames' frames before
+void KeypointHistory_SpeedAll(const KeypointHistory_t *history, uint32_t frames, float32_t *speed);
+void KeypointHistory_DisplacementAll(const KeypointHistory_t *history, uint32_t frames, float32_t *dx, float32_t *dy);
+void KeypointHistory_ExtremumAll(const KeypointHistory_t *history, uint32_t frames,
+                                 float32_t *min_x, float32_t *max_x, float32_t *min_y, float32_t *max_y);
+
+#endif /* KEYPOINT_HISTORY_H */
@@ -0,0 +1,86 @@
+/**
+ ******************************************************************************
+ * @file    latency_trace.h
+ * @brief   Per-stage latency instrumentation of the frame pipeline: timestamped
+ *          begin/end events recorded into a lock-free ring, turned into rolling
+ *          min/avg/p99/max statistics by a single consumer
+ ******************************************************************************
+ */
+
+#ifndef LATENCY_TRACE_H
+#define LATENCY_TRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Timestamp source, DWT cycle counter on target. May be overridden (e.g. a mocked clock) */
+#ifndef LATENCY_TRACE_GET_TS
+#include "stm32n6xx.h"
+#define LATENCY_TRACE_GET_TS()        (DWT->CYCCNT)
+#define LATENCY_TRACE_USE_DWT
+#endif
+
+/* Events in flight between producers and the consumer, power of two */
+#define LATENCY_TRACE_NB_EVENTS       512
+/* Durations kept per stage for the statistics, above 100 for the p99 to drop the largest one */
+#define LATENCY_TRACE_WINDOW          128
+
+typedef enum {
+  LATENCY_STAGE_CAPTURE = 0,    /* NN pipe vsync to frame end */
+  LATENCY_STAGE_ISP,
+  LATENCY_STAGE_CROP,
+  LATENCY_STAGE_MOTION,         /* Motion measurement of a frame and inference decision, NN_ADAPTIVE_RATE */
+  LATENCY_STAGE_INFERENCE,      /* Whole inference, first epoch block start to network done */
+  LATENCY_STAGE_NPU_EPOCH,      /* One epoch block, its number is the event argument */
+  LATENCY_STAGE_POSTPROCESS,
+  LATENCY_STAGE_GESTURE,
+  LATENCY_STAGE_DRAW,
+  LATENCY_STAGE_NB,
+} LatencyStage_t;
+
+typedef enum {
+  LATENCY_EVENT_BEGIN = 0,
+  LATENCY_EVENT_END,
+} LatencyEventKind_t;
+
+typedef struct {
+  uint32_t seq;           /* Published last: slot holds event 'seq - 1' */
+  uint32_t ts;
+  uint8_t stage;
+  uint8_t kind;
+  uint16_t arg;
+} LatencyEvent_t;
+
+/* Durations in timestamp ticks, over the last LATENCY_TRACE_WINDOW ones */
+typedef struct {
+  uint32_t count;         /* Durations in the window */
+  uint32_t total;         /* Durations measured since the last reset */
+  uint32_t min;
+  uint32_t avg;
+  uint32_t p99;
+  uint32_t max;
+} LatencyStats_t;
+
+/* Enables the timestamp source, 'ts_freq_hz' is used to report durations in us */
+void LatencyTrace_Init(uint32_t ts_freq_hz);
+void LatencyTrace_ResetStats(void);
+
+/* Producers: safe from any context, including interrupts. A given stage must
+ * be begun and ended in order, as one begin/end pair at a time */
+void LatencyTrace_Event(LatencyStage_t stage, LatencyEventKind_t kind, uint16_t arg);
+#define LatencyTrace_Begin(stage)     LatencyTrace_Event((stage), LATENCY_EVENT_BEGIN, 0)
+#define LatencyTrace_End(stage)       LatencyTrace_Event((stage), LATENCY_EVENT_END, 0)
+
+/* Consumer side, single context */
+/* Gets the oldest event not yet read: returns 1 if any, 0 if the ring is empty */
+int LatencyTrace_Pop(LatencyEvent_t *event);
+/* Drains the ring into the per-stage statistics */
+void LatencyTrace_Process(void);
+void LatencyTrace_GetStats(LatencyStage_t stage, LatencyStats_t *stats);
+/* Events overwritten before being read */
+uint32_t LatencyTrace_GetLost(void);
+const char *LatencyTrace_GetStageName(LatencyStage_t stage);
+/* Formats the statistics of all stages in us as text lines, returns the length written */
+int LatencyTrace_Report(char *buffer, size_t size);
+
+#endif /* LATENCY_TRACE_H */
@@ -23,6 +23,7 @@
 /* Includes ------------------------------------------------------------------*/
 #include "stm32n6xx_hal.h"
 #include "stm32_lcd.h"
+#include "overlay_draw.h"
 
 /* Exported types ------------------------------------------------------------*/
 /* Exported constants --------------------------------------------------------*/
@@ -36,6 +37,10 @@
 #define COLOR_LEGS UTIL_LCD_COLOR_ORANGE
 #define COLOR_BOX UTIL_LCD_COLOR_RED
 
+/* Exported variables --------------------------------------------------------*/
+/* Drawing queue of the overlay layer, see Display_BeginFrame() in main.c */
+extern OverlayDraw_t lcd_fg_overlay;
+
 /* Exported functions ------------------------------------------------------- */
 
 #endif /* MAIN_H */
@@ -0,0 +1,80 @@
+/**
+ ******************************************************************************
+ * @file    model_manager.h
+ * @brief   Relocatable networks stored in the xSPI NOR (one per slot), installed
+ *          into the NPU memories at runtime and switched without reboot
+ ******************************************************************************
+ * Only available in the relocatable build (make RELOC=1, LL_ATON_RT_RELOC).
+ *
+ * Each slot of the NOR holds either nothing or a relocatable binary as
+ * produced by the ST Edge AI relocatable generation. Models are installed in
+ * XIP mode: the code stays in the memory-mapped NOR, only its data/got/bss are
+ * relocated into the exec arena. An installed image keeps its part of the arena
+ * until the arena is full, so switching back to it only restores its memory
+ * pools (weights copied to RAM, external RAM pool) instead of relocating it
+ * again.
+ ******************************************************************************
+ */
+
+#ifndef MODEL_MANAGER_H
+#define MODEL_MANAGER_H
+
+#include <stdint.h>
+#include "ll_aton_runtime.h"
+
+#if defined(LL_ATON_RT_RELOC)
+#include "ll_aton_reloc_network.h"
+
+/* Slots of the memory-mapped NOR holding the relocatable binaries */
+#ifndef MODEL_MANAGER_FLASH_BASE
+#define MODEL_MANAGER_FLASH_BASE      (0x71000000UL)
+#endif
+#ifndef MODEL_MANAGER_SLOT_SIZE
+#define MODEL_MANAGER_SLOT_SIZE       (0x00800000UL)
+#endif
+#ifndef MODEL_MANAGER_NB_SLOTS
+#define MODEL_MANAGER_NB_SLOTS        4
+#endif
+
+/* Relocated data of the installed images (internal RAM) */
+#ifndef MODEL_MANAGER_EXEC_RAM_SIZE
+#define MODEL_MANAGER_EXEC_RAM_SIZE   (64 * 1024)
+#endif
+/* External RAM pool, shared by all the models (PSRAM) */
+#ifndef MODEL_MANAGER_EXT_RAM_SIZE
+#define MODEL_MANAGER_EXT_RAM_SIZE    (4 * 1024 * 1024)
+#endif
+
+/* Timestamp source of the switch time, DWT cycle counter on target. May be overridden (e.g. host tests) */
+#ifndef MODEL_MANAGER_GET_TS
+#include "stm32n6xx.h"
+#define MODEL_MANAGER_GET_TS()        (DWT->CYCCNT)
+#endif
+
+typedef struct {
+  uint32_t nb_installs;         /* Full installs (relocation) */
+  uint32_t nb_cache_hits;       /* Switches back to an image still relocated in the exec arena */
+  uint32_t nb_evictions;        /* Exec arena resets */
+  uint32_t last_switch_ticks;   /* MODEL_MANAGER_GET_TS() ticks of the last switch, runtime re-init included */
+} ModelManager_Stats_t;
+
+/* Scans the NOR slots, returns the number of models found */
+int ModelManager_Init(void);
+int ModelManager_GetCount(void);
+/* Description of a model found by ModelManager_Init(), NULL if 'index' is out of range */
+const ll_aton_reloc_info *ModelManager_GetInfo(int index);
+/* Index of the model generated with the given c-name, -1 if none */
+int ModelManager_Find(const char *c_name);
+/* Makes model 'index' the one executed by 'resident': the model previously
+ * bound to it is de-initialized (no inference may be running), the new one is
+ * installed or restored, then initialized with 'epoch_cb' as epoch callback.
+ * Returns its instance, NULL on failure (no model is bound then) */
+NN_Instance_TypeDef *ModelManager_Select(int index, LL_ATON_RT_Resident_TypeDef *resident,
+                                         TraceEpochBlock_FuncPtr_t epoch_cb);
+/* Index of the selected model, -1 if none */
+int ModelManager_GetActive(void);
+const ModelManager_Stats_t *ModelManager_GetStats(void);
+
+#endif /* LL_ATON_RT_RELOC */
+
+#endif /* MODEL_MANAGER_H */
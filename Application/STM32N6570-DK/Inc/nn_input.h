@@ -0,0 +1,63 @@
+/**
+ ******************************************************************************
+ * @file    nn_input.h
+ * @brief   Ownership of the NN input buffers between their writer, the CPU
+ *          copying the captured frames or the DCMIPP capturing into them,
+ *          and the NPU, which reads them
+ ******************************************************************************
+ * With two buffers, the next frame is written into one while the inference
+ * in flight reads the other, which is then rebound as the network input. With
+ * a single buffer (network allocating its input), the next frame can only be
+ * written once the inference is done.
+ *
+ *   FREE --AcquireWrite--> WRITING --CommitWrite--> READY --StartInference--> NPU
+ *     ^ ^                     |                         |                      |
+ *     | +----CancelWrite------+        (newer frame) AcquireWrite              |
+ *     +------------------------------------------------------InferenceDone-----+
+ *
+ * A write is cancelled when the frame turns out not to be inferred or torn:
+ * the buffer no longer holds a complete frame, the older one included.
+ ******************************************************************************
+ */
+
+#ifndef NN_INPUT_H
+#define NN_INPUT_H
+
+#include <stdint.h>
+
+#define NN_INPUT_MAX_BUFFERS  2
+
+typedef enum {
+  NN_INPUT_FREE = 0,
+  NN_INPUT_WRITING,     /* Being written by the CPU */
+  NN_INPUT_READY,       /* Holds a frame not inferred yet */
+  NN_INPUT_NPU,         /* Read by the inference in flight */
+} NnInput_State_t;
+
+/* Binds 'buffer' as the network input, returns 0 on success */
+typedef int (*NnInput_BindFunc_t)(uint8_t *buffer, uint32_t len);
+
+typedef struct {
+  uint8_t *buffers[NN_INPUT_MAX_BUFFERS];
+  NnInput_State_t states[NN_INPUT_MAX_BUFFERS];
+  int nb_buffers;
+  uint32_t len;
+  int bound;            /* Buffer bound to the network input, -1 if none */
+  NnInput_BindFunc_t bind;
+} NnInput_TypeDef;
+
+/* 'buffer1' and 'bind' are NULL when the network input is the only buffer */
+void NnInput_Init(NnInput_TypeDef *in, uint8_t *buffer0, uint8_t *buffer1, uint32_t len, NnInput_BindFunc_t bind);
+/* Buffer to copy the next frame into, the one holding an older frame first; NULL if all are read by the NPU */
+uint8_t *NnInput_AcquireWrite(NnInput_TypeDef *in);
+/* Whether NnInput_AcquireWrite() would return a buffer */
+int NnInput_CanWrite(const NnInput_TypeDef *in);
+void NnInput_CommitWrite(NnInput_TypeDef *in, uint8_t *buffer);
+/* Frame dropped while being written: the buffer is free again */
+void NnInput_CancelWrite(NnInput_TypeDef *in, uint8_t *buffer);
+int NnInput_IsReady(const NnInput_TypeDef *in);
+/* To be called with the NPU idle, before starting the inference: binds the ready buffer to the network input */
+uint8_t *NnInput_StartInference(NnInput_TypeDef *in);
+void NnInput_InferenceDone(NnInput_TypeDef *in);
+
+#endif /* NN_INPUT_H */
@@ -0,0 +1,70 @@
+/**
+ ******************************************************************************
+ * @file    npu_profiler.h
+ * @brief   Per epoch block NPU performance counters (ATON debug and trace
+ *          unit), aggregated over several inferences and reported as CSV
+ ******************************************************************************
+ * The 16 debug and trace counters cannot observe everything at once: each
+ * inference samples one group of events, the groups taking turns.
+ *  - BUS: bursts of each length read and written on both bus interfaces
+ *    (LL_Dbgtrc_BurstLenBenchStart()), i.e. the bytes transferred.
+ *  - STRENG_IN / STRENG_OUT: cycles each stream engine reading / writing the
+ *    memories is active, i.e. neither idle nor stalled
+ *    (LL_Dbgtrc_Count_StrengActive_Config()), and the NPU clock cycles.
+ * CPU cycles and the start of each block within the inference are measured at
+ * every inference.
+ *
+ * The CSV lines start with "npu,", so that they can be picked out of the
+ * virtual COM port output (see Tools/npu_profile_report.py).
+ ******************************************************************************
+ */
+
+#ifndef NPU_PROFILER_H
+#define NPU_PROFILER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ll_aton_runtime.h"
+
+/* Epoch blocks profiled, the following ones are ignored */
+#define NPU_PROFILER_MAX_EB           16
+
+typedef enum {
+  NPU_PROFILER_GROUP_BUS = 0,
+  NPU_PROFILER_GROUP_STRENG_IN,
+  NPU_PROFILER_GROUP_STRENG_OUT,
+  NPU_PROFILER_GROUP_NB,
+} NpuProfiler_Group_t;
+
+/* Sums over the executions of an epoch block. The counters of a group are
+ * summed over the group_count[group] executions which sampled it */
+typedef struct {
+  uint32_t count;                               /* Executions, all groups */
+  uint64_t start_ticks;                         /* CPU cycles from the start of the inference to the block's */
+  uint64_t ticks;                               /* CPU cycles, PRE_START to POST_END callbacks */
+  uint32_t min_ticks;
+  uint32_t max_ticks;
+  uint32_t group_count[NPU_PROFILER_GROUP_NB];
+  uint64_t bursts[16];                          /* LL_Dbgtrc_BurstLenGet() layout */
+  uint64_t streng_in[ATON_STRENG_NUM];
+  uint64_t streng_out[ATON_STRENG_NUM];
+  uint64_t npu_cycles[NPU_PROFILER_GROUP_NB];   /* Measured by the STRENG_* groups only */
+  uint16_t flags;                               /* EpochBlock_Flags_t */
+} NpuProfiler_EbStats_t;
+
+/* To be called once the network is initialized: profiles the next
+ * 'runs_per_group' x NPU_PROFILER_GROUP_NB inferences */
+void NpuProfiler_Init(uint32_t runs_per_group);
+/* To be called from the epoch callback of the network, PRE_START and POST_END at least */
+void NpuProfiler_EpochCallback(LL_ATON_RT_Callbacktype_t ctype, const NN_Instance_TypeDef *nn_instance,
+                               const EpochBlock_ItemTypeDef *eb);
+/* All the inferences of the profile have been measured */
+int NpuProfiler_IsDone(void);
+/* Epoch blocks seen so far, at most NPU_PROFILER_MAX_EB */
+int NpuProfiler_GetNbEb(void);
+void NpuProfiler_GetStats(int eb_idx, NpuProfiler_EbStats_t *stats);
+/* Formats CSV line 'line' of the report (0 is the header, then one per epoch
+ * block, averages per execution), returns the length written, 0 past the last line */
+int NpuProfiler_ReportLine(int line, char *buffer, size_t size);
+
+#endif /* NPU_PROFILER_H */
@@ -0,0 +1,34 @@
+/**
+ ******************************************************************************
+ * @file    overlay_damage.h
+ * @brief   Tracking of the regions drawn in an overlay frame buffer, so that
+ *          only those are cleared and cache cleaned on the next use
+ ******************************************************************************
+ */
+
+#ifndef OVERLAY_DAMAGE_H
+#define OVERLAY_DAMAGE_H
+
+#include <stdint.h>
+
+#define OVERLAY_DAMAGE_MAX_RECTS  8
+
+typedef struct {
+  uint16_t x0, y0;  /* Inclusive */
+  uint16_t x1, y1;  /* Exclusive */
+} OverlayRect_t;
+
+typedef struct {
+  uint16_t width;
+  uint16_t height;
+  uint32_t nb_rects;
+  OverlayRect_t rects[OVERLAY_DAMAGE_MAX_RECTS];
+} OverlayDamage_t;
+
+void OverlayDamage_Init(OverlayDamage_t *damage, uint16_t width, uint16_t height);
+void OverlayDamage_Reset(OverlayDamage_t *damage);
+void OverlayDamage_Add(OverlayDamage_t *damage, int x, int y, int w, int h);
+void OverlayDamage_AddFull(OverlayDamage_t *damage);
+uint32_t OverlayDamage_Area(const OverlayDamage_t *damage);
+
+#endif /* OVERLAY_DAMAGE_H */
@@ -0,0 +1,132 @@
+/**
+ ******************************************************************************
+ * @file    overlay_draw.h
+ * @brief   Batched drawing of the overlay layer: primitives are queued during
+ *          the frame then flushed as rectangle fills, mask blends and copies
+ *          executed by a backend (DMA2D on target, CPU reference otherwise)
+ ******************************************************************************
+ */
+
+#ifndef OVERLAY_DRAW_H
+#define OVERLAY_DRAW_H
+
+#include <stdint.h>
+#include "stm32_lcd.h"
+
+#define OVERLAY_DRAW_MAX_PRIMITIVES     96
+#define OVERLAY_DRAW_TEXT_POOL_SIZE     1024
+/* Longest string of a single OverlayDraw_PrintfAt() call */
+#define OVERLAY_DRAW_MAX_TEXT_LEN       47
+/* Circles up to this radius are blended from a pre-rendered mask, larger ones are filled row per row */
+#define OVERLAY_DRAW_MAX_MASK_RADIUS    8
+/* Glyph atlas: one A8 cell per printable character, ' ' to '~' */
+#define OVERLAY_DRAW_FIRST_GLYPH        ' '
+#define OVERLAY_DRAW_NB_GLYPHS          95
+#define OVERLAY_DRAW_GLYPH_ATLAS_SIZE(width, height)  (OVERLAY_DRAW_NB_GLYPHS * (width) * (height))
+
+typedef enum {
+  OVERLAY_DRAW_ALIGN_LEFT = 0,
+  OVERLAY_DRAW_ALIGN_CENTER,
+  OVERLAY_DRAW_ALIGN_RIGHT,
+} OverlayDrawAlign_t;
+
+/* Elementary operation of a flush, already clipped to the frame buffer */
+typedef enum {
+  OVERLAY_OP_FILL,    /* Replace with color */
+  OVERLAY_OP_MASK,    /* Blend color over the frame buffer through an A8 mask */
+  OVERLAY_OP_GLYPH,   /* Replace with color blended over back_color through an A8 mask */
+  OVERLAY_OP_COPY,    /* Replace with ARGB4444 pixels */
+} OverlayOpType_t;
+
+typedef struct {
+  OverlayOpType_t type;
+  uint16_t x, y, w, h;
+  uint32_t color;         /* ARGB8888 */
+  uint32_t back_color;    /* ARGB8888, OVERLAY_OP_GLYPH only */
+  const uint8_t *src;     /* A8 mask or ARGB4444 pixels, first pixel of the op */
+  uint16_t src_pitch;     /* In pixels */
+} OverlayOp_t;
+
+typedef struct OverlayDraw OverlayDraw_t;
+
+typedef struct {
+  /* Executes one op: returns 0 once done, or 1 if started and completion is
+   * later reported through OverlayDraw_OpDone() */
+  int (*execute)(OverlayDraw_t *od, const OverlayOp_t *op);
+  /* Makes CPU built data (glyph atlas, circle masks) visible to the backend, may be NULL */
+  void (*sync_source)(const void *data, uint32_t size);
+  /* Non-zero if the frame buffer is written through the CPU data cache */
+  int cpu_writes;
+} OverlayDrawBackend_t;
+
+typedef enum {
+  OVERLAY_PRIM_RECT,
+  OVERLAY_PRIM_LINE,
+  OVERLAY_PRIM_CIRCLE,
+  OVERLAY_PRIM_TEXT,
+  OVERLAY_PRIM_BITMAP,
+} OverlayPrimType_t;
+
+typedef struct {
+  uint8_t type;
+  uint8_t width;          /* Line width, odd */
+  int16_t x0, y0;         /* Rect/bitmap/text origin, line start, circle center */
+  int16_t x1, y1;         /* Rect/bitmap size, line end, circle radius in x1 */
+  uint32_t color;
+  uint32_t back_color;
+  const uint8_t *data;    /* Text (in the pool) or ARGB4444 bitmap */
+} OverlayPrimitive_t;
+
+struct OverlayDraw {
+  const OverlayDrawBackend_t *backend;
+  uint8_t *fb;            /* ARGB4444 frame buffer */
+  uint16_t width;
+  uint16_t height;
+  /* Text state, as set by OverlayDraw_SetFont() and OverlayDraw_Set*Color() */
+  const sFONT *font;
+  const uint8_t *glyph_atlas;
+  uint32_t text_color;
+  uint32_t back_color;
+  /* Queue of the frame */
+  uint32_t nb_prims;
+  OverlayPrimitive_t prims[OVERLAY_DRAW_MAX_PRIMITIVES];
+  uint32_t text_pool_used;
+  char text_pool[OVERLAY_DRAW_TEXT_POOL_SIZE];
+  uint32_t nb_dropped;    /* Primitives not queued for lack of room */
+  /* Flush state, op generation resumes at (prim_idx, step) */
+  uint32_t prim_idx;
+  int32_t step;
+  volatile int busy;
+  void (*done_cb)(void *arg);
+  void *done_arg;
+};
+
+extern const OverlayDrawBackend_t OverlayDraw_SwBackend;
+/* DMA2D backend (overlay_draw_dma2d.c), OverlayDraw_Dma2d_IRQHandler() is called from DMA2D_IRQHandler() */
+extern const OverlayDrawBackend_t OverlayDraw_Dma2dBackend;
+void OverlayDraw_Dma2d_Init(void);
+void OverlayDraw_Dma2d_IRQHandler(void);
+
+void OverlayDraw_Init(OverlayDraw_t *od, const OverlayDrawBackend_t *backend, uint16_t width, uint16_t height);
+/* Builds the A8 glyph atlas of the font into 'atlas' (OVERLAY_DRAW_GLYPH_ATLAS_SIZE() bytes) */
+void OverlayDraw_SetFont(OverlayDraw_t *od, const sFONT *font, uint8_t *atlas, uint32_t atlas_size);
+void OverlayDraw_SetTextColor(OverlayDraw_t *od, uint32_t color);
+void OverlayDraw_SetBackColor(OverlayDraw_t *od, uint32_t color);
+
+/* Waits for the previous flush then starts a new queue on frame buffer 'fb' */
+void OverlayDraw_Begin(OverlayDraw_t *od, uint8_t *fb);
+void OverlayDraw_FillRect(OverlayDraw_t *od, int x, int y, int w, int h, uint32_t color);
+void OverlayDraw_Rect(OverlayDraw_t *od, int x, int y, int w, int h, uint32_t color);
+void OverlayDraw_Line(OverlayDraw_t *od, int x0, int y0, int x1, int y1, int width, uint32_t color);
+void OverlayDraw_FillCircle(OverlayDraw_t *od, int x, int y, int radius, uint32_t color);
+void OverlayDraw_Bitmap(OverlayDraw_t *od, int x, int y, int w, int h, const uint8_t *argb4444);
+void OverlayDraw_PrintfAt(OverlayDraw_t *od, int x, int y, OverlayDrawAlign_t align, const char *format, ...);
+
+/* Executes the queue in order, 'done_cb' (may be NULL) is called once the last op completed,
+ * from the backend completion context */
+void OverlayDraw_Flush(OverlayDraw_t *od, void (*done_cb)(void *arg), void *done_arg);
+void OverlayDraw_Wait(OverlayDraw_t *od);
+/* Backend completion of the op started last */
+void OverlayDraw_OpDone(OverlayDraw_t *od);
+
+#endif /* OVERLAY_DRAW_H */
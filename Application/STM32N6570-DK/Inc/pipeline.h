@@ -0,0 +1,92 @@
+/**
+ ******************************************************************************
+ * @file    pipeline.h
+ * @brief   Frame pipeline of the main loop: capture N+1 | inference N |
+ *          post-process & draw N-1
+ ******************************************************************************
+ * The scheduling is portable, the camera, copy, NPU and display actions are
+ * callbacks of the application. Pipeline_Step() is called from the main loop,
+ * once per iteration:
+ *   - inference N stepped as far as possible without waiting
+ *   - post-processing of N, before inference N+1 overwrites the NN outputs
+ *   - latest captured frame into a NN input buffer the NPU is not reading
+ *   - inference N+1 as soon as the NPU is free and the outputs of N are used
+ *   - drawing of N while the NPU works on N+1
+ *
+ * Frames reach the NN input in one of two ways:
+ *   - copied: DCMIPP continuously alternates between two capture buffers of
+ *     its own, the latest complete one is copied (cropped to the NN width)
+ *     into the NN input buffer. The capture buffer is written again by DCMIPP
+ *     a frame period after it completed: a frame read for longer, or read
+ *     late, is torn and dropped, checked through its sequence number.
+ *   - direct: DCMIPP writes the NN input buffer itself, one snapshot at a
+ *     time, when the NN pipe pitch is the NN input pitch.
+ ******************************************************************************
+ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdint.h>
+#include "nn_input.h"
+#include "roi_tracker.h"
+#include "inference_rate.h"
+
+/* Application actions of the pipeline */
+typedef struct {
+  /* Direct capture: starts the snapshot of the next frame into the NN input buffer, NULL when frames are copied */
+  void (*capture_start)(uint8_t *nn_in);
+  /* Latest NN pipe frame completed since the previous call, NULL if none: its sequence number and the region of the
+   * camera frame it holds. The frame is then readable by the CPU */
+  uint8_t *(*frame_get)(uint32_t *seq, Roi_t *roi);
+  /* Sequence number of the frame a buffer returned by frame_get() holds now, copied frames only */
+  uint32_t (*frame_seq)(const uint8_t *frame);
+  /* Starts the copy of a frame into the NN input buffer, completed by Pipeline_InputWritten(). Returns non zero if
+   * the copy is done by copy() instead. May be NULL */
+  int (*copy_start)(const uint8_t *frame, uint8_t *nn_in);
+  /* Copies a frame into the NN input buffer by CPU, copied frames only */
+  void (*copy)(const uint8_t *frame, uint8_t *nn_in);
+  /* NN input buffer written, before an inference reads it */
+  void (*commit)(uint8_t *nn_in);
+  /* Runs the inference started as far as possible without waiting, returns non zero once it is done */
+  int (*inference_run)(void);
+  /* Post-processes the NN outputs of the inference done, on a frame of region 'roi' */
+  void (*postprocess)(const Roi_t *roi);
+  /* Draws the keypoints post-processed or, with 'is_predicted', extrapolated for a frame not inferred */
+  void (*draw)(int is_predicted);
+} Pipeline_Ops_t;
+
+typedef struct {
+  const Pipeline_Ops_t *ops;
+  NnInput_TypeDef *nn_input;
+  InferenceRate_t *rate;  /* Frames inferred following the motion, NULL to infer them all */
+  int is_direct;
+  uint32_t pitch;         /* Of the NN pipe frames */
+  uint32_t nn_in_len;
+  int nn_running;         /* Inference in flight on the NPU */
+  int pp_pending;         /* Inference done, nn outputs not yet post-processed */
+  int draw_pending;       /* Post-processed keypoints not yet rendered */
+  int draw_predicted;     /* Frame not inferred: keypoints extrapolated rendered instead */
+  uint8_t *nn_in_writing; /* NN input buffer a frame is being copied or captured into */
+  uint8_t *nn_in_frame;   /* NN pipe buffer it is copied from */
+  uint32_t nn_in_seq;     /* Sequence number of the frame copied */
+  volatile uint32_t nn_in_end_seq; /* Sequence number of its buffer once copied */
+  volatile int nn_in_written;
+  volatile int nn_in_failed; /* DMA2D transfer error, to be copied by the CPU */
+  Roi_t input_roi;        /* Region of the camera frame in the NN input buffer last written */
+  Roi_t inference_roi;    /* Region of the camera frame inferred */
+  uint32_t nb_torn;       /* Frames dropped, written by DCMIPP while read */
+} Pipeline_TypeDef;
+
+/* 'is_direct' when DCMIPP captures into the NN input buffers, 'pitch' being then their pitch */
+void Pipeline_Init(Pipeline_TypeDef *p, const Pipeline_Ops_t *ops, NnInput_TypeDef *nn_input, InferenceRate_t *rate,
+                   int is_direct, uint32_t pitch, uint32_t nn_in_len);
+/* One iteration of the main loop, returns non zero when it can wait for an event (WFE) */
+int Pipeline_Step(Pipeline_TypeDef *p);
+/* Keeps the NPU fed from a long CPU task, e.g. while drawing: steps the inference, hands the NN input buffer written
+ * meanwhile over to the next one. Returns non zero if the NPU is busy */
+int Pipeline_Advance(Pipeline_TypeDef *p);
+/* End of the copy started by copy_start(), possibly from an interrupt. On error, copied by copy() from the main loop */
+void Pipeline_InputWritten(Pipeline_TypeDef *p, int error);
+
+#endif /* PIPELINE_H */
@@ -0,0 +1,68 @@
+/**
+ ******************************************************************************
+ * @file    roi_tracker.h
+ * @brief   Region of the camera frame zoomed into by the NN pipe, following
+ *          the keypoints of the previous frames
+ ******************************************************************************
+ * Coordinates are normalized to [0, 1] over the full frame, i.e. the NN pipe
+ * output without zoom, which the display and the gesture detection expect.
+ * The region is a square in these coordinates: its pixel aspect ratio is the
+ * one of the full frame mapping, so that the NN input is never distorted more
+ * than without zoom.
+ ******************************************************************************
+ */
+
+#ifndef ROI_TRACKER_H
+#define ROI_TRACKER_H
+
+#include <stdint.h>
+#include "app_config.h"
+#include "spe_pp_output_if.h"
+
+typedef struct {
+    float32_t x0;
+    float32_t y0;
+    float32_t width;
+    float32_t height;
+} Roi_t;
+
+typedef struct {
+    float32_t margin;               // Added on each side, fraction of the keypoints bounding box size
+    float32_t min_size;             // Smallest region side, i.e. highest zoom
+    float32_t min_confidence;       // Keypoints below are ignored
+    float32_t shrink_rate;          // Fraction of the way to a smaller region covered per frame, 1 to jump
+    uint8_t min_keypoints;          // Fewer confident keypoints is a missed detection
+    uint8_t max_missed;             // Consecutive missed detections after which the full frame is used again
+} RoiTracker_Params_t;
+
+// Region in pixels of the full frame
+typedef struct {
+    uint32_t x0;
+    uint32_t y0;
+    uint32_t width;
+    uint32_t height;
+} Roi_Pixels_t;
+
+typedef struct {
+    RoiTracker_Params_t params;
+    Roi_t roi;
+    uint8_t missed;
+} RoiTracker_t;
+
+extern const Roi_t Roi_FullFrame;
+
+void RoiTracker_Init(RoiTracker_t *tracker, const RoiTracker_Params_t *params);
+// Back to the full frame
+void RoiTracker_Reset(RoiTracker_t *tracker);
+// Region of the next frames from the keypoints of a frame, in full frame coordinates
+const Roi_t *RoiTracker_Update(RoiTracker_t *tracker, const spe_pp_outBuffer_t *keypoints, int nb_keypoints);
+// Pixels of a 'full_width' x 'full_height' full frame covering 'roi', at least 'min_width' x 'min_height' and shifted
+// back inside the frame, and the region they cover in full frame coordinates
+void Roi_ToPixels(const Roi_t *roi, uint32_t full_width, uint32_t full_height, uint32_t min_width, uint32_t min_height,
+                  Roi_Pixels_t *pixels, Roi_t *captured);
+// Whether an edge of 'to' is more than 'dead_band' pixels away from the same edge of 'from'
+int Roi_PixelsMoved(const Roi_Pixels_t *from, const Roi_Pixels_t *to, uint32_t dead_band);
+// Maps in place keypoints inferred on 'roi' to full frame coordinates
+void Roi_ToFullFrame(const Roi_t *roi, spe_pp_outBuffer_t *keypoints, int nb_keypoints);
+
+#endif /* ROI_TRACKER_H */
@@ -0,0 +1,86 @@
+/**
+ ******************************************************************************
+ * @file    weight_prefetch.h
+ * @brief   NPU cache profiling of the epoch blocks and warming of the weights
+ *          read from the xSPI NOR ahead of the blocks that miss the most
+ ******************************************************************************
+ * Profiling: around each epoch block, the CACHEAXI read hit/miss monitors and
+ * the bus interface burst counters of the ATON debug and trace unit
+ * (LL_Dbgtrc_BurstLenBenchStart(), all 16 counters) are sampled, giving per
+ * block its NPU cache hit rate, the bytes the NPU read and the external memory
+ * traffic (one 64-byte line per miss).
+ *
+ * Prefetch: after WEIGHT_PREFETCH_PROFILE_RUNS inferences, the epoch blobs whose
+ * miss ratio reaches WEIGHT_PREFETCH_COLD_MISS_PCT are marked cold. The weights
+ * of a blob are taken from the reads of its buffer dependencies (see
+ * network_eb_deps.c): the first WEIGHT_PREFETCH_MAX_RANGES ranges inside the
+ * weights window, up to WEIGHT_PREFETCH_MAX_BYTES, are copied concurrently by
+ * pairs of stream engines through the NPU cache into a scratch buffer in
+ * npuRAM3 (not used by the network), which allocates their lines. The copies
+ * run while the NPU is idle: during the pure SW epoch block preceding a cold
+ * blob, or between inferences for the first block, and are waited for when the
+ * blob is about to start. The ATON IP is owned meanwhile, the copies are only
+ * started when no instance owns it.
+ *
+ * One network only: another instance sharing the NPU (LL_ATON_RT_Sched_*) may
+ * not start an epoch block while the copies own it.
+ ******************************************************************************
+ */
+
+#ifndef WEIGHT_PREFETCH_H
+#define WEIGHT_PREFETCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ll_aton_runtime.h"
+
+/* Epoch blocks profiled, the following ones are ignored */
+#define WEIGHT_PREFETCH_MAX_EB          16
+/* Inferences profiled before the cold blocks are selected */
+#define WEIGHT_PREFETCH_PROFILE_RUNS    8
+/* NPU cache read miss ratio (%) from which an epoch blob is cold */
+#define WEIGHT_PREFETCH_COLD_MISS_PCT   20
+/* Weight ranges warmed before a cold blob, one pair of stream engines each */
+#define WEIGHT_PREFETCH_MAX_RANGES      4
+/* Weights warmed before a cold blob, well below the NPU cache size */
+#define WEIGHT_PREFETCH_MAX_BYTES       (64 * 1024)
+/* Destination of the warming copies, start of npuRAM3 */
+#define WEIGHT_PREFETCH_SCRATCH_ADDR    (0x34200000UL)
+
+typedef enum {
+  WEIGHT_PREFETCH_OFF = 0,
+  WEIGHT_PREFETCH_PROFILE,        /* Profiling only */
+  WEIGHT_PREFETCH_AUTO,           /* Profiling, then warming of the cold blobs */
+} WeightPrefetch_Mode_t;
+
+/* Sums over the executions of an epoch block since the last reset */
+typedef struct {
+  uint32_t count;                 /* Executions */
+  uint64_t ticks;                 /* CPU cycles, PRE_START to POST_END callbacks */
+  uint64_t read_hits;             /* NPU cache read hits */
+  uint64_t read_misses;           /* NPU cache read misses, i.e. lines read from the external memories */
+  uint64_t read_bytes;            /* Read by the NPU bus interfaces, cached or not */
+  uint64_t write_bytes;
+  uint8_t blob;                   /* Epoch blob, the only kind of block warmed */
+  uint8_t cold;                   /* Warmed before each execution */
+  uint32_t warm_bytes;            /* Weights warmed before each execution, 0 if not cold */
+} WeightPrefetch_EbStats_t;
+
+/* To be called once the network is initialized, starts the counters. 'deps' gives the buffer dependencies of the
+ * epoch blocks (NULL: nothing is warmed), 'weights_start' and 'weights_size' the memory-mapped weights */
+void WeightPrefetch_Init(WeightPrefetch_Mode_t mode, const EpochBlock_DepsTypeDef *deps, uintptr_t weights_start,
+                         uint32_t weights_size);
+/* To be called from the epoch callback of the network, PRE_START and POST_END at least */
+void WeightPrefetch_EpochCallback(LL_ATON_RT_Callbacktype_t ctype, const NN_Instance_TypeDef *nn_instance,
+                                  const EpochBlock_ItemTypeDef *eb);
+/* To be called between inferences, once the last one is done: warms the first
+ * epoch block if it is cold, the copy overlaps whatever the CPU does next */
+void WeightPrefetch_Idle(void);
+void WeightPrefetch_ResetStats(void);
+/* Epoch blocks seen so far, at most WEIGHT_PREFETCH_MAX_EB */
+int WeightPrefetch_GetNbEb(void);
+void WeightPrefetch_GetStats(int eb_idx, WeightPrefetch_EbStats_t *stats);
+/* Formats the average per epoch block as text lines, returns the length written */
+int WeightPrefetch_Report(char *buffer, size_t size);
+
+#endif /* WEIGHT_PREFETCH_H */
@@ -18,9 +18,11 @@
 
 #include <assert.h>
 #include "cmw_camera.h"
+#include "cmw_utils.h"
 #include "app_camerapipeline.h"
 #include "app_config.h"
 #include "crop_img.h"
+#include "latency_trace.h"
 
 #if defined(USE_IMX335_SENSOR)
   #define GAMMA_CONVERSION 0
@@ -37,6 +39,34 @@
 
 extern int32_t cameraFrameReceived;
 
+/* NN pipe buffers handed to DCMIPP, the second one NULL in snapshot mode, and index of the last completed one */
+static uint8_t *nn_pipe_buffers[2];
+static volatile uint32_t nn_pipe_last_frame_idx;
+static volatile uint32_t nn_pipe_next_frame_idx;
+/* Sequence number of the frame each buffer holds, NN_PIPE_SEQ_WRITING once DCMIPP may write it again */
+#define NN_PIPE_SEQ_WRITING 0
+static volatile uint32_t nn_pipe_seqs[2];
+static uint32_t nn_pipe_seq;
+
+/* NN pipe zoom: camera frame size and area of the frame output without zoom, in sensor pixels */
+static uint32_t nn_pipe_cam_width;
+static uint32_t nn_pipe_cam_height;
+static CMW_Manual_roi_area_t nn_pipe_full_area;
+static CMW_DCMIPP_Conf_t nn_pipe_conf;
+/* Configuration of the next zoom, applied by the frame event callback */
+static struct {
+  DCMIPP_CropConfTypeDef crop;
+  DCMIPP_DecimationConfTypeDef dec;
+  DCMIPP_DownsizeTypeDef down;
+  Roi_t roi;
+} nn_pipe_zoom;
+static volatile int nn_pipe_zoom_pending;
+/* Region captured in each buffer, and in the one DCMIPP is writing */
+static Roi_t nn_pipe_rois[2];
+static Roi_t nn_pipe_roi;
+/* Pixels of the last zoom programmed, within the area output without zoom */
+static Roi_Pixels_t nn_pipe_pixels;
+
 static void DCMIPP_PipeInitDisplay(CMW_CameraInit_t *camConf, uint32_t *bg_width, uint32_t *bg_height)
 {
   CMW_Aspect_Ratio_Mode_t aspect_ratio;
@@ -82,10 +112,13 @@ static void DCMIPP_PipeInitDisplay(CMW_CameraInit_t *camConf, uint32_t *bg_width
   assert(dcmipp_conf.output_width * dcmipp_conf.output_bpp == pitch);
 }
 
-static void DCMIPP_PipeInitNn(uint32_t *pitch)
+static void DCMIPP_PipeInitNn(CMW_CameraInit_t *camConf, uint32_t *pitch)
 {
   CMW_Aspect_Ratio_Mode_t aspect_ratio;
-  CMW_DCMIPP_Conf_t dcmipp_conf;
+  CMW_DCMIPP_Conf_t dcmipp_conf = {0};
+  DCMIPP_CropConfTypeDef crop_conf = {0};
+  DCMIPP_DecimationConfTypeDef dec_conf;
+  DCMIPP_DownsizeTypeDef down_conf;
   int ret;
 
   if (ASPECT_RATIO_MODE == ASPECT_RATIO_CROP)
@@ -110,6 +143,65 @@ static void DCMIPP_PipeInitNn(uint32_t *pitch)
   dcmipp_conf.enable_gamma_conversion = GAMMA_CONVERSION;
   ret = CMW_CAMERA_SetPipeConfig(DCMIPP_PIPE2, &dcmipp_conf, pitch);
   assert(ret == HAL_OK);
+
+  /* The zoom regions are relative to the area output without zoom: the crop if any, the whole frame otherwise */
+  nn_pipe_cam_width = camConf->width;
+  nn_pipe_cam_height = camConf->height;
+  CMW_UTILS_GetPipeConfig(camConf->width, camConf->height, &dcmipp_conf, &crop_conf, &dec_conf, &down_conf);
+  if (crop_conf.HSize != 0 && crop_conf.VSize != 0)
+  {
+    nn_pipe_full_area.width = crop_conf.HSize;
+    nn_pipe_full_area.height = crop_conf.VSize;
+    nn_pipe_full_area.offset_x = crop_conf.HStart;
+    nn_pipe_full_area.offset_y = crop_conf.VStart;
+  }
+  else
+  {
+    nn_pipe_full_area.width = camConf->width;
+    nn_pipe_full_area.height = camConf->height;
+    nn_pipe_full_area.offset_x = 0;
+    nn_pipe_full_area.offset_y = 0;
+  }
+  nn_pipe_conf = dcmipp_conf;
+  nn_pipe_conf.mode = CMW_Aspect_ratio_manual_roi;
+  nn_pipe_pixels.x0 = 0;
+  nn_pipe_pixels.y0 = 0;
+  nn_pipe_pixels.width = nn_pipe_full_area.width;
+  nn_pipe_pixels.height = nn_pipe_full_area.height;
+  nn_pipe_roi = Roi_FullFrame;
+  nn_pipe_rois[0] = Roi_FullFrame;
+  nn_pipe_rois[1] = Roi_FullFrame;
+  nn_pipe_zoom_pending = 0;
+}
+
+/* Programs the crop, decimation and downsize of the next zoom, from the frame event callback */
+static void DCMIPP_PipeApplyNnZoom(void)
+{
+  DCMIPP_HandleTypeDef *hdcmipp = CMW_CAMERA_GetDCMIPPHandle();
+  int ret;
+
+  ret = HAL_DCMIPP_PIPE_SetCropConfig(hdcmipp, DCMIPP_PIPE2, &nn_pipe_zoom.crop);
+  assert(ret == HAL_OK);
+  ret = HAL_DCMIPP_PIPE_EnableCrop(hdcmipp, DCMIPP_PIPE2);
+  assert(ret == HAL_OK);
+
+  if (nn_pipe_zoom.dec.VRatio != 0 || nn_pipe_zoom.dec.HRatio != 0)
+  {
+    ret = HAL_DCMIPP_PIPE_SetDecimationConfig(hdcmipp, DCMIPP_PIPE2, &nn_pipe_zoom.dec);
+    assert(ret == HAL_OK);
+    ret = HAL_DCMIPP_PIPE_EnableDecimation(hdcmipp, DCMIPP_PIPE2);
+  }
+  else
+  {
+    ret = HAL_DCMIPP_PIPE_DisableDecimation(hdcmipp, DCMIPP_PIPE2);
+  }
+  assert(ret == HAL_OK);
+
+  ret = HAL_DCMIPP_PIPE_SetDownsizeConfig(hdcmipp, DCMIPP_PIPE2, &nn_pipe_zoom.down);
+  assert(ret == HAL_OK);
+  (void) ret;
+
+  nn_pipe_roi = nn_pipe_zoom.roi;
 }
 
 /**
@@ -133,7 +225,7 @@ void CameraPipeline_Init(uint32_t *lcd_bg_width, uint32_t *lcd_bg_height, uint32
   ret = CMW_CAMERA_Init(&cam_conf);
   assert(ret == CMW_ERROR_NONE);
   DCMIPP_PipeInitDisplay(&cam_conf, lcd_bg_width, lcd_bg_height);
-  DCMIPP_PipeInitNn(pitch_nn);
+  DCMIPP_PipeInitNn(&cam_conf, pitch_nn);
 }
 
 void CameraPipeline_DeInit(void)
@@ -150,14 +242,147 @@ void CameraPipeline_DisplayPipe_Start(uint8_t *display_pipe_dst, uint32_t cam_mo
   assert(ret == CMW_ERROR_NONE);
 }
 
+/**
+* @brief Start NN pipe capture into a single buffer
+* @param nn_pipe_dst DCMIPP output buffer
+* @param cam_mode CMW_MODE_CONTINUOUS or CMW_MODE_SNAPSHOT
+* @note In snapshot mode, called again for each frame, possibly with another buffer
+*/
 void CameraPipeline_NNPipe_Start(uint8_t *nn_pipe_dst, uint32_t cam_mode)
 {
   int ret;
 
+  /* Pipe stopped between two snapshots: a zoom requested meanwhile applies to this frame */
+  if (nn_pipe_zoom_pending)
+  {
+    DCMIPP_PipeApplyNnZoom();
+    nn_pipe_zoom_pending = 0;
+  }
+  nn_pipe_buffers[0] = nn_pipe_dst;
+  nn_pipe_buffers[1] = NULL;
+  nn_pipe_last_frame_idx = 0;
+  nn_pipe_next_frame_idx = 0;
+  nn_pipe_seqs[0] = NN_PIPE_SEQ_WRITING;
+  nn_pipe_rois[0] = nn_pipe_roi;
+
   ret = CMW_CAMERA_Start(DCMIPP_PIPE2, nn_pipe_dst, cam_mode);
   assert(ret == CMW_ERROR_NONE);
 }
 
+/**
+* @brief Start NN pipe continuous capture alternating between two buffers
+* @param nn_pipe_dst0 first DCMIPP output buffer
+* @param nn_pipe_dst1 second DCMIPP output buffer
+* @param cam_mode CMW_MODE_CONTINUOUS or CMW_MODE_SNAPSHOT
+*/
+void CameraPipeline_NNPipe_DoubleBufferStart(uint8_t *nn_pipe_dst0, uint8_t *nn_pipe_dst1, uint32_t cam_mode)
+{
+  int ret;
+
+  nn_pipe_buffers[0] = nn_pipe_dst0;
+  nn_pipe_buffers[1] = nn_pipe_dst1;
+  nn_pipe_last_frame_idx = 1;
+  nn_pipe_next_frame_idx = 0;
+  nn_pipe_seqs[0] = NN_PIPE_SEQ_WRITING;
+  nn_pipe_seqs[1] = NN_PIPE_SEQ_WRITING;
+
+  ret = CMW_CAMERA_DoubleBufferStart(DCMIPP_PIPE2, nn_pipe_dst0, nn_pipe_dst1, cam_mode);
+  assert(ret == CMW_ERROR_NONE);
+}
+
+/**
+* @brief Return the NN pipe buffer holding the most recently completed frame
+* @param seq sequence number of the frame
+* @note DCMIPP is already writing the other buffer, so the returned one stays
+*       untouched for about a frame period: once read, the frame is only
+*       whole if CameraPipeline_NNPipe_GetFrameSeq() still returns seq
+*/
+uint8_t *CameraPipeline_NNPipe_GetLastFrame(uint32_t *seq)
+{
+  Roi_t roi;
+
+  return CameraPipeline_NNPipe_GetLastFrameRoi(&roi, seq);
+}
+
+/**
+* @brief Return the NN pipe buffer holding the most recently completed frame and the region of the camera frame it holds
+* @param roi region captured, in full frame coordinates
+* @param seq sequence number of the frame
+*/
+uint8_t *CameraPipeline_NNPipe_GetLastFrameRoi(Roi_t *roi, uint32_t *seq)
+{
+  uint32_t primask;
+  uint32_t idx;
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  idx = nn_pipe_last_frame_idx;
+  *roi = nn_pipe_rois[idx];
+  *seq = nn_pipe_seqs[idx];
+  __set_PRIMASK(primask);
+
+  return nn_pipe_buffers[idx];
+}
+
+/**
+* @brief Sequence number of the frame a NN pipe buffer holds now
+* @param frame buffer returned by CameraPipeline_NNPipe_GetLastFrame()
+* @retval the sequence number returned with it while the frame is whole, another one once DCMIPP may write the buffer
+*/
+uint32_t CameraPipeline_NNPipe_GetFrameSeq(const uint8_t *frame)
+{
+  return nn_pipe_seqs[frame == nn_pipe_buffers[1]];
+}
+
+/**
+* @brief Smallest NN pipe region side: the downsize cannot upscale, the region must be at least the NN input size
+*/
+float32_t CameraPipeline_NNPipe_GetMinRoiSize(void)
+{
+  float32_t min_width = (float32_t) NN_WIDTH / nn_pipe_full_area.width;
+  float32_t min_height = (float32_t) NN_HEIGHT / nn_pipe_full_area.height;
+
+  return min_width > min_height ? min_width : min_height;
+}
+
+/**
+* @brief Zoom the NN pipe into a region of the camera frame, from the next frame captured
+* @param roi region in full frame coordinates, at least CameraPipeline_NNPipe_GetMinRoiSize()
+* @note Ignored while no edge of the region moves by more than NN_ROI_DEAD_BAND sensor pixels from the zoom
+*       programmed: each new zoom changes the whole NN input, which the motion metric of the inference rate sees
+*/
+void CameraPipeline_NNPipe_SetRoi(const Roi_t *roi)
+{
+  CMW_DCMIPP_Conf_t dcmipp_conf = nn_pipe_conf;
+  CMW_Manual_roi_area_t *area = &dcmipp_conf.manual_conf;
+  DCMIPP_CropConfTypeDef crop_conf = {0};
+  DCMIPP_DecimationConfTypeDef dec_conf;
+  DCMIPP_DownsizeTypeDef down_conf;
+  Roi_Pixels_t pixels;
+  Roi_t captured;
+  uint32_t primask;
+
+  /* Sensor pixels within the area output without zoom, and region actually captured after rounding to pixels */
+  Roi_ToPixels(roi, nn_pipe_full_area.width, nn_pipe_full_area.height, NN_WIDTH, NN_HEIGHT, &pixels, &captured);
+  if (!Roi_PixelsMoved(&nn_pipe_pixels, &pixels, NN_ROI_DEAD_BAND))
+    return;
+  nn_pipe_pixels = pixels;
+  area->width = pixels.width;
+  area->height = pixels.height;
+  area->offset_x = nn_pipe_full_area.offset_x + pixels.x0;
+  area->offset_y = nn_pipe_full_area.offset_y + pixels.y0;
+  CMW_UTILS_GetPipeConfig(nn_pipe_cam_width, nn_pipe_cam_height, &dcmipp_conf, &crop_conf, &dec_conf, &down_conf);
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  nn_pipe_zoom.crop = crop_conf;
+  nn_pipe_zoom.dec = dec_conf;
+  nn_pipe_zoom.down = down_conf;
+  nn_pipe_zoom.roi = captured;
+  nn_pipe_zoom_pending = 1;
+  __set_PRIMASK(primask);
+}
+
 void CameraPipeline_DisplayPipe_Stop()
 {
   int ret;
@@ -177,11 +402,40 @@ void CameraPipeline_IspUpdate(void)
   * @param  hdcmipp pointer to the DCMIPP handle
   * @retval None
   */
+int CMW_CAMERA_PIPE_VsyncEventCallback(uint32_t pipe)
+{
+  /* Start of a NN pipe frame */
+  if (pipe == DCMIPP_PIPE2)
+    LatencyTrace_Begin(LATENCY_STAGE_CAPTURE);
+  return 0;
+}
+
 int CMW_CAMERA_PIPE_FrameEventCallback(uint32_t pipe)
 {
   switch (pipe)
   {
     case DCMIPP_PIPE2 :
+      LatencyTrace_End(LATENCY_STAGE_CAPTURE);
+      nn_pipe_last_frame_idx = nn_pipe_next_frame_idx;
+      /* Never NN_PIPE_SEQ_WRITING, even once wrapped */
+      nn_pipe_seq = nn_pipe_seq + 1 == NN_PIPE_SEQ_WRITING ? nn_pipe_seq + 2 : nn_pipe_seq + 1;
+      nn_pipe_seqs[nn_pipe_last_frame_idx] = nn_pipe_seq;
+      /* Snapshot: the pipe stops, the zoom and the region of the next frame are set when it starts again */
+      if (nn_pipe_buffers[1] == NULL)
+      {
+        cameraFrameReceived++;
+        break;
+      }
+      /* DCMIPP writes the other buffer from the next frame start */
+      nn_pipe_next_frame_idx = 1 - nn_pipe_next_frame_idx;
+      nn_pipe_seqs[nn_pipe_next_frame_idx] = NN_PIPE_SEQ_WRITING;
+      /* Between two frames: the new zoom is taken into account from the next frame start */
+      if (nn_pipe_zoom_pending)
+      {
+        DCMIPP_PipeApplyNnZoom();
+        nn_pipe_zoom_pending = 0;
+      }
+      nn_pipe_rois[nn_pipe_next_frame_idx] = nn_pipe_roi;
       cameraFrameReceived++;
       break;
   }
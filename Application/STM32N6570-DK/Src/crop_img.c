@@ -17,6 +17,10 @@
  */
 #include "crop_img.h"
 #include <assert.h>
+#if defined(__ARM_FEATURE_MVE) && (__ARM_FEATURE_MVE & 1)
+#include <arm_mve.h>
+#define IMG_CROP_USE_MVEI
+#endif
 
 void img_crop(uint8_t *src_image, uint8_t *dst_img, const uint32_t src_stride,
               const uint16_t dst_width, const uint16_t height,
@@ -32,4 +36,54 @@ void img_crop(uint8_t *src_image, uint8_t *dst_img, const uint32_t src_stride,
     memcpy(pOut, pIn + (i * src_stride), dst_line_size);
     pOut += dst_line_size;
   }
-}
\ No newline at end of file
+}
+
+static void img_crop_copy(uint8_t *dst, const uint8_t *src, uint32_t size)
+{
+#if defined(IMG_CROP_USE_MVEI)
+  int32_t remaining = (int32_t) size;
+
+  /* Two vectors per iteration, the last ones tail predicated */
+  while (remaining > 16)
+  {
+    mve_pred16_t p = vctp8q((uint32_t) (remaining - 16));
+    uint8x16_t v0 = vld1q_u8(src);
+    uint8x16_t v1 = vld1q_z_u8(src + 16, p);
+
+    vst1q_u8(dst, v0);
+    vst1q_p_u8(dst + 16, v1, p);
+    src += 32;
+    dst += 32;
+    remaining -= 32;
+  }
+  if (remaining > 0)
+  {
+    mve_pred16_t p = vctp8q((uint32_t) remaining);
+
+    vst1q_p_u8(dst, vld1q_z_u8(src, p), p);
+  }
+#else
+  memcpy(dst, src, size);
+#endif
+}
+
+void img_crop_mve(const uint8_t *src_image, uint8_t *dst_img, const uint32_t src_stride,
+                  const uint16_t dst_width, const uint16_t dst_height,
+                  const uint16_t dst_bpp)
+{
+  const uint32_t dst_line_size = (dst_width * dst_bpp);
+
+  /* Nothing to crop: one contiguous copy */
+  if (src_stride == dst_line_size)
+  {
+    img_crop_copy(dst_img, src_image, dst_line_size * dst_height);
+    return;
+  }
+
+  for (uint32_t i = 0; i < dst_height; i++)
+  {
+    img_crop_copy(dst_img, src_image, dst_line_size);
+    src_image += src_stride;
+    dst_img += dst_line_size;
+  }
+}
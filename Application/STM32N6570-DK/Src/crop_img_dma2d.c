@@ -0,0 +1,115 @@
+/**
+ ******************************************************************************
+ * @file    crop_img_dma2d.c
+ * @brief   DMA2D back-end of img_crop: one interrupt driven memory to memory
+ *          transfer, the cropped part of each source line skipped through the
+ *          foreground line offset
+ ******************************************************************************
+ */
+
+#include "crop_img.h"
+#include "stm32n6xx_hal.h"
+#include "stm32n6xx_ll_dma2d.h"
+
+/* Line offsets and widths in pixels */
+#define DMA2D_MAX_LINE_OFFSET   0xFFFFU
+#define DMA2D_MAX_WIDTH         0x3FFFU
+
+/* Copy in flight */
+static volatile int dma2d_busy;
+static struct {
+  img_crop_done_cb_t done_cb;
+  void *done_arg;
+} dma2d_copy;
+
+/* M2M transfers do not convert: the foreground color mode only gives the pixel size */
+static int img_crop_dma2d_color_mode(uint16_t bpp, uint32_t *input_mode, uint32_t *output_mode)
+{
+  switch (bpp)
+  {
+  case 1:
+    *input_mode = LL_DMA2D_INPUT_MODE_L8;
+    *output_mode = LL_DMA2D_OUTPUT_MODE_ARGB8888;
+    return 0;
+  case 2:
+    *input_mode = LL_DMA2D_INPUT_MODE_RGB565;
+    *output_mode = LL_DMA2D_OUTPUT_MODE_RGB565;
+    return 0;
+  case 3:
+    *input_mode = LL_DMA2D_INPUT_MODE_RGB888;
+    *output_mode = LL_DMA2D_OUTPUT_MODE_RGB888;
+    return 0;
+  case 4:
+    *input_mode = LL_DMA2D_INPUT_MODE_ARGB8888;
+    *output_mode = LL_DMA2D_OUTPUT_MODE_ARGB8888;
+    return 0;
+  default:
+    return -1;
+  }
+}
+
+int img_crop_dma2d_start(const uint8_t *src_image, uint8_t *dst_img, const uint32_t src_stride,
+                         const uint16_t dst_width, const uint16_t dst_height, const uint16_t bpp,
+                         img_crop_done_cb_t done_cb, void *done_arg)
+{
+  uint32_t input_mode, output_mode;
+  uint32_t src_offset;
+
+  if (dma2d_busy || img_crop_dma2d_color_mode(bpp, &input_mode, &output_mode))
+    return -1;
+  /* The line offset counts whole pixels */
+  if (src_stride % bpp || src_stride < (uint32_t) dst_width * bpp || dst_width > DMA2D_MAX_WIDTH)
+    return -1;
+  src_offset = src_stride / bpp - dst_width;
+  if (src_offset > DMA2D_MAX_LINE_OFFSET)
+    return -1;
+
+  dma2d_copy.done_cb = done_cb;
+  dma2d_copy.done_arg = done_arg;
+  dma2d_busy = 1;
+
+  LL_DMA2D_SetMode(DMA2D, LL_DMA2D_MODE_M2M);
+  LL_DMA2D_FGND_SetMemAddr(DMA2D, (uint32_t) src_image);
+  LL_DMA2D_FGND_SetLineOffset(DMA2D, src_offset);
+  LL_DMA2D_FGND_SetColorMode(DMA2D, input_mode);
+  LL_DMA2D_SetOutputColorMode(DMA2D, output_mode);
+  LL_DMA2D_SetOutputMemAddr(DMA2D, (uint32_t) dst_img);
+  LL_DMA2D_SetLineOffset(DMA2D, 0);
+  LL_DMA2D_SetNbrOfPixelsPerLines(DMA2D, dst_width);
+  LL_DMA2D_SetNbrOfLines(DMA2D, dst_height);
+
+  LL_DMA2D_EnableIT_TC(DMA2D);
+  LL_DMA2D_EnableIT_TE(DMA2D);
+  LL_DMA2D_EnableIT_CE(DMA2D);
+  LL_DMA2D_Start(DMA2D);
+
+  return 0;
+}
+
+int img_crop_dma2d_busy(void)
+{
+  return dma2d_busy;
+}
+
+void img_crop_dma2d_wait(void)
+{
+  while (dma2d_busy)
+    ;
+}
+
+void img_crop_dma2d_irq_handler(void)
+{
+  int error = LL_DMA2D_IsActiveFlag_TE(DMA2D) || LL_DMA2D_IsActiveFlag_CE(DMA2D);
+
+  LL_DMA2D_ClearFlag_TC(DMA2D);
+  LL_DMA2D_ClearFlag_TE(DMA2D);
+  LL_DMA2D_ClearFlag_CE(DMA2D);
+  LL_DMA2D_DisableIT_TC(DMA2D);
+  LL_DMA2D_DisableIT_TE(DMA2D);
+  LL_DMA2D_DisableIT_CE(DMA2D);
+
+  /* On an error, the caller copies the frame by CPU: not from the interrupt, where the whole frame would be copied */
+  dma2d_busy = 0;
+  if (dma2d_copy.done_cb)
+    dma2d_copy.done_cb(dma2d_copy.done_arg, error);
+}
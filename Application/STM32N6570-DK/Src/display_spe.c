@@ -19,7 +19,7 @@
 #include "display_spe.h"
 #include "app_config.h"
 #include "main.h"
-#if POSTPROCESS_TYPE == POSTPROCESS_SPE_MOVENET_UF
+#if POSTPROCESS_TYPE == POSTPROCESS_SPE_MOVENET_UF || POSTPROCESS_TYPE == POSTPROCESS_SPE_MOVENET_UI
   #if AI_POSE_PP_POSE_KEYPOINTS_NB == 17
     #include "display_keypoints_17.h"
   #elif AI_POSE_PP_POSE_KEYPOINTS_NB == 13
@@ -37,6 +37,16 @@ static int (*clamp_point)(int *x, int *y);
 static void (*convert_length)(float32_t wi, float32_t hi, int *wo, int *ho);
 static void (*convert_point)(float32_t xi, float32_t yi, int *xo, int *yo);
 static void (*Display_binding_line)(int x0, int y0, int x1, int y1, uint32_t color);
+/* Bounding box of what the last Display_spe_Detection() call has drawn */
+static int drawn_x0, drawn_y0, drawn_x1, drawn_y1;
+
+static void Display_extend_drawn_area(int x, int y, int margin)
+{
+  drawn_x0 = MIN(drawn_x0, x - margin);
+  drawn_y0 = MIN(drawn_y0, y - margin);
+  drawn_x1 = MAX(drawn_x1, x + margin + 1);
+  drawn_y1 = MAX(drawn_y1, y + margin + 1);
+}
 
 static void Display_keypoint(spe_pp_outBuffer_t *key, uint32_t color)
 {
@@ -58,7 +68,8 @@ static void Display_keypoint(spe_pp_outBuffer_t *key, uint32_t color)
   if (is_clamp)
     return ;
 
-  UTIL_LCD_FillCircle(x, y, CIRCLE_RADIUS, color);
+  OverlayDraw_FillCircle(&lcd_fg_overlay, x, y, CIRCLE_RADIUS, color);
+  Display_extend_drawn_area(x, y, CIRCLE_RADIUS);
 }
 
 static void Display_binding(spe_pp_outBuffer_t *from, spe_pp_outBuffer_t *to, uint32_t color)
@@ -66,7 +77,6 @@ static void Display_binding(spe_pp_outBuffer_t *from, spe_pp_outBuffer_t *to, ui
   int is_clamp;
   int x0, y0;
   int x1, y1;
-  int i;
 
   assert(BINDING_WIDTH % 2 == 1);
 
@@ -85,16 +95,10 @@ static void Display_binding(spe_pp_outBuffer_t *from, spe_pp_outBuffer_t *to, ui
   if (is_clamp)
     return ;
 
-  UTIL_LCD_DrawLine(x0, y0, x1, y1, color);
-  for (i = 1; i <= (BINDING_WIDTH - 1) / 2; i++) {
-    if (abs(y1 - y0) > abs(x1 - x0)) {
-      Display_binding_line(x0 + i, y0, x1 + i , y1, color);
-      Display_binding_line(x0 - i, y0, x1 - i , y1, color);
-    } else {
-      Display_binding_line(x0, y0 + i, x1 , y1 + i, color);
-      Display_binding_line(x0, y0 - i, x1 , y1 - i, color);
-    }
-  }
+  /* BINDING_WIDTH thick line */
+  Display_binding_line(x0, y0, x1, y1, color);
+  Display_extend_drawn_area(x0, y0, (BINDING_WIDTH - 1) / 2);
+  Display_extend_drawn_area(x1, y1, (BINDING_WIDTH - 1) / 2);
 }
 
 void Display_spe_InitFunctions(int clamp_point_init(int *x, int *y),
@@ -112,8 +116,26 @@ void Display_spe_Detection(spe_pp_outBuffer_t *detect)
 {
   int i;
 
+  drawn_x0 = INT32_MAX;
+  drawn_y0 = INT32_MAX;
+  drawn_x1 = INT32_MIN;
+  drawn_y1 = INT32_MIN;
+
   for (i = 0; i < ARRAY_NB(bindings); i++)
     Display_binding(&detect[bindings[i][0]], &detect[bindings[i][1]], bindings[i][2]);
   for (i = 0; i < AI_POSE_PP_POSE_KEYPOINTS_NB; i++)
     Display_keypoint(&detect[i], kp_color[i]);
 }
+
+int Display_spe_GetDrawnArea(int *x0, int *y0, int *x1, int *y1)
+{
+  if (drawn_x1 <= drawn_x0 || drawn_y1 <= drawn_y0)
+    return 0;
+
+  *x0 = drawn_x0;
+  *y0 = drawn_y0;
+  *x1 = drawn_x1;
+  *y1 = drawn_y1;
+
+  return 1;
+}
@@ -9,218 +9,201 @@
 #include "gesture_detection.h"
 #include "main.h"
 #include "display_spe.h"
+#include <assert.h>
 #include <math.h>
 #include <string.h>
 
 
-void Gesture_Init(GestureDetector_t *detector)
-{
-    memset(detector, 0, sizeof(GestureDetector_t));
-    detector->last_detected_gesture = GESTURE_NONE;
-    detector->current_display_gesture = GESTURE_NONE;
-    detector->gesture_display_timeout = 0;
-}
-
-float32_t Gesture_CalculateDistance(float32_t x1, float32_t y1, float32_t x2, float32_t y2)
-{
-    float32_t dx = x2 - x1;
-    float32_t dy = y2 - y1;
-    return sqrtf(dx * dx + dy * dy);
-}
-
-float32_t Gesture_CalculateSpeed(KeypointHistory_t *history, uint8_t current_idx, uint8_t frames_back)
-{
-    if (frames_back >= GESTURE_HISTORY_SIZE) return 0.0f;
-
-    uint8_t prev_idx = (current_idx - frames_back + GESTURE_HISTORY_SIZE) % GESTURE_HISTORY_SIZE;
-
-    float32_t distance = Gesture_CalculateDistance(
-        history[prev_idx].x, history[prev_idx].y,
-        history[current_idx].x, history[current_idx].y
-    );
-
-    uint32_t time_diff = history[current_idx].timestamp - history[prev_idx].timestamp;
-    if (time_diff == 0) return 0.0f;
-
-    return distance / (time_diff / 1000.0f); // Speed per second
-}
-
-static GestureType_t Detect_ArmSwipe(GestureDetector_t *detector, spe_pp_outBuffer_t *keypoints)
-{
-    uint8_t curr_idx = detector->history_index;
-    uint8_t prev_idx = (curr_idx - 4 + GESTURE_HISTORY_SIZE) % GESTURE_HISTORY_SIZE;
-
+#define COND(t, a, b, w, c, th) { { (t), (a), (b), (w) }, (c), (th) }
+
+// Gestures in priority order: the first one whose conditions all hold is reported
+static const GestureSpec_t gesture_specs[] = {
+    // Overhead strike: hand started above the nose and moved down quickly
+    { GESTURE_SWORD_OVERHEAD_STRIKE, 1000, 6, {
+        COND(GESTURE_FEATURE_CONFIDENCE, KEYPOINT_RIGHT_WRIST, 0, 0, GESTURE_CMP_GT, MIN_CONFIDENCE),
+        COND(GESTURE_FEATURE_CONFIDENCE, KEYPOINT_RIGHT_SHOULDER, 0, 0, GESTURE_CMP_GT, MIN_CONFIDENCE),
+        COND(GESTURE_FEATURE_CONFIDENCE, KEYPOINT_RIGHT_ELBOW, 0, 0, GESTURE_CMP_GT, MIN_CONFIDENCE),
+        COND(GESTURE_FEATURE_HEIGHT_ABOVE, KEYPOINT_RIGHT_WRIST, KEYPOINT_NOSE, 12, GESTURE_CMP_GT, 0.0f),
+        COND(GESTURE_FEATURE_DY, KEYPOINT_RIGHT_WRIST, 0, 12, GESTURE_CMP_GT, 0.25f),
+        COND(GESTURE_FEATURE_SPEED, KEYPOINT_RIGHT_WRIST, 0, 5, GESTURE_CMP_GT, SWIPE_MIN_SPEED * 1.5f),
+    } },
+    // Side slash: horizontal movement with extended arm
+    { GESTURE_SWORD_SIDE_SLASH, 1000, 6, {
+        COND(GESTURE_FEATURE_CONFIDENCE, KEYPOINT_RIGHT_WRIST, 0, 0, GESTURE_CMP_GT, MIN_CONFIDENCE),
+        COND(GESTURE_FEATURE_CONFIDENCE, KEYPOINT_RIGHT_SHOULDER, 0, 0, GESTURE_CMP_GT, MIN_CONFIDENCE),
+        COND(GESTURE_FEATURE_CONFIDENCE, KEYPOINT_RIGHT_ELBOW, 0, 0, GESTURE_CMP_GT, MIN_CONFIDENCE),
+        COND(GESTURE_FEATURE_DX, KEYPOINT_RIGHT_WRIST, 0, 12, GESTURE_CMP_ABS_GT, 0.2f),
+        COND(GESTURE_FEATURE_DISTANCE, KEYPOINT_RIGHT_WRIST, KEYPOINT_RIGHT_SHOULDER, 0, GESTURE_CMP_GT, 0.25f),
+        COND(GESTURE_FEATURE_SPEED, KEYPOINT_RIGHT_WRIST, 0, 3, GESTURE_CMP_GT, SWIPE_MIN_SPEED),
+    } },
     /***** Right now I am deactivating the right arm swipe, so that is not confounded with the sword gestures */
     /*
-    	// Check right arm swipe
-    KeypointHistory_t *right_wrist = detector->history[KEYPOINT_RIGHT_WRIST];
-    KeypointHistory_t *right_shoulder = detector->history[KEYPOINT_RIGHT_SHOULDER];
-
-    if (right_wrist[curr_idx].confidence > MIN_CONFIDENCE
-    		//&& right_shoulder[curr_idx].confidence > MIN_CONFIDENCE
-		) {
-
-        // Calculate horizontal movement of wrist
-        float32_t wrist_dx = right_wrist[curr_idx].x - right_wrist[prev_idx].x;
-        float32_t wrist_speed = Gesture_CalculateSpeed(right_wrist, curr_idx, 3);
-        float32_t current_x_pos= right_wrist[curr_idx].x;
-		float32_t prev_x_pos = right_wrist[prev_idx].x;
-//	  UTIL_LCD_SetBackColor(0x40000000);
-//        UTIL_LCDEx_PrintfAt(0, LINE(13), CENTER_MODE, "curr_x %.3f, prev_x: %.3f", current_x_pos, prev_x_pos);
-//        UTIL_LCDEx_PrintfAt(0, LINE(14), CENTER_MODE, "n_dx: %.3f, n_sp: %.3f", wrist_dx, wrist_speed);
-//        UTIL_LCD_SetBackColor(0);
-
-        // Check if wrist is moving significantly horizontally
-        if (fabsf(wrist_dx) > 0.05f && wrist_speed > SWIPE_MIN_SPEED) {
-            // Check if arm is extended (wrist far from shoulder)
-        //    float32_t arm_extension = Gesture_CalculateDistance(
-        //        right_wrist[curr_idx].x, right_wrist[curr_idx].y,
-       //         right_shoulder[curr_idx].x, right_shoulder[curr_idx].y
-       //     );
-
-        //    if (arm_extension > 0.2f) { // Arm is extended
-                if (wrist_dx > 0) {
-                    return GESTURE_RIGHT_ARM_SWIPE_RIGHT;
-                } else {
-                    return GESTURE_RIGHT_ARM_SWIPE_LEFT;
-                }
-            //}
+    { GESTURE_RIGHT_ARM_SWIPE_RIGHT, 1000, 3, {
+        COND(GESTURE_FEATURE_CONFIDENCE, KEYPOINT_RIGHT_WRIST, 0, 0, GESTURE_CMP_GT, MIN_CONFIDENCE),
+        COND(GESTURE_FEATURE_DX, KEYPOINT_RIGHT_WRIST, 0, 4, GESTURE_CMP_GT, 0.05f),
+        COND(GESTURE_FEATURE_SPEED, KEYPOINT_RIGHT_WRIST, 0, 3, GESTURE_CMP_GT, SWIPE_MIN_SPEED),
+    } },
+    { GESTURE_RIGHT_ARM_SWIPE_LEFT, 1000, 3, {
+        COND(GESTURE_FEATURE_CONFIDENCE, KEYPOINT_RIGHT_WRIST, 0, 0, GESTURE_CMP_GT, MIN_CONFIDENCE),
+        COND(GESTURE_FEATURE_DX, KEYPOINT_RIGHT_WRIST, 0, 4, GESTURE_CMP_LT, -0.05f),
+        COND(GESTURE_FEATURE_SPEED, KEYPOINT_RIGHT_WRIST, 0, 3, GESTURE_CMP_GT, SWIPE_MIN_SPEED),
+    } },
+    */
+    // Left arm swipes: significant horizontal wrist movement
+    { GESTURE_LEFT_ARM_SWIPE_RIGHT, 1000, 3, {
+        COND(GESTURE_FEATURE_CONFIDENCE, KEYPOINT_LEFT_WRIST, 0, 0, GESTURE_CMP_GT, MIN_CONFIDENCE),
+        COND(GESTURE_FEATURE_DX, KEYPOINT_LEFT_WRIST, 0, 4, GESTURE_CMP_GT, 0.05f),
+        COND(GESTURE_FEATURE_SPEED, KEYPOINT_LEFT_WRIST, 0, 3, GESTURE_CMP_GT, SWIPE_MIN_SPEED),
+    } },
+    { GESTURE_LEFT_ARM_SWIPE_LEFT, 1000, 3, {
+        COND(GESTURE_FEATURE_CONFIDENCE, KEYPOINT_LEFT_WRIST, 0, 0, GESTURE_CMP_GT, MIN_CONFIDENCE),
+        COND(GESTURE_FEATURE_DX, KEYPOINT_LEFT_WRIST, 0, 4, GESTURE_CMP_LT, -0.05f),
+        COND(GESTURE_FEATURE_SPEED, KEYPOINT_LEFT_WRIST, 0, 3, GESTURE_CMP_GT, SWIPE_MIN_SPEED),
+    } },
+};
+
+#define NB_GESTURE_SPECS (sizeof(gesture_specs) / sizeof(gesture_specs[0]))
+
+// Index of a feature in the detector feature list, added if not yet present
+static uint8_t Gesture_RegisterFeature(GestureDetector_t *detector, const GestureFeature_t *feature)
+{
+    for (uint8_t i = 0; i < detector->nb_features; i++) {
+        if (memcmp(&detector->features[i], feature, sizeof(GestureFeature_t)) == 0) {
+            return i;
         }
     }
-    */
+    assert(detector->nb_features < GESTURE_MAX_FEATURES);
+    detector->features[detector->nb_features] = *feature;
+    return detector->nb_features++;
+}
 
-    // Check left arm swipe (similar logic)
-    KeypointHistory_t *left_wrist = detector->history[KEYPOINT_LEFT_WRIST];
-    KeypointHistory_t *left_shoulder = detector->history[KEYPOINT_LEFT_SHOULDER];
-
-    if (left_wrist[curr_idx].confidence > MIN_CONFIDENCE
-    	//	&&  left_shoulder[curr_idx].confidence > MIN_CONFIDENCE
-			) {
-
-        float32_t wrist_dx = left_wrist[curr_idx].x - left_wrist[prev_idx].x;
-        float32_t wrist_speed = Gesture_CalculateSpeed(left_wrist, curr_idx, 3);
-        UTIL_LCDEx_PrintfAt(0, LINE(15), CENTER_MODE, "idx:%d/%d,w_dx: %.3f, w_sp: %.3f", prev_idx, curr_idx, wrist_dx, wrist_speed);
-        if (fabsf(wrist_dx) > 0.05f && wrist_speed > SWIPE_MIN_SPEED) {
-        //    float32_t arm_extension = Gesture_CalculateDistance(
-         //       left_wrist[curr_idx].x, left_wrist[curr_idx].y,
-        //        left_shoulder[curr_idx].x, left_shoulder[curr_idx].y
-        //    );
-
-        //    if (arm_extension > 0.2f) {
-                if (wrist_dx > 0) {
-                    return GESTURE_LEFT_ARM_SWIPE_RIGHT;
-                } else {
-                    return GESTURE_LEFT_ARM_SWIPE_LEFT;
-                }
-          //  }
+// Evaluates every distinct feature once for the latest frame
+static void Gesture_ComputeFeatures(GestureDetector_t *detector)
+{
+    KeypointHistory_t *history = &detector->history;
+
+    for (uint8_t i = 0; i < detector->nb_features; i++) {
+        const GestureFeature_t *f = &detector->features[i];
+        float32_t value = 0.0f;
+        uint8_t valid = KeypointHistory_Has(history, f->window);
+
+        if (valid) {
+            switch (f->type) {
+                case GESTURE_FEATURE_CONFIDENCE:
+                    value = KeypointHistory_Confidence(history, f->kp_a, 0);
+                    break;
+                case GESTURE_FEATURE_DX:
+                    value = KeypointHistory_X(history, f->kp_a, 0) - KeypointHistory_X(history, f->kp_a, f->window);
+                    break;
+                case GESTURE_FEATURE_DY:
+                    value = KeypointHistory_Y(history, f->kp_a, 0) - KeypointHistory_Y(history, f->kp_a, f->window);
+                    break;
+                case GESTURE_FEATURE_SPEED:
+                    value = KeypointHistory_Speed(history, f->kp_a, 0, f->window);
+                    break;
+                case GESTURE_FEATURE_DISTANCE:
+                    value = Gesture_CalculateDistance(
+                        KeypointHistory_X(history, f->kp_a, 0), KeypointHistory_Y(history, f->kp_a, 0),
+                        KeypointHistory_X(history, f->kp_b, 0), KeypointHistory_Y(history, f->kp_b, 0));
+                    break;
+                case GESTURE_FEATURE_HEIGHT_ABOVE:
+                    value = KeypointHistory_Y(history, f->kp_b, f->window) - KeypointHistory_Y(history, f->kp_a, f->window);
+                    break;
+                default:
+                    valid = 0;
+                    break;
+            }
         }
+        detector->feature_values[i] = value;
+        detector->feature_valid[i] = valid;
     }
-
-    return GESTURE_NONE;
 }
 
-static GestureType_t Detect_SwordGestures(GestureDetector_t *detector, spe_pp_outBuffer_t *keypoints)
+static int Gesture_MatchSpec(GestureDetector_t *detector, uint32_t spec_idx)
 {
-    uint8_t curr_idx = detector->history_index;
+    const GestureSpec_t *spec = &gesture_specs[spec_idx];
 
-    KeypointHistory_t *right_wrist = detector->history[KEYPOINT_RIGHT_WRIST];
-    KeypointHistory_t *right_shoulder = detector->history[KEYPOINT_RIGHT_SHOULDER];
-    KeypointHistory_t *right_elbow = detector->history[KEYPOINT_RIGHT_ELBOW];
-    KeypointHistory_t *nose = detector->history[KEYPOINT_NOSE];
-
-    if (right_wrist[curr_idx].confidence < MIN_CONFIDENCE ||
-        right_shoulder[curr_idx].confidence < MIN_CONFIDENCE ||
-        right_elbow[curr_idx].confidence < MIN_CONFIDENCE) {
-        return GESTURE_NONE;
-    }
+    for (uint8_t c = 0; c < spec->nb_conditions; c++) {
+        uint8_t f = detector->condition_feature[spec_idx][c];
+        float32_t value = detector->feature_values[f];
+        float32_t threshold = spec->conditions[c].threshold;
 
-    // Overhead strike: Check if hand moves from high to low rapidly
-    if (curr_idx >= 12) { // Need some history
-        uint8_t start_idx = (curr_idx - 12 + GESTURE_HISTORY_SIZE) % GESTURE_HISTORY_SIZE;
+        if (!detector->feature_valid[f]) return 0;
 
-        float32_t start_y = right_wrist[start_idx].y;
-        float32_t curr_y = right_wrist[curr_idx].y;
-        float32_t vertical_movement = curr_y - start_y;
-        float32_t start_nose = nose[start_idx].y;
-
-        // Check if hand started anove the nose and moved down quickly
-        if (start_y < start_nose && vertical_movement > 0.25f) { // Started high, moved down
-            float32_t speed = Gesture_CalculateSpeed(right_wrist, curr_idx, 5);
-            if (speed > SWIPE_MIN_SPEED * 1.5f) {
-                return GESTURE_SWORD_OVERHEAD_STRIKE;
-            }
+        switch (spec->conditions[c].cmp) {
+            case GESTURE_CMP_GT:     if (!(value > threshold)) return 0; break;
+            case GESTURE_CMP_LT:     if (!(value < threshold)) return 0; break;
+            case GESTURE_CMP_ABS_GT: if (!(fabsf(value) > threshold)) return 0; break;
+            default:                 return 0;
         }
     }
 
-    // Side slash: Check for horizontal movement with extended arm
-    if (curr_idx >= 12) {
-        uint8_t start_idx = (curr_idx - 12 + GESTURE_HISTORY_SIZE) % GESTURE_HISTORY_SIZE;
+    return 1;
+}
 
-        float32_t horizontal_movement = fabsf(right_wrist[curr_idx].x - right_wrist[start_idx].x);
-        float32_t arm_extension = Gesture_CalculateDistance(
-            right_wrist[curr_idx].x, right_wrist[curr_idx].y,
-            right_shoulder[curr_idx].x, right_shoulder[curr_idx].y
-        );
+void Gesture_Init(GestureDetector_t *detector)
+{
+    memset(detector, 0, sizeof(GestureDetector_t));
+    KeypointHistory_Init(&detector->history);
+    detector->last_detected_gesture = GESTURE_NONE;
+    detector->current_display_gesture = GESTURE_NONE;
+    detector->gesture_display_timeout = 0;
 
-        if (horizontal_movement > 0.2f && arm_extension > 0.25f) {
-            float32_t speed = Gesture_CalculateSpeed(right_wrist, curr_idx, 3);
-            if (speed > SWIPE_MIN_SPEED) {
-                return GESTURE_SWORD_SIDE_SLASH;
-            }
+    // Collect the distinct features of all the gestures
+    assert(NB_GESTURE_SPECS <= GESTURE_MAX_SPECS);
+    for (uint32_t g = 0; g < NB_GESTURE_SPECS; g++) {
+        assert(gesture_specs[g].nb_conditions <= GESTURE_MAX_CONDITIONS);
+        for (uint8_t c = 0; c < gesture_specs[g].nb_conditions; c++) {
+            detector->condition_feature[g][c] = Gesture_RegisterFeature(detector, &gesture_specs[g].conditions[c].feature);
         }
     }
+}
 
-    return GESTURE_NONE;
+float32_t Gesture_CalculateDistance(float32_t x1, float32_t y1, float32_t x2, float32_t y2)
+{
+    float32_t dx = x2 - x1;
+    float32_t dy = y2 - y1;
+    return sqrtf(dx * dx + dy * dy);
+}
+
+float32_t Gesture_CalculateSpeed(const GestureDetector_t *detector, uint32_t keypoint, uint32_t frames_back)
+{
+    return KeypointHistory_Speed(&detector->history, keypoint, 0, frames_back);
 }
 
 GestureType_t Gesture_Detect(GestureDetector_t *detector, spe_pp_outBuffer_t *keypoints)
 {
     uint32_t current_time = HAL_GetTick();
 
-    // Advance history index
-    detector->history_index = (detector->history_index + 1) % GESTURE_HISTORY_SIZE;
-
-
     // Update history with current keypoints
-    for (int i = 0; i < AI_POSE_PP_POSE_KEYPOINTS_NB; i++) {
-        detector->history[i][detector->history_index].x = keypoints[i].x_center;
-        detector->history[i][detector->history_index].y = keypoints[i].y_center;
-        detector->history[i][detector->history_index].confidence = keypoints[i].proba;
-        detector->history[i][detector->history_index].timestamp = current_time;
+    KeypointHistory_Push(&detector->history, keypoints, current_time);
+
+    // Left wrist debug trace
+    if (KeypointHistory_Confidence(&detector->history, KEYPOINT_LEFT_WRIST, 0) > MIN_CONFIDENCE) {
+        OverlayDraw_PrintfAt(&lcd_fg_overlay, 0, LINE(15), OVERLAY_DRAW_ALIGN_CENTER, "idx:%d/%d,w_dx: %.3f, w_sp: %.3f",
+                             (int) KeypointHistory_Slot(&detector->history, 4), (int) KeypointHistory_Slot(&detector->history, 0),
+                             KeypointHistory_X(&detector->history, KEYPOINT_LEFT_WRIST, 0) - KeypointHistory_X(&detector->history, KEYPOINT_LEFT_WRIST, 4),
+                             KeypointHistory_Speed(&detector->history, KEYPOINT_LEFT_WRIST, 0, 3));
     }
 
+    // All the gestures are evaluated on the same set of features
+    Gesture_ComputeFeatures(detector);
 
-
-    // Prevent detecting same gesture too quickly
-    if (current_time - detector->last_gesture_time < 1000) { // 1 second cooldown
-        return GESTURE_NONE;
-    }
-
-    // Try different gesture detection algorithms
-    GestureType_t detected_gesture = GESTURE_NONE;
-
-    // Check for sword gestures
-    detected_gesture = Detect_SwordGestures(detector, keypoints);
-    if (detected_gesture != GESTURE_NONE) {
-        detector->last_detected_gesture = detected_gesture;
-        detector->last_gesture_time = current_time;
-        detector->current_display_gesture = detected_gesture;
-        detector->gesture_display_timeout = current_time + GESTURE_DISPLAY_TIME;
-        return detected_gesture;
-    }
-
-    // Check for arm swipes
-    detected_gesture = Detect_ArmSwipe(detector, keypoints);
-    if (detected_gesture != GESTURE_NONE) {
-        detector->last_detected_gesture = detected_gesture;
-        detector->last_gesture_time = current_time;
-        detector->current_display_gesture = detected_gesture;
-        detector->gesture_display_timeout = current_time + GESTURE_DISPLAY_TIME;
-        return detected_gesture;
+    for (uint32_t g = 0; g < NB_GESTURE_SPECS; g++) {
+        // Prevent detecting same gesture too quickly
+        if (current_time - detector->last_gesture_time < gesture_specs[g].cooldown_ms) {
+            continue;
+        }
+        if (Gesture_MatchSpec(detector, g)) {
+            GestureType_t detected_gesture = gesture_specs[g].gesture;
+            detector->last_detected_gesture = detected_gesture;
+            detector->last_gesture_time = current_time;
+            detector->current_display_gesture = detected_gesture;
+            detector->gesture_display_timeout = current_time + GESTURE_DISPLAY_TIME;
+            return detected_gesture;
+        }
     }
 
-
-
     return GESTURE_NONE;
 }
 
@@ -250,6 +233,26 @@ GestureType_t Gesture_GetCurrentDisplayGesture(GestureDetector_t *detector)
     return detector->current_display_gesture;
 }
 
+float32_t Gesture_MaxKeypointSpeed(const GestureDetector_t *detector, uint32_t frames)
+{
+    const KeypointHistory_t *history = &detector->history;
+    float32_t speed[AI_POSE_PP_POSE_KEYPOINTS_NB];
+    float32_t max_speed = 0.0f;
+
+    // Gesture_CalculateSpeed() of all the keypoints at once
+    KeypointHistory_SpeedAll(history, frames, speed);
+    for (int i = 0; i < AI_POSE_PP_POSE_KEYPOINTS_NB; i++) {
+        // Keypoints appearing or vanishing jump, they do not move
+        if (KeypointHistory_Confidence(history, i, 0) <= MIN_CONFIDENCE ||
+            KeypointHistory_Confidence(history, i, frames) <= MIN_CONFIDENCE)
+            continue;
+        if (speed[i] > max_speed)
+            max_speed = speed[i];
+    }
+
+    return max_speed;
+}
+
 void Gesture_GetKeypointDebugInfo(GestureDetector_t *detector, uint8_t keypoint_idx,
                                   float32_t *current_x, float32_t *current_y,
                                   float32_t *current_confidence, float32_t *current_speed)
@@ -262,16 +265,13 @@ void Gesture_GetKeypointDebugInfo(GestureDetector_t *detector, uint8_t keypoint_
         return;
     }
 
-    // Get current index (last updated position)
-    uint8_t curr_idx = (detector->history_index + GESTURE_HISTORY_SIZE) % GESTURE_HISTORY_SIZE;
-
     // Get current keypoint data
-    *current_x = detector->history[keypoint_idx][curr_idx].x;
-    *current_y = detector->history[keypoint_idx][curr_idx].y;
-    *current_confidence = detector->history[keypoint_idx][curr_idx].confidence;
+    *current_x = KeypointHistory_X(&detector->history, keypoint_idx, 0);
+    *current_y = KeypointHistory_Y(&detector->history, keypoint_idx, 0);
+    *current_confidence = KeypointHistory_Confidence(&detector->history, keypoint_idx, 0);
 
     // Calculate speed over last 3 frames
-    *current_speed = Gesture_CalculateSpeed(detector->history[keypoint_idx], curr_idx, 3);
+    *current_speed = KeypointHistory_Speed(&detector->history, keypoint_idx, 0, 3);
 }
 
 
@@ -287,15 +287,12 @@ void Gesture_GetPastKeypointDebugInfo(GestureDetector_t *detector, uint8_t keypo
         return;
     }
 
-    // Get past index (using past_keypoint_offset)
-    uint8_t read_idx = (detector->history_index - past_keypoint_offset+ GESTURE_HISTORY_SIZE) % GESTURE_HISTORY_SIZE;
-
-    // Get that keypoint's data
-    *current_x = detector->history[keypoint_idx][read_idx].x;
-    *current_y = detector->history[keypoint_idx][read_idx].y;
-    *current_confidence = detector->history[keypoint_idx][read_idx].confidence;
+    // Get that keypoint's data (past_keypoint_offset frames back)
+    *current_x = KeypointHistory_X(&detector->history, keypoint_idx, past_keypoint_offset);
+    *current_y = KeypointHistory_Y(&detector->history, keypoint_idx, past_keypoint_offset);
+    *current_confidence = KeypointHistory_Confidence(&detector->history, keypoint_idx, past_keypoint_offset);
 
     // Calculate speed over last 3 frames
-    *current_speed = Gesture_CalculateSpeed(detector->history[keypoint_idx], read_idx, 3);
+    *current_speed = KeypointHistory_Speed(&detector->history, keypoint_idx, past_keypoint_offset, 3);
 }
 
@@ -0,0 +1,112 @@
+/**
+ ******************************************************************************
+ * @file    inference_rate.c
+ * @brief   Inference rate following the motion of the scene and of the
+ *          keypoints
+ ******************************************************************************
+ */
+
+#include "inference_rate.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#define GRID INFERENCE_RATE_GRID
+
+void InferenceRate_Init(InferenceRate_t *rate, const InferenceRate_Params_t *params)
+{
+    assert(params->idle_period >= 1);
+
+    rate->params = *params;
+    rate->frames = 0;
+    rate->inferences = 0;
+    InferenceRate_Reset(rate);
+}
+
+void InferenceRate_Reset(InferenceRate_t *rate)
+{
+    rate->has_thumbnail = 0;
+    rate->static_frames = 0;
+    rate->skipped = 0;
+    rate->speed = 0.0f;
+}
+
+// Luma approximation, (R + 2G + B) / 4 without the channel order mattering for RGB888 and ARGB8888
+static uint8_t InferenceRate_Luma(const uint8_t *pixel, uint16_t bpp)
+{
+    uint16_t rgb565;
+
+    switch (bpp) {
+    case 1:
+        return pixel[0];
+    case 2:
+        // Green channel alone
+        rgb565 = pixel[0] | (pixel[1] << 8);
+        return ((rgb565 >> 5) & 0x3F) << 2;
+    default:
+        return (pixel[0] + 2 * pixel[1] + pixel[2]) >> 2;
+    }
+}
+
+uint32_t InferenceRate_Motion(InferenceRate_t *rate, const uint8_t *frame, uint32_t pitch,
+                              uint16_t width, uint16_t height, uint16_t bpp)
+{
+    uint32_t changed = 0;
+
+    for (int j = 0; j < GRID; j++) {
+        // Center of each cell of a GRID x GRID division of the frame
+        const uint8_t *line = frame + (uint32_t) ((2 * j + 1) * height / (2 * GRID)) * pitch;
+
+        for (int i = 0; i < GRID; i++) {
+            uint8_t luma = InferenceRate_Luma(line + (uint32_t) ((2 * i + 1) * width / (2 * GRID)) * bpp, bpp);
+            int diff = luma - rate->thumbnail[j * GRID + i];
+
+            if (diff < 0) diff = -diff;
+            changed += diff > rate->params.pixel_threshold;
+            rate->latest[j * GRID + i] = luma;
+        }
+    }
+
+    return rate->has_thumbnail ? changed : GRID * GRID;
+}
+
+void InferenceRate_SetSpeed(InferenceRate_t *rate, float32_t speed)
+{
+    rate->speed = speed;
+}
+
+int InferenceRate_Decide(InferenceRate_t *rate, uint32_t motion)
+{
+    const InferenceRate_Params_t *params = &rate->params;
+    int moving = motion >= params->motion_samples || rate->speed >= params->speed_threshold;
+
+    rate->frames++;
+    if (moving)
+        rate->static_frames = 0;
+    else if (rate->static_frames < params->hold_frames)
+        rate->static_frames++;
+
+    // Full rate as soon as anything moves, and for a while after
+    if (moving || rate->static_frames < params->hold_frames || ++rate->skipped >= params->idle_period) {
+        rate->skipped = 0;
+        rate->inferences++;
+        // Next frames compared to this one
+        memcpy(rate->thumbnail, rate->latest, sizeof(rate->thumbnail));
+        rate->has_thumbnail = 1;
+        return 1;
+    }
+    return 0;
+}
+
+int InferenceRate_Report(InferenceRate_t *rate, char *buffer, size_t size)
+{
+    int len = snprintf(buffer, size, "nn rate %lu/%lu frames\r\n", (unsigned long) rate->inferences,
+                       (unsigned long) rate->frames);
+
+    rate->frames = 0;
+    rate->inferences = 0;
+    // Truncated output: snprintf() returned the length it would have written
+    if (len < 0)
+        return 0;
+    return (size_t) len < size ? len : (int) size - 1;
+}
@@ -0,0 +1,190 @@
+/**
+ ******************************************************************************
+ * @file    keypoint_filter.c
+ * @brief   Temporal smoothing of the keypoints (One-Euro or constant velocity
+ *          Kalman filter)
+ ******************************************************************************
+ */
+
+#include "keypoint_filter.h"
+#include <string.h>
+
+#define NB_KP AI_POSE_PP_POSE_KEYPOINTS_NB
+
+// Kalman velocity variance of a newly tracked keypoint
+#define KALMAN_INITIAL_VEL_VARIANCE  (1.0f)
+// Lower bound of the elapsed time between frames, keeps speeds within the fixed-point range
+#define MIN_FRAME_PERIOD_MS          (10)
+// Upper bound of the elapsed time between frames, keeps the Kalman dt^3 within the fixed-point range
+#define MAX_FRAME_PERIOD_MS          (1000)
+// One-Euro bounds, beyond any keypoint motion: they keep the speed and the cutoff within the fixed-point range
+#define ONE_EURO_MAX_SPEED           (32.0f)
+#define ONE_EURO_MAX_CUTOFF          (100.0f)
+// Consecutive missed detections after which a keypoint is no longer tracked
+#define MAX_MISSED_FRAMES            (5)
+// Upper bound of the extrapolation, a speed estimate does not hold much longer
+#define MAX_PREDICTION_MS            (200)
+
+void KeypointFilter_Reset(KeypointFilter_t *filter)
+{
+    filter->started = 0;
+    memset(filter->tracked, 0, sizeof(filter->tracked));
+    memset(filter->missed, 0, sizeof(filter->missed));
+    memset(filter->axis, 0, sizeof(filter->axis));
+}
+
+void KeypointFilter_InitOneEuro(KeypointFilter_t *filter, const KeypointFilter_OneEuroParams_t *params, float32_t min_confidence)
+{
+    memset(filter, 0, sizeof(KeypointFilter_t));
+    filter->type = KEYPOINT_FILTER_ONE_EURO;
+    filter->min_cutoff = KPF_FROM_FLOAT(params->min_cutoff);
+    filter->beta = KPF_FROM_FLOAT(params->beta);
+    filter->d_cutoff = KPF_FROM_FLOAT(params->d_cutoff);
+    filter->cutoff_vel_limit = KPF_FROM_FLOAT(ONE_EURO_MAX_SPEED);
+    if (params->beta * ONE_EURO_MAX_SPEED > ONE_EURO_MAX_CUTOFF - params->min_cutoff) {
+        filter->cutoff_vel_limit = KPF_FROM_FLOAT((ONE_EURO_MAX_CUTOFF - params->min_cutoff) / params->beta);
+    }
+    filter->min_confidence = min_confidence;
+}
+
+void KeypointFilter_InitKalman(KeypointFilter_t *filter, const KeypointFilter_KalmanParams_t *params, float32_t min_confidence)
+{
+    memset(filter, 0, sizeof(KeypointFilter_t));
+    filter->type = KEYPOINT_FILTER_KALMAN;
+    filter->process_noise = KPF_FROM_FLOAT(params->process_noise);
+    filter->measurement_noise = KPF_FROM_FLOAT(params->measurement_noise);
+    filter->min_confidence = min_confidence;
+}
+
+// Smoothing factor of a first order low-pass filter: te / (te + 1 / (2 * pi * cutoff))
+static kpf_scalar_t OneEuro_Alpha(kpf_scalar_t te, kpf_scalar_t cutoff)
+{
+    // 1 / (2 * pi) / cutoff: 2 * pi * cutoff exceeds the Q7.24 range above 20 Hz
+    kpf_scalar_t tau = KPF_DIV(KPF_FROM_FLOAT(0.15915494f), cutoff);
+
+    return KPF_DIV(te, te + tau);
+}
+
+static void OneEuro_Update(const KeypointFilter_t *filter, KeypointFilterAxis_t *axis, kpf_scalar_t z, kpf_scalar_t te)
+{
+    kpf_scalar_t speed = KPF_DIV(z - axis->pos, te);
+    kpf_scalar_t max_speed = KPF_FROM_FLOAT(ONE_EURO_MAX_SPEED);
+
+    // Keypoint jumps (detection switching to another person) are not motion
+    speed = speed > max_speed ? max_speed : speed < -max_speed ? -max_speed : speed;
+    axis->vel += KPF_MUL(OneEuro_Alpha(te, filter->d_cutoff), speed - axis->vel);
+
+    kpf_scalar_t abs_vel = KPF_ABS(axis->vel);
+    kpf_scalar_t cutoff = filter->min_cutoff +
+                          KPF_MUL(filter->beta, abs_vel < filter->cutoff_vel_limit ? abs_vel : filter->cutoff_vel_limit);
+    axis->pos += KPF_MUL(OneEuro_Alpha(te, cutoff), z - axis->pos);
+}
+
+static void Kalman_Predict(const KeypointFilter_t *filter, KeypointFilterAxis_t *axis, kpf_scalar_t dt)
+{
+    kpf_scalar_t q = filter->process_noise;
+    kpf_scalar_t dt2 = KPF_MUL(dt, dt);
+    kpf_scalar_t dt3 = KPF_MUL(dt2, dt);
+
+    axis->pos += KPF_MUL(axis->vel, dt);
+
+    // P = F.P.F' + Q, continuous white acceleration noise
+    axis->p00 += KPF_MUL(dt, 2 * axis->p01 + KPF_MUL(dt, axis->p11)) + KPF_DIV(KPF_MUL(q, dt3), KPF_FROM_FLOAT(3.0f));
+    axis->p01 += KPF_MUL(dt, axis->p11) + KPF_MUL(q, dt2) / 2;
+    axis->p11 += KPF_MUL(q, dt);
+}
+
+static void Kalman_Update(const KeypointFilter_t *filter, KeypointFilterAxis_t *axis, kpf_scalar_t z)
+{
+    kpf_scalar_t s = axis->p00 + filter->measurement_noise;
+    kpf_scalar_t k0 = KPF_DIV(axis->p00, s);
+    kpf_scalar_t k1 = KPF_DIV(axis->p01, s);
+    kpf_scalar_t innovation = z - axis->pos;
+
+    axis->pos += KPF_MUL(k0, innovation);
+    axis->vel += KPF_MUL(k1, innovation);
+
+    // P = (I - K.H).P
+    axis->p11 -= KPF_MUL(k1, axis->p01);
+    axis->p01 -= KPF_MUL(k0, axis->p01);
+    axis->p00 -= KPF_MUL(k0, axis->p00);
+}
+
+static void Axis_Start(const KeypointFilter_t *filter, KeypointFilterAxis_t *axis, kpf_scalar_t z)
+{
+    axis->pos = z;
+    axis->vel = 0;
+    axis->p00 = filter->measurement_noise;
+    axis->p01 = 0;
+    axis->p11 = KPF_FROM_FLOAT(KALMAN_INITIAL_VEL_VARIANCE);
+}
+
+void KeypointFilter_Apply(KeypointFilter_t *filter, spe_pp_outBuffer_t *keypoints, uint32_t timestamp_ms)
+{
+    if (filter->type == KEYPOINT_FILTER_NONE) return;
+
+    uint32_t elapsed_ms = filter->started ? timestamp_ms - filter->last_timestamp : 0;
+
+    elapsed_ms = elapsed_ms < MIN_FRAME_PERIOD_MS ? MIN_FRAME_PERIOD_MS : elapsed_ms;
+    elapsed_ms = elapsed_ms > MAX_FRAME_PERIOD_MS ? MAX_FRAME_PERIOD_MS : elapsed_ms;
+    kpf_scalar_t dt = KPF_FROM_MS(elapsed_ms);
+
+    filter->started = 1;
+    filter->last_timestamp = timestamp_ms;
+
+    for (int i = 0; i < NB_KP; i++) {
+        int measured = keypoints[i].proba >= filter->min_confidence;
+        kpf_scalar_t z[2] = { KPF_FROM_FLOAT(keypoints[i].x_center), KPF_FROM_FLOAT(keypoints[i].y_center) };
+
+        if (!filter->tracked[i]) {
+            // Unfiltered until a first confident detection
+            if (measured) {
+                Axis_Start(filter, &filter->axis[i][0], z[0]);
+                Axis_Start(filter, &filter->axis[i][1], z[1]);
+                filter->tracked[i] = 1;
+                filter->missed[i] = 0;
+            }
+            continue;
+        }
+
+        filter->missed[i] = measured ? 0 : filter->missed[i] + 1;
+        if (filter->missed[i] > MAX_MISSED_FRAMES) {
+            filter->tracked[i] = 0;
+            continue;
+        }
+
+        for (int a = 0; a < 2; a++) {
+            KeypointFilterAxis_t *axis = &filter->axis[i][a];
+
+            if (filter->type == KEYPOINT_FILTER_KALMAN) {
+                Kalman_Predict(filter, axis, dt);
+                if (measured) Kalman_Update(filter, axis, z[a]);
+            } else if (measured) {
+                OneEuro_Update(filter, axis, z[a], dt);
+            }
+        }
+
+        // Missed detections: Kalman keeps predicting, One-Euro holds the last position
+        keypoints[i].x_center = KPF_TO_FLOAT(filter->axis[i][0].pos);
+        keypoints[i].y_center = KPF_TO_FLOAT(filter->axis[i][1].pos);
+    }
+}
+
+void KeypointFilter_Predict(const KeypointFilter_t *filter, spe_pp_outBuffer_t *keypoints, uint32_t timestamp_ms)
+{
+    if (filter->type == KEYPOINT_FILTER_NONE || !filter->started) return;
+
+    uint32_t elapsed_ms = timestamp_ms - filter->last_timestamp;
+    kpf_scalar_t dt = KPF_FROM_MS(elapsed_ms > MAX_PREDICTION_MS ? MAX_PREDICTION_MS : elapsed_ms);
+
+    for (int i = 0; i < NB_KP; i++) {
+        if (!filter->tracked[i]) continue;
+
+        const KeypointFilterAxis_t *axis = filter->axis[i];
+        float32_t x = KPF_TO_FLOAT(axis[0].pos + KPF_MUL(axis[0].vel, dt));
+        float32_t y = KPF_TO_FLOAT(axis[1].pos + KPF_MUL(axis[1].vel, dt));
+
+        keypoints[i].x_center = x < 0.0f ? 0.0f : x > 1.0f ? 1.0f : x;
+        keypoints[i].y_center = y < 0.0f ? 0.0f : y > 1.0f ? 1.0f : y;
+    }
+}
@@ -0,0 +1,135 @@
+/**
+ ******************************************************************************
+ * @file    keypoint_history.c
+ * @brief   Ring buffer of the last keypoint frames, structure-of-arrays layout
+ ******************************************************************************
+ */
+
+#include "keypoint_history.h"
+#include <math.h>
+#include <string.h>
+
+#define NB_KP AI_POSE_PP_POSE_KEYPOINTS_NB
+
+void KeypointHistory_Init(KeypointHistory_t *history)
+{
+    memset(history, 0, sizeof(KeypointHistory_t));
+}
+
+void KeypointHistory_Push(KeypointHistory_t *history, const spe_pp_outBuffer_t *keypoints, uint32_t timestamp)
+{
+    uint32_t slot = (history->head + 1) & KEYPOINT_HISTORY_MASK;
+    float32_t *x = history->x[slot];
+    float32_t *y = history->y[slot];
+    float32_t *confidence = history->confidence[slot];
+
+    for (int i = 0; i < NB_KP; i++) {
+        x[i] = keypoints[i].x_center;
+        y[i] = keypoints[i].y_center;
+        confidence[i] = keypoints[i].proba;
+    }
+    history->timestamp[slot] = timestamp;
+    history->head++;
+}
+
+// Elapsed seconds between two frames, 0 if unknown
+static float32_t KeypointHistory_Seconds(const KeypointHistory_t *history, uint32_t curr_slot, uint32_t prev_slot)
+{
+    uint32_t time_diff = history->timestamp[curr_slot] - history->timestamp[prev_slot];
+
+    return time_diff / 1000.0f;
+}
+
+float32_t KeypointHistory_Speed(const KeypointHistory_t *history, uint32_t keypoint, uint32_t from_back, uint32_t frames)
+{
+    if (!KeypointHistory_Has(history, from_back + frames)) return 0.0f;
+
+    uint32_t curr = KeypointHistory_Slot(history, from_back);
+    uint32_t prev = KeypointHistory_Slot(history, from_back + frames);
+    float32_t seconds = KeypointHistory_Seconds(history, curr, prev);
+    if (seconds == 0.0f) return 0.0f;
+
+    float32_t dx = history->x[curr][keypoint] - history->x[prev][keypoint];
+    float32_t dy = history->y[curr][keypoint] - history->y[prev][keypoint];
+
+    return sqrtf(dx * dx + dy * dy) / seconds; // Speed per second
+}
+
+void KeypointHistory_SpeedAll(const KeypointHistory_t *history, uint32_t frames, float32_t *speed)
+{
+    float32_t seconds = 0.0f;
+    uint32_t curr = KeypointHistory_Slot(history, 0);
+    uint32_t prev = KeypointHistory_Slot(history, frames);
+
+    if (KeypointHistory_Has(history, frames)) {
+        seconds = KeypointHistory_Seconds(history, curr, prev);
+    }
+    if (seconds == 0.0f) {
+        memset(speed, 0, NB_KP * sizeof(float32_t));
+        return;
+    }
+
+    const float32_t *cx = history->x[curr], *cy = history->y[curr];
+    const float32_t *px = history->x[prev], *py = history->y[prev];
+    float32_t inv_seconds = 1.0f / seconds;
+
+    for (int i = 0; i < NB_KP; i++) {
+        float32_t dx = cx[i] - px[i];
+        float32_t dy = cy[i] - py[i];
+        speed[i] = sqrtf(dx * dx + dy * dy) * inv_seconds;
+    }
+}
+
+void KeypointHistory_DisplacementAll(const KeypointHistory_t *history, uint32_t frames, float32_t *dx, float32_t *dy)
+{
+    if (!KeypointHistory_Has(history, frames)) {
+        memset(dx, 0, NB_KP * sizeof(float32_t));
+        memset(dy, 0, NB_KP * sizeof(float32_t));
+        return;
+    }
+
+    uint32_t curr = KeypointHistory_Slot(history, 0);
+    uint32_t prev = KeypointHistory_Slot(history, frames);
+    const float32_t *cx = history->x[curr], *cy = history->y[curr];
+    const float32_t *px = history->x[prev], *py = history->y[prev];
+
+    for (int i = 0; i < NB_KP; i++) {
+        dx[i] = cx[i] - px[i];
+        dy[i] = cy[i] - py[i];
+    }
+}
+
+void KeypointHistory_ExtremumAll(const KeypointHistory_t *history, uint32_t frames,
+                                 float32_t *min_x, float32_t *max_x, float32_t *min_y, float32_t *max_y)
+{
+    // Local accumulators: the outputs may alias the history for the compiler, which would keep it from vectorizing
+    float32_t lo_x[NB_KP], hi_x[NB_KP], lo_y[NB_KP], hi_y[NB_KP];
+    uint32_t slot = KeypointHistory_Slot(history, 0);
+
+    // Window limited to the frames actually stored
+    if (frames >= history->head) frames = history->head ? history->head - 1 : 0;
+    if (frames >= KEYPOINT_HISTORY_SIZE) frames = KEYPOINT_HISTORY_SIZE - 1;
+
+    memcpy(lo_x, history->x[slot], sizeof(lo_x));
+    memcpy(hi_x, history->x[slot], sizeof(hi_x));
+    memcpy(lo_y, history->y[slot], sizeof(lo_y));
+    memcpy(hi_y, history->y[slot], sizeof(hi_y));
+
+    for (uint32_t back = 1; back <= frames; back++) {
+        slot = KeypointHistory_Slot(history, back);
+        const float32_t *x = history->x[slot], *y = history->y[slot];
+
+        // Compare and select rather than fminf()/fmaxf(), whose NaN handling is not a single vector instruction
+        for (int i = 0; i < NB_KP; i++) {
+            lo_x[i] = x[i] < lo_x[i] ? x[i] : lo_x[i];
+            hi_x[i] = x[i] > hi_x[i] ? x[i] : hi_x[i];
+            lo_y[i] = y[i] < lo_y[i] ? y[i] : lo_y[i];
+            hi_y[i] = y[i] > hi_y[i] ? y[i] : hi_y[i];
+        }
+    }
+
+    memcpy(min_x, lo_x, sizeof(lo_x));
+    memcpy(max_x, hi_x, sizeof(hi_x));
+    memcpy(min_y, lo_y, sizeof(lo_y));
+    memcpy(max_y, hi_y, sizeof(hi_y));
+}
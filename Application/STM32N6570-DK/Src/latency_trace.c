@@ -0,0 +1,236 @@
+/**
+ ******************************************************************************
+ * @file    latency_trace.c
+ * @brief   Per-stage latency instrumentation of the frame pipeline
+ ******************************************************************************
+ */
+
+#include "latency_trace.h"
+#include <stdio.h>
+#include <string.h>
+
+#define EVENT_MASK  (LATENCY_TRACE_NB_EVENTS - 1)
+
+#if (LATENCY_TRACE_NB_EVENTS & EVENT_MASK) != 0
+#error "LATENCY_TRACE_NB_EVENTS must be a power of two"
+#endif
+
+typedef struct {
+  uint8_t open;
+  uint32_t open_ts;
+  uint32_t window[LATENCY_TRACE_WINDOW];
+  uint32_t window_idx;
+  uint32_t count;
+  uint32_t total;
+} TraceStage_t;
+
+static const char *const stage_names[LATENCY_STAGE_NB] = {
+  [LATENCY_STAGE_CAPTURE] = "capture",
+  [LATENCY_STAGE_ISP] = "isp",
+  [LATENCY_STAGE_CROP] = "crop",
+  [LATENCY_STAGE_MOTION] = "motion",
+  [LATENCY_STAGE_INFERENCE] = "inference",
+  [LATENCY_STAGE_NPU_EPOCH] = "npu_epoch",
+  [LATENCY_STAGE_POSTPROCESS] = "postprocess",
+  [LATENCY_STAGE_GESTURE] = "gesture",
+  [LATENCY_STAGE_DRAW] = "draw",
+};
+
+/* Ring: producers reserve slots by incrementing the head, the consumer reads from the tail */
+static LatencyEvent_t trace_ring[LATENCY_TRACE_NB_EVENTS];
+static uint32_t trace_head;
+static uint32_t trace_tail;
+static uint32_t trace_lost;
+
+static TraceStage_t trace_stages[LATENCY_STAGE_NB];
+static uint32_t trace_ticks_per_us = 1;
+
+void LatencyTrace_Init(uint32_t ts_freq_hz)
+{
+#ifdef LATENCY_TRACE_USE_DWT
+  DCB->DEMCR |= DCB_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+  trace_ticks_per_us = ts_freq_hz >= 1000000 ? ts_freq_hz / 1000000 : 1;
+
+  memset(trace_ring, 0, sizeof(trace_ring));
+  __atomic_store_n(&trace_head, 0, __ATOMIC_RELEASE);
+  trace_tail = 0;
+  LatencyTrace_ResetStats();
+}
+
+void LatencyTrace_ResetStats(void)
+{
+  memset(trace_stages, 0, sizeof(trace_stages));
+  trace_lost = 0;
+}
+
+void LatencyTrace_Event(LatencyStage_t stage, LatencyEventKind_t kind, uint16_t arg)
+{
+  uint32_t idx = __atomic_fetch_add(&trace_head, 1, __ATOMIC_RELAXED);
+  LatencyEvent_t *slot = &trace_ring[idx & EVENT_MASK];
+
+  /* Invalidate the slot before filling it, a reader copying it concurrently then drops it */
+  __atomic_store_n(&slot->seq, 0, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  slot->ts = LATENCY_TRACE_GET_TS();
+  slot->stage = stage;
+  slot->kind = kind;
+  slot->arg = arg;
+  __atomic_store_n(&slot->seq, idx + 1, __ATOMIC_RELEASE);
+}
+
+int LatencyTrace_Pop(LatencyEvent_t *event)
+{
+  uint32_t head = __atomic_load_n(&trace_head, __ATOMIC_ACQUIRE);
+
+  while (trace_tail != head)
+  {
+    LatencyEvent_t *slot = &trace_ring[trace_tail & EVENT_MASK];
+    uint32_t seq;
+
+    /* Consumer lapped: skip what the producers already overwrote */
+    if (head - trace_tail > LATENCY_TRACE_NB_EVENTS)
+    {
+      trace_lost += head - trace_tail - LATENCY_TRACE_NB_EVENTS;
+      trace_tail = head - LATENCY_TRACE_NB_EVENTS;
+      continue;
+    }
+
+    seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+    if (seq != trace_tail + 1)
+    {
+      /* Reserved but not published yet: the producer was interrupted, read it next time */
+      if (seq == 0 || (int32_t) (seq - (trace_tail + 1)) < 0)
+        return 0;
+      trace_lost++;
+      trace_tail++;
+      continue;
+    }
+
+    event->ts = slot->ts;
+    event->stage = slot->stage;
+    event->kind = slot->kind;
+    event->arg = slot->arg;
+    event->seq = seq;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+    /* Overwritten while being copied */
+    if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != seq)
+    {
+      trace_lost++;
+      trace_tail++;
+      continue;
+    }
+
+    trace_tail++;
+    return 1;
+  }
+
+  return 0;
+}
+
+static void Stage_AddDuration(TraceStage_t *s, uint32_t duration)
+{
+  s->window[s->window_idx] = duration;
+  s->window_idx = (s->window_idx + 1) % LATENCY_TRACE_WINDOW;
+  if (s->count < LATENCY_TRACE_WINDOW)
+    s->count++;
+  s->total++;
+}
+
+void LatencyTrace_Process(void)
+{
+  LatencyEvent_t event;
+
+  while (LatencyTrace_Pop(&event))
+  {
+    TraceStage_t *s;
+
+    if (event.stage >= LATENCY_STAGE_NB)
+      continue;
+    s = &trace_stages[event.stage];
+
+    if (event.kind == LATENCY_EVENT_BEGIN)
+    {
+      s->open = 1;
+      s->open_ts = event.ts;
+    }
+    else if (s->open)
+    {
+      /* Unsigned difference is wrap safe */
+      Stage_AddDuration(s, event.ts - s->open_ts);
+      s->open = 0;
+    }
+  }
+}
+
+void LatencyTrace_GetStats(LatencyStage_t stage, LatencyStats_t *stats)
+{
+  const TraceStage_t *s = &trace_stages[stage];
+  uint32_t sorted[LATENCY_TRACE_WINDOW];
+  uint64_t sum = 0;
+  uint32_t n = s->count;
+
+  memset(stats, 0, sizeof(*stats));
+  stats->count = n;
+  stats->total = s->total;
+  if (n == 0)
+    return;
+
+  /* Insertion sort, the window is small and mostly ordered from one call to the next */
+  for (uint32_t i = 0; i < n; i++)
+  {
+    uint32_t v = s->window[i];
+    uint32_t j = i;
+
+    sum += v;
+    for (; j > 0 && sorted[j - 1] > v; j--)
+      sorted[j] = sorted[j - 1];
+    sorted[j] = v;
+  }
+
+  stats->min = sorted[0];
+  stats->max = sorted[n - 1];
+  stats->avg = sum / n;
+  /* Nearest rank: ceil(0.99 * n) */
+  stats->p99 = sorted[(99 * n + 99) / 100 - 1];
+}
+
+uint32_t LatencyTrace_GetLost(void)
+{
+  return trace_lost;
+}
+
+const char *LatencyTrace_GetStageName(LatencyStage_t stage)
+{
+  return stage < LATENCY_STAGE_NB ? stage_names[stage] : "?";
+}
+
+int LatencyTrace_Report(char *buffer, size_t size)
+{
+  int len;
+
+  len = snprintf(buffer, size, "%-11s %6s %6s %6s %6s %12s\r\n", "stage (us)", "min", "avg", "p99", "max", "count");
+  for (int i = 0; i < LATENCY_STAGE_NB && len >= 0 && (size_t) len < size; i++)
+  {
+    LatencyStats_t stats;
+
+    LatencyTrace_GetStats(i, &stats);
+    if (stats.count == 0)
+      continue;
+    len += snprintf(buffer + len, size - len, "%-11s %6lu %6lu %6lu %6lu %12lu\r\n", stage_names[i],
+                    (unsigned long) (stats.min / trace_ticks_per_us),
+                    (unsigned long) (stats.avg / trace_ticks_per_us),
+                    (unsigned long) (stats.p99 / trace_ticks_per_us),
+                    (unsigned long) (stats.max / trace_ticks_per_us),
+                    (unsigned long) stats.total);
+  }
+  if (len >= 0 && (size_t) len < size && trace_lost)
+    len += snprintf(buffer + len, size - len, "lost events %lu\r\n", (unsigned long) trace_lost);
+
+  /* Truncated output: snprintf() returned the length it would have written */
+  if (len < 0)
+    return 0;
+  return (size_t) len < size ? len : (int) size - 1;
+}
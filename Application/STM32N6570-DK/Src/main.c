@@ -25,22 +25,52 @@
 #include "stm32_lcd_ex.h"
 #include "app_postprocess.h"
 #include "ll_aton_runtime.h"
+#include "ll_aton_caches_interface.h"
+#if defined(LL_ATON_RT_EB_OVERLAP)
+#include "ll_aton_eb_deps.h"
+#endif
+#if defined(LL_ATON_RT_RELOC)
+#include "model_manager.h"
+#endif
 #include "app_camerapipeline.h"
 #include "main.h"
 #include <stdio.h>
+#include <string.h>
 #include "app_config.h"
 #include "crop_img.h"
 #include "stlogo.h"
 #include "utils.h"
 #if POSTPROCESS_TYPE == POSTPROCESS_MPE_YOLO_V8_UF
   #include "display_mpe.h"
-#elif POSTPROCESS_TYPE == POSTPROCESS_SPE_MOVENET_UF
+#elif POSTPROCESS_TYPE == POSTPROCESS_SPE_MOVENET_UF || POSTPROCESS_TYPE == POSTPROCESS_SPE_MOVENET_UI
   #include "display_spe.h"
 #else
   #error "PostProcessing type not supported"
 #endif
 
 #include "gesture_detection.h"
+#include "keypoint_filter.h"
+#include "overlay_damage.h"
+#include "latency_trace.h"
+#include "weight_prefetch.h"
+#include "npu_profiler.h"
+#include "nn_input.h"
+#include "pipeline.h"
+#include "roi_tracker.h"
+#include "inference_rate.h"
+
+#if NPU_PROFILER_RUNS && NN_WEIGHT_PREFETCH_MODE != WEIGHT_PREFETCH_OFF
+#error "NPU profiler and weight prefetch both use the ATON debug and trace counters"
+#endif
+#if NPU_PROFILER_RUNS && !LATENCY_REPORT_PERIOD_MS
+#error "NPU profiler report is sent on the virtual COM port of the latency report"
+#endif
+#if NN_ROI_TRACKING && POSTPROCESS_TYPE == POSTPROCESS_MPE_YOLO_V8_UF
+#error "NN pipe zoom follows the keypoints of a single pose"
+#endif
+#if NN_ADAPTIVE_RATE && POSTPROCESS_TYPE == POSTPROCESS_MPE_YOLO_V8_UF
+#error "Keypoints extrapolation between inferences is done for a single pose"
+#endif
 
 #define MAX_NUMBER_OUTPUT 5
 #define LCD_FG_WIDTH  SCREEN_WIDTH
@@ -79,7 +109,7 @@ Rectangle_TypeDef lcd_fg_area = {
 #if POSTPROCESS_TYPE == POSTPROCESS_MPE_YOLO_V8_UF
   mpe_yolov8_pp_static_param_t pp_params;
   mpe_pp_out_t pp_output;
-#elif POSTPROCESS_TYPE == POSTPROCESS_SPE_MOVENET_UF
+#elif POSTPROCESS_TYPE == POSTPROCESS_SPE_MOVENET_UF || POSTPROCESS_TYPE == POSTPROCESS_SPE_MOVENET_UI
   spe_movenet_pp_static_param_t pp_params;
   spe_pp_out_t pp_output;
 #else
@@ -87,22 +117,53 @@ Rectangle_TypeDef lcd_fg_area = {
 #endif
 
 volatile int32_t cameraFrameReceived;
-uint8_t *nn_in;
+/* NN input buffers, written by the CPU or the DCMIPP while the NPU is not reading them */
+static NnInput_TypeDef nn_input;
+/* Layout of the NN outputs, as generated */
+static Buffer_CHPos_TypeDef nn_out_chpos[MAX_NUMBER_OUTPUT];
 BSP_LCD_LayerConfig_t LayerConfig = {0};
 
 #define ALIGN_TO_16(value) (((value) + 15) & ~15)
 
-/* for models not multiple of 16; needs a working buffer */
 #if (NN_WIDTH * NN_BPP) != ALIGN_TO_16(NN_WIDTH * NN_BPP)
+/* DCMIPP requires a 16 bytes aligned pitch: frames are captured into buffers of their own, then cropped into nn_in */
+#define NN_PIPE_DIRECT 0
 #define DCMIPP_OUT_NN_LEN (ALIGN_TO_16(NN_WIDTH * NN_BPP) * NN_HEIGHT)
 #define DCMIPP_OUT_NN_BUFF_LEN (DCMIPP_OUT_NN_LEN + 32 - DCMIPP_OUT_NN_LEN%32)
 
+/* NN pipe capture buffers: DCMIPP fills one while the other is copied */
 __attribute__ ((aligned (32)))
-uint8_t dcmipp_out_nn[DCMIPP_OUT_NN_BUFF_LEN];
+uint8_t dcmipp_out_nn[2][DCMIPP_OUT_NN_BUFF_LEN];
 #else
-uint8_t *dcmipp_out_nn;
+/* DCMIPP captures into the NN input buffers, one snapshot at a time */
+#define NN_PIPE_DIRECT 1
+#endif
+
+#if NN_INPUT_DOUBLE_BUFFER
+#define NN_IN_LEN (NN_WIDTH * NN_HEIGHT * NN_BPP)
+#define NN_IN_BUFF_LEN (NN_IN_LEN + 32 - NN_IN_LEN%32)
+
+/* NN input buffers owned by the application, rebound as the network input at each inference */
+__attribute__ ((aligned (32)))
+static uint8_t nn_in_buffers[2][NN_IN_BUFF_LEN];
 #endif
 
+/* NN outputs, post-processed from the main loop */
+static float32_t *nn_out[MAX_NUMBER_OUTPUT];
+static int32_t nn_out_len[MAX_NUMBER_OUTPUT];
+static int number_output;
+static uint32_t nn_in_len;
+static uint32_t inference_ms;
+
+/* Frame pipeline: capture N+1 | inference N | post-process & draw N-1 */
+static Pipeline_TypeDef pipeline;
+/* Network stays initialized across frames, only re-armed between inferences */
+static LL_ATON_RT_Resident_TypeDef nn_resident;
+
+/* Latency report text, sent in the background over the virtual COM port */
+static char latency_report[1280];
+static uint32_t latency_report_ts;
+
 /* Lcd Background Buffer */
 __attribute__ ((section (".psram_bss")))
 __attribute__ ((aligned (32)))
@@ -112,12 +173,30 @@ __attribute__ ((section (".psram_bss")))
 __attribute__ ((aligned (32)))
 uint8_t lcd_fg_buffer[2][LCD_FG_WIDTH * LCD_FG_HEIGHT * 2];
 static int lcd_fg_buffer_rd_idx;
+/* Regions drawn in each foreground buffer, cleared on its next use instead of the whole buffer */
+static OverlayDamage_t lcd_fg_damage[2];
+/* Drawing queue of the foreground layer and the A8 glyph atlas of Font20 (14x20) */
+OverlayDraw_t lcd_fg_overlay;
+static uint8_t lcd_fg_glyph_atlas[OVERLAY_DRAW_GLYPH_ATLAS_SIZE(14, 20)];
 GestureDetector_t gesture_detector;
+static KeypointFilter_t keypoint_filter;
+#if NN_ROI_TRACKING
+static RoiTracker_t roi_tracker;
+#endif
+#if NN_ADAPTIVE_RATE
+static InferenceRate_t inference_rate;
+/* Keypoints of the last inference, moved to each frame not inferred */
+static spe_pp_outBuffer_t predicted_keypoints[AI_POSE_PP_POSE_KEYPOINTS_NB];
+static spe_pp_out_t predicted_output = { .pOutBuff = predicted_keypoints };
+#endif
 
 static void SystemClock_Config(void);
 static void NPURam_enable(void);
 static void NPUCache_config(void);
+static void Display_BeginFrame(void);
 static void Display_NetworkOutput(void *p_postprocess, uint32_t inference_ms);
+static void Display_FrameDone(void *arg);
+static void Display_DamageCacheClean(uint8_t *buffer, const OverlayDamage_t *damage);
 static void LCD_init(void);
 static void Security_Config(void);
 static void set_clk_sleep_mode(void);
@@ -125,6 +204,29 @@ static void IAC_Config(void);
 static void Display_WelcomeScreen(void);
 static void Hardware_init(void);
 static void NeuralNetwork_init(uint32_t *nnin_length, float32_t *nn_out[], int *number_output, int32_t nn_out_len[]);
+#if NN_PIPE_DIRECT
+static void Capture_Start(uint8_t *nn_in);
+#else
+static uint32_t Capture_FrameSeq(const uint8_t *frame);
+static int Capture_CopyStart(const uint8_t *frame, uint8_t *nn_in);
+static void Capture_CopyDone(void *arg, int error);
+static void Capture_Copy(const uint8_t *frame, uint8_t *nn_in);
+#endif
+static uint8_t *Capture_GetFrame(uint32_t *seq, Roi_t *roi);
+static void Capture_Commit(uint8_t *nn_in);
+static int NeuralNetwork_Run(void);
+static void NeuralNetwork_Postprocess(const Roi_t *roi);
+static void Display_Frame(int is_predicted);
+static void NeuralNetwork_EpochTrace(LL_ATON_RT_Callbacktype_t ctype, const NN_Instance_TypeDef *nn_instance,
+                                     const EpochBlock_ItemTypeDef *eb);
+static void LatencyReport_Init(void);
+static void LatencyReport_Poll(void);
+
+#if !defined(LL_ATON_RT_RELOC)
+LL_ATON_DECLARE_NAMED_NN_INSTANCE_AND_INTERFACE(Default);
+/* Buffer dependencies of the epoch blocks of the network, see network_eb_deps.c */
+extern const EpochBlock_DepsTypeDef *LL_ATON_EpochBlockDeps_Default(void);
+#endif
 
 
 /**
@@ -139,107 +241,416 @@ int main(void)
 
   /*** NN Init ****************************************************************/
   uint32_t pitch_nn = 0;
-  uint32_t nn_in_len = 0;
-  int number_output = 0;
-  float32_t *nn_out[MAX_NUMBER_OUTPUT] = {0};
-  int32_t nn_out_len[MAX_NUMBER_OUTPUT] = {0};
-  LL_ATON_DECLARE_NAMED_NN_INSTANCE_AND_INTERFACE(Default);
   NeuralNetwork_init(&nn_in_len, nn_out, &number_output, nn_out_len);
 
   /*** Post Processing Init ***************************************************/
   app_postprocess_init(&pp_params);
+#if POSTPROCESS_TYPE == POSTPROCESS_SPE_MOVENET_UF
+  /* Heatmaps of a network generated with channel-first outputs are one after the other */
+  pp_params.planar_heatmaps = (nn_out_chpos[0] == CHPos_First);
+#endif
 
   /* Gesture detection Init */
   // Initialize gesture detection
   Gesture_Init(&gesture_detector);
 
+  /* Keypoints smoothing between post-processing and its consumers */
+  const KeypointFilter_OneEuroParams_t keypoint_filter_params = {
+    .min_cutoff = KEYPOINT_FILTER_MIN_CUTOFF,
+    .beta = KEYPOINT_FILTER_BETA,
+    .d_cutoff = KEYPOINT_FILTER_D_CUTOFF,
+  };
+  KeypointFilter_InitOneEuro(&keypoint_filter, &keypoint_filter_params, AI_POSE_PP_CONF_THRESHOLD);
+
   /*** Camera Init ************************************************************/
   CameraPipeline_Init(&lcd_bg_area.XSize, &lcd_bg_area.YSize, &pitch_nn);
 
+#if NN_ROI_TRACKING
+  /* NN pipe zoom following the keypoints */
+  const float32_t roi_min_size = CameraPipeline_NNPipe_GetMinRoiSize();
+  const RoiTracker_Params_t roi_tracker_params = {
+    .margin = NN_ROI_MARGIN,
+    .min_size = roi_min_size > NN_ROI_MIN_SIZE ? roi_min_size : NN_ROI_MIN_SIZE,
+    .min_confidence = AI_POSE_PP_CONF_THRESHOLD,
+    .shrink_rate = NN_ROI_SHRINK_RATE,
+    .min_keypoints = NN_ROI_MIN_KEYPOINTS,
+    .max_missed = NN_ROI_MAX_MISSED,
+  };
+  RoiTracker_Init(&roi_tracker, &roi_tracker_params);
+#endif
+
+#if NN_ADAPTIVE_RATE
+  const InferenceRate_Params_t inference_rate_params = {
+    .idle_period = NN_IDLE_PERIOD,
+    .hold_frames = NN_IDLE_HOLD_FRAMES,
+    .pixel_threshold = NN_MOTION_PIXEL_THRESHOLD,
+    .motion_samples = NN_MOTION_SAMPLES,
+    .speed_threshold = NN_MOTION_KEYPOINT_SPEED,
+  };
+  InferenceRate_Init(&inference_rate, &inference_rate_params);
+#endif
+
   LCD_init();
 
   /* Start LCD Display camera pipe stream */
   CameraPipeline_DisplayPipe_Start(lcd_bg_buffer, CMW_MODE_CONTINUOUS);
 
+  static const Pipeline_Ops_t pipeline_ops = {
+#if NN_PIPE_DIRECT
+    .capture_start = Capture_Start,
+#else
+    .frame_seq = Capture_FrameSeq,
+#if NN_CROP_BACKEND == IMG_CROP_DMA2D
+    .copy_start = Capture_CopyStart,
+#endif
+    .copy = Capture_Copy,
+#endif
+    .frame_get = Capture_GetFrame,
+    .commit = Capture_Commit,
+    .inference_run = NeuralNetwork_Run,
+    .postprocess = NeuralNetwork_Postprocess,
+    .draw = Display_Frame,
+  };
+#if NN_ADAPTIVE_RATE
+  InferenceRate_t *rate = &inference_rate;
+#else
+  InferenceRate_t *rate = NULL;
+#endif
+
+#if NN_PIPE_DIRECT
+  /* Each snapshot is started by the pipeline into the NN input buffer it is written into */
+  assert(pitch_nn == NN_WIDTH * NN_BPP);
+#else
+  /* Start NN camera pipe stream; DCMIPP alternates between the two capture buffers */
+  CameraPipeline_NNPipe_DoubleBufferStart(dcmipp_out_nn[0], dcmipp_out_nn[1], CMW_MODE_CONTINUOUS);
+#endif
+  Pipeline_Init(&pipeline, &pipeline_ops, &nn_input, rate, NN_PIPE_DIRECT, pitch_nn, nn_in_len);
+
   /*** App Loop ***************************************************************/
   while (1)
   {
+    LatencyReport_Poll();
+
+    LatencyTrace_Begin(LATENCY_STAGE_ISP);
     CameraPipeline_IspUpdate();
+    LatencyTrace_End(LATENCY_STAGE_ISP);
 
-    if (pitch_nn != (NN_WIDTH * NN_BPP))
-    {
-      /* Start NN camera single capture Snapshot */
-      CameraPipeline_NNPipe_Start(dcmipp_out_nn, CMW_MODE_SNAPSHOT);
-    }
-    else
+    if (Pipeline_Step(&pipeline))
     {
-      /* Start NN camera single capture Snapshot */
-      CameraPipeline_NNPipe_Start(nn_in, CMW_MODE_SNAPSHOT);
+      LL_ATON_OSAL_WFE();
     }
+  }
+}
 
-    while (cameraFrameReceived == 0) {};
-    cameraFrameReceived = 0;
+#if NN_PIPE_DIRECT
+/**
+* @brief Start the snapshot of the next NN pipe frame into a NN input buffer
+*
+* @param nn_in NN input buffer, not read by the NPU
+*/
+static void Capture_Start(uint8_t *nn_in)
+{
+  /* No dirty line of the buffer may be evicted over the frame */
+  SCB_CleanInvalidateDCache_by_Addr(nn_in, nn_in_len);
+  CameraPipeline_NNPipe_Start(nn_in, CMW_MODE_SNAPSHOT);
+}
+#else
+/**
+* @brief Sequence number of the frame a DCMIPP buffer holds now
+*/
+static uint32_t Capture_FrameSeq(const uint8_t *frame)
+{
+  return CameraPipeline_NNPipe_GetFrameSeq(frame);
+}
 
-    uint32_t ts[2] = { 0 };
+/**
+* @brief Start copying a captured frame into a NN input buffer with the DMA2D, completed by Capture_CopyDone()
+*
+* @param frame DCMIPP buffer holding the frame
+* @param nn_in NN input buffer, not read by the NPU
+* @retval 0 if started, -1 to copy by CPU instead
+*/
+static int Capture_CopyStart(const uint8_t *frame, uint8_t *nn_in)
+{
+  /* The DMA2D writes the memory: no dirty line of the buffer may be evicted over it. Copied by the CPU while the
+   * overlay is being drawn */
+  SCB_CleanInvalidateDCache_by_Addr(nn_in, nn_in_len);
+  if (lcd_fg_overlay.busy)
+  {
+    return -1;
+  }
+  return img_crop_dma2d_start(frame, nn_in, pipeline.pitch, NN_WIDTH, NN_HEIGHT, NN_BPP, Capture_CopyDone, NULL);
+}
 
-    if (pitch_nn != (NN_WIDTH * NN_BPP))
-    {
-      SCB_InvalidateDCache_by_Addr(dcmipp_out_nn, sizeof(dcmipp_out_nn));
-    /*
-     * Crop the image if the neural network (NN) input dimensions are not a multiple of 16.
-     * The DCMIPP hardware requires the output image dimensions to be multiples of 16.
-     * This ensures compatibility with the NN input dimensions.
-     */
-      img_crop(dcmipp_out_nn, nn_in, pitch_nn, NN_WIDTH, NN_HEIGHT, NN_BPP);
-      SCB_CleanInvalidateDCache_by_Addr(nn_in, nn_in_len);
-    }
+/**
+* @brief End of the DMA2D copy, from its interrupt
+*
+* @param arg unused
+* @param error DMA2D transfer error: the frame is then copied by CPU from the main loop
+*/
+static void Capture_CopyDone(void *arg, int error)
+{
+  Pipeline_InputWritten(&pipeline, error);
+}
+
+/**
+* @brief Copy a captured frame into a NN input buffer by CPU
+*
+* @param frame DCMIPP buffer holding the frame
+* @param nn_in NN input buffer, not read by the NPU
+*/
+static void Capture_Copy(const uint8_t *frame, uint8_t *nn_in)
+{
+#if NN_CROP_BACKEND == IMG_CROP_MEMCPY
+  img_crop((uint8_t *) frame, nn_in, pipeline.pitch, NN_WIDTH, NN_HEIGHT, NN_BPP);
+#else
+  img_crop_mve(frame, nn_in, pipeline.pitch, NN_WIDTH, NN_HEIGHT, NN_BPP);
+#endif
+  SCB_CleanInvalidateDCache_by_Addr(nn_in, nn_in_len);
+}
+#endif
+
+/**
+* @brief Latest NN pipe frame completed since the previous call
+*
+* @param seq sequence number of the frame
+* @param roi region of the camera frame it holds
+* @retval DCMIPP buffer holding the frame, readable by the CPU, or NULL if none
+*/
+static uint8_t *Capture_GetFrame(uint32_t *seq, Roi_t *roi)
+{
+  uint8_t *frame;
+
+  if (!cameraFrameReceived)
+  {
+    return NULL;
+  }
+  cameraFrameReceived = 0;
+
+  frame = CameraPipeline_NNPipe_GetLastFrameRoi(roi, seq);
+#if NN_PIPE_DIRECT
+  SCB_InvalidateDCache_by_Addr(frame, nn_in_len);
+#else
+  SCB_InvalidateDCache_by_Addr(frame, DCMIPP_OUT_NN_LEN);
+#endif
+
+  return frame;
+}
+
+/**
+* @brief NN input buffer written, before the next inference reads it
+*/
+static void Capture_Commit(uint8_t *nn_in)
+{
+#if NN_INPUT_DOUBLE_BUFFER
+  /* The NPU cache may still hold this buffer as read two inferences ago */
+  LL_ATON_Cache_NPU_Clean_Invalidate_Range((uintptr_t) nn_in, nn_in_len);
+#endif
+}
+
+/**
+* @brief Run the in-flight inference as far as possible without blocking
+*
+* @retval 1 once the inference is done, 0 while the NPU is busy
+*/
+static int NeuralNetwork_Run(void)
+{
+  LL_ATON_RT_RetValues_t ret;
+
+  do
+  {
+    ret = LL_ATON_RT_Resident_RunEpochBlock(&nn_resident);
+  } while (ret == LL_ATON_RT_NO_WFE);
+
+  if (ret != LL_ATON_RT_DONE)
+  {
+    return 0;
+  }
+
+  /* Instance already re-armed by the resident runtime */
+  inference_ms = LL_ATON_RT_Resident_GetStats(&nn_resident)->last_inference_ticks / (SystemCoreClock / 1000);
+
+  /* NPU idle until the next frame: the weights read first are brought back into the NPU cache meanwhile */
+  WeightPrefetch_Idle();
+
+  return 1;
+}
+
+/**
+* @brief Extract the keypoints of the inference done, before the next one overwrites nn_out
+*
+* @param roi region of the camera frame inferred
+*/
+static void NeuralNetwork_Postprocess(const Roi_t *roi)
+{
+  int32_t ret = app_postprocess_run((void **) nn_out, number_output, &pp_output, &pp_params);
+  assert(ret == 0);
+  (void) roi;
+#if NN_ROI_TRACKING
+  /* Keypoints of the zoomed region back to full frame coordinates, then zoom of the next frames */
+  Roi_ToFullFrame(roi, ((spe_pp_out_t *) &pp_output)->pOutBuff, AI_POSE_PP_POSE_KEYPOINTS_NB);
+#endif
+  KeypointFilter_Apply(&keypoint_filter, ((spe_pp_out_t *) &pp_output)->pOutBuff, HAL_GetTick());
+#if NN_ROI_TRACKING
+  CameraPipeline_NNPipe_SetRoi(RoiTracker_Update(&roi_tracker, ((spe_pp_out_t *) &pp_output)->pOutBuff,
+                                                 AI_POSE_PP_POSE_KEYPOINTS_NB));
+#endif
+#if NN_ADAPTIVE_RATE
+  memcpy(predicted_keypoints, ((spe_pp_out_t *) &pp_output)->pOutBuff, sizeof(predicted_keypoints));
+#endif
 
-    ts[0] = HAL_GetTick();
-    /* run ATON inference */
-    LL_ATON_RT_Main(&NN_Instance_Default);
-    ts[1] = HAL_GetTick();
+  /* Discard nn_out region (used by pp_input and pp_outputs variables) to avoid Dcache evictions during nn inference */
+  for (int i = 0; i < number_output; i++)
+  {
+    float32_t *tmp = nn_out[i];
+    SCB_InvalidateDCache_by_Addr(tmp, nn_out_len[i]);
+  }
+}
 
-    int32_t ret = app_postprocess_run((void **) nn_out, number_output, &pp_output, &pp_params);
-    assert(ret == 0);
+/**
+* @brief Gesture detection and rendering of the last keypoints, while the NPU works on the next frame
+*
+* @param is_predicted frame not inferred: the keypoints of the last inference are extrapolated instead
+*/
+static void Display_Frame(int is_predicted)
+{
+  /* Debug prints below already go to the foreground buffer of this frame */
+  Display_BeginFrame();
 
+  void *p_output = &pp_output;
+#if NN_ADAPTIVE_RATE
+  if (is_predicted)
+  {
+    /* Gestures are only detected on inferred keypoints */
+    KeypointFilter_Predict(&keypoint_filter, predicted_keypoints, HAL_GetTick());
+    p_output = &predicted_output;
+  }
+  else
+#endif
+  {
     spe_pp_outBuffer_t *keypoints = ((spe_pp_out_t *) &pp_output)->pOutBuff;
+    LatencyTrace_Begin(LATENCY_STAGE_GESTURE);
     GestureType_t detected_gesture = Gesture_Detect(&gesture_detector, keypoints);
-   // UTIL_LCDEx_PrintfAt(0, LINE(16), CENTER_MODE, "X: %f, Y: %f P:%f", x_coord,y_coord, confidence	  );
+    LatencyTrace_End(LATENCY_STAGE_GESTURE);
+#if NN_ADAPTIVE_RATE
+    InferenceRate_SetSpeed(&inference_rate, Gesture_MaxKeypointSpeed(&gesture_detector, 1));
+#endif
+  }
+ // UTIL_LCDEx_PrintfAt(0, LINE(16), CENTER_MODE, "X: %f, Y: %f P:%f", x_coord,y_coord, confidence	  );
 
-    //Debug a keypoint:
-    float32_t wrist_x, wrist_y, wrist_conf, wrist_speed;
-    float32_t wrist_x2, wrist_y2, wrist_conf2, wrist_speed2;
+  //Debug a keypoint:
+  float32_t wrist_x, wrist_y, wrist_conf, wrist_speed;
+  float32_t wrist_x2, wrist_y2, wrist_conf2, wrist_speed2;
 
-    Gesture_GetKeypointDebugInfo(&gesture_detector, KEYPOINT_RIGHT_WRIST,
-                                 &wrist_x, &wrist_y, &wrist_conf, &wrist_speed);
-    Gesture_GetPastKeypointDebugInfo(&gesture_detector, KEYPOINT_RIGHT_WRIST,
-            &wrist_x2, &wrist_y2, &wrist_conf2, &wrist_speed2, 5);
-    if (wrist_speed >0.5)
-    {
-    	UTIL_LCD_SetTextColor(UTIL_LCD_COLOR_CYAN);
-    }
-    else
-    {
-        UTIL_LCD_SetTextColor(UTIL_LCD_COLOR_WHITE);
-    }
+  Gesture_GetKeypointDebugInfo(&gesture_detector, KEYPOINT_RIGHT_WRIST,
+                               &wrist_x, &wrist_y, &wrist_conf, &wrist_speed);
+  Gesture_GetPastKeypointDebugInfo(&gesture_detector, KEYPOINT_RIGHT_WRIST,
+          &wrist_x2, &wrist_y2, &wrist_conf2, &wrist_speed2, 5);
+  if (wrist_speed >0.5)
+  {
+  	OverlayDraw_SetTextColor(&lcd_fg_overlay, UTIL_LCD_COLOR_CYAN);
+  }
+  else
+  {
+      OverlayDraw_SetTextColor(&lcd_fg_overlay, UTIL_LCD_COLOR_WHITE);
+  }
 
-    UTIL_LCDEx_PrintfAt(0, LINE(17), CENTER_MODE, "R Wrist: (%.2f,%.2f) C:%.2f Spd:%.3f",
-                        wrist_x, wrist_y, wrist_conf, wrist_speed);
-    UTIL_LCDEx_PrintfAt(0, LINE(18), CENTER_MODE, "RW Past: (%.2f,%.2f) C:%.2f Spd:%.3f",
-                        wrist_x2, wrist_y2, wrist_conf2, wrist_speed2);
-    //End of kepoint debug print
+  OverlayDraw_PrintfAt(&lcd_fg_overlay, 0, LINE(17), OVERLAY_DRAW_ALIGN_CENTER, "R Wrist: (%.2f,%.2f) C:%.2f Spd:%.3f",
+                       wrist_x, wrist_y, wrist_conf, wrist_speed);
+  OverlayDraw_PrintfAt(&lcd_fg_overlay, 0, LINE(18), OVERLAY_DRAW_ALIGN_CENTER, "RW Past: (%.2f,%.2f) C:%.2f Spd:%.3f",
+                       wrist_x2, wrist_y2, wrist_conf2, wrist_speed2);
+  //End of kepoint debug print
 
+  /* Keep the NPU fed across software epochs while the CPU is drawing */
+  Pipeline_Advance(&pipeline);
+
+  Display_NetworkOutput(p_output, inference_ms);
+}
+
+/**
+* @brief Epoch callback of the network instance: traces the duration of each epoch block and profiles its NPU cache use
+*        and, with NPU_PROFILER_RUNS, its NPU performance counters
+*/
+static void NeuralNetwork_EpochTrace(LL_ATON_RT_Callbacktype_t ctype, const NN_Instance_TypeDef *nn_instance,
+                                     const EpochBlock_ItemTypeDef *eb)
+{
+  /* Epoch blocks are identified by their index in the list being executed */
+  uint16_t eb_idx;
+
+  if (ctype != LL_ATON_RT_Callbacktype_PRE_START && ctype != LL_ATON_RT_Callbacktype_POST_END)
+    return;
+
+  WeightPrefetch_EpochCallback(ctype, nn_instance, eb);
+#if NPU_PROFILER_RUNS
+  NpuProfiler_EpochCallback(ctype, nn_instance, eb);
+#endif
+
+  eb_idx = eb - nn_instance->exec_state.first_epoch_block;
+  LatencyTrace_Event(LATENCY_STAGE_NPU_EPOCH,
+                     ctype == LL_ATON_RT_Callbacktype_PRE_START ? LATENCY_EVENT_BEGIN : LATENCY_EVENT_END, eb_idx);
+}
+
+/**
+* @brief Virtual COM port used to send the latency report
+*/
+static void LatencyReport_Init(void)
+{
+#if LATENCY_REPORT_PERIOD_MS
+  COM_InitTypeDef com_init = {
+    .BaudRate = 115200,
+    .WordLength = COM_WORDLENGTH_8B,
+    .StopBits = COM_STOPBITS_1,
+    .Parity = COM_PARITY_NONE,
+    .HwFlowCtl = COM_HWCONTROL_NONE,
+  };
+  int ret;
+
+  ret = BSP_COM_Init(COM1, &com_init);
+  assert(ret == BSP_ERROR_NONE);
+  HAL_NVIC_SetPriority(USART1_IRQn, 10, 0);
+  HAL_NVIC_EnableIRQ(USART1_IRQn);
+#endif
+}
 
-    Display_NetworkOutput(&pp_output, ts[1] - ts[0]);
-    /* Discard nn_out region (used by pp_input and pp_outputs variables) to avoid Dcache evictions during nn inference */
-    for (int i = 0; i < number_output; i++)
+/**
+* @brief Update the latency statistics and periodically send them, without waiting for the transfer
+*/
+static void LatencyReport_Poll(void)
+{
+  LatencyTrace_Process();
+
+#if LATENCY_REPORT_PERIOD_MS
+  /* Previous report still being sent */
+  if (hcom_uart[COM1].gState != HAL_UART_STATE_READY)
+    return;
+
+#if NPU_PROFILER_RUNS
+  /* NPU profile sent once, a line at a time, as soon as complete */
+  static int npu_profile_line;
+  if (npu_profile_line >= 0 && NpuProfiler_IsDone())
+  {
+    int npu_len = NpuProfiler_ReportLine(npu_profile_line++, latency_report, sizeof(latency_report));
+    if (npu_len > 0)
     {
-      float32_t *tmp = nn_out[i];
-      SCB_InvalidateDCache_by_Addr(tmp, nn_out_len[i]);
+      HAL_UART_Transmit_IT(&hcom_uart[COM1], (uint8_t *) latency_report, npu_len);
+      return;
     }
+    npu_profile_line = -1;
   }
-}
+#endif
 
+  if (HAL_GetTick() - latency_report_ts < LATENCY_REPORT_PERIOD_MS)
+    return;
+
+  latency_report_ts = HAL_GetTick();
+  int len = LatencyTrace_Report(latency_report, sizeof(latency_report));
+  len += WeightPrefetch_Report(latency_report + len, sizeof(latency_report) - len);
+#if NN_ADAPTIVE_RATE
+  len += InferenceRate_Report(&inference_rate, latency_report + len, sizeof(latency_report) - len);
+#endif
+  HAL_UART_Transmit_IT(&hcom_uart[COM1], (uint8_t *) latency_report, len);
+#endif
+}
 
 static void Hardware_init(void)
 {
@@ -262,6 +673,9 @@ static void Hardware_init(void)
 
   SystemClock_Config();
 
+  /* Cycle counter timestamps, from here on */
+  LatencyTrace_Init(SystemCoreClock);
+
   NPURam_enable();
 
   Fuse_Programming();
@@ -284,15 +698,43 @@ static void Hardware_init(void)
   IAC_Config();
   set_clk_sleep_mode();
 
+  LatencyReport_Init();
+}
+
+#if NN_INPUT_DOUBLE_BUFFER
+/**
+* @brief Bind an application buffer as the network input, between two inferences
+*/
+static int NeuralNetwork_BindInput(uint8_t *buffer, uint32_t len)
+{
+  LL_ATON_User_IO_Result_t ret;
+
+#if defined(LL_ATON_RT_RELOC)
+  ret = ll_aton_reloc_set_input(nn_resident.nn_instance, 0, buffer, len);
+#else
+  ret = LL_ATON_Set_User_Input_Buffer_Default(0, buffer, len);
+#endif
+
+  return ret == LL_ATON_User_IO_NOERROR ? 0 : -1;
 }
+#endif
 
 static void NeuralNetwork_init(uint32_t *nnin_length, float32_t *nn_out[], int *number_output, int32_t nn_out_len[])
 {
+#if defined(LL_ATON_RT_RELOC)
+  /* The network is the first relocatable binary found in the NOR slots, installed at runtime */
+  int nb_models = ModelManager_Init();
+  assert(nb_models > 0);
+  NN_Instance_TypeDef *nn_instance = ModelManager_Select(0, &nn_resident, NeuralNetwork_EpochTrace);
+  assert(nn_instance != NULL);
+
+  const LL_Buffer_InfoTypeDef *nn_in_info = ll_aton_reloc_get_input_buffers_info(nn_instance, -1);
+  const LL_Buffer_InfoTypeDef *nn_out_info = ll_aton_reloc_get_output_buffers_info(nn_instance, -1);
+#else
   const LL_Buffer_InfoTypeDef *nn_in_info = LL_ATON_Input_Buffers_Info_Default();
   const LL_Buffer_InfoTypeDef *nn_out_info = LL_ATON_Output_Buffers_Info_Default();
+#endif
 
-  // Get the input buffer address
-  nn_in = (uint8_t *) LL_Buffer_addr_start(&nn_in_info[0]);
 
   /* Count number of outputs */
   while (nn_out_info[*number_output].name != NULL)
@@ -306,9 +748,47 @@ static void NeuralNetwork_init(uint32_t *nnin_length, float32_t *nn_out[], int *
     // Get the output buffers address
     nn_out[i] = (float32_t *) LL_Buffer_addr_start(&nn_out_info[i]);
     nn_out_len[i] = LL_Buffer_len(&nn_out_info[i]);
+    nn_out_chpos[i] = nn_out_info[i].chpos;
   }
 
   *nnin_length = LL_Buffer_len(&nn_in_info[0]);
+
+#if NN_INPUT_DOUBLE_BUFFER
+  /* Requires a network generated without allocating its input (--no-inputs-allocation) */
+  assert(*nnin_length <= NN_IN_LEN);
+  NnInput_Init(&nn_input, nn_in_buffers[0], nn_in_buffers[1], *nnin_length, NeuralNetwork_BindInput);
+#else
+  // Get the input buffer address
+  NnInput_Init(&nn_input, (uint8_t *) LL_Buffer_addr_start(&nn_in_info[0]), NULL, *nnin_length, NULL);
+#endif
+
+#if !defined(LL_ATON_RT_RELOC)
+  /* Set before the instance init, kept across the re-arms of the resident runtime */
+  LL_ATON_RT_SetEpochCallback(NeuralNetwork_EpochTrace, &NN_Instance_Default);
+
+  /* Buffer dependencies of overlap and weight prefetch: network_eb_deps.c must be generated again along with
+   * network.c (Tools/gen_eb_deps.py) */
+  assert(LL_ATON_EbDeps_Validate(&NN_Interface_Default, LL_ATON_EpochBlockDeps_Default()));
+
+#if defined(LL_ATON_RT_EB_OVERLAP)
+  {
+    LL_ATON_EbDeps_Summary_t summary;
+
+    /* Only the SW epoch blocks independent from the next epoch blob are overlapped, list them */
+    LL_ATON_EbDeps_Analyze(LL_ATON_EpochBlockItems_Default(), LL_ATON_EpochBlockDeps_Default(), NULL, true, &summary);
+    LL_ATON_RT_SetEpochBlockDeps(LL_ATON_EpochBlockDeps_Default(), &NN_Instance_Default);
+  }
+#endif
+
+  /* Runtime and instance stay initialized; inferences are stepped asynchronously from the main loop */
+  LL_ATON_RT_Resident_Init(&nn_resident, &NN_Instance_Default);
+
+  WeightPrefetch_Init(NN_WEIGHT_PREFETCH_MODE, LL_ATON_EpochBlockDeps_Default(), NN_WEIGHTS_ADDR, NN_WEIGHTS_SIZE);
+#endif
+
+#if NPU_PROFILER_RUNS
+  NpuProfiler_Init(NPU_PROFILER_RUNS);
+#endif
 }
 
 static void NPURam_enable(void)
@@ -437,7 +917,73 @@ static void Display_binding_line(int x0, int y0, int x1, int y1, uint32_t color)
   clamp_point(&x0, &y0);
   clamp_point(&x1, &y1);
 
-  UTIL_LCD_DrawLine(x0, y0, x1, y1, color);
+  OverlayDraw_Line(&lcd_fg_overlay, x0, y0, x1, y1, BINDING_WIDTH, color);
+}
+
+/**
+* @brief Select the foreground buffer of the next frame and clear what was drawn in it last time
+*/
+static void Display_BeginFrame(void)
+{
+  OverlayDamage_t *damage = &lcd_fg_damage[lcd_fg_buffer_rd_idx];
+  int ret;
+
+  /* Also waits for the previous frame drawing */
+  OverlayDraw_Begin(&lcd_fg_overlay, lcd_fg_buffer[lcd_fg_buffer_rd_idx]);
+
+  ret = HAL_LTDC_SetAddress_NoReload(&hlcd_ltdc, (uint32_t) lcd_fg_buffer[lcd_fg_buffer_rd_idx], LTDC_LAYER_2);
+  assert(ret == HAL_OK);
+
+  /* Clear the previous drawing only, first ops of the frame queue */
+  for (uint32_t i = 0; i < damage->nb_rects; i++)
+  {
+    OverlayRect_t *r = &damage->rects[i];
+    OverlayDraw_FillRect(&lcd_fg_overlay, r->x0, r->y0, r->x1 - r->x0, r->y1 - r->y0, 0x00000000);
+  }
+  OverlayDamage_Reset(damage);
+}
+
+/**
+* @brief Completion of the frame drawing queue: show the foreground buffer
+*
+* @param arg damaged regions of the drawn foreground buffer
+*/
+static void Display_FrameDone(void *arg)
+{
+  int ret;
+
+  if (lcd_fg_overlay.backend->cpu_writes)
+    Display_DamageCacheClean(lcd_fg_overlay.fb, arg);
+  ret = HAL_LTDC_ReloadLayer(&hlcd_ltdc, LTDC_RELOAD_VERTICAL_BLANKING, LTDC_LAYER_2);
+  assert(ret == HAL_OK);
+  LatencyTrace_End(LATENCY_STAGE_DRAW);
+}
+
+/**
+* @brief Clean the data cache over the damaged regions of a foreground buffer
+*
+* @param buffer foreground buffer
+* @param damage regions to clean
+*/
+static void Display_DamageCacheClean(uint8_t *buffer, const OverlayDamage_t *damage)
+{
+  const uint32_t pitch = LCD_FG_WIDTH * 2;
+
+  for (uint32_t i = 0; i < damage->nb_rects; i++)
+  {
+    const OverlayRect_t *r = &damage->rects[i];
+    int full_rows = r->x0 == 0 && r->x1 == LCD_FG_WIDTH;
+    /* Full width rectangles are contiguous, others are cleaned line per line */
+    uint32_t nb_ops = full_rows ? 1 : r->y1 - r->y0;
+    int32_t len = full_rows ? (r->y1 - r->y0) * pitch : (r->x1 - r->x0) * 2;
+
+    for (uint32_t y = 0; y < nb_ops; y++)
+    {
+      uint8_t *addr = buffer + (r->y0 + y) * pitch + r->x0 * 2;
+
+      SCB_CleanDCache_by_Addr(addr, len);
+    }
+  }
 }
 
 /**
@@ -451,57 +997,70 @@ static void Display_NetworkOutput(void *p_postprocess, uint32_t inference_ms)
 #if POSTPROCESS_TYPE == POSTPROCESS_MPE_YOLO_V8_UF
   mpe_pp_outBuffer_t *rois = ((mpe_pp_out_t *) p_postprocess)->pOutBuff;
   uint32_t nb_rois = ((mpe_pp_out_t *) p_postprocess)->nb_detect;
-#elif POSTPROCESS_TYPE == POSTPROCESS_SPE_MOVENET_UF
+#elif POSTPROCESS_TYPE == POSTPROCESS_SPE_MOVENET_UF || POSTPROCESS_TYPE == POSTPROCESS_SPE_MOVENET_UI
   spe_pp_outBuffer_t *roi = ((spe_pp_out_t *) p_postprocess)->pOutBuff;
 #endif
-  int ret;
-
-  ret = HAL_LTDC_SetAddress_NoReload(&hlcd_ltdc, (uint32_t) lcd_fg_buffer[lcd_fg_buffer_rd_idx], LTDC_LAYER_2);
-  assert(ret == HAL_OK);
+  OverlayDamage_t *damage = &lcd_fg_damage[lcd_fg_buffer_rd_idx];
 
   /* Draw bounding boxes */
-  UTIL_LCD_FillRect(lcd_fg_area.X0, lcd_fg_area.Y0, lcd_fg_area.XSize, lcd_fg_area.YSize, 0x00000000); /* Clear previous boxes */
 #if POSTPROCESS_TYPE == POSTPROCESS_MPE_YOLO_V8_UF
+  int x0, y0, x1, y1;
+
+  /* One damaged region per detection, merged by the damage tracker when they overlap or outnumber its slots */
   for (int i = 0; i < nb_rois; i++)
+  {
     Display_mpe_Detection(&rois[i]);
-  UTIL_LCDEx_PrintfAt(0, LINE(2), CENTER_MODE, "Objects %u", nb_rois);
-#elif POSTPROCESS_TYPE == POSTPROCESS_SPE_MOVENET_UF
+    if (Display_mpe_GetDrawnArea(&x0, &y0, &x1, &y1))
+      OverlayDamage_Add(damage, x0, y0, x1 - x0, y1 - y0);
+  }
+  OverlayDraw_PrintfAt(&lcd_fg_overlay, 0, LINE(2), OVERLAY_DRAW_ALIGN_CENTER, "Objects %u", nb_rois);
+  OverlayDamage_Add(damage, 0, LINE(2), LCD_FG_WIDTH, LINE(3) - LINE(2));
+#elif POSTPROCESS_TYPE == POSTPROCESS_SPE_MOVENET_UF || POSTPROCESS_TYPE == POSTPROCESS_SPE_MOVENET_UI
+  int x0, y0, x1, y1;
+
   Display_spe_Detection(roi);
+  if (Display_spe_GetDrawnArea(&x0, &y0, &x1, &y1))
+    OverlayDamage_Add(damage, x0, y0, x1 - x0, y1 - y0);
 #endif
+  /* Gesture and debug text lines */
+  OverlayDamage_Add(damage, 0, LINE(15), LCD_FG_WIDTH, LINE(21) - LINE(15));
 
   // *** GESTURE DISPLAY AND DEBUGGING ***
   GestureType_t current_gesture = Gesture_GetCurrentDisplayGesture(&gesture_detector);
   // To save the current gesture
 
-  UTIL_LCD_SetBackColor(0x40000000);
-  UTIL_LCDEx_PrintfAt(0, LINE(19), CENTER_MODE, "Inference: %ums", inference_ms);
+  OverlayDraw_SetBackColor(&lcd_fg_overlay, 0x40000000);
+  OverlayDraw_PrintfAt(&lcd_fg_overlay, 0, LINE(19), OVERLAY_DRAW_ALIGN_CENTER, "Inference: %ums", inference_ms);
   //UTIL_LCDEx_PrintfAt(0, LINE(18), CENTER_MODE, "STM32 Edge AI Contest");
 
   // Gesture detection result
    if (current_gesture != GESTURE_NONE) {
-     UTIL_LCD_SetTextColor(UTIL_LCD_COLOR_YELLOW); // Highlight detected gesture
-     UTIL_LCDEx_PrintfAt(0, LINE(16), CENTER_MODE, "GESTURE: %s", Gesture_GetName(current_gesture));
-     UTIL_LCD_SetTextColor(UTIL_LCD_COLOR_WHITE);  // Reset to white
+     OverlayDraw_SetTextColor(&lcd_fg_overlay, UTIL_LCD_COLOR_YELLOW); // Highlight detected gesture
+     OverlayDraw_PrintfAt(&lcd_fg_overlay, 0, LINE(16), OVERLAY_DRAW_ALIGN_CENTER, "GESTURE: %s", Gesture_GetName(current_gesture));
+     OverlayDraw_SetTextColor(&lcd_fg_overlay, UTIL_LCD_COLOR_WHITE);  // Reset to white
    } else {
-     UTIL_LCDEx_PrintfAt(0, LINE(16), CENTER_MODE, "Gesture: %s", Gesture_GetName(current_gesture));
+     OverlayDraw_PrintfAt(&lcd_fg_overlay, 0, LINE(16), OVERLAY_DRAW_ALIGN_CENTER, "Gesture: %s", Gesture_GetName(current_gesture));
    }
 
   //Debug the head postiion
   float32_t  x_coord=roi[0].x_center;
   float32_t  y_coord=roi[0].y_center;
   float32_t confidence = roi[0].proba;
-  UTIL_LCDEx_PrintfAt(0, LINE(20), CENTER_MODE, "X: %f, Y: %f P:%f", x_coord,y_coord, confidence	  );
+  OverlayDraw_PrintfAt(&lcd_fg_overlay, 0, LINE(20), OVERLAY_DRAW_ALIGN_CENTER, "X: %f, Y: %f P:%f", x_coord,y_coord, confidence	  );
   //Check if gesture_detector is being updated correctly
-  UTIL_LCDEx_PrintfAt(0, LINE(20), CENTER_MODE, "X: %f, Y: %f P:%f", x_coord,y_coord, confidence	  );
+  OverlayDraw_PrintfAt(&lcd_fg_overlay, 0, LINE(20), OVERLAY_DRAW_ALIGN_CENTER, "X: %f, Y: %f P:%f", x_coord,y_coord, confidence	  );
 
   //End of debug head position
 
-  UTIL_LCD_SetBackColor(0);
+  OverlayDraw_SetBackColor(&lcd_fg_overlay, 0);
   Display_WelcomeScreen();
 
-  SCB_CleanDCache_by_Addr(lcd_fg_buffer[lcd_fg_buffer_rd_idx], LCD_FG_FRAMEBUFFER_SIZE);
-  ret = HAL_LTDC_ReloadLayer(&hlcd_ltdc, LTDC_RELOAD_VERTICAL_BLANKING, LTDC_LAYER_2);
-  assert(ret == HAL_OK);
+  /* Drawn in the background, the layer is reloaded once complete */
+#if NN_CROP_BACKEND == IMG_CROP_DMA2D
+  /* DMA2D still copying the NN input */
+  img_crop_dma2d_wait();
+#endif
+  OverlayDraw_Flush(&lcd_fg_overlay, Display_FrameDone, damage);
   lcd_fg_buffer_rd_idx = 1 - lcd_fg_buffer_rd_idx;
 }
 
@@ -530,15 +1089,24 @@ static void LCD_init(void)
   UTIL_LCD_SetFuncDriver(&LCD_Driver);
   UTIL_LCD_SetLayer(LTDC_LAYER_2);
   UTIL_LCD_Clear(0x00000000);
+  /* Only the first buffer is cleared above, the second one is fully cleared on its first use */
+  OverlayDamage_Init(&lcd_fg_damage[0], LCD_FG_WIDTH, LCD_FG_HEIGHT);
+  OverlayDamage_Init(&lcd_fg_damage[1], LCD_FG_WIDTH, LCD_FG_HEIGHT);
+  OverlayDamage_AddFull(&lcd_fg_damage[1]);
   UTIL_LCD_SetFont(&Font20);
   UTIL_LCD_SetTextColor(UTIL_LCD_COLOR_WHITE);
 
+  OverlayDraw_Dma2d_Init();
+  OverlayDraw_Init(&lcd_fg_overlay, &OverlayDraw_Dma2dBackend, LCD_FG_WIDTH, LCD_FG_HEIGHT);
+  OverlayDraw_SetFont(&lcd_fg_overlay, &Font20, lcd_fg_glyph_atlas, sizeof(lcd_fg_glyph_atlas));
+  OverlayDraw_SetTextColor(&lcd_fg_overlay, UTIL_LCD_COLOR_WHITE);
+
 #if POSTPROCESS_TYPE == POSTPROCESS_MPE_YOLO_V8_UF
   Display_mpe_InitFunctions(clamp_point,
                             convert_length,
                             convert_point,
                             Display_binding_line);
-#elif POSTPROCESS_TYPE == POSTPROCESS_SPE_MOVENET_UF
+#elif POSTPROCESS_TYPE == POSTPROCESS_SPE_MOVENET_UF || POSTPROCESS_TYPE == POSTPROCESS_SPE_MOVENET_UI
   Display_spe_InitFunctions(clamp_point,
                             convert_length,
                             convert_point,
@@ -558,14 +1126,15 @@ static void Display_WelcomeScreen(void)
   if (HAL_GetTick() - t0 < 4000)
   {
     /* Draw logo */
-    UTIL_LCD_FillRGBRect(300, 100, (uint8_t *) stlogo, 200, 107);
+    OverlayDraw_Bitmap(&lcd_fg_overlay, 300, 100, 200, 107, stlogo);
+    OverlayDamage_Add(&lcd_fg_damage[lcd_fg_buffer_rd_idx], 300, 100, 200, 107);
 
     /* Display welcome message */
-    UTIL_LCD_SetBackColor(0x40000000);
-    UTIL_LCDEx_PrintfAt(0, LINE(16), CENTER_MODE, "Pose estimation");
-    UTIL_LCDEx_PrintfAt(0, LINE(17), CENTER_MODE, WELCOME_MSG_1);
-    UTIL_LCDEx_PrintfAt(0, LINE(18), CENTER_MODE, WELCOME_MSG_2);
-    UTIL_LCD_SetBackColor(0);
+    OverlayDraw_SetBackColor(&lcd_fg_overlay, 0x40000000);
+    OverlayDraw_PrintfAt(&lcd_fg_overlay, 0, LINE(16), OVERLAY_DRAW_ALIGN_CENTER, "Pose estimation");
+    OverlayDraw_PrintfAt(&lcd_fg_overlay, 0, LINE(17), OVERLAY_DRAW_ALIGN_CENTER, WELCOME_MSG_1);
+    OverlayDraw_PrintfAt(&lcd_fg_overlay, 0, LINE(18), OVERLAY_DRAW_ALIGN_CENTER, WELCOME_MSG_2);
+    OverlayDraw_SetBackColor(&lcd_fg_overlay, 0);
   }
 }
 
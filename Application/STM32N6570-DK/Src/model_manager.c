@@ -0,0 +1,219 @@
+/**
+ ******************************************************************************
+ * @file    model_manager.c
+ * @brief   Relocatable networks stored in the xSPI NOR, installed and switched
+ *          at runtime
+ ******************************************************************************
+ */
+
+#include "model_manager.h"
+
+#if defined(LL_ATON_RT_RELOC)
+
+#include <assert.h>
+#include <string.h>
+
+#define EXEC_RAM_ALIGN(v)   (((v) + 7) & ~7UL)
+
+typedef struct {
+  uintptr_t file_ptr;           /* Binary in the memory-mapped NOR */
+  ll_aton_reloc_info info;
+  uint8_t cached;               /* Relocated data still valid in the exec arena */
+  uintptr_t exec_ram;
+  uint32_t exec_ram_size;
+  NN_Instance_TypeDef instance;
+} ModelEntry_t;
+
+__attribute__ ((aligned (8)))
+static uint8_t exec_ram[MODEL_MANAGER_EXEC_RAM_SIZE];
+__attribute__ ((section (".psram_bss")))
+__attribute__ ((aligned (32)))
+static uint8_t ext_ram[MODEL_MANAGER_EXT_RAM_SIZE];
+
+static ModelEntry_t models[MODEL_MANAGER_NB_SLOTS];
+static int nb_models;
+static int active_model = -1;
+static uint32_t exec_ram_used;
+static ModelManager_Stats_t stats;
+
+static void ModelManager_GetConfig(const ModelEntry_t *model, ll_aton_reloc_config *config)
+{
+  memset(config, 0, sizeof(*config));
+  config->exec_ram_addr = model->exec_ram;
+  config->exec_ram_size = model->exec_ram_size;
+  config->ext_ram_addr = (uintptr_t) ext_ram;
+  config->ext_ram_size = sizeof(ext_ram);
+  config->ext_param_addr = 0; /* Weights read in place from the NOR */
+  config->mode = AI_RELOC_RT_LOAD_MODE_XIP;
+}
+
+/* Reserves the exec RAM of a model, evicting all the cached images when the arena is full */
+static int ModelManager_AllocExecRam(ModelEntry_t *model)
+{
+  uint32_t size = EXEC_RAM_ALIGN(model->info.rt_ram_xip);
+
+  if (size > sizeof(exec_ram))
+  {
+    return -1;
+  }
+  if (exec_ram_used + size > sizeof(exec_ram))
+  {
+    for (int i = 0; i < nb_models; i++)
+    {
+      models[i].cached = 0;
+    }
+    exec_ram_used = 0;
+    stats.nb_evictions++;
+  }
+
+  model->exec_ram = (uintptr_t) &exec_ram[exec_ram_used];
+  model->exec_ram_size = size;
+  exec_ram_used += size;
+
+  return 0;
+}
+
+int ModelManager_Init(void)
+{
+  memset(models, 0, sizeof(models));
+  memset(&stats, 0, sizeof(stats));
+  nb_models = 0;
+  active_model = -1;
+  exec_ram_used = 0;
+
+  for (int slot = 0; slot < MODEL_MANAGER_NB_SLOTS; slot++)
+  {
+    uintptr_t file_ptr = MODEL_MANAGER_FLASH_BASE + slot * MODEL_MANAGER_SLOT_SIZE;
+    ModelEntry_t *model = &models[nb_models];
+
+    /* Erased or foreign slots are skipped */
+    if (*(const volatile uint32_t *) file_ptr != AI_RELOC_MAGIC)
+    {
+      continue;
+    }
+    if (ll_aton_reloc_get_info(file_ptr, &model->info) != AI_RELOC_RT_ERR_NONE)
+    {
+      continue;
+    }
+    if (EXEC_RAM_ALIGN(model->info.rt_ram_xip) > sizeof(exec_ram) || model->info.ext_ram_sz > sizeof(ext_ram))
+    {
+      continue;
+    }
+
+    model->file_ptr = file_ptr;
+    nb_models++;
+  }
+
+  return nb_models;
+}
+
+int ModelManager_GetCount(void)
+{
+  return nb_models;
+}
+
+const ll_aton_reloc_info *ModelManager_GetInfo(int index)
+{
+  if (index < 0 || index >= nb_models)
+  {
+    return NULL;
+  }
+
+  return &models[index].info;
+}
+
+int ModelManager_Find(const char *c_name)
+{
+  for (int i = 0; i < nb_models; i++)
+  {
+    if (strcmp(models[i].info.c_name, c_name) == 0)
+    {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+NN_Instance_TypeDef *ModelManager_Select(int index, LL_ATON_RT_Resident_TypeDef *resident,
+                                         TraceEpochBlock_FuncPtr_t epoch_cb)
+{
+  ll_aton_reloc_config config;
+  ModelEntry_t *model;
+  uint32_t ts;
+  int ret;
+
+  assert(resident != NULL);
+  if (index < 0 || index >= nb_models)
+  {
+    return NULL;
+  }
+
+  model = &models[index];
+  if (index == active_model && resident->nn_instance == &model->instance)
+  {
+    return &model->instance;
+  }
+
+  ts = MODEL_MANAGER_GET_TS();
+
+  /* The NPU memories are shared: the current model gives them up first */
+  if (resident->nn_instance != NULL)
+  {
+    assert(!resident->running);
+    LL_ATON_RT_Resident_DeInit(resident);
+  }
+  active_model = -1;
+
+  if (model->cached)
+  {
+    /* Relocated code and data are still valid, only the pools overwritten by the other models are restored */
+    ModelManager_GetConfig(model, &config);
+    ret = ll_aton_reloc_reload_mpools(model->file_ptr, &config);
+    if (ret == AI_RELOC_RT_ERR_NONE)
+    {
+      stats.nb_cache_hits++;
+    }
+  }
+  else
+  {
+    ret = ModelManager_AllocExecRam(model);
+    if (ret == 0)
+    {
+      ModelManager_GetConfig(model, &config);
+      ret = ll_aton_reloc_install(model->file_ptr, &config, &model->instance);
+    }
+    if (ret == AI_RELOC_RT_ERR_NONE)
+    {
+      model->cached = 1;
+      stats.nb_installs++;
+    }
+  }
+
+  if (ret != AI_RELOC_RT_ERR_NONE)
+  {
+    model->cached = 0;
+    return NULL;
+  }
+
+  /* The install resets the execution state, the callback is set again before the instance init */
+  LL_ATON_RT_SetEpochCallback(epoch_cb, &model->instance);
+  LL_ATON_RT_Resident_Init(resident, &model->instance);
+  active_model = index;
+
+  stats.last_switch_ticks = MODEL_MANAGER_GET_TS() - ts;
+
+  return &model->instance;
+}
+
+int ModelManager_GetActive(void)
+{
+  return active_model;
+}
+
+const ModelManager_Stats_t *ModelManager_GetStats(void)
+{
+  return &stats;
+}
+
+#endif /* LL_ATON_RT_RELOC */
@@ -0,0 +1,115 @@
+/**
+ ******************************************************************************
+ * @file    nn_input.c
+ * @brief   Ownership of the NN input buffers between the CPU and the NPU
+ ******************************************************************************
+ */
+
+#include "nn_input.h"
+#include <assert.h>
+#include <stddef.h>
+
+static int NnInput_Find(const NnInput_TypeDef *in, NnInput_State_t state)
+{
+  for (int i = 0; i < in->nb_buffers; i++)
+  {
+    if (in->states[i] == state)
+      return i;
+  }
+  return -1;
+}
+
+static int NnInput_Index(const NnInput_TypeDef *in, const uint8_t *buffer)
+{
+  for (int i = 0; i < in->nb_buffers; i++)
+  {
+    if (in->buffers[i] == buffer)
+      return i;
+  }
+  assert(0);
+  return -1;
+}
+
+void NnInput_Init(NnInput_TypeDef *in, uint8_t *buffer0, uint8_t *buffer1, uint32_t len, NnInput_BindFunc_t bind)
+{
+  assert(buffer0 != NULL);
+  assert((buffer1 == NULL) == (bind == NULL));
+
+  in->buffers[0] = buffer0;
+  in->buffers[1] = buffer1;
+  in->states[0] = NN_INPUT_FREE;
+  in->states[1] = NN_INPUT_FREE;
+  in->nb_buffers = buffer1 ? 2 : 1;
+  in->len = len;
+  /* A single buffer is the network's own input */
+  in->bound = buffer1 ? -1 : 0;
+  in->bind = bind;
+}
+
+uint8_t *NnInput_AcquireWrite(NnInput_TypeDef *in)
+{
+  /* A frame waiting for the NPU is replaced by the newer one rather than queued behind it */
+  int idx = NnInput_Find(in, NN_INPUT_READY);
+
+  if (idx < 0)
+    idx = NnInput_Find(in, NN_INPUT_FREE);
+  if (idx < 0)
+    return NULL;
+
+  in->states[idx] = NN_INPUT_WRITING;
+  return in->buffers[idx];
+}
+
+int NnInput_CanWrite(const NnInput_TypeDef *in)
+{
+  return NnInput_Find(in, NN_INPUT_READY) >= 0 || NnInput_Find(in, NN_INPUT_FREE) >= 0;
+}
+
+void NnInput_CommitWrite(NnInput_TypeDef *in, uint8_t *buffer)
+{
+  int idx = NnInput_Index(in, buffer);
+
+  assert(in->states[idx] == NN_INPUT_WRITING);
+  in->states[idx] = NN_INPUT_READY;
+}
+
+void NnInput_CancelWrite(NnInput_TypeDef *in, uint8_t *buffer)
+{
+  int idx = NnInput_Index(in, buffer);
+
+  assert(in->states[idx] == NN_INPUT_WRITING);
+  in->states[idx] = NN_INPUT_FREE;
+}
+
+int NnInput_IsReady(const NnInput_TypeDef *in)
+{
+  return NnInput_Find(in, NN_INPUT_READY) >= 0;
+}
+
+uint8_t *NnInput_StartInference(NnInput_TypeDef *in)
+{
+  int idx = NnInput_Find(in, NN_INPUT_READY);
+  int ret;
+
+  assert(idx >= 0);
+  assert(NnInput_Find(in, NN_INPUT_NPU) < 0);
+
+  if (idx != in->bound)
+  {
+    ret = in->bind(in->buffers[idx], in->len);
+    assert(ret == 0);
+    (void) ret;
+    in->bound = idx;
+  }
+  in->states[idx] = NN_INPUT_NPU;
+
+  return in->buffers[idx];
+}
+
+void NnInput_InferenceDone(NnInput_TypeDef *in)
+{
+  int idx = NnInput_Find(in, NN_INPUT_NPU);
+
+  assert(idx >= 0);
+  in->states[idx] = NN_INPUT_FREE;
+}
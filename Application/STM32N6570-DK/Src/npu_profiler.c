@@ -0,0 +1,268 @@
+/**
+ ******************************************************************************
+ * @file    npu_profiler.c
+ * @brief   Per epoch block NPU performance counters, reported as CSV
+ ******************************************************************************
+ */
+
+#include "npu_profiler.h"
+#include <stdio.h>
+#include <string.h>
+#include "stm32n6xx.h"
+#include "ll_aton.h"
+#include "ll_aton_dbgtrc.h"
+
+#define NB_COUNTERS         16
+/* NPU clock cycles in the STRENG_* groups, after the stream engine counters */
+#define NPU_CYCLES_COUNTER  ATON_STRENG_NUM
+
+#if NPU_CYCLES_COUNTER >= NB_COUNTERS
+#error "No debug and trace counter left for the NPU clock cycles"
+#endif
+
+typedef struct {
+  NpuProfiler_EbStats_t stats;
+  uint32_t snap_ts;                     /* Sampled at PRE_START */
+  uint32_t snap[NB_COUNTERS];
+} ProfilerEb_t;
+
+static ProfilerEb_t eb_state[NPU_PROFILER_MAX_EB];
+static int nb_eb;
+static uint32_t nb_runs;                /* Inferences started */
+static uint32_t total_runs;
+static int sampling;                    /* Current inference is part of the profile */
+static NpuProfiler_Group_t group;       /* Sampled by the current inference */
+static uint32_t inference_ts;
+
+static const char *NpuProfiler_Kind(uint16_t flags)
+{
+  if (flags & EpochBlock_Flags_blob)
+    return "blob";
+  if (flags & EpochBlock_Flags_pure_sw)
+    return "sw";
+  if (flags & EpochBlock_Flags_hybrid)
+    return "hybrid";
+  return "hw";
+}
+
+static void NpuProfiler_ReadCounters(uint32_t *counters)
+{
+  for (int i = 0; i < NB_COUNTERS; i++)
+  {
+    counters[i] = LL_Dbgtrc_Counter_Read(0, i);
+  }
+}
+
+/* Programs the counters of the group sampled by the inference about to start */
+static void NpuProfiler_StartGroup(NpuProfiler_Group_t new_group)
+{
+  const uint32_t all_strengs = (1U << ATON_STRENG_NUM) - 1;
+  LL_Dbgtrc_Counter_InitTypdef cycles_init = {
+    .signal = DBGTRC_VDD,
+    .evt_type = DBGTRC_EVT_HI,
+    .int_disable = 1,
+  };
+
+  group = new_group;
+  switch (group)
+  {
+    case NPU_PROFILER_GROUP_BUS:
+      LL_Dbgtrc_BurstLenBenchStart(0);
+      return;
+    case NPU_PROFILER_GROUP_STRENG_IN:
+      LL_Dbgtrc_Count_StrengActive_Config(all_strengs, 0, 0);
+      LL_Dbgtrc_Count_StrengActive_Start(all_strengs, 0, 0);
+      break;
+    default:
+      LL_Dbgtrc_Count_StrengActive_Config(0, all_strengs, 0);
+      LL_Dbgtrc_Count_StrengActive_Start(0, all_strengs, 0);
+      break;
+  }
+  LL_Dbgtrc_Counter_Init(0, NPU_CYCLES_COUNTER, &cycles_init);
+  LL_Dbgtrc_Counter_Start(0, NPU_CYCLES_COUNTER);
+}
+
+/* Adds the counters of the current group moved since 'snap' */
+static void NpuProfiler_Accumulate(NpuProfiler_EbStats_t *stats, const uint32_t *snap, const uint32_t *counters)
+{
+  uint32_t delta[NB_COUNTERS];
+
+  /* The counters wrap around, their differences stay right */
+  for (int i = 0; i < NB_COUNTERS; i++)
+  {
+    delta[i] = counters[i] - snap[i];
+  }
+
+  stats->group_count[group]++;
+  switch (group)
+  {
+    case NPU_PROFILER_GROUP_BUS:
+      for (int i = 0; i < NB_COUNTERS; i++)
+        stats->bursts[i] += delta[i];
+      return;
+    case NPU_PROFILER_GROUP_STRENG_IN:
+      for (int i = 0; i < ATON_STRENG_NUM; i++)
+        stats->streng_in[i] += delta[i];
+      break;
+    default:
+      for (int i = 0; i < ATON_STRENG_NUM; i++)
+        stats->streng_out[i] += delta[i];
+      break;
+  }
+  stats->npu_cycles[group] += delta[NPU_CYCLES_COUNTER];
+}
+
+void NpuProfiler_Init(uint32_t runs_per_group)
+{
+  memset(eb_state, 0, sizeof(eb_state));
+  nb_eb = 0;
+  nb_runs = 0;
+  total_runs = runs_per_group * NPU_PROFILER_GROUP_NB;
+  sampling = 0;
+
+  LL_Dbgtrc_Init(0);
+}
+
+void NpuProfiler_EpochCallback(LL_ATON_RT_Callbacktype_t ctype, const NN_Instance_TypeDef *nn_instance,
+                               const EpochBlock_ItemTypeDef *eb)
+{
+  const NN_Execution_State_TypeDef *exec_state = &nn_instance->exec_state;
+  uint32_t counters[NB_COUNTERS];
+  ProfilerEb_t *state;
+  int eb_idx;
+
+  /* Epoch blocks inserted by hybrid epochs are accounted to the one they belong to */
+  if (exec_state->saved_first_epoch_block != NULL)
+  {
+    return;
+  }
+
+  eb_idx = eb - exec_state->first_epoch_block;
+  if (ctype == LL_ATON_RT_Callbacktype_PRE_START && eb_idx == 0)
+  {
+    sampling = nb_runs < total_runs;
+    if (sampling)
+    {
+      NpuProfiler_StartGroup(nb_runs % NPU_PROFILER_GROUP_NB);
+      nb_runs++;
+      inference_ts = DWT->CYCCNT;
+    }
+  }
+  /* Profile done, or started in the middle of an inference */
+  if (!sampling || eb_idx >= NPU_PROFILER_MAX_EB)
+  {
+    return;
+  }
+
+  state = &eb_state[eb_idx];
+  if (ctype == LL_ATON_RT_Callbacktype_PRE_START)
+  {
+    if (eb_idx >= nb_eb)
+    {
+      nb_eb = eb_idx + 1;
+      state->stats.flags = eb->flags;
+      state->stats.min_ticks = UINT32_MAX;
+    }
+    state->snap_ts = DWT->CYCCNT;
+    NpuProfiler_ReadCounters(state->snap);
+  }
+  else if (ctype == LL_ATON_RT_Callbacktype_POST_END && eb_idx < nb_eb)
+  {
+    uint32_t ticks;
+
+    NpuProfiler_ReadCounters(counters);
+    ticks = DWT->CYCCNT - state->snap_ts;
+
+    state->stats.count++;
+    state->stats.start_ticks += state->snap_ts - inference_ts;
+    state->stats.ticks += ticks;
+    state->stats.min_ticks = ticks < state->stats.min_ticks ? ticks : state->stats.min_ticks;
+    state->stats.max_ticks = ticks > state->stats.max_ticks ? ticks : state->stats.max_ticks;
+    NpuProfiler_Accumulate(&state->stats, state->snap, counters);
+  }
+}
+
+int NpuProfiler_IsDone(void)
+{
+  return total_runs != 0 && nb_runs == total_runs && nb_eb != 0 &&
+         eb_state[nb_eb - 1].stats.count == total_runs;
+}
+
+int NpuProfiler_GetNbEb(void)
+{
+  return nb_eb;
+}
+
+void NpuProfiler_GetStats(int eb_idx, NpuProfiler_EbStats_t *stats)
+{
+  *stats = eb_state[eb_idx].stats;
+}
+
+int NpuProfiler_ReportLine(int line, char *buffer, size_t size)
+{
+  uint32_t ticks_per_us = SystemCoreClock >= 1000000 ? SystemCoreClock / 1000000 : 1;
+  const NpuProfiler_EbStats_t *stats;
+  uint32_t n_bus, n_in, n_out, n_cycles;
+  uint64_t rd_bytes = 0, wr_bytes = 0;
+  int len;
+
+  if (line == 0)
+  {
+    len = snprintf(buffer, size, "npu,eb,kind,count,start_us,avg_us,min_us,max_us,npu_cycles,rd_bytes,wr_bytes,"
+                   "rd_b1,rd_b2,rd_b4,rd_b8,wr_b1,wr_b2,wr_b4,wr_b8");
+    for (int i = 0; i < ATON_STRENG_NUM && len >= 0 && (size_t) len < size; i++)
+      len += snprintf(buffer + len, size - len, ",in%d", i);
+    for (int i = 0; i < ATON_STRENG_NUM && len >= 0 && (size_t) len < size; i++)
+      len += snprintf(buffer + len, size - len, ",out%d", i);
+  }
+  else if (line <= nb_eb && eb_state[line - 1].stats.count != 0)
+  {
+    stats = &eb_state[line - 1].stats;
+    /* Averages over the executions which sampled each value */
+    n_bus = stats->group_count[NPU_PROFILER_GROUP_BUS] ? stats->group_count[NPU_PROFILER_GROUP_BUS] : 1;
+    n_in = stats->group_count[NPU_PROFILER_GROUP_STRENG_IN] ? stats->group_count[NPU_PROFILER_GROUP_STRENG_IN] : 1;
+    n_out = stats->group_count[NPU_PROFILER_GROUP_STRENG_OUT] ? stats->group_count[NPU_PROFILER_GROUP_STRENG_OUT] : 1;
+    n_cycles = stats->group_count[NPU_PROFILER_GROUP_STRENG_IN] + stats->group_count[NPU_PROFILER_GROUP_STRENG_OUT];
+    n_cycles = n_cycles ? n_cycles : 1;
+
+    /* Burst lengths 1, 2, 4 and 8 beats of 8 bytes, writes then reads of each bus interface */
+    for (int i = 0; i < 4; i++)
+    {
+      wr_bytes += (stats->bursts[i] + stats->bursts[8 + i]) << (i + 3);
+      rd_bytes += (stats->bursts[4 + i] + stats->bursts[12 + i]) << (i + 3);
+    }
+
+    len = snprintf(buffer, size, "npu,%d,%s,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu", line - 1, NpuProfiler_Kind(stats->flags),
+                   (unsigned long) stats->count,
+                   (unsigned long) (stats->start_ticks / stats->count / ticks_per_us),
+                   (unsigned long) (stats->ticks / stats->count / ticks_per_us),
+                   (unsigned long) (stats->min_ticks / ticks_per_us),
+                   (unsigned long) (stats->max_ticks / ticks_per_us),
+                   (unsigned long) ((stats->npu_cycles[NPU_PROFILER_GROUP_STRENG_IN] +
+                                     stats->npu_cycles[NPU_PROFILER_GROUP_STRENG_OUT]) / n_cycles),
+                   (unsigned long) (rd_bytes / n_bus),
+                   (unsigned long) (wr_bytes / n_bus));
+    for (int i = 0; i < 4 && len >= 0 && (size_t) len < size; i++)
+      len += snprintf(buffer + len, size - len, ",%lu",
+                      (unsigned long) ((stats->bursts[4 + i] + stats->bursts[12 + i]) / n_bus));
+    for (int i = 0; i < 4 && len >= 0 && (size_t) len < size; i++)
+      len += snprintf(buffer + len, size - len, ",%lu",
+                      (unsigned long) ((stats->bursts[i] + stats->bursts[8 + i]) / n_bus));
+    for (int i = 0; i < ATON_STRENG_NUM && len >= 0 && (size_t) len < size; i++)
+      len += snprintf(buffer + len, size - len, ",%lu", (unsigned long) (stats->streng_in[i] / n_in));
+    for (int i = 0; i < ATON_STRENG_NUM && len >= 0 && (size_t) len < size; i++)
+      len += snprintf(buffer + len, size - len, ",%lu", (unsigned long) (stats->streng_out[i] / n_out));
+  }
+  else
+  {
+    return 0;
+  }
+
+  if (len >= 0 && (size_t) len < size)
+    len += snprintf(buffer + len, size - len, "\r\n");
+
+  /* Truncated output: snprintf() returned the length it would have written */
+  if (len < 0)
+    return 0;
+  return (size_t) len < size ? len : (int) size - 1;
+}
@@ -0,0 +1,121 @@
+/**
+ ******************************************************************************
+ * @file    overlay_damage.c
+ * @brief   Tracking of the regions drawn in an overlay frame buffer
+ ******************************************************************************
+ */
+
+#include "overlay_damage.h"
+#include "utils.h"
+#include <string.h>
+
+static uint32_t Rect_Area(const OverlayRect_t *r)
+{
+  return (uint32_t) (r->x1 - r->x0) * (r->y1 - r->y0);
+}
+
+static int Rect_Overlap(const OverlayRect_t *a, const OverlayRect_t *b)
+{
+  return a->x0 <= b->x1 && b->x0 <= a->x1 && a->y0 <= b->y1 && b->y0 <= a->y1;
+}
+
+static void Rect_Union(OverlayRect_t *dst, const OverlayRect_t *src)
+{
+  dst->x0 = MIN(dst->x0, src->x0);
+  dst->y0 = MIN(dst->y0, src->y0);
+  dst->x1 = MAX(dst->x1, src->x1);
+  dst->y1 = MAX(dst->y1, src->y1);
+}
+
+static uint32_t Rect_UnionArea(const OverlayRect_t *a, const OverlayRect_t *b)
+{
+  OverlayRect_t u = *a;
+
+  Rect_Union(&u, b);
+  return Rect_Area(&u);
+}
+
+static void OverlayDamage_Remove(OverlayDamage_t *damage, uint32_t idx)
+{
+  damage->rects[idx] = damage->rects[damage->nb_rects - 1];
+  damage->nb_rects--;
+}
+
+void OverlayDamage_Init(OverlayDamage_t *damage, uint16_t width, uint16_t height)
+{
+  damage->width = width;
+  damage->height = height;
+  OverlayDamage_Reset(damage);
+}
+
+void OverlayDamage_Reset(OverlayDamage_t *damage)
+{
+  damage->nb_rects = 0;
+  memset(damage->rects, 0, sizeof(damage->rects));
+}
+
+void OverlayDamage_Add(OverlayDamage_t *damage, int x, int y, int w, int h)
+{
+  OverlayRect_t r;
+  int i;
+
+  /* Clip to the frame buffer */
+  r.x0 = MAX(0, MIN(x, (int) damage->width));
+  r.y0 = MAX(0, MIN(y, (int) damage->height));
+  r.x1 = MAX(0, MIN(x + w, (int) damage->width));
+  r.y1 = MAX(0, MIN(y + h, (int) damage->height));
+  if (r.x1 <= r.x0 || r.y1 <= r.y0)
+    return;
+
+  for (;;)
+  {
+    /* Absorb every overlapping or touching rectangle, so that none is cleared twice */
+    for (i = damage->nb_rects - 1; i >= 0; i--)
+    {
+      if (Rect_Overlap(&damage->rects[i], &r))
+      {
+        Rect_Union(&r, &damage->rects[i]);
+        OverlayDamage_Remove(damage, i);
+        i = damage->nb_rects;
+      }
+    }
+
+    if (damage->nb_rects < OVERLAY_DAMAGE_MAX_RECTS)
+      break;
+
+    /* Out of slots: merge with the rectangle whose union grows the least, the union may then reach other
+     * rectangles */
+    uint32_t best = 0;
+    uint32_t best_growth = UINT32_MAX;
+
+    for (i = 0; i < (int) damage->nb_rects; i++)
+    {
+      uint32_t growth = Rect_UnionArea(&damage->rects[i], &r) - Rect_Area(&damage->rects[i]);
+      if (growth < best_growth)
+      {
+        best_growth = growth;
+        best = i;
+      }
+    }
+    Rect_Union(&r, &damage->rects[best]);
+    OverlayDamage_Remove(damage, best);
+  }
+
+  damage->rects[damage->nb_rects++] = r;
+}
+
+void OverlayDamage_AddFull(OverlayDamage_t *damage)
+{
+  OverlayDamage_Reset(damage);
+  OverlayDamage_Add(damage, 0, 0, damage->width, damage->height);
+}
+
+uint32_t OverlayDamage_Area(const OverlayDamage_t *damage)
+{
+  uint32_t area = 0;
+
+  for (uint32_t i = 0; i < damage->nb_rects; i++)
+    area += Rect_Area(&damage->rects[i]);
+
+  return area;
+}
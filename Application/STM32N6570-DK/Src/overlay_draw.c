@@ -0,0 +1,547 @@
+/**
+ ******************************************************************************
+ * @file    overlay_draw.c
+ * @brief   Batched drawing of the overlay layer and CPU reference backend
+ ******************************************************************************
+ */
+
+#include "overlay_draw.h"
+#include "utils.h"
+#include <assert.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Sum of the (2r + 1)^2 masks for r in [1, radius] */
+#define CIRCLE_MASKS_SIZE(radius) (2 * (radius) * ((radius) + 1) * (2 * (radius) + 1) / 3 + \
+                                   2 * (radius) * ((radius) + 1) + (radius))
+
+static uint8_t circle_masks[CIRCLE_MASKS_SIZE(OVERLAY_DRAW_MAX_MASK_RADIUS)];
+static int circle_masks_ready;
+
+static int Circle_Inside(int dx, int dy, int radius)
+{
+  return dx * dx + dy * dy <= radius * radius + radius;
+}
+
+static const uint8_t *Circle_Mask(int radius)
+{
+  return &circle_masks[CIRCLE_MASKS_SIZE(radius - 1)];
+}
+
+static void Circle_BuildMasks(void)
+{
+  for (int r = 1; r <= OVERLAY_DRAW_MAX_MASK_RADIUS; r++)
+  {
+    uint8_t *mask = (uint8_t *) Circle_Mask(r);
+
+    for (int dy = -r; dy <= r; dy++)
+      for (int dx = -r; dx <= r; dx++)
+        *mask++ = Circle_Inside(dx, dy, r) ? 0xff : 0x00;
+  }
+  circle_masks_ready = 1;
+}
+
+void OverlayDraw_Init(OverlayDraw_t *od, const OverlayDrawBackend_t *backend, uint16_t width, uint16_t height)
+{
+  memset(od, 0, sizeof(*od));
+  od->backend = backend;
+  od->width = width;
+  od->height = height;
+  od->text_color = 0xffffffff;
+
+  if (!circle_masks_ready)
+    Circle_BuildMasks();
+  if (backend->sync_source)
+    backend->sync_source(circle_masks, sizeof(circle_masks));
+}
+
+void OverlayDraw_SetFont(OverlayDraw_t *od, const sFONT *font, uint8_t *atlas, uint32_t atlas_size)
+{
+  uint32_t bytes_per_row = (font->Width + 7) / 8;
+  const uint8_t *src = font->table;
+  uint8_t *dst = atlas;
+
+  assert(atlas_size >= OVERLAY_DRAW_GLYPH_ATLAS_SIZE(font->Width, font->Height));
+  assert(bytes_per_row <= 3);
+
+  /* Same bit order as the stm32_lcd DrawChar(): rows MSB first, padded to bytes */
+  for (uint32_t g = 0; g < OVERLAY_DRAW_NB_GLYPHS; g++)
+  {
+    for (uint32_t i = 0; i < font->Height; i++)
+    {
+      uint32_t line = 0;
+
+      for (uint32_t b = 0; b < bytes_per_row; b++)
+        line = (line << 8) | *src++;
+      for (uint32_t j = 0; j < font->Width; j++)
+        *dst++ = (line & (1U << (8 * bytes_per_row - 1 - j))) ? 0xff : 0x00;
+    }
+  }
+
+  od->font = font;
+  od->glyph_atlas = atlas;
+  if (od->backend->sync_source)
+    od->backend->sync_source(atlas, OVERLAY_DRAW_GLYPH_ATLAS_SIZE(font->Width, font->Height));
+}
+
+void OverlayDraw_SetTextColor(OverlayDraw_t *od, uint32_t color)
+{
+  od->text_color = color;
+}
+
+void OverlayDraw_SetBackColor(OverlayDraw_t *od, uint32_t color)
+{
+  od->back_color = color;
+}
+
+void OverlayDraw_Begin(OverlayDraw_t *od, uint8_t *fb)
+{
+  OverlayDraw_Wait(od);
+  od->fb = fb;
+  od->nb_prims = 0;
+  od->text_pool_used = 0;
+  od->nb_dropped = 0;
+}
+
+static OverlayPrimitive_t *OverlayDraw_Push(OverlayDraw_t *od, OverlayPrimType_t type, uint32_t color)
+{
+  OverlayPrimitive_t *prim;
+
+  assert(!od->busy);
+  if (od->nb_prims == OVERLAY_DRAW_MAX_PRIMITIVES)
+  {
+    od->nb_dropped++;
+    return NULL;
+  }
+
+  prim = &od->prims[od->nb_prims++];
+  memset(prim, 0, sizeof(*prim));
+  prim->type = type;
+  prim->color = color;
+
+  return prim;
+}
+
+void OverlayDraw_FillRect(OverlayDraw_t *od, int x, int y, int w, int h, uint32_t color)
+{
+  OverlayPrimitive_t *prim;
+
+  if (w <= 0 || h <= 0)
+    return ;
+  prim = OverlayDraw_Push(od, OVERLAY_PRIM_RECT, color);
+  if (!prim)
+    return ;
+
+  prim->x0 = x;
+  prim->y0 = y;
+  prim->x1 = w;
+  prim->y1 = h;
+}
+
+void OverlayDraw_Rect(OverlayDraw_t *od, int x, int y, int w, int h, uint32_t color)
+{
+  /* Same outline as UTIL_LCD_DrawRect(): w x h pixels, borders included */
+  OverlayDraw_FillRect(od, x, y, w, 1, color);
+  OverlayDraw_FillRect(od, x, y + h - 1, w, 1, color);
+  OverlayDraw_FillRect(od, x, y + 1, 1, h - 2, color);
+  OverlayDraw_FillRect(od, x + w - 1, y + 1, 1, h - 2, color);
+}
+
+void OverlayDraw_Line(OverlayDraw_t *od, int x0, int y0, int x1, int y1, int width, uint32_t color)
+{
+  OverlayPrimitive_t *prim;
+
+  assert(width > 0 && width % 2 == 1);
+  prim = OverlayDraw_Push(od, OVERLAY_PRIM_LINE, color);
+  if (!prim)
+    return ;
+
+  prim->width = width;
+  prim->x0 = x0;
+  prim->y0 = y0;
+  prim->x1 = x1;
+  prim->y1 = y1;
+}
+
+void OverlayDraw_FillCircle(OverlayDraw_t *od, int x, int y, int radius, uint32_t color)
+{
+  OverlayPrimitive_t *prim;
+
+  if (radius < 0)
+    return ;
+  prim = OverlayDraw_Push(od, OVERLAY_PRIM_CIRCLE, color);
+  if (!prim)
+    return ;
+
+  prim->x0 = x;
+  prim->y0 = y;
+  prim->x1 = radius;
+}
+
+void OverlayDraw_Bitmap(OverlayDraw_t *od, int x, int y, int w, int h, const uint8_t *argb4444)
+{
+  OverlayPrimitive_t *prim = OverlayDraw_Push(od, OVERLAY_PRIM_BITMAP, 0);
+
+  if (!prim)
+    return ;
+
+  prim->x0 = x;
+  prim->y0 = y;
+  prim->x1 = w;
+  prim->y1 = h;
+  prim->data = argb4444;
+}
+
+void OverlayDraw_PrintfAt(OverlayDraw_t *od, int x, int y, OverlayDrawAlign_t align, const char *format, ...)
+{
+  uint32_t room = MIN(OVERLAY_DRAW_TEXT_POOL_SIZE - od->text_pool_used, OVERLAY_DRAW_MAX_TEXT_LEN + 1);
+  char *text = &od->text_pool[od->text_pool_used];
+  OverlayPrimitive_t *prim;
+  int nb_cols;
+  int len;
+  int col;
+  va_list args;
+
+  assert(od->font);
+  if (room < 2)
+  {
+    od->nb_dropped++;
+    return ;
+  }
+
+  va_start(args, format);
+  len = vsnprintf(text, room, format, args);
+  va_end(args);
+  if (len < 0)
+    return ;
+  len = MIN(len, (int) room - 1);
+
+  prim = OverlayDraw_Push(od, OVERLAY_PRIM_TEXT, od->text_color);
+  if (!prim)
+    return ;
+  od->text_pool_used += len + 1;
+
+  /* Same placement as UTIL_LCD_DisplayStringAt() */
+  nb_cols = od->width / od->font->Width;
+  switch (align)
+  {
+  case OVERLAY_DRAW_ALIGN_CENTER:
+    col = x + ((nb_cols - len) * od->font->Width) / 2;
+    break;
+  case OVERLAY_DRAW_ALIGN_RIGHT:
+    col = -x + (nb_cols - len) * od->font->Width;
+    break;
+  default:
+    col = x;
+    break;
+  }
+  if (col < 1)
+    col = 1;
+
+  prim->x0 = col;
+  prim->y0 = y;
+  prim->back_color = od->back_color;
+  prim->data = (const uint8_t *) text;
+}
+
+/* Clips the op to the frame buffer, src follows the clipped origin. Returns 0 if nothing is left */
+static int OverlayDraw_ClipOp(const OverlayDraw_t *od, OverlayOp_t *op, int x, int y, int w, int h, int src_bpp)
+{
+  if (x < 0)
+  {
+    w += x;
+    if (op->src)
+      op->src += -x * src_bpp;
+    x = 0;
+  }
+  if (y < 0)
+  {
+    h += y;
+    if (op->src)
+      op->src += -y * op->src_pitch * src_bpp;
+    y = 0;
+  }
+  w = MIN(w, od->width - x);
+  h = MIN(h, od->height - y);
+  if (w <= 0 || h <= 0)
+    return 0;
+
+  op->x = x;
+  op->y = y;
+  op->w = w;
+  op->h = h;
+
+  return 1;
+}
+
+/* Minor axis coordinate of the i-th of the n + 1 pixels of a line, rounded to nearest */
+static int Line_Minor(int minor0, int d_minor, int i, int n)
+{
+  int num = 2 * i * d_minor + (d_minor < 0 ? -n : n);
+
+  return minor0 + num / (2 * n);
+}
+
+/*
+ * Thick lines are the union of the centre line pixels extended by width / 2
+ * along the minor axis, emitted as one rectangle per run of pixels sharing
+ * the same minor coordinate.
+ */
+static int Prim_LineOp(const OverlayDraw_t *od, const OverlayPrimitive_t *prim, int32_t *step, OverlayOp_t *op)
+{
+  int half = prim->width / 2;
+  int dx = prim->x1 - prim->x0;
+  int dy = prim->y1 - prim->y0;
+  int steep = abs(dy) > abs(dx);
+  int major0 = steep ? prim->y0 : prim->x0;
+  int minor0 = steep ? prim->x0 : prim->y0;
+  int d_major = steep ? dy : dx;
+  int d_minor = steep ? dx : dy;
+  int n = abs(d_major);
+  int i = *step;
+  int j;
+
+  if (i > n)
+    return 0;
+
+  /* A single pixel is extended vertically, as a horizontal line would */
+  if (n == 0)
+  {
+    *step = 1;
+    OverlayDraw_ClipOp(od, op, prim->x0, prim->y0 - half, 1, prim->width, 0);
+    return 1;
+  }
+
+  int minor = Line_Minor(minor0, d_minor, i, n);
+  for (j = i + 1; j <= n && Line_Minor(minor0, d_minor, j, n) == minor; j++)
+    ;
+  *step = j;
+
+  int run_start = major0 + (d_major > 0 ? i : -(j - 1));
+  int run_len = j - i;
+  if (steep)
+    OverlayDraw_ClipOp(od, op, minor - half, run_start, prim->width, run_len, 0);
+  else
+    OverlayDraw_ClipOp(od, op, run_start, minor - half, run_len, prim->width, 0);
+
+  return 1;
+}
+
+/*
+ * Generates the next op of a primitive from its progress 'step'. Returns 0 once
+ * the primitive is complete; ops that end up fully clipped are returned with
+ * a null width.
+ */
+static int OverlayDraw_PrimOp(const OverlayDraw_t *od, const OverlayPrimitive_t *prim, int32_t *step, OverlayOp_t *op)
+{
+  int r;
+
+  memset(op, 0, sizeof(*op));
+  op->color = prim->color;
+
+  switch (prim->type)
+  {
+  case OVERLAY_PRIM_RECT:
+    if ((*step)++)
+      return 0;
+    op->type = OVERLAY_OP_FILL;
+    OverlayDraw_ClipOp(od, op, prim->x0, prim->y0, prim->x1, prim->y1, 0);
+    return 1;
+  case OVERLAY_PRIM_LINE:
+    op->type = OVERLAY_OP_FILL;
+    return Prim_LineOp(od, prim, step, op);
+  case OVERLAY_PRIM_CIRCLE:
+    r = prim->x1;
+    if (r >= 1 && r <= OVERLAY_DRAW_MAX_MASK_RADIUS)
+    {
+      if ((*step)++)
+        return 0;
+      op->type = OVERLAY_OP_MASK;
+      op->src = Circle_Mask(r);
+      op->src_pitch = 2 * r + 1;
+      OverlayDraw_ClipOp(od, op, prim->x0 - r, prim->y0 - r, 2 * r + 1, 2 * r + 1, 1);
+      return 1;
+    }
+    if (*step > 2 * r)
+      return 0;
+    {
+      /* Row per row above the mask sizes */
+      int dy = (*step)++ - r;
+      int half = r;
+
+      while (half > 0 && !Circle_Inside(half, dy, r))
+        half--;
+      op->type = OVERLAY_OP_FILL;
+      OverlayDraw_ClipOp(od, op, prim->x0 - half, prim->y0 + dy, 2 * half + 1, 1, 0);
+    }
+    return 1;
+  case OVERLAY_PRIM_TEXT:
+    {
+      const sFONT *font = od->font;
+      char c = prim->data[*step];
+      int x = prim->x0 + *step * font->Width;
+
+      /* Like the stm32_lcd, only characters fully inside the screen width */
+      if (c == '\0' || x + font->Width > od->width)
+        return 0;
+      (*step)++;
+      if (c < OVERLAY_DRAW_FIRST_GLYPH || c >= OVERLAY_DRAW_FIRST_GLYPH + OVERLAY_DRAW_NB_GLYPHS)
+        c = ' ';
+      op->type = OVERLAY_OP_GLYPH;
+      op->back_color = prim->back_color;
+      op->src = od->glyph_atlas + (c - OVERLAY_DRAW_FIRST_GLYPH) * font->Width * font->Height;
+      op->src_pitch = font->Width;
+      OverlayDraw_ClipOp(od, op, x, prim->y0, font->Width, font->Height, 1);
+    }
+    return 1;
+  case OVERLAY_PRIM_BITMAP:
+    if ((*step)++)
+      return 0;
+    op->type = OVERLAY_OP_COPY;
+    op->src = prim->data;
+    op->src_pitch = prim->x1;
+    OverlayDraw_ClipOp(od, op, prim->x0, prim->y0, prim->x1, prim->y1, 2);
+    return 1;
+  default:
+    assert(0);
+    return 0;
+  }
+}
+
+static int OverlayDraw_NextOp(OverlayDraw_t *od, OverlayOp_t *op)
+{
+  while (od->prim_idx < od->nb_prims)
+  {
+    if (!OverlayDraw_PrimOp(od, &od->prims[od->prim_idx], &od->step, op))
+    {
+      od->prim_idx++;
+      od->step = 0;
+      continue;
+    }
+    if (op->w && op->h)
+      return 1;
+  }
+
+  return 0;
+}
+
+/* Executes ops until the backend goes asynchronous or the queue is exhausted */
+static void OverlayDraw_Run(OverlayDraw_t *od)
+{
+  OverlayOp_t op;
+
+  while (OverlayDraw_NextOp(od, &op))
+  {
+    if (od->backend->execute(od, &op))
+      return ;
+  }
+
+  if (od->done_cb)
+    od->done_cb(od->done_arg);
+  od->busy = 0;
+}
+
+void OverlayDraw_Flush(OverlayDraw_t *od, void (*done_cb)(void *arg), void *done_arg)
+{
+  assert(!od->busy);
+  assert(od->fb);
+
+  od->done_cb = done_cb;
+  od->done_arg = done_arg;
+  od->prim_idx = 0;
+  od->step = 0;
+  od->busy = 1;
+  OverlayDraw_Run(od);
+}
+
+void OverlayDraw_Wait(OverlayDraw_t *od)
+{
+  while (od->busy)
+    ;
+}
+
+void OverlayDraw_OpDone(OverlayDraw_t *od)
+{
+  OverlayDraw_Run(od);
+}
+
+/* CPU reference backend ---------------------------------------------------- */
+
+static uint16_t Sw_ToArgb4444(uint32_t argb8888)
+{
+  return ((argb8888 >> 16) & 0xf000) | ((argb8888 >> 12) & 0x0f00) |
+         ((argb8888 >> 8) & 0x00f0) | ((argb8888 >> 4) & 0x000f);
+}
+
+static uint32_t Sw_ToArgb8888(uint16_t argb4444)
+{
+  uint32_t argb8888 = 0;
+
+  for (int shift = 0; shift < 16; shift += 4)
+    argb8888 |= ((argb4444 >> shift) & 0xf) * 0x11 << (2 * shift);
+
+  return argb8888;
+}
+
+/* DMA2D blending equation, foreground alpha already modulated by the mask */
+static uint16_t Sw_Blend(uint32_t fg, uint32_t fg_alpha, uint32_t bg)
+{
+  uint32_t bg_alpha = bg >> 24;
+  uint32_t mult = fg_alpha * bg_alpha / 255;
+  uint32_t out_alpha = fg_alpha + bg_alpha - mult;
+  uint32_t out = out_alpha << 24;
+
+  if (!out_alpha)
+    return 0;
+
+  for (int shift = 0; shift < 24; shift += 8)
+  {
+    uint32_t cf = (fg >> shift) & 0xff;
+    uint32_t cb = (bg >> shift) & 0xff;
+
+    out |= ((cf * fg_alpha + cb * bg_alpha - cb * mult) / out_alpha) << shift;
+  }
+
+  return Sw_ToArgb4444(out);
+}
+
+static int Sw_Execute(OverlayDraw_t *od, const OverlayOp_t *op)
+{
+  uint16_t fill = Sw_ToArgb4444(op->color);
+  uint32_t alpha = op->color >> 24;
+
+  for (uint32_t y = 0; y < op->h; y++)
+  {
+    uint16_t *dst = (uint16_t *) od->fb + (op->y + y) * od->width + op->x;
+    const uint8_t *src = op->src ? op->src + y * op->src_pitch * (op->type == OVERLAY_OP_COPY ? 2 : 1) : NULL;
+
+    switch (op->type)
+    {
+    case OVERLAY_OP_FILL:
+      for (uint32_t x = 0; x < op->w; x++)
+        dst[x] = fill;
+      break;
+    case OVERLAY_OP_MASK:
+      for (uint32_t x = 0; x < op->w; x++)
+        dst[x] = Sw_Blend(op->color, src[x] * alpha / 255, Sw_ToArgb8888(dst[x]));
+      break;
+    case OVERLAY_OP_GLYPH:
+      for (uint32_t x = 0; x < op->w; x++)
+        dst[x] = Sw_Blend(op->color, src[x] * alpha / 255, op->back_color);
+      break;
+    case OVERLAY_OP_COPY:
+      memcpy(dst, src, op->w * 2);
+      break;
+    }
+  }
+
+  return 0;
+}
+
+const OverlayDrawBackend_t OverlayDraw_SwBackend = {
+  .execute = Sw_Execute,
+  .sync_source = NULL,
+  .cpu_writes = 1,
+};
@@ -0,0 +1,120 @@
+/**
+ ******************************************************************************
+ * @file    overlay_draw_dma2d.c
+ * @brief   DMA2D backend of the overlay drawing, one interrupt driven transfer
+ *          per op
+ ******************************************************************************
+ */
+
+#include "overlay_draw.h"
+#include "stm32n6xx_hal.h"
+#include "stm32n6xx_ll_dma2d.h"
+
+#define DMA2D_IRQ_PRIORITY  8
+
+/* Queue being flushed, completions are reported to it */
+static OverlayDraw_t *dma2d_od;
+
+static uint32_t Dma2d_ToArgb4444(uint32_t argb8888)
+{
+  return ((argb8888 >> 16) & 0xf000) | ((argb8888 >> 12) & 0x0f00) |
+         ((argb8888 >> 8) & 0x00f0) | ((argb8888 >> 4) & 0x000f);
+}
+
+/* Foreground: A8 mask tinted with the op color */
+static void Dma2d_SetMaskLayer(const OverlayOp_t *op)
+{
+  LL_DMA2D_FGND_SetMemAddr(DMA2D, (uint32_t) op->src);
+  LL_DMA2D_FGND_SetLineOffset(DMA2D, op->src_pitch - op->w);
+  LL_DMA2D_FGND_SetColorMode(DMA2D, LL_DMA2D_INPUT_MODE_A8);
+  LL_DMA2D_FGND_SetAlphaMode(DMA2D, LL_DMA2D_ALPHA_MODE_COMBINE);
+  LL_DMA2D_FGND_SetAlpha(DMA2D, op->color >> 24);
+  LL_DMA2D_FGND_SetColor(DMA2D, (op->color >> 16) & 0xff, (op->color >> 8) & 0xff, op->color & 0xff);
+}
+
+static int Dma2d_Execute(OverlayDraw_t *od, const OverlayOp_t *op)
+{
+  uint32_t dst = (uint32_t) od->fb + 2 * (op->y * od->width + op->x);
+  uint32_t dst_offset = od->width - op->w;
+
+  switch (op->type)
+  {
+  case OVERLAY_OP_FILL:
+    LL_DMA2D_SetMode(DMA2D, LL_DMA2D_MODE_R2M);
+    LL_DMA2D_SetOutputColor(DMA2D, Dma2d_ToArgb4444(op->color));
+    break;
+  case OVERLAY_OP_MASK:
+    /* Background read back from the destination */
+    LL_DMA2D_SetMode(DMA2D, LL_DMA2D_MODE_M2M_BLEND);
+    Dma2d_SetMaskLayer(op);
+    LL_DMA2D_BGND_SetMemAddr(DMA2D, dst);
+    LL_DMA2D_BGND_SetLineOffset(DMA2D, dst_offset);
+    LL_DMA2D_BGND_SetColorMode(DMA2D, LL_DMA2D_INPUT_MODE_ARGB4444);
+    LL_DMA2D_BGND_SetAlphaMode(DMA2D, LL_DMA2D_ALPHA_MODE_NO_MODIF);
+    break;
+  case OVERLAY_OP_GLYPH:
+    /* Fixed background: the whole glyph cell is replaced, as the stm32_lcd does */
+    LL_DMA2D_SetMode(DMA2D, LL_DMA2D_MODE_M2M_BLEND_FIXED_COLOR_BG);
+    Dma2d_SetMaskLayer(op);
+    LL_DMA2D_BGND_SetAlphaMode(DMA2D, LL_DMA2D_ALPHA_MODE_REPLACE);
+    LL_DMA2D_BGND_SetAlpha(DMA2D, op->back_color >> 24);
+    LL_DMA2D_BGND_SetColor(DMA2D, (op->back_color >> 16) & 0xff, (op->back_color >> 8) & 0xff,
+                           op->back_color & 0xff);
+    break;
+  case OVERLAY_OP_COPY:
+    LL_DMA2D_SetMode(DMA2D, LL_DMA2D_MODE_M2M);
+    LL_DMA2D_FGND_SetMemAddr(DMA2D, (uint32_t) op->src);
+    LL_DMA2D_FGND_SetLineOffset(DMA2D, op->src_pitch - op->w);
+    LL_DMA2D_FGND_SetColorMode(DMA2D, LL_DMA2D_INPUT_MODE_ARGB4444);
+    break;
+  }
+
+  LL_DMA2D_SetOutputColorMode(DMA2D, LL_DMA2D_OUTPUT_MODE_ARGB4444);
+  LL_DMA2D_SetOutputMemAddr(DMA2D, dst);
+  LL_DMA2D_SetLineOffset(DMA2D, dst_offset);
+  LL_DMA2D_SetNbrOfPixelsPerLines(DMA2D, op->w);
+  LL_DMA2D_SetNbrOfLines(DMA2D, op->h);
+
+  dma2d_od = od;
+  LL_DMA2D_EnableIT_TC(DMA2D);
+  LL_DMA2D_EnableIT_TE(DMA2D);
+  LL_DMA2D_EnableIT_CE(DMA2D);
+  LL_DMA2D_Start(DMA2D);
+
+  return 1;
+}
+
+static void Dma2d_SyncSource(const void *data, uint32_t size)
+{
+  SCB_CleanDCache_by_Addr((void *) data, size);
+}
+
+const OverlayDrawBackend_t OverlayDraw_Dma2dBackend = {
+  .execute = Dma2d_Execute,
+  .sync_source = Dma2d_SyncSource,
+  .cpu_writes = 0,
+};
+
+void OverlayDraw_Dma2d_Init(void)
+{
+  HAL_NVIC_SetPriority(DMA2D_IRQn, DMA2D_IRQ_PRIORITY, 0);
+  HAL_NVIC_EnableIRQ(DMA2D_IRQn);
+}
+
+void OverlayDraw_Dma2d_IRQHandler(void)
+{
+  /* A faulty op is dropped, the flush goes on with the next one */
+  LL_DMA2D_ClearFlag_TC(DMA2D);
+  LL_DMA2D_ClearFlag_TE(DMA2D);
+  LL_DMA2D_ClearFlag_CE(DMA2D);
+
+  OverlayDraw_OpDone(dma2d_od);
+
+  /* Leave the DMA2D to the BSP polling transfers once the queue is done */
+  if (!dma2d_od->busy)
+  {
+    LL_DMA2D_DisableIT_TC(DMA2D);
+    LL_DMA2D_DisableIT_TE(DMA2D);
+    LL_DMA2D_DisableIT_CE(DMA2D);
+  }
+}
@@ -0,0 +1,278 @@
+/**
+ ******************************************************************************
+ * @file    pipeline.c
+ * @brief   Frame pipeline of the main loop
+ ******************************************************************************
+ */
+
+#include "pipeline.h"
+#include <assert.h>
+#include <stddef.h>
+#include "app_config.h"
+#include "latency_trace.h"
+
+void Pipeline_Init(Pipeline_TypeDef *p, const Pipeline_Ops_t *ops, NnInput_TypeDef *nn_input, InferenceRate_t *rate,
+                   int is_direct, uint32_t pitch, uint32_t nn_in_len)
+{
+  assert(is_direct ? ops->capture_start != NULL : ops->copy != NULL && ops->frame_seq != NULL);
+
+  p->ops = ops;
+  p->nn_input = nn_input;
+  p->rate = rate;
+  p->is_direct = is_direct;
+  p->pitch = pitch;
+  p->nn_in_len = nn_in_len;
+  p->nn_running = 0;
+  p->pp_pending = 0;
+  p->draw_pending = 0;
+  p->draw_predicted = 0;
+  p->nn_in_writing = NULL;
+  p->nn_in_frame = NULL;
+  p->nn_in_written = 0;
+  p->nn_in_failed = 0;
+  p->input_roi = Roi_FullFrame;
+  p->inference_roi = Roi_FullFrame;
+  p->nb_torn = 0;
+}
+
+/**
+* @brief Whether the frame is inferred, NN_ADAPTIVE_RATE drawing the keypoints extrapolated otherwise
+*/
+static int Pipeline_IsInferred(Pipeline_TypeDef *p, const uint8_t *frame, uint32_t seq)
+{
+  uint32_t motion;
+  int infer;
+
+  if (p->rate == NULL)
+    return 1;
+
+  LatencyTrace_Begin(LATENCY_STAGE_MOTION);
+  motion = InferenceRate_Motion(p->rate, frame, p->pitch, NN_WIDTH, NN_HEIGHT, NN_BPP);
+  /* Measured on a torn frame: dropped before it becomes the reference of the motion */
+  if (!p->is_direct && p->ops->frame_seq(frame) != seq)
+  {
+    LatencyTrace_End(LATENCY_STAGE_MOTION);
+    p->nb_torn++;
+    return 0;
+  }
+  infer = InferenceRate_Decide(p->rate, motion);
+  LatencyTrace_End(LATENCY_STAGE_MOTION);
+  if (!infer && !p->draw_pending)
+  {
+    /* Overlay of this frame drawn with the keypoints extrapolated, unless an inferred one is still pending */
+    p->draw_pending = 1;
+    p->draw_predicted = 1;
+  }
+
+  return infer;
+}
+
+/**
+* @brief Copy the frame into the NN input buffer by CPU: without copy_start(), or the copy it started failed
+*/
+static void Pipeline_CopyInput(Pipeline_TypeDef *p)
+{
+  p->ops->copy(p->nn_in_frame, p->nn_in_writing);
+  Pipeline_InputWritten(p, 0);
+}
+
+/**
+* @brief Start writing the latest captured frame into a NN input buffer: a copy, or the capture itself when direct
+*/
+static void Pipeline_Capture(Pipeline_TypeDef *p)
+{
+  uint8_t *frame;
+  uint32_t seq;
+  Roi_t roi;
+
+  if (p->is_direct)
+  {
+    p->nn_in_writing = NnInput_AcquireWrite(p->nn_input);
+    p->nn_in_written = 0;
+    p->ops->capture_start(p->nn_in_writing);
+    return;
+  }
+
+  frame = p->ops->frame_get(&seq, &roi);
+  if (frame == NULL || !Pipeline_IsInferred(p, frame, seq))
+    return;
+
+  p->input_roi = roi;
+  p->nn_in_writing = NnInput_AcquireWrite(p->nn_input);
+  p->nn_in_frame = frame;
+  p->nn_in_seq = seq;
+  p->nn_in_written = 0;
+  p->nn_in_failed = 0;
+  /*
+   * Crop the image if the neural network (NN) input dimensions are not a multiple of 16.
+   * The DCMIPP hardware requires the output image dimensions to be multiples of 16.
+   * This ensures compatibility with the NN input dimensions.
+   */
+  LatencyTrace_Begin(LATENCY_STAGE_CROP);
+  if (p->ops->copy_start != NULL && p->ops->copy_start(frame, p->nn_in_writing) == 0)
+    return;
+  Pipeline_CopyInput(p);
+}
+
+/**
+* @brief Direct capture: the snapshot written into the NN input buffer is complete
+*/
+static void Pipeline_Captured(Pipeline_TypeDef *p)
+{
+  uint32_t seq;
+  Roi_t roi;
+  uint8_t *frame = p->ops->frame_get(&seq, &roi);
+
+  if (frame == NULL)
+    return;
+
+  assert(frame == p->nn_in_writing);
+  if (!Pipeline_IsInferred(p, frame, seq))
+  {
+    NnInput_CancelWrite(p->nn_input, p->nn_in_writing);
+    p->nn_in_writing = NULL;
+    return;
+  }
+  p->input_roi = roi;
+  p->nn_in_seq = seq;
+  p->nn_in_written = 1;
+}
+
+void Pipeline_InputWritten(Pipeline_TypeDef *p, int error)
+{
+  if (error)
+  {
+    p->nn_in_failed = 1;
+    return;
+  }
+  /* Torn if DCMIPP has started writing the frame buffer again meanwhile */
+  p->nn_in_end_seq = p->ops->frame_seq(p->nn_in_frame);
+  LatencyTrace_End(LATENCY_STAGE_CROP);
+  p->nn_in_written = 1;
+}
+
+/**
+* @brief Hand the NN input buffer written over to the next inference, unless the frame copied was torn
+*/
+static void Pipeline_CommitInput(Pipeline_TypeDef *p)
+{
+  if (!p->is_direct && p->nn_in_end_seq != p->nn_in_seq)
+  {
+    p->nb_torn++;
+    NnInput_CancelWrite(p->nn_input, p->nn_in_writing);
+  }
+  else
+  {
+    p->ops->commit(p->nn_in_writing);
+    NnInput_CommitWrite(p->nn_input, p->nn_in_writing);
+  }
+  p->nn_in_writing = NULL;
+}
+
+/**
+* @brief Start a new inference on the NN input buffer holding the latest frame
+*/
+static void Pipeline_StartInference(Pipeline_TypeDef *p)
+{
+  NnInput_StartInference(p->nn_input);
+  /* The ready buffer is always the last written */
+  p->inference_roi = p->input_roi;
+
+  LatencyTrace_Begin(LATENCY_STAGE_INFERENCE);
+  p->nn_running = 1;
+}
+
+/**
+* @brief Run the in-flight inference as far as possible without blocking
+*
+* @retval non zero if the NPU is busy
+*/
+static int Pipeline_Run(Pipeline_TypeDef *p)
+{
+  if (p->nn_running && p->ops->inference_run())
+  {
+    LatencyTrace_End(LATENCY_STAGE_INFERENCE);
+    p->nn_running = 0;
+    p->pp_pending = 1;
+    NnInput_InferenceDone(p->nn_input);
+  }
+
+  return p->nn_running;
+}
+
+int Pipeline_Advance(Pipeline_TypeDef *p)
+{
+  Pipeline_Run(p);
+
+  /* Copy done, by the CPU or in the background by the DMA2D, or captured */
+  if (p->nn_in_writing && p->nn_in_written)
+  {
+    Pipeline_CommitInput(p);
+  }
+
+  /* Inference N+1 as soon as the NPU is free and the outputs of N are consumed */
+  if (!p->nn_running && !p->pp_pending && NnInput_IsReady(p->nn_input))
+  {
+    Pipeline_StartInference(p);
+  }
+
+  return Pipeline_Run(p);
+}
+
+int Pipeline_Step(Pipeline_TypeDef *p)
+{
+  /* Inference N: kick every epoch block that can run without waiting */
+  int is_busy = Pipeline_Advance(p);
+
+  /* Keypoints of N must be extracted before inference N+1 overwrites nn_out */
+  if (p->pp_pending)
+  {
+    LatencyTrace_Begin(LATENCY_STAGE_POSTPROCESS);
+    p->ops->postprocess(&p->inference_roi);
+    LatencyTrace_End(LATENCY_STAGE_POSTPROCESS);
+    p->pp_pending = 0;
+    p->draw_pending = 1;
+    p->draw_predicted = 0;
+  }
+
+  /* Capture N+1: latest complete frame into a NN input buffer the NPU is not reading */
+  if (!p->nn_in_writing && NnInput_CanWrite(p->nn_input))
+  {
+    Pipeline_Capture(p);
+  }
+
+  if (p->nn_in_writing && p->is_direct && !p->nn_in_written)
+  {
+    Pipeline_Captured(p);
+  }
+
+  /* Copy error, e.g. a DMA2D transfer error: copied again by the CPU, out of the interrupt */
+  if (p->nn_in_writing && p->nn_in_failed)
+  {
+    p->nn_in_failed = 0;
+    Pipeline_CopyInput(p);
+  }
+
+  is_busy = Pipeline_Advance(p);
+
+  /* Direct capture: next snapshot armed before drawing, the next frame may still start within the blanking */
+  if (p->is_direct && !p->nn_in_writing && NnInput_CanWrite(p->nn_input))
+  {
+    Pipeline_Capture(p);
+  }
+
+  /* Gesture detection and rendering of N while the NPU works on N+1 */
+  if (p->draw_pending)
+  {
+    int is_predicted = p->draw_predicted;
+
+    p->draw_pending = 0;
+    p->draw_predicted = 0;
+    /* Ends once the overlay is drawn */
+    LatencyTrace_Begin(LATENCY_STAGE_DRAW);
+    p->ops->draw(is_predicted);
+    return 0;
+  }
+
+  return is_busy;
+}
@@ -0,0 +1,141 @@
+/**
+ ******************************************************************************
+ * @file    roi_tracker.c
+ * @brief   Region of the camera frame zoomed into by the NN pipe, following
+ *          the keypoints of the previous frames
+ ******************************************************************************
+ */
+
+#include "roi_tracker.h"
+#include <assert.h>
+
+#define ROI_MIN(a, b) ((a) < (b) ? (a) : (b))
+#define ROI_MAX(a, b) ((a) > (b) ? (a) : (b))
+
+const Roi_t Roi_FullFrame = { .x0 = 0.0f, .y0 = 0.0f, .width = 1.0f, .height = 1.0f };
+
+void RoiTracker_Init(RoiTracker_t *tracker, const RoiTracker_Params_t *params)
+{
+    assert(params->min_size > 0.0f && params->min_size <= 1.0f);
+    assert(params->shrink_rate > 0.0f && params->shrink_rate <= 1.0f);
+
+    tracker->params = *params;
+    RoiTracker_Reset(tracker);
+}
+
+void RoiTracker_Reset(RoiTracker_t *tracker)
+{
+    tracker->roi = Roi_FullFrame;
+    tracker->missed = 0;
+}
+
+// Start of a window of 'size' centered on 'center', shifted back inside [0, 1] rather than shrunk
+static float32_t Roi_ClampStart(float32_t center, float32_t size)
+{
+    return ROI_MIN(ROI_MAX(center - size / 2, 0.0f), 1.0f - size);
+}
+
+static int Roi_Contains(const Roi_t *outer, const Roi_t *inner)
+{
+    return inner->x0 >= outer->x0 && inner->y0 >= outer->y0 &&
+           inner->x0 + inner->width <= outer->x0 + outer->width &&
+           inner->y0 + inner->height <= outer->y0 + outer->height;
+}
+
+const Roi_t *RoiTracker_Update(RoiTracker_t *tracker, const spe_pp_outBuffer_t *keypoints, int nb_keypoints)
+{
+    const RoiTracker_Params_t *params = &tracker->params;
+    float32_t x_min = 1.0f, y_min = 1.0f, x_max = 0.0f, y_max = 0.0f;
+    float32_t size;
+    Roi_t target;
+    int count = 0;
+
+    for (int i = 0; i < nb_keypoints; i++)
+    {
+        if (keypoints[i].proba < params->min_confidence)
+            continue;
+        x_min = ROI_MIN(x_min, keypoints[i].x_center);
+        y_min = ROI_MIN(y_min, keypoints[i].y_center);
+        x_max = ROI_MAX(x_max, keypoints[i].x_center);
+        y_max = ROI_MAX(y_max, keypoints[i].y_center);
+        count++;
+    }
+
+    if (count < params->min_keypoints)
+    {
+        // Keep looking where the person was for a few frames, then give up on the zoom
+        if (tracker->missed < params->max_missed)
+            tracker->missed++;
+        if (tracker->missed >= params->max_missed)
+            tracker->roi = Roi_FullFrame;
+        return &tracker->roi;
+    }
+    tracker->missed = 0;
+
+    size = ROI_MAX(x_max - x_min, y_max - y_min) * (1.0f + 2.0f * params->margin);
+    size = ROI_MIN(ROI_MAX(size, params->min_size), 1.0f);
+    target.width = size;
+    target.height = size;
+    target.x0 = Roi_ClampStart((x_min + x_max) / 2, size);
+    target.y0 = Roi_ClampStart((y_min + y_max) / 2, size);
+
+    if (Roi_Contains(&tracker->roi, &target))
+    {
+        // Zoom in progressively: the region moves toward the target and keeps containing it
+        tracker->roi.x0 += params->shrink_rate * (target.x0 - tracker->roi.x0);
+        tracker->roi.y0 += params->shrink_rate * (target.y0 - tracker->roi.y0);
+        tracker->roi.width += params->shrink_rate * (target.width - tracker->roi.width);
+        tracker->roi.height = tracker->roi.width;
+    }
+    else
+    {
+        // Keypoints leaving the region: catch up at once
+        tracker->roi = target;
+    }
+
+    return &tracker->roi;
+}
+
+// Pixels of 'size' (normalized) on an axis of 'full' pixels, between 'min' and 'full'
+static uint32_t Roi_SizeToPixels(float32_t size, uint32_t full, uint32_t min)
+{
+    uint32_t pixels = (uint32_t) (size * full + 0.5f);
+
+    return ROI_MIN(ROI_MAX(pixels, min), full);
+}
+
+void Roi_ToPixels(const Roi_t *roi, uint32_t full_width, uint32_t full_height, uint32_t min_width, uint32_t min_height,
+                  Roi_Pixels_t *pixels, Roi_t *captured)
+{
+    pixels->width = Roi_SizeToPixels(roi->width, full_width, min_width);
+    pixels->height = Roi_SizeToPixels(roi->height, full_height, min_height);
+    pixels->x0 = ROI_MIN((uint32_t) (roi->x0 * full_width + 0.5f), full_width - pixels->width);
+    pixels->y0 = ROI_MIN((uint32_t) (roi->y0 * full_height + 0.5f), full_height - pixels->height);
+
+    captured->x0 = (float32_t) pixels->x0 / full_width;
+    captured->y0 = (float32_t) pixels->y0 / full_height;
+    captured->width = (float32_t) pixels->width / full_width;
+    captured->height = (float32_t) pixels->height / full_height;
+}
+
+// Distance between two edges, in pixels
+static uint32_t Roi_EdgeDistance(uint32_t a, uint32_t b)
+{
+    return a > b ? a - b : b - a;
+}
+
+int Roi_PixelsMoved(const Roi_Pixels_t *from, const Roi_Pixels_t *to, uint32_t dead_band)
+{
+    return Roi_EdgeDistance(from->x0, to->x0) > dead_band || Roi_EdgeDistance(from->y0, to->y0) > dead_band ||
+           Roi_EdgeDistance(from->x0 + from->width, to->x0 + to->width) > dead_band ||
+           Roi_EdgeDistance(from->y0 + from->height, to->y0 + to->height) > dead_band;
+}
+
+void Roi_ToFullFrame(const Roi_t *roi, spe_pp_outBuffer_t *keypoints, int nb_keypoints)
+{
+    for (int i = 0; i < nb_keypoints; i++)
+    {
+        keypoints[i].x_center = roi->x0 + keypoints[i].x_center * roi->width;
+        keypoints[i].y_center = roi->y0 + keypoints[i].y_center * roi->height;
+    }
+}
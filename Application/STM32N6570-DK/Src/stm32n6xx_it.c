@@ -21,6 +21,9 @@
 #include "stm32n6xx_it.h"
 
 #include "cmw_camera.h"
+#include "overlay_draw.h"
+#include "crop_img.h"
+#include "stm32n6570_discovery.h"
 
 /**
   * @brief   This function handles NMI exception.
@@ -155,4 +158,18 @@ void DCMIPP_IRQHandler(void)
 {
   DCMIPP_HandleTypeDef *hcamera_dcmipp = CMW_CAMERA_GetDCMIPPHandle();
   HAL_DCMIPP_IRQHandler(hcamera_dcmipp);
+}
+
+void DMA2D_IRQHandler(void)
+{
+  /* Shared: the NN input copy and the overlay flushes never overlap */
+  if (img_crop_dma2d_busy())
+    img_crop_dma2d_irq_handler();
+  else
+    OverlayDraw_Dma2d_IRQHandler();
+}
+
+void USART1_IRQHandler(void)
+{
+  HAL_UART_IRQHandler(&hcom_uart[COM1]);
 }
\ No newline at end of file
@@ -0,0 +1,402 @@
+/**
+ ******************************************************************************
+ * @file    weight_prefetch.c
+ * @brief   NPU cache profiling of the epoch blocks and warming of the weights
+ *          ahead of the cold epoch blobs
+ ******************************************************************************
+ */
+
+#include "weight_prefetch.h"
+#include <stdio.h>
+#include <string.h>
+#include "stm32n6xx.h"
+#include "npu_cache.h"
+#include "ll_aton.h"
+#include "ll_aton_dbgtrc.h"
+
+/* First of the 16 debug and trace counters counting the bus interface bursts */
+#define BURST_COUNTER       0
+/* NPU cache line, i.e. bytes read from the external memories per miss */
+#define NPU_CACHE_LINE      64
+
+typedef struct {
+  WeightPrefetch_EbStats_t stats;
+  EpochBlock_MemRangeTypeDef warm[WEIGHT_PREFETCH_MAX_RANGES]; /* Weights read first by the blob */
+  int nb_warm;
+  uint32_t snap_ts;                     /* Counters sampled at PRE_START */
+  uint32_t snap_hits;
+  uint32_t snap_misses;
+  unsigned int snap_reads;
+  unsigned int snap_writes;
+} PrefetchEb_t;
+
+static WeightPrefetch_Mode_t prefetch_mode;
+static uintptr_t weights_start;
+static uintptr_t weights_end;
+static const EpochBlock_DepsTypeDef *eb_deps;
+static const EpochBlock_ItemTypeDef *eb_list;
+static PrefetchEb_t eb_state[WEIGHT_PREFETCH_MAX_EB];
+static int nb_eb;
+static uint32_t nb_runs;
+static int warm_pending;
+static int warm_copies;
+
+/* Owner of the ATON IP during the warming copies. Its epoch block waits for no stream engine: the completion
+ * interrupts stay masked, WeightPrefetch_WaitWarm() polls them, and the ISR only sees errors, handled as for the
+ * epoch blocks of the runtime */
+static const EpochBlock_ItemTypeDef warm_eb = {.flags = EpochBlock_Flags_pure_hw};
+static NN_Instance_TypeDef warm_owner = {.exec_state = {.current_epoch_block = &warm_eb}};
+
+/* First weight ranges read by a blob, in the order of its reads metadata, within WEIGHT_PREFETCH_MAX_BYTES */
+static void WeightPrefetch_BlobRanges(const EpochBlock_DepsTypeDef *deps, PrefetchEb_t *state)
+{
+  uint32_t total = 0;
+
+  state->nb_warm = 0;
+  for (int i = 0; i < deps->nr_reads && state->nb_warm < WEIGHT_PREFETCH_MAX_RANGES; i++)
+  {
+    EpochBlock_MemRangeTypeDef range = deps->reads[i];
+
+    if (range.start < weights_start || range.end > weights_end || range.end <= range.start)
+    {
+      continue;
+    }
+    if (range.end - range.start > WEIGHT_PREFETCH_MAX_BYTES - total)
+    {
+      range.end = range.start + (WEIGHT_PREFETCH_MAX_BYTES - total);
+    }
+    state->warm[state->nb_warm++] = range;
+    total += range.end - range.start;
+    if (total == WEIGHT_PREFETCH_MAX_BYTES)
+    {
+      break;
+    }
+  }
+}
+
+static void WeightPrefetch_Scan(const EpochBlock_ItemTypeDef *list)
+{
+  eb_list = list;
+  for (nb_eb = 0; nb_eb < WEIGHT_PREFETCH_MAX_EB && !EpochBlock_IsLastEpochBlock(&list[nb_eb]); nb_eb++)
+  {
+    PrefetchEb_t *state = &eb_state[nb_eb];
+
+    state->stats.blob = EpochBlock_IsEpochBlob(&list[nb_eb]);
+    state->nb_warm = 0;
+    if (state->stats.blob && eb_deps != NULL)
+    {
+      WeightPrefetch_BlobRanges(&eb_deps[nb_eb], state);
+    }
+  }
+}
+
+/* One copy per range, stream engine 2i to 2i + 1 (port names are pasted) */
+static const LL_Switch_InitTypeDef warm_switch[WEIGHT_PREFETCH_MAX_RANGES] = {
+  {LL_Switch_Init_Dest() = ATONN_DSTPORT(STRSWITCH, 0, STRENG, 1, 0),
+   LL_Switch_Init_Source(0) = ATONN_SRCPORT(STRSWITCH, 0, STRENG, 0, 0), LL_Switch_Init_Context(0) = 1,
+   LL_Switch_Init_Frames(0) = 0},
+  {LL_Switch_Init_Dest() = ATONN_DSTPORT(STRSWITCH, 0, STRENG, 3, 0),
+   LL_Switch_Init_Source(0) = ATONN_SRCPORT(STRSWITCH, 0, STRENG, 2, 0), LL_Switch_Init_Context(0) = 1,
+   LL_Switch_Init_Frames(0) = 0},
+  {LL_Switch_Init_Dest() = ATONN_DSTPORT(STRSWITCH, 0, STRENG, 5, 0),
+   LL_Switch_Init_Source(0) = ATONN_SRCPORT(STRSWITCH, 0, STRENG, 4, 0), LL_Switch_Init_Context(0) = 1,
+   LL_Switch_Init_Frames(0) = 0},
+  {LL_Switch_Init_Dest() = ATONN_DSTPORT(STRSWITCH, 0, STRENG, 7, 0),
+   LL_Switch_Init_Source(0) = ATONN_SRCPORT(STRSWITCH, 0, STRENG, 6, 0), LL_Switch_Init_Context(0) = 1,
+   LL_Switch_Init_Frames(0) = 0},
+};
+
+/* Output engine then input engine of each copy */
+static const LL_ATON_EnableUnits_InitTypeDef warm_units[2 * WEIGHT_PREFETCH_MAX_RANGES] = {
+  {{STRENG, 1}}, {{STRENG, 0}}, {{STRENG, 3}}, {{STRENG, 2}},
+  {{STRENG, 5}}, {{STRENG, 4}}, {{STRENG, 7}}, {{STRENG, 6}},
+};
+
+/* Copies the ranges of 'state' through the NPU cache (allocating their lines) into the scratch buffer, without
+ * waiting. The ATON IP is owned until WeightPrefetch_WaitWarm(), only started if no instance owns it */
+static void WeightPrefetch_StartWarm(const PrefetchEb_t *state)
+{
+  extern NN_Instance_TypeDef *volatile __ll_current_aton_ip_owner;
+  uintptr_t dst = WEIGHT_PREFETCH_SCRATCH_ADDR;
+
+  if (__ll_current_aton_ip_owner != NULL)
+  {
+    return;
+  }
+  __ll_set_aton_owner(&warm_owner);
+
+  warm_copies = 0;
+  for (int i = 0; i < state->nb_warm; i++)
+  {
+    const EpochBlock_MemRangeTypeDef *range = &state->warm[i];
+    /* 24-bit units, the last bytes are left to the blob */
+    uint32_t n = range->end - range->start;
+    n -= n % 3;
+    if (n == 0)
+    {
+      continue;
+    }
+
+    LL_Streng_TensorInitTypeDef dma_in = {
+      .dir = 0,
+      .addr_base = {(unsigned char *) range->start},
+      .offset_start = 0,
+      .offset_end = n,
+      .offset_limit = weights_end - range->start,
+      .raw = 1,
+      .frame_offset = n,
+      .frame_tot_cnt = 1,
+      .nbits_in = 24,
+      .nbits_out = 24,
+      .cacheable = 1,
+      .cache_allocate = 1,
+    };
+    LL_Streng_TensorInitTypeDef dma_out = {
+      .dir = 1,
+      .addr_base = {(unsigned char *) dst},
+      .offset_start = 0,
+      .offset_end = n,
+      .raw = 1,
+      .frame_offset = n,
+      .frame_tot_cnt = 1,
+      .nbits_in = 24,
+      .nbits_out = 24,
+    };
+
+    LL_Streng_TensorInit(2 * warm_copies, &dma_in, 1);
+    LL_Streng_TensorInit(2 * warm_copies + 1, &dma_out, 1);
+    dst += n;
+    warm_copies++;
+  }
+
+  if (warm_copies == 0)
+  {
+    __ll_clear_aton_owner(&warm_owner);
+    return;
+  }
+  LL_Switch_Init(warm_switch, warm_copies);
+  LL_ATON_EnableUnits_Init(warm_units, 2 * warm_copies);
+  warm_pending = 1;
+}
+
+/* Hands the stream engines and the ATON IP back to the runtime */
+static void WeightPrefetch_WaitWarm(void)
+{
+  uint32_t out_mask = 0;
+
+  if (!warm_pending)
+  {
+    return;
+  }
+
+  for (int i = 0; i < warm_copies; i++)
+  {
+    out_mask |= 1 << (2 * i + 1);
+  }
+  LL_Streng_Wait(out_mask);
+  LL_ATON_DisableUnits_Init(warm_units, 2 * warm_copies);
+  LL_Switch_Deinit(warm_switch, warm_copies);
+  warm_pending = 0;
+  __ll_clear_aton_owner(&warm_owner);
+}
+
+/* End of profiling: the blobs missing the most are warmed from now on, measured again from scratch */
+static void WeightPrefetch_SelectCold(void)
+{
+  for (int i = 0; i < nb_eb; i++)
+  {
+    WeightPrefetch_EbStats_t *stats = &eb_state[i].stats;
+    uint64_t reads = stats->read_hits + stats->read_misses;
+
+    if (!stats->blob || eb_state[i].nb_warm == 0 || reads == 0)
+    {
+      continue;
+    }
+    if (stats->read_misses * 100 >= reads * WEIGHT_PREFETCH_COLD_MISS_PCT)
+    {
+      stats->cold = 1;
+      stats->warm_bytes = 0;
+      for (int j = 0; j < eb_state[i].nb_warm; j++)
+      {
+        stats->warm_bytes += eb_state[i].warm[j].end - eb_state[i].warm[j].start;
+      }
+    }
+  }
+
+  WeightPrefetch_ResetStats();
+}
+
+void WeightPrefetch_Init(WeightPrefetch_Mode_t mode, const EpochBlock_DepsTypeDef *deps, uintptr_t start,
+                         uint32_t size)
+{
+  memset(eb_state, 0, sizeof(eb_state));
+  prefetch_mode = mode;
+  eb_deps = deps;
+  weights_start = start;
+  weights_end = start + size;
+  eb_list = NULL;
+  nb_eb = 0;
+  nb_runs = 0;
+  warm_pending = 0;
+
+  if (mode == WEIGHT_PREFETCH_OFF)
+  {
+    return;
+  }
+
+  LL_Dbgtrc_BurstLenBenchStart(BURST_COUNTER);
+  npu_cache_monitor_start();
+}
+
+void WeightPrefetch_EpochCallback(LL_ATON_RT_Callbacktype_t ctype, const NN_Instance_TypeDef *nn_instance,
+                                  const EpochBlock_ItemTypeDef *eb)
+{
+  const NN_Execution_State_TypeDef *exec_state = &nn_instance->exec_state;
+  PrefetchEb_t *state;
+  int eb_idx;
+
+  if (prefetch_mode == WEIGHT_PREFETCH_OFF)
+  {
+    return;
+  }
+
+  /* A copy in flight must be done before anything else may use the stream engines */
+  if (ctype == LL_ATON_RT_Callbacktype_PRE_START && !EpochBlock_IsEpochPureSW(eb))
+  {
+    WeightPrefetch_WaitWarm();
+  }
+
+  /* Epoch blocks inserted by hybrid epochs are accounted to the one they belong to */
+  if (exec_state->saved_first_epoch_block != NULL)
+  {
+    return;
+  }
+
+  eb_idx = eb - exec_state->first_epoch_block;
+  if (ctype == LL_ATON_RT_Callbacktype_PRE_START && eb_idx == 0)
+  {
+    if (eb_list != exec_state->first_epoch_block)
+    {
+      WeightPrefetch_Scan(exec_state->first_epoch_block);
+    }
+    /* The monitors saturate, measured per inference */
+    npu_cache_monitor_reset();
+  }
+  if (eb_idx >= nb_eb)
+  {
+    return;
+  }
+
+  state = &eb_state[eb_idx];
+  if (ctype == LL_ATON_RT_Callbacktype_PRE_START)
+  {
+    npu_cache_monitor_read(&state->snap_hits, &state->snap_misses);
+    LL_Dbgtrc_GetTotalTranfers(BURST_COUNTER, &state->snap_writes, &state->snap_reads);
+    state->snap_ts = DWT->CYCCNT;
+
+    /* The NPU stays idle during a pure SW block, the next blob is warmed meanwhile */
+    if (EpochBlock_IsEpochPureSW(eb) && eb_idx + 1 < nb_eb && eb_state[eb_idx + 1].stats.cold && !warm_pending)
+    {
+      WeightPrefetch_StartWarm(&eb_state[eb_idx + 1]);
+    }
+  }
+  else if (ctype == LL_ATON_RT_Callbacktype_POST_END)
+  {
+    uint32_t hits, misses;
+    unsigned int reads, writes;
+
+    npu_cache_monitor_read(&hits, &misses);
+    LL_Dbgtrc_GetTotalTranfers(BURST_COUNTER, &writes, &reads);
+
+    state->stats.count++;
+    state->stats.ticks += DWT->CYCCNT - state->snap_ts;
+    state->stats.read_hits += hits - state->snap_hits;
+    state->stats.read_misses += misses - state->snap_misses;
+    /* Byte totals wrap around, their differences stay right */
+    state->stats.read_bytes += (uint32_t) (reads - state->snap_reads);
+    state->stats.write_bytes += (uint32_t) (writes - state->snap_writes);
+
+    if (EpochBlock_IsLastEpochBlock(eb + 1))
+    {
+      nb_runs++;
+      if (nb_runs == WEIGHT_PREFETCH_PROFILE_RUNS && prefetch_mode == WEIGHT_PREFETCH_AUTO)
+      {
+        WeightPrefetch_SelectCold();
+      }
+    }
+  }
+}
+
+void WeightPrefetch_Idle(void)
+{
+  if (prefetch_mode != WEIGHT_PREFETCH_AUTO || nb_eb == 0 || warm_pending)
+  {
+    return;
+  }
+
+  if (eb_state[0].stats.cold)
+  {
+    WeightPrefetch_StartWarm(&eb_state[0]);
+  }
+}
+
+void WeightPrefetch_ResetStats(void)
+{
+  for (int i = 0; i < WEIGHT_PREFETCH_MAX_EB; i++)
+  {
+    WeightPrefetch_EbStats_t *stats = &eb_state[i].stats;
+
+    stats->count = 0;
+    stats->ticks = 0;
+    stats->read_hits = 0;
+    stats->read_misses = 0;
+    stats->read_bytes = 0;
+    stats->write_bytes = 0;
+  }
+}
+
+int WeightPrefetch_GetNbEb(void)
+{
+  return nb_eb;
+}
+
+void WeightPrefetch_GetStats(int eb_idx, WeightPrefetch_EbStats_t *stats)
+{
+  *stats = eb_state[eb_idx].stats;
+}
+
+int WeightPrefetch_Report(char *buffer, size_t size)
+{
+  uint32_t ticks_per_us = SystemCoreClock >= 1000000 ? SystemCoreClock / 1000000 : 1;
+  int len;
+
+  if (prefetch_mode == WEIGHT_PREFETCH_OFF)
+    return 0;
+
+  len = snprintf(buffer, size, "%-7s %6s %5s %7s %7s %6s %7s\r\n", "eb", "us", "hit%", "rd_KB", "ext_KB", "MB/s",
+                 "warm_KB");
+  for (int i = 0; i < nb_eb && len >= 0 && (size_t) len < size; i++)
+  {
+    const WeightPrefetch_EbStats_t *stats = &eb_state[i].stats;
+    uint64_t reads = stats->read_hits + stats->read_misses;
+    uint32_t us, ext_bytes;
+
+    if (stats->count == 0)
+      continue;
+    us = stats->ticks / stats->count / ticks_per_us;
+    ext_bytes = stats->read_misses * NPU_CACHE_LINE / stats->count;
+    len += snprintf(buffer + len, size - len, "%2d %-4s %6lu %5lu %7lu %7lu %6lu %7lu\r\n", i,
+                    stats->blob ? "blob" : "sw",
+                    (unsigned long) us,
+                    (unsigned long) (reads ? stats->read_hits * 100 / reads : 0),
+                    (unsigned long) (stats->read_bytes / stats->count / 1024),
+                    (unsigned long) (ext_bytes / 1024),
+                    (unsigned long) (us ? ext_bytes / us : 0),
+                    (unsigned long) (stats->warm_bytes / 1024));
+  }
+
+  /* Truncated output: snprintf() returned the length it would have written */
+  if (len < 0)
+    return 0;
+  return (size_t) len < size ? len : (int) size - 1;
+}
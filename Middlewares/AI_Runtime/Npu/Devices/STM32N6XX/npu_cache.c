@@ -61,6 +61,30 @@ void npu_cache_clean_invalidate_range(uint32_t start_addr, uint32_t end_addr)
   HAL_CACHEAXI_CleanInvalidByAddr(&hcacheaxi_s, (uint32_t*)start_addr, end_addr-start_addr);
 }
 
+// Read hit/miss monitors: the counters saturate, the caller resets them often enough
+// (e.g. once per inference) and samples them around what it measures
+void npu_cache_monitor_start(void)
+{
+  HAL_CACHEAXI_Monitor_Reset(&hcacheaxi_s, CACHEAXI_MONITOR_READ_HIT | CACHEAXI_MONITOR_READ_MISS);
+  HAL_CACHEAXI_Monitor_Start(&hcacheaxi_s, CACHEAXI_MONITOR_READ_HIT | CACHEAXI_MONITOR_READ_MISS);
+}
+
+void npu_cache_monitor_stop(void)
+{
+  HAL_CACHEAXI_Monitor_Stop(&hcacheaxi_s, CACHEAXI_MONITOR_READ_HIT | CACHEAXI_MONITOR_READ_MISS);
+}
+
+void npu_cache_monitor_reset(void)
+{
+  HAL_CACHEAXI_Monitor_Reset(&hcacheaxi_s, CACHEAXI_MONITOR_READ_HIT | CACHEAXI_MONITOR_READ_MISS);
+}
+
+void npu_cache_monitor_read(uint32_t *read_hits, uint32_t *read_misses)
+{
+  *read_hits = HAL_CACHEAXI_Monitor_GetReadHitValue(&hcacheaxi_s);
+  *read_misses = HAL_CACHEAXI_Monitor_GetReadMissValue(&hcacheaxi_s);
+}
+
 void NPU_CACHE_IRQHandler(void)
 {
   __NOP();
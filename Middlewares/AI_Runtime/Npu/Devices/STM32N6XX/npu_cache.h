@@ -30,6 +30,10 @@ void npu_cache_disable(void);
 void npu_cache_invalidate(void);
 void npu_cache_clean_invalidate_range(uint32_t start_addr, uint32_t end_addr);
 void npu_cache_clean_range(uint32_t start_addr, uint32_t end_addr);
+void npu_cache_monitor_start(void);
+void npu_cache_monitor_stop(void);
+void npu_cache_monitor_reset(void);
+void npu_cache_monitor_read(uint32_t *read_hits, uint32_t *read_misses);
 
 #ifdef __cplusplus
 }
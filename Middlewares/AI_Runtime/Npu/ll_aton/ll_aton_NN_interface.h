@@ -106,6 +106,34 @@ extern "C"
 #endif                             // LL_ATON_EB_DBG_INFO
   } EpochBlock_ItemTypeDef;
 
+  /**
+   * @brief Memory range `[start, end)` accessed by an EpochBlock
+   */
+  typedef struct
+  {
+    uintptr_t start; /**< Address of the first byte */
+    uintptr_t end;   /**< Address of the first byte beyond the range */
+  } EpochBlock_MemRangeTypeDef;
+
+  typedef enum
+  {
+    EpochBlock_Deps_NONE = 0x0,                   /**< Listed ranges are only a subset of the accessed ones */
+    EpochBlock_Deps_complete_reads = (0x1 << 0),  /**< `reads` holds every range read by the EpochBlock */
+    EpochBlock_Deps_complete_writes = (0x1 << 1), /**< `writes` holds every range written by the EpochBlock */
+  } EpochBlock_DepsFlags_t;
+
+  /**
+   * @brief Buffer dependencies of an EpochBlock, one entry per item of the EpochBlock array (see `ll_aton_eb_deps.h`)
+   */
+  typedef struct
+  {
+    const EpochBlock_MemRangeTypeDef *reads;  /**< Ranges read by the EpochBlock */
+    const EpochBlock_MemRangeTypeDef *writes; /**< Ranges written by the EpochBlock */
+    uint16_t nr_reads;                        /**< Number of entries of `reads` */
+    uint16_t nr_writes;                       /**< Number of entries of `writes` */
+    uint16_t flags;                           /**< `EpochBlock_DepsFlags_t`, which of the lists are exhaustive */
+  } EpochBlock_DepsTypeDef;
+
   /**
    * @brief Checks if the pointed element is the last one of an array of `const EpochBlock_ItemTypeDef`
    *
@@ -465,6 +493,10 @@ extern "C"
     uint32_t inst_reloc;
 #endif
 
+#if defined(LL_ATON_RT_EB_OVERLAP)
+    const EpochBlock_DepsTypeDef *epoch_block_deps; // buffer dependencies of the network epoch blocks (may be `NULL`)
+#endif
+
   } NN_Execution_State_TypeDef;
 
   struct __nn_instance_struct
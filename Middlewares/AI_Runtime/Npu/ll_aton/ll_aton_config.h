@@ -65,6 +65,7 @@
 #define LL_ATON_PLAT_BITTWARE     13
 #define LL_ATON_PLAT_EC_TRACE     14
 #define LL_ATON_PLAT_STM32H7P     15
+#define LL_ATON_PLAT_HOST_SIM     16
 
 /* Definition of ATON RTOS abstraction layers */
 #define LL_ATON_OSAL_BARE_METAL 1
@@ -73,6 +74,7 @@
 #define LL_ATON_OSAL_THREADX    4
 #define LL_ATON_OSAL_FREERTOS   5
 #define LL_ATON_OSAL_ZEPHYR     6
+#define LL_ATON_OSAL_HOST_SIM   7
 
 #define LL_ATON_OSAL_USER_IMPL                                                                                         \
   ((1 << LL_ATON_CONFIG_OSAL_BSIZE) -                                                                                  \
@@ -139,6 +141,7 @@
 #if (LL_ATON_PLATFORM != LL_ATON_PLAT_BITTWARE)
 #if (LL_ATON_PLATFORM != LL_ATON_PLAT_EC_TRACE)
 #if (LL_ATON_PLATFORM != LL_ATON_PLAT_STM32H7P)
+#if (LL_ATON_PLATFORM != LL_ATON_PLAT_HOST_SIM)
 #error "Wrong definition of `LL_ATON_PLATFORM`"
 #endif
 #endif
@@ -155,6 +158,7 @@
 #endif
 #endif
 #endif
+#endif
 
 #if (LL_ATON_OSAL != LL_ATON_OSAL_BARE_METAL)
 #if (LL_ATON_OSAL != LL_ATON_OSAL_LINUX_UIO)
@@ -162,6 +166,7 @@
 #if (LL_ATON_OSAL != LL_ATON_OSAL_THREADX)
 #if (LL_ATON_OSAL != LL_ATON_OSAL_FREERTOS)
 #if (LL_ATON_OSAL != LL_ATON_OSAL_ZEPHYR)
+#if (LL_ATON_OSAL != LL_ATON_OSAL_HOST_SIM)
 #if (LL_ATON_OSAL != LL_ATON_OSAL_USER_IMPL)
 #error "Wrong definition of `LL_ATON_OSAL`"
 #endif
@@ -171,6 +176,7 @@
 #endif
 #endif
 #endif
+#endif
 
 #if (LL_ATON_RT_MODE != LL_ATON_RT_POLLING)
 #if (LL_ATON_RT_MODE != LL_ATON_RT_ASYNC)
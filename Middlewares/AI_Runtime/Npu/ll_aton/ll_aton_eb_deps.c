@@ -0,0 +1,320 @@
+/**
+ ******************************************************************************
+ * @file    ll_aton_eb_deps.c
+ * @brief   Buffer dependencies between epoch blocks
+ ******************************************************************************
+ ******************************************************************************
+ */
+
+#include <inttypes.h>
+#include <string.h>
+
+#include "ll_aton_eb_deps.h"
+#include "ll_aton_platform.h"
+#include "ll_aton_util.h"
+
+#define EB_DEPS_COMPLETE (EpochBlock_Deps_complete_reads | EpochBlock_Deps_complete_writes)
+
+/* Returns the aligned start of the first range of `a` sharing a line with a range of `b`, 0 if none */
+static uintptr_t __ll_aton_eb_deps_intersect(const EpochBlock_MemRangeTypeDef *a, uint16_t nr_a,
+                                            const EpochBlock_MemRangeTypeDef *b, uint16_t nr_b)
+{
+  const uintptr_t mask = ~((uintptr_t)LL_ATON_EB_DEPS_ALIGN - 1);
+
+  for (uint16_t i = 0; i < nr_a; i++)
+  {
+    uintptr_t a_start = a[i].start & mask;
+    uintptr_t a_end = (a[i].end + LL_ATON_EB_DEPS_ALIGN - 1) & mask;
+
+    for (uint16_t j = 0; j < nr_b; j++)
+    {
+      uintptr_t b_start = b[j].start & mask;
+      uintptr_t b_end = (b[j].end + LL_ATON_EB_DEPS_ALIGN - 1) & mask;
+
+      if ((a_start < b_end) && (b_start < a_end))
+      {
+        return (a_start > b_start) ? a_start : b_start;
+      }
+    }
+  }
+
+  return 0;
+}
+
+LL_ATON_EbDeps_Result_t LL_ATON_EbDeps_Check(const EpochBlock_DepsTypeDef *a, const EpochBlock_DepsTypeDef *b,
+                                             uintptr_t *conflict_addr)
+{
+  uintptr_t addr = 0;
+
+  if (conflict_addr != NULL)
+  {
+    *conflict_addr = 0;
+  }
+  if ((a == NULL) || (b == NULL))
+  {
+    return LL_ATON_EB_DEPS_UNKNOWN;
+  }
+
+  /* Write after write, read after write and write after read, in both directions */
+  addr = __ll_aton_eb_deps_intersect(a->writes, a->nr_writes, b->writes, b->nr_writes);
+  if (addr == 0)
+    addr = __ll_aton_eb_deps_intersect(a->writes, a->nr_writes, b->reads, b->nr_reads);
+  if (addr == 0)
+    addr = __ll_aton_eb_deps_intersect(b->writes, b->nr_writes, a->reads, a->nr_reads);
+
+  if (addr != 0)
+  {
+    if (conflict_addr != NULL)
+    {
+      *conflict_addr = addr;
+    }
+    return LL_ATON_EB_DEPS_DEPENDENT;
+  }
+
+  /* A conflict may hide in the ranges which are not listed */
+  if (((a->flags & EB_DEPS_COMPLETE) != EB_DEPS_COMPLETE) || ((b->flags & EB_DEPS_COMPLETE) != EB_DEPS_COMPLETE))
+  {
+    return LL_ATON_EB_DEPS_UNKNOWN;
+  }
+
+  return LL_ATON_EB_DEPS_INDEPENDENT;
+}
+
+/* Pure SW epoch block directly followed by an epoch blob (which is flagged pure HW) */
+static bool __ll_aton_eb_deps_is_candidate(const EpochBlock_ItemTypeDef *eb_list, uint32_t index)
+{
+  const EpochBlock_ItemTypeDef *eb = &eb_list[index];
+
+  if (EpochBlock_IsLastEpochBlock(eb) || !EpochBlock_IsEpochPureSW(eb))
+  {
+    return false;
+  }
+  eb++;
+  return !EpochBlock_IsLastEpochBlock(eb) && EpochBlock_IsEpochBlob(eb) && EpochBlock_IsEpochPureHW(eb);
+}
+
+bool LL_ATON_EbDeps_CanOverlapNext(const EpochBlock_ItemTypeDef *eb_list, const EpochBlock_DepsTypeDef *deps,
+                                   uint32_t index)
+{
+  LL_ATON_ASSERT(eb_list != NULL);
+
+  if ((deps == NULL) || !__ll_aton_eb_deps_is_candidate(eb_list, index))
+  {
+    return false;
+  }
+
+  return LL_ATON_EbDeps_Check(&deps[index], &deps[index + 1], NULL) == LL_ATON_EB_DEPS_INDEPENDENT;
+}
+
+uint32_t LL_ATON_EbDeps_Analyze(const EpochBlock_ItemTypeDef *eb_list, const EpochBlock_DepsTypeDef *deps,
+                                const uint32_t *durations, bool verbose, LL_ATON_EbDeps_Summary_t *summary)
+{
+  static const char *const result_names[] = {
+      [LL_ATON_EB_DEPS_INDEPENDENT] = "independent",
+      [LL_ATON_EB_DEPS_DEPENDENT] = "dependent",
+      [LL_ATON_EB_DEPS_UNKNOWN] = "unknown",
+  };
+  uint32_t i = 0;
+
+  LL_ATON_ASSERT(eb_list != NULL);
+  LL_ATON_ASSERT(summary != NULL);
+  LL_ATON_LIB_UNUSED(verbose);
+  LL_ATON_LIB_UNUSED(result_names);
+
+  memset(summary, 0, sizeof(*summary));
+
+  while (!EpochBlock_IsLastEpochBlock(&eb_list[i]))
+  {
+    uint32_t duration = (durations != NULL) ? durations[i] : 0;
+
+    summary->serial_ticks += duration;
+
+    if (!__ll_aton_eb_deps_is_candidate(eb_list, i))
+    {
+      summary->overlapped_ticks += duration;
+      i++;
+      continue;
+    }
+
+    /* The blob is started first, the SW block then runs on the MCU, the next block waits for both */
+    uint32_t next_duration = (durations != NULL) ? durations[i + 1] : 0;
+    uintptr_t conflict_addr = 0;
+    LL_ATON_EbDeps_Result_t res =
+        (deps != NULL) ? LL_ATON_EbDeps_Check(&deps[i], &deps[i + 1], &conflict_addr) : LL_ATON_EB_DEPS_UNKNOWN;
+
+    summary->nr_candidates++;
+    summary->serial_ticks += next_duration;
+    if (res == LL_ATON_EB_DEPS_INDEPENDENT)
+    {
+      summary->nr_independent++;
+      summary->overlapped_ticks += (duration > next_duration) ? duration : next_duration;
+    }
+    else
+    {
+      summary->overlapped_ticks += (uint64_t)duration + next_duration;
+    }
+
+    if (verbose)
+    {
+      if (res == LL_ATON_EB_DEPS_DEPENDENT)
+      {
+        LL_ATON_PRINTF("EB %" PRIu32 " (SW) / EB %" PRIu32 " (blob): %s, conflict at 0x%08" PRIxPTR "\n", i, i + 1,
+                       result_names[res], conflict_addr);
+      }
+      else
+      {
+        LL_ATON_PRINTF("EB %" PRIu32 " (SW) / EB %" PRIu32 " (blob): %s\n", i, i + 1, result_names[res]);
+      }
+    }
+
+    i += 2;
+  }
+
+  summary->nr_epoch_blocks = i;
+
+  if (verbose)
+  {
+    LL_ATON_PRINTF("%" PRIu32 " epoch blocks, %" PRIu32 "/%" PRIu32 " SW blocks may overlap, critical path %" PRIu64
+                   " -> %" PRIu64 "\n",
+                   summary->nr_epoch_blocks, summary->nr_independent, summary->nr_candidates, summary->serial_ticks,
+                   summary->overlapped_ticks);
+  }
+
+  return summary->nr_independent;
+}
+
+/* Whether [start, end) lies in the buffers of a buffer info array, up to their limit */
+static bool __ll_aton_eb_deps_in_buffers(const LL_Buffer_InfoTypeDef *const buffers[], uint32_t nr_arrays,
+                                         uintptr_t start, uintptr_t end)
+{
+  uintptr_t pos = start;
+
+  while (pos < end)
+  {
+    uintptr_t next = pos;
+
+    for (uint32_t a = 0; a < nr_arrays; a++)
+    {
+      for (const LL_Buffer_InfoTypeDef *buf = buffers[a]; (buf != NULL) && (buf->name != NULL); buf++)
+      {
+        uintptr_t buf_start = ATON_LIB_PHYSICAL_TO_VIRTUAL_ADDR((uintptr_t)LL_Buffer_addr_start(buf));
+        uintptr_t buf_limit = ATON_LIB_PHYSICAL_TO_VIRTUAL_ADDR((uintptr_t)LL_Buffer_addr_limit(buf));
+        uintptr_t buf_end = ATON_LIB_PHYSICAL_TO_VIRTUAL_ADDR((uintptr_t)LL_Buffer_addr_end(buf));
+
+        /* A buffer may be accessed up to its limit (e.g. padding), and at least up to its end */
+        if (buf_limit < buf_end)
+        {
+          buf_limit = buf_end;
+        }
+
+        if ((buf_start <= pos) && (pos < buf_limit) && (buf_limit > next))
+        {
+          next = buf_limit;
+        }
+      }
+    }
+
+    if (next == pos)
+    {
+      return false;
+    }
+    pos = next;
+  }
+
+  return true;
+}
+
+#ifdef LL_ATON_EB_DBG_INFO
+/* Whether [start, end) lies in the ranges of a list */
+static bool __ll_aton_eb_deps_in_ranges(const EpochBlock_MemRangeTypeDef *ranges, uint16_t nr_ranges, uintptr_t start,
+                                        uintptr_t end)
+{
+  uintptr_t pos = start;
+
+  while (pos < end)
+  {
+    uintptr_t next = pos;
+
+    for (uint16_t i = 0; i < nr_ranges; i++)
+    {
+      if ((ranges[i].start <= pos) && (pos < ranges[i].end) && (ranges[i].end > next))
+      {
+        next = ranges[i].end;
+      }
+    }
+
+    if (next == pos)
+    {
+      return false;
+    }
+    pos = next;
+  }
+
+  return true;
+}
+#endif
+
+bool LL_ATON_EbDeps_Validate(const NN_Interface_TypeDef *nn_interface, const EpochBlock_DepsTypeDef *deps)
+{
+  const EpochBlock_ItemTypeDef *eb_list;
+  const LL_Buffer_InfoTypeDef *buffers[3];
+  uint32_t i;
+
+  LL_ATON_ASSERT(nn_interface != NULL);
+  LL_ATON_ASSERT(deps != NULL);
+
+  eb_list = nn_interface->epoch_block_items();
+  buffers[0] = nn_interface->input_buffers_info();
+  buffers[1] = nn_interface->output_buffers_info();
+  buffers[2] = nn_interface->internal_buffers_info();
+
+  for (i = 0; !EpochBlock_IsLastEpochBlock(&eb_list[i]); i++)
+  {
+    const EpochBlock_DepsTypeDef *d = &deps[i];
+
+    /* Table shorter than the epoch block array */
+    if ((d->reads == NULL) && (d->writes == NULL))
+    {
+      return false;
+    }
+    for (uint16_t r = 0; r < d->nr_reads; r++)
+    {
+      if (!__ll_aton_eb_deps_in_buffers(buffers, 3, d->reads[r].start, d->reads[r].end))
+      {
+        return false;
+      }
+    }
+    for (uint16_t w = 0; w < d->nr_writes; w++)
+    {
+      if (!__ll_aton_eb_deps_in_buffers(buffers, 3, d->writes[w].start, d->writes[w].end))
+      {
+        return false;
+      }
+    }
+
+#ifdef LL_ATON_EB_DBG_INFO
+    if (EpochBlock_IsEpochBlob(&eb_list[i]))
+    {
+      for (uint32_t a = 1; a < 3; a++)
+      {
+        for (const LL_Buffer_InfoTypeDef *buf = buffers[a]; (buf != NULL) && (buf->name != NULL); buf++)
+        {
+          if (buf->is_param || (buf->epoch < eb_list[i].epoch_num) || (buf->epoch > eb_list[i].last_epoch_num))
+          {
+            continue;
+          }
+          if (!__ll_aton_eb_deps_in_ranges(d->writes, d->nr_writes,
+                                           ATON_LIB_PHYSICAL_TO_VIRTUAL_ADDR((uintptr_t)LL_Buffer_addr_start(buf)),
+                                           ATON_LIB_PHYSICAL_TO_VIRTUAL_ADDR((uintptr_t)LL_Buffer_addr_end(buf))))
+          {
+            return false;
+          }
+        }
+      }
+    }
+#endif
+  }
+
+  /* Table longer than the epoch block array */
+  return (deps[i].reads == NULL) && (deps[i].writes == NULL) && (deps[i].nr_reads == 0) && (deps[i].nr_writes == 0);
+}
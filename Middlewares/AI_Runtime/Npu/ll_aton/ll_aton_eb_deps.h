@@ -0,0 +1,94 @@
+/**
+ ******************************************************************************
+ * @file    ll_aton_eb_deps.h
+ * @brief   Buffer dependencies between epoch blocks: independence check used by the
+ *          SW/HW overlap mode of the runtime (`LL_ATON_RT_EB_OVERLAP`) and offline analysis
+ ******************************************************************************
+ ******************************************************************************
+ */
+
+#ifndef __LL_ATON_EB_DEPS_H
+#define __LL_ATON_EB_DEPS_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "ll_aton_NN_interface.h"
+
+/* Granularity of the conflict check: the MCU cache maintenance done by the epoch blocks works on whole lines,
+ * so two ranges sharing a line are never independent */
+#ifndef LL_ATON_EB_DEPS_ALIGN
+#define LL_ATON_EB_DEPS_ALIGN 32
+#endif
+
+  typedef enum
+  {
+    LL_ATON_EB_DEPS_INDEPENDENT = 0, /**< Both epoch blocks may run concurrently */
+    LL_ATON_EB_DEPS_DEPENDENT,       /**< A range written by one epoch block is accessed by the other */
+    LL_ATON_EB_DEPS_UNKNOWN,         /**< No conflict found, but the metadata of at least one block is partial */
+  } LL_ATON_EbDeps_Result_t;
+
+  /**
+   * @brief Result of `LL_ATON_EbDeps_Analyze()`
+   */
+  typedef struct
+  {
+    uint32_t nr_epoch_blocks;  /**< Epoch blocks of the array, without the terminating one */
+    uint32_t nr_candidates;    /**< Pure SW epoch blocks directly followed by an epoch blob */
+    uint32_t nr_independent;   /**< Candidates which may overlap with the following epoch blob */
+    uint64_t serial_ticks;     /**< Sum of the durations, i.e. execution in array order */
+    uint64_t overlapped_ticks; /**< Critical path when each independent pair runs concurrently */
+  } LL_ATON_EbDeps_Summary_t;
+
+  /**
+   * @brief Checks whether two epoch blocks may run concurrently
+   * @param a             Buffer dependencies of the first epoch block (`NULL` if unknown)
+   * @param b             Buffer dependencies of the second epoch block (`NULL` if unknown)
+   * @param conflict_addr If not `NULL`, receives the (aligned) start of the first conflicting range, if any
+   * @retval See `LL_ATON_EbDeps_Result_t`
+   */
+  LL_ATON_EbDeps_Result_t LL_ATON_EbDeps_Check(const EpochBlock_DepsTypeDef *a, const EpochBlock_DepsTypeDef *b,
+                                               uintptr_t *conflict_addr);
+
+  /**
+   * @brief Checks whether epoch block `index` of an array is a pure SW block which may run while the following
+   *        epoch blob executes on the NPU
+   * @param eb_list Epoch block array of the network
+   * @param deps    Buffer dependencies, one entry per item of `eb_list`
+   * @param index   Index of the pure SW epoch block
+   */
+  bool LL_ATON_EbDeps_CanOverlapNext(const EpochBlock_ItemTypeDef *eb_list, const EpochBlock_DepsTypeDef *deps,
+                                     uint32_t index);
+
+  /**
+   * @brief Reports which epoch blocks of a network could overlap and simulates the resulting critical path
+   * @param eb_list   Epoch block array of the network (e.g. `LL_ATON_EpochBlockItems_Default()`)
+   * @param deps      Buffer dependencies, one entry per item of `eb_list`
+   * @param durations Duration of each epoch block in any time unit (measured or synthetic), may be `NULL`
+   * @param verbose   Prints one line per candidate with `LL_ATON_PRINTF()`
+   * @param summary   Receives the result
+   * @retval Number of pure SW epoch blocks which may overlap with the following epoch blob
+   */
+  uint32_t LL_ATON_EbDeps_Analyze(const EpochBlock_ItemTypeDef *eb_list, const EpochBlock_DepsTypeDef *deps,
+                                  const uint32_t *durations, bool verbose, LL_ATON_EbDeps_Summary_t *summary);
+
+  /**
+   * @brief Checks buffer dependencies against the network they describe, e.g. a table not generated again along
+   *        with the network (`Tools/gen_eb_deps.py`)
+   * @param nn_interface Network
+   * @param deps         Buffer dependencies, one entry per epoch block of the network
+   * @retval true if there is one entry per epoch block and each range lies in the buffers of the buffer infos.
+   *         With `LL_ATON_EB_DBG_INFO`, the writes of each epoch blob also cover the buffers of its epochs
+   */
+  bool LL_ATON_EbDeps_Validate(const NN_Interface_TypeDef *nn_interface, const EpochBlock_DepsTypeDef *deps);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __LL_ATON_EB_DEPS_H
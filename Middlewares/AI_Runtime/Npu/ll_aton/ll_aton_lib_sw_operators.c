@@ -26,6 +26,11 @@
 #include "ll_aton_lib_sw_operators.h"
 #include "ll_aton_runtime.h"
 
+#if defined(__ARM_FEATURE_MVE) && (__ARM_FEATURE_MVE & 1)
+#include <arm_mve.h>
+#define LL_ATON_LIB_USE_MVEI
+#endif
+
 /* Common data structure(s) */
 typedef struct __ll_stack_lnklst
 {
@@ -83,6 +88,102 @@ static inline void __ll_aton_lib_copy_element(uint8_t nbytes, int32_t index, int
   }
 }
 
+/* Copies `size` contiguous bytes, with tail-predicated 16-byte vectors when MVE is available */
+static inline void __ll_aton_lib_block_copy(int8_t *dst, const int8_t *src, uint32_t size)
+{
+#if defined(LL_ATON_LIB_USE_MVEI)
+  int32_t remaining = (int32_t)size;
+  while (remaining > 0)
+  {
+    mve_pred16_t p = vctp8q((uint32_t)remaining);
+    vst1q_p_s8(dst, vld1q_z_s8(src, p), p);
+    src += 16;
+    dst += 16;
+    remaining -= 16;
+  }
+#else
+  memcpy(dst, src, size);
+#endif
+}
+
+#if !defined(LL_ATON_LIB_SW_OPS_REFERENCE)
+/* Copies `n` elements of `nbytes` bytes, `src_stride`/`dst_stride` bytes apart (non-negative strides) */
+static void __ll_aton_lib_strided_copy(int8_t *dst, uint32_t dst_stride, const int8_t *src, uint32_t src_stride,
+                                       uint32_t n, uint8_t nbytes)
+{
+  if ((dst_stride == nbytes) && (src_stride == nbytes))
+  {
+    __ll_aton_lib_block_copy(dst, src, n * nbytes);
+    return;
+  }
+
+#if defined(LL_ATON_LIB_USE_MVEI)
+  /* Gather/scatter 4 elements at a time, zero-extended to 32-bit lanes */
+  if (nbytes != 3)
+  {
+    uint32x4_t src_offsets = vmulq_n_u32(vidupq_n_u32(0, 1), src_stride);
+    uint32x4_t dst_offsets = vmulq_n_u32(vidupq_n_u32(0, 1), dst_stride);
+    int32_t remaining = (int32_t)n;
+
+    while (remaining > 0)
+    {
+      mve_pred16_t p = vctp32q((uint32_t)remaining);
+      uint32x4_t values;
+
+      switch (nbytes)
+      {
+      case 1:
+        values = vldrbq_gather_offset_z_u32((const uint8_t *)src, src_offsets, p);
+        vstrbq_scatter_offset_p_u32((uint8_t *)dst, dst_offsets, values, p);
+        break;
+      case 2:
+        values = vldrhq_gather_offset_z_u32((const uint16_t *)src, src_offsets, p);
+        vstrhq_scatter_offset_p_u32((uint16_t *)dst, dst_offsets, values, p);
+        break;
+      default:
+        values = vldrwq_gather_offset_z_u32((const uint32_t *)src, src_offsets, p);
+        vstrwq_scatter_offset_p_u32((uint32_t *)dst, dst_offsets, values, p);
+        break;
+      }
+      src += 4 * src_stride;
+      dst += 4 * dst_stride;
+      remaining -= 4;
+    }
+    return;
+  }
+#endif
+
+  switch (nbytes)
+  {
+  case 1:
+    for (uint32_t i = 0; i < n; i++, dst += dst_stride, src += src_stride)
+      *dst = *src;
+    return;
+  case 2:
+    LL_ATON_ASSERT(((((uintptr_t)src) | ((uintptr_t)dst) | src_stride | dst_stride) % 2) == 0);
+    for (uint32_t i = 0; i < n; i++, dst += dst_stride, src += src_stride)
+      *((int16_t *)dst) = *((const int16_t *)src);
+    return;
+  case 3: // NOTE: assuming no alignment
+    for (uint32_t i = 0; i < n; i++, dst += dst_stride, src += src_stride)
+    {
+      dst[0] = src[0];
+      dst[1] = src[1];
+      dst[2] = src[2];
+    }
+    return;
+  case 4:
+    LL_ATON_ASSERT(((((uintptr_t)src) | ((uintptr_t)dst) | src_stride | dst_stride) % 4) == 0);
+    for (uint32_t i = 0; i < n; i++, dst += dst_stride, src += src_stride)
+      *((int32_t *)dst) = *((const int32_t *)src);
+    return;
+  default:
+    LL_ATON_ASSERT(false);
+    return;
+  }
+}
+#endif // !LL_ATON_LIB_SW_OPS_REFERENCE
+
 static inline uint32_t __ll_aton_lib_calc_offset(uint32_t n, uint32_t c, uint32_t h, uint32_t w, uint32_t offset_0,
                                                  uint32_t offset_1, uint32_t offset_2, uint32_t offset_3)
 {
@@ -945,6 +1046,7 @@ static void __ll_aton_lib_transpose(uint32_t curr_in_axis, uint32_t inner_out_ax
   }
 }
 
+#if defined(LL_ATON_LIB_SW_OPS_REFERENCE)
 static inline uint32_t __ll_transp_find_input_index_3or4(uint32_t *indexes, const uint8_t *perm, uint32_t output_axis)
 {
   uint32_t input_axis = (uint32_t)perm[output_axis];
@@ -983,6 +1085,7 @@ static int8_t *__ll_transp_get_input_base_pos_3or4(const __ll_transp_params_t *c
 
   return (int8_t *)target;
 }
+#endif // LL_ATON_LIB_SW_OPS_REFERENCE
 
 static inline uint32_t __ll_transp_get_inner_out_axis(const __ll_transp_params_t *common_params)
 {
@@ -995,6 +1098,7 @@ static inline uint32_t __ll_transp_get_inner_out_axis(const __ll_transp_params_t
   return common_params->rank; // make compiler happy
 }
 
+#if defined(LL_ATON_LIB_SW_OPS_REFERENCE)
 static void __ll_aton_lib_transpose_3or4(const __ll_transp_params_t *common_params)
 {
   LL_ATON_ASSERT((common_params->rank == 4) || ((common_params->rank == 3)));
@@ -1039,6 +1143,148 @@ static void __ll_aton_lib_transpose_3or4(const __ll_transp_params_t *common_para
     }
   }
 }
+#endif // LL_ATON_LIB_SW_OPS_REFERENCE
+
+#if !defined(LL_ATON_LIB_SW_OPS_REFERENCE)
+/* Axis of the iterative transpose, strides in bytes */
+typedef struct
+{
+  uint32_t size;
+  uint32_t in_stride;
+  uint32_t out_stride;
+} __ll_transp_axis_t;
+
+/* Lists the input axes (innermost last) with their input/output strides, dropping the unit axes and merging each axis
+   into the previous one when both are contiguous in input and output; returns the number of axes left */
+static uint32_t __ll_transp_coalesce_axes(const __ll_transp_params_t *common_params, __ll_transp_axis_t *axes)
+{
+  uint32_t naxes = 0;
+
+  for (uint32_t in_axis = 0; in_axis < common_params->rank; in_axis++)
+  {
+    uint32_t size = common_params->in_shape_aton[in_axis];
+    uint32_t in_stride =
+        (in_axis == (common_params->rank - 1)) ? common_params->byte_size : common_params->in_axis_off[in_axis];
+    uint32_t out_stride = 0;
+
+    if (size == 1)
+      continue;
+
+    for (uint32_t out_axis = 0; out_axis < common_params->rank; out_axis++)
+    {
+      if (((uint32_t)common_params->perm[out_axis]) == in_axis)
+        out_stride = common_params->out_axis_off[out_axis];
+    }
+
+    if ((naxes > 0) && (axes[naxes - 1].in_stride == (in_stride * size)) &&
+        (axes[naxes - 1].out_stride == (out_stride * size)))
+    {
+      axes[naxes - 1].size *= size;
+      axes[naxes - 1].in_stride = in_stride;
+      axes[naxes - 1].out_stride = out_stride;
+    }
+    else
+    {
+      axes[naxes].size = size;
+      axes[naxes].in_stride = in_stride;
+      axes[naxes].out_stride = out_stride;
+      naxes++;
+    }
+  }
+
+  return naxes;
+}
+
+static void __ll_aton_lib_transpose_iter(const __ll_transp_params_t *common_params)
+{
+  LL_ATON_ASSERT(common_params->rank <= __LL_SW_OPS_MAX_RANK);
+
+  __ll_transp_axis_t axes[__LL_SW_OPS_MAX_RANK];
+  uint32_t indexes[__LL_SW_OPS_MAX_RANK] = {0};
+  const uint8_t byte_size = common_params->byte_size;
+  const int8_t *in_target = common_params->in_tensor;
+  int8_t *out_target = common_params->out_tensor;
+
+  for (uint32_t axis = 0; axis < common_params->rank; axis++)
+  {
+    if (common_params->in_shape_aton[axis] == 0)
+      return; // empty tensor
+  }
+
+  uint32_t naxes = __ll_transp_coalesce_axes(common_params, axes);
+  if (naxes == 0)
+  { // single element
+    axes[0].size = 1;
+    axes[0].in_stride = byte_size;
+    axes[0].out_stride = byte_size;
+    naxes = 1;
+  }
+
+  /* The innermost axis is copied by each strided copy, the outer ones are iterated below */
+  const __ll_transp_axis_t inner = axes[--naxes];
+
+  /* When another axis is the contiguous one in the output, its elements are copied in bands of one D-cache line:
+     for each element of the inner axis, the band is read from one line of each of its input rows and written to one
+     output line, so that the input lines are reused by the following elements of the inner axis. Not worth it when
+     the axis is shorter than a band */
+  const uint32_t band_elems = (byte_size < __LL_TRANSP_TILE_BYTES) ? (__LL_TRANSP_TILE_BYTES / byte_size) : 1;
+  __ll_transp_axis_t band = {.size = 0};
+  if ((inner.in_stride == byte_size) && (inner.out_stride != byte_size))
+  {
+    for (uint32_t axis = 0; axis < naxes; axis++)
+    {
+      if ((axes[axis].out_stride == byte_size) && (axes[axis].size >= band_elems))
+      {
+        band = axes[axis];
+        for (; axis < (naxes - 1); axis++)
+        {
+          axes[axis] = axes[axis + 1];
+        }
+        naxes--;
+        break;
+      }
+    }
+  }
+
+  for (;;)
+  {
+    if (band.size > 0)
+    {
+      for (uint32_t band_start = 0; band_start < band.size; band_start += band_elems)
+      {
+        uint32_t n = ((band.size - band_start) < band_elems) ? (band.size - band_start) : band_elems;
+        const int8_t *in_band = in_target + (band_start * band.in_stride);
+        int8_t *out_band = out_target + (band_start * byte_size);
+
+        for (uint32_t index = 0; index < inner.size; index++)
+        {
+          __ll_aton_lib_strided_copy(out_band + (index * inner.out_stride), byte_size, in_band + (index * byte_size),
+                                     band.in_stride, n, byte_size);
+        }
+      }
+    }
+    else
+    {
+      __ll_aton_lib_strided_copy(out_target, inner.out_stride, in_target, inner.in_stride, inner.size, byte_size);
+    }
+
+    /* Next position of the outer axes */
+    int32_t axis = (int32_t)naxes - 1;
+    for (; axis >= 0; axis--)
+    {
+      in_target += axes[axis].in_stride;
+      out_target += axes[axis].out_stride;
+      if (++indexes[axis] < axes[axis].size)
+        break;
+      in_target -= axes[axis].in_stride * axes[axis].size;
+      out_target -= axes[axis].out_stride * axes[axis].size;
+      indexes[axis] = 0;
+    }
+    if (axis < 0)
+      break;
+  }
+}
+#endif // !LL_ATON_LIB_SW_OPS_REFERENCE
 
 int LL_ATON_LIB_Transpose(const LL_LIB_TensorShape_TypeDef *input, const uint32_t *input_axes_offsets,
                           const LL_LIB_TensorShape_TypeDef *output, const uint32_t *output_axes_offsets,
@@ -1073,10 +1319,17 @@ int LL_ATON_LIB_Transpose(const LL_LIB_TensorShape_TypeDef *input, const uint32_
                                               .in_tensor = (int8_t *)LL_Buffer_addr_start(input),
                                               .out_tensor = (int8_t *)LL_Buffer_addr_start(output)};
 
+#if defined(LL_ATON_LIB_SW_OPS_REFERENCE)
   if (input->ndims <= 4)
   {
     __ll_aton_lib_transpose_3or4(&common_params);
   }
+#else
+  if (input->ndims <= __LL_SW_OPS_MAX_RANK)
+  {
+    __ll_aton_lib_transpose_iter(&common_params);
+  }
+#endif
   else
   {
     uint32_t inner_out_axis = __ll_transp_get_inner_out_axis(&common_params);
@@ -1726,6 +1979,223 @@ static void __ll_aton_lib_pad_edge_sw(uint32_t curr_axis, __ll_pad_sw_params_t *
   }
 }
 
+#if !defined(LL_ATON_LIB_SW_OPS_REFERENCE)
+/* Reads the element of `nbytes` bytes at `src` as the value of `__ll_aton_lib_memset()` */
+static inline int32_t __ll_aton_lib_load_element(uint8_t nbytes, const int8_t *src)
+{
+  switch (nbytes)
+  {
+  case 1:
+    return *src;
+  case 2:
+    return *((const int16_t *)src);
+  case 3: // NOTE: assuming no alignment
+    return (uint8_t)src[0] | ((uint8_t)src[1] << 8) | ((uint8_t)src[2] << 16);
+  case 4:
+    return *((const int32_t *)src);
+  default:
+    LL_ATON_ASSERT(false);
+    return 0;
+  }
+}
+
+/* Writes `nr_pads` items of `item_bytes` bytes next to the `n_elems` items already in the output: before them (`start`,
+   `edge_item` being the first one) or after them (`edge_item` being the last one). Items are elements (`item_bytes ==
+   nbytes`) on the innermost axis, rows of the inner axes otherwise */
+static void __ll_aton_lib_pad_items_sw(const __ll_pad_sw_params_t *common_params, int8_t *edge_item, int32_t n_elems,
+                                       int32_t item_bytes, int32_t nr_pads, bool start)
+{
+  const uint8_t nbytes = common_params->nbytes;
+  const int32_t step = start ? -item_bytes : item_bytes;
+
+  LL_ATON_ASSERT(n_elems > 0);
+
+#if defined(DUMP_DEBUG_SW_OPS)
+  LL_ATON_PRINTF("%s(%d): mode=%d, edge=%p, n_elems=%d, item_bytes=%d, nr_pads=%d, start=%d\n", __func__, __LINE__,
+                 common_params->mode, edge_item, n_elems, item_bytes, nr_pads, start);
+#endif
+
+  if (common_params->mode == 1)
+  { // `reflect`: items 1, 2, ..., n_elems - 1, n_elems - 2, ..., 0, 1, ... away from the edge
+    const int32_t period = 2 * (n_elems - 1);
+
+    for (int32_t i = 1; i <= nr_pads; i++)
+    {
+      int32_t pos = (period > 0) ? (i % period) : 0;
+      int32_t src_idx = (pos < n_elems) ? pos : (period - pos);
+      int8_t *dst_ptr = edge_item + (i * step);
+      int8_t *src_ptr = edge_item - (src_idx * step);
+
+      if (item_bytes == nbytes)
+      {
+        __ll_aton_lib_copy_element(nbytes, src_idx, dst_ptr, src_ptr);
+      }
+      else
+      {
+        __ll_aton_lib_block_copy(dst_ptr, src_ptr, item_bytes);
+      }
+    }
+  }
+  else
+  { // `edge`: copies of the edge item
+    if (item_bytes == nbytes)
+    {
+      int8_t *dst_ptr = start ? (edge_item - (nr_pads * item_bytes)) : (edge_item + item_bytes);
+      __ll_aton_lib_memset(nbytes, dst_ptr, __ll_aton_lib_load_element(nbytes, edge_item), nr_pads * item_bytes);
+    }
+    else
+    {
+      for (int32_t i = 1; i <= nr_pads; i++)
+      {
+        __ll_aton_lib_block_copy(edge_item + (i * step), edge_item, item_bytes);
+      }
+    }
+  }
+}
+
+/* Padded axes, items on the innermost one and rows of the inner axes on the other ones */
+static inline int32_t __ll_aton_lib_pad_item_bytes(const __ll_pad_sw_params_t *common_params, uint32_t axis)
+{
+  return (axis == (common_params->tensor_rank - 1)) ? common_params->nbytes : common_params->out_offsets[axis];
+}
+
+/* Output position and iteration of the axes being padded */
+typedef struct
+{
+  int8_t *out_start;
+  uint32_t index;
+} __ll_pad_axis_state_t;
+
+static inline void __ll_aton_lib_pad_enter_axis_sw(uint32_t axis, __ll_pad_sw_params_t *common_params,
+                                                   __ll_pad_axis_state_t *state)
+{
+  if (common_params->mode == 2)
+  { // `edge`: negative paddings crop the input
+    if (common_params->pad_in_offsets_start[axis] < 0)
+    {
+      common_params->in_target -= common_params->pad_in_offsets_start[axis];
+    }
+  }
+  else
+  {
+    LL_ATON_ASSERT(common_params->pad_in_offsets_start[axis] >= 0);
+  }
+
+  state->out_start = common_params->out_target;
+  state->index = 0;
+
+  if (common_params->pad_out_offsets_start[axis] > 0)
+  {
+    common_params->out_target += common_params->pad_out_offsets_start[axis];
+  }
+}
+
+/* Pads the axis once its content is in the output */
+static inline void __ll_aton_lib_pad_leave_axis_sw(uint32_t axis, __ll_pad_sw_params_t *common_params,
+                                                   const __ll_pad_axis_state_t *state)
+{
+  const int32_t item_bytes = __ll_aton_lib_pad_item_bytes(common_params, axis);
+  const int32_t n_elems = common_params->min_shape[axis];
+
+  if (common_params->pad_out_offsets_start[axis] > 0)
+  {
+    __ll_aton_lib_pad_items_sw(common_params, state->out_start + common_params->pad_out_offsets_start[axis], n_elems,
+                               item_bytes, common_params->pad_out_offsets_start[axis] / item_bytes, true);
+  }
+
+  if (common_params->pad_out_offsets_end[axis] > 0)
+  {
+    __ll_aton_lib_pad_items_sw(common_params, common_params->out_target - item_bytes, n_elems, item_bytes,
+                               common_params->pad_out_offsets_end[axis] / item_bytes, false);
+    common_params->out_target += common_params->pad_out_offsets_end[axis];
+    LL_ATON_ASSERT(common_params->out_target <= common_params->end_out_target);
+  }
+
+  if (common_params->mode == 2)
+  {
+    if (common_params->pad_in_offsets_end[axis] < 0)
+    {
+      common_params->in_target -= common_params->pad_in_offsets_end[axis];
+    }
+  }
+  else
+  {
+    LL_ATON_ASSERT(common_params->pad_in_offsets_end[axis] >= 0);
+  }
+}
+
+/* `reflect` and `edge` modes without recursion: the inner axes without any padding are handled as rows copied at
+   once, each padded axis is padded once its content is in the output, from that content */
+static void __ll_aton_lib_pad_iter_sw(__ll_pad_sw_params_t *common_params, bool fill)
+{
+  LL_ATON_ASSERT(common_params->tensor_rank <= __LL_SW_OPS_MAX_RANK);
+  LL_ATON_ASSERT((common_params->mode == 1) || (common_params->mode == 2));
+
+  __ll_pad_axis_state_t state[__LL_SW_OPS_MAX_RANK];
+  uint32_t inner_axis = 0;
+
+  for (uint32_t axis = 0; axis < common_params->tensor_rank; axis++)
+  {
+    if ((common_params->pad_in_offsets_start[axis] != 0) || (common_params->pad_in_offsets_end[axis] != 0) ||
+        (common_params->pad_out_offsets_start[axis] != 0) || (common_params->pad_out_offsets_end[axis] != 0))
+    {
+      inner_axis = axis;
+    }
+  }
+
+  uint32_t axis = 0;
+  __ll_aton_lib_pad_enter_axis_sw(axis, common_params, &state[axis]);
+  for (;;)
+  {
+    if (axis == inner_axis)
+    {
+      int32_t filling_bytes = common_params->min_shape[axis] * __ll_aton_lib_pad_item_bytes(common_params, axis);
+
+      if (fill)
+      {
+        __ll_aton_lib_block_copy(common_params->out_target, common_params->in_target, filling_bytes);
+      }
+      common_params->in_target += filling_bytes;
+      common_params->out_target += filling_bytes;
+      LL_ATON_ASSERT(common_params->out_target <= common_params->end_out_target);
+    }
+    else if (state[axis].index < common_params->min_shape[axis])
+    {
+      state[axis].index++;
+      axis++;
+      __ll_aton_lib_pad_enter_axis_sw(axis, common_params, &state[axis]);
+      continue;
+    }
+
+    __ll_aton_lib_pad_leave_axis_sw(axis, common_params, &state[axis]);
+    if (axis == 0)
+      break;
+    axis--;
+  }
+}
+#endif // !LL_ATON_LIB_SW_OPS_REFERENCE
+
+/* `reflect` and `edge` modes, `fill` copying the input too */
+static void __ll_aton_lib_pad_framing_mode_sw(__ll_pad_sw_params_t *common_params, bool fill)
+{
+#if !defined(LL_ATON_LIB_SW_OPS_REFERENCE)
+  if (common_params->tensor_rank <= __LL_SW_OPS_MAX_RANK)
+  {
+    __ll_aton_lib_pad_iter_sw(common_params, fill);
+    return;
+  }
+#endif
+
+  if (common_params->mode == 1)
+  {
+    __ll_aton_lib_pad_reflect_sw(0, common_params, fill);
+  }
+  else
+  {
+    __ll_aton_lib_pad_edge_sw(0, common_params, fill);
+  }
+}
+
 static int __ll_aton_lib_pad_filling(__ll_pad_sw_params_t *common_params)
 {
 #ifndef NDEBUG
@@ -1876,11 +2346,8 @@ static int __ll_aton_lib_pad_framing_sw(__ll_pad_sw_params_t *common_params)
   switch (common_params->mode)
   {
   case 1: // `reflect` mode
-    __ll_aton_lib_pad_reflect_sw(0, common_params, false);
-    break;
-
   case 2: // `edge` mode
-    __ll_aton_lib_pad_edge_sw(0, common_params, false);
+    __ll_aton_lib_pad_framing_mode_sw(common_params, false);
     break;
 
   default:
@@ -2041,7 +2508,7 @@ int LL_ATON_LIB_Pad(unsigned char *input, unsigned char *output, unsigned char *
   case 1: // `reflect` mode
     if ((consecutive_bytes < __LL_PAD_FILLING_DMA_MIN_BUFF_LEN) || (tensor_rank > __LL_DMA_PAD_MAX_DIMS))
     {                                                        // do it without HW support
-      __ll_aton_lib_pad_reflect_sw(0, &common_params, true); // all (i.e. `filling` & `framing`) is done in SW
+      __ll_aton_lib_pad_framing_mode_sw(&common_params, true); // all (i.e. `filling` & `framing`) is done in SW
     }
     else
     {
@@ -2052,8 +2519,8 @@ int LL_ATON_LIB_Pad(unsigned char *input, unsigned char *output, unsigned char *
 
   case 2: // `edge` mode
     if ((consecutive_bytes < __LL_PAD_FILLING_DMA_MIN_BUFF_LEN) || (tensor_rank > __LL_DMA_PAD_MAX_DIMS))
-    {                                                     // do it without HW support
-      __ll_aton_lib_pad_edge_sw(0, &common_params, true); // all is done in SW
+    {                                                          // do it without HW support
+      __ll_aton_lib_pad_framing_mode_sw(&common_params, true); // all is done in SW
     }
     else
     {
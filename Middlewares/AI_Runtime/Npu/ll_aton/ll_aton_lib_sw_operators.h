@@ -34,12 +34,20 @@ extern "C"
 #define __LL_PAD_FRAMING_DMA_MIN_BUFF_LEN 9500
 #define __LL_PAD_FILLING_DMA_MIN_BUFF_LEN 1200
 
+// Highest rank handled by the iterative `Transpose`/`Pad` SW operators, beyond the recursive reference ones are used
+#define __LL_SW_OPS_MAX_RANK 8
+// Size (in bytes) of the tile rows/columns of the SW `Transpose` operator, i.e. one D-cache line of the Cortex-M55
+#define __LL_TRANSP_TILE_BYTES 32
+
   // Uncomment beyond line to get runtime information about beyond SW operator's execution
   // #define DUMP_DEBUG_SW_OPS
 
   // Uncomment beyond line to dump operation results for `Pad` operator
   // #define DUMP_RESULTS_PAD_OP
 
+  // Uncomment beyond line to use the original recursive `Transpose`/`Pad` SW operators (reference implementations)
+  // #define LL_ATON_LIB_SW_OPS_REFERENCE
+
   typedef LL_Buffer_InfoTypeDef LL_LIB_TensorShape_TypeDef;
 #define LL_LIB_NBYTES(x) ((x) + 7) >> 3
 
@@ -157,6 +157,27 @@
 #define LL_ATON_OSAL_LOCK_NPU_CACHE()   aton_osal_zephyr_lock()
 #define LL_ATON_OSAL_UNLOCK_NPU_CACHE() aton_osal_zephyr_unlock()
 
+#elif (LL_ATON_OSAL == LL_ATON_OSAL_HOST_SIM)
+#include "ll_aton_osal_host_sim.h"
+
+/* Macros for (de-)initialization of OSAL layer */
+#define LL_ATON_OSAL_INIT()         host_sim_init()
+#define LL_ATON_OSAL_DEINIT()       host_sim_uninit()
+
+/* Wait for / signal event from ATON runtime */
+#define LL_ATON_OSAL_WFE()          host_sim_wfe()
+#define LL_ATON_OSAL_SIGNAL_EVENT() host_sim_post_event()
+
+#define LL_ATON_OSAL_INSTALL_IRQ(irq_aton_line_nr, handler) host_sim_install_irq(irq_aton_line_nr, handler)
+#define LL_ATON_OSAL_REMOVE_IRQ(irq_aton_line_nr)           host_sim_uninstall_irq(irq_aton_line_nr)
+#define LL_ATON_OSAL_ENABLE_IRQ(irq_aton_line_nr)           host_sim_enable_irq(irq_aton_line_nr, true)
+#define LL_ATON_OSAL_DISABLE_IRQ(irq_aton_line_nr)          host_sim_enable_irq(irq_aton_line_nr, false)
+#define LL_ATON_OSAL_ENTER_CS()                             host_sim_enter_cs()
+#define LL_ATON_OSAL_EXIT_CS()                              host_sim_exit_cs()
+
+/* Data synchronization barrier */
+#define LL_ATON_OSAL_DSB() __sync_synchronize()
+
 #elif (LL_ATON_OSAL == LL_ATON_OSAL_USER_IMPL)
 #include "ll_aton_osal_user_impl.h" /* file to be provided together with an implemetation of the custom OSAL by the user */
 
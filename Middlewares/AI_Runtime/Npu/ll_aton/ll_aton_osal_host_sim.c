@@ -0,0 +1,512 @@
+/**
+ ******************************************************************************
+ * @file    ll_aton_osal_host_sim.c
+ * @brief   ATON LL host simulation OSAL and register-level NPU stand-in
+ * @note    To be used for running the runtime on a host (e.g. Linux x86) without ATON hardware
+ ******************************************************************************
+ */
+
+#include "ll_aton_config.h"
+
+#if (LL_ATON_OSAL == LL_ATON_OSAL_HOST_SIM)
+
+#if (LL_ATON_PLATFORM != LL_ATON_PLAT_HOST_SIM)
+#error "`LL_ATON_OSAL_HOST_SIM` requires `LL_ATON_PLATFORM == LL_ATON_PLAT_HOST_SIM`"
+#endif
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "ll_aton_osal_host_sim.h"
+#include "ll_aton_platform.h"
+#include "ll_aton_util.h"
+
+#define HOST_SIM_IRQ_LINES 4
+
+typedef struct
+{
+  bool busy;         /* Enabled and not yet completed */
+  uint64_t start_ns; /* Host time of the enable */
+  uint64_t end_ns;   /* Host time of the completion */
+} host_sim_job_t;
+
+static uint32_t host_sim_regs[ATON_SIZE / sizeof(uint32_t)] __attribute__((aligned(8)));
+static bool host_sim_regs_ready = false;
+
+static host_sim_job_t host_sim_streng[ATON_STRENG_NUM];
+static host_sim_job_t host_sim_epochctrl[ATON_EPOCHCTRL_NUM];
+
+static void (*host_sim_irq_handlers[HOST_SIM_IRQ_LINES])(void);
+static bool host_sim_irq_enabled[HOST_SIM_IRQ_LINES];
+static uint32_t host_sim_cs_nesting = 0;
+static bool host_sim_event_pending = false;
+static uint32_t host_sim_idle_wfe = 0; /* Consecutive calls of `host_sim_wfe()` with nothing to wait for */
+
+static uint32_t host_sim_latency_ns[HOST_SIM_UNIT_NR] = {
+    [HOST_SIM_UNIT_STRENG] = HOST_SIM_STRENG_LATENCY_NS,
+    [HOST_SIM_UNIT_EPOCHCTRL] = HOST_SIM_EPOCHCTRL_LATENCY_NS,
+};
+static host_sim_latency_cb_t host_sim_latency_cb = NULL;
+
+static struct
+{
+  uintptr_t phys;
+  size_t size;
+  uintptr_t host;
+} host_sim_mem_regions[HOST_SIM_MAX_MEM_REGIONS];
+static uint32_t host_sim_nr_mem_regions = 0;
+
+static host_sim_stats_t host_sim_stats;
+static uint64_t host_sim_busy_until_ns = 0; /* End of the last accounted NPU busy period */
+
+/*** Helper Functions ***/
+
+static uint64_t __host_sim_now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void __host_sim_sleep_until(uint64_t deadline_ns)
+{
+  struct timespec ts = {
+      .tv_sec = (time_t)(deadline_ns / 1000000000ULL),
+      .tv_nsec = (long)(deadline_ns % 1000000000ULL),
+  };
+
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+  {
+  }
+}
+
+static inline uint32_t *__host_sim_reg(uintptr_t regaddr)
+{
+  uintptr_t offset = regaddr - (uintptr_t)host_sim_regs;
+
+  LL_ATON_ASSERT(offset < sizeof(host_sim_regs));
+  return &host_sim_regs[offset / sizeof(uint32_t)];
+}
+
+static inline bool __host_sim_ctrl_en(host_sim_unit_t unit, uint32_t ctrl)
+{
+  return (unit == HOST_SIM_UNIT_STRENG) ? ATON_STRENG_CTRL_GET_EN(ctrl) : ATON_EPOCHCTRL_CTRL_GET_EN(ctrl);
+}
+
+/* Maps a register address to the job of the unit it belongs to, if the register is its `CTRL` register */
+static host_sim_job_t *__host_sim_ctrl_to_job(uintptr_t regaddr, host_sim_unit_t *unit, uint32_t *id)
+{
+  for (uint32_t i = 0; i < ATON_STRENG_NUM; i++)
+  {
+    if (regaddr == ATON_STRENG_CTRL_ADDR(i))
+    {
+      *unit = HOST_SIM_UNIT_STRENG;
+      *id = i;
+      return &host_sim_streng[i];
+    }
+  }
+  for (uint32_t i = 0; i < ATON_EPOCHCTRL_NUM; i++)
+  {
+    if (regaddr == ATON_EPOCHCTRL_CTRL_ADDR(i))
+    {
+      *unit = HOST_SIM_UNIT_EPOCHCTRL;
+      *id = i;
+      return &host_sim_epochctrl[i];
+    }
+  }
+
+  return NULL;
+}
+
+static void __host_sim_start(host_sim_job_t *job, host_sim_unit_t unit, uint32_t id)
+{
+  uint32_t latency_ns = host_sim_latency_ns[unit];
+
+  if (host_sim_latency_cb != NULL)
+  {
+    latency_ns = host_sim_latency_cb(unit, id, latency_ns);
+  }
+
+  job->busy = true;
+  job->start_ns = __host_sim_now_ns();
+  job->end_ns = job->start_ns + latency_ns;
+}
+
+/* Raises the interrupt of a unit whose job is over */
+static void __host_sim_complete(host_sim_job_t *job, host_sim_unit_t unit, uint32_t id)
+{
+  uint32_t t;
+
+  job->busy = false;
+
+  /* Account the union of the busy periods */
+  if (job->end_ns > host_sim_busy_until_ns)
+  {
+    uint64_t from = (job->start_ns > host_sim_busy_until_ns) ? job->start_ns : host_sim_busy_until_ns;
+    host_sim_stats.npu_busy_ns += job->end_ns - from;
+    host_sim_busy_until_ns = job->end_ns;
+  }
+  host_sim_stats.nr_completions[unit]++;
+
+  if (unit == HOST_SIM_UNIT_STRENG)
+  {
+    /* Stream engine interrupts are assigned in the order of their engine number (see `ATON_STD_IRQHandler()`) */
+    t = ATON_INTCTRL_INTREG_GET(0);
+    ATON_SET_REG32(ATON_INTCTRL_INTREG_ADDR(0), t | (1U << (ATON_STRENG_INT(0) + id)));
+  }
+  else
+  {
+    t = ATON_EPOCHCTRL_IRQ_GET(id);
+    ATON_EPOCHCTRL_IRQ_SET(id, ATON_EPOCHCTRL_IRQ_SET_IRQ(t, 1));
+    t = ATON_INTCTRL_INTREG_GET(0);
+    ATON_SET_REG32(ATON_INTCTRL_INTREG_ADDR(0), t | (uint32_t)ATON_INT_GET_MASK(ATON_EPOCHCTRL_INT_MASK, id));
+  }
+}
+
+/* Returns the job completing first, `NULL` if the NPU is idle */
+static host_sim_job_t *__host_sim_next_job(host_sim_unit_t *unit, uint32_t *id)
+{
+  host_sim_job_t *next = NULL;
+
+  for (uint32_t i = 0; i < ATON_STRENG_NUM; i++)
+  {
+    if (host_sim_streng[i].busy && ((next == NULL) || (host_sim_streng[i].end_ns < next->end_ns)))
+    {
+      next = &host_sim_streng[i];
+      *unit = HOST_SIM_UNIT_STRENG;
+      *id = i;
+    }
+  }
+  for (uint32_t i = 0; i < ATON_EPOCHCTRL_NUM; i++)
+  {
+    if (host_sim_epochctrl[i].busy && ((next == NULL) || (host_sim_epochctrl[i].end_ns < next->end_ns)))
+    {
+      next = &host_sim_epochctrl[i];
+      *unit = HOST_SIM_UNIT_EPOCHCTRL;
+      *id = i;
+    }
+  }
+
+  return next;
+}
+
+/* Whether the OR-mask or the AND-mask of an interrupt line is satisfied */
+static bool __host_sim_line_pending(int line)
+{
+  if (!ATON_INTCTRL_CTRL_GET_EN(ATON_INTCTRL_CTRL_GET(0)))
+  {
+    return false;
+  }
+
+  uint32_t irqs = ATON_INTCTRL_INTREG_GET(0);
+  uint32_t or_mask = ATON_INTCTRL_INTORMSK_GET(0, line);
+  uint32_t and_mask = ATON_INTCTRL_INTANDMSK_GET(0, line);
+
+  return ((irqs & ~or_mask) != 0) || ((and_mask != 0xFFFFFFFF) && ((irqs | and_mask) == 0xFFFFFFFF));
+}
+
+/* Calls the handlers of the pending interrupt lines and emulates the write-to-clear registers */
+static bool __host_sim_deliver(void)
+{
+  bool delivered = false;
+
+  for (int line = 0; line < HOST_SIM_IRQ_LINES; line++)
+  {
+    if ((host_sim_irq_handlers[line] == NULL) || !host_sim_irq_enabled[line] || !__host_sim_line_pending(line))
+    {
+      continue;
+    }
+
+    ATON_INTCTRL_INTCLR_SET(0, 0);
+    host_sim_irq_handlers[line]();
+    host_sim_stats.nr_irqs++;
+    delivered = true;
+
+    uint32_t cleared = ATON_INTCTRL_INTCLR_GET(0);
+    ATON_SET_REG32(ATON_INTCTRL_INTREG_ADDR(0), ATON_INTCTRL_INTREG_GET(0) & ~cleared);
+    ATON_INTCTRL_INTCLR_SET(0, 0);
+    for (uint32_t i = 0; i < ATON_EPOCHCTRL_NUM; i++)
+    {
+      if (cleared & (uint32_t)ATON_INT_GET_MASK(ATON_EPOCHCTRL_INT_MASK, i))
+      {
+        ATON_EPOCHCTRL_IRQ_SET(i, 0);
+      }
+    }
+  }
+
+  return delivered;
+}
+
+/*** Register-level stand-in ***/
+
+uintptr_t host_sim_get_aton_base(void)
+{
+  if (!host_sim_regs_ready)
+  {
+    host_sim_regs_ready = true;
+    memset(host_sim_regs, 0, sizeof(host_sim_regs));
+
+    /* `LL_ATON_Init()` checks the versions of the units against `ATON.h` */
+#define HOST_SIM_PRESET_VERSION(unitname, val)                                                                         \
+  do                                                                                                                   \
+  {                                                                                                                    \
+    for (uint32_t i = 0; i < ATON_##unitname##_NUM; i++)                                                               \
+    {                                                                                                                  \
+      ATON_SET_REG32(ATON_##unitname##_VERSION_ADDR(i), (val));                                                        \
+    }                                                                                                                  \
+  } while (0)
+
+    HOST_SIM_PRESET_VERSION(CLKCTRL, ATON_CLKCTRL_VERSION_DT);
+    HOST_SIM_PRESET_VERSION(INTCTRL, ATON_INTCTRL_VERSION_DT);
+    HOST_SIM_PRESET_VERSION(STRSWITCH, ATON_STRSWITCH_VERSION_DT);
+    HOST_SIM_PRESET_VERSION(BUSIF, ATON_BUSIF_VERSION_DT(i));
+    HOST_SIM_PRESET_VERSION(STRENG, ATON_STRENG_VERSION_DT);
+#ifdef ATON_CONVACC_NUM
+    HOST_SIM_PRESET_VERSION(CONVACC, ATON_CONVACC_VERSION_DT);
+#endif
+#ifdef ATON_POOL_NUM
+    HOST_SIM_PRESET_VERSION(POOL, ATON_POOL_VERSION_DT);
+#endif
+#ifdef ATON_ARITH_NUM
+    HOST_SIM_PRESET_VERSION(ARITH, ATON_ARITH_VERSION_DT);
+#endif
+#ifdef ATON_ACTIV_NUM
+    HOST_SIM_PRESET_VERSION(ACTIV, ATON_ACTIV_VERSION_DT);
+#endif
+#ifdef ATON_DECUN_NUM
+    HOST_SIM_PRESET_VERSION(DECUN, ATON_DECUN_VERSION_DT);
+#endif
+#ifdef ATON_EPOCHCTRL_VERSION_TYPE_DT
+    HOST_SIM_PRESET_VERSION(EPOCHCTRL, ATON_EPOCHCTRL_VERSION_DT);
+#endif
+#ifdef ATON_RECBUF_VERSION_TYPE_DT
+    HOST_SIM_PRESET_VERSION(RECBUF, ATON_RECBUF_VERSION_DT);
+#endif
+
+#undef HOST_SIM_PRESET_VERSION
+  }
+
+  return (uintptr_t)host_sim_regs;
+}
+
+void host_sim_reg_write_field(uintptr_t regaddr, uint32_t lsb, uint32_t width, uint32_t val)
+{
+  uint32_t *reg = __host_sim_reg(regaddr);
+  uint32_t was = *reg;
+  host_sim_unit_t unit;
+  uint32_t id;
+
+  *reg = ATON_SET_FIELD(was, lsb, width, val);
+
+  /* Rising edge of `CTRL.EN` of a stream engine or an epoch controller starts a job */
+  host_sim_job_t *job = __host_sim_ctrl_to_job(regaddr, &unit, &id);
+  if ((job != NULL) && !__host_sim_ctrl_en(unit, was) && __host_sim_ctrl_en(unit, *reg))
+  {
+    __host_sim_start(job, unit, id);
+  }
+}
+
+void host_sim_reg_poll(uintptr_t regaddr, uint32_t lsb, uint32_t width, uint32_t val)
+{
+  uint32_t *reg = __host_sim_reg(regaddr);
+  host_sim_unit_t unit;
+  uint32_t id;
+
+  if (ATON_GET_FIELD(*reg, lsb, width) == val)
+  {
+    return;
+  }
+
+  /* The only fields polled by the runtime are self-clearing ones (`CLR`, `CONFCLR`): the stand-in acknowledges them
+   * at once */
+  *reg = ATON_SET_FIELD(*reg, lsb, width, val);
+
+  /* Clearing a unit aborts its job */
+  host_sim_job_t *job = __host_sim_ctrl_to_job(regaddr, &unit, &id);
+  if ((job != NULL) && !__host_sim_ctrl_en(unit, *reg))
+  {
+    job->busy = false;
+  }
+
+  /* Clearing the interrupt controller drops all pending interrupts */
+  if (regaddr == ATON_INTCTRL_CTRL_ADDR(0))
+  {
+    ATON_SET_REG32(ATON_INTCTRL_INTREG_ADDR(0), 0);
+  }
+}
+
+uintptr_t host_sim_phys_to_virt(uintptr_t addr)
+{
+  for (uint32_t i = 0; i < host_sim_nr_mem_regions; i++)
+  {
+    if ((addr >= host_sim_mem_regions[i].phys) && (addr - host_sim_mem_regions[i].phys < host_sim_mem_regions[i].size))
+    {
+      return host_sim_mem_regions[i].host + (addr - host_sim_mem_regions[i].phys);
+    }
+  }
+
+  return addr;
+}
+
+uintptr_t host_sim_virt_to_phys(uintptr_t addr)
+{
+  for (uint32_t i = 0; i < host_sim_nr_mem_regions; i++)
+  {
+    if ((addr >= host_sim_mem_regions[i].host) && (addr - host_sim_mem_regions[i].host < host_sim_mem_regions[i].size))
+    {
+      return host_sim_mem_regions[i].phys + (addr - host_sim_mem_regions[i].host);
+    }
+  }
+
+  return addr;
+}
+
+int host_sim_add_mem_region(uintptr_t phys, size_t size, void *host)
+{
+  if (host_sim_nr_mem_regions >= HOST_SIM_MAX_MEM_REGIONS)
+  {
+    return -1;
+  }
+
+  host_sim_mem_regions[host_sim_nr_mem_regions].phys = phys;
+  host_sim_mem_regions[host_sim_nr_mem_regions].size = size;
+  host_sim_mem_regions[host_sim_nr_mem_regions].host = (uintptr_t)host;
+  host_sim_nr_mem_regions++;
+
+  return 0;
+}
+
+void host_sim_set_latency(host_sim_unit_t unit, uint32_t latency_ns)
+{
+  LL_ATON_ASSERT(unit < HOST_SIM_UNIT_NR);
+  host_sim_latency_ns[unit] = latency_ns;
+}
+
+void host_sim_set_latency_cb(host_sim_latency_cb_t cb)
+{
+  host_sim_latency_cb = cb;
+}
+
+void host_sim_get_stats(host_sim_stats_t *stats)
+{
+  *stats = host_sim_stats;
+}
+
+void host_sim_reset_stats(void)
+{
+  memset(&host_sim_stats, 0, sizeof(host_sim_stats));
+  host_sim_busy_until_ns = 0;
+}
+
+uint32_t host_sim_get_ts(void)
+{
+  return (uint32_t)__host_sim_now_ns();
+}
+
+/*** OSAL ***/
+
+int host_sim_init(void)
+{
+  memset(host_sim_streng, 0, sizeof(host_sim_streng));
+  memset(host_sim_epochctrl, 0, sizeof(host_sim_epochctrl));
+  host_sim_cs_nesting = 0;
+  host_sim_event_pending = false;
+  host_sim_idle_wfe = 0;
+
+  return 0;
+}
+
+int host_sim_uninit(void)
+{
+  for (int line = 0; line < HOST_SIM_IRQ_LINES; line++)
+  {
+    host_sim_irq_handlers[line] = NULL;
+    host_sim_irq_enabled[line] = false;
+  }
+
+  return 0;
+}
+
+int host_sim_install_irq(int irq_aton_line_nr, void (*handler)(void))
+{
+  LL_ATON_ASSERT((irq_aton_line_nr >= 0) && (irq_aton_line_nr < HOST_SIM_IRQ_LINES));
+  host_sim_irq_handlers[irq_aton_line_nr] = handler;
+  return 0;
+}
+
+int host_sim_uninstall_irq(int irq_aton_line_nr)
+{
+  return host_sim_install_irq(irq_aton_line_nr, NULL);
+}
+
+int host_sim_enable_irq(int irq_aton_line_nr, bool enable)
+{
+  LL_ATON_ASSERT((irq_aton_line_nr >= 0) && (irq_aton_line_nr < HOST_SIM_IRQ_LINES));
+  host_sim_irq_enabled[irq_aton_line_nr] = enable;
+  return 0;
+}
+
+/* Interrupts are only delivered from here: the runtime never waits from within a critical section */
+int host_sim_wfe(void)
+{
+  host_sim_unit_t unit;
+  uint32_t id;
+
+  LL_ATON_ASSERT(host_sim_cs_nesting == 0);
+
+  if (host_sim_event_pending)
+  {
+    host_sim_event_pending = false;
+    return 0;
+  }
+
+  while (!__host_sim_deliver())
+  {
+    host_sim_job_t *job = __host_sim_next_job(&unit, &id);
+
+    if (job == NULL)
+    {
+      /* Nothing may ever complete: return like a spurious wake-up, but do not let a CI run hang */
+      host_sim_stats.nr_idle_wfe++;
+      if (++host_sim_idle_wfe >= HOST_SIM_MAX_IDLE_WFE)
+      {
+        LL_ATON_PRINTF("host_sim_wfe(): no busy unit and no pending interrupt (INTREG=0x%08" PRIx32 ")\n",
+                       ATON_INTCTRL_INTREG_GET(0));
+        LL_ATON_ASSERT(false);
+      }
+      return 0;
+    }
+
+    __host_sim_sleep_until(job->end_ns);
+    __host_sim_complete(job, unit, id);
+  }
+
+  host_sim_idle_wfe = 0;
+  return 0;
+}
+
+int host_sim_enter_cs(void)
+{
+  host_sim_cs_nesting++;
+  return 0;
+}
+
+int host_sim_exit_cs(void)
+{
+  LL_ATON_ASSERT(host_sim_cs_nesting > 0);
+  host_sim_cs_nesting--;
+  return 0;
+}
+
+int host_sim_post_event(void)
+{
+  host_sim_event_pending = true;
+  return 0;
+}
+
+#endif // (LL_ATON_OSAL == LL_ATON_OSAL_HOST_SIM)
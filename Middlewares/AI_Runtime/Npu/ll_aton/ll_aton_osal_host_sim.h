@@ -0,0 +1,126 @@
+/**
+ ******************************************************************************
+ * @file    ll_aton_osal_host_sim.h
+ * @brief   Interface to the host simulation OSAL and its register-level NPU stand-in
+ * @note    To be used with `LL_ATON_PLATFORM == LL_ATON_PLAT_HOST_SIM` and `LL_ATON_OSAL == LL_ATON_OSAL_HOST_SIM`
+ *          for running the ATON runtime natively on a host (e.g. Linux x86) without any ATON hardware
+ ******************************************************************************
+ *
+ * The ATON register file is plain host memory. Stream engines and epoch controllers enabled by the runtime are
+ * considered busy for a modelled latency, after which they raise their interrupt in the interrupt controller.
+ * `host_sim_wfe()` sleeps until the next completion and calls the installed interrupt handler once the masks of the
+ * interrupt line are satisfied, so that `LL_ATON_RT_RunEpochBlock()`, the epoch callbacks and the SW fallback
+ * operators execute as on target.
+ *
+ * The NPU does not compute anything: the outputs of HW epochs and epoch blobs are left untouched.
+ * The memory pools of the network must be backed by host memory with `host_sim_add_mem_region()`.
+ ******************************************************************************
+ */
+
+#ifndef __LL_ATON_OSAL_HOST_SIM_H
+#define __LL_ATON_OSAL_HOST_SIM_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Default modelled latencies in nanoseconds */
+#ifndef HOST_SIM_STRENG_LATENCY_NS
+#define HOST_SIM_STRENG_LATENCY_NS 20000
+#endif
+
+#ifndef HOST_SIM_EPOCHCTRL_LATENCY_NS
+#define HOST_SIM_EPOCHCTRL_LATENCY_NS 500000
+#endif
+
+/* Consecutive calls of `host_sim_wfe()` with nothing to wait for after which the simulation is aborted */
+#ifndef HOST_SIM_MAX_IDLE_WFE
+#define HOST_SIM_MAX_IDLE_WFE 1000
+#endif
+
+/* Maximum number of host memory regions */
+#ifndef HOST_SIM_MAX_MEM_REGIONS
+#define HOST_SIM_MAX_MEM_REGIONS 8
+#endif
+
+  typedef enum
+  {
+    HOST_SIM_UNIT_STRENG = 0,
+    HOST_SIM_UNIT_EPOCHCTRL,
+    HOST_SIM_UNIT_NR,
+  } host_sim_unit_t;
+
+  /**
+   * @brief Returns the modelled latency of a unit which has just been enabled
+   * @param unit       Kind of unit
+   * @param id         Unit instance
+   * @param latency_ns Default latency of this kind of unit (see `host_sim_set_latency()`)
+   * @retval Latency in nanoseconds
+   */
+  typedef uint32_t (*host_sim_latency_cb_t)(host_sim_unit_t unit, uint32_t id, uint32_t latency_ns);
+
+  typedef struct
+  {
+    uint64_t npu_busy_ns;                      /**< Time during which at least one unit was busy */
+    uint32_t nr_completions[HOST_SIM_UNIT_NR]; /**< Completed jobs per kind of unit */
+    uint32_t nr_irqs;                          /**< Calls of the installed interrupt handler(s) */
+    uint32_t nr_idle_wfe;                      /**< Calls of `host_sim_wfe()` with no busy unit and no pending IRQ */
+  } host_sim_stats_t;
+
+  /* OSAL */
+  int host_sim_init(void);
+  int host_sim_uninit(void);
+  int host_sim_install_irq(int irq_aton_line_nr, void (*handler)(void));
+  int host_sim_uninstall_irq(int irq_aton_line_nr);
+  int host_sim_enable_irq(int irq_aton_line_nr, bool enable);
+  int host_sim_wfe(void);
+  int host_sim_enter_cs(void);
+  int host_sim_exit_cs(void);
+  int host_sim_post_event(void);
+
+  /* Register-level stand-in (used by `ll_aton_platform.h`) */
+  uintptr_t host_sim_get_aton_base(void);
+  void host_sim_reg_write_field(uintptr_t regaddr, uint32_t lsb, uint32_t width, uint32_t val);
+  void host_sim_reg_poll(uintptr_t regaddr, uint32_t lsb, uint32_t width, uint32_t val);
+  uintptr_t host_sim_phys_to_virt(uintptr_t addr);
+  uintptr_t host_sim_virt_to_phys(uintptr_t addr);
+
+  /**
+   * @brief Backs a range of target addresses (e.g. a memory pool of the network) with host memory
+   * @param phys Start of the range on target
+   * @param size Size in bytes of the range
+   * @param host Host memory of at least `size` bytes
+   * @retval 0 on success, -1 if there are already `HOST_SIM_MAX_MEM_REGIONS` regions
+   */
+  int host_sim_add_mem_region(uintptr_t phys, size_t size, void *host);
+
+  /**
+   * @brief Sets the modelled latency of a kind of unit, e.g. from the `LL_ATON_RT_Callbacktype_PRE_START` epoch
+   *        callback to model each epoch block individually
+   */
+  void host_sim_set_latency(host_sim_unit_t unit, uint32_t latency_ns);
+
+  /**
+   * @brief Installs a callback computing the latency of each unit when it is enabled (`NULL` to remove it)
+   */
+  void host_sim_set_latency_cb(host_sim_latency_cb_t cb);
+
+  void host_sim_get_stats(host_sim_stats_t *stats);
+  void host_sim_reset_stats(void);
+
+  /**
+   * @brief Returns the host monotonic time in nanoseconds (wraps around), default timestamp source of the resident
+   *        network counters on this platform
+   */
+  uint32_t host_sim_get_ts(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //__LL_ATON_OSAL_HOST_SIM_H
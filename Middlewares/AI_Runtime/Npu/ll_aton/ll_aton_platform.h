@@ -243,6 +243,37 @@ void complete_dmas(void);
                     ec_trace_get_REG_id(ATON_##unitname##_##reg##_OFFSET), ATON_##unitname##_##reg##_##field##_LSB,    \
                     ATON_##unitname##_##reg##_##field##_W, (uint32_t)val)
 
+/* Host (e.g. Linux x86) simulation platform with a register-level NPU stand-in (see `ll_aton_osal_host_sim.h`) */
+#elif (LL_ATON_PLATFORM == LL_ATON_PLAT_HOST_SIM)
+#include "ll_aton_osal_host_sim.h"
+
+#define ATON_PLAT_HAS_FFLUSH (1)
+
+#define ATON_BASE (host_sim_get_aton_base())
+
+#define __DSB()
+#define NVIC_EnableIRQ(x)
+#define NVIC_DisableIRQ(x)
+#define CDNN0_IRQn         (0)
+#define CDNN1_IRQn         (1)
+#define CDNN2_IRQn         (2)
+#define CDNN3_IRQn         (3)
+#define ATON_EPOCH_TIMEOUT (ATON_EPOCH_TIMEOUT_MS * 1000)
+
+/* Memory pools of the network live in host memory */
+#define ATON_LIB_PHYSICAL_TO_VIRTUAL_ADDR(address)                                                                     \
+  ((__typeof__(address))host_sim_phys_to_virt((uintptr_t)(address)))
+#define ATON_LIB_VIRTUAL_TO_PHYSICAL_ADDR(address)                                                                     \
+  ((__typeof__(address))host_sim_virt_to_phys((uintptr_t)(address)))
+
+/* Let the stand-in see units being enabled and acknowledge the self-clearing fields */
+#define ATON_REG_WRITE_FIELD(unitname, id, reg, field, val)                                                            \
+  host_sim_reg_write_field(ATON_##unitname##_##reg##_ADDR(id), ATON_##unitname##_##reg##_##field##_LSB,                \
+                           ATON_##unitname##_##reg##_##field##_W, (uint32_t)(val))
+#define ATON_REG_POLL(unitname, id, reg, field, val)                                                                   \
+  host_sim_reg_poll(ATON_##unitname##_##reg##_ADDR(id), ATON_##unitname##_##reg##_##field##_LSB,                       \
+                    ATON_##unitname##_##reg##_##field##_W, (uint32_t)(val))
+
 #elif (LL_ATON_PLATFORM == LL_ATON_PLAT_CENTAURI)
 #define ATON_BASE             0xA0000000
 #define SYSMEM1_BASE          0xA0080000
@@ -52,8 +52,8 @@
   } while (0)
 #endif
 
-#if !defined(LL_ATON_PLATFORM) || (LL_ATON_PLATFORM != LL_ATON_PLAT_STM32N6)
-#error "Model Relocatable mode is only supported for LL_ATON_PLAT_STM32N6 platform"
+#if !defined(LL_ATON_PLATFORM) || ((LL_ATON_PLATFORM != LL_ATON_PLAT_STM32N6) && (LL_ATON_PLATFORM != LL_ATON_PLAT_HOST_SIM))
+#error "Model Relocatable mode is only supported for LL_ATON_PLAT_STM32N6 platform (and LL_ATON_PLAT_HOST_SIM)"
 #if !defined(STM32N6)
 #error "STM32N6 should be defined"
 #endif
@@ -254,7 +254,30 @@ struct ai_reloc_bin_hdr
  *
  */
 
-#if defined(__GNUC__) && !defined(__ARMCC_VERSION) /* GNU compiler */
+#if (LL_ATON_PLATFORM == LL_ATON_PLAT_HOST_SIM)
+
+/*
+ * Host simulation: the text section of the binary holds, at each entry point, the address of the host
+ * function standing for it. R9 is emulated by `ai_reloc_host_sim_r9`.
+ */
+uintptr_t ai_reloc_host_sim_r9;
+
+typedef uintptr_t (*ai_reloc_host_sim_entry)(uintptr_t arg1, uintptr_t arg2, uintptr_t arg3);
+
+static uintptr_t call_with_r9(const void *base, uint32_t offset, void *data, uintptr_t arg1, uintptr_t arg2,
+                              uintptr_t arg3)
+{
+  const ai_reloc_host_sim_entry entry = *(const ai_reloc_host_sim_entry *)((uintptr_t)base + offset);
+  const uintptr_t saved_r9 = ai_reloc_host_sim_r9;
+
+  ai_reloc_host_sim_r9 = (uintptr_t)data;
+  uintptr_t res = entry(arg1, arg2, arg3);
+  ai_reloc_host_sim_r9 = saved_r9;
+
+  return res;
+}
+
+#elif defined(__GNUC__) && !defined(__ARMCC_VERSION) /* GNU compiler */
 
 static uintptr_t __attribute__((naked))
 call_with_r9(const void *base, uint32_t offset, void *data, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3)
@@ -364,8 +387,14 @@ static uint32_t _npu_reloc_requested_ram_size(const uintptr_t file_ptr, uint32_t
     return rw_sz + ro_sz;
 }
 
+#if (LL_ATON_PLATFORM == LL_ATON_PLAT_HOST_SIM)
+/* The host stands for the Cortex-M55 of the STM32N6, FPU enabled */
+#define _CPUID (AI_RELOC_ARM_CORTEX_M55 << 4)
+#define _CPACR (0xF << 20)
+#else
 #define _CPUID *(volatile uint32_t *)(0xE000ED00)
 #define _CPACR *(volatile uint32_t *)(0xE000ED88)
+#endif
 
 #define _CPUID_PART_NUMBER (0xFFF << 4) /* Part Number */
 #define _CPACR_CPx         (0xF << 20)  /* CP1 & CP0 bits */
@@ -489,7 +518,7 @@ static int _ai_reloc_prepare_mpools(const uintptr_t file_ptr, struct id_mpool_ma
   ll_aton_reloc_mem_pool_desc *cur_mem_c_desc;
 
   /* Set/check base param addr - user addr is used in priority */
-  if ((id_map->addr_0 == NULL) && (header->sect.params_offset == 0))
+  if ((id_map->addr_0 == 0) && (header->sect.params_offset == 0))
     return AI_RELOC_RT_ERR_PARAM_ADDR;
 
   if (id_map->addr_0 == 0)
@@ -979,6 +1008,26 @@ int ll_aton_reloc_install(const uintptr_t file_ptr, const ll_aton_reloc_config *
   return res;
 }
 
+/*
+ * Restore the memory pools of an already installed model (COPY/RESET pools and the external RAM pool)
+ * which may have been overwritten by another model sharing the same memories. The relocated code/data
+ * kept in the exec memory region are left untouched, no relocation is done again.
+ */
+int ll_aton_reloc_reload_mpools(const uintptr_t file_ptr, const ll_aton_reloc_config *config)
+{
+  const struct ai_reloc_bin_hdr *rom_addr = (struct ai_reloc_bin_hdr *)file_ptr;
+
+  if (!rom_addr || (rom_addr->hdr.magic != AI_RELOC_MAGIC))
+    return AI_RELOC_RT_ERR_INVALID_BIN;
+
+  if (!config)
+    return AI_RELOC_RT_ERR_ARG;
+
+  struct id_mpool_mapping id_map = {config->ext_param_addr, 0, config->ext_ram_addr, config->ext_ram_size};
+
+  return _ai_reloc_prepare_mpools(file_ptr, &id_map, config->mode);
+}
+
 int ll_aton_reloc_set_callbacks(const NN_Instance_TypeDef *nn_instance, const struct ll_aton_reloc_callback *cbs)
 {
   if (!nn_instance || !cbs || !nn_instance->exec_state.inst_reloc)
@@ -1170,12 +1219,19 @@ const LL_Buffer_InfoTypeDef *ai_rel_network_get_internal_buffers_info(uintptr_t
 
 void ai_rel_call_start_end_function(uintptr_t inst, start_end_func_ptr fct, const void *epoch_block)
 {
+#if (LL_ATON_PLATFORM == LL_ATON_PLAT_HOST_SIM)
+  const uintptr_t saved_r9 = ai_reloc_host_sim_r9;
+  ai_reloc_host_sim_r9 = ((struct ai_reloc_rt_ctx *)inst)->ram_addr;
+  (*(const start_end_func_ptr *)(uintptr_t)fct)(epoch_block);
+  ai_reloc_host_sim_r9 = saved_r9;
+#else
   register uint32_t _saved_r9;
   register uint32_t _r9 = ((struct ai_reloc_rt_ctx *)inst)->ram_addr;
   __asm volatile("mov %0, r9\n\t" : "=r"(_saved_r9));
   __asm volatile("mov r9, %0\n\t" ::"r"(_r9));
   fct(epoch_block);
   __asm volatile("mov r9, %0\n\t" ::"r"(_saved_r9));
+#endif
 }
 
 int ll_aton_reloc_get_file_ptr(const NN_Instance_TypeDef *nn_inst, uintptr_t *file_ptr)
@@ -286,6 +286,7 @@ extern "C"
 
   int ll_aton_reloc_install(const uintptr_t file_ptr, const ll_aton_reloc_config *config,
                             NN_Instance_TypeDef *nn_instance);
+  int ll_aton_reloc_reload_mpools(const uintptr_t file_ptr, const ll_aton_reloc_config *config);
 
   int ll_aton_reloc_is_valid(const NN_Instance_TypeDef *nn_instance);
   int ll_aton_reloc_get_file_ptr(const NN_Instance_TypeDef *nn_instance, uintptr_t *file_ptr);
@@ -329,6 +330,11 @@ extern "C"
 
   void ai_rel_call_start_end_function(uintptr_t inst, start_end_func_ptr fct, const void *epoch_block);
 
+#if (LL_ATON_PLATFORM == LL_ATON_PLAT_HOST_SIM)
+  /* Host simulation: base address of the relocated data of the model being called (R9 on target) */
+  extern uintptr_t ai_reloc_host_sim_r9;
+#endif
+
 #if defined(BUILD_AI_NETWORK_RELOC)
 
   /* -----------------------------------------------------------------------------
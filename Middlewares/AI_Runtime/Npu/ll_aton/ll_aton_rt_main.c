@@ -21,9 +21,16 @@
  ******************************************************************************
  */
 
+#include <inttypes.h>
+#include <string.h>
+
 #include "ll_aton_runtime.h"
 #include "ll_aton_util.h"
 
+#if defined(LL_ATON_RT_EB_OVERLAP)
+#include "ll_aton_eb_deps.h"
+#endif
+
 /*** Main Template ***/
 
 /**
@@ -72,3 +79,439 @@ void LL_ATON_RT_Main(NN_Instance_TypeDef *network_instance)
 
   /*** End of user de-initialization code ***/
 }
+
+/*** Resident Network ***/
+
+/* Timestamp source of the resident network counters, may be overridden by the application */
+#ifndef LL_ATON_RT_RESIDENT_GET_TS
+#if (LL_ATON_PLATFORM == LL_ATON_PLAT_STM32N6)
+#define LL_ATON_RT_RESIDENT_GET_TS() (DWT->CYCCNT)
+#elif (LL_ATON_PLATFORM == LL_ATON_PLAT_HOST_SIM)
+#define LL_ATON_RT_RESIDENT_GET_TS() (host_sim_get_ts())
+#else
+#define LL_ATON_RT_RESIDENT_GET_TS() (0U)
+#endif
+#endif // LL_ATON_RT_RESIDENT_GET_TS
+
+static uint32_t ll_aton_rt_resident_refcount = 0;
+
+static void __ll_aton_rt_resident_ts_init(void)
+{
+#if (LL_ATON_PLATFORM == LL_ATON_PLAT_STM32N6)
+  DCB->DEMCR |= DCB_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+void LL_ATON_RT_Resident_ResetStats(LL_ATON_RT_Resident_TypeDef *resident)
+{
+  LL_ATON_ASSERT(resident != NULL);
+
+  uint32_t init_ticks = resident->stats.init_ticks;
+
+  memset(&resident->stats, 0, sizeof(resident->stats));
+  resident->stats.init_ticks = init_ticks;
+  resident->stats.min_inference_ticks = UINT32_MAX;
+}
+
+void LL_ATON_RT_Resident_Init(LL_ATON_RT_Resident_TypeDef *resident, NN_Instance_TypeDef *nn_instance)
+{
+  uint32_t ts;
+
+  LL_ATON_ASSERT(resident != NULL);
+  LL_ATON_ASSERT(nn_instance != NULL);
+  LL_ATON_ASSERT(nn_instance->network != NULL);
+
+  __ll_aton_rt_resident_ts_init();
+  ts = LL_ATON_RT_RESIDENT_GET_TS();
+
+  if (ll_aton_rt_resident_refcount++ == 0)
+  {
+    LL_ATON_RT_RuntimeInit(); // Initialize runtime once for all resident networks
+  }
+  LL_ATON_RT_Init_Network(nn_instance); // Initialize passed network instance object once
+
+  resident->nn_instance = nn_instance;
+  resident->running = false;
+  resident->start_ts = 0;
+  resident->stats.init_ticks = LL_ATON_RT_RESIDENT_GET_TS() - ts;
+  LL_ATON_RT_Resident_ResetStats(resident);
+}
+
+void LL_ATON_RT_Resident_DeInit(LL_ATON_RT_Resident_TypeDef *resident)
+{
+  LL_ATON_ASSERT(resident != NULL);
+  LL_ATON_ASSERT(resident->nn_instance != NULL);
+  LL_ATON_ASSERT(!resident->running);
+  LL_ATON_ASSERT(ll_aton_rt_resident_refcount > 0);
+
+  LL_ATON_RT_DeInit_Network(resident->nn_instance);
+  resident->nn_instance = NULL;
+
+  if (--ll_aton_rt_resident_refcount == 0)
+  {
+    LL_ATON_RT_RuntimeDeInit();
+  }
+}
+
+LL_ATON_RT_RetValues_t LL_ATON_RT_Resident_RunEpochBlock(LL_ATON_RT_Resident_TypeDef *resident)
+{
+  LL_ATON_RT_RetValues_t ll_aton_rt_ret;
+  uint32_t ts;
+
+  LL_ATON_ASSERT(resident != NULL);
+  LL_ATON_ASSERT(resident->nn_instance != NULL);
+
+  if (!resident->running)
+  {
+    resident->start_ts = LL_ATON_RT_RESIDENT_GET_TS();
+    resident->running = true;
+  }
+
+  ll_aton_rt_ret = LL_ATON_RT_RunEpochBlock(resident->nn_instance);
+  if (ll_aton_rt_ret != LL_ATON_RT_DONE)
+  {
+    return ll_aton_rt_ret;
+  }
+
+  ts = LL_ATON_RT_RESIDENT_GET_TS();
+  resident->running = false;
+  resident->stats.nr_inferences++;
+  resident->stats.last_inference_ticks = ts - resident->start_ts;
+  resident->stats.total_inference_ticks += resident->stats.last_inference_ticks;
+  if (resident->stats.last_inference_ticks < resident->stats.min_inference_ticks)
+  {
+    resident->stats.min_inference_ticks = resident->stats.last_inference_ticks;
+  }
+  if (resident->stats.last_inference_ticks > resident->stats.max_inference_ticks)
+  {
+    resident->stats.max_inference_ticks = resident->stats.last_inference_ticks;
+  }
+
+  /* Re-arm the instance for the next inference instead of a full de-init/init cycle */
+  LL_ATON_RT_Reset_Network(resident->nn_instance);
+  resident->stats.last_rearm_ticks = LL_ATON_RT_RESIDENT_GET_TS() - ts;
+
+  return ll_aton_rt_ret;
+}
+
+void LL_ATON_RT_Resident_Run(LL_ATON_RT_Resident_TypeDef *resident)
+{
+  LL_ATON_RT_RetValues_t ll_aton_rt_ret;
+
+  do
+  {
+    ll_aton_rt_ret = LL_ATON_RT_Resident_RunEpochBlock(resident);
+
+    if (ll_aton_rt_ret == LL_ATON_RT_WFE)
+    {
+      LL_ATON_OSAL_WFE();
+    }
+  } while (ll_aton_rt_ret != LL_ATON_RT_DONE);
+}
+
+/*** Multi-Network Scheduler ***/
+
+/* Account the time elapsed since the last call, as busy if an instance owned the NPU meanwhile */
+static void __ll_aton_rt_sched_account(LL_ATON_RT_Sched_TypeDef *sched)
+{
+  extern NN_Instance_TypeDef *volatile __ll_current_aton_ip_owner;
+  uint32_t ts = LL_ATON_RT_RESIDENT_GET_TS();
+  uint32_t delta = ts - sched->last_ts;
+
+  sched->elapsed_ticks += delta;
+  if (sched->npu_owned)
+  {
+    sched->npu_busy_ticks += delta;
+  }
+  sched->last_ts = ts;
+  sched->npu_owned = (__ll_current_aton_ip_owner != NULL);
+}
+
+/* The next call of `LL_ATON_RT_RunEpochBlock()` for this instance neither accesses nor takes the NPU */
+static bool __ll_aton_rt_sched_is_sw_step(NN_Instance_TypeDef *nn_instance)
+{
+  const LL_ATON_RT_EpochBlockItem_t *eb = nn_instance->exec_state.current_epoch_block;
+
+  if (nn_instance->exec_state.current_epoch_block_started)
+  {
+    return false;
+  }
+  if (EpochBlock_IsLastEpochBlock(eb))
+  {
+    return nn_instance->exec_state.saved_current_epoch_block == NULL;
+  }
+  if (!EpochBlock_IsEpochPureSW(eb))
+  {
+    return false;
+  }
+#if defined(LL_ATON_RT_EB_OVERLAP)
+  /* the blob following the SW block would be started along with it */
+  if ((nn_instance->exec_state.epoch_block_deps != NULL) &&
+      (nn_instance->exec_state.saved_current_epoch_block == NULL) &&
+      LL_ATON_EbDeps_CanOverlapNext(nn_instance->exec_state.first_epoch_block,
+                                    nn_instance->exec_state.epoch_block_deps,
+                                    __LL_ATON_RT_GetCurrEpochBlockIndex(nn_instance)))
+  {
+    return false;
+  }
+#endif // LL_ATON_RT_EB_OVERLAP
+  return true;
+}
+
+/* Task `a` is more urgent than task `b` */
+static bool __ll_aton_rt_sched_is_before(const LL_ATON_RT_SchedTask_TypeDef *a, const LL_ATON_RT_SchedTask_TypeDef *b)
+{
+  if (a->priority != b->priority)
+  {
+    return a->priority > b->priority;
+  }
+  if ((a->deadline_ticks != 0) && (b->deadline_ticks != 0))
+  {
+    /* earliest absolute deadline first (wrap-around safe) */
+    return (int32_t)((a->release_ts + a->deadline_ticks) - (b->release_ts + b->deadline_ticks)) < 0;
+  }
+  return (a->deadline_ticks != 0) && (b->deadline_ticks == 0);
+}
+
+void LL_ATON_RT_Sched_Init(LL_ATON_RT_Sched_TypeDef *sched)
+{
+  LL_ATON_ASSERT(sched != NULL);
+
+  memset(sched, 0, sizeof(*sched));
+  __ll_aton_rt_resident_ts_init();
+  sched->last_ts = LL_ATON_RT_RESIDENT_GET_TS();
+}
+
+#ifndef NDEBUG
+/* Returns `true` if a buffer written by the network (not a parameter) of list `a` shares a byte with one of `b` */
+static bool __ll_aton_rt_sched_buffers_overlap(const LL_Buffer_InfoTypeDef *a, const LL_Buffer_InfoTypeDef *b)
+{
+  if ((a == NULL) || (b == NULL))
+  {
+    return false;
+  }
+
+  for (; a->name != NULL; a++)
+  {
+    if (a->is_param)
+    {
+      continue;
+    }
+    for (const LL_Buffer_InfoTypeDef *other = b; other->name != NULL; other++)
+    {
+      if (!other->is_param && (LL_Buffer_addr_start(a) < LL_Buffer_addr_end(other)) &&
+          (LL_Buffer_addr_start(other) < LL_Buffer_addr_end(a)))
+      {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+/* The SW epoch blocks of one instance may run while the NPU works for another one: their activation pools (and
+ * inputs/outputs) may not overlap */
+static bool __ll_aton_rt_sched_pools_disjoint(const NN_Instance_TypeDef *a, const NN_Instance_TypeDef *b)
+{
+  const NN_Interface_TypeDef *nn_a = a->network;
+  const NN_Interface_TypeDef *nn_b = b->network;
+  const LL_Buffer_InfoTypeDef *buffers_a[3] = {
+      nn_a->internal_buffers_info ? nn_a->internal_buffers_info() : NULL,
+      nn_a->input_buffers_info ? nn_a->input_buffers_info() : NULL,
+      nn_a->output_buffers_info ? nn_a->output_buffers_info() : NULL,
+  };
+  const LL_Buffer_InfoTypeDef *buffers_b[3] = {
+      nn_b->internal_buffers_info ? nn_b->internal_buffers_info() : NULL,
+      nn_b->input_buffers_info ? nn_b->input_buffers_info() : NULL,
+      nn_b->output_buffers_info ? nn_b->output_buffers_info() : NULL,
+  };
+
+  for (uint32_t i = 0; i < 3; i++)
+  {
+    for (uint32_t j = 0; j < 3; j++)
+    {
+      if (__ll_aton_rt_sched_buffers_overlap(buffers_a[i], buffers_b[j]))
+      {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+#endif // NDEBUG
+
+void LL_ATON_RT_Sched_AddTask(LL_ATON_RT_Sched_TypeDef *sched, LL_ATON_RT_SchedTask_TypeDef *task,
+                              NN_Instance_TypeDef *nn_instance, uint32_t priority, uint32_t deadline_ticks)
+{
+  LL_ATON_ASSERT(sched != NULL);
+  LL_ATON_ASSERT(task != NULL);
+  LL_ATON_ASSERT(sched->nr_tasks < LL_ATON_RT_SCHED_MAX_TASKS);
+  for (uint32_t i = 0; i < sched->nr_tasks; i++)
+  {
+    LL_ATON_ASSERT(sched->tasks[i]->resident.nn_instance != nn_instance);
+    LL_ATON_ASSERT(__ll_aton_rt_sched_pools_disjoint(sched->tasks[i]->resident.nn_instance, nn_instance));
+  }
+
+  memset(task, 0, sizeof(*task));
+  LL_ATON_RT_Resident_Init(&task->resident, nn_instance);
+  task->priority = priority;
+  task->deadline_ticks = deadline_ticks;
+
+  sched->tasks[sched->nr_tasks++] = task;
+}
+
+void LL_ATON_RT_Sched_DeInit(LL_ATON_RT_Sched_TypeDef *sched)
+{
+  LL_ATON_ASSERT(sched != NULL);
+
+  for (uint32_t i = 0; i < sched->nr_tasks; i++)
+  {
+    LL_ATON_ASSERT(!sched->tasks[i]->released);
+    LL_ATON_RT_Resident_DeInit(&sched->tasks[i]->resident);
+    sched->tasks[i] = NULL;
+  }
+  sched->nr_tasks = 0;
+}
+
+void LL_ATON_RT_Sched_Release(LL_ATON_RT_SchedTask_TypeDef *task)
+{
+  LL_ATON_ASSERT(task != NULL);
+  LL_ATON_ASSERT(!task->released);
+
+  task->release_ts = LL_ATON_RT_RESIDENT_GET_TS();
+  task->released = true;
+}
+
+LL_ATON_RT_RetValues_t LL_ATON_RT_Sched_Step(LL_ATON_RT_Sched_TypeDef *sched)
+{
+  extern NN_Instance_TypeDef *volatile __ll_current_aton_ip_owner;
+  LL_ATON_RT_SchedTask_TypeDef *order[LL_ATON_RT_SCHED_MAX_TASKS];
+  uint32_t nr_released = 0;
+
+  LL_ATON_ASSERT(sched != NULL);
+
+  __ll_aton_rt_sched_account(sched);
+
+  /* sort the pending tasks by urgency (insertion sort keeps the registration order of equal tasks) */
+  for (uint32_t i = 0; i < sched->nr_tasks; i++)
+  {
+    LL_ATON_RT_SchedTask_TypeDef *task = sched->tasks[i];
+    uint32_t j = nr_released;
+
+    if (!task->released)
+    {
+      continue;
+    }
+    while ((j > 0) && __ll_aton_rt_sched_is_before(task, order[j - 1]))
+    {
+      order[j] = order[j - 1];
+      j--;
+    }
+    order[j] = task;
+    nr_released++;
+  }
+
+  if (nr_released == 0)
+  {
+    return LL_ATON_RT_DONE;
+  }
+
+  for (uint32_t i = 0; i < nr_released; i++)
+  {
+    LL_ATON_RT_SchedTask_TypeDef *task = order[i];
+    NN_Instance_TypeDef *nn_instance = task->resident.nn_instance;
+    LL_ATON_RT_RetValues_t ll_aton_rt_ret;
+
+    /* while another instance owns the NPU, only SW epoch blocks may be interleaved */
+    if ((__ll_current_aton_ip_owner != NULL) && (__ll_current_aton_ip_owner != nn_instance) &&
+        !__ll_aton_rt_sched_is_sw_step(nn_instance))
+    {
+      continue;
+    }
+
+    ll_aton_rt_ret = LL_ATON_RT_Resident_RunEpochBlock(&task->resident);
+    if (ll_aton_rt_ret == LL_ATON_RT_WFE)
+    {
+      continue; // waiting for the NPU, give the next task a chance
+    }
+
+    if (ll_aton_rt_ret == LL_ATON_RT_DONE)
+    {
+      uint32_t response_ticks = LL_ATON_RT_RESIDENT_GET_TS() - task->release_ts;
+
+      task->released = false;
+      task->last_response_ticks = response_ticks;
+      if (response_ticks > task->max_response_ticks)
+      {
+        task->max_response_ticks = response_ticks;
+      }
+      if ((task->deadline_ticks != 0) && (response_ticks > task->deadline_ticks))
+      {
+        task->nr_deadline_misses++;
+      }
+    }
+
+    __ll_aton_rt_sched_account(sched);
+    return LL_ATON_RT_NO_WFE;
+  }
+
+  return LL_ATON_RT_WFE;
+}
+
+void LL_ATON_RT_Sched_Run(LL_ATON_RT_Sched_TypeDef *sched)
+{
+  LL_ATON_RT_RetValues_t ll_aton_rt_ret;
+
+  do
+  {
+    ll_aton_rt_ret = LL_ATON_RT_Sched_Step(sched);
+
+    if (ll_aton_rt_ret == LL_ATON_RT_WFE)
+    {
+      LL_ATON_OSAL_WFE();
+    }
+  } while (ll_aton_rt_ret != LL_ATON_RT_DONE);
+}
+
+void LL_ATON_RT_Sched_ResetStats(LL_ATON_RT_Sched_TypeDef *sched)
+{
+  LL_ATON_ASSERT(sched != NULL);
+
+  for (uint32_t i = 0; i < sched->nr_tasks; i++)
+  {
+    LL_ATON_RT_SchedTask_TypeDef *task = sched->tasks[i];
+
+    LL_ATON_RT_Resident_ResetStats(&task->resident);
+    task->last_response_ticks = 0;
+    task->max_response_ticks = 0;
+    task->nr_deadline_misses = 0;
+  }
+  sched->elapsed_ticks = 0;
+  sched->npu_busy_ticks = 0;
+  sched->last_ts = LL_ATON_RT_RESIDENT_GET_TS();
+}
+
+void LL_ATON_RT_Sched_PrintStats(const LL_ATON_RT_Sched_TypeDef *sched)
+{
+  LL_ATON_ASSERT(sched != NULL);
+
+  for (uint32_t i = 0; i < sched->nr_tasks; i++)
+  {
+    const LL_ATON_RT_SchedTask_TypeDef *task = sched->tasks[i];
+    const LL_ATON_RT_ResidentStats_t *stats = &task->resident.stats;
+    uint32_t avg_ticks =
+        (stats->nr_inferences != 0) ? (uint32_t)(stats->total_inference_ticks / stats->nr_inferences) : 0;
+
+    LL_ATON_LIB_UNUSED(avg_ticks);
+    LL_ATON_PRINTF("%s (prio %" PRIu32 "): %" PRIu32 " inferences, service avg %" PRIu32 " max %" PRIu32
+                   ", response max %" PRIu32 ", %" PRIu32 " deadline misses\n",
+                   task->resident.nn_instance->network->network_name, task->priority, stats->nr_inferences, avg_ticks,
+                   stats->max_inference_ticks, task->max_response_ticks, task->nr_deadline_misses);
+  }
+  LL_ATON_PRINTF("NPU owned %" PRIu64 "/%" PRIu64 " ticks (%" PRIu32 "%%)\n", sched->npu_busy_ticks,
+                 sched->elapsed_ticks,
+                 (sched->elapsed_ticks != 0) ? (uint32_t)((sched->npu_busy_ticks * 100) / sched->elapsed_ticks) : 0);
+}
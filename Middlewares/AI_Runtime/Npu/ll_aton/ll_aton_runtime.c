@@ -31,6 +31,13 @@
 #include "ll_aton_reloc_network.h"
 #endif
 
+#if defined(LL_ATON_RT_EB_OVERLAP)
+#if (LL_ATON_RT_MODE != LL_ATON_RT_ASYNC)
+#error `LL_ATON_RT_EB_OVERLAP` requires the asynchronous runtime mode
+#endif
+#include "ll_aton_eb_deps.h"
+#endif
+
 /*** ATON RT Variables ***/
 
 /* Check if current runtime is prepared for underlying ATON IP instance */
@@ -234,8 +241,15 @@ static inline void __LL_ATON_RT_ExecEndEpochBlock(const LL_ATON_RT_EpochBlockIte
   {
     __ll_clear_aton_owner(nn_instance);
   }
+#if defined(LL_ATON_RT_EB_OVERLAP)
+  /* A pure SW epoch block overlapped with the next epoch blob ends while the latter (already current) holds the IP */
+  LL_ATON_ASSERT(EpochBlock_IsEpochInternal(eb) || EpochBlock_IsEpochHybrid(eb) ||
+                 (__ll_current_aton_ip_owner != nn_instance) ||
+                 (EpochBlock_IsEpochPureSW(eb) && (nn_instance->exec_state.current_epoch_block != eb)));
+#else
   LL_ATON_ASSERT(EpochBlock_IsEpochInternal(eb) || EpochBlock_IsEpochHybrid(eb) ||
                  (__ll_current_aton_ip_owner != nn_instance));
+#endif
 
   if (nn_instance->exec_state.epoch_callback_function != NULL)
   {
@@ -284,6 +298,41 @@ static void __LL_ATON_RT_DetermineNextEpochBlock(NN_Instance_TypeDef *nn_instanc
 #endif
 }
 
+#if defined(LL_ATON_RT_EB_OVERLAP)
+/* Returns `true` if the current (not yet started) epoch block has been run overlapped with the next one,
+ * which then is the current epoch block, already started */
+static bool __LL_ATON_RT_RunOverlapped(NN_Instance_TypeDef *nn_instance)
+{
+  const LL_ATON_RT_EpochBlockItem_t *sw_eb = nn_instance->exec_state.current_epoch_block;
+
+  /* Dependencies only describe the network epoch block array, not the ones inserted by ATON lib operations */
+  if ((nn_instance->exec_state.epoch_block_deps == NULL) ||
+      (nn_instance->exec_state.saved_current_epoch_block != NULL) ||
+      !LL_ATON_EbDeps_CanOverlapNext(nn_instance->exec_state.first_epoch_block,
+                                     nn_instance->exec_state.epoch_block_deps,
+                                     __LL_ATON_RT_GetCurrEpochBlockIndex(nn_instance)))
+  {
+    return false;
+  }
+
+  const LL_ATON_RT_EpochBlockItem_t *hw_eb = sw_eb + 1;
+
+  /* the SW block start only checks & traces, do it while no event may be pending */
+  __LL_ATON_RT_ExecStartEpochBlock(sw_eb, nn_instance);
+
+  /* start the blob, it becomes the current epoch block waited for */
+  nn_instance->exec_state.current_epoch_block = hw_eb;
+  nn_instance->exec_state.current_epoch_block_started = true;
+  __LL_ATON_RT_ExecStartEpochBlock(hw_eb, nn_instance);
+
+  /* execute the SW block on the MCU meanwhile */
+  __LL_ATON_RT_ExecEndEpochBlock(sw_eb, nn_instance);
+  LL_ATON_ASSERT(nn_instance->exec_state.next_epoch_block == NULL); // pure SW blocks may not insert epoch blocks
+
+  return true;
+}
+#endif // LL_ATON_RT_EB_OVERLAP
+
 static inline uint32_t __LL_ATON_RT_GetWaitMask(const LL_ATON_RT_EpochBlockItem_t *eb)
 {
   if (EpochBlock_IsEpochBlob(eb))
@@ -388,6 +437,21 @@ void LL_ATON_RT_SetEpochCallback(TraceEpochBlock_FuncPtr_t epoch_block_callback,
   nn_instance->exec_state.epoch_callback_function = epoch_block_callback;
 }
 
+#if defined(LL_ATON_RT_EB_OVERLAP)
+/**
+ * @brief Register the buffer dependencies of the epoch blocks of a network instance
+ * @param deps        Buffer dependencies, one entry per epoch block (set to `NULL` to disable overlapping)
+ * @param nn_instance Pointer to network instance for which to set the dependencies (may not be `NULL`)
+ *
+ * @note  This function must only be called while the passed network instance is not executing!
+ */
+void LL_ATON_RT_SetEpochBlockDeps(const EpochBlock_DepsTypeDef *deps, NN_Instance_TypeDef *nn_instance)
+{
+  LL_ATON_ASSERT(nn_instance != NULL);
+  nn_instance->exec_state.epoch_block_deps = deps;
+}
+#endif // LL_ATON_RT_EB_OVERLAP
+
 /**
  * @brief Initialize a network instance
  * @param nn_instance Pointer to network instance to initialize
@@ -676,6 +740,14 @@ LL_ATON_RT_RetValues_t LL_ATON_RT_RunEpochBlock(NN_Instance_TypeDef *nn_instance
       return LL_ATON_RT_NO_WFE;
     }
 
+#if defined(LL_ATON_RT_EB_OVERLAP)
+    if (!nn_instance->exec_state.current_epoch_block_started && __LL_ATON_RT_RunOverlapped(nn_instance))
+    {
+      /* Return to main loop (but do NOT call `LL_ATON_OSAL_WFE())`), the blob is waited for by the next call */
+      return LL_ATON_RT_NO_WFE;
+    }
+#endif // LL_ATON_RT_EB_OVERLAP
+
     if (!nn_instance->exec_state.current_epoch_block_started)
     {
       nn_instance->exec_state.current_epoch_block_started = true;
@@ -26,6 +26,7 @@ extern "C"
 #endif
 
 #include <assert.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -41,6 +42,66 @@ extern "C"
 
   typedef EpochBlock_ItemTypeDef LL_ATON_RT_EpochBlockItem_t;
 
+  /**
+   * @brief Execution counters of a resident network (see `LL_ATON_RT_Resident_Init()`)
+   * @note  All durations are expressed in `LL_ATON_RT_RESIDENT_GET_TS()` ticks (CPU cycles on STM32N6)
+   */
+  typedef struct
+  {
+    uint32_t init_ticks;            /**< One-time cost of runtime & network instance initialization */
+    uint32_t nr_inferences;         /**< Number of completed inferences */
+    uint32_t last_inference_ticks;  /**< Duration of the last inference (first epoch block to `LL_ATON_RT_DONE`) */
+    uint32_t min_inference_ticks;   /**< Shortest inference observed */
+    uint32_t max_inference_ticks;   /**< Longest inference observed */
+    uint64_t total_inference_ticks; /**< Accumulated inference duration (average = total / nr_inferences) */
+    uint32_t last_rearm_ticks;      /**< Cost of `LL_ATON_RT_Reset_Network()` after the last inference */
+  } LL_ATON_RT_ResidentStats_t;
+
+  /**
+   * @brief Resident network: a network instance which is initialized once and re-armed after each inference
+   */
+  typedef struct
+  {
+    NN_Instance_TypeDef *nn_instance; /**< Network instance kept initialized between inferences */
+    bool running;                     /**< An inference has been started and has not yet returned `LL_ATON_RT_DONE` */
+    uint32_t start_ts;                /**< Timestamp of the first epoch block of the running inference */
+    LL_ATON_RT_ResidentStats_t stats; /**< Execution counters */
+  } LL_ATON_RT_Resident_TypeDef;
+
+/* Maximum number of networks served by one scheduler */
+#ifndef LL_ATON_RT_SCHED_MAX_TASKS
+#define LL_ATON_RT_SCHED_MAX_TASKS 4
+#endif
+
+  /**
+   * @brief Network served by a cooperative scheduler (see `LL_ATON_RT_Sched_AddTask()`)
+   * @note  All durations are expressed in `LL_ATON_RT_RESIDENT_GET_TS()` ticks
+   */
+  typedef struct
+  {
+    LL_ATON_RT_Resident_TypeDef resident; /**< Resident network executing the inferences of the task */
+    uint32_t priority;                    /**< Higher values are served first at epoch block boundaries */
+    uint32_t deadline_ticks;              /**< Relative deadline of an inference from its release (0 if none) */
+    bool released;                        /**< An inference has been requested and has not yet completed */
+    uint32_t release_ts;                  /**< Timestamp of the release of the pending inference */
+    uint32_t last_response_ticks;         /**< Release to completion time of the last inference */
+    uint32_t max_response_ticks;          /**< Longest release to completion time observed */
+    uint32_t nr_deadline_misses;          /**< Inferences completed after their deadline */
+  } LL_ATON_RT_SchedTask_TypeDef;
+
+  /**
+   * @brief Cooperative scheduler interleaving the epoch blocks of several resident networks on a single NPU
+   */
+  typedef struct
+  {
+    LL_ATON_RT_SchedTask_TypeDef *tasks[LL_ATON_RT_SCHED_MAX_TASKS]; /**< Registered tasks */
+    uint32_t nr_tasks;                                                /**< Number of registered tasks */
+    uint32_t last_ts;        /**< Timestamp up to which the time has been accounted */
+    bool npu_owned;          /**< The NPU was owned by an instance at `last_ts` */
+    uint64_t elapsed_ticks;  /**< Accounted time since the last reset of the counters */
+    uint64_t npu_busy_ticks; /**< Part of `elapsed_ticks` during which an instance owned the NPU */
+  } LL_ATON_RT_Sched_TypeDef;
+
   /*** Helper Functions ***/
 
   static inline void __ll_set_aton_owner(NN_Instance_TypeDef *new_owner)
@@ -236,6 +297,21 @@ extern "C"
    */
   void LL_ATON_RT_SetEpochCallback(TraceEpochBlock_FuncPtr_t epoch_block_callback, NN_Instance_TypeDef *nn_instance);
 
+#if defined(LL_ATON_RT_EB_OVERLAP)
+  /**
+   * @brief Register the buffer dependencies of the epoch blocks of a network instance, which enables the
+   *        overlap of a pure SW epoch block with the epoch blob following it whenever both are independent
+   *        (see `LL_ATON_EbDeps_CanOverlapNext()`): the blob is started on the NPU before the SW block runs
+   * @param deps        Buffer dependencies, one entry per item of the network epoch block array
+   *                    (set to `NULL` to execute the epoch blocks strictly in order)
+   * @param nn_instance Pointer to network instance for which to set the dependencies (may not be `NULL`)
+   *
+   * @note  This function must only be called while the passed network instance is not executing.
+   *        With overlap, the epoch callback sees the start of the blob before the end of the SW block
+   */
+  void LL_ATON_RT_SetEpochBlockDeps(const EpochBlock_DepsTypeDef *deps, NN_Instance_TypeDef *nn_instance);
+#endif // LL_ATON_RT_EB_OVERLAP
+
   /**
    * @brief Initialise a network instance
    * @param nn_instance Pointer to network instance to initialize
@@ -294,6 +370,116 @@ extern "C"
    */
   void LL_ATON_RT_Main(NN_Instance_TypeDef *network_instance);
 
+  /**
+   * @brief Initialize the runtime (if not yet done) and a network instance once, for repeated inferences
+   * @param resident    Resident network object to initialize
+   * @param nn_instance Network instance to keep resident (same requirements as for `LL_ATON_RT_Main()`)
+   *
+   * @note Contrary to `LL_ATON_RT_Main()`, runtime and instance are NOT de-initialized at the end of an inference,
+   *       the instance is simply re-armed with `LL_ATON_RT_Reset_Network()`
+   */
+  void LL_ATON_RT_Resident_Init(LL_ATON_RT_Resident_TypeDef *resident, NN_Instance_TypeDef *nn_instance);
+
+  /**
+   * @brief De-initialize a resident network (and the runtime, once the last resident network is gone)
+   * @param resident Resident network object to de-initialize (no inference may be running)
+   */
+  void LL_ATON_RT_Resident_DeInit(LL_ATON_RT_Resident_TypeDef *resident);
+
+  /**
+   * @brief Non-blocking step of a resident network, to be called instead of `LL_ATON_RT_RunEpochBlock()`
+   * @param resident Resident network to run/continue
+   * @retval Same as `LL_ATON_RT_RunEpochBlock()`; on `LL_ATON_RT_DONE` the counters have been updated and the
+   *         instance has already been re-armed, so the next call starts a new inference
+   */
+  LL_ATON_RT_RetValues_t LL_ATON_RT_Resident_RunEpochBlock(LL_ATON_RT_Resident_TypeDef *resident);
+
+  /**
+   * @brief Synchronously execute one inference of a resident network
+   * @param resident Resident network to execute
+   */
+  void LL_ATON_RT_Resident_Run(LL_ATON_RT_Resident_TypeDef *resident);
+
+  /**
+   * @brief Get the execution counters of a resident network
+   * @param resident Resident network
+   * @retval Pointer to the counters (valid as long as the resident network object)
+   */
+  static inline const LL_ATON_RT_ResidentStats_t *LL_ATON_RT_Resident_GetStats(const LL_ATON_RT_Resident_TypeDef *resident)
+  {
+    return &resident->stats;
+  }
+
+  /**
+   * @brief Clear the inference counters of a resident network (the init cost is preserved)
+   * @param resident Resident network
+   */
+  void LL_ATON_RT_Resident_ResetStats(LL_ATON_RT_Resident_TypeDef *resident);
+
+  /**
+   * @brief Initialize a cooperative multi-network scheduler
+   * @param sched Scheduler object to initialize
+   *
+   * @note Networks are switched only at epoch block boundaries. While an instance owns the NPU (from the start to the
+   *       end of a HW/hybrid epoch block or of an inserted epoch block array), the other instances may only run their
+   *       pure SW epoch blocks. All tasks MUST be run from the same thread.
+   */
+  void LL_ATON_RT_Sched_Init(LL_ATON_RT_Sched_TypeDef *sched);
+
+  /**
+   * @brief Register a network with the scheduler and make it resident (see `LL_ATON_RT_Resident_Init()`)
+   * @param sched          Scheduler
+   * @param task           Task object to initialize
+   * @param nn_instance    Network instance executed by the task
+   * @param priority       Higher values are served first, ties are broken by earliest absolute deadline
+   * @param deadline_ticks Relative deadline of an inference from its release (0 if none)
+   *
+   * @note The activation pools and the inputs/outputs of the networks of a scheduler MUST be disjoint (e.g. generated
+   *       with distinct memory pool descriptions): a SW epoch block of one network may run while the NPU writes the
+   *       buffers of another one. This is asserted at registration from the buffer infos of the networks.
+   */
+  void LL_ATON_RT_Sched_AddTask(LL_ATON_RT_Sched_TypeDef *sched, LL_ATON_RT_SchedTask_TypeDef *task,
+                                NN_Instance_TypeDef *nn_instance, uint32_t priority, uint32_t deadline_ticks);
+
+  /**
+   * @brief De-initialize all tasks of a scheduler (no inference may be pending)
+   * @param sched Scheduler
+   */
+  void LL_ATON_RT_Sched_DeInit(LL_ATON_RT_Sched_TypeDef *sched);
+
+  /**
+   * @brief Request an inference of a task, whose inputs MUST be ready
+   * @param task Task (no inference may be pending)
+   */
+  void LL_ATON_RT_Sched_Release(LL_ATON_RT_SchedTask_TypeDef *task);
+
+  /**
+   * @brief Non-blocking step of the scheduler: runs/continues the most urgent task which may progress
+   * @param sched Scheduler
+   * @retval LL_ATON_RT_NO_WFE An epoch block has been started or ended, call again
+   * @retval LL_ATON_RT_WFE    All pending inferences wait for the NPU, you may call `LL_ATON_OSAL_WFE()`
+   * @retval LL_ATON_RT_DONE   No inference is pending
+   */
+  LL_ATON_RT_RetValues_t LL_ATON_RT_Sched_Step(LL_ATON_RT_Sched_TypeDef *sched);
+
+  /**
+   * @brief Synchronously execute all pending inferences
+   * @param sched Scheduler
+   */
+  void LL_ATON_RT_Sched_Run(LL_ATON_RT_Sched_TypeDef *sched);
+
+  /**
+   * @brief Clear the counters of a scheduler and of its tasks
+   * @param sched Scheduler
+   */
+  void LL_ATON_RT_Sched_ResetStats(LL_ATON_RT_Sched_TypeDef *sched);
+
+  /**
+   * @brief Print per-network latencies and NPU utilization with `LL_ATON_PRINTF()`
+   * @param sched Scheduler
+   */
+  void LL_ATON_RT_Sched_PrintStats(const LL_ATON_RT_Sched_TypeDef *sched);
+
   /** @brief Dumps status of all DMAs. Used for debugging purposes
    */
   void dump_dma_state(void);
@@ -33,6 +33,14 @@
 #include "layers.h"
 #include "ll_aton_util.h"
 
+#if defined(__ARM_FEATURE_MVE) && (__ARM_FEATURE_MVE & 1)
+#include <arm_mve.h>
+#define LL_SW_USE_MVEI
+#if (__ARM_FEATURE_MVE & 2)
+#define LL_SW_USE_MVEF
+#endif
+#endif
+
 #define FORMAT AI_ARRAY_FORMAT_FLOAT
 
 #define SHAPE_INIT(a_, b_, c_, d_) AI_SHAPE_INIT(4, (d_), (c_), (b_), (a_))
@@ -336,11 +344,94 @@ void ll_sw_forward_quantizelinear(/* int processor, */ void *sw_info_struct)
 }
 
 //##########################################################################################
+/*
+ * Direct int8 to float32 DequantizeLinear for per-tensor quantization and a dense HWC input, instead
+ * of the generic `node_convert` layer: y = scale * (x - zero_point), as defined by ONNX.
+ * The output is written in the layout of its strides, either dense in the input order or planar (CHW),
+ * as generated for a channel-first network output.
+ */
+
+/* Dequantizes 'n' values read every 'in_step' bytes into consecutive floats */
+static inline void ll_sw_dequantize_is8of32(const int8_t *in, uint32_t in_step, float *out, uint32_t n, float scale,
+                                            int32_t zero_point)
+{
+#if defined(LL_SW_USE_MVEF)
+  const uint32x4_t offsets = vmulq_n_u32(vidupq_n_u32(0, 1), in_step);
+
+  for (int32_t i = 0; i < (int32_t)n; i += 4)
+  {
+    mve_pred16_t p = vctp32q(n - i);
+    int32x4_t q = (in_step == 1) ? vldrbq_z_s32(in, p) : vldrbq_gather_offset_z_s32(in, offsets, p);
+    q = vsubq_n_s32(q, zero_point);
+    vstrwq_p_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(q), scale), p);
+    in += 4 * in_step;
+  }
+#else
+  for (uint32_t i = 0; i < n; i++)
+  {
+    out[i] = scale * (float)((int32_t)*in - zero_point);
+    in += in_step;
+  }
+#endif
+}
+
+/* Returns false, without any output written, if the generic layer is needed */
+static bool ll_sw_forward_dequantizelinear_fast(const Dequantizelinear_sw_info *sw_info)
+{
+  const Tensor_info *in = &sw_info->general.input;
+  const Tensor_info *out = &sw_info->general.output;
+  const uint32_t c = in->dim.tensor_c;
+  const uint32_t w = in->dim.tensor_w;
+  const uint32_t hw = in->dim.tensor_h * w;
+  bool planar;
+
+  if (!in->format.is_signed || sw_info->is.dim.num_elem != 1 || sw_info->izp.dim.num_elem != 1 ||
+      !sw_info->izp.format.is_signed)
+    return false;
+  if (in->stride.c != 1 || in->stride.w != c || in->stride.h != w * c || in->stride.b != hw * c)
+    return false;
+  if (out->dim.num_elem != in->dim.num_elem || out->stride.b != hw * c * sizeof(float))
+    return false;
+  if (out->stride.c == sizeof(float) && out->stride.w == c * sizeof(float) && out->stride.h == w * c * sizeof(float))
+    planar = false;
+  else if (out->stride.c == hw * sizeof(float) && out->stride.w == sizeof(float) && out->stride.h == w * sizeof(float))
+    planar = true;
+  else
+    return false;
+
+  const float scale = *(const float *)sw_info->is.mem.start_offset;
+  const int32_t zero_point = *(const int8_t *)sw_info->izp.mem.start_offset;
+
+  for (uint32_t b = 0; b < in->dim.tensor_b; b++)
+  {
+    const int8_t *src = (const int8_t *)in->mem.start_offset + b * hw * c;
+    float *dst = (float *)out->mem.start_offset + b * hw * c;
+
+    if (planar)
+    {
+      // One plane per channel, gathered from the interleaved input
+      for (uint32_t ch = 0; ch < c; ch++)
+        ll_sw_dequantize_is8of32(src + ch, c, dst + ch * hw, hw, scale, zero_point);
+    }
+    else
+    {
+      ll_sw_dequantize_is8of32(src, 1, dst, hw * c, scale, zero_point);
+    }
+  }
+
+  return true;
+}
+
 /** Dequantizelinear forward function */
 void ll_sw_forward_dequantizelinear(/* int processor, */ void *sw_info_struct)
 {
   Dequantizelinear_sw_info *sw_info = (Dequantizelinear_sw_info *)sw_info_struct;
 
+  if (ll_sw_forward_dequantizelinear_fast(sw_info))
+  {
+    return;
+  }
+
   // array init
   int32_t format = sw_info->general.input.format.is_signed ? (AI_ARRAY_FORMAT_S8 | AI_FMT_FLAG_IS_IO)
                                                            : (AI_ARRAY_FORMAT_U8 | AI_FMT_FLAG_IS_IO);
@@ -1127,10 +1218,162 @@ void ll_sw_forward_activ_integer(/* int processor, */ void *sw_info_struct)
 }
 
 //##########################################################################################
+/*
+ * Fast path of the int8 bilinear Resize for upsampling by 2 or 4 with half-pixel coordinates.
+ *
+ * The generic kernel (`forward_resize_bilinear_is8os8`) interpolates the raw int8 values in float
+ * then rounds half away from zero. For these factors the source coordinates, hence the weights,
+ * are exact multiples of 1/(2 * factor) on each axis: the same values are computed here with
+ * 16-bit integer weights, bit-exact with the generic kernel.
+ * Restricted to per-tensor quantization with identical input and output parameters (the generic
+ * kernel does not requantize) and to channel-contiguous (NHWC) tensors.
+ */
+
+/* Source pixels and weights of an output coordinate along one axis */
+typedef struct
+{
+  uint32_t i0, i1; // Neighbour indexes, clamped to the input size
+  int16_t w0, w1;  // Weights of i0 and i1, w0 + w1 == 2 * factor
+} ll_sw_resize_tap;
+
+static inline void ll_sw_resize_tap_init(ll_sw_resize_tap *tap, uint32_t o, uint32_t log2_factor, uint32_t in_size)
+{
+  // Source coordinate: (o + 0.5) / factor - 0.5 == num / (2 * factor)
+  const int32_t num = 2 * (int32_t)o + 1 - (1 << log2_factor);
+  const uint32_t log2_den = log2_factor + 1;
+
+  if (num < 0)
+  {
+    // Clamped to the first pixel, as the generic kernel does
+    tap->i0 = tap->i1 = 0;
+    tap->w0 = 1 << log2_den;
+    tap->w1 = 0;
+    return;
+  }
+
+  tap->i0 = num >> log2_den;
+  tap->i1 = (tap->i0 + 1 < in_size) ? tap->i0 + 1 : in_size - 1;
+  tap->w1 = num & ((1 << log2_den) - 1);
+  tap->w0 = (1 << log2_den) - tap->w1;
+}
+
+/* Blends 'n' channels of 4 neighbour pixels, sum of the weights is '1 << shift' */
+static inline void ll_sw_resize_blend_is8os8(int8_t *dst, const int8_t *p00, const int8_t *p01, const int8_t *p10,
+                                             const int8_t *p11, const int16_t w[4], uint32_t shift, uint32_t n)
+{
+  const int16_t half = 1 << (shift - 1);
+
+#if defined(LL_SW_USE_MVEI)
+  for (int32_t i = 0; i < (int32_t)n; i += 8)
+  {
+    mve_pred16_t p = vctp16q(n - i);
+    // |sum| <= 128 << shift, fits in 16 bits up to a factor 4 on both axes
+    int16x8_t acc = vmulq_n_s16(vldrbq_z_s16(p00 + i, p), w[0]);
+    acc = vmlaq_n_s16(acc, vldrbq_z_s16(p01 + i, p), w[1]);
+    acc = vmlaq_n_s16(acc, vldrbq_z_s16(p10 + i, p), w[2]);
+    acc = vmlaq_n_s16(acc, vldrbq_z_s16(p11 + i, p), w[3]);
+    // Round half away from zero: (acc + half - (acc < 0)) >> shift
+    acc = vaddq_s16(acc, vshrq_n_s16(acc, 15));
+    acc = vaddq_n_s16(acc, half);
+    acc = vshlq_r_s16(acc, -(int32_t)shift);
+    vstrbq_p_s16(dst + i, acc, p);
+  }
+#else
+  for (uint32_t i = 0; i < n; i++)
+  {
+    int32_t acc = w[0] * p00[i] + w[1] * p01[i] + w[2] * p10[i] + w[3] * p11[i];
+    dst[i] = (int8_t)((acc + half - (acc < 0)) >> shift);
+  }
+#endif
+}
+
+static bool ll_sw_resize_is_nhwc(const Tensor_info *t)
+{
+  return t->stride.c == 1 && t->stride.w == t->dim.tensor_c && t->stride.h == t->dim.tensor_w * t->stride.w &&
+         t->stride.b == t->dim.tensor_h * t->stride.h;
+}
+
+static int ll_sw_resize_log2_factor(uint32_t in_size, uint32_t out_size, float scale)
+{
+  if (out_size == 2 * in_size && scale == 2.0f)
+    return 1;
+  if (out_size == 4 * in_size && scale == 4.0f)
+    return 2;
+  return -1;
+}
+
+/* Returns false, without any output written, if the generic kernel is needed */
+static bool ll_sw_forward_resize_bilinear_is8os8_fast(const Resize_integer_sw_info *sw_info)
+{
+  const Tensor_info *in = &sw_info->general.input;
+  const Tensor_info *out = &sw_info->general.output;
+  const float *scales = (const float *)sw_info->scales.mem.start_offset;
+
+  if ((sw_info->mode != RESIZE_LINEAR) ||
+      (sw_info->coord_transf_mode != HALF_PIXEL && sw_info->coord_transf_mode != PYTORCH_HALF_PIXEL))
+    return false;
+  if (!in->format.is_signed || !out->format.is_signed)
+    return false;
+  if (sw_info->is.dim.num_elem != 1 || sw_info->os.dim.num_elem != 1 || sw_info->izp.dim.num_elem != 1 ||
+      sw_info->ozp.dim.num_elem != 1)
+    return false;
+  if (*(const float *)sw_info->is.mem.start_offset != *(const float *)sw_info->os.mem.start_offset ||
+      *(const int8_t *)sw_info->izp.mem.start_offset != *(const int8_t *)sw_info->ozp.mem.start_offset ||
+      sw_info->izp.format.is_signed != sw_info->ozp.format.is_signed)
+    return false;
+  if (out->dim.tensor_b != in->dim.tensor_b || out->dim.tensor_c != in->dim.tensor_c || !ll_sw_resize_is_nhwc(in) ||
+      !ll_sw_resize_is_nhwc(out))
+    return false;
+  if (scales == NULL || sw_info->scales.dim.num_elem != 4)
+    return false;
+
+  // Scales are in NCHW order
+  const int log2_fh = ll_sw_resize_log2_factor(in->dim.tensor_h, out->dim.tensor_h, scales[2]);
+  const int log2_fw = ll_sw_resize_log2_factor(in->dim.tensor_w, out->dim.tensor_w, scales[3]);
+  if (log2_fh < 0 || log2_fw < 0)
+    return false;
+
+  const uint32_t c = in->dim.tensor_c;
+  const uint32_t shift = (log2_fh + 1) + (log2_fw + 1);
+
+  for (uint32_t b = 0; b < out->dim.tensor_b; b++)
+  {
+    const int8_t *src = (const int8_t *)in->mem.start_offset + b * in->stride.b;
+    int8_t *dst = (int8_t *)out->mem.start_offset + b * out->stride.b;
+
+    for (uint32_t oy = 0; oy < out->dim.tensor_h; oy++)
+    {
+      ll_sw_resize_tap ty;
+      ll_sw_resize_tap_init(&ty, oy, log2_fh, in->dim.tensor_h);
+      const int8_t *row0 = src + ty.i0 * in->stride.h;
+      const int8_t *row1 = src + ty.i1 * in->stride.h;
+
+      for (uint32_t ox = 0; ox < out->dim.tensor_w; ox++)
+      {
+        ll_sw_resize_tap tx;
+        ll_sw_resize_tap_init(&tx, ox, log2_fw, in->dim.tensor_w);
+        const int16_t w[4] = {ty.w0 * tx.w0, ty.w0 * tx.w1, ty.w1 * tx.w0, ty.w1 * tx.w1};
+
+        ll_sw_resize_blend_is8os8(dst, row0 + tx.i0 * c, row0 + tx.i1 * c, row1 + tx.i0 * c, row1 + tx.i1 * c, w,
+                                  shift, c);
+        dst += c;
+      }
+    }
+  }
+
+  return true;
+}
+
 /** Resize forward function */
 void ll_sw_forward_resize_integer(/* int processor, */ void *sw_info_struct)
 {
   Resize_integer_sw_info *sw_info = (Resize_integer_sw_info *)sw_info_struct;
+
+  if (ll_sw_forward_resize_bilinear_is8os8_fast(sw_info))
+  {
+    return;
+  }
+
   // array init
 
   int32_t format = sw_info->general.input.format.is_signed ? (AI_ARRAY_FORMAT_S8 | AI_FMT_FLAG_IS_IO)
@@ -52,6 +52,7 @@ extern "C"
 #define POSTPROCESS_MPE_YOLO_V8_UF      (20)  /* Yolov8 postprocessing; Input model: uint8; output: float32         */
 #define POSTPROCESS_MPE_PD_UF           (21)  /* Palm detector postprocessing; Input model: uint8; output: float32  */
 #define POSTPROCESS_SPE_MOVENET_UF      (22)  /* Movenet postprocessing; Input model: uint8; output: float32        */
+#define POSTPROCESS_SPE_MOVENET_UI      (23)  /* Movenet postprocessing; Input model: uint8; output: int8           */
 #define POSTPROCESS_ISEG_YOLO_V8_UI     (30)  /* Yolov8 Seg postprocessing; Input model: uint8; output: int8        */
 #define POSTPROCESS_SSEG_DEEPLAB_V3_UF  (40)  /* Deeplabv3 Seg postprocessing; Input model: uint8; output: float32  */
 #define POSTPROCESS_CUSTOM              (100) /* Custom post processing which needs to be implemented by user       */
@@ -32,6 +32,12 @@ int32_t app_postprocess_init(void *params_postprocess)
   params->heatmap_width = AI_SPE_MOVENET_POSTPROC_HEATMAP_WIDTH;
   params->heatmap_height = AI_SPE_MOVENET_POSTPROC_HEATMAP_HEIGHT;
   params->nb_keypoints = AI_POSE_PP_POSE_KEYPOINTS_NB;
+#ifdef AI_SPE_MOVENET_POSTPROC_REFINE
+  params->refine_mode = AI_SPE_MOVENET_POSTPROC_REFINE;
+#else
+  params->refine_mode = AI_SPE_MOVENET_PP_REFINE_NONE;
+#endif
+  params->planar_heatmaps = 0;
   error = spe_movenet_pp_reset(params);
   return error;
 }
@@ -18,6 +18,12 @@
 #include "spe_pp_output_if.h"
 
 
+/* Sub-pixel refinement of the heatmap maxima (3x3 neighbourhood) */
+#define AI_SPE_MOVENET_PP_REFINE_NONE       (0)  /* Keypoints at the centre of the heatmap cell */
+#define AI_SPE_MOVENET_PP_REFINE_QUADRATIC  (1)  /* Parabola vertex along each axis             */
+#define AI_SPE_MOVENET_PP_REFINE_CENTROID   (2)  /* Weighted centroid of the neighbourhood      */
+
+
 /* I/O structures for Movenet model type */
 /* ------------------------------------- */
 typedef struct spe_movenet_pp_in
@@ -29,6 +35,11 @@ typedef struct spe_movenet_pp_in
 	float32_t *inBuff;
 } spe_movenet_pp_in_t;
 
+typedef struct spe_movenet_pp_in_int8
+{
+	int8_t *inBuff;    /* Quantized heatmaps, same layout as spe_movenet_pp_in_t */
+} spe_movenet_pp_in_int8_t;
+
 
 
 typedef struct spe_movenet_pp_static_param {
@@ -39,6 +50,10 @@ typedef struct spe_movenet_pp_static_param {
   uint32_t  heatmap_width;
   uint32_t  heatmap_height;
   uint32_t  nb_keypoints;
+  uint32_t  refine_mode;           /* AI_SPE_MOVENET_PP_REFINE_xxx */
+  uint32_t  planar_heatmaps;       /* Float input only: heatmaps one after the other (CHW) instead of interleaved (HWC) */
+  float32_t raw_output_scale;      /* Int8 input only */
+  int8_t    raw_output_zero_point; /* Int8 input only */
 } spe_movenet_pp_static_param_t;
 
 
@@ -67,6 +82,20 @@ int32_t spe_movenet_pp_process(spe_movenet_pp_in_t *pInput,
                                spe_movenet_pp_static_param_t *pInput_static_param);
 
 
+/*!
+ * @brief Movenet post processing on int8 heatmaps: the arg-max is done on the
+ *        quantized values, only the maximum of each heatmap is dequantized
+ *
+ * @param [IN] Pointer on input data
+ *             Pointer on output data
+ *             pointer on static parameters
+ * @retval Error code
+ */
+int32_t spe_movenet_pp_process_is8(spe_movenet_pp_in_int8_t *pInput,
+                                   spe_pp_out_t     *pOutput,
+                                   spe_movenet_pp_static_param_t *pInput_static_param);
+
+
 #ifdef __cplusplus
   }
 #endif
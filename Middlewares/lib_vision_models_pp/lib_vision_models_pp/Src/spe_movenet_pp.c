@@ -12,6 +12,150 @@
 #include "vision_models_pp.h"
 
 
+#define MOVENET_REFINE_Q        (15)
+#define MOVENET_REFINE_HALF_Q   (1 << (MOVENET_REFINE_Q - 1))
+
+
+/* Loads the 3x3 neighbourhood of a heatmap maximum, returns 0 if the maximum lies on the heatmap border */
+static int32_t movenet_neighbourhood_f32(float32_t *pKp, uint32_t index, uint32_t width, uint32_t height,
+                                         uint32_t stride, float32_t *pN)
+{
+  uint32_t a = index % height;
+  uint32_t b = index / height;
+
+  if ((a == 0) || (a >= height - 1) || (b == 0) || (b >= width - 1))
+  {
+    return 0;
+  }
+  for (int32_t db = -1; db <= 1; db++)
+  {
+    for (int32_t da = -1; da <= 1; da++)
+    {
+      *pN++ = pKp[((int32_t)index + db * (int32_t)height + da) * (int32_t)stride];
+    }
+  }
+  return 1;
+}
+
+
+static int32_t movenet_neighbourhood_is8(int8_t *pKp, uint32_t index, uint32_t width, uint32_t height,
+                                         uint32_t nb_keypoints, int32_t *pN)
+{
+  uint32_t a = index % height;
+  uint32_t b = index / height;
+
+  if ((a == 0) || (a >= height - 1) || (b == 0) || (b >= width - 1))
+  {
+    return 0;
+  }
+  for (int32_t db = -1; db <= 1; db++)
+  {
+    for (int32_t da = -1; da <= 1; da++)
+    {
+      *pN++ = pKp[((int32_t)index + db * (int32_t)height + da) * (int32_t)nb_keypoints];
+    }
+  }
+  return 1;
+}
+
+
+/* Vertex of the parabola fitted on a 1D peak, in cells, within [-0.5, 0.5] */
+static float32_t movenet_quadratic_f32(float32_t l, float32_t c, float32_t r)
+{
+  float32_t den = l - 2.0f * c + r;
+
+  if (den >= 0.0f)
+  {
+    /* Flat neighbourhood: no curvature to fit */
+    return 0.0f;
+  }
+  return MIN(0.5f, MAX(-0.5f, 0.5f * (l - r) / den));
+}
+
+
+/* Same as movenet_quadratic_f32() on quantized values, result in Q15 */
+static int32_t movenet_quadratic_s32(int32_t l, int32_t c, int32_t r)
+{
+  int32_t den = 2 * (l - 2 * c + r);
+
+  if (den >= 0)
+  {
+    return 0;
+  }
+  return MIN(MOVENET_REFINE_HALF_Q, MAX(-MOVENET_REFINE_HALF_Q, ((l - r) * (1 << MOVENET_REFINE_Q)) / den));
+}
+
+
+/* Sub-pixel offsets (da along index % height, db along index / height) from a 3x3 neighbourhood */
+static void movenet_refine_f32(float32_t *pN, uint32_t mode, float32_t *pDa, float32_t *pDb)
+{
+  if (mode == AI_SPE_MOVENET_PP_REFINE_QUADRATIC)
+  {
+    *pDa = movenet_quadratic_f32(pN[3], pN[4], pN[5]);
+    *pDb = movenet_quadratic_f32(pN[1], pN[4], pN[7]);
+  }
+  else
+  {
+    /* Centroid of the neighbourhood, weights relative to its minimum so that they are positive */
+    float32_t vmin = pN[0];
+    float32_t sum = 0.0f;
+    float32_t sum_a = 0.0f;
+    float32_t sum_b = 0.0f;
+
+    for (uint32_t i = 1; i < 9; i++)
+    {
+      vmin = MIN(vmin, pN[i]);
+    }
+    for (int32_t i = 0; i < 9; i++)
+    {
+      float32_t w = pN[i] - vmin;
+      sum += w;
+      sum_a += w * (float32_t)(i % 3 - 1);
+      sum_b += w * (float32_t)(i / 3 - 1);
+    }
+    *pDa = (sum > 0.0f) ? sum_a / sum : 0.0f;
+    *pDb = (sum > 0.0f) ? sum_b / sum : 0.0f;
+  }
+}
+
+
+static void movenet_refine_s32(int32_t *pN, uint32_t mode, float32_t *pDa, float32_t *pDb)
+{
+  int32_t da_q;
+  int32_t db_q;
+
+  if (mode == AI_SPE_MOVENET_PP_REFINE_QUADRATIC)
+  {
+    da_q = movenet_quadratic_s32(pN[3], pN[4], pN[5]);
+    db_q = movenet_quadratic_s32(pN[1], pN[4], pN[7]);
+  }
+  else
+  {
+    /* Int8 weights: sums fit in int32 without overflow (9 * 255 * 2^15) */
+    int32_t vmin = pN[0];
+    int32_t sum = 0;
+    int32_t sum_a = 0;
+    int32_t sum_b = 0;
+
+    for (uint32_t i = 1; i < 9; i++)
+    {
+      vmin = MIN(vmin, pN[i]);
+    }
+    for (int32_t i = 0; i < 9; i++)
+    {
+      int32_t w = pN[i] - vmin;
+      sum += w;
+      sum_a += w * (i % 3 - 1);
+      sum_b += w * (i / 3 - 1);
+    }
+    da_q = (sum > 0) ? (sum_a * (1 << MOVENET_REFINE_Q)) / sum : 0;
+    db_q = (sum > 0) ? (sum_b * (1 << MOVENET_REFINE_Q)) / sum : 0;
+  }
+  *pDa = (float32_t)da_q * (1.0f / (1 << MOVENET_REFINE_Q));
+  *pDb = (float32_t)db_q * (1.0f / (1 << MOVENET_REFINE_Q));
+}
+
+
 
 int32_t movenet_heatmap_max(spe_movenet_pp_in_t *pInput,
                             spe_pp_out_t *pOutput,
@@ -25,20 +169,45 @@ int32_t movenet_heatmap_max(spe_movenet_pp_in_t *pInput,
   uint32_t width = pInput_static_param->heatmap_width;
   uint32_t height = pInput_static_param->heatmap_height;
   float32_t *pInputKp = pInput->inBuff;
+  float32_t neighbourhood[9];
+  float32_t da;
+  float32_t db;
+  /* Distance between two cells of a heatmap */
+  uint32_t stride = pInput_static_param->planar_heatmaps ? 1 : pInput_static_param->nb_keypoints;
 
   for (i = 0; i < pInput_static_param->nb_keypoints; i++)
   {
 
-    pInputKp = &(pInput->inBuff[i]);
-    vision_models_maxi_tr_if32ou32((float32_t *) pInputKp,
-                                   (uint32_t) width * height,
-                                   pInput_static_param->nb_keypoints,
-                                   (float32_t *) &proba,
-                                   (uint32_t *) &index);
+    if (pInput_static_param->planar_heatmaps)
+    {
+      /* Contiguous heatmap: no transposed gather */
+      pInputKp = &(pInput->inBuff[i * width * height]);
+      vision_models_maxi_if32ou32((float32_t *) pInputKp,
+                                  (uint32_t) width * height,
+                                  (float32_t *) &proba,
+                                  (uint32_t *) &index);
+    }
+    else
+    {
+      pInputKp = &(pInput->inBuff[i]);
+      vision_models_maxi_tr_if32ou32((float32_t *) pInputKp,
+                                     (uint32_t) width * height,
+                                     pInput_static_param->nb_keypoints,
+                                     (float32_t *) &proba,
+                                     (uint32_t *) &index);
+    }
+
+    da = 0.0f;
+    db = 0.0f;
+    if ((pInput_static_param->refine_mode != AI_SPE_MOVENET_PP_REFINE_NONE) &&
+        movenet_neighbourhood_f32(pInputKp, index, width, height, stride, neighbourhood))
+    {
+      movenet_refine_f32(neighbourhood, pInput_static_param->refine_mode, &da, &db);
+    }
 
     /* This is not cartesian referential, to be aligned with Python code */
-    y_center = ((index % height + 0.5f) / height);
-    x_center = ((index / height + 0.5f) / width);
+    y_center = ((index % height + 0.5f + da) / height);
+    x_center = ((index / height + 0.5f + db) / width);
 
     /* Coordinates inversion for the application code that uses cartesian referential */
     pOutput->pOutBuff[i].x_center = y_center;
@@ -50,6 +219,69 @@ int32_t movenet_heatmap_max(spe_movenet_pp_in_t *pInput,
 }
 
 
+int32_t movenet_heatmap_max_is8(spe_movenet_pp_in_int8_t *pInput,
+                                spe_pp_out_t *pOutput,
+                                spe_movenet_pp_static_param_t *pInput_static_param)
+{
+  uint32_t i;
+  uint32_t k;
+  uint32_t nb;
+  float32_t x_center;
+  float32_t y_center;
+  int8_t maxim[16];
+  uint32_t index[16];
+  int32_t neighbourhood[9];
+  float32_t da;
+  float32_t db;
+  uint32_t width = pInput_static_param->heatmap_width;
+  uint32_t height = pInput_static_param->heatmap_height;
+  uint32_t nb_keypoints = pInput_static_param->nb_keypoints;
+  float32_t scale = pInput_static_param->raw_output_scale;
+  int8_t zero_point = pInput_static_param->raw_output_zero_point;
+
+  /* Heatmaps are interleaved (HWC): up to 16 keypoints are scanned in a single pass */
+  for (k = 0; k < nb_keypoints; k += 16)
+  {
+    nb = MIN(16, nb_keypoints - k);
+
+    /* MVE implementation only writes the index of lanes exceeding Q7_MIN */
+    for (i = 0; i < nb; i++)
+    {
+      index[i] = 0;
+    }
+    vision_models_maxi_tr_p_is8ou32(&(pInput->inBuff[k]),
+                                    width * height,
+                                    nb_keypoints,
+                                    maxim,
+                                    index,
+                                    nb);
+
+    for (i = 0; i < nb; i++)
+    {
+      da = 0.0f;
+      db = 0.0f;
+      if ((pInput_static_param->refine_mode != AI_SPE_MOVENET_PP_REFINE_NONE) &&
+          movenet_neighbourhood_is8(&(pInput->inBuff[k + i]), index[i], width, height, nb_keypoints, neighbourhood))
+      {
+        movenet_refine_s32(neighbourhood, pInput_static_param->refine_mode, &da, &db);
+      }
+
+      /* This is not cartesian referential, to be aligned with Python code */
+      y_center = ((index[i] % height + 0.5f + da) / height);
+      x_center = ((index[i] / height + 0.5f + db) / width);
+
+      /* Coordinates inversion for the application code that uses cartesian referential */
+      pOutput->pOutBuff[k + i].x_center = y_center;
+      pOutput->pOutBuff[k + i].y_center = x_center;
+      /* Dequantization is monotonic: only the winning value needs it */
+      pOutput->pOutBuff[k + i].proba = scale * (float32_t)((int32_t)maxim[i] - zero_point);
+    }
+  }
+
+  return (AI_SPE_POSTPROCESS_ERROR_NO);
+}
+
+
 /* ----------------------       Exported routines      ---------------------- */
 
 int32_t spe_movenet_pp_reset(spe_movenet_pp_static_param_t *pInput_static_param)
@@ -74,3 +306,18 @@ int32_t spe_movenet_pp_process(spe_movenet_pp_in_t *pInput,
 
     return (error);
 }
+
+
+int32_t spe_movenet_pp_process_is8(spe_movenet_pp_in_int8_t *pInput,
+                                   spe_pp_out_t *pOutput,
+                                   spe_movenet_pp_static_param_t *pInput_static_param)
+{
+    int32_t error   = AI_SPE_POSTPROCESS_ERROR_NO;
+
+     /* Extracts max value and indexes of each quantized heatmap */
+    error = movenet_heatmap_max_is8(pInput,
+                                    pOutput,
+                                    pInput_static_param);
+
+    return (error);
+}
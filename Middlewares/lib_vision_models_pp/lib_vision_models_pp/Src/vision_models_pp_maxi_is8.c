@@ -306,7 +306,7 @@ void vision_models_maxi_tr_p_is8ou32(int8_t *arr, uint32_t len_arr, uint32_t off
       pArr+=offset;
 
     } // internal loop (max 256)
-    len_arr -= 256;
+    len_arr -= maxIter;
     // Compare according to global max to create p0
     p0 = vcmpgtq_m_s8(s8x16_blk_max_val, s8x16_max_val, p);
 
@@ -16,6 +16,7 @@ typedef enum {
   SCRL_ARGB8888,/* AKA st ABGR888 */
   SCRL_RGB888, /* AKA st BGR888 */
   SCRL_BGR888, /* AKA st RGB888 */
+  SCRL_MJPEG, /* UVCL screen only: composed in RGB565, then JPEG encoded */
   SCRL_FORMAT_NB
 } SCRL_Format;
 
@@ -72,5 +73,37 @@ int SCRL_ReloadLayer(SCRL_Layer layer);
  * return 0 in case of success else negative value is returned
  */
 int SRCL_Update(void);
+/* Size of the buffer given to SCRL_SetYuvCache() */
+#define SCRL_YUV_CACHE_SIZE(screen_width, screen_height) ((screen_width) * (screen_height) * 2 * 2)
+/* UVCL mode with YUV422 screen format only. Frames are converted into address, which is then sent over USB, and the
+ * rows of the layers identical to the previous frame are not converted again. The buffer also holds a copy of the
+ * previous RGB565 frame the rows are compared to. To be called after SCRL_Init() and
+ * before the first SRCL_Update().
+ *
+ * address : 4 bytes aligned buffer of SCRL_YUV_CACHE_SIZE() bytes, NULL to convert the screen buffer in place again
+ *
+ * return 0 in case of success else negative value is returned
+ */
+int SCRL_SetYuvCache(void *address);
+
+/* Size of each compressed frame buffer of SCRL_MjpegConfig, also the largest frame announced over USB */
+#define SCRL_MJPEG_BUFFER_SIZE(screen_width, screen_height) ((screen_width) * (screen_height))
+
+typedef struct {
+  void *mcu_buffer; /* screen width * screen height * 2 bytes */
+  void *jpeg_buffer[2]; /* SCRL_MJPEG_BUFFER_SIZE() bytes each: one is sent while the next frame is encoded in the other */
+  uint32_t bitrate; /* targeted bits per second, the quality following it. 0 for a fixed quality, lowered on overflow */
+  uint8_t quality; /* initial JPEG quality, 1 to 100 */
+} SCRL_MjpegConfig;
+
+/* UVCL mode with MJPEG screen format only, requires HAL_JPEG_MODULE_ENABLED and USE_HAL_JPEG_REGISTER_CALLBACKS.
+ * Screen width must be a multiple of 16 and height a multiple of 8. To be called after SCRL_Init() and before the first
+ * SRCL_Update().
+ *
+ * config : buffers and quality of the encoding
+ *
+ * return 0 in case of success else negative value is returned
+ */
+int SCRL_SetMjpegConfig(SCRL_MjpegConfig *config);
 
 #endif
@@ -331,6 +331,8 @@ static int get_bpp(SCRL_Format fmt)
     return 2;
   case SCRL_YUV422:
     return 2;
+  case SCRL_MJPEG:
+    return 2;
   case SCRL_BGR888:
     return 3;
   case SCRL_RGB888:
@@ -350,6 +352,9 @@ static uint32_t cvt_dma2d_pixel_format_output(SCRL_Format fmt)
   case SCRL_YUV422:
     /* We will do sw convertion from RGB565 to YUV422 */
     return DMA2D_OUTPUT_RGB565;
+  case SCRL_MJPEG:
+    /* We will do sw convertion from RGB565 to YCbCr MCUs, then hw encoding */
+    return DMA2D_OUTPUT_RGB565;
   default:
     assert(0);
   }
@@ -0,0 +1,52 @@
+#include "scrl_jpeg.h"
+
+#include "scrl_yuv.h"
+
+#define CLAMP(v, v_min, v_max) do { \
+  v = v < v_min ? v_min : v; \
+  v = v > v_max ? v_max : v; \
+} while (0)
+
+void SCRJ_Cvt_Rgb565_To_Mcu(uint8_t *p_mcu, uint8_t *p_src, int stride, int width, int height)
+{
+  uint8_t yuyv[SCRJ_MCU_WIDTH * 2];
+  int x, y, l, i;
+
+  for (y = 0; y < height; y += SCRJ_MCU_HEIGHT) {
+    for (x = 0; x < width; x += SCRJ_MCU_WIDTH) {
+      for (l = 0; l < SCRJ_MCU_HEIGHT; l++) {
+        SCRY_Cvt_Rgb565_To_Yuv422_Row(yuyv, p_src + (y + l) * stride + x * 2, SCRJ_MCU_WIDTH);
+        for (i = 0; i < 8; i++) {
+          p_mcu[l * 8 + i] = yuyv[2 * i];
+          p_mcu[64 + l * 8 + i] = yuyv[16 + 2 * i];
+          p_mcu[128 + l * 8 + i] = yuyv[4 * i + 1];
+          p_mcu[192 + l * 8 + i] = yuyv[4 * i + 3];
+        }
+      }
+      p_mcu += SCRJ_MCU_SIZE;
+    }
+  }
+}
+
+/* Steps toward the targeted frame size, larger when far from it. A frame that did not fit lowers the quality even
+ * without target, never below SCRJ_QUALITY_MIN unless it already was
+ */
+uint32_t SCRJ_Adapt_Quality(uint32_t quality, uint32_t size, uint32_t target_size, int is_overflow)
+{
+  int q = quality;
+
+  if (is_overflow)
+    q -= 16;
+  else if (!target_size)
+    return quality;
+  else if (size > target_size + target_size / 8)
+    q -= size > 2 * target_size ? 8 : 2;
+  else if (size < target_size - target_size / 8)
+    q += size < target_size / 2 ? 4 : 1;
+
+  CLAMP(q, SCRJ_QUALITY_MIN, SCRJ_QUALITY_MAX);
+  if (is_overflow && q > (int) quality)
+    q = quality;
+
+  return q;
+}
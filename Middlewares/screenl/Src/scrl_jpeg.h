@@ -0,0 +1,23 @@
+#ifndef _SCRL_JPEG_
+#define _SCRL_JPEG_
+
+#include <stdint.h>
+
+/* 16x8 pixels YCbCr 4:2:2 MCU: two 8x8 luma blocks, then one 8x8 block for each chroma */
+#define SCRJ_MCU_WIDTH 16
+#define SCRJ_MCU_HEIGHT 8
+#define SCRJ_MCU_SIZE 256
+/* Quality range of the bitrate control */
+#define SCRJ_QUALITY_MIN 10
+#define SCRJ_QUALITY_MAX 90
+
+/* Whole RGB565 frame into 4:2:2 MCUs, in raster order, as read by the JPEG codec. SCRY_Init() must have been called.
+ * width must be a multiple of 16 and height a multiple of 8.
+ */
+void SCRJ_Cvt_Rgb565_To_Mcu(uint8_t *p_mcu, uint8_t *p_src, int stride, int width, int height);
+/* Next quality of the bitrate control, from the size of the last frame encoded at quality. A frame that did not fit in
+ * its buffer has is_overflow set. target_size of 0 keeps a fixed quality, only lowered by the frames that do not fit.
+ */
+uint32_t SCRJ_Adapt_Quality(uint32_t quality, uint32_t size, uint32_t target_size, int is_overflow);
+
+#endif
@@ -148,9 +148,9 @@ static int SCRL_validate_parameters(SCRL_LayerConfig *layers_config[SCRL_LAYER_N
     if (!layers_config[i]->address)
       return -1;
 
-  /* SCRL_YUV422 format is not supported */
+  /* SCRL_YUV422 and SCRL_MJPEG formats are not supported */
   for (i = 0; i < SCRL_LAYER_NB; i++)
-    if (layers_config[i]->format == SCRL_YUV422)
+    if (layers_config[i]->format == SCRL_YUV422 || layers_config[i]->format == SCRL_MJPEG)
       return -1;
 
   return 0;
@@ -3,6 +3,7 @@
 #include <assert.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "stm32n6xx_hal.h"
 #include "stm32_lcd.h"
@@ -16,6 +17,8 @@
 #endif
 #include "uvcl.h"
 #include "scrl_common.h"
+#include "scrl_yuv.h"
+#include "scrl_jpeg.h"
 
 #define container_of(ptr, type, member) (type *) ((unsigned char *)ptr - offsetof(type,member))
 
@@ -23,30 +26,40 @@
 #define MIN(a, b)  (((a) < (b)) ? (a) : (b))
 #endif /* MIN */
 
-#define CLAMP(v, v_min, v_max) do { \
-  v = v < v_min ? v_min : v; \
-  v = v > v_max ? v_max : v; \
-} while (0)
-
-#define RGB_2_Y(r, g, b, y) do { \
-  y = SCRU_RED_Y_LUT[r] + SCRU_GREEN_Y_LUT[g] + SCRU_BLUE_Y_LUT[b]; \
-  CLAMP(y, 0, 255); \
-} while(0)
-
-#define RGB_2_CR(r, g, b, cr) do { \
-  cr = SCRU_BLUE_CB_RED_CR_LUT[r] + SCRU_GREEN_CR_LUT[g] + SCRU_BLUE_CR_LUT[b] + 128; \
-  CLAMP(cr, 0, 255); \
-} while(0)
+/* The codec callbacks are registered through the handle, the HAL weak ones are left to the application */
+#if defined(HAL_JPEG_MODULE_ENABLED) && (USE_HAL_JPEG_REGISTER_CALLBACKS == 1)
+#define SCRU_USE_MJPEG
+#endif
 
-#define RGB_2_CB(r, g, b, cb) do { \
-  cb = SCRU_RED_CB_LUT[r] + SCRU_GREEN_CB_LUT[g] + SCRU_BLUE_CB_RED_CR_LUT[b] + 128; \
-  CLAMP(cb, 0, 255); \
-} while(0)
+#ifdef SCRU_USE_MJPEG
+struct scrl_mjpeg_ctx {
+  JPEG_HandleTypeDef hjpeg;
+  uint8_t *mcu_buffer;
+  uint8_t *jpeg_buffer[2];
+  int is_jpeg_sending[2];
+  /* buffer being encoded into, -1 when the codec is idle */
+  int jpeg_idx;
+  uint32_t jpeg_size;
+  int is_overflow;
+  /* 0 for a fixed quality */
+  uint32_t frame_target_size;
+  uint32_t quality;
+  uint32_t codec_quality;
+};
+#endif
 
 struct scrl_usb_ctx {
   struct scrl_common_ctx common;
   struct uvcl_callbacks usb_cbs;
   int is_screen_ready_to_update;
+  /* YUV422 frame sent over USB when set, see SCRL_SetYuvCache() */
+  uint8_t *yuv_cache;
+  /* previous RGB565 frame, rows compared to find the changed ones */
+  uint8_t *prev_frame;
+  int is_yuv_cache_valid;
+#ifdef SCRU_USE_MJPEG
+  struct scrl_mjpeg_ctx mjpeg;
+#endif
 #ifdef SCR_LIB_USE_THREADX
   TX_SEMAPHORE update_sem;
   TX_SEMAPHORE dma2d_sem;
@@ -61,15 +74,6 @@ struct scrl_usb_ctx {
 #endif
 };
 
-static int32_t SCRU_RED_Y_LUT[256];
-static int32_t SCRU_RED_CB_LUT[256];
-static int32_t SCRU_BLUE_CB_RED_CR_LUT[256];
-static int32_t SCRU_GREEN_Y_LUT[256];
-static int32_t SCRU_GREEN_CR_LUT[256];
-static int32_t SCRU_GREEN_CB_LUT[256];
-static int32_t SCRU_BLUE_Y_LUT[256];
-static int32_t SCRU_BLUE_CR_LUT[256];
-
 static struct scrl_usb_ctx scrl_ctx;
 #ifdef SCR_LIB_USE_THREADX
 static uint8_t update_thread_stack[4096];
@@ -85,6 +89,8 @@ static int cvt_uvcl_payload_format(SCRL_Format fmt)
     return UVCL_PAYLOAD_FB_RGB565;
   case SCRL_YUV422:
     return UVCL_PAYLOAD_UNCOMPRESSED_YUY2;
+  case SCRL_MJPEG:
+    return UVCL_PAYLOAD_JPEG;
   default:
     assert(0);
   }
@@ -101,6 +107,8 @@ static int get_bpp(SCRL_Format fmt)
     return 2;
   case SCRL_YUV422:
     return 2;
+  case SCRL_MJPEG:
+    return 2;
   case SCRL_BGR888:
     return 3;
   case SCRL_RGB888:
@@ -117,60 +125,6 @@ static int get_screen_buffer_size(struct scrl_common_ctx *ctx)
   return ctx->screen.size.width * ctx->screen.size.height * get_bpp(ctx->screen.format);
 }
 
-static void SCRU_cvt_dual_pel_rgb_to_yuv(uint8_t *r, uint8_t *g, uint8_t *b, int32_t *y, int32_t *cb, int32_t *cr)
-{
-  uint8_t red, green, blue;
-
-  RGB_2_Y(r[0], g[0], b[0], y[0]);
-  RGB_2_Y(r[1], g[1], b[1], y[1]);
-
-  red = (r[0] + r[1] + 1) / 2;
-  green = (g[0] + g[1] + 1) / 2;
-  blue = (b[0] + b[1] + 1) / 2;
-
-  RGB_2_CR(red, green, blue, cr[0]);
-  RGB_2_CB(red, green, blue, cb[0]);
-}
-
-static void SCRU_cvt_rgb565_to_yuv422_internal(uint8_t *p_dst, uint8_t *p_src, int width, int height)
-{
-  uint32_t *p_src_dual_rgb565 = (uint32_t *)p_src;
-  int32_t luma[2];
-  int32_t cb, cr;
-  uint8_t b[2];
-  uint8_t g[2];
-  uint8_t r[2];
-  int x, y;
-
-  for (y = 0; y < height; y++)
-  {
-    for (x = 0; x < width; x += 2)
-    {
-      uint32_t p = p_src_dual_rgb565[x / 2];
-
-      b[0] = (p >> 0) & 0x1f;
-      b[0] = (b[0] << 3) | (b[0] >> 2);
-      g[0] = (p >> 5) & 0x3f;
-      g[0] = (g[0] << 2) | (g[0] >> 4);
-      r[0] = (p >> 11) & 0x1f;
-      r[0] = (r[0] << 3) | (r[0] >> 2);
-      b[1] = (p >> 16) & 0x1f;
-      b[1] = (b[1] << 3) | (b[1] >> 2);
-      g[1] = (p >> 21) & 0x3f;
-      g[1] = (g[1] << 2) | (g[1] >> 4);
-      r[1] = (p >> 27) & 0x1f;
-      r[1] = (r[1] << 3) | (r[1] >> 2);
-
-      SCRU_cvt_dual_pel_rgb_to_yuv(r, g, b, luma, &cb, &cr);
-      *p_dst++ = luma[0];
-      *p_dst++ = cb;
-      *p_dst++ = luma[1];
-      *p_dst++ = cr;
-    }
-    p_src_dual_rgb565 += width / 2;
-  }
-}
-
 static void SCRU_cvt_rgb565_to_yuv422(struct scrl_common_ctx  *ctx_common)
 {
   /* only convert layers area */
@@ -185,18 +139,160 @@ static void SCRU_cvt_rgb565_to_yuv422(struct scrl_common_ctx  *ctx_common)
   buffer += y * stride + x * 2;
 
   for (r = 0; r < height; r++) {
-    SCRU_cvt_rgb565_to_yuv422_internal(buffer, buffer, width, 1);
+    SCRY_Cvt_Rgb565_To_Yuv422_Row(buffer, buffer, width);
     buffer += stride;
   }
 }
 
+/* Only the rows changed since the previous frame are converted into the cache, the other ones are already there */
+static void SCRU_cvt_rgb565_to_yuv422_cached(struct scrl_usb_ctx *ctx)
+{
+  struct scrl_common_ctx *ctx_common = &ctx->common;
+  int stride = ctx_common->screen.size.width * 2;
+  int height = ctx_common->layers[0].size.height;
+  int width = ctx_common->layers[0].size.width;
+  int offset = ctx_common->layers[0].origin.y * stride + ctx_common->layers[0].origin.x * 2;
+  uint8_t *buffer = (uint8_t *) ctx_common->screen.address + offset;
+
+  SCRY_Cvt_Rgb565_To_Yuv422_Changed(ctx->yuv_cache + offset, ctx->prev_frame + offset, buffer, stride, width, height,
+                                    ctx->is_yuv_cache_valid);
+  ctx->is_yuv_cache_valid = 1;
+}
+
+#ifdef SCRU_USE_MJPEG
+static int SCRU_mjpeg_buffer_size(struct scrl_common_ctx *ctx_common)
+{
+  return SCRL_MJPEG_BUFFER_SIZE(ctx_common->screen.size.width, ctx_common->screen.size.height);
+}
+
+/* Next composition once the codec is idle and a compressed frame buffer is not being sent */
+static void SCRU_mjpeg_update_ready(struct scrl_usb_ctx *ctx)
+{
+  struct scrl_mjpeg_ctx *mjpeg = &ctx->mjpeg;
+
+  if (mjpeg->jpeg_idx < 0 && (!mjpeg->is_jpeg_sending[0] || !mjpeg->is_jpeg_sending[1]))
+    ctx->is_screen_ready_to_update = 1;
+}
+
+static void SCRU_mjpeg_encode(struct scrl_usb_ctx *ctx)
+{
+  struct scrl_mjpeg_ctx *mjpeg = &ctx->mjpeg;
+  JPEG_ConfTypeDef conf;
+  int ret;
+
+  if (!mjpeg->mcu_buffer) {
+    ctx->is_screen_ready_to_update = 1;
+    return;
+  }
+
+  SCRJ_Cvt_Rgb565_To_Mcu(mjpeg->mcu_buffer, ctx->common.screen.address, ctx->common.screen.size.width * 2,
+                         ctx->common.screen.size.width, ctx->common.screen.size.height);
+
+  if (mjpeg->quality != mjpeg->codec_quality) {
+    conf.ColorSpace = JPEG_YCBCR_COLORSPACE;
+    conf.ChromaSubsampling = JPEG_422_SUBSAMPLING;
+    conf.ImageWidth = ctx->common.screen.size.width;
+    conf.ImageHeight = ctx->common.screen.size.height;
+    conf.ImageQuality = mjpeg->quality;
+    ret = HAL_JPEG_ConfigEncoding(&mjpeg->hjpeg, &conf);
+    assert(ret == HAL_OK);
+    mjpeg->codec_quality = mjpeg->quality;
+  }
+
+  mjpeg->jpeg_idx = mjpeg->is_jpeg_sending[0] ? 1 : 0;
+  mjpeg->jpeg_size = 0;
+  mjpeg->is_overflow = 0;
+  ret = HAL_JPEG_Encode_IT(&mjpeg->hjpeg, mjpeg->mcu_buffer, get_screen_buffer_size(&ctx->common),
+                           mjpeg->jpeg_buffer[mjpeg->jpeg_idx], SCRU_mjpeg_buffer_size(&ctx->common));
+  assert(ret == HAL_OK);
+}
+
+static void SCRU_jpeg_msp_init_cb(JPEG_HandleTypeDef *hjpeg)
+{
+  assert(hjpeg == &scrl_ctx.mjpeg.hjpeg);
+
+  __HAL_RCC_JPEG_CLK_ENABLE();
+  __HAL_RCC_JPEG_CLK_SLEEP_ENABLE();
+  __HAL_RCC_JPEG_FORCE_RESET();
+  __HAL_RCC_JPEG_RELEASE_RESET();
+
+  /* Same priority as USB: frame release and encoding end do not preempt each other */
+  HAL_NVIC_SetPriority(JPEG_IRQn, 6U, 0U);
+  HAL_NVIC_EnableIRQ(JPEG_IRQn);
+}
+
+static void SCRU_jpeg_get_data_cb(JPEG_HandleTypeDef *hjpeg, uint32_t NbEncodedData)
+{
+  struct scrl_usb_ctx *ctx = container_of(hjpeg, struct scrl_usb_ctx, mjpeg.hjpeg);
+
+  /* Whole frame given at once */
+  HAL_JPEG_ConfigInputBuffer(hjpeg, ctx->mjpeg.mcu_buffer, 0);
+}
+
+static void SCRU_jpeg_data_ready_cb(JPEG_HandleTypeDef *hjpeg, uint8_t *pDataOut, uint32_t OutDataLength)
+{
+  struct scrl_usb_ctx *ctx = container_of(hjpeg, struct scrl_usb_ctx, mjpeg.hjpeg);
+  struct scrl_mjpeg_ctx *mjpeg = &ctx->mjpeg;
+  uint32_t size = SCRU_mjpeg_buffer_size(&ctx->common);
+
+  mjpeg->jpeg_size += OutDataLength;
+  if (mjpeg->jpeg_size < size)
+    return;
+
+  /* Buffer full before the end of the frame: the rest is written over it and the frame is dropped */
+  mjpeg->is_overflow = 1;
+  mjpeg->jpeg_size = 0;
+  HAL_JPEG_ConfigOutputBuffer(hjpeg, pDataOut, size);
+}
+
+static void SCRU_jpeg_encode_cplt_cb(JPEG_HandleTypeDef *hjpeg)
+{
+  struct scrl_usb_ctx *ctx = container_of(hjpeg, struct scrl_usb_ctx, mjpeg.hjpeg);
+  struct scrl_mjpeg_ctx *mjpeg = &ctx->mjpeg;
+  int idx = mjpeg->jpeg_idx;
+  int ret;
+
+  mjpeg->quality = SCRJ_Adapt_Quality(mjpeg->quality, mjpeg->jpeg_size, mjpeg->frame_target_size,
+                                      mjpeg->is_overflow);
+  mjpeg->jpeg_idx = -1;
+  if (!mjpeg->is_overflow) {
+    ret = UVCL_ShowFrame(mjpeg->jpeg_buffer[idx], mjpeg->jpeg_size);
+    mjpeg->is_jpeg_sending[idx] = ret == 0;
+  }
+
+  SCRU_mjpeg_update_ready(ctx);
+}
+
+static void SCRU_jpeg_error_cb(JPEG_HandleTypeDef *hjpeg)
+{
+  struct scrl_usb_ctx *ctx = container_of(hjpeg, struct scrl_usb_ctx, mjpeg.hjpeg);
+
+  /* Frame dropped */
+  ctx->mjpeg.jpeg_idx = -1;
+  SCRU_mjpeg_update_ready(ctx);
+}
+#endif
+
 static void SCRU_uvcl_show_frame(struct scrl_usb_ctx *ctx)
 {
+  void *frame = ctx->common.screen.address;
   int ret;
 
-  if (ctx->common.screen.format == SCRL_YUV422)
+#ifdef SCRU_USE_MJPEG
+  if (ctx->common.screen.format == SCRL_MJPEG) {
+    /* Sent from HAL_JPEG_EncodeCpltCallback() */
+    SCRU_mjpeg_encode(ctx);
+    return;
+  }
+#endif
+
+  if (ctx->common.screen.format == SCRL_YUV422 && ctx->yuv_cache) {
+    SCRU_cvt_rgb565_to_yuv422_cached(ctx);
+    frame = ctx->yuv_cache;
+  } else if (ctx->common.screen.format == SCRL_YUV422) {
     SCRU_cvt_rgb565_to_yuv422(&ctx->common);
-  ret = UVCL_ShowFrame(ctx->common.screen.address, get_screen_buffer_size(&ctx->common));
+  }
+  ret = UVCL_ShowFrame(frame, get_screen_buffer_size(&ctx->common));
   if (ret)
     ctx->is_screen_ready_to_update = 1;
 }
@@ -288,6 +384,14 @@ static void usb_frame_release_cb(struct uvcl_callbacks *cbs, void *frame)
 {
   struct scrl_usb_ctx *ctx = container_of(cbs, struct scrl_usb_ctx, usb_cbs);
 
+#ifdef SCRU_USE_MJPEG
+  if (ctx->common.screen.format == SCRL_MJPEG) {
+    ctx->mjpeg.is_jpeg_sending[frame == ctx->mjpeg.jpeg_buffer[1]] = 0;
+    SCRU_mjpeg_update_ready(ctx);
+    return;
+  }
+#endif
+
   ctx->is_screen_ready_to_update = 1;
 }
 
@@ -324,6 +428,9 @@ static int is_output_format_valid(SCRL_Format fmt)
   switch (fmt) {
   case SCRL_RGB565:
   case SCRL_YUV422:
+#ifdef SCRU_USE_MJPEG
+  case SCRL_MJPEG:
+#endif
     return 1;
   default:
     return 0;
@@ -379,6 +486,11 @@ static int SCRU_validate_parameters(SCRL_LayerConfig *layers_config[SCRL_LAYER_N
   if (!is_output_format_valid(screen_config->format))
     return -1;
 
+  /* whole MCUs */
+  if (screen_config->format == SCRL_MJPEG &&
+      (screen_config->size.width % 16 || screen_config->size.height % 8))
+    return -1;
+
   return 0;
 }
 
@@ -414,24 +526,6 @@ static void SCRL_Init_freertos(struct scrl_usb_ctx *ctx)
 }
 #endif
 
-static void SCRL_Init_Lut()
-{
-  int i;
-
-  for (i = 0; i <= 255; i++)
-  {
-    SCRU_RED_Y_LUT[i]           = ((  ((int32_t) ((0.299 )  * (1L << 16)))  * i) + ((int32_t) 1 << (16 - 1))) >> 16 ;
-    SCRU_GREEN_Y_LUT[i]         = ((  ((int32_t) ((0.587 )  * (1L << 16)))  * i) + ((int32_t) 1 << (16 - 1))) >> 16 ;
-    SCRU_BLUE_Y_LUT[i]          = ((  ((int32_t) ((0.114 )  * (1L << 16)))  * i) + ((int32_t) 1 << (16 - 1))) >> 16 ;
-    SCRU_RED_CB_LUT[i]          = (((-((int32_t) ((0.1687 ) * (1L << 16)))) * i) + ((int32_t) 1 << (16 - 1))) >> 16 ;
-    SCRU_GREEN_CB_LUT[i]        = (((-((int32_t) ((0.3313 ) * (1L << 16)))) * i) + ((int32_t) 1 << (16 - 1))) >> 16 ;
-    /* BLUE_CB_LUT and RED_CR_LUT are identical */
-    SCRU_BLUE_CB_RED_CR_LUT[i]  = ((  ((int32_t) ((0.5 )    * (1L << 16)))  * i) + ((int32_t) 1 << (16 - 1))) >> 16 ;
-    SCRU_GREEN_CR_LUT[i]        = (((-((int32_t) ((0.4187 ) * (1L << 16)))) * i) + ((int32_t) 1 << (16 - 1))) >> 16 ;
-    SCRU_BLUE_CR_LUT[i]         = (((-((int32_t) ((0.0813 ) * (1L << 16)))) * i) + ((int32_t) 1 << (16 - 1))) >> 16 ;
-  }
-}
-
 int SCRL_Init(SCRL_LayerConfig *layers_config[SCRL_LAYER_NB], SCRL_ScreenConfig *screen_config)
 {
   struct scrl_usb_ctx *ctx = &scrl_ctx;
@@ -441,7 +535,7 @@ int SCRL_Init(SCRL_LayerConfig *layers_config[SCRL_LAYER_NB], SCRL_ScreenConfig
   if (ret)
     return ret;
 
-  SCRL_Init_Lut();
+  SCRY_Init();
 
   ret = SCRC_Init(layers_config, screen_config, &ctx->common);
   if (ret)
@@ -464,6 +558,78 @@ int SCRL_Init(SCRL_LayerConfig *layers_config[SCRL_LAYER_NB], SCRL_ScreenConfig
   return 0;
 }
 
+int SCRL_SetYuvCache(void *address)
+{
+  struct scrl_usb_ctx *ctx = &scrl_ctx;
+  int size = get_screen_buffer_size(&ctx->common);
+
+  if (ctx->common.screen.format != SCRL_YUV422)
+    return -1;
+  if (!ctx->is_screen_ready_to_update)
+    return -1;
+
+  ctx->yuv_cache = address;
+  ctx->is_yuv_cache_valid = 0;
+  if (!address)
+    return 0;
+
+  /* Outside of the layers area, what the screen buffer holds is sent as is */
+  memcpy(ctx->yuv_cache, ctx->common.screen.address, size);
+  ctx->prev_frame = ctx->yuv_cache + size;
+
+  return 0;
+}
+
+int SCRL_SetMjpegConfig(SCRL_MjpegConfig *config)
+{
+#ifdef SCRU_USE_MJPEG
+  struct scrl_usb_ctx *ctx = &scrl_ctx;
+  struct scrl_mjpeg_ctx *mjpeg = &ctx->mjpeg;
+  int ret;
+
+  if (ctx->common.screen.format != SCRL_MJPEG)
+    return -1;
+  if (!config || !config->mcu_buffer || !config->jpeg_buffer[0] || !config->jpeg_buffer[1])
+    return -1;
+  if (config->quality < JPEG_IMAGE_QUALITY_MIN || config->quality > JPEG_IMAGE_QUALITY_MAX)
+    return -1;
+  if (mjpeg->mcu_buffer)
+    return -1;
+
+  mjpeg->hjpeg.Instance = JPEG;
+  ret = HAL_JPEG_RegisterCallback(&mjpeg->hjpeg, HAL_JPEG_MSPINIT_CB_ID, SCRU_jpeg_msp_init_cb);
+  if (ret != HAL_OK)
+    return -1;
+  ret = HAL_JPEG_Init(&mjpeg->hjpeg);
+  if (ret != HAL_OK)
+    return -1;
+  /* Reset to the weak ones by HAL_JPEG_Init() */
+  ret = HAL_JPEG_RegisterCallback(&mjpeg->hjpeg, HAL_JPEG_ENCODE_CPLT_CB_ID, SCRU_jpeg_encode_cplt_cb);
+  ret |= HAL_JPEG_RegisterCallback(&mjpeg->hjpeg, HAL_JPEG_ERROR_CB_ID, SCRU_jpeg_error_cb);
+  ret |= HAL_JPEG_RegisterGetDataCallback(&mjpeg->hjpeg, SCRU_jpeg_get_data_cb);
+  ret |= HAL_JPEG_RegisterDataReadyCallback(&mjpeg->hjpeg, SCRU_jpeg_data_ready_cb);
+  if (ret != HAL_OK)
+    return -1;
+
+  mjpeg->jpeg_buffer[0] = config->jpeg_buffer[0];
+  mjpeg->jpeg_buffer[1] = config->jpeg_buffer[1];
+  mjpeg->is_jpeg_sending[0] = 0;
+  mjpeg->is_jpeg_sending[1] = 0;
+  mjpeg->jpeg_idx = -1;
+  mjpeg->quality = config->quality;
+  mjpeg->codec_quality = 0;
+  mjpeg->frame_target_size = 0;
+  if (config->bitrate && ctx->common.screen.fps)
+    mjpeg->frame_target_size = config->bitrate / 8 / ctx->common.screen.fps;
+  __DMB();
+  mjpeg->mcu_buffer = config->mcu_buffer;
+
+  return 0;
+#else
+  return -1;
+#endif
+}
+
 int SCRL_SetAddress_NoReload(void *address, SCRL_Layer layer)
 {
   struct scrl_usb_ctx *ctx = &scrl_ctx;
@@ -537,3 +703,10 @@ void USB1_OTG_HS_IRQHandler(void)
 {
   UVCL_IRQHandler();
 }
+
+#ifdef SCRU_USE_MJPEG
+void JPEG_IRQHandler(void)
+{
+  HAL_JPEG_IRQHandler(&scrl_ctx.mjpeg.hjpeg);
+}
+#endif
@@ -0,0 +1,217 @@
+#include "scrl_yuv.h"
+
+#include <string.h>
+
+#if defined(__ARM_FEATURE_MVE) && (__ARM_FEATURE_MVE & 1)
+#include <arm_mve.h>
+#define SCRY_USE_MVEI
+#endif
+
+#define CLAMP(v, v_min, v_max) do { \
+  v = v < v_min ? v_min : v; \
+  v = v > v_max ? v_max : v; \
+} while (0)
+
+#define RGB_2_Y(r, g, b, y) do { \
+  y = SCRY_RED_Y_LUT[r] + SCRY_GREEN_Y_LUT[g] + SCRY_BLUE_Y_LUT[b]; \
+  CLAMP(y, 0, 255); \
+} while(0)
+
+#define RGB_2_CR(r, g, b, cr) do { \
+  cr = SCRY_BLUE_CB_RED_CR_LUT[r] + SCRY_GREEN_CR_LUT[g] + SCRY_BLUE_CR_LUT[b] + 128; \
+  CLAMP(cr, 0, 255); \
+} while(0)
+
+#define RGB_2_CB(r, g, b, cb) do { \
+  cb = SCRY_RED_CB_LUT[r] + SCRY_GREEN_CB_LUT[g] + SCRY_BLUE_CB_RED_CR_LUT[b] + 128; \
+  CLAMP(cb, 0, 255); \
+} while(0)
+
+/* Same BT.601 coefficients as the LUTs, in Q15 */
+#define SCRY_Q15(c) ((int16_t) ((c) * (1L << 15) + ((c) < 0 ? -0.5 : 0.5)))
+
+static int32_t SCRY_RED_Y_LUT[256];
+static int32_t SCRY_RED_CB_LUT[256];
+static int32_t SCRY_BLUE_CB_RED_CR_LUT[256];
+static int32_t SCRY_GREEN_Y_LUT[256];
+static int32_t SCRY_GREEN_CR_LUT[256];
+static int32_t SCRY_GREEN_CB_LUT[256];
+static int32_t SCRY_BLUE_Y_LUT[256];
+static int32_t SCRY_BLUE_CR_LUT[256];
+
+void SCRY_Init(void)
+{
+  int i;
+
+  for (i = 0; i <= 255; i++)
+  {
+    SCRY_RED_Y_LUT[i]           = ((  ((int32_t) ((0.299 )  * (1L << 16)))  * i) + ((int32_t) 1 << (16 - 1))) >> 16 ;
+    SCRY_GREEN_Y_LUT[i]         = ((  ((int32_t) ((0.587 )  * (1L << 16)))  * i) + ((int32_t) 1 << (16 - 1))) >> 16 ;
+    SCRY_BLUE_Y_LUT[i]          = ((  ((int32_t) ((0.114 )  * (1L << 16)))  * i) + ((int32_t) 1 << (16 - 1))) >> 16 ;
+    SCRY_RED_CB_LUT[i]          = (((-((int32_t) ((0.1687 ) * (1L << 16)))) * i) + ((int32_t) 1 << (16 - 1))) >> 16 ;
+    SCRY_GREEN_CB_LUT[i]        = (((-((int32_t) ((0.3313 ) * (1L << 16)))) * i) + ((int32_t) 1 << (16 - 1))) >> 16 ;
+    /* BLUE_CB_LUT and RED_CR_LUT are identical */
+    SCRY_BLUE_CB_RED_CR_LUT[i]  = ((  ((int32_t) ((0.5 )    * (1L << 16)))  * i) + ((int32_t) 1 << (16 - 1))) >> 16 ;
+    SCRY_GREEN_CR_LUT[i]        = (((-((int32_t) ((0.4187 ) * (1L << 16)))) * i) + ((int32_t) 1 << (16 - 1))) >> 16 ;
+    SCRY_BLUE_CR_LUT[i]         = (((-((int32_t) ((0.0813 ) * (1L << 16)))) * i) + ((int32_t) 1 << (16 - 1))) >> 16 ;
+  }
+}
+
+static void SCRY_cvt_dual_pel_rgb_to_yuv(uint8_t *r, uint8_t *g, uint8_t *b, int32_t *y, int32_t *cb, int32_t *cr)
+{
+  uint8_t red, green, blue;
+
+  RGB_2_Y(r[0], g[0], b[0], y[0]);
+  RGB_2_Y(r[1], g[1], b[1], y[1]);
+
+  red = (r[0] + r[1] + 1) / 2;
+  green = (g[0] + g[1] + 1) / 2;
+  blue = (b[0] + b[1] + 1) / 2;
+
+  RGB_2_CR(red, green, blue, cr[0]);
+  RGB_2_CB(red, green, blue, cb[0]);
+}
+
+void SCRY_Cvt_Rgb565_To_Yuv422(uint8_t *p_dst, uint8_t *p_src, int width, int height)
+{
+  uint32_t *p_src_dual_rgb565 = (uint32_t *)p_src;
+  int32_t luma[2];
+  int32_t cb, cr;
+  uint8_t b[2];
+  uint8_t g[2];
+  uint8_t r[2];
+  int x, y;
+
+  for (y = 0; y < height; y++)
+  {
+    for (x = 0; x < width; x += 2)
+    {
+      uint32_t p = p_src_dual_rgb565[x / 2];
+
+      b[0] = (p >> 0) & 0x1f;
+      b[0] = (b[0] << 3) | (b[0] >> 2);
+      g[0] = (p >> 5) & 0x3f;
+      g[0] = (g[0] << 2) | (g[0] >> 4);
+      r[0] = (p >> 11) & 0x1f;
+      r[0] = (r[0] << 3) | (r[0] >> 2);
+      b[1] = (p >> 16) & 0x1f;
+      b[1] = (b[1] << 3) | (b[1] >> 2);
+      g[1] = (p >> 21) & 0x3f;
+      g[1] = (g[1] << 2) | (g[1] >> 4);
+      r[1] = (p >> 27) & 0x1f;
+      r[1] = (r[1] << 3) | (r[1] >> 2);
+
+      SCRY_cvt_dual_pel_rgb_to_yuv(r, g, b, luma, &cb, &cr);
+      *p_dst++ = luma[0];
+      *p_dst++ = cb;
+      *p_dst++ = luma[1];
+      *p_dst++ = cr;
+    }
+    p_src_dual_rgb565 += width / 2;
+  }
+}
+
+#ifdef SCRY_USE_MVEI
+/* Expand 8 RGB565 pixels to 8 bits per component */
+static void SCRY_unpack_rgb565_mve(uint16x8_t p, int16x8_t *r, int16x8_t *g, int16x8_t *b)
+{
+  uint16x8_t c;
+
+  c = vandq_u16(p, vdupq_n_u16(0x1f));
+  *b = vreinterpretq_s16_u16(vorrq_u16(vshlq_n_u16(c, 3), vshrq_n_u16(c, 2)));
+  c = vandq_u16(vshrq_n_u16(p, 5), vdupq_n_u16(0x3f));
+  *g = vreinterpretq_s16_u16(vorrq_u16(vshlq_n_u16(c, 2), vshrq_n_u16(c, 4)));
+  c = vshrq_n_u16(p, 11);
+  *r = vreinterpretq_s16_u16(vorrq_u16(vshlq_n_u16(c, 3), vshrq_n_u16(c, 2)));
+}
+
+/* Each product rounded as in the LUTs, results within 1 LSB of them */
+static uint16x8_t SCRY_dot_q15_mve(int16x8_t r, int16x8_t g, int16x8_t b, int16_t cr, int16_t cg, int16_t cb,
+                                   int16_t offset)
+{
+  int16x8_t v;
+
+  v = vaddq_s16(vqrdmulhq_n_s16(r, cr), vqrdmulhq_n_s16(g, cg));
+  v = vaddq_s16(v, vqrdmulhq_n_s16(b, cb));
+  v = vaddq_s16(v, vdupq_n_s16(offset));
+  v = vmaxq_s16(vminq_s16(v, vdupq_n_s16(255)), vdupq_n_s16(0));
+
+  return vreinterpretq_u16_s16(v);
+}
+
+/* 8 pixel pairs per iteration, the remaining pairs by the scalar version. p_dst may be p_src */
+static void SCRY_cvt_rgb565_to_yuv422_mve(uint8_t *p_dst, uint8_t *p_src, int width)
+{
+  int16x8_t r[2], g[2], b[2];
+  uint16x8x2_t yuyv;
+  uint16x8x2_t pel;
+  uint16x8_t cb, cr;
+  int i;
+
+  for (; width >= 16; width -= 16)
+  {
+    /* Even pixels in val[0], odd ones in val[1] */
+    pel = vld2q_u16((uint16_t *) p_src);
+    for (i = 0; i < 2; i++)
+      SCRY_unpack_rgb565_mve(pel.val[i], &r[i], &g[i], &b[i]);
+
+    yuyv.val[0] = SCRY_dot_q15_mve(r[0], g[0], b[0], SCRY_Q15(0.299), SCRY_Q15(0.587), SCRY_Q15(0.114), 0);
+    yuyv.val[1] = SCRY_dot_q15_mve(r[1], g[1], b[1], SCRY_Q15(0.299), SCRY_Q15(0.587), SCRY_Q15(0.114), 0);
+
+    /* Chroma of the pair average */
+    r[0] = vrhaddq_s16(r[0], r[1]);
+    g[0] = vrhaddq_s16(g[0], g[1]);
+    b[0] = vrhaddq_s16(b[0], b[1]);
+    cb = SCRY_dot_q15_mve(r[0], g[0], b[0], SCRY_Q15(-0.1687), SCRY_Q15(-0.3313), SCRY_Q15(0.5), 128);
+    cr = SCRY_dot_q15_mve(r[0], g[0], b[0], SCRY_Q15(0.5), SCRY_Q15(-0.4187), SCRY_Q15(-0.0813), 128);
+
+    /* Y0 Cb Y1 Cr */
+    yuyv.val[0] = vorrq_u16(yuyv.val[0], vshlq_n_u16(cb, 8));
+    yuyv.val[1] = vorrq_u16(yuyv.val[1], vshlq_n_u16(cr, 8));
+    vst2q_u16((uint16_t *) p_dst, yuyv);
+
+    p_src += 32;
+    p_dst += 32;
+  }
+
+  if (width)
+    SCRY_Cvt_Rgb565_To_Yuv422(p_dst, p_src, width, 1);
+}
+#endif
+
+void SCRY_Cvt_Rgb565_To_Yuv422_Row(uint8_t *p_dst, uint8_t *p_src, int width)
+{
+#ifdef SCRY_USE_MVEI
+  SCRY_cvt_rgb565_to_yuv422_mve(p_dst, p_src, width);
+#else
+  SCRY_Cvt_Rgb565_To_Yuv422(p_dst, p_src, width, 1);
+#endif
+}
+
+/* Bytes read by the conversion of a row: odd widths end with a whole pixel pair */
+static int SCRY_row_size(int width)
+{
+  return ((width + 1) / 2) * 4;
+}
+
+int SCRY_Cvt_Rgb565_To_Yuv422_Changed(uint8_t *p_dst, uint8_t *p_prev, uint8_t *p_src, int stride, int width,
+                                      int height, int is_prev_valid)
+{
+  int size = SCRY_row_size(width);
+  int nb = 0;
+  int r;
+
+  /* Compared as a whole, any change converts the row again */
+  for (r = 0; r < height; r++) {
+    if (!is_prev_valid || memcmp(p_src, p_prev, size)) {
+      SCRY_Cvt_Rgb565_To_Yuv422_Row(p_dst, p_src, width);
+      memcpy(p_prev, p_src, size);
+      nb++;
+    }
+    p_dst += stride;
+    p_prev += stride;
+    p_src += stride;
+  }
+
+  return nb;
+}
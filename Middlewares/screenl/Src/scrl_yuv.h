@@ -0,0 +1,19 @@
+#ifndef _SCRL_YUV_
+#define _SCRL_YUV_
+
+#include <stdint.h>
+
+/* BT.601 tables of the conversions, to be called once before them */
+void SCRY_Init(void);
+/* Scalar conversion of width x height pixels, also the reference of the Helium one. p_dst may be p_src */
+void SCRY_Cvt_Rgb565_To_Yuv422(uint8_t *p_dst, uint8_t *p_src, int width, int height);
+/* One row, with Helium when available. p_dst may be p_src */
+void SCRY_Cvt_Rgb565_To_Yuv422_Row(uint8_t *p_dst, uint8_t *p_src, int width);
+/* Rows of p_src that differ from p_prev are converted into p_dst and copied into p_prev, the other ones are left as
+ * they are. All rows are converted when is_prev_valid is 0. Buffers of stride bytes per row. Returns the number of
+ * rows converted.
+ */
+int SCRY_Cvt_Rgb565_To_Yuv422_Changed(uint8_t *p_dst, uint8_t *p_prev, uint8_t *p_src, int stride, int width,
+                                      int height, int is_prev_valid);
+
+#endif
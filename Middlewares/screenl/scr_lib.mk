@@ -7,6 +7,8 @@ SCR_LIB_REL_DIR := $(dir $(lastword $(MAKEFILE_LIST)))
 
 ifeq ($(SCR_LIB_SCREEN_ITF), UVCL)
 C_SOURCES_SCR_LIB += $(SCR_LIB_REL_DIR)Src/scrl_usb.c
+C_SOURCES_SCR_LIB += $(SCR_LIB_REL_DIR)Src/scrl_yuv.c
+C_SOURCES_SCR_LIB += $(SCR_LIB_REL_DIR)Src/scrl_jpeg.c
 C_SOURCES_SCR_LIB += $(SCR_LIB_REL_DIR)Src/scrl_common.c
 else ifeq ($(SCR_LIB_SCREEN_ITF), LTDC)
 C_SOURCES_SCR_LIB += $(SCR_LIB_REL_DIR)Src/scrl_lcd.c
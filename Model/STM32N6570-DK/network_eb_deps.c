@@ -0,0 +1,202 @@
+/**
+  ******************************************************************************
+  * @file    network_eb_deps.c
+  * @brief   Buffer dependencies of the epoch blocks of network.c (`LL_ATON_EpochBlockItems_Default()`)
+  ******************************************************************************
+  * Generated from network.c by Tools/gen_eb_deps.py, do not edit.
+  *
+  * Pure SW epoch blocks list every range they access, taken from their `*_sw_info`
+  * (tensors and quantization parameters). Epoch blob programs are not decoded:
+  * their writes are the buffers of their epochs in the buffer infos (`.epoch`),
+  * their reads only the tensors known to be consumed, so they are partial.
+  * The reads of a blob also list the parameter buffers of its convolutions, in
+  * the order of the operators (their `.epoch` is 0 in the buffer infos: they
+  * are assigned by operator number between the SW epochs). The weight prefetch
+  * warms the first ones.
+  ******************************************************************************
+  */
+
+#include "ll_aton_NN_interface.h"
+#include "ll_aton_platform.h"
+
+#define EB_RANGE(base, start, end)                                                                                     \
+  { ATON_LIB_PHYSICAL_TO_VIRTUAL_ADDR((uintptr_t)(base) + (start)),                                                    \
+    ATON_LIB_PHYSICAL_TO_VIRTUAL_ADDR((uintptr_t)(base) + (end)) }
+
+#define EB_DEPS(r, w, f)                                                                                               \
+  { .reads = (r), .writes = (w), .nr_reads = sizeof(r) / sizeof((r)[0]), .nr_writes = sizeof(w) / sizeof((w)[0]),    \
+    .flags = (f) }
+
+#define EB_SW_COMPLETE (EpochBlock_Deps_complete_reads | EpochBlock_Deps_complete_writes)
+
+/* Epoch blob 1 (epochs 1 to 58) */
+static const EpochBlock_MemRangeTypeDef eb0_reads[] = {
+  EB_RANGE(0x342e0000UL, 0, 110592),              /* Input_0_out_0 */
+  EB_RANGE(0x70380000UL, 3062096, 3062960),       /* Conv2D_7_weights */
+  EB_RANGE(0x70380000UL, 3043568, 3045872),       /* Conv2D_12_weights_inflated_580 */
+  EB_RANGE(0x70380000UL, 3064880, 3065393),       /* Conv2D_16_weights */
+  EB_RANGE(0x70380000UL, 3058288, 3059824),       /* Conv2D_19_weights */
+  EB_RANGE(0x70380000UL, 2968432, 2975344),       /* Conv2D_24_weights_inflated_582 */
+  EB_RANGE(0x70380000UL, 3045872, 3048176),       /* Conv2D_28_weights */
+  EB_RANGE(0x70380000UL, 3033200, 3036656),       /* Conv2D_31_weights */
+  EB_RANGE(0x70380000UL, 2947696, 2958064),       /* Conv2D_36_weights_inflated_584 */
+  EB_RANGE(0x70380000UL, 3036656, 3040112),       /* Conv2D_40_weights */
+  EB_RANGE(0x70380000UL, 3063728, 3064304),       /* Conv2D_46_weights */
+  EB_RANGE(0x70380000UL, 3040112, 3043568),       /* Conv2D_49_weights */
+  EB_RANGE(0x70380000UL, 2958064, 2968432),       /* Conv2D_54_weights_inflated_586 */
+  EB_RANGE(0x70380000UL, 3019888, 3024496),       /* Conv2D_58_weights */
+  EB_RANGE(0x70380000UL, 2989168, 2995312),       /* Conv2D_61_weights */
+  EB_RANGE(0x70380000UL, 2617456, 2631280),       /* Conv2D_66_weights_inflated_588 */
+  EB_RANGE(0x70380000UL, 2995312, 3007600),       /* Conv2D_70_weights, Conv2D_76_weights */
+  EB_RANGE(0x70380000UL, 2631280, 2645104),       /* Conv2D_81_weights_inflated_590 */
+  EB_RANGE(0x70380000UL, 3007600, 3013744),       /* Conv2D_85_weights */
+  EB_RANGE(0x70380000UL, 3061072, 3062096),       /* Conv2D_91_weights */
+  EB_RANGE(0x70380000UL, 3013744, 3019888),       /* Conv2D_94_weights */
+  EB_RANGE(0x70380000UL, 2645104, 2658928),       /* Conv2D_99_weights_inflated_592 */
+  EB_RANGE(0x70380000UL, 2797168, 2809456),       /* Conv2D_103_weights */
+  EB_RANGE(0x70380000UL, 2513008, 2537584),       /* Conv2D_106_weights */
+  EB_RANGE(0x70380000UL, 2304064, 2331712),       /* Conv2D_111_weights_inflated_594 */
+  EB_RANGE(0x70380000UL, 2414656, 2439244),       /* Conv2D_115_weights */
+  EB_RANGE(0x70380000UL, 2537584, 2562160),       /* Conv2D_121_weights */
+  EB_RANGE(0x70380000UL, 2331712, 2359360),       /* Conv2D_126_weights_inflated_596 */
+  EB_RANGE(0x70380000UL, 2439248, 2463836),       /* Conv2D_130_weights */
+  EB_RANGE(0x70380000UL, 2562160, 2586736),       /* Conv2D_136_weights */
+  EB_RANGE(0x70380000UL, 2359360, 2387008),       /* Conv2D_141_weights_inflated_598 */
+  EB_RANGE(0x70380000UL, 2463840, 2488428),       /* Conv2D_145_weights */
+  EB_RANGE(0x70380000UL, 3029104, 3033200),       /* Conv2D_151_weights */
+  EB_RANGE(0x70380000UL, 2488432, 2513008),       /* Conv2D_154_weights */
+  EB_RANGE(0x70380000UL, 2387008, 2414656),       /* Conv2D_159_weights_inflated_600 */
+  EB_RANGE(0x70380000UL, 2267200, 2304064),       /* Conv2D_163_weights */
+  EB_RANGE(0x70380000UL, 1866304, 1921600),       /* Conv2D_166_weights */
+  EB_RANGE(0x70380000UL, 2658928, 2686576),       /* Conv2D_166_mul_scale_326, Conv2D_166_off_bias_329 */
+  EB_RANGE(0x70380000UL, 2142784, 2184256),       /* Conv2D_171_weights_inflated_602 */
+  EB_RANGE(0x70380000UL, 2686576, 2714224),       /* Conv2D_171_mul_scale_335, Conv2D_171_off_bias_338 */
+  EB_RANGE(0x70380000UL, 1921600, 2032192),       /* Conv2D_175_weights, Conv2D_181_weights */
+  EB_RANGE(0x70380000UL, 2714224, 2741872),       /* Conv2D_181_mul_scale_350, Conv2D_181_off_bias_353 */
+  EB_RANGE(0x70380000UL, 2184256, 2225728),       /* Conv2D_186_weights_inflated_604 */
+  EB_RANGE(0x70380000UL, 2741872, 2769520),       /* Conv2D_186_mul_scale_359, Conv2D_186_off_bias_362 */
+  EB_RANGE(0x70380000UL, 2032192, 2142784),       /* Conv2D_190_weights, Conv2D_196_weights */
+  EB_RANGE(0x70380000UL, 2769520, 2797168),       /* Conv2D_196_mul_scale_377, Conv2D_196_off_bias_380 */
+  EB_RANGE(0x70380000UL, 2225728, 2267200),       /* Conv2D_201_weights_inflated_606 */
+  EB_RANGE(0x70380000UL, 2975344, 2989168),       /* Conv2D_201_mul_scale_386, Conv2D_201_off_bias_389 */
+  EB_RANGE(0x70380000UL, 1484800, 1576960),       /* Conv2D_205_weights */
+  EB_RANGE(0x70380000UL, 716800, 870400),         /* Conv2D_208_weights */
+  EB_RANGE(0x70380000UL, 2809456, 2832496),       /* Conv2D_208_mul_scale_404, Conv2D_208_off_bias_407 */
+  EB_RANGE(0x70380000UL, 1658944, 1728064),       /* Conv2D_213_weights_inflated_608 */
+  EB_RANGE(0x70380000UL, 2832496, 2855536),       /* Conv2D_213_mul_scale_413, Conv2D_213_off_bias_416 */
+  EB_RANGE(0x70380000UL, 870400, 1177600),        /* Conv2D_217_weights, Conv2D_223_weights */
+  EB_RANGE(0x70380000UL, 2855536, 2878576),       /* Conv2D_223_mul_scale_431, Conv2D_223_off_bias_434 */
+  EB_RANGE(0x70380000UL, 1728064, 1797184),       /* Conv2D_228_weights_inflated_610 */
+  EB_RANGE(0x70380000UL, 2878576, 2901616),       /* Conv2D_228_mul_scale_440, Conv2D_228_off_bias_443 */
+  EB_RANGE(0x70380000UL, 1177600, 1484800),       /* Conv2D_232_weights, Conv2D_238_weights */
+  EB_RANGE(0x70380000UL, 2901616, 2924656),       /* Conv2D_238_mul_scale_458, Conv2D_238_off_bias_461 */
+  EB_RANGE(0x70380000UL, 1797184, 1866304),       /* Conv2D_243_weights_inflated_612 */
+  EB_RANGE(0x70380000UL, 2924656, 2947696),       /* Conv2D_243_mul_scale_467, Conv2D_243_off_bias_470 */
+  EB_RANGE(0x70380000UL, 409600, 716800),         /* Conv2D_247_weights */
+  EB_RANGE(0x70380000UL, 0, 409600),              /* Conv2D_250_weights */
+  EB_RANGE(0x70380000UL, 2586736, 2617456),       /* Conv2D_250_mul_scale_485, Conv2D_250_off_bias_488 */
+  EB_RANGE(0x70380000UL, 1576960, 1658944),       /* Conv2D_254_weights */
+};
+static const EpochBlock_MemRangeTypeDef eb0_writes[] = {
+  EB_RANGE(0x34100000UL, 0, 884736),              /* Conv2D_24_zero_off_out_37 */
+  EB_RANGE(0x34270000UL, 0, 387072),
+  EB_RANGE(0x342e0000UL, 0, 442368),
+};
+
+/* Epoch 59: Resize_257 */
+static const EpochBlock_MemRangeTypeDef eb1_reads[] = {
+  EB_RANGE(0x342e0000UL, 211968, 214272),         /* Conv2D_254_off_bias_out_496 */
+  EB_RANGE(0x70380000UL, 3065536, 3065860),       /* roi, sizes, scales, quantization */
+};
+static const EpochBlock_MemRangeTypeDef eb1_writes[] = {
+  EB_RANGE(0x342e0000UL, 202752, 211968),         /* Resize_257_out_0 */
+};
+
+/* Epoch blob 60 (epochs 60 to 62) */
+static const EpochBlock_MemRangeTypeDef eb2_reads[] = {
+  EB_RANGE(0x342e0000UL, 202752, 211968),         /* Resize_257_out_0 */
+  EB_RANGE(0x70380000UL, 3024496, 3029104),       /* Conv2D_262_weights_inflated_614 */
+  EB_RANGE(0x70380000UL, 3052784, 3054832),       /* Conv2D_265_weights */
+};
+static const EpochBlock_MemRangeTypeDef eb2_writes[] = {
+  EB_RANGE(0x342e0000UL, 211968, 221184),         /* Add_258_out_0 */
+  EB_RANGE(0x342e0000UL, 239616, 248832),         /* Conv2D_262_off_bias_out_505 */
+  EB_RANGE(0x342e0000UL, 258048, 262656),         /* Relu_268_out_0 */
+};
+
+/* Epoch 63: Resize_269 */
+static const EpochBlock_MemRangeTypeDef eb3_reads[] = {
+  EB_RANGE(0x342e0000UL, 258048, 262656),         /* Relu_268_out_0 */
+  EB_RANGE(0x70380000UL, 3065472, 3065828),       /* roi, sizes, scales, quantization */
+};
+static const EpochBlock_MemRangeTypeDef eb3_writes[] = {
+  EB_RANGE(0x342e0000UL, 239616, 258048),         /* Resize_269_out_0 */
+};
+
+/* Epoch blob 64 (epochs 64 to 66) */
+static const EpochBlock_MemRangeTypeDef eb4_reads[] = {
+  EB_RANGE(0x342e0000UL, 239616, 258048),         /* Resize_269_out_0 */
+  EB_RANGE(0x70380000UL, 3048176, 3050480),       /* Conv2D_274_weights_inflated_616 */
+  EB_RANGE(0x70380000UL, 3062960, 3063728),       /* Conv2D_277_weights */
+};
+static const EpochBlock_MemRangeTypeDef eb4_writes[] = {
+  EB_RANGE(0x342e0000UL, 0, 32256),               /* Conv2D_274_off_bias_out_523, Relu_280_out_0 */
+  EB_RANGE(0x342e0000UL, 258048, 276480),         /* Add_270_out_0 */
+};
+
+/* Epoch 67: Resize_281 */
+static const EpochBlock_MemRangeTypeDef eb5_reads[] = {
+  EB_RANGE(0x342e0000UL, 18432, 32256),           /* Relu_280_out_0 */
+  EB_RANGE(0x70380000UL, 3065408, 3065796),       /* roi, sizes, scales, quantization */
+};
+static const EpochBlock_MemRangeTypeDef eb5_writes[] = {
+  EB_RANGE(0x34270000UL, 0, 55296),               /* Resize_281_out_0 */
+};
+
+/* Epoch blob 68 (epochs 68 to 73) */
+static const EpochBlock_MemRangeTypeDef eb6_reads[] = {
+  EB_RANGE(0x34270000UL, 0, 55296),               /* Resize_281_out_0 */
+  EB_RANGE(0x70380000UL, 3054832, 3056560),       /* Conv2D_286_weights_inflated_618 */
+  EB_RANGE(0x70380000UL, 3064304, 3064880),       /* Conv2D_289_weights */
+  EB_RANGE(0x70380000UL, 3056560, 3058288),       /* Conv2D_294_weights_inflated_620 */
+  EB_RANGE(0x70380000UL, 3050480, 3052784),       /* Conv2D_297_weights */
+  EB_RANGE(0x70380000UL, 3059824, 3061072),       /* Conv2D_301_weights */
+};
+static const EpochBlock_MemRangeTypeDef eb6_writes[] = {
+  EB_RANGE(0x342e0000UL, 0, 276480),
+};
+
+/* Epoch 74: Dequantize_306 */
+static const EpochBlock_MemRangeTypeDef eb7_reads[] = {
+  EB_RANGE(0x342e0000UL, 221184, 251136),         /* Sigmoid_304_out_0 */
+  EB_RANGE(0x70380000UL, 3065648, 3065764),       /* quantization */
+};
+static const EpochBlock_MemRangeTypeDef eb7_writes[] = {
+  EB_RANGE(0x342e0000UL, 0, 119808),              /* Dequantize_306_out_0 */
+};
+
+/* Epoch blob 75 (epochs 75 to 76) */
+static const EpochBlock_MemRangeTypeDef eb8_reads[] = {
+  EB_RANGE(0x342e0000UL, 0, 119808),              /* Dequantize_306_out_0 */
+};
+static const EpochBlock_MemRangeTypeDef eb8_writes[] = {
+  EB_RANGE(0x342e0000UL, 0, 119808),              /* Transpose_307_out_0 */
+};
+
+const EpochBlock_DepsTypeDef *LL_ATON_EpochBlockDeps_Default(void)
+{
+  static const EpochBlock_DepsTypeDef ll_aton_eb_deps_array[] = {
+    EB_DEPS(eb0_reads, eb0_writes, EpochBlock_Deps_NONE),
+    EB_DEPS(eb1_reads, eb1_writes, EB_SW_COMPLETE),
+    EB_DEPS(eb2_reads, eb2_writes, EpochBlock_Deps_NONE),
+    EB_DEPS(eb3_reads, eb3_writes, EB_SW_COMPLETE),
+    EB_DEPS(eb4_reads, eb4_writes, EpochBlock_Deps_NONE),
+    EB_DEPS(eb5_reads, eb5_writes, EB_SW_COMPLETE),
+    EB_DEPS(eb6_reads, eb6_writes, EpochBlock_Deps_NONE),
+    EB_DEPS(eb7_reads, eb7_writes, EB_SW_COMPLETE),
+    EB_DEPS(eb8_reads, eb8_writes, EpochBlock_Deps_NONE),
+    { 0 }, /* last (empty) epoch block */
+  };
+
+  return ll_aton_eb_deps_array;
+}
@@ -3,5 +3,6 @@
 stedgeai generate --model st_movenet_lightning_heatmaps_192_int8_pc.tflite --target stm32n6 --st-neural-art default@user_neuralart_STM32N6570-DK.json --input-data-type uint8
 cp st_ai_output/network.c STM32N6570-DK/
 cp st_ai_output/network_ecblobs.h STM32N6570-DK/
+python3 ../Tools/gen_eb_deps.py STM32N6570-DK/network.c -o STM32N6570-DK/network_eb_deps.c
 cp st_ai_output/network_atonbuf.xSPI2.raw STM32N6570-DK/network_data.xSPI2.bin
 arm-none-eabi-objcopy -I binary STM32N6570-DK/network_data.xSPI2.bin --change-addresses 0x70380000 -O ihex STM32N6570-DK/network_data.hex
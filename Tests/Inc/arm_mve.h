@@ -0,0 +1,250 @@
+/**
+ ******************************************************************************
+ * @file    arm_mve.h
+ * @brief   Host stand-in of the Helium (MVE) intrinsics: only those the tested
+ *          modules use, lane by lane in C
+ ******************************************************************************
+ * Built with -D__ARM_FEATURE_MVE=1, the Helium paths of the modules are then
+ * compiled and run on the host. Vectors are structures of 128 bits, the
+ * predicates hold one bit per byte as on target. Inactive lanes are neither
+ * read nor written, and are zeroed by the _z variants.
+ ******************************************************************************
+ */
+
+#ifndef ARM_MVE_H
+#define ARM_MVE_H
+
+#include <stdint.h>
+#include <string.h>
+
+typedef uint16_t mve_pred16_t;
+typedef struct { int8_t val[16]; } int8x16_t;
+typedef struct { uint8_t val[16]; } uint8x16_t;
+typedef struct { int16_t val[8]; } int16x8_t;
+typedef struct { uint16_t val[8]; } uint16x8_t;
+typedef struct { int32_t val[4]; } int32x4_t;
+typedef struct { uint32_t val[4]; } uint32x4_t;
+typedef struct { int64_t val[2]; } int64x2_t;
+/* Only declared by the vector types of arm_math_types.h */
+typedef struct { int8x16_t val[2]; } int8x16x2_t;
+typedef struct { int8x16_t val[4]; } int8x16x4_t;
+typedef struct { int16x8_t val[2]; } int16x8x2_t;
+typedef struct { int16x8_t val[4]; } int16x8x4_t;
+typedef struct { int32x4_t val[2]; } int32x4x2_t;
+typedef struct { int32x4_t val[4]; } int32x4x4_t;
+typedef struct { uint16x8_t val[2]; } uint16x8x2_t;
+
+/* Whether the lane `i` of `bytes` bytes is active */
+#define MVE_LANE_ACTIVE(p, i, bytes) (((p) >> ((i) * (bytes))) & 1)
+
+/* Tail predicates: the first `n` lanes active */
+static inline mve_pred16_t vctp8q(uint32_t n)
+{
+  return n >= 16 ? 0xffff : (mve_pred16_t) ((1u << n) - 1);
+}
+
+static inline mve_pred16_t vctp32q(uint32_t n)
+{
+  return n >= 4 ? 0xffff : (mve_pred16_t) ((1u << (4 * n)) - 1);
+}
+
+/* Contiguous loads and stores */
+static inline int8x16_t vld1q_z_s8(const int8_t *base, mve_pred16_t p)
+{
+  int8x16_t r;
+
+  for (int i = 0; i < 16; i++)
+    r.val[i] = MVE_LANE_ACTIVE(p, i, 1) ? base[i] : 0;
+  return r;
+}
+
+static inline void vst1q_p_s8(int8_t *base, int8x16_t v, mve_pred16_t p)
+{
+  for (int i = 0; i < 16; i++)
+  {
+    if (MVE_LANE_ACTIVE(p, i, 1))
+      base[i] = v.val[i];
+  }
+}
+
+static inline uint8x16_t vld1q_u8(const uint8_t *base)
+{
+  uint8x16_t r;
+
+  memcpy(r.val, base, sizeof(r.val));
+  return r;
+}
+
+static inline uint8x16_t vld1q_z_u8(const uint8_t *base, mve_pred16_t p)
+{
+  uint8x16_t r;
+
+  for (int i = 0; i < 16; i++)
+    r.val[i] = MVE_LANE_ACTIVE(p, i, 1) ? base[i] : 0;
+  return r;
+}
+
+static inline void vst1q_u8(uint8_t *base, uint8x16_t v)
+{
+  memcpy(base, v.val, sizeof(v.val));
+}
+
+static inline void vst1q_p_u8(uint8_t *base, uint8x16_t v, mve_pred16_t p)
+{
+  for (int i = 0; i < 16; i++)
+  {
+    if (MVE_LANE_ACTIVE(p, i, 1))
+      base[i] = v.val[i];
+  }
+}
+
+/* Interleaved loads and stores of two vectors: even elements in val[0], odd ones in val[1] */
+static inline uint16x8x2_t vld2q_u16(const uint16_t *base)
+{
+  uint16x8x2_t r;
+
+  for (int i = 0; i < 8; i++)
+  {
+    r.val[0].val[i] = base[2 * i];
+    r.val[1].val[i] = base[2 * i + 1];
+  }
+  return r;
+}
+
+static inline void vst2q_u16(uint16_t *base, uint16x8x2_t v)
+{
+  for (int i = 0; i < 8; i++)
+  {
+    base[2 * i] = v.val[0].val[i];
+    base[2 * i + 1] = v.val[1].val[i];
+  }
+}
+
+static inline uint16x8_t vdupq_n_u16(uint16_t a)
+{
+  uint16x8_t r;
+
+  for (int i = 0; i < 8; i++)
+    r.val[i] = a;
+  return r;
+}
+
+static inline int16x8_t vdupq_n_s16(int16_t a)
+{
+  int16x8_t r;
+
+  for (int i = 0; i < 8; i++)
+    r.val[i] = a;
+  return r;
+}
+
+static inline int16x8_t vreinterpretq_s16_u16(uint16x8_t a)
+{
+  int16x8_t r;
+
+  memcpy(r.val, a.val, sizeof(r.val));
+  return r;
+}
+
+static inline uint16x8_t vreinterpretq_u16_s16(int16x8_t a)
+{
+  uint16x8_t r;
+
+  memcpy(r.val, a.val, sizeof(r.val));
+  return r;
+}
+
+/* Lane by lane operations of 16-bit vectors */
+#define MVE_BINARY(name, type, expr) \
+  static inline type name(type a, type b) \
+  { \
+    for (int i = 0; i < 8; i++) \
+      a.val[i] = (expr); \
+    return a; \
+  }
+
+MVE_BINARY(vandq_u16, uint16x8_t, a.val[i] & b.val[i])
+MVE_BINARY(vorrq_u16, uint16x8_t, a.val[i] | b.val[i])
+MVE_BINARY(vaddq_s16, int16x8_t, (int16_t) (a.val[i] + b.val[i]))
+MVE_BINARY(vmaxq_s16, int16x8_t, a.val[i] > b.val[i] ? a.val[i] : b.val[i])
+MVE_BINARY(vminq_s16, int16x8_t, a.val[i] < b.val[i] ? a.val[i] : b.val[i])
+/* Rounding halving add: (a + b + 1) >> 1 without overflow */
+MVE_BINARY(vrhaddq_s16, int16x8_t, (int16_t) (((int32_t) a.val[i] + b.val[i] + 1) >> 1))
+
+static inline uint16x8_t vshlq_n_u16(uint16x8_t a, int imm)
+{
+  for (int i = 0; i < 8; i++)
+    a.val[i] = (uint16_t) (a.val[i] << imm);
+  return a;
+}
+
+static inline uint16x8_t vshrq_n_u16(uint16x8_t a, int imm)
+{
+  for (int i = 0; i < 8; i++)
+    a.val[i] >>= imm;
+  return a;
+}
+
+/* Saturating rounding doubling multiply returning the high half: sat((2 * a * b + (1 << 15)) >> 16) */
+static inline int16x8_t vqrdmulhq_n_s16(int16x8_t a, int16_t b)
+{
+  for (int i = 0; i < 8; i++)
+  {
+    int64_t v = (2 * (int64_t) a.val[i] * b + (1 << 15)) >> 16;
+
+    a.val[i] = v > INT16_MAX ? INT16_MAX : (int16_t) v;
+  }
+  return a;
+}
+
+/* a, a + imm, a + 2 * imm, a + 3 * imm */
+static inline uint32x4_t vidupq_n_u32(uint32_t a, int imm)
+{
+  uint32x4_t r;
+
+  for (int i = 0; i < 4; i++)
+    r.val[i] = a + i * imm;
+  return r;
+}
+
+static inline uint32x4_t vmulq_n_u32(uint32x4_t a, uint32_t b)
+{
+  for (int i = 0; i < 4; i++)
+    a.val[i] *= b;
+  return a;
+}
+
+/* Gathers and scatters of 8-, 16- and 32-bit elements zero-extended to 32-bit lanes, offsets in bytes */
+#define MVE_GATHER_OFFSET_Z_U32(name, type) \
+  static inline uint32x4_t name(const type *base, uint32x4_t offsets, mve_pred16_t p) \
+  { \
+    uint32x4_t r; \
+    for (int i = 0; i < 4; i++) \
+    { \
+      type v = 0; \
+      if (MVE_LANE_ACTIVE(p, i, 4)) \
+        memcpy(&v, (const uint8_t *) base + offsets.val[i], sizeof(v)); \
+      r.val[i] = v; \
+    } \
+    return r; \
+  }
+
+#define MVE_SCATTER_OFFSET_P_U32(name, type) \
+  static inline void name(type *base, uint32x4_t offsets, uint32x4_t values, mve_pred16_t p) \
+  { \
+    for (int i = 0; i < 4; i++) \
+    { \
+      type v = (type) values.val[i]; \
+      if (MVE_LANE_ACTIVE(p, i, 4)) \
+        memcpy((uint8_t *) base + offsets.val[i], &v, sizeof(v)); \
+    } \
+  }
+
+MVE_GATHER_OFFSET_Z_U32(vldrbq_gather_offset_z_u32, uint8_t)
+MVE_GATHER_OFFSET_Z_U32(vldrhq_gather_offset_z_u32, uint16_t)
+MVE_GATHER_OFFSET_Z_U32(vldrwq_gather_offset_z_u32, uint32_t)
+MVE_SCATTER_OFFSET_P_U32(vstrbq_scatter_offset_p_u32, uint8_t)
+MVE_SCATTER_OFFSET_P_U32(vstrhq_scatter_offset_p_u32, uint16_t)
+MVE_SCATTER_OFFSET_P_U32(vstrwq_scatter_offset_p_u32, uint32_t)
+
+#endif /* ARM_MVE_H */
@@ -0,0 +1,75 @@
+/**
+ ******************************************************************************
+ * @file    host_test.h
+ * @brief   Checks and timing of the host tests
+ ******************************************************************************
+ * Each test is a host executable returning 0 when all its checks pass. Run
+ * with the "bench" argument, it also reports its benchmarks.
+ ******************************************************************************
+ */
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+static int host_test_checks;
+static int host_test_failures;
+
+#define CHECK(cond) \
+  do { \
+    host_test_checks++; \
+    if (!(cond)) { \
+      host_test_failures++; \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+    } \
+  } while (0)
+
+#define CHECK_EQ(a, b) \
+  do { \
+    long long a_ = (long long) (a), b_ = (long long) (b); \
+    host_test_checks++; \
+    if (a_ != b_) { \
+      host_test_failures++; \
+      printf("%s:%d: check failed: %s == %s (%lld != %lld)\n", __FILE__, __LINE__, #a, #b, a_, b_); \
+    } \
+  } while (0)
+
+#define CHECK_NEAR(a, b, tol) \
+  do { \
+    double a_ = (double) (a), b_ = (double) (b); \
+    host_test_checks++; \
+    if (!(fabs(a_ - b_) <= (tol))) { \
+      host_test_failures++; \
+      printf("%s:%d: check failed: %s ~ %s (%g != %g +/- %g)\n", __FILE__, __LINE__, #a, #b, a_, b_, \
+             (double) (tol)); \
+    } \
+  } while (0)
+
+/* Whether the benchmarks are to be run */
+static inline int host_test_bench(int argc, char **argv)
+{
+  return argc > 1 && strcmp(argv[1], "bench") == 0;
+}
+
+/* Host monotonic time in nanoseconds */
+static inline uint64_t host_test_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+/* Prints the outcome of the checks, returns the exit code of the test */
+static inline int host_test_result(const char *name)
+{
+  printf("%s: %d checks, %d failed\n", name, host_test_checks, host_test_failures);
+  return host_test_failures != 0;
+}
+
+#endif /* HOST_TEST_H */
@@ -0,0 +1,18 @@
+/**
+ ******************************************************************************
+ * @file    mock_clock.h
+ * @brief   Mocked timestamp source of the latency trace, set by the test. One
+ *          clock per thread, for the concurrent producers
+ ******************************************************************************
+ */
+
+#ifndef MOCK_CLOCK_H
+#define MOCK_CLOCK_H
+
+#include <stdint.h>
+
+extern __thread uint32_t mock_clock;
+
+#define LATENCY_TRACE_GET_TS()        (mock_clock)
+
+#endif /* MOCK_CLOCK_H */
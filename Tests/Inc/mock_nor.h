@@ -0,0 +1,26 @@
+/**
+ ******************************************************************************
+ * @file    mock_nor.h
+ * @brief   Memory-mapped NOR of the model manager replaced by a test array,
+ *          small slots and arenas, simulated timestamps
+ ******************************************************************************
+ * The relocatable loader keeps 32-bit addresses: the test is linked without
+ * PIE so that all its static data lives below 4 GB.
+ ******************************************************************************
+ */
+
+#ifndef MOCK_NOR_H
+#define MOCK_NOR_H
+
+#include <stdint.h>
+
+extern uint8_t mock_nor[];
+
+#define MODEL_MANAGER_FLASH_BASE      ((uintptr_t) mock_nor)
+#define MODEL_MANAGER_SLOT_SIZE       (0x4000UL)
+#define MODEL_MANAGER_NB_SLOTS        6
+#define MODEL_MANAGER_EXEC_RAM_SIZE   2560
+#define MODEL_MANAGER_EXT_RAM_SIZE    1024
+#define MODEL_MANAGER_GET_TS()        (host_sim_get_ts())
+
+#endif /* MOCK_NOR_H */
@@ -0,0 +1,91 @@
+/**
+ ******************************************************************************
+ * @file    sim_network.h
+ * @brief   Synthetic networks for the ATON runtime on the host simulation
+ *          platform (LL_ATON_PLAT_HOST_SIM)
+ ******************************************************************************
+ * A synthetic network is an array of epoch blocks: pure SW blocks executing
+ * sim_network_sw_block(), which spins for SIM_NETWORK_SW_NS(eb), and epoch
+ * blobs, which the NPU stand-in completes after its modelled epoch controller
+ * latency. Its memory pools are described by its internal buffers.
+ ******************************************************************************
+ */
+
+#ifndef SIM_NETWORK_H
+#define SIM_NETWORK_H
+
+#include "host_test.h"
+#include "ll_aton_runtime.h"
+
+/* Epoch blocks */
+#define SIM_NETWORK_SW_EB(ns) \
+  { .end_epoch_block = sim_network_sw_block, .blob_address = (ns), \
+    .flags = EpochBlock_Flags_epoch_start | EpochBlock_Flags_epoch_end | EpochBlock_Flags_pure_sw }
+#define SIM_NETWORK_BLOB_EB(addr) \
+  { .blob_address = (addr), .wait_mask = 0, \
+    .flags = EpochBlock_Flags_epoch_start | EpochBlock_Flags_epoch_end | EpochBlock_Flags_pure_hw | \
+             EpochBlock_Flags_blob }
+#define SIM_NETWORK_LAST_EB { .flags = EpochBlock_Flags_last_eb }
+
+/* The blob address of a SW block is unused by the runtime: it holds the duration of the block */
+#define SIM_NETWORK_SW_NS(eb) ((eb)->blob_address)
+
+/* Buffer of a memory pool, [start, end) */
+#define SIM_NETWORK_BUFFER(buf_name, start, end) \
+  { .name = (buf_name), .addr_base = { .i = (start) }, .offset_start = 0, .offset_end = (end) - (start) }
+#define SIM_NETWORK_LAST_BUFFER { .name = NULL }
+
+static uint32_t sim_network_sw_blocks;
+
+static inline void sim_network_sw_block(const void *epoch_block)
+{
+  const EpochBlock_ItemTypeDef *eb = (const EpochBlock_ItemTypeDef *) epoch_block;
+  uint64_t end = host_test_ns() + SIM_NETWORK_SW_NS(eb);
+
+  sim_network_sw_blocks++;
+  while (host_test_ns() < end)
+    ;
+}
+
+static const LL_Buffer_InfoTypeDef sim_network_no_buffers[] = { SIM_NETWORK_LAST_BUFFER };
+
+/* Declares `NN_Instance_<name>` running the epoch blocks `ebs` with the memory pools described by `pools`, and
+ * `sim_network_<name>_inits` counting the network initializations */
+#define SIM_NETWORK_DECLARE(nn_name, ebs, pools) \
+  static uint32_t sim_network_##nn_name##_inits; \
+  static bool LL_ATON_EC_Network_Init_##nn_name(void) \
+  { \
+    sim_network_##nn_name##_inits++; \
+    return true; \
+  } \
+  static bool LL_ATON_EC_Inference_Init_##nn_name(void) { return true; } \
+  static LL_ATON_User_IO_Result_t LL_ATON_Set_User_Input_Buffer_##nn_name(uint32_t num, void *buffer, uint32_t size) \
+  { \
+    return LL_ATON_User_IO_WRONG_INDEX; \
+  } \
+  static void *LL_ATON_Get_User_Input_Buffer_##nn_name(uint32_t num) { return NULL; } \
+  static LL_ATON_User_IO_Result_t LL_ATON_Set_User_Output_Buffer_##nn_name(uint32_t num, void *buffer, \
+                                                                            uint32_t size) \
+  { \
+    return LL_ATON_User_IO_WRONG_INDEX; \
+  } \
+  static void *LL_ATON_Get_User_Output_Buffer_##nn_name(uint32_t num) { return NULL; } \
+  static const EpochBlock_ItemTypeDef *LL_ATON_EpochBlockItems_##nn_name(void) { return ebs; } \
+  static const LL_Buffer_InfoTypeDef *LL_ATON_Output_Buffers_Info_##nn_name(void) { return sim_network_no_buffers; } \
+  static const LL_Buffer_InfoTypeDef *LL_ATON_Input_Buffers_Info_##nn_name(void) { return sim_network_no_buffers; } \
+  static const LL_Buffer_InfoTypeDef *LL_ATON_Internal_Buffers_Info_##nn_name(void) { return pools; } \
+  static const NN_Interface_TypeDef NN_Interface_##nn_name = { \
+    .network_name = #nn_name, \
+    .ec_network_init = &LL_ATON_EC_Network_Init_##nn_name, \
+    .ec_inference_init = &LL_ATON_EC_Inference_Init_##nn_name, \
+    .input_setter = &LL_ATON_Set_User_Input_Buffer_##nn_name, \
+    .input_getter = &LL_ATON_Get_User_Input_Buffer_##nn_name, \
+    .output_setter = &LL_ATON_Set_User_Output_Buffer_##nn_name, \
+    .output_getter = &LL_ATON_Get_User_Output_Buffer_##nn_name, \
+    .epoch_block_items = &LL_ATON_EpochBlockItems_##nn_name, \
+    .output_buffers_info = &LL_ATON_Output_Buffers_Info_##nn_name, \
+    .input_buffers_info = &LL_ATON_Input_Buffers_Info_##nn_name, \
+    .internal_buffers_info = &LL_ATON_Internal_Buffers_Info_##nn_name}; \
+  LL_ATON_DECLARE_NAMED_NN_INSTANCE(nn_name, &NN_Interface_##nn_name)
+
+#endif /* SIM_NETWORK_H */
@@ -0,0 +1,25 @@
+/**
+ ******************************************************************************
+ * @file    stm32n6xx.h
+ * @brief   Host stand-in of the device header: only what the tested modules
+ *          use, the cycle counter is the mocked clock of the test
+ ******************************************************************************
+ */
+
+#ifndef STM32N6XX_H
+#define STM32N6XX_H
+
+#include <stdint.h>
+#include "stm32n6xx_hal.h"
+#include "mock_clock.h"
+
+typedef struct {
+  uint32_t CYCCNT;
+} DWT_Type;
+
+#define DWT ((DWT_Type *) &mock_clock)
+
+/* CPU clock, set by the test */
+extern uint32_t SystemCoreClock;
+
+#endif /* STM32N6XX_H */
@@ -0,0 +1,19 @@
+/**
+ ******************************************************************************
+ * @file    stm32n6xx_hal.h
+ * @brief   Host stand-in of the HAL: only what the tested modules use, the
+ *          tests provide the definitions
+ ******************************************************************************
+ */
+
+#ifndef STM32N6XX_HAL_H
+#define STM32N6XX_HAL_H
+
+#include <stdint.h>
+
+#define __IO volatile
+
+/* Millisecond tick, driven by the test */
+uint32_t HAL_GetTick(void);
+
+#endif /* STM32N6XX_HAL_H */
@@ -0,0 +1,138 @@
+/**
+ ******************************************************************************
+ * @file    stm32n6xx_ll_dma2d.h
+ * @brief   Host stand-in of the DMA2D LL driver: only the memory to memory
+ *          transfers the tested modules start
+ ******************************************************************************
+ * The registers are fields of `host_dma2d`, defined by the test. A started
+ * transfer is run by host_dma2d_transfer(), called by the test before the
+ * interrupt handler of the module: the destination is written and the
+ * transfer complete flag set, or only the transfer error flag when the test
+ * injects an error. As on target in M2M mode, the foreground color mode gives
+ * the pixel size.
+ ******************************************************************************
+ */
+
+#ifndef STM32N6XX_LL_DMA2D_H
+#define STM32N6XX_LL_DMA2D_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define LL_DMA2D_MODE_M2M             0x0U
+#define LL_DMA2D_INPUT_MODE_ARGB8888  0x0U
+#define LL_DMA2D_INPUT_MODE_RGB888    0x1U
+#define LL_DMA2D_INPUT_MODE_RGB565    0x2U
+#define LL_DMA2D_INPUT_MODE_L8        0x5U
+#define LL_DMA2D_OUTPUT_MODE_ARGB8888 0x0U
+#define LL_DMA2D_OUTPUT_MODE_RGB888   0x1U
+#define LL_DMA2D_OUTPUT_MODE_RGB565   0x2U
+
+#define HOST_DMA2D_FLAG_TC 0x1U
+#define HOST_DMA2D_FLAG_TE 0x2U
+#define HOST_DMA2D_FLAG_CE 0x4U
+
+typedef struct {
+  uint32_t mode;
+  uint32_t fg_addr;
+  uint32_t fg_offset;
+  uint32_t fg_color_mode;
+  uint32_t out_color_mode;
+  uint32_t out_addr;
+  uint32_t out_offset;
+  uint32_t pixels_per_line;
+  uint32_t lines;
+  uint32_t it;
+  uint32_t flags;
+  int started;
+  int inject_error;   /* Set by the test: the next transfer fails without writing */
+  int nb_transfers;
+} DMA2D_TypeDef;
+
+extern DMA2D_TypeDef host_dma2d;
+#define DMA2D (&host_dma2d)
+
+#define HOST_DMA2D_SET(name, field) \
+  static inline void name(DMA2D_TypeDef *dma2d, uint32_t value) \
+  { \
+    dma2d->field = value; \
+  }
+
+HOST_DMA2D_SET(LL_DMA2D_SetMode, mode)
+HOST_DMA2D_SET(LL_DMA2D_FGND_SetMemAddr, fg_addr)
+HOST_DMA2D_SET(LL_DMA2D_FGND_SetLineOffset, fg_offset)
+HOST_DMA2D_SET(LL_DMA2D_FGND_SetColorMode, fg_color_mode)
+HOST_DMA2D_SET(LL_DMA2D_SetOutputColorMode, out_color_mode)
+HOST_DMA2D_SET(LL_DMA2D_SetOutputMemAddr, out_addr)
+HOST_DMA2D_SET(LL_DMA2D_SetLineOffset, out_offset)
+HOST_DMA2D_SET(LL_DMA2D_SetNbrOfPixelsPerLines, pixels_per_line)
+HOST_DMA2D_SET(LL_DMA2D_SetNbrOfLines, lines)
+
+#define HOST_DMA2D_FLAG(flag, bit) \
+  static inline void LL_DMA2D_EnableIT_##flag(DMA2D_TypeDef *dma2d) \
+  { \
+    dma2d->it |= (bit); \
+  } \
+  static inline void LL_DMA2D_DisableIT_##flag(DMA2D_TypeDef *dma2d) \
+  { \
+    dma2d->it &= ~(bit); \
+  } \
+  static inline uint32_t LL_DMA2D_IsActiveFlag_##flag(DMA2D_TypeDef *dma2d) \
+  { \
+    return (dma2d->flags & (bit)) != 0; \
+  } \
+  static inline void LL_DMA2D_ClearFlag_##flag(DMA2D_TypeDef *dma2d) \
+  { \
+    dma2d->flags &= ~(bit); \
+  }
+
+HOST_DMA2D_FLAG(TC, HOST_DMA2D_FLAG_TC)
+HOST_DMA2D_FLAG(TE, HOST_DMA2D_FLAG_TE)
+HOST_DMA2D_FLAG(CE, HOST_DMA2D_FLAG_CE)
+
+static inline void LL_DMA2D_Start(DMA2D_TypeDef *dma2d)
+{
+  dma2d->started = 1;
+}
+
+/* Bytes per pixel of the foreground color modes */
+static inline uint32_t host_dma2d_pixel_size(uint32_t color_mode)
+{
+  switch (color_mode)
+  {
+  case LL_DMA2D_INPUT_MODE_ARGB8888:
+    return 4;
+  case LL_DMA2D_INPUT_MODE_RGB888:
+    return 3;
+  case LL_DMA2D_INPUT_MODE_RGB565:
+    return 2;
+  default:
+    return 1;
+  }
+}
+
+/* Runs the started transfer, addresses are those of the host below 4 GB (tests linked with -no-pie) */
+static inline void host_dma2d_transfer(DMA2D_TypeDef *dma2d)
+{
+  uint32_t bpp = host_dma2d_pixel_size(dma2d->fg_color_mode);
+  const uint8_t *src = (const uint8_t *) (uintptr_t) dma2d->fg_addr;
+  uint8_t *dst = (uint8_t *) (uintptr_t) dma2d->out_addr;
+
+  dma2d->started = 0;
+  dma2d->nb_transfers++;
+  if (dma2d->inject_error)
+  {
+    dma2d->inject_error = 0;
+    dma2d->flags |= HOST_DMA2D_FLAG_TE;
+    return;
+  }
+  for (uint32_t y = 0; y < dma2d->lines; y++)
+  {
+    memcpy(dst, src, dma2d->pixels_per_line * bpp);
+    src += (dma2d->pixels_per_line + dma2d->fg_offset) * bpp;
+    dst += (dma2d->pixels_per_line + dma2d->out_offset) * bpp;
+  }
+  dma2d->flags |= HOST_DMA2D_FLAG_TC;
+}
+
+#endif /* STM32N6XX_LL_DMA2D_H */
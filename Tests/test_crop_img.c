@@ -0,0 +1,266 @@
+/**
+ ******************************************************************************
+ * @file    test_crop_img.c
+ * @brief   Copy back-ends of the NN input crop (crop_img.c, crop_img_dma2d.c)
+ ******************************************************************************
+ * The memcpy, MVE and DMA2D back-ends must match a byte model of the crop
+ * over random odd widths, unaligned strides and buffers, and 1- to 4-byte
+ * pixels, without writing past the destination. The DMA2D back-end runs on
+ * the register stand-in of stm32n6xx_ll_dma2d.h: layouts it cannot transfer
+ * are refused, a transfer error is signalled to the caller without writing
+ * the destination. The test is also built with the Helium stand-in
+ * (arm_mve.h) as test_crop_img_mve. The benchmark times the NN input layouts
+ * of the application.
+ ******************************************************************************
+ */
+
+#include <stdlib.h>
+#include "host_test.h"
+#include "crop_img.h"
+#include "stm32n6xx_ll_dma2d.h"
+
+#define NB_RANDOM   3000
+#define MAX_WIDTH   97
+#define MAX_HEIGHT  13
+#define MAX_PADDING 37
+#define GUARD       0xA5
+#define SRC_SIZE    (MAX_HEIGHT * (MAX_WIDTH * 4 + MAX_PADDING) + 16)
+#define DST_SIZE    (MAX_HEIGHT * MAX_WIDTH * 4 + 64)
+
+#ifdef __ARM_FEATURE_MVE
+#define TEST_NAME "test_crop_img_mve"
+#else
+#define TEST_NAME "test_crop_img"
+#endif
+
+DMA2D_TypeDef host_dma2d;
+
+/* Addressed by the DMA2D stand-in through 32-bit registers: static, below 4 GB */
+static uint8_t src[SRC_SIZE];
+static uint8_t dst[DST_SIZE];
+static uint8_t expected[DST_SIZE];
+
+/* NN input layouts of the application, benchmark only */
+static uint8_t frame[256 * 768];
+static uint8_t nn_in[256 * 768];
+
+static uint32_t rng_state = 0x2545F491;
+
+static uint32_t rng(uint32_t n)
+{
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return rng_state % n;
+}
+
+/* Completion of the DMA2D back-end */
+static int nb_done;
+static int last_error;
+
+static void copy_done(void *arg, int error)
+{
+  CHECK(arg == &nb_done);
+  nb_done++;
+  last_error = error;
+}
+
+/* Expected destination: the first `width` pixels of each line, then the guard bytes untouched */
+static void model_crop(const uint8_t *in, uint32_t stride, uint32_t width, uint32_t height, uint32_t bpp,
+                       uint8_t *out)
+{
+  memset(out, GUARD, DST_SIZE);
+  for (uint32_t y = 0; y < height; y++)
+  {
+    for (uint32_t x = 0; x < width * bpp; x++)
+      out[y * width * bpp + x] = in[y * stride + x];
+  }
+}
+
+/* Back-end `backend` on `dst` + `dst_shift`, returns whether the destination matches the model */
+static int run_crop(int backend, const uint8_t *in, uint32_t stride, uint32_t width, uint32_t height, uint32_t bpp,
+                    uint32_t dst_shift)
+{
+  uint8_t *out = dst + dst_shift;
+
+  memset(dst, GUARD, sizeof(dst));
+  switch (backend)
+  {
+  case IMG_CROP_MEMCPY:
+    img_crop((uint8_t *) in, out, stride, width, height, bpp);
+    break;
+  case IMG_CROP_MVE:
+    img_crop_mve(in, out, stride, width, height, bpp);
+    break;
+  default:
+    nb_done = 0;
+    if (img_crop_dma2d_start(in, out, stride, width, height, bpp, copy_done, &nb_done) != 0)
+      return 0;
+    CHECK(img_crop_dma2d_busy());
+    CHECK(host_dma2d.started);
+    /* Single transfer, one interrupt */
+    host_dma2d_transfer(&host_dma2d);
+    img_crop_dma2d_irq_handler();
+    CHECK(!img_crop_dma2d_busy());
+    CHECK_EQ(nb_done, 1);
+    CHECK_EQ(last_error, 0);
+    CHECK_EQ(host_dma2d.it, 0);
+    break;
+  }
+  for (uint32_t i = 0; i < dst_shift; i++)
+  {
+    if (dst[i] != GUARD)
+      return 0;
+  }
+  return memcmp(dst + dst_shift, expected, DST_SIZE - dst_shift) == 0;
+}
+
+static void test_random(void)
+{
+  int failures[3] = { 0 }, dma2d_runs = 0, dma2d_refused = 0;
+
+  for (int n = 0; n < NB_RANDOM; n++)
+  {
+    uint32_t bpp = 1 + rng(4);
+    uint32_t width = 1 + rng(MAX_WIDTH);
+    uint32_t height = 1 + rng(MAX_HEIGHT);
+    /* A quarter without padding: the MVE back-end then copies the frame as one block */
+    uint32_t stride = width * bpp + (rng(4) == 0 ? 0 : rng(MAX_PADDING));
+    uint32_t src_shift = rng(16), dst_shift = rng(16);
+    const uint8_t *in = src + src_shift;
+
+    for (size_t i = 0; i < sizeof(src); i++)
+      src[i] = (uint8_t) rng(256);
+    model_crop(in, stride, width, height, bpp, expected);
+
+    failures[IMG_CROP_MEMCPY] += !run_crop(IMG_CROP_MEMCPY, in, stride, width, height, bpp, dst_shift);
+    failures[IMG_CROP_MVE] += !run_crop(IMG_CROP_MVE, in, stride, width, height, bpp, dst_shift);
+    /* The DMA2D line offset counts whole pixels */
+    if (stride % bpp == 0)
+    {
+      failures[IMG_CROP_DMA2D] += !run_crop(IMG_CROP_DMA2D, in, stride, width, height, bpp, dst_shift);
+      dma2d_runs++;
+    }
+    else
+    {
+      CHECK_EQ(img_crop_dma2d_start(in, dst, stride, width, height, bpp, copy_done, &nb_done), -1);
+      CHECK(!img_crop_dma2d_busy());
+      dma2d_refused++;
+    }
+  }
+  CHECK_EQ(failures[IMG_CROP_MEMCPY], 0);
+  CHECK_EQ(failures[IMG_CROP_MVE], 0);
+  CHECK_EQ(failures[IMG_CROP_DMA2D], 0);
+  CHECK(dma2d_runs > NB_RANDOM / 4 && dma2d_refused > NB_RANDOM / 10);
+}
+
+/* Odd widths of 3-byte pixels around the 16 and 32 bytes of the MVE loop, with the padding of the DCMIPP pitch */
+static void test_rgb888(void)
+{
+  for (uint32_t width = 1; width <= 33; width += 2)
+  {
+    uint32_t stride = (width * 3 + 15) & ~15u;
+
+    for (size_t i = 0; i < sizeof(src); i++)
+      src[i] = (uint8_t) rng(256);
+    model_crop(src, stride, width, MAX_HEIGHT, 3, expected);
+    CHECK(run_crop(IMG_CROP_MEMCPY, src, stride, width, MAX_HEIGHT, 3, 0));
+    CHECK(run_crop(IMG_CROP_MVE, src, stride, width, MAX_HEIGHT, 3, 0));
+    /* Transferred by the DMA2D when the pitch is a whole number of pixels, by the CPU otherwise */
+    if (stride % 3 == 0)
+    {
+      CHECK(run_crop(IMG_CROP_DMA2D, src, stride, width, MAX_HEIGHT, 3, 0));
+      CHECK_EQ(host_dma2d.fg_offset, (stride - width * 3) / 3);
+      CHECK_EQ(host_dma2d.out_offset, 0);
+      CHECK_EQ(host_dma2d.fg_color_mode, LL_DMA2D_INPUT_MODE_RGB888);
+    }
+    else
+    {
+      CHECK_EQ(img_crop_dma2d_start(src, dst, stride, width, MAX_HEIGHT, 3, copy_done, &nb_done), -1);
+    }
+  }
+}
+
+static void test_dma2d(void)
+{
+  const uint32_t width = 31, height = 7, stride = 33 * 2;
+
+  for (size_t i = 0; i < sizeof(src); i++)
+    src[i] = (uint8_t) rng(256);
+
+  /* A single copy in flight */
+  memset(dst, GUARD, sizeof(dst));
+  nb_done = 0;
+  CHECK_EQ(img_crop_dma2d_start(src, dst, stride, width, height, 2, copy_done, &nb_done), 0);
+  CHECK_EQ(img_crop_dma2d_start(src, dst, stride, width, height, 2, copy_done, &nb_done), -1);
+  host_dma2d_transfer(&host_dma2d);
+  img_crop_dma2d_irq_handler();
+  CHECK_EQ(nb_done, 1);
+
+  /* Transfer error: signalled to the caller, the destination is left to it and the next copy may start */
+  memset(dst, GUARD, sizeof(dst));
+  memset(expected, GUARD, sizeof(expected));
+  nb_done = 0;
+  CHECK_EQ(img_crop_dma2d_start(src, dst, stride, width, height, 2, copy_done, &nb_done), 0);
+  host_dma2d.inject_error = 1;
+  host_dma2d_transfer(&host_dma2d);
+  img_crop_dma2d_irq_handler();
+  CHECK_EQ(nb_done, 1);
+  CHECK_EQ(last_error, 1);
+  CHECK(!img_crop_dma2d_busy());
+  CHECK_EQ(host_dma2d.flags, 0);
+  CHECK(memcmp(dst, expected, sizeof(dst)) == 0);
+  model_crop(src, stride, width, height, 2, expected);
+  CHECK(run_crop(IMG_CROP_DMA2D, src, stride, width, height, 2, 0));
+
+  /* Pixel sizes without a color mode, lines longer than the DMA2D counts */
+  CHECK_EQ(img_crop_dma2d_start(src, dst, 5 * 8, 8, 1, 5, copy_done, &nb_done), -1);
+  CHECK_EQ(img_crop_dma2d_start(src, dst, 0x4000, 0x4000, 1, 1, copy_done, &nb_done), -1);
+  CHECK_EQ(img_crop_dma2d_start(src, dst, 0x10000 + 8, 8, 1, 1, copy_done, &nb_done), -1);
+  /* Stride shorter than the line */
+  CHECK_EQ(img_crop_dma2d_start(src, dst, 8, 8, 2, 2, copy_done, &nb_done), -1);
+  CHECK(!img_crop_dma2d_busy());
+}
+
+static void bench_layout(uint32_t width, uint32_t height, uint32_t bpp)
+{
+  const int nb_runs = 200;
+  uint32_t stride = (width * bpp + 15) & ~15u;
+  uint64_t best[2] = { UINT64_MAX, UINT64_MAX };
+
+  for (int r = 0; r < nb_runs; r++)
+  {
+    for (int b = IMG_CROP_MEMCPY; b <= IMG_CROP_MVE; b++)
+    {
+      uint64_t t0 = host_test_ns(), ns;
+
+      if (b == IMG_CROP_MEMCPY)
+        img_crop(frame, nn_in, stride, width, height, bpp);
+      else
+        img_crop_mve(frame, nn_in, stride, width, height, bpp);
+      ns = host_test_ns() - t0;
+      if (ns < best[b])
+        best[b] = ns;
+    }
+  }
+  printf("%ux%ux%u, pitch %u: memcpy %.1f us, mve %.1f us\n", width, height, bpp, stride, best[0] / 1e3,
+         best[1] / 1e3);
+}
+
+int main(int argc, char **argv)
+{
+  test_random();
+  test_rgb888();
+  test_dma2d();
+
+  if (host_test_bench(argc, argv))
+  {
+    /* MoveNet inputs: packed lines, and odd widths whose DCMIPP pitch is padded */
+    bench_layout(192, 192, 3);
+    bench_layout(256, 256, 3);
+    bench_layout(191, 192, 3);
+    bench_layout(255, 256, 3);
+  }
+
+  return host_test_result(TEST_NAME);
+}
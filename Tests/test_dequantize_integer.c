@@ -0,0 +1,245 @@
+/**
+ ******************************************************************************
+ * @file    test_dequantize_integer.c
+ * @brief   Direct int8 to float32 DequantizeLinear of the ATON software
+ *          fallback, dense and planar outputs
+ ******************************************************************************
+ * The output layout is the one described by the strides of the operator
+ * output, as generated for the network: dense in the input order (HWC) or one
+ * plane per channel (CHW) for a channel-first output. Both must match
+ * scale * (x - zero_point) written at the strided position of each element.
+ * The generic layer (node_convert) is only delivered in the target network
+ * runtime library: it is replaced here by a stub counting its calls, it must
+ * get all the other configurations without the output written.
+ ******************************************************************************
+ */
+
+#include <stdlib.h>
+#include "host_test.h"
+#include "ll_sw.h"
+#include "core_convert.h"
+
+void ll_sw_forward_dequantizelinear(void *sw_info_struct);
+
+/* Generic layer of the network runtime library */
+static uint32_t generic_calls;
+
+void node_convert(ai_node *pNode)
+{
+  generic_calls++;
+}
+
+/* Operator of a b x h x w x c NHWC int8 tensor */
+typedef struct {
+  Dequantizelinear_sw_info info;
+  float is;
+  int8_t izp;
+} Dequantize_t;
+
+static void dequantize_init(Dequantize_t *d, int8_t *in, float *out, int b, int h, int w, int c, int planar)
+{
+  Tensor_info *i = &d->info.general.input;
+  Tensor_info *o = &d->info.general.output;
+
+  memset(d, 0, sizeof(*d));
+  d->info.general.type = LL_SW_DEQUANTIZELINEAR;
+  i->dim.tensor_b = o->dim.tensor_b = b;
+  i->dim.tensor_h = o->dim.tensor_h = h;
+  i->dim.tensor_w = o->dim.tensor_w = w;
+  i->dim.tensor_c = o->dim.tensor_c = c;
+  i->dim.num_elem = o->dim.num_elem = b * h * w * c;
+  i->stride.c = 1;
+  i->stride.w = c;
+  i->stride.h = w * c;
+  i->stride.b = h * w * c;
+  i->mem.start_offset = (unsigned char *) in;
+  i->format.is_signed = true;
+  /* Strides in bytes, as generated */
+  o->stride.c = (planar ? h * w : 1) * sizeof(float);
+  o->stride.w = (planar ? 1 : c) * sizeof(float);
+  o->stride.h = (planar ? w : w * c) * sizeof(float);
+  o->stride.b = h * w * c * sizeof(float);
+  o->mem.start_offset = (unsigned char *) out;
+  o->format.is_signed = true;
+  d->is = 0.00390625f * 3;
+  d->izp = -9;
+  d->info.is.dim.num_elem = 1;
+  d->info.is.mem.start_offset = (unsigned char *) &d->is;
+  d->info.is.format.is_signed = true;
+  d->info.izp.dim.num_elem = 1;
+  d->info.izp.mem.start_offset = (unsigned char *) &d->izp;
+  d->info.izp.format.is_signed = true;
+}
+
+/* Reference: each element written at the position given by the output strides */
+static void model_dequantize(const Dequantize_t *d, const int8_t *in, float *out)
+{
+  const Tensor_info *i = &d->info.general.input;
+  const Tensor_info *o = &d->info.general.output;
+
+  for (uint32_t n = 0; n < i->dim.tensor_b; n++)
+    for (uint32_t y = 0; y < i->dim.tensor_h; y++)
+      for (uint32_t x = 0; x < i->dim.tensor_w; x++)
+        for (uint32_t k = 0; k < i->dim.tensor_c; k++)
+        {
+          int8_t q = in[n * i->stride.b + y * i->stride.h + x * i->stride.w + k * i->stride.c];
+          uint32_t offset = n * o->stride.b + y * o->stride.h + x * o->stride.w + k * o->stride.c;
+
+          out[offset / sizeof(float)] = d->is * (float) (q - d->izp);
+        }
+}
+
+#define MAX_ELEMS (2 * 48 * 48 * 17)
+
+static int8_t input[MAX_ELEMS];
+static float output[MAX_ELEMS + 1];
+static float expected[MAX_ELEMS];
+
+static void test_layouts(void)
+{
+  static const int sizes[] = { 1, 2, 3, 5, 7, 12, 48 };
+  static const int channels[] = { 1, 3, 4, 5, 13, 17 };
+  uint32_t cases = 0;
+
+  srand(12);
+  for (int i = 0; i < MAX_ELEMS; i++)
+    input[i] = i < 256 ? (int8_t) i : (int8_t) rand();
+  for (int planar = 0; planar <= 1; planar++)
+  {
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+      for (size_t k = 0; k < sizeof(channels) / sizeof(channels[0]); k++)
+      {
+        int h = sizes[s], w = sizes[(s * 3 + k) % (sizeof(sizes) / sizeof(sizes[0]))], c = channels[k];
+        int b = 1 + (s + k) % 2, n = b * h * w * c;
+        Dequantize_t d;
+
+        dequantize_init(&d, input, output, b, h, w, c, planar);
+        memset(output, 0x55, (n + 1) * sizeof(float));
+        model_dequantize(&d, input, expected);
+        generic_calls = 0;
+
+        ll_sw_forward_dequantizelinear(&d.info);
+        CHECK_EQ(generic_calls, 0);
+        /* Exact: one subtraction and one multiplication per element */
+        CHECK(memcmp(output, expected, n * sizeof(float)) == 0);
+        /* Nothing written past the output */
+        CHECK_EQ(((uint32_t *) output)[n], 0x55555555);
+        cases++;
+      }
+    }
+  }
+  CHECK(cases > 80);
+
+  /* Extreme input values and zero points */
+  for (int zp = -128; zp <= 127; zp += 255)
+  {
+    Dequantize_t d;
+
+    dequantize_init(&d, input, output, 1, 1, 256, 1, 0);
+    d.izp = (int8_t) zp;
+    d.is = 1.0f;
+    for (int i = 0; i < 256; i++)
+      input[i] = (int8_t) (i - 128);
+    ll_sw_forward_dequantizelinear(&d.info);
+    CHECK_NEAR(output[0], -128.0f - zp, 0.0f);
+    CHECK_NEAR(output[255], 127.0f - zp, 0.0f);
+  }
+}
+
+/* Configurations the fast path does not cover go to the generic layer, the output untouched */
+static void test_fallbacks(void)
+{
+  for (int variant = 0; variant < 7; variant++)
+  {
+    Dequantize_t d;
+
+    dequantize_init(&d, input, output, 1, 5, 7, 3, variant % 2);
+    switch (variant)
+    {
+    case 0:
+      d.info.general.input.format.is_signed = false;
+      break;
+    case 1:
+      /* Per-channel quantization */
+      d.info.is.dim.num_elem = 3;
+      break;
+    case 2:
+      d.info.izp.format.is_signed = false;
+      break;
+    case 3:
+      /* Input not channel-contiguous */
+      d.info.general.input.stride.c = 5 * 7;
+      d.info.general.input.stride.w = 1;
+      d.info.general.input.stride.h = 7;
+      break;
+    case 4:
+      /* Output rows padded */
+      d.info.general.output.stride.h += 16;
+      d.info.general.output.stride.b = 5 * d.info.general.output.stride.h;
+      break;
+    case 5:
+      /* Planar output with padded planes */
+      d.info.general.output.stride.c += 16;
+      break;
+    case 6:
+      /* Output width-major (CWH) */
+      d.info.general.output.stride.w = 5 * sizeof(float);
+      d.info.general.output.stride.h = sizeof(float);
+      break;
+    }
+    memset(output, 0x55, 5 * 7 * 3 * 2 * sizeof(float));
+    generic_calls = 0;
+
+    ll_sw_forward_dequantizelinear(&d.info);
+    CHECK_EQ(generic_calls, 1);
+    for (int i = 0; i < 5 * 7 * 3 * 2; i++)
+    {
+      if (((uint32_t *) output)[i] != 0x55555555)
+      {
+        CHECK_EQ(((uint32_t *) output)[i], 0x55555555);
+        break;
+      }
+    }
+  }
+}
+
+/* MoveNet heatmap output (48x48x13 and 48x48x17), against the strided reference */
+static void bench(void)
+{
+  static const int channels[] = { 13, 17 };
+  const int runs = 2000;
+
+  for (size_t k = 0; k < sizeof(channels) / sizeof(channels[0]); k++)
+  {
+    const double n = 48.0 * 48 * channels[k] * runs;
+
+    for (int planar = 0; planar <= 1; planar++)
+    {
+      uint64_t t0, fast_ns, model_ns;
+      Dequantize_t d;
+
+      dequantize_init(&d, input, output, 1, 48, 48, channels[k], planar);
+      t0 = host_test_ns();
+      for (int i = 0; i < runs; i++)
+        ll_sw_forward_dequantizelinear(&d.info);
+      fast_ns = host_test_ns() - t0;
+      t0 = host_test_ns();
+      for (int i = 0; i < runs; i++)
+        model_dequantize(&d, input, expected);
+      model_ns = host_test_ns() - t0;
+      printf("dequantize 48x48x%d %s: fast path %.2f ns, strided reference %.2f ns per element\n", channels[k],
+             planar ? "planar" : "dense ", fast_ns / n, model_ns / n);
+    }
+  }
+}
+
+int main(int argc, char **argv)
+{
+  test_layouts();
+  test_fallbacks();
+  if (host_test_bench(argc, argv))
+    bench();
+
+  return host_test_result("test_dequantize_integer");
+}
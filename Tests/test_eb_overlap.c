@@ -0,0 +1,237 @@
+/**
+ ******************************************************************************
+ * @file    test_eb_overlap.c
+ * @brief   Overlap of pure SW epoch blocks with the next epoch blob
+ *          (LL_ATON_RT_EB_OVERLAP) on the host simulation platform
+ ******************************************************************************
+ * The dependency check is exercised on synthetic ranges: disjoint, shared,
+ * sharing a cache line only, and partially described. A synthetic network
+ * then alternates SW blocks and blobs, the first SW block independent from
+ * the blob after it and the second one not: only the first pair may be run
+ * concurrently, which the order of the epoch callbacks and the inference
+ * time must show, and registering no dependencies must restore the strict
+ * order. A table is only valid for a network if it has one entry per epoch
+ * block and its ranges lie in the buffers of the network.
+ ******************************************************************************
+ */
+
+#include <string.h>
+#include "sim_network.h"
+#include "ll_aton_eb_deps.h"
+
+#define SW_NS 300000
+#define BLOB_NS 400000
+
+static const EpochBlock_ItemTypeDef pose_ebs[] = {
+  SIM_NETWORK_SW_EB(SW_NS),
+  SIM_NETWORK_BLOB_EB(0x34000000),
+  SIM_NETWORK_SW_EB(SW_NS),
+  SIM_NETWORK_BLOB_EB(0x34001000),
+  SIM_NETWORK_LAST_EB,
+};
+SIM_NETWORK_DECLARE(Pose, pose_ebs, sim_network_no_buffers);
+
+#define NB_EBS (sizeof(pose_ebs) / sizeof(pose_ebs[0]) - 1)
+
+/*
+ * SW block 0 reads [0x1000, 0x1100) and writes [0x2000, 0x2100), blob 1 reads [0x3000, 0x3400) and writes
+ * [0x4000, 0x4400): independent. SW block 2 writes what blob 3 reads.
+ */
+static const EpochBlock_MemRangeTypeDef sw0_reads[] = { { 0x1000, 0x1100 } };
+static const EpochBlock_MemRangeTypeDef sw0_writes[] = { { 0x2000, 0x2100 } };
+static const EpochBlock_MemRangeTypeDef blob1_reads[] = { { 0x3000, 0x3400 } };
+static const EpochBlock_MemRangeTypeDef blob1_writes[] = { { 0x4000, 0x4400 } };
+static const EpochBlock_MemRangeTypeDef sw2_reads[] = { { 0x4000, 0x4400 } };
+static const EpochBlock_MemRangeTypeDef sw2_writes[] = { { 0x5000, 0x5040 } };
+static const EpochBlock_MemRangeTypeDef blob3_reads[] = { { 0x5000, 0x5040 } };
+static const EpochBlock_MemRangeTypeDef blob3_writes[] = { { 0x6000, 0x6400 } };
+
+#define DEPS(r, w) { .reads = (r), .writes = (w), .nr_reads = 1, .nr_writes = 1, \
+                     .flags = EpochBlock_Deps_complete_reads | EpochBlock_Deps_complete_writes }
+
+static const EpochBlock_DepsTypeDef pose_deps[] = {
+  DEPS(sw0_reads, sw0_writes),
+  DEPS(blob1_reads, blob1_writes),
+  DEPS(sw2_reads, sw2_writes),
+  DEPS(blob3_reads, blob3_writes),
+  { 0 },
+};
+
+static void test_check(void)
+{
+  static const EpochBlock_MemRangeTypeDef r0[] = { { 0x1000, 0x1010 }, { 0x8000, 0x8100 } };
+  static const EpochBlock_MemRangeTypeDef r1[] = { { 0x1020, 0x1030 } };
+  static const EpochBlock_MemRangeTypeDef r2[] = { { 0x1010, 0x1018 } };
+  static const EpochBlock_MemRangeTypeDef r3[] = { { 0x80f0, 0x8200 } };
+  EpochBlock_DepsTypeDef a = DEPS(r0, r0), b = DEPS(r1, r1);
+  uintptr_t conflict;
+
+  a.nr_reads = a.nr_writes = 2;
+  CHECK_EQ(LL_ATON_EbDeps_Check(&a, &b, &conflict), LL_ATON_EB_DEPS_INDEPENDENT);
+  CHECK_EQ(conflict, 0);
+
+  /* Same cache line, different bytes */
+  b.reads = b.writes = r2;
+  CHECK_EQ(LL_ATON_EbDeps_Check(&a, &b, &conflict), LL_ATON_EB_DEPS_DEPENDENT);
+  CHECK_EQ(conflict, 0x1000);
+
+  /* Read after write in either direction, write after write */
+  b = (EpochBlock_DepsTypeDef) DEPS(r3, r1);
+  CHECK_EQ(LL_ATON_EbDeps_Check(&a, &b, &conflict), LL_ATON_EB_DEPS_DEPENDENT);
+  CHECK_EQ(conflict, 0x80e0);
+  CHECK_EQ(LL_ATON_EbDeps_Check(&b, &a, NULL), LL_ATON_EB_DEPS_DEPENDENT);
+  a.nr_writes = 1;
+  CHECK_EQ(LL_ATON_EbDeps_Check(&a, &b, NULL), LL_ATON_EB_DEPS_INDEPENDENT);
+  b = (EpochBlock_DepsTypeDef) DEPS(r1, r3);
+  CHECK_EQ(LL_ATON_EbDeps_Check(&a, &b, NULL), LL_ATON_EB_DEPS_DEPENDENT);
+
+  /* No conflict among the listed ranges is not enough when some are not listed */
+  b = (EpochBlock_DepsTypeDef) DEPS(r1, r1);
+  b.flags = EpochBlock_Deps_complete_writes;
+  CHECK_EQ(LL_ATON_EbDeps_Check(&a, &b, NULL), LL_ATON_EB_DEPS_UNKNOWN);
+  CHECK_EQ(LL_ATON_EbDeps_Check(&a, NULL, NULL), LL_ATON_EB_DEPS_UNKNOWN);
+}
+
+/* Memory pools holding every range of pose_deps, but the last write of blob 3 */
+static const LL_Buffer_InfoTypeDef pose_pools[] = {
+  SIM_NETWORK_BUFFER("sw_in", 0x1000, 0x1100),
+  SIM_NETWORK_BUFFER("blob_in", 0x3000, 0x3200),
+  SIM_NETWORK_BUFFER("blob_in_2", 0x3200, 0x3400),
+  SIM_NETWORK_BUFFER("pool", 0x2000, 0x6000),
+  SIM_NETWORK_BUFFER("out", 0x6000, 0x6200),
+  SIM_NETWORK_LAST_BUFFER,
+};
+SIM_NETWORK_DECLARE(Pools, pose_ebs, pose_pools);
+
+static void test_validate(void)
+{
+  static const EpochBlock_MemRangeTypeDef in_pools[] = { { 0x6000, 0x6200 } };
+  EpochBlock_DepsTypeDef deps[NB_EBS + 2];
+
+  /* A range beyond the buffers: blob 3 writes up to 0x6400 */
+  CHECK(!LL_ATON_EbDeps_Validate(NN_Instance_Pools.network, pose_deps));
+
+  memcpy(deps, pose_deps, sizeof(pose_deps));
+  deps[3].writes = in_pools;
+  CHECK(LL_ATON_EbDeps_Validate(NN_Instance_Pools.network, deps));
+
+  /* Not for this network: shorter, then longer than its epoch blocks */
+  deps[3] = (EpochBlock_DepsTypeDef) { 0 };
+  CHECK(!LL_ATON_EbDeps_Validate(NN_Instance_Pools.network, deps));
+  deps[3] = pose_deps[2];
+  deps[4] = pose_deps[2];
+  deps[5] = (EpochBlock_DepsTypeDef) { 0 };
+  CHECK(!LL_ATON_EbDeps_Validate(NN_Instance_Pools.network, deps));
+}
+
+static void test_analyze(void)
+{
+  static const uint32_t durations[NB_EBS] = { 300, 400, 300, 400 };
+  LL_ATON_EbDeps_Summary_t summary;
+
+  CHECK(LL_ATON_EbDeps_CanOverlapNext(pose_ebs, pose_deps, 0));
+  CHECK(!LL_ATON_EbDeps_CanOverlapNext(pose_ebs, pose_deps, 1));
+  CHECK(!LL_ATON_EbDeps_CanOverlapNext(pose_ebs, pose_deps, 2));
+  CHECK(!LL_ATON_EbDeps_CanOverlapNext(pose_ebs, NULL, 0));
+
+  CHECK_EQ(LL_ATON_EbDeps_Analyze(pose_ebs, pose_deps, durations, false, &summary), 1);
+  CHECK_EQ(summary.nr_epoch_blocks, NB_EBS);
+  CHECK_EQ(summary.nr_candidates, 2);
+  CHECK_EQ(summary.nr_independent, 1);
+  CHECK_EQ(summary.serial_ticks, 1400);
+  CHECK_EQ(summary.overlapped_ticks, 400 + 300 + 400);
+}
+
+/* Epoch callbacks in order, as (kind, epoch block index) */
+static int trace[64];
+static int trace_len;
+
+static void epoch_trace(LL_ATON_RT_Callbacktype_t ctype, const NN_Instance_TypeDef *nn_instance,
+                        const EpochBlock_ItemTypeDef *eb)
+{
+  if ((ctype == LL_ATON_RT_Callbacktype_PRE_START || ctype == LL_ATON_RT_Callbacktype_POST_END) &&
+      trace_len < (int) (sizeof(trace) / sizeof(trace[0])))
+    trace[trace_len++] = (ctype == LL_ATON_RT_Callbacktype_PRE_START ? 's' : 'e') << 8 | (int) (eb - pose_ebs);
+}
+
+static int trace_index(int kind, int eb)
+{
+  for (int i = 0; i < trace_len; i++)
+  {
+    if (trace[i] == (kind << 8 | eb))
+      return i;
+  }
+  return -1;
+}
+
+/* Shortest of a few inferences, in ns */
+static uint32_t run(LL_ATON_RT_Resident_TypeDef *resident, int runs)
+{
+  const LL_ATON_RT_ResidentStats_t *stats = LL_ATON_RT_Resident_GetStats(resident);
+
+  LL_ATON_RT_Resident_ResetStats(resident);
+  for (int i = 0; i < runs; i++)
+  {
+    trace_len = 0;
+    LL_ATON_RT_Resident_Run(resident);
+  }
+  return stats->min_inference_ticks;
+}
+
+static void test_runtime(int bench)
+{
+  LL_ATON_RT_Resident_TypeDef resident;
+  uint32_t blocks = sim_network_sw_blocks;
+  uint32_t serial_ns, overlapped_ns;
+
+  host_sim_set_latency(HOST_SIM_UNIT_EPOCHCTRL, BLOB_NS);
+  LL_ATON_RT_SetEpochCallback(epoch_trace, &NN_Instance_Pose);
+  LL_ATON_RT_Resident_Init(&resident, &NN_Instance_Pose);
+
+  serial_ns = run(&resident, 5);
+  /* Strict order */
+  CHECK_EQ(trace_len, 2 * NB_EBS);
+  for (int i = 0; i < (int) NB_EBS; i++)
+    CHECK(trace_index('s', i) == 2 * i && trace_index('e', i) == 2 * i + 1);
+  CHECK(serial_ns >= 2 * (SW_NS + BLOB_NS));
+
+  LL_ATON_RT_SetEpochBlockDeps(pose_deps, &NN_Instance_Pose);
+  overlapped_ns = run(&resident, 5);
+  /* Blob 1 started before SW block 0 runs, SW block 2 still ends before blob 3 starts */
+  CHECK_EQ(trace_len, 2 * NB_EBS);
+  CHECK(trace_index('s', 0) < trace_index('s', 1));
+  CHECK(trace_index('s', 1) < trace_index('e', 0));
+  CHECK(trace_index('e', 0) < trace_index('e', 1));
+  CHECK(trace_index('e', 1) < trace_index('s', 2));
+  CHECK(trace_index('e', 2) < trace_index('s', 3));
+  /* SW block 0 hidden behind blob 1 */
+  CHECK(overlapped_ns >= BLOB_NS + SW_NS + BLOB_NS);
+  CHECK(overlapped_ns + SW_NS / 2 < serial_ns);
+  CHECK_EQ(sim_network_sw_blocks - blocks, 2 * 10);
+
+  /* Back to the strict order without dependencies */
+  LL_ATON_RT_SetEpochBlockDeps(NULL, &NN_Instance_Pose);
+  run(&resident, 1);
+  CHECK(trace_index('e', 0) < trace_index('s', 1));
+
+  LL_ATON_RT_Resident_DeInit(&resident);
+  LL_ATON_RT_SetEpochCallback(NULL, &NN_Instance_Pose);
+  host_sim_set_latency(HOST_SIM_UNIT_EPOCHCTRL, HOST_SIM_EPOCHCTRL_LATENCY_NS);
+
+  if (bench)
+  {
+    printf("SW %u us, blobs %u us: inference %.1f us in order, %.1f us overlapped (analysis %u -> %u us)\n",
+           SW_NS / 1000, BLOB_NS / 1000, serial_ns / 1e3, overlapped_ns / 1e3, 2 * (SW_NS + BLOB_NS) / 1000,
+           (BLOB_NS + SW_NS + BLOB_NS) / 1000);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  test_check();
+  test_validate();
+  test_analyze();
+  test_runtime(host_test_bench(argc, argv));
+
+  return host_test_result("test_eb_overlap");
+}
@@ -0,0 +1,290 @@
+/**
+ ******************************************************************************
+ * @file    test_gesture_replay.c
+ * @brief   Replay of keypoint traces through the gesture rule engine, with the
+ *          per-frame evaluation cost
+ ******************************************************************************
+ * Without argument, a scripted 30 fps trace of the gestures of the rule table
+ * (and of motions that must not trigger any) is replayed and the detections
+ * are checked. With a file argument, a recorded trace is replayed instead: one
+ * frame per line, "timestamp_ms,x0,y0,p0,x1,y1,p1,..." for the
+ * AI_POSE_PP_POSE_KEYPOINTS_NB keypoints of the post-processing output.
+ ******************************************************************************
+ */
+
+#include <stdlib.h>
+#include "host_test.h"
+#include "gesture_detection.h"
+#include "main.h"
+
+#define NB_KP AI_POSE_PP_POSE_KEYPOINTS_NB
+#define FRAME_MS 33
+#define REST_CONFIDENCE 0.9f
+#define JITTER 0.004f
+
+/* Host stand-ins of the target environment of gesture_detection.c */
+OverlayDraw_t lcd_fg_overlay;
+static uint32_t tick;
+static uint32_t nb_debug_prints;
+static sFONT font = { .Height = 16 };
+
+uint32_t HAL_GetTick(void)
+{
+  return tick;
+}
+
+sFONT *UTIL_LCD_GetFont(void)
+{
+  return &font;
+}
+
+void OverlayDraw_PrintfAt(OverlayDraw_t *od, int x, int y, OverlayDrawAlign_t align, const char *format, ...)
+{
+  nb_debug_prints++;
+}
+
+/* Per-frame cost of Gesture_Detect() */
+typedef struct {
+  uint64_t total_ns;
+  uint64_t max_ns;
+  uint32_t frames;
+} Cost_t;
+
+static GestureType_t detect(GestureDetector_t *detector, spe_pp_outBuffer_t *keypoints, Cost_t *cost)
+{
+  uint64_t t0 = host_test_ns();
+  GestureType_t gesture = Gesture_Detect(detector, keypoints);
+  uint64_t ns = host_test_ns() - t0;
+
+  cost->total_ns += ns;
+  cost->frames++;
+  if (ns > cost->max_ns)
+    cost->max_ns = ns;
+  return gesture;
+}
+
+static void print_cost(const Cost_t *cost)
+{
+  printf("Gesture_Detect: %.0f ns per frame on average, %.0f ns at most, over %u frames\n",
+         (double) cost->total_ns / cost->frames, (double) cost->max_ns, cost->frames);
+}
+
+/* Scripted trace: each segment moves one keypoint in a straight line to a target, or holds the pose */
+typedef struct {
+  const char *name;
+  uint32_t frames;
+  int kp;                  /* -1: hold */
+  float x, y;
+  float confidence;
+  GestureType_t expected;  /* Gesture to be detected once during the segment, or GESTURE_NONE */
+} Segment_t;
+
+static const Segment_t script[] = {
+  { "rest", 60, -1 },
+  { "left swipe right", 6, KEYPOINT_LEFT_WRIST, 0.6f, 0.6f, REST_CONFIDENCE, GESTURE_LEFT_ARM_SWIPE_RIGHT },
+  { "rest", 45, -1 },
+  { "left swipe left", 6, KEYPOINT_LEFT_WRIST, 0.3f, 0.6f, REST_CONFIDENCE, GESTURE_LEFT_ARM_SWIPE_LEFT },
+  { "rest", 45, -1 },
+  { "unconfident swipe", 6, KEYPOINT_LEFT_WRIST, 0.6f, 0.6f, 0.3f },
+  /* Only the confidence of the latest frame is checked: the wrist must be still once confident again */
+  { "rest", 10, -1 },
+  { "slow left return", 30, KEYPOINT_LEFT_WRIST, 0.3f, 0.6f, REST_CONFIDENCE },
+  { "right arm raise", 40, KEYPOINT_RIGHT_WRIST, 0.65f, 0.05f, REST_CONFIDENCE },
+  { "hold above head", 20, -1 },
+  { "overhead strike", 6, KEYPOINT_RIGHT_WRIST, 0.65f, 0.65f, REST_CONFIDENCE, GESTURE_SWORD_OVERHEAD_STRIKE },
+  { "rest", 45, -1 },
+  { "slow move aside", 45, KEYPOINT_RIGHT_WRIST, 0.2f, 0.35f, REST_CONFIDENCE },
+  { "side slash", 10, KEYPOINT_RIGHT_WRIST, 0.95f, 0.35f, REST_CONFIDENCE, GESTURE_SWORD_SIDE_SLASH },
+  { "rest", 60, -1 },
+};
+
+static void rest_pose(spe_pp_outBuffer_t *pose)
+{
+  static const float rest[NB_KP][2] = {
+    [KEYPOINT_NOSE] = { 0.5f, 0.2f },
+    [KEYPOINT_LEFT_SHOULDER] = { 0.4f, 0.35f },   [KEYPOINT_RIGHT_SHOULDER] = { 0.6f, 0.35f },
+    [KEYPOINT_LEFT_ELBOW] = { 0.35f, 0.48f },     [KEYPOINT_RIGHT_ELBOW] = { 0.65f, 0.48f },
+    [KEYPOINT_LEFT_WRIST] = { 0.3f, 0.6f },       [KEYPOINT_RIGHT_WRIST] = { 0.65f, 0.6f },
+    [KEYPOINT_LEFT_HIP] = { 0.43f, 0.62f },       [KEYPOINT_RIGHT_HIP] = { 0.57f, 0.62f },
+    [KEYPOINT_LEFT_KNEE] = { 0.43f, 0.78f },      [KEYPOINT_RIGHT_KNEE] = { 0.57f, 0.78f },
+    [KEYPOINT_LEFT_ANKLE] = { 0.43f, 0.94f },     [KEYPOINT_RIGHT_ANKLE] = { 0.57f, 0.94f },
+  };
+
+  for (int i = 0; i < NB_KP; i++)
+  {
+    pose[i].x_center = rest[i][0];
+    pose[i].y_center = rest[i][1];
+    pose[i].proba = REST_CONFIDENCE;
+  }
+}
+
+static float jitter(void)
+{
+  return JITTER * (2.0f * rand() / (float) RAND_MAX - 1.0f);
+}
+
+static void test_script(int bench)
+{
+  static GestureDetector_t detector;
+  spe_pp_outBuffer_t pose[NB_KP], frame[NB_KP];
+  uint32_t detections = 0;
+  Cost_t cost = { 0 };
+
+  srand(3);
+  Gesture_Init(&detector);
+  rest_pose(pose);
+  tick = 0;
+
+  for (size_t s = 0; s < sizeof(script) / sizeof(script[0]); s++)
+  {
+    const Segment_t *seg = &script[s];
+    float x0 = 0, y0 = 0;
+    int found = -1;
+
+    if (seg->kp >= 0)
+    {
+      x0 = pose[seg->kp].x_center;
+      y0 = pose[seg->kp].y_center;
+      pose[seg->kp].proba = seg->confidence;
+    }
+
+    for (uint32_t f = 1; f <= seg->frames; f++)
+    {
+      if (seg->kp >= 0)
+      {
+        pose[seg->kp].x_center = x0 + (seg->x - x0) * f / seg->frames;
+        pose[seg->kp].y_center = y0 + (seg->y - y0) * f / seg->frames;
+      }
+      for (int i = 0; i < NB_KP; i++)
+      {
+        frame[i] = pose[i];
+        frame[i].x_center += jitter();
+        frame[i].y_center += jitter();
+      }
+
+      tick += FRAME_MS;
+      GestureType_t gesture = detect(&detector, frame, &cost);
+
+      if (gesture != GESTURE_NONE)
+      {
+        detections++;
+        CHECK_EQ(gesture, seg->expected);
+        CHECK(found < 0);
+        found = f;
+        CHECK_EQ(Gesture_GetCurrentDisplayGesture(&detector), gesture);
+        if (bench)
+          printf("%-18s %-22s detected after %u ms\n", seg->name, Gesture_GetName(gesture), f * FRAME_MS);
+      }
+    }
+    if (seg->expected != GESTURE_NONE)
+    {
+      CHECK(found > 0);
+      /* Detected while the motion is still going on */
+      CHECK(found < (int) seg->frames);
+    }
+  }
+
+  CHECK_EQ(detections, 4);
+  /* The display of the last gesture has timed out */
+  CHECK_EQ(Gesture_GetCurrentDisplayGesture(&detector), GESTURE_NONE);
+  CHECK(nb_debug_prints > 0);
+
+  if (bench)
+  {
+    printf("%u features evaluated per frame\n", (unsigned) detector.nb_features);
+    print_cost(&cost);
+  }
+}
+
+/* Cooldown: a gesture repeated within a second of the previous detection is ignored */
+static void test_cooldown(void)
+{
+  static GestureDetector_t detector;
+  spe_pp_outBuffer_t pose[NB_KP];
+  Cost_t cost = { 0 };
+  uint32_t detections = 0;
+
+  Gesture_Init(&detector);
+  rest_pose(pose);
+  tick = 0;
+  for (int f = 0; f < 200; f++)
+  {
+    /* Left wrist swinging 0.3 <-> 0.6 at 0.1 per frame: a swipe every 3 frames */
+    int phase = f % 6;
+
+    pose[KEYPOINT_LEFT_WRIST].x_center = 0.3f + 0.1f * (phase < 3 ? phase : 6 - phase);
+    tick += FRAME_MS;
+    if (detect(&detector, pose, &cost) != GESTURE_NONE)
+    {
+      detections++;
+      CHECK(detector.last_gesture_time == tick);
+    }
+  }
+  /* 200 frames of 33 ms: at most one detection per second */
+  CHECK(detections >= 5 && detections <= 7);
+}
+
+static int replay_file(const char *path)
+{
+  static GestureDetector_t detector;
+  spe_pp_outBuffer_t frame[NB_KP];
+  Cost_t cost = { 0 };
+  char line[2048];
+  FILE *f = fopen(path, "r");
+  uint32_t n = 0;
+
+  if (f == NULL)
+  {
+    printf("%s: cannot open\n", path);
+    return 1;
+  }
+
+  Gesture_Init(&detector);
+  while (fgets(line, sizeof(line), f))
+  {
+    char *p = line;
+    int ok = 1;
+
+    tick = strtoul(p, &p, 10);
+    for (int i = 0; i < NB_KP && ok; i++)
+    {
+      float *fields[3] = { &frame[i].x_center, &frame[i].y_center, &frame[i].proba };
+
+      for (int j = 0; j < 3 && ok; j++)
+      {
+        char *end;
+
+        ok = (*p == ',');
+        *fields[j] = strtof(p + 1, &end);
+        ok = ok && end != p + 1;
+        p = end;
+      }
+    }
+    n++;
+    if (!ok)
+    {
+      printf("%s:%u: expected a timestamp and %d keypoints\n", path, n, NB_KP);
+      continue;
+    }
+
+    GestureType_t gesture = detect(&detector, frame, &cost);
+    if (gesture != GESTURE_NONE)
+      printf("%8u ms  frame %6u  %s\n", (unsigned) tick, n, Gesture_GetName(gesture));
+  }
+  fclose(f);
+
+  if (cost.frames)
+    print_cost(&cost);
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  if (argc > 1 && !host_test_bench(argc, argv))
+    return replay_file(argv[1]);
+
+  test_script(host_test_bench(argc, argv));
+  test_cooldown();
+
+  return host_test_result("test_gesture_replay");
+}
@@ -0,0 +1,610 @@
+/**
+ ******************************************************************************
+ * @file    test_inference_rate.c
+ * @brief   Adaptive inference rate (inference_rate.c): motion metric, rate
+ *          decisions and replay of keypoint and motion traces
+ ******************************************************************************
+ * The luma thumbnail metric and the decisions are checked on their own. A
+ * trace is then replayed twice through the keypoint filter and the gesture
+ * rule engine, as in the main loop: every frame inferred, then only the frames
+ * the inference rate decides on. The replay reports the ratio of frames
+ * skipped and, per gesture detected at full rate, the delay of its detection
+ * at the adaptive rate.
+ *
+ * Without argument, a scripted 30 fps kiosk trace is replayed: long rests,
+ * swipes and sword gestures, slow moves. Its frames are rendered as L8
+ * images of the limbs, the motion metric being measured on them along the
+ * replay. It is replayed again with the NN pipe zooming into the region of
+ * the keypoints of a larger camera frame, as with NN_ROI_TRACKING: each new
+ * zoom moves the whole NN input, so the zoom follows the keypoints within
+ * NN_ROI_DEAD_BAND sensor pixels only, or each step of the zoom gets the next
+ * frame inferred. With a file argument, a recorded trace is replayed
+ * instead: one frame per line, "timestamp_ms,motion,x0,y0,p0,x1,y1,p1,..."
+ * with the changed samples of InferenceRate_Motion() as measured on the
+ * device and the AI_POSE_PP_POSE_KEYPOINTS_NB keypoints of the
+ * post-processing output.
+ ******************************************************************************
+ */
+
+#include <stdlib.h>
+#include "host_test.h"
+#include "gesture_detection.h"
+#include "inference_rate.h"
+#include "keypoint_filter.h"
+#include "roi_tracker.h"
+#include "main.h"
+
+#define NB_KP AI_POSE_PP_POSE_KEYPOINTS_NB
+#define FRAME_MS 33
+#define REST_CONFIDENCE 0.9f
+#define JITTER 0.004f
+#define MAX_FRAMES 4096
+/* Rendered frames, L8 */
+#define IMG_SIZE 96
+#define LIMB_RADIUS 3.0f
+#define HAND_RADIUS 5.0f
+/* Camera frames zoomed into by the NN pipe, L8 */
+#define CAM_SIZE (2 * IMG_SIZE)
+/* Adaptive detections matched to the full rate ones within this many frames */
+#define MATCH_FRAMES 15
+
+/* Host stand-ins of the target environment of gesture_detection.c */
+OverlayDraw_t lcd_fg_overlay;
+static uint32_t tick;
+static sFONT font = { .Height = 16 };
+
+uint32_t HAL_GetTick(void)
+{
+  return tick;
+}
+
+sFONT *UTIL_LCD_GetFont(void)
+{
+  return &font;
+}
+
+void OverlayDraw_PrintfAt(OverlayDraw_t *od, int x, int y, OverlayDrawAlign_t align, const char *format, ...)
+{
+}
+
+static const InferenceRate_Params_t rate_params = {
+  .idle_period = NN_IDLE_PERIOD,
+  .hold_frames = NN_IDLE_HOLD_FRAMES,
+  .pixel_threshold = NN_MOTION_PIXEL_THRESHOLD,
+  .motion_samples = NN_MOTION_SAMPLES,
+  .speed_threshold = NN_MOTION_KEYPOINT_SPEED,
+};
+
+static const KeypointFilter_OneEuroParams_t filter_params = {
+  .min_cutoff = KEYPOINT_FILTER_MIN_CUTOFF,
+  .beta = KEYPOINT_FILTER_BETA,
+  .d_cutoff = KEYPOINT_FILTER_D_CUTOFF,
+};
+
+/* Trace replayed: per camera frame, its timestamp, changed thumbnail samples and keypoints */
+typedef struct {
+  uint32_t nb_frames;
+  uint32_t timestamp[MAX_FRAMES];
+  uint32_t motion[MAX_FRAMES];
+  spe_pp_outBuffer_t keypoints[MAX_FRAMES][NB_KP];
+  /* Scripted traces: the frames are rendered from the poses, the motion measured along the replay */
+  int rendered;
+  spe_pp_outBuffer_t pose[MAX_FRAMES][NB_KP];
+  /* Rendered camera frames zoomed into around the keypoints inferred, the zoom moving beyond this dead band */
+  int roi_tracking;
+  uint32_t roi_dead_band;
+} Trace_t;
+
+static Trace_t trace;
+
+static void render(const spe_pp_outBuffer_t *pose, uint32_t seed, uint8_t *img, int size);
+
+static const RoiTracker_Params_t roi_params = {
+  .margin = NN_ROI_MARGIN,
+  .min_size = NN_ROI_MIN_SIZE,
+  .min_confidence = AI_POSE_PP_CONF_THRESHOLD,
+  .shrink_rate = NN_ROI_SHRINK_RATE,
+  .min_keypoints = NN_ROI_MIN_KEYPOINTS,
+  .max_missed = NN_ROI_MAX_MISSED,
+};
+
+/* Person standing away from the camera: the poses in the central half of its frames */
+static void far(const spe_pp_outBuffer_t *pose, spe_pp_outBuffer_t *far_pose)
+{
+  for (int i = 0; i < NB_KP; i++)
+  {
+    far_pose[i] = pose[i];
+    far_pose[i].x_center = 0.25f + 0.5f * pose[i].x_center;
+    far_pose[i].y_center = 0.25f + 0.5f * pose[i].y_center;
+  }
+}
+
+/* NN input of a camera frame: the zoom region downsized to IMG_SIZE, nearest pixel */
+static void zoom(const uint8_t *cam, const Roi_Pixels_t *pixels, uint8_t *img)
+{
+  for (int y = 0; y < IMG_SIZE; y++)
+    for (int x = 0; x < IMG_SIZE; x++)
+      img[y * IMG_SIZE + x] = cam[(pixels->y0 + y * pixels->height / IMG_SIZE) * CAM_SIZE +
+                                  pixels->x0 + x * pixels->width / IMG_SIZE];
+}
+
+/* Gestures detected along a replay */
+typedef struct {
+  uint32_t nb;
+  uint32_t frame[64];
+  GestureType_t gesture[64];
+  uint32_t inferences;
+} Detections_t;
+
+static void replay(const Trace_t *t, int adaptive, Detections_t *detections)
+{
+  static GestureDetector_t detector;
+  static KeypointFilter_t filter;
+  static InferenceRate_t rate;
+  static RoiTracker_t tracker;
+  static uint8_t img[IMG_SIZE * IMG_SIZE];
+  static uint8_t cam[CAM_SIZE * CAM_SIZE];
+  spe_pp_outBuffer_t keypoints[NB_KP], far_pose[NB_KP];
+  Roi_Pixels_t pixels = { 0, 0, CAM_SIZE, CAM_SIZE };
+
+  Gesture_Init(&detector);
+  KeypointFilter_InitOneEuro(&filter, &filter_params, AI_POSE_PP_CONF_THRESHOLD);
+  InferenceRate_Init(&rate, &rate_params);
+  RoiTracker_Init(&tracker, &roi_params);
+  memset(detections, 0, sizeof(*detections));
+
+  for (uint32_t f = 0; f < t->nb_frames; f++)
+  {
+    GestureType_t gesture;
+
+    tick = t->timestamp[f];
+    if (adaptive)
+    {
+      uint32_t motion = t->motion[f];
+
+      if (t->rendered && t->roi_tracking)
+      {
+        far(t->pose[f], far_pose);
+        render(far_pose, f, cam, CAM_SIZE);
+        zoom(cam, &pixels, img);
+        motion = InferenceRate_Motion(&rate, img, IMG_SIZE, IMG_SIZE, IMG_SIZE, 1);
+      }
+      else if (t->rendered)
+      {
+        render(t->pose[f], f, img, IMG_SIZE);
+        motion = InferenceRate_Motion(&rate, img, IMG_SIZE, IMG_SIZE, IMG_SIZE, 1);
+      }
+      if (!InferenceRate_Decide(&rate, motion))
+        continue;
+    }
+
+    detections->inferences++;
+    memcpy(keypoints, t->keypoints[f], sizeof(keypoints));
+    KeypointFilter_Apply(&filter, keypoints, tick);
+    gesture = Gesture_Detect(&detector, keypoints);
+    if (t->roi_tracking)
+    {
+      Roi_Pixels_t next;
+      Roi_t captured;
+
+      /* As CameraPipeline_NNPipe_SetRoi(), for the next frames */
+      far(keypoints, far_pose);
+      Roi_ToPixels(RoiTracker_Update(&tracker, far_pose, NB_KP), CAM_SIZE, CAM_SIZE, IMG_SIZE, IMG_SIZE, &next,
+                   &captured);
+      if (Roi_PixelsMoved(&pixels, &next, t->roi_dead_band))
+        pixels = next;
+    }
+    InferenceRate_SetSpeed(&rate, Gesture_MaxKeypointSpeed(&detector, 1));
+    if (gesture != GESTURE_NONE && detections->nb < sizeof(detections->frame) / sizeof(detections->frame[0]))
+    {
+      detections->frame[detections->nb] = f;
+      detections->gesture[detections->nb] = gesture;
+      detections->nb++;
+    }
+  }
+}
+
+/* Replays the trace at both rates, returns the number of full rate detections missed at the adaptive rate */
+static uint32_t compare_rates(const Trace_t *t, int verbose, uint32_t *max_delay_frames, float *skipped_ratio)
+{
+  Detections_t full, adaptive;
+  uint32_t missed = 0, total_delay = 0;
+
+  replay(t, 0, &full);
+  replay(t, 1, &adaptive);
+  *max_delay_frames = 0;
+  *skipped_ratio = 1.0f - (float) adaptive.inferences / t->nb_frames;
+
+  for (uint32_t i = 0; i < full.nb; i++)
+  {
+    int found = -1;
+
+    for (uint32_t j = 0; j < adaptive.nb && found < 0; j++)
+    {
+      if (adaptive.gesture[j] == full.gesture[i] && adaptive.frame[j] + MATCH_FRAMES >= full.frame[i] &&
+          adaptive.frame[j] <= full.frame[i] + MATCH_FRAMES)
+        found = j;
+    }
+    if (found < 0)
+    {
+      missed++;
+      if (verbose)
+        printf("%8u ms  %-22s missed at the adaptive rate\n", (unsigned) t->timestamp[full.frame[i]],
+               Gesture_GetName(full.gesture[i]));
+      continue;
+    }
+
+    int delay = (int) adaptive.frame[found] - (int) full.frame[i];
+    if (delay > 0)
+    {
+      total_delay += delay;
+      if ((uint32_t) delay > *max_delay_frames)
+        *max_delay_frames = delay;
+    }
+    if (verbose)
+      printf("%8u ms  %-22s detected %+d ms at the adaptive rate\n", (unsigned) t->timestamp[full.frame[i]],
+             Gesture_GetName(full.gesture[i]),
+             (int) t->timestamp[adaptive.frame[found]] - (int) t->timestamp[full.frame[i]]);
+  }
+
+  if (verbose)
+  {
+    printf("%u frames, %u inferred at full rate and %u at the adaptive rate: %.1f%% skipped\n",
+           (unsigned) t->nb_frames, (unsigned) full.inferences, (unsigned) adaptive.inferences,
+           100.0f * *skipped_ratio);
+    printf("%u gestures at full rate, %u at the adaptive rate, %u missed, latency delta %.1f ms on average, "
+           "%u ms at most\n", (unsigned) full.nb, (unsigned) adaptive.nb, (unsigned) missed,
+           full.nb > missed ? (float) total_delay * FRAME_MS / (full.nb - missed) : 0.0f,
+           (unsigned) (*max_delay_frames * FRAME_MS));
+  }
+  return missed;
+}
+
+/* Scripted trace: each segment moves one keypoint in a straight line to a target, or holds the pose */
+typedef struct {
+  uint32_t frames;
+  int kp;                  /* -1: hold */
+  float x, y;
+} Segment_t;
+
+static const Segment_t kiosk[] = {
+  { 300, -1 },
+  { 6, KEYPOINT_LEFT_WRIST, 0.6f, 0.6f },
+  { 200, -1 },
+  { 6, KEYPOINT_LEFT_WRIST, 0.3f, 0.6f },
+  { 150, -1 },
+  /* Too slow to change enough thumbnail samples from one frame to the next */
+  { 40, KEYPOINT_LEFT_WRIST, 0.5f, 0.6f },
+  { 100, -1 },
+  { 40, KEYPOINT_LEFT_WRIST, 0.3f, 0.6f },
+  { 100, -1 },
+  { 40, KEYPOINT_RIGHT_WRIST, 0.65f, 0.05f },
+  { 20, -1 },
+  { 6, KEYPOINT_RIGHT_WRIST, 0.65f, 0.65f },
+  { 300, -1 },
+  { 45, KEYPOINT_RIGHT_WRIST, 0.2f, 0.35f },
+  { 10, KEYPOINT_RIGHT_WRIST, 0.95f, 0.35f },
+  { 400, -1 },
+  { 6, KEYPOINT_LEFT_WRIST, 0.6f, 0.6f },
+  { 300, -1 },
+};
+
+static void rest_pose(spe_pp_outBuffer_t *pose)
+{
+  static const float rest[NB_KP][2] = {
+    [KEYPOINT_NOSE] = { 0.5f, 0.2f },
+    [KEYPOINT_LEFT_SHOULDER] = { 0.4f, 0.35f },   [KEYPOINT_RIGHT_SHOULDER] = { 0.6f, 0.35f },
+    [KEYPOINT_LEFT_ELBOW] = { 0.35f, 0.48f },     [KEYPOINT_RIGHT_ELBOW] = { 0.65f, 0.48f },
+    [KEYPOINT_LEFT_WRIST] = { 0.3f, 0.6f },       [KEYPOINT_RIGHT_WRIST] = { 0.65f, 0.6f },
+    [KEYPOINT_LEFT_HIP] = { 0.43f, 0.62f },       [KEYPOINT_RIGHT_HIP] = { 0.57f, 0.62f },
+    [KEYPOINT_LEFT_KNEE] = { 0.43f, 0.78f },      [KEYPOINT_RIGHT_KNEE] = { 0.57f, 0.78f },
+    [KEYPOINT_LEFT_ANKLE] = { 0.43f, 0.94f },     [KEYPOINT_RIGHT_ANKLE] = { 0.57f, 0.94f },
+  };
+
+  for (int i = 0; i < NB_KP; i++)
+  {
+    pose[i].x_center = rest[i][0];
+    pose[i].y_center = rest[i][1];
+    pose[i].proba = REST_CONFIDENCE;
+  }
+}
+
+static float jitter(float amplitude)
+{
+  return amplitude * (2.0f * rand() / (float) RAND_MAX - 1.0f);
+}
+
+/* Limbs of the rendered frames */
+static const uint8_t limbs[][2] = {
+  { KEYPOINT_LEFT_SHOULDER, KEYPOINT_RIGHT_SHOULDER }, { KEYPOINT_LEFT_HIP, KEYPOINT_RIGHT_HIP },
+  { KEYPOINT_LEFT_SHOULDER, KEYPOINT_LEFT_HIP },       { KEYPOINT_RIGHT_SHOULDER, KEYPOINT_RIGHT_HIP },
+  { KEYPOINT_LEFT_SHOULDER, KEYPOINT_LEFT_ELBOW },     { KEYPOINT_LEFT_ELBOW, KEYPOINT_LEFT_WRIST },
+  { KEYPOINT_RIGHT_SHOULDER, KEYPOINT_RIGHT_ELBOW },   { KEYPOINT_RIGHT_ELBOW, KEYPOINT_RIGHT_WRIST },
+  { KEYPOINT_LEFT_HIP, KEYPOINT_LEFT_KNEE },           { KEYPOINT_LEFT_KNEE, KEYPOINT_LEFT_ANKLE },
+  { KEYPOINT_RIGHT_HIP, KEYPOINT_RIGHT_KNEE },         { KEYPOINT_RIGHT_KNEE, KEYPOINT_RIGHT_ANKLE },
+};
+
+/* Camera frame of `size` x `size` of a pose: bright limbs and hands on a gradient, sensor noise drawn from `seed` */
+static void render(const spe_pp_outBuffer_t *pose, uint32_t seed, uint8_t *img, int size)
+{
+  static const int hands[] = { KEYPOINT_LEFT_WRIST, KEYPOINT_RIGHT_WRIST };
+  uint32_t noise = seed * 2654435761u + 1;
+
+  for (int p = 0; p < size * size; p++)
+  {
+    noise ^= noise << 13;
+    noise ^= noise >> 17;
+    noise ^= noise << 5;
+    img[p] = (uint8_t) (40 + p % size * IMG_SIZE / size + p / size * IMG_SIZE / size / 2 + noise % 13);
+  }
+
+  /* Limbs as segments, hands as discs */
+  for (size_t l = 0; l < sizeof(limbs) / sizeof(limbs[0]) + 2; l++)
+  {
+    int hand = l >= sizeof(limbs) / sizeof(limbs[0]);
+    const spe_pp_outBuffer_t *a = &pose[hand ? hands[l - sizeof(limbs) / sizeof(limbs[0])] : limbs[l][0]];
+    const spe_pp_outBuffer_t *b = hand ? a : &pose[limbs[l][1]];
+    float radius = (hand ? HAND_RADIUS : LIMB_RADIUS) * size / IMG_SIZE;
+    float ax = a->x_center * size, ay = a->y_center * size;
+    float dx = b->x_center * size - ax, dy = b->y_center * size - ay;
+    int x0 = (int) fminf(ax, ax + dx) - (int) radius - 1, x1 = (int) fmaxf(ax, ax + dx) + (int) radius + 1;
+    int y0 = (int) fminf(ay, ay + dy) - (int) radius - 1, y1 = (int) fmaxf(ay, ay + dy) + (int) radius + 1;
+
+    for (int y = y0 < 0 ? 0 : y0; y <= y1 && y < size; y++)
+    {
+      for (int x = x0 < 0 ? 0 : x0; x <= x1 && x < size; x++)
+      {
+        /* Distance of the pixel centre to the segment */
+        float t = ((x + 0.5f - ax) * dx + (y + 0.5f - ay) * dy) / (dx * dx + dy * dy + 1e-6f);
+
+        t = t < 0.0f ? 0.0f : (t > 1.0f ? 1.0f : t);
+        if (hypotf(x + 0.5f - ax - t * dx, y + 0.5f - ay - t * dy) <= radius)
+          img[y * size + x] = (uint8_t) (214 + (img[y * size + x] & 7));
+      }
+    }
+  }
+}
+
+static void script_trace(Trace_t *t)
+{
+  spe_pp_outBuffer_t pose[NB_KP];
+
+  srand(7);
+  rest_pose(pose);
+  t->nb_frames = 0;
+  t->rendered = 1;
+  t->roi_tracking = 0;
+
+  for (size_t s = 0; s < sizeof(kiosk) / sizeof(kiosk[0]); s++)
+  {
+    const Segment_t *seg = &kiosk[s];
+    float x0 = seg->kp >= 0 ? pose[seg->kp].x_center : 0, y0 = seg->kp >= 0 ? pose[seg->kp].y_center : 0;
+
+    for (uint32_t f = 1; f <= seg->frames && t->nb_frames < MAX_FRAMES; f++)
+    {
+      spe_pp_outBuffer_t *frame = t->keypoints[t->nb_frames];
+
+      if (seg->kp >= 0)
+      {
+        pose[seg->kp].x_center = x0 + (seg->x - x0) * f / seg->frames;
+        pose[seg->kp].y_center = y0 + (seg->y - y0) * f / seg->frames;
+      }
+      for (int i = 0; i < NB_KP; i++)
+      {
+        frame[i] = pose[i];
+        frame[i].x_center += jitter(JITTER);
+        frame[i].y_center += jitter(JITTER);
+      }
+      memcpy(t->pose[t->nb_frames], pose, sizeof(pose));
+      t->timestamp[t->nb_frames] = (t->nb_frames + 1) * FRAME_MS;
+      t->nb_frames++;
+    }
+  }
+}
+
+#define MOTION(img) InferenceRate_Motion(&rate, img, pitch, IMG_SIZE, IMG_SIZE - 8, bpp)
+
+static void test_motion(void)
+{
+  static uint8_t img[IMG_SIZE * 3 * IMG_SIZE];
+  InferenceRate_t rate;
+
+  InferenceRate_Init(&rate, &rate_params);
+  for (uint16_t bpp = 1; bpp <= 3; bpp += 2)
+  {
+    uint32_t pitch = IMG_SIZE * bpp + 16;
+
+    memset(img, 100, sizeof(img));
+    InferenceRate_Reset(&rate);
+    /* Nothing to compare the first frame to: all samples changed */
+    CHECK_EQ(MOTION(img), INFERENCE_RATE_GRID * INFERENCE_RATE_GRID);
+    CHECK(InferenceRate_Decide(&rate, INFERENCE_RATE_GRID * INFERENCE_RATE_GRID));
+    CHECK_EQ(MOTION(img), 0);
+
+    /* Below the pixel threshold */
+    memset(img, 100 + rate_params.pixel_threshold, sizeof(img));
+    CHECK_EQ(MOTION(img), 0);
+
+    /* Left half of the frame changed, the padding of the lines is not sampled */
+    for (int y = 0; y < IMG_SIZE - 8; y++)
+    {
+      memset(img + y * pitch, 200, IMG_SIZE / 2 * bpp);
+      memset(img + y * pitch + IMG_SIZE * bpp, 0, 16);
+    }
+    CHECK_EQ(MOTION(img), INFERENCE_RATE_GRID * INFERENCE_RATE_GRID / 2);
+    /* Compared to the last frame inferred */
+    CHECK_EQ(MOTION(img), INFERENCE_RATE_GRID * INFERENCE_RATE_GRID / 2);
+    CHECK(InferenceRate_Decide(&rate, INFERENCE_RATE_GRID * INFERENCE_RATE_GRID / 2));
+    CHECK_EQ(MOTION(img), 0);
+  }
+}
+
+/* Thumbnail row `row` of a uniform frame covered from column `col` over `cols` columns */
+static void bar(uint8_t *img, int row, int col, int cols)
+{
+  const int cell = IMG_SIZE / INFERENCE_RATE_GRID;
+
+  memset(img, 100, IMG_SIZE * IMG_SIZE);
+  for (int y = row * cell; y < (row + 1) * cell; y++)
+    memset(img + y * IMG_SIZE + col * cell, 200, cols * cell);
+}
+
+/* A motion too slow to be seen from one frame to the next adds up over the frames skipped */
+static void test_slow_motion(void)
+{
+  static uint8_t img[IMG_SIZE * IMG_SIZE];
+  const uint16_t bpp = 1;
+  const uint32_t pitch = IMG_SIZE;
+  InferenceRate_t rate;
+  int f;
+
+  InferenceRate_Init(&rate, &rate_params);
+  bar(img, 10, 0, 3);
+  for (f = 0; f < 100 && InferenceRate_Decide(&rate, MOTION(img)); f++)
+    ;
+  CHECK_EQ(f, NN_IDLE_HOLD_FRAMES);
+
+  /* Moving by one cell a frame: two samples changed since the previous frame, four since the last inferred */
+  bar(img, 10, 1, 3);
+  CHECK_EQ(MOTION(img), 2);
+  CHECK(!InferenceRate_Decide(&rate, 2));
+  bar(img, 10, 2, 3);
+  CHECK_EQ(MOTION(img), 4);
+  CHECK(InferenceRate_Decide(&rate, 4));
+  CHECK_EQ(MOTION(img), 0);
+}
+
+static void test_decide(void)
+{
+  InferenceRate_t rate;
+  uint32_t inferred = 0;
+
+  InferenceRate_Init(&rate, &rate_params);
+  /* Static: every frame inferred for the hold frames, then one in idle_period */
+  for (int f = 0; f < NN_IDLE_HOLD_FRAMES - 1; f++)
+    CHECK(InferenceRate_Decide(&rate, 0));
+  for (int f = 0; f < 40 * NN_IDLE_PERIOD; f++)
+    inferred += InferenceRate_Decide(&rate, 0);
+  CHECK_EQ(inferred, 40);
+
+  /* Back to full rate on the first frame with scene motion, and for the hold frames after */
+  CHECK(InferenceRate_Decide(&rate, NN_MOTION_SAMPLES));
+  for (int f = 0; f < NN_IDLE_HOLD_FRAMES - 1; f++)
+    CHECK(InferenceRate_Decide(&rate, NN_MOTION_SAMPLES - 1));
+  CHECK(!InferenceRate_Decide(&rate, 0));
+
+  /* Or with keypoint motion */
+  InferenceRate_SetSpeed(&rate, NN_MOTION_KEYPOINT_SPEED);
+  CHECK(InferenceRate_Decide(&rate, 0));
+  InferenceRate_SetSpeed(&rate, 0.0f);
+  for (int f = 0; f < NN_IDLE_HOLD_FRAMES - 1; f++)
+    CHECK(InferenceRate_Decide(&rate, 0));
+
+  /* Report of the frames decided on since the previous one */
+  char report[64];
+  CHECK(InferenceRate_Report(&rate, report, sizeof(report)) > 0);
+  CHECK_EQ(rate.frames, 0);
+  CHECK(InferenceRate_Report(&rate, report, 8) == 7);
+  CHECK(strcmp(report, "nn rate") == 0);
+}
+
+static void test_replay(int bench)
+{
+  uint32_t max_delay_frames;
+  float skipped_ratio;
+
+  script_trace(&trace);
+  /* All gestures detected, the first moving frame being inferred: at most one frame later */
+  CHECK_EQ(compare_rates(&trace, bench, &max_delay_frames, &skipped_ratio), 0);
+  CHECK(max_delay_frames <= 1);
+  /* Mostly static: close to 1 - 1 / NN_IDLE_PERIOD skipped */
+  CHECK(skipped_ratio > 0.5f);
+}
+
+static void test_replay_roi(int bench)
+{
+  uint32_t max_delay_frames;
+  float skipped_ratio, skipped_ratio_no_band;
+
+  script_trace(&trace);
+  trace.roi_tracking = 1;
+
+  /* Zoom following every pixel of keypoint jitter: the NN input keeps moving */
+  trace.roi_dead_band = 0;
+  CHECK_EQ(compare_rates(&trace, bench, &max_delay_frames, &skipped_ratio_no_band), 0);
+
+  /* Within the dead band: as static as without zoom, all gestures detected as soon */
+  trace.roi_dead_band = NN_ROI_DEAD_BAND;
+  CHECK_EQ(compare_rates(&trace, bench, &max_delay_frames, &skipped_ratio), 0);
+  CHECK(max_delay_frames <= 1);
+  CHECK(skipped_ratio > 0.5f);
+  CHECK(skipped_ratio > skipped_ratio_no_band + 0.2f);
+}
+
+static int replay_file(const char *path)
+{
+  char line[2048];
+  FILE *f = fopen(path, "r");
+  uint32_t n = 0, max_delay_frames;
+  float skipped_ratio;
+
+  if (f == NULL)
+  {
+    printf("%s: cannot open\n", path);
+    return 1;
+  }
+
+  trace.nb_frames = 0;
+  trace.rendered = 0;
+  trace.roi_tracking = 0;
+  while (fgets(line, sizeof(line), f) && trace.nb_frames < MAX_FRAMES)
+  {
+    spe_pp_outBuffer_t *frame = trace.keypoints[trace.nb_frames];
+    char *p = line, *end;
+    int ok = 1;
+
+    n++;
+    trace.timestamp[trace.nb_frames] = strtoul(p, &p, 10);
+    ok = (*p == ',');
+    trace.motion[trace.nb_frames] = strtoul(p + 1, &end, 10);
+    ok = ok && end != p + 1;
+    p = end;
+    for (int i = 0; i < NB_KP && ok; i++)
+    {
+      float *fields[3] = { &frame[i].x_center, &frame[i].y_center, &frame[i].proba };
+
+      for (int j = 0; j < 3 && ok; j++)
+      {
+        ok = (*p == ',');
+        *fields[j] = strtof(p + 1, &end);
+        ok = ok && end != p + 1;
+        p = end;
+      }
+    }
+    if (!ok)
+    {
+      printf("%s:%u: expected a timestamp, a motion and %d keypoints\n", path, n, NB_KP);
+      continue;
+    }
+    trace.nb_frames++;
+  }
+  fclose(f);
+
+  if (trace.nb_frames)
+    compare_rates(&trace, 1, &max_delay_frames, &skipped_ratio);
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  if (argc > 1 && !host_test_bench(argc, argv))
+    return replay_file(argv[1]);
+
+  test_motion();
+  test_slow_motion();
+  test_decide();
+  test_replay(host_test_bench(argc, argv));
+  test_replay_roi(host_test_bench(argc, argv));
+
+  return host_test_result("test_inference_rate");
+}
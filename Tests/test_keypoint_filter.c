@@ -0,0 +1,408 @@
+/**
+ ******************************************************************************
+ * @file    test_keypoint_filter.c
+ * @brief   One-Euro and constant velocity Kalman keypoint filters, float32 and
+ *          Q7.24 (built with KEYPOINT_FILTER_FIXED_POINT)
+ ******************************************************************************
+ * The filters are compared with a double precision reference of their
+ * equations written here, on synthetic noisy keypoint tracks.
+ ******************************************************************************
+ */
+
+#include <stdlib.h>
+#include "host_test.h"
+#include "keypoint_filter.h"
+
+#define NB_KP AI_POSE_PP_POSE_KEYPOINTS_NB
+#define FRAME_MS 33
+#define MIN_CONFIDENCE 0.5f
+
+#ifdef KEYPOINT_FILTER_FIXED_POINT
+#define TEST_NAME "test_keypoint_filter_q24"
+/* Rounding of the Q7.24 state, mostly of the small Kalman covariances, accumulated over the frames of a track */
+#define REF_TOL 5e-4
+#else
+#define TEST_NAME "test_keypoint_filter"
+#define REF_TOL 2e-5
+#endif
+
+static const KeypointFilter_OneEuroParams_t one_euro_params = { .min_cutoff = 1.0f, .beta = 10.0f, .d_cutoff = 1.0f };
+static const KeypointFilter_KalmanParams_t kalman_params = { .process_noise = 1.0f, .measurement_noise = 1e-4f };
+
+/* Reference of one coordinate */
+typedef struct {
+  double pos, vel, p00, p01, p11;
+} RefAxis_t;
+
+static double ref_alpha(double te, double cutoff)
+{
+  return te / (te + 1.0 / (2 * M_PI * cutoff));
+}
+
+static void ref_one_euro(RefAxis_t *a, double z, double te)
+{
+  const KeypointFilter_OneEuroParams_t *p = &one_euro_params;
+  /* Speed and cutoff bounds of the filter, 32 per second and 100 Hz */
+  double speed = fmax(-32.0, fmin(32.0, (z - a->pos) / te));
+  double vel_limit = (100.0 - p->min_cutoff) / p->beta;
+
+  a->vel += ref_alpha(te, p->d_cutoff) * (speed - a->vel);
+  a->pos += ref_alpha(te, p->min_cutoff + p->beta * fmin(fabs(a->vel), vel_limit)) * (z - a->pos);
+}
+
+static void ref_kalman(RefAxis_t *a, double z, double dt, int measured)
+{
+  double q = kalman_params.process_noise;
+
+  a->pos += a->vel * dt;
+  a->p00 += dt * (2 * a->p01 + dt * a->p11) + q * dt * dt * dt / 3;
+  a->p01 += dt * a->p11 + q * dt * dt / 2;
+  a->p11 += q * dt;
+  if (!measured)
+    return;
+
+  double s = a->p00 + kalman_params.measurement_noise;
+  double k0 = a->p00 / s, k1 = a->p01 / s;
+  double innovation = z - a->pos;
+
+  a->pos += k0 * innovation;
+  a->vel += k1 * innovation;
+  a->p11 -= k1 * a->p01;
+  a->p01 -= k0 * a->p01;
+  a->p00 -= k0 * a->p00;
+}
+
+static void ref_start(RefAxis_t *a, double z)
+{
+  a->pos = z;
+  a->vel = 0;
+  a->p00 = kalman_params.measurement_noise;
+  a->p01 = 0;
+  a->p11 = 1.0;
+}
+
+static double noise(double amplitude)
+{
+  return amplitude * (2.0 * rand() / RAND_MAX - 1.0);
+}
+
+/* True position of keypoint k at time t: still, slow and fast sinusoids, linear ramps */
+static double track(int k, int axis, double t)
+{
+  double phase = 0.3 * k + axis;
+
+  switch (k % 4)
+  {
+    case 0:
+      return 0.5;
+    case 1:
+      return 0.5 + 0.2 * sin(2 * M_PI * 0.3 * t + phase);
+    case 2:
+      return 0.5 + 0.3 * sin(2 * M_PI * 2.0 * t + phase);
+    default:
+      return 0.1 + 0.8 * fmod(0.4 * t + 0.1 * k, 1.0);
+  }
+}
+
+/* Filtered tracks against the reference, with dropped detections and irregular frame periods */
+static void test_reference(KeypointFilterType_t type)
+{
+  static KeypointFilter_t filter;
+  RefAxis_t ref[NB_KP][2];
+  int ref_tracked[NB_KP] = { 0 }, ref_missed[NB_KP] = { 0 };
+  spe_pp_outBuffer_t kp[NB_KP];
+  uint32_t t = 1000, last_t = 0;
+  double max_err = 0;
+
+  srand(11);
+  if (type == KEYPOINT_FILTER_KALMAN)
+    KeypointFilter_InitKalman(&filter, &kalman_params, MIN_CONFIDENCE);
+  else
+    KeypointFilter_InitOneEuro(&filter, &one_euro_params, MIN_CONFIDENCE);
+
+  for (int n = 0; n < 600; n++)
+  {
+    /* Frame periods from 5 ms (clamped to 10 ms by the filter) to 80 ms */
+    t += (n % 50 == 49) ? 5 : (n % 70 == 69) ? 80 : FRAME_MS;
+    double dt = (n == 0) ? 0.01 : fmax(0.01, (t - last_t) / 1000.0);
+
+    last_t = t;
+    for (int k = 0; k < NB_KP; k++)
+    {
+      /* Keypoint k is not detected for a few frames every so often, longer than the Kalman coasting for some */
+      int gap = (n + 13 * k) % 97;
+      int measured = !(gap >= 90 && gap < 90 + 1 + k % 8);
+      double z[2];
+
+      for (int a = 0; a < 2; a++)
+        z[a] = track(k, a, t / 1000.0) + noise(0.01);
+      kp[k].x_center = (float) z[0];
+      kp[k].y_center = (float) z[1];
+      kp[k].proba = measured ? 0.9f : 0.2f;
+
+      /* Reference of the tracking logic */
+      if (!ref_tracked[k])
+      {
+        if (measured)
+        {
+          ref_start(&ref[k][0], kp[k].x_center);
+          ref_start(&ref[k][1], kp[k].y_center);
+          ref_tracked[k] = 1;
+          ref_missed[k] = 0;
+        }
+        continue;
+      }
+      ref_missed[k] = measured ? 0 : ref_missed[k] + 1;
+      if (ref_missed[k] > 5)
+      {
+        ref_tracked[k] = 0;
+        continue;
+      }
+      for (int a = 0; a < 2; a++)
+      {
+        if (type == KEYPOINT_FILTER_KALMAN)
+          ref_kalman(&ref[k][a], a ? kp[k].y_center : kp[k].x_center, dt, measured);
+        else if (measured)
+          ref_one_euro(&ref[k][a], a ? kp[k].y_center : kp[k].x_center, dt);
+      }
+    }
+
+    spe_pp_outBuffer_t raw[NB_KP];
+    memcpy(raw, kp, sizeof(raw));
+    KeypointFilter_Apply(&filter, kp, t);
+
+    for (int k = 0; k < NB_KP; k++)
+    {
+      CHECK_EQ(filter.tracked[k], ref_tracked[k]);
+      CHECK(kp[k].proba == raw[k].proba);
+      if (!ref_tracked[k] || (n == 0))
+      {
+        /* Untracked, or first detection: passed through */
+        CHECK(kp[k].x_center == raw[k].x_center && kp[k].y_center == raw[k].y_center);
+        continue;
+      }
+      max_err = fmax(max_err, fabs(kp[k].x_center - ref[k][0].pos));
+      max_err = fmax(max_err, fabs(kp[k].y_center - ref[k][1].pos));
+    }
+  }
+  CHECK(max_err < REF_TOL);
+  printf("%s %s: max deviation from the reference %.2e\n", TEST_NAME,
+         type == KEYPOINT_FILTER_KALMAN ? "kalman" : "one-euro", max_err);
+}
+
+/* Root mean square error of the filtered tracks to the true ones: jitter at rest, lag in motion */
+static void test_smoothing(KeypointFilterType_t type)
+{
+  static KeypointFilter_t filter;
+  spe_pp_outBuffer_t kp[NB_KP];
+  double err_raw[4] = { 0 }, err_filt[4] = { 0 };
+  int count[4] = { 0 };
+
+  srand(21);
+  if (type == KEYPOINT_FILTER_KALMAN)
+    KeypointFilter_InitKalman(&filter, &kalman_params, MIN_CONFIDENCE);
+  else
+    KeypointFilter_InitOneEuro(&filter, &one_euro_params, MIN_CONFIDENCE);
+
+  for (int n = 0; n < 900; n++)
+  {
+    uint32_t t = n * FRAME_MS;
+    float raw[NB_KP];
+
+    for (int k = 0; k < NB_KP; k++)
+    {
+      kp[k].x_center = (float) (track(k, 0, t / 1000.0) + noise(0.01));
+      kp[k].y_center = (float) (track(k, 1, t / 1000.0) + noise(0.01));
+      kp[k].proba = 0.9f;
+      raw[k] = kp[k].x_center;
+    }
+    KeypointFilter_Apply(&filter, kp, t);
+
+    /* After the filters settled, ramps excepted right after they wrap around */
+    for (int k = 0; k < NB_KP && n >= 60; k++)
+    {
+      if (k % 4 == 3 && fmod(0.4 * t / 1000.0 + 0.1 * k, 1.0) < 0.2)
+        continue;
+      err_raw[k % 4] += pow(raw[k] - track(k, 0, t / 1000.0), 2);
+      err_filt[k % 4] += pow(kp[k].x_center - track(k, 0, t / 1000.0), 2);
+      count[k % 4]++;
+    }
+  }
+
+  for (int m = 0; m < 4; m++)
+  {
+    err_filt[m] = sqrt(err_filt[m] / count[m]);
+    err_raw[m] = sqrt(err_raw[m] / count[m]);
+  }
+  /* Still keypoints: the jitter is reduced */
+  CHECK(err_filt[0] < err_raw[0] * 0.8);
+  /* Moving keypoints: the lag stays within a hundredth, a few hundredths for the fast ones */
+  CHECK(err_filt[1] < 0.01);
+  CHECK(err_filt[2] < 0.05);
+  CHECK(err_filt[3] < 0.01);
+  printf("%s %s: rms error still %.4f (raw %.4f), slow %.4f, fast %.4f, ramp %.4f\n", TEST_NAME,
+         type == KEYPOINT_FILTER_KALMAN ? "kalman" : "one-euro", err_filt[0], err_raw[0], err_filt[1], err_filt[2],
+         err_filt[3]);
+}
+
+/* Kalman coasting over missed detections, prediction between frames, disabled filter */
+static void test_prediction(void)
+{
+  static KeypointFilter_t filter;
+  spe_pp_outBuffer_t kp[NB_KP];
+  uint32_t t = 0;
+
+  KeypointFilter_InitKalman(&filter, &kalman_params, MIN_CONFIDENCE);
+  /* Constant velocity of 0.3 per second along x */
+  for (int n = 0; n < 60; n++, t += FRAME_MS)
+  {
+    for (int k = 0; k < NB_KP; k++)
+    {
+      kp[k].x_center = 0.1f + 0.3f * t / 1000.0f;
+      kp[k].y_center = 0.5f;
+      kp[k].proba = 0.9f;
+    }
+    KeypointFilter_Apply(&filter, kp, t);
+  }
+  CHECK_NEAR(kp[0].x_center, 0.1 + 0.3 * (t - FRAME_MS) / 1000.0, 1e-3);
+
+  /* Between frames: extrapolated along the speed, bounded to 200 ms and to the image */
+  spe_pp_outBuffer_t pred[NB_KP];
+  uint32_t last = t - FRAME_MS;
+  memcpy(pred, kp, sizeof(pred));
+  KeypointFilter_Predict(&filter, pred, last + 20);
+  CHECK_NEAR(pred[0].x_center, kp[0].x_center + 0.3 * 0.020, 1e-3);
+  CHECK_NEAR(pred[0].y_center, 0.5, 1e-3);
+  KeypointFilter_Predict(&filter, pred, last + 1000);
+  CHECK_NEAR(pred[0].x_center, kp[0].x_center + 0.3 * 0.200, 1e-3);
+
+  /* Missed detections: the track keeps going for 5 frames, then is dropped */
+  for (int n = 1; n <= 7; n++, t += FRAME_MS)
+  {
+    for (int k = 0; k < NB_KP; k++)
+    {
+      kp[k].x_center = 0.0f;
+      kp[k].proba = 0.1f;
+    }
+    KeypointFilter_Apply(&filter, kp, t);
+    if (n <= 5)
+    {
+      CHECK(filter.tracked[0]);
+      CHECK_NEAR(kp[0].x_center, 0.1 + 0.3 * t / 1000.0, 2e-3);
+    }
+    else
+    {
+      CHECK(!filter.tracked[0]);
+      CHECK(kp[0].x_center == 0.0f);
+    }
+  }
+
+  /* Near the border, the prediction stays within the image */
+  KeypointFilter_Reset(&filter);
+  for (int n = 0; n < 30; n++, t += FRAME_MS)
+  {
+    for (int k = 0; k < NB_KP; k++)
+    {
+      kp[k].x_center = 0.7f + 0.01f * n;
+      kp[k].proba = 0.9f;
+    }
+    KeypointFilter_Apply(&filter, kp, t);
+  }
+  KeypointFilter_Predict(&filter, kp, t + 1000);
+  CHECK(kp[0].x_center <= 1.0f);
+
+  /* Disabled filter */
+  KeypointFilter_t none = { .type = KEYPOINT_FILTER_NONE };
+  spe_pp_outBuffer_t raw[NB_KP];
+  memcpy(raw, kp, sizeof(raw));
+  KeypointFilter_Apply(&none, kp, t);
+  KeypointFilter_Predict(&none, kp, t + 10);
+  CHECK(memcmp(raw, kp, sizeof(raw)) == 0);
+}
+
+/* Keypoints jumping across the whole image every frame, long pauses: the Q7.24 state must not overflow */
+static void test_range(void)
+{
+  static KeypointFilter_t filter;
+  spe_pp_outBuffer_t kp[NB_KP];
+
+  for (int type = KEYPOINT_FILTER_ONE_EURO; type <= KEYPOINT_FILTER_KALMAN; type++)
+  {
+    if (type == KEYPOINT_FILTER_KALMAN)
+      KeypointFilter_InitKalman(&filter, &kalman_params, MIN_CONFIDENCE);
+    else
+      KeypointFilter_InitOneEuro(&filter, &one_euro_params, MIN_CONFIDENCE);
+    for (int n = 0; n < 300; n++)
+    {
+      for (int k = 0; k < NB_KP; k++)
+      {
+        kp[k].x_center = (n + k) & 1 ? 1.0f : 0.0f;
+        kp[k].y_center = (n / 3) & 1 ? 1.0f : 0.0f;
+        kp[k].proba = 0.9f;
+      }
+      /* Shortest frame period */
+      KeypointFilter_Apply(&filter, kp, n * 10);
+      for (int k = 0; k < NB_KP; k++)
+      {
+        CHECK(kp[k].x_center >= -0.5f && kp[k].x_center <= 1.5f);
+        CHECK(kp[k].y_center >= -0.5f && kp[k].y_center <= 1.5f);
+      }
+    }
+    /* Ten minutes without any frame, then a still keypoint */
+    for (int n = 0; n < 30; n++)
+    {
+      for (int k = 0; k < NB_KP; k++)
+      {
+        kp[k].x_center = kp[k].y_center = 0.5f;
+        kp[k].proba = 0.9f;
+      }
+      KeypointFilter_Apply(&filter, kp, 3000 + 600000 + n * FRAME_MS);
+    }
+    CHECK_NEAR(kp[0].x_center, 0.5, 0.05);
+    CHECK_NEAR(kp[0].y_center, 0.5, 0.05);
+  }
+}
+
+static void bench(void)
+{
+  static KeypointFilter_t filter;
+  spe_pp_outBuffer_t kp[NB_KP];
+  const int runs = 200000;
+
+  for (int type = KEYPOINT_FILTER_ONE_EURO; type <= KEYPOINT_FILTER_KALMAN; type++)
+  {
+    uint64_t t0;
+
+    if (type == KEYPOINT_FILTER_KALMAN)
+      KeypointFilter_InitKalman(&filter, &kalman_params, MIN_CONFIDENCE);
+    else
+      KeypointFilter_InitOneEuro(&filter, &one_euro_params, MIN_CONFIDENCE);
+    t0 = host_test_ns();
+    for (int n = 0; n < runs; n++)
+    {
+      for (int k = 0; k < NB_KP; k++)
+      {
+        kp[k].x_center = 0.5f + 0.001f * (n & 7);
+        kp[k].y_center = 0.5f;
+        kp[k].proba = 0.9f;
+      }
+      KeypointFilter_Apply(&filter, kp, n * FRAME_MS);
+    }
+    printf("%s %s: %.1f ns per frame of %d keypoints\n", TEST_NAME,
+           type == KEYPOINT_FILTER_KALMAN ? "kalman" : "one-euro", (double) (host_test_ns() - t0) / runs, NB_KP);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  test_reference(KEYPOINT_FILTER_ONE_EURO);
+  test_reference(KEYPOINT_FILTER_KALMAN);
+  test_smoothing(KEYPOINT_FILTER_ONE_EURO);
+  test_smoothing(KEYPOINT_FILTER_KALMAN);
+  test_prediction();
+  test_range();
+  if (host_test_bench(argc, argv))
+    bench();
+
+  return host_test_result(TEST_NAME);
+}
@@ -0,0 +1,243 @@
+/**
+ ******************************************************************************
+ * @file    test_keypoint_history.c
+ * @brief   Structure-of-arrays keypoint history of the gesture detection,
+ *          against the array-of-structures history it replaced
+ ******************************************************************************
+ */
+
+#include <stdlib.h>
+#include "host_test.h"
+#include "keypoint_history.h"
+
+#define NB_KP AI_POSE_PP_POSE_KEYPOINTS_NB
+
+/* Array-of-structures history and speed query of the former gesture_detection.c */
+#define AOS_HISTORY_SIZE 40
+
+typedef struct {
+  float32_t x;
+  float32_t y;
+  float32_t confidence;
+  uint32_t timestamp;
+} AosEntry_t;
+
+typedef struct {
+  AosEntry_t history[NB_KP][AOS_HISTORY_SIZE];
+  uint8_t history_index;
+} AosHistory_t;
+
+static void aos_push(AosHistory_t *h, const spe_pp_outBuffer_t *keypoints, uint32_t timestamp)
+{
+  h->history_index = (h->history_index + 1) % AOS_HISTORY_SIZE;
+  for (int i = 0; i < NB_KP; i++)
+  {
+    h->history[i][h->history_index].x = keypoints[i].x_center;
+    h->history[i][h->history_index].y = keypoints[i].y_center;
+    h->history[i][h->history_index].confidence = keypoints[i].proba;
+    h->history[i][h->history_index].timestamp = timestamp;
+  }
+}
+
+static float32_t aos_speed(AosEntry_t *history, uint8_t current_idx, uint8_t frames_back)
+{
+  if (frames_back >= AOS_HISTORY_SIZE)
+    return 0.0f;
+
+  uint8_t prev_idx = (current_idx - frames_back + AOS_HISTORY_SIZE) % AOS_HISTORY_SIZE;
+  float32_t dx = history[current_idx].x - history[prev_idx].x;
+  float32_t dy = history[current_idx].y - history[prev_idx].y;
+  uint32_t time_diff = history[current_idx].timestamp - history[prev_idx].timestamp;
+
+  if (time_diff == 0)
+    return 0.0f;
+  return sqrtf(dx * dx + dy * dy) / (time_diff / 1000.0f);
+}
+
+static KeypointHistory_t soa;
+static AosHistory_t aos;
+
+static void random_frame(spe_pp_outBuffer_t *keypoints)
+{
+  for (int i = 0; i < NB_KP; i++)
+  {
+    keypoints[i].x_center = rand() / (float) RAND_MAX;
+    keypoints[i].y_center = rand() / (float) RAND_MAX;
+    keypoints[i].proba = rand() / (float) RAND_MAX;
+  }
+}
+
+/* Frames are kept in order over several wraps of the ring, the queries match the former history */
+static void test_against_aos(void)
+{
+  spe_pp_outBuffer_t frames[100][NB_KP];
+  uint32_t time = 1000;
+
+  srand(5);
+  KeypointHistory_Init(&soa);
+  memset(&aos, 0, sizeof(aos));
+  CHECK(!KeypointHistory_Has(&soa, 0));
+
+  for (int n = 0; n < 100; n++)
+  {
+    random_frame(frames[n]);
+    /* Irregular frame intervals, one repeated timestamp */
+    time += (n == 50) ? 0 : 25 + rand() % 20;
+    KeypointHistory_Push(&soa, frames[n], time);
+    aos_push(&aos, frames[n], time);
+
+    CHECK_EQ(soa.head, n + 1);
+    CHECK(KeypointHistory_Has(&soa, 0));
+    CHECK_EQ(KeypointHistory_Has(&soa, n), n < KEYPOINT_HISTORY_SIZE);
+    CHECK(!KeypointHistory_Has(&soa, n + 1));
+    CHECK(!KeypointHistory_Has(&soa, KEYPOINT_HISTORY_SIZE));
+
+    for (uint32_t back = 0; back <= (uint32_t) n && back < KEYPOINT_HISTORY_SIZE; back++)
+    {
+      for (int k = 0; k < NB_KP; k++)
+      {
+        CHECK(KeypointHistory_X(&soa, k, back) == frames[n - back][k].x_center);
+        CHECK(KeypointHistory_Y(&soa, k, back) == frames[n - back][k].y_center);
+        CHECK(KeypointHistory_Confidence(&soa, k, back) == frames[n - back][k].proba);
+      }
+    }
+
+    /* Speeds from the latest frame and from older ones */
+    for (uint32_t from = 0; from < 4; from++)
+    {
+      for (uint32_t back = 1; from + back <= (uint32_t) n && from + back < KEYPOINT_HISTORY_SIZE; back++)
+      {
+        uint8_t idx = (aos.history_index - from + AOS_HISTORY_SIZE) % AOS_HISTORY_SIZE;
+
+        for (int k = 0; k < NB_KP; k++)
+          CHECK(KeypointHistory_Speed(&soa, k, from, back) == aos_speed(aos.history[k], idx, back));
+      }
+    }
+    /* Not stored yet, or not any more */
+    CHECK(KeypointHistory_Speed(&soa, 0, 0, n + 1) == 0.0f);
+    CHECK(KeypointHistory_Speed(&soa, 0, 0, KEYPOINT_HISTORY_SIZE) == 0.0f);
+  }
+}
+
+/* Bulk queries are the single keypoint queries over all the keypoints */
+static void test_bulk(void)
+{
+  spe_pp_outBuffer_t frame[NB_KP];
+  float32_t speed[NB_KP], dx[NB_KP], dy[NB_KP];
+  float32_t min_x[NB_KP], max_x[NB_KP], min_y[NB_KP], max_y[NB_KP];
+
+  srand(9);
+  KeypointHistory_Init(&soa);
+  for (int n = 0; n < 45; n++)
+  {
+    random_frame(frame);
+    KeypointHistory_Push(&soa, frame, 40 * n);
+
+    for (uint32_t frames = 1; frames < KEYPOINT_HISTORY_SIZE + 2; frames++)
+    {
+      KeypointHistory_SpeedAll(&soa, frames, speed);
+      KeypointHistory_DisplacementAll(&soa, frames, dx, dy);
+      KeypointHistory_ExtremumAll(&soa, frames, min_x, max_x, min_y, max_y);
+
+      uint32_t window = frames;
+      if (window > (uint32_t) n)
+        window = n;
+      if (window > KEYPOINT_HISTORY_SIZE - 1)
+        window = KEYPOINT_HISTORY_SIZE - 1;
+
+      for (int k = 0; k < NB_KP; k++)
+      {
+        int stored = KeypointHistory_Has(&soa, frames);
+        float32_t lo_x = KeypointHistory_X(&soa, k, 0), hi_x = lo_x;
+        float32_t lo_y = KeypointHistory_Y(&soa, k, 0), hi_y = lo_y;
+
+        CHECK_NEAR(speed[k], KeypointHistory_Speed(&soa, k, 0, frames), 1e-5);
+        CHECK(dx[k] == (stored ? KeypointHistory_X(&soa, k, 0) - KeypointHistory_X(&soa, k, frames) : 0.0f));
+        CHECK(dy[k] == (stored ? KeypointHistory_Y(&soa, k, 0) - KeypointHistory_Y(&soa, k, frames) : 0.0f));
+
+        /* Window limited to the frames stored */
+        for (uint32_t back = 1; back <= window; back++)
+        {
+          lo_x = fminf(lo_x, KeypointHistory_X(&soa, k, back));
+          hi_x = fmaxf(hi_x, KeypointHistory_X(&soa, k, back));
+          lo_y = fminf(lo_y, KeypointHistory_Y(&soa, k, back));
+          hi_y = fmaxf(hi_y, KeypointHistory_Y(&soa, k, back));
+        }
+        CHECK(min_x[k] == lo_x && max_x[k] == hi_x);
+        CHECK(min_y[k] == lo_y && max_y[k] == hi_y);
+      }
+    }
+  }
+}
+
+/* Per-frame work of the gesture detection: push, speeds over 3 frames, displacements and extrema over 12 frames */
+static void bench(void)
+{
+  const int runs = 200000;
+  spe_pp_outBuffer_t frames[64][NB_KP];
+  float32_t speed[NB_KP], dx[NB_KP], dy[NB_KP];
+  float32_t min_x[NB_KP], max_x[NB_KP], min_y[NB_KP], max_y[NB_KP];
+  volatile float32_t sink = 0;
+  uint64_t t0, aos_ns, soa_ns;
+
+  for (int n = 0; n < 64; n++)
+    random_frame(frames[n]);
+
+  memset(&aos, 0, sizeof(aos));
+  t0 = host_test_ns();
+  for (int n = 0; n < runs; n++)
+  {
+    aos_push(&aos, frames[n & 63], 33 * n);
+    uint8_t curr = aos.history_index;
+    uint8_t prev = (curr - 12 + AOS_HISTORY_SIZE) % AOS_HISTORY_SIZE;
+
+    for (int k = 0; k < NB_KP; k++)
+    {
+      AosEntry_t *h = aos.history[k];
+
+      speed[k] = aos_speed(h, curr, 3);
+      dx[k] = h[curr].x - h[prev].x;
+      dy[k] = h[curr].y - h[prev].y;
+      min_x[k] = max_x[k] = h[curr].x;
+      min_y[k] = max_y[k] = h[curr].y;
+      for (int back = 1; back <= 12; back++)
+      {
+        AosEntry_t *e = &h[(curr - back + AOS_HISTORY_SIZE) % AOS_HISTORY_SIZE];
+
+        /* Same arithmetic as KeypointHistory_ExtremumAll(), only the layout differs */
+        min_x[k] = e->x < min_x[k] ? e->x : min_x[k];
+        max_x[k] = e->x > max_x[k] ? e->x : max_x[k];
+        min_y[k] = e->y < min_y[k] ? e->y : min_y[k];
+        max_y[k] = e->y > max_y[k] ? e->y : max_y[k];
+      }
+    }
+    sink += speed[n % NB_KP] + dx[0] + dy[0] + min_x[1] + max_x[2] + min_y[3] + max_y[4];
+  }
+  aos_ns = host_test_ns() - t0;
+
+  KeypointHistory_Init(&soa);
+  t0 = host_test_ns();
+  for (int n = 0; n < runs; n++)
+  {
+    KeypointHistory_Push(&soa, frames[n & 63], 33 * n);
+    KeypointHistory_SpeedAll(&soa, 3, speed);
+    KeypointHistory_DisplacementAll(&soa, 12, dx, dy);
+    KeypointHistory_ExtremumAll(&soa, 12, min_x, max_x, min_y, max_y);
+    sink += speed[n % NB_KP] + dx[0] + dy[0] + min_x[1] + max_x[2] + min_y[3] + max_y[4];
+  }
+  soa_ns = host_test_ns() - t0;
+
+  printf("history per frame: AoS %.1f ns (%u bytes), SoA %.1f ns (%u bytes)\n", (double) aos_ns / runs,
+         (unsigned) sizeof(AosHistory_t), (double) soa_ns / runs, (unsigned) sizeof(KeypointHistory_t));
+  (void) sink;
+}
+
+int main(int argc, char **argv)
+{
+  test_against_aos();
+  test_bulk();
+  if (host_test_bench(argc, argv))
+    bench();
+
+  return host_test_result("test_keypoint_history");
+}
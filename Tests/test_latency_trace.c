@@ -0,0 +1,278 @@
+/**
+ ******************************************************************************
+ * @file    test_latency_trace.c
+ * @brief   Lock-free event ring and per-stage statistics of the latency trace,
+ *          timestamped by a mocked clock
+ ******************************************************************************
+ * Built with mock_clock.h as timestamp source. The statistics are checked on
+ * scripted durations, the ring on overflow and on concurrent producers
+ * (threads standing for the interrupt handlers) with a concurrent consumer:
+ * no event may be torn or reordered, and every event must be either read or
+ * counted as lost.
+ ******************************************************************************
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include "host_test.h"
+#include "latency_trace.h"
+
+__thread uint32_t mock_clock;
+
+static void span(LatencyStage_t stage, uint32_t begin_ts, uint32_t duration)
+{
+  mock_clock = begin_ts;
+  LatencyTrace_Begin(stage);
+  mock_clock = begin_ts + duration;
+  LatencyTrace_End(stage);
+}
+
+static void test_stats(void)
+{
+  LatencyStats_t stats;
+
+  LatencyTrace_Init(1000000);
+  LatencyTrace_GetStats(LATENCY_STAGE_ISP, &stats);
+  CHECK_EQ(stats.count, 0);
+  CHECK_EQ(stats.max, 0);
+
+  /* Durations 1 to 300 in shuffled order: the window holds the last LATENCY_TRACE_WINDOW ones */
+  for (uint32_t i = 0; i < 300; i++)
+  {
+    span(LATENCY_STAGE_ISP, 1000 * i, 1 + (i * 7) % 300);
+    if (i % 50 == 49)
+      LatencyTrace_Process();
+  }
+  LatencyTrace_Process();
+  LatencyTrace_GetStats(LATENCY_STAGE_ISP, &stats);
+  {
+    uint32_t window[LATENCY_TRACE_WINDOW];
+    uint64_t sum = 0;
+    uint32_t min = UINT32_MAX, max = 0, above;
+
+    for (uint32_t i = 0; i < LATENCY_TRACE_WINDOW; i++)
+    {
+      window[i] = 1 + ((300 - LATENCY_TRACE_WINDOW + i) * 7) % 300;
+      sum += window[i];
+      min = window[i] < min ? window[i] : min;
+      max = window[i] > max ? window[i] : max;
+    }
+    CHECK_EQ(stats.count, LATENCY_TRACE_WINDOW);
+    CHECK_EQ(stats.total, 300);
+    CHECK_EQ(stats.min, min);
+    CHECK_EQ(stats.max, max);
+    CHECK_EQ(stats.avg, sum / LATENCY_TRACE_WINDOW);
+    /* Nearest rank: at most 1% of the window above the p99, and the p99 is one of the durations */
+    above = 0;
+    for (uint32_t i = 0; i < LATENCY_TRACE_WINDOW; i++)
+      above += window[i] > stats.p99;
+    CHECK(above >= 1 && above <= LATENCY_TRACE_WINDOW / 100);
+  }
+
+  /* A single outlier among 200 durations does not move the p99 */
+  LatencyTrace_ResetStats();
+  for (uint32_t i = 0; i < 200; i++)
+    span(LATENCY_STAGE_CROP, 10 * i, i == 150 ? 5000 : 40 + i % 3);
+  LatencyTrace_Process();
+  LatencyTrace_GetStats(LATENCY_STAGE_CROP, &stats);
+  CHECK_EQ(stats.max, 5000);
+  CHECK_EQ(stats.p99, 42);
+  CHECK_EQ(stats.min, 40);
+
+  /* Timestamp wrap, unmatched events, restarted stage */
+  LatencyTrace_ResetStats();
+  span(LATENCY_STAGE_GESTURE, 0xfffffff0, 0x30);
+  mock_clock = 100;
+  LatencyTrace_End(LATENCY_STAGE_GESTURE);
+  LatencyTrace_Begin(LATENCY_STAGE_GESTURE);
+  mock_clock = 200;
+  LatencyTrace_Begin(LATENCY_STAGE_GESTURE);
+  mock_clock = 250;
+  LatencyTrace_End(LATENCY_STAGE_GESTURE);
+  LatencyTrace_Process();
+  LatencyTrace_GetStats(LATENCY_STAGE_GESTURE, &stats);
+  CHECK_EQ(stats.count, 2);
+  CHECK_EQ(stats.min, 0x30);
+  CHECK_EQ(stats.max, 50);
+
+  /* Stages are independent, nested ones included */
+  mock_clock = 1000;
+  LatencyTrace_Begin(LATENCY_STAGE_INFERENCE);
+  span(LATENCY_STAGE_NPU_EPOCH, 1010, 20);
+  span(LATENCY_STAGE_NPU_EPOCH, 1040, 30);
+  mock_clock = 1100;
+  LatencyTrace_End(LATENCY_STAGE_INFERENCE);
+  LatencyTrace_Process();
+  LatencyTrace_GetStats(LATENCY_STAGE_INFERENCE, &stats);
+  CHECK(stats.count == 1 && stats.max == 100);
+  LatencyTrace_GetStats(LATENCY_STAGE_NPU_EPOCH, &stats);
+  CHECK(stats.count == 2 && stats.min == 20 && stats.max == 30 && stats.avg == 25);
+  CHECK_EQ(LatencyTrace_GetLost(), 0);
+}
+
+static void test_report(void)
+{
+  char buffer[512];
+  char small[40];
+  int len;
+
+  /* 400 MHz clock: durations reported in us */
+  LatencyTrace_Init(400000000);
+  span(LATENCY_STAGE_POSTPROCESS, 0, 400 * 250);
+  span(LATENCY_STAGE_POSTPROCESS, 0, 400 * 350);
+  LatencyTrace_Process();
+  len = LatencyTrace_Report(buffer, sizeof(buffer));
+  CHECK_EQ(len, (int) strlen(buffer));
+  CHECK(strstr(buffer, "postprocess") != NULL);
+  CHECK(strstr(buffer, "   250    300    350    350            2") != NULL);
+  /* Stages without durations are not reported */
+  CHECK(strstr(buffer, "draw") == NULL);
+
+  len = LatencyTrace_Report(small, sizeof(small));
+  CHECK_EQ(len, (int) sizeof(small) - 1);
+  CHECK_EQ(strlen(small), sizeof(small) - 1);
+}
+
+/* Overflow without concurrency: the oldest events are lost, the others read in order */
+static void test_overflow(void)
+{
+  const uint32_t produced = LATENCY_TRACE_NB_EVENTS + 88;
+  LatencyEvent_t event;
+  uint32_t popped = 0;
+
+  LatencyTrace_Init(1000000);
+  for (uint32_t i = 0; i < produced; i++)
+  {
+    mock_clock = 3 * i;
+    LatencyTrace_Event(LATENCY_STAGE_DRAW, LATENCY_EVENT_BEGIN, i);
+  }
+  while (LatencyTrace_Pop(&event))
+  {
+    uint32_t i = popped + produced - LATENCY_TRACE_NB_EVENTS;
+
+    CHECK(event.seq == i + 1 && event.ts == 3 * i && event.arg == (uint16_t) i);
+    popped++;
+  }
+  CHECK_EQ(popped, LATENCY_TRACE_NB_EVENTS);
+  CHECK_EQ(LatencyTrace_GetLost(), produced - LATENCY_TRACE_NB_EVENTS);
+  CHECK(!LatencyTrace_Pop(&event));
+}
+
+/*
+ * Concurrent producers, each on its own stage with its own clock. The
+ * timestamp encodes the producer and its event counter, the argument the
+ * counter: a torn event breaks the encoding.
+ */
+#define NB_PRODUCERS 4
+#define EVENTS_PER_PRODUCER 200000
+
+static int producers_running;
+
+static void *producer(void *arg)
+{
+  uint32_t id = (uintptr_t) arg;
+
+  for (uint32_t n = 0; n < EVENTS_PER_PRODUCER; n++)
+  {
+    mock_clock = id << 24 | n;
+    LatencyTrace_Event((LatencyStage_t) id, n & 1, n & 0xffff);
+    /* Bursts then pauses: the consumer alternately falls behind and catches up */
+    if (n % 1024 == 0)
+      sched_yield();
+  }
+  __atomic_fetch_sub(&producers_running, 1, __ATOMIC_RELEASE);
+  return NULL;
+}
+
+static void test_concurrent(int bench)
+{
+  pthread_t threads[NB_PRODUCERS];
+  int32_t last[NB_PRODUCERS];
+  uint32_t popped = 0, bad = 0;
+  int running;
+  LatencyEvent_t event;
+
+  LatencyTrace_Init(1000000);
+  producers_running = NB_PRODUCERS;
+  for (int i = 0; i < NB_PRODUCERS; i++)
+  {
+    last[i] = -1;
+    pthread_create(&threads[i], NULL, producer, (void *) (uintptr_t) i);
+  }
+
+  /* The last drain starts once all the producers are done: nothing is left in flight */
+  do
+  {
+    running = __atomic_load_n(&producers_running, __ATOMIC_ACQUIRE);
+    while (LatencyTrace_Pop(&event))
+    {
+      uint32_t id = event.ts >> 24;
+      uint32_t n = event.ts & 0xffffff;
+
+      popped++;
+      if (id >= NB_PRODUCERS || id != event.stage || event.kind != (n & 1) || event.arg != (n & 0xffff) ||
+          (int32_t) n <= last[id])
+      {
+        bad++;
+        continue;
+      }
+      last[id] = n;
+    }
+  } while (running);
+
+  for (int i = 0; i < NB_PRODUCERS; i++)
+    pthread_join(threads[i], NULL);
+  CHECK_EQ(bad, 0);
+  CHECK_EQ(popped + LatencyTrace_GetLost(), NB_PRODUCERS * EVENTS_PER_PRODUCER);
+  CHECK(popped > 0);
+  if (bench)
+    printf("%u producers, %u events: %u read, %u lost\n", NB_PRODUCERS, NB_PRODUCERS * EVENTS_PER_PRODUCER,
+           popped, LatencyTrace_GetLost());
+}
+
+static void bench(void)
+{
+  const int runs = 1000000;
+  uint64_t t0, event_ns, process_ns = 0;
+
+  LatencyTrace_Init(1000000);
+  t0 = host_test_ns();
+  for (int n = 0; n < runs; n++)
+  {
+    mock_clock = n;
+    LatencyTrace_Event(LATENCY_STAGE_ISP, n & 1, 0);
+    if ((n & 255) == 255)
+    {
+      uint64_t t1 = host_test_ns();
+
+      LatencyTrace_Process();
+      process_ns += host_test_ns() - t1;
+    }
+  }
+  event_ns = host_test_ns() - t0 - process_ns;
+  printf("LatencyTrace_Event %.1f ns, LatencyTrace_Process %.1f ns per event\n",
+         (double) event_ns / runs, (double) process_ns / runs);
+
+  t0 = host_test_ns();
+  for (int n = 0; n < 10000; n++)
+  {
+    LatencyStats_t stats;
+
+    LatencyTrace_GetStats(LATENCY_STAGE_ISP, &stats);
+  }
+  printf("LatencyTrace_GetStats %.2f us per stage\n", (host_test_ns() - t0) / 1e3 / 10000);
+}
+
+int main(int argc, char **argv)
+{
+  int bench_mode = host_test_bench(argc, argv);
+
+  test_stats();
+  test_report();
+  test_overflow();
+  test_concurrent(bench_mode);
+  if (bench_mode)
+    bench();
+
+  return host_test_result("test_latency_trace");
+}
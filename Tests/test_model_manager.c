@@ -0,0 +1,549 @@
+/**
+ ******************************************************************************
+ * @file    test_model_manager.c
+ * @brief   Model manager and relocatable loader of the ATON runtime on
+ *          synthetic relocatable images, host simulation platform
+ ******************************************************************************
+ * The NOR slots (mock_nor.h) hold synthetic images laid out as the loader
+ * reads them: header, text, rodata, data and GOT sections with tagged
+ * addresses, relocation table, memory pool descriptors and weights. On the
+ * host simulation platform the text section holds the addresses of the host
+ * functions standing for the entry points, R9 being emulated by the loader.
+ * Erased, foreign and oversized slots must be skipped, every tagged address
+ * relocated to the slot, the exec arena, the weights or the external RAM
+ * pool, and switching back to a cached image must only restore its pools.
+ ******************************************************************************
+ */
+
+#include "host_test.h"
+#include "model_manager.h"
+#include "ll_aton_version.h"
+
+__attribute__ ((aligned (32)))
+uint8_t mock_nor[MODEL_MANAGER_NB_SLOTS * MODEL_MANAGER_SLOT_SIZE];
+
+/* Internal RAM overwritten by the COPY pools of all the models */
+__attribute__ ((aligned (8)))
+static uint8_t npu_ram[128];
+
+/* Header of the binary, as read by the loader (see ll_aton_reloc_network.c) */
+enum {
+  ENTRY_EC_NETWORK_INIT,
+  ENTRY_EC_INFERENCE_INIT,
+  ENTRY_INPUT_SETTER,
+  ENTRY_INPUT_GETTER,
+  ENTRY_OUTPUT_SETTER,
+  ENTRY_OUTPUT_GETTER,
+  ENTRY_EPOCH_ITEMS,
+  ENTRY_OUTPUT_BUFFERS,
+  ENTRY_INPUT_BUFFERS,
+  ENTRY_INTERNAL_BUFFERS,
+  NB_ENTRIES,
+};
+
+typedef struct {
+  uint32_t magic;
+  uint32_t flags;
+  uint32_t data_start, data_end, data_data, bss_start, bss_end, got_start, got_end, rel_start, rel_end;
+  uint32_t params_start, params_offset;
+  uint32_t entries[NB_ENTRIES];
+  uint32_t ctx;
+} Image_Header_t;
+
+/* Data section, relocated into the exec arena, followed by the GOT */
+#define NB_GOT 5
+
+typedef struct {
+  struct ai_reloc_rt_ctx ctx;
+  NN_Interface_TypeDef itf;
+  EpochBlock_ItemTypeDef ebs[5];
+  LL_Buffer_InfoTypeDef buffers[2];
+  ll_aton_reloc_mem_pool_desc mpools[4];
+  uint32_t got[NB_GOT];
+} Image_Data_t;
+
+/* Tagged addresses: offsets in the binary, the relocated data, the weights and the external RAM pool */
+#define FLASH(off)  (0x20000000UL | (off))
+#define RAM(off)    (0x40000000UL | (off))
+#define PARAM0(off) (0x80000000UL | (off))
+#define PARAM1(off) (0x90000000UL | (off))
+
+/* File layout */
+#define TEXT_OFF      sizeof(Image_Header_t)
+#define RODATA_OFF    (TEXT_OFF + (NB_ENTRIES + 1) * sizeof(uintptr_t))
+#define NAME_OFF      (RODATA_OFF)
+#define DESC_OFF      (RODATA_OFF + 32)
+#define POOL_NAME_OFF (RODATA_OFF + 64)
+#define DATA_OFF      512
+#define REL_OFF       (DATA_OFF + ((sizeof(Image_Data_t) + 7) & ~7UL))
+#define WEIGHTS_OFF   4096
+#define WEIGHTS_SIZE  1024
+
+/* Pools: weights read in place, a part copied to the internal RAM, another one to the external RAM pool */
+#define MPOOL_FLAGS(type, dtype, attr, id) ((type) << 24 | (dtype) << 16 | (attr) << 8 | (id))
+#define COPY_FOFF  256
+#define EXT_FOFF   512
+#define EXT_SIZE   64
+
+_Static_assert(sizeof(Image_Data_t) < 1024 && POOL_NAME_OFF + 32 <= DATA_OFF, "image layout");
+_Static_assert(REL_OFF + 16 * sizeof(uint32_t) <= WEIGHTS_OFF, "image layout");
+
+static uint8_t *slot_addr(int slot)
+{
+  return &mock_nor[slot * MODEL_MANAGER_SLOT_SIZE];
+}
+
+/* Entry points of the images, called with the relocated data of their model as R9 */
+static uintptr_t last_r9;
+static uint32_t network_inits;
+static uint32_t sw_blocks, misplaced_sw_blocks;
+
+static uintptr_t entry_ec_network_init(uintptr_t arg1, uintptr_t arg2, uintptr_t arg3)
+{
+  last_r9 = ai_reloc_host_sim_r9;
+  network_inits++;
+  return true;
+}
+
+static uintptr_t entry_ec_inference_init(uintptr_t arg1, uintptr_t arg2, uintptr_t arg3)
+{
+  last_r9 = ai_reloc_host_sim_r9;
+  return true;
+}
+
+static uintptr_t entry_no_user_io(uintptr_t arg1, uintptr_t arg2, uintptr_t arg3)
+{
+  return LL_ATON_User_IO_WRONG_INDEX;
+}
+
+static uintptr_t entry_no_buffer(uintptr_t arg1, uintptr_t arg2, uintptr_t arg3)
+{
+  return 0;
+}
+
+static uintptr_t entry_epoch_items(uintptr_t arg1, uintptr_t arg2, uintptr_t arg3)
+{
+  last_r9 = ai_reloc_host_sim_r9;
+  return (uintptr_t) ((const Image_Data_t *) ai_reloc_host_sim_r9)->ebs;
+}
+
+static uintptr_t entry_internal_buffers(uintptr_t arg1, uintptr_t arg2, uintptr_t arg3)
+{
+  return (uintptr_t) ((const Image_Data_t *) ai_reloc_host_sim_r9)->buffers;
+}
+
+static void image_sw_block(const void *epoch_block)
+{
+  const Image_Data_t *data = (const Image_Data_t *) ai_reloc_host_sim_r9;
+
+  if (epoch_block == &data->ebs[0] || epoch_block == &data->ebs[2])
+    sw_blocks++;
+  else
+    misplaced_sw_blocks++;
+}
+
+static const uintptr_t image_text[NB_ENTRIES + 1] = {
+  [ENTRY_EC_NETWORK_INIT] = (uintptr_t) entry_ec_network_init,
+  [ENTRY_EC_INFERENCE_INIT] = (uintptr_t) entry_ec_inference_init,
+  [ENTRY_INPUT_SETTER] = (uintptr_t) entry_no_user_io,
+  [ENTRY_INPUT_GETTER] = (uintptr_t) entry_no_buffer,
+  [ENTRY_OUTPUT_SETTER] = (uintptr_t) entry_no_user_io,
+  [ENTRY_OUTPUT_GETTER] = (uintptr_t) entry_no_buffer,
+  [ENTRY_EPOCH_ITEMS] = (uintptr_t) entry_epoch_items,
+  [ENTRY_OUTPUT_BUFFERS] = (uintptr_t) entry_no_buffer,
+  [ENTRY_INPUT_BUFFERS] = (uintptr_t) entry_no_buffer,
+  [ENTRY_INTERNAL_BUFFERS] = (uintptr_t) entry_internal_buffers,
+  [NB_ENTRIES] = (uintptr_t) image_sw_block,
+};
+
+/* Relocated words of the data section */
+static const uint32_t image_rel[] = {
+  offsetof(Image_Data_t, ctx.c_name),
+  offsetof(Image_Data_t, ctx.rt_version_desc),
+  offsetof(Image_Data_t, ctx.itf_network),
+  offsetof(Image_Data_t, itf.network_name),
+  offsetof(Image_Data_t, ebs[0].end_epoch_block),
+  offsetof(Image_Data_t, ebs[1].blob_address),
+  offsetof(Image_Data_t, ebs[2].end_epoch_block),
+  offsetof(Image_Data_t, ebs[3].blob_address),
+  offsetof(Image_Data_t, buffers[0].name),
+};
+
+#define NB_REL (sizeof(image_rel) / sizeof(image_rel[0]))
+
+/* Not periodic over the pool offsets: a pool read from the wrong place must not match */
+static uint8_t weight(uint8_t seed, uint32_t i)
+{
+  return (uint8_t) (seed + i * 7 + (i >> 8));
+}
+
+/* Image of `c_name` requesting `rw_size` bytes of exec RAM in XIP mode */
+static void image_build(int slot, const char *c_name, uint32_t rw_size, uint8_t seed)
+{
+  uint8_t *bin = slot_addr(slot);
+  Image_Header_t *hdr = (Image_Header_t *) bin;
+  Image_Data_t *data = (Image_Data_t *) &bin[DATA_OFF];
+  uint32_t *rel = (uint32_t *) &bin[REL_OFF];
+  const EpochBlock_FuncPtr_t sw_block = (EpochBlock_FuncPtr_t) FLASH(TEXT_OFF + NB_ENTRIES * sizeof(uintptr_t));
+  const uint16_t sw_flags = EpochBlock_Flags_epoch_start | EpochBlock_Flags_epoch_end | EpochBlock_Flags_pure_sw;
+  const uint16_t blob_flags = EpochBlock_Flags_epoch_start | EpochBlock_Flags_epoch_end | EpochBlock_Flags_pure_hw |
+                              EpochBlock_Flags_blob;
+  const struct ai_reloc_rt_ctx ctx = {
+    .c_name = (const char *) FLASH(NAME_OFF),
+    .acts_sz = 0x40000,
+    .params_sz = WEIGHTS_SIZE,
+    .ext_ram_sz = EXT_SIZE,
+    .rt_version_desc = (const char *) FLASH(DESC_OFF),
+    .rt_version = LL_ATON_VERSION_MAJOR << 24 | LL_ATON_VERSION_MINOR << 16 | LL_ATON_VERSION_MICRO << 8,
+    .itf_network = (const NN_Interface_TypeDef *) RAM(offsetof(Image_Data_t, itf)),
+  };
+
+  memset(bin, 0, MODEL_MANAGER_SLOT_SIZE);
+  hdr->magic = AI_RELOC_MAGIC;
+  hdr->flags = (uint32_t) AI_RELOC_RT_SET_FLAGS(AI_RELOC_RT_SET_TOOLS(AI_RELOC_TOOLCHAIN_ARM_EMBEDDED) |
+                                       AI_RELOC_RT_SET_ABI(AI_RELOC_TOOLCHAIN_FP_ABI_HARD) | AI_RELOC_RT_SET_FPU(1) |
+                                       AI_RELOC_RT_SET_MCU_CONF(AI_RELOC_ARM_CORTEX_M55),
+                                     1 << 2 /* async */);
+  hdr->data_start = RAM(0);
+  hdr->data_end = RAM(offsetof(Image_Data_t, got));
+  hdr->data_data = FLASH(DATA_OFF);
+  hdr->got_start = RAM(offsetof(Image_Data_t, got));
+  hdr->got_end = RAM(sizeof(Image_Data_t));
+  hdr->bss_start = RAM(sizeof(Image_Data_t));
+  hdr->bss_end = RAM(rw_size);
+  hdr->rel_start = FLASH(REL_OFF);
+  hdr->rel_end = FLASH(REL_OFF + sizeof(image_rel));
+  hdr->params_start = RAM(offsetof(Image_Data_t, mpools));
+  hdr->params_offset = FLASH(WEIGHTS_OFF);
+  for (int i = 0; i < NB_ENTRIES; i++)
+    hdr->entries[i] = FLASH(TEXT_OFF + i * sizeof(uintptr_t));
+  hdr->ctx = RAM(offsetof(Image_Data_t, ctx));
+
+  memcpy(&bin[TEXT_OFF], image_text, sizeof(image_text));
+  strcpy((char *) &bin[NAME_OFF], c_name);
+  strcpy((char *) &bin[DESC_OFF], "host sim");
+  strcpy((char *) &bin[POOL_NAME_OFF], "act_pool");
+
+  memcpy(&data->ctx, &ctx, sizeof(ctx));
+  data->itf.network_name = (const char *) FLASH(NAME_OFF);
+  data->ebs[0] = (EpochBlock_ItemTypeDef) { .end_epoch_block = sw_block, .flags = sw_flags };
+  data->ebs[1] = (EpochBlock_ItemTypeDef) { .blob_address = PARAM0(0x100), .flags = blob_flags };
+  data->ebs[2] = (EpochBlock_ItemTypeDef) { .end_epoch_block = sw_block, .flags = sw_flags };
+  data->ebs[3] = (EpochBlock_ItemTypeDef) { .blob_address = PARAM1(0x20), .flags = blob_flags };
+  data->ebs[4] = (EpochBlock_ItemTypeDef) { .flags = EpochBlock_Flags_last_eb };
+  data->buffers[0] = (LL_Buffer_InfoTypeDef) { .name = (const char *) FLASH(POOL_NAME_OFF),
+                                               .addr_base = { .i = 0x34200000 }, .offset_end = 0x40000 };
+  data->mpools[0] = (ll_aton_reloc_mem_pool_desc) {
+    (const char *) FLASH(POOL_NAME_OFF),
+    MPOOL_FLAGS(AI_RELOC_MPOOL_TYPE_RELOC, AI_RELOC_MPOOL_DTYPE_PARAM, AI_RELOC_MPOOL_DATTR_READ, 0), 0, 0,
+    WEIGHTS_SIZE };
+  data->mpools[1] = (ll_aton_reloc_mem_pool_desc) {
+    (const char *) FLASH(POOL_NAME_OFF),
+    MPOOL_FLAGS(AI_RELOC_MPOOL_TYPE_COPY, AI_RELOC_MPOOL_DTYPE_PARAM, AI_RELOC_MPOOL_DATTR_READ, 0), COPY_FOFF,
+    (uint32_t) (uintptr_t) npu_ram, sizeof(npu_ram) };
+  data->mpools[2] = (ll_aton_reloc_mem_pool_desc) {
+    (const char *) FLASH(POOL_NAME_OFF),
+    MPOOL_FLAGS(AI_RELOC_MPOOL_TYPE_RELOC, AI_RELOC_MPOOL_DTYPE_MIXED,
+                AI_RELOC_MPOOL_DATTR_READ | AI_RELOC_MPOOL_DATTR_WRITE, 1), EXT_FOFF, 0, EXT_SIZE };
+  data->got[0] = RAM(offsetof(Image_Data_t, ebs));
+  data->got[1] = FLASH(NAME_OFF);
+  data->got[2] = PARAM0(16);
+  data->got[3] = PARAM1(8);
+  data->got[4] = 0;
+
+  memcpy(rel, image_rel, sizeof(image_rel));
+  for (uint32_t i = 0; i < NB_REL; i++)
+    rel[i] = RAM(rel[i]);
+
+  for (uint32_t i = 0; i < WEIGHTS_SIZE; i++)
+    bin[WEIGHTS_OFF + i] = weight(seed, i);
+}
+
+/* Slots: A, erased, B, foreign, oversized, C */
+#define SLOT_A 0
+#define SLOT_B 2
+#define SLOT_C 5
+#define RW_A   1024
+#define RW_B   1024
+#define RW_C   1536
+
+static void nor_build(void)
+{
+  image_build(SLOT_A, "pose_a", RW_A, 1);
+  memset(slot_addr(1), 0xff, MODEL_MANAGER_SLOT_SIZE);
+  image_build(SLOT_B, "pose_b", RW_B, 2);
+  for (uint32_t i = 0; i < MODEL_MANAGER_SLOT_SIZE; i++)
+    slot_addr(3)[i] = (uint8_t) (i * 13 + 5);
+  image_build(4, "pose_big", 2 * MODEL_MANAGER_EXEC_RAM_SIZE, 4);
+  image_build(SLOT_C, "pose_c", RW_C, 3);
+}
+
+static void test_scan(void)
+{
+  const ll_aton_reloc_info *info;
+
+  nor_build();
+  CHECK_EQ(ModelManager_Init(), 3);
+  CHECK_EQ(ModelManager_GetCount(), 3);
+  CHECK_EQ(ModelManager_GetActive(), -1);
+  CHECK_EQ(ModelManager_Find("pose_a"), 0);
+  CHECK_EQ(ModelManager_Find("pose_b"), 1);
+  CHECK_EQ(ModelManager_Find("pose_c"), 2);
+  CHECK_EQ(ModelManager_Find("pose_big"), -1);
+  CHECK(ModelManager_GetInfo(3) == NULL && ModelManager_GetInfo(-1) == NULL);
+
+  info = ModelManager_GetInfo(2);
+  CHECK(info->c_name == (const char *) &slot_addr(SLOT_C)[NAME_OFF]);
+  CHECK(strcmp(info->rt_version_desc, "host sim") == 0);
+  CHECK_EQ(info->rt_ram_xip, RW_C);
+  CHECK_EQ(info->rt_ram_copy, RW_C + DATA_OFF);
+  CHECK_EQ(info->code_sz, DATA_OFF);
+  CHECK_EQ(info->params_off, WEIGHTS_OFF);
+  CHECK_EQ(info->params_sz, WEIGHTS_SIZE);
+  CHECK_EQ(info->acts_sz, 0x40000);
+  CHECK_EQ(info->ext_ram_sz, EXT_SIZE);
+  CHECK_EQ(AI_RELOC_RT_GET_CPUID(info->variant), AI_RELOC_ARM_CORTEX_M55);
+}
+
+static uint32_t epochs_started;
+
+static void epoch_trace(LL_ATON_RT_Callbacktype_t ctype, const NN_Instance_TypeDef *nn_instance,
+                        const EpochBlock_ItemTypeDef *eb)
+{
+  if (ctype == LL_ATON_RT_Callbacktype_PRE_START)
+    epochs_started++;
+}
+
+static const Image_Data_t *instance_data(const NN_Instance_TypeDef *instance)
+{
+  return (const Image_Data_t *) ((const struct ai_reloc_rt_ctx *) instance->exec_state.inst_reloc)->ram_addr;
+}
+
+/* Pools of the model in `slot`: its part of the weights in the internal RAM and in the external RAM pool */
+static int pools_restored(const NN_Instance_TypeDef *instance, int slot)
+{
+  const uint8_t *ext = (const uint8_t *) (uintptr_t) instance_data(instance)->got[3] - 8;
+  uint8_t seed = slot_addr(slot)[WEIGHTS_OFF];
+
+  for (uint32_t i = 0; i < sizeof(npu_ram); i++)
+  {
+    if (npu_ram[i] != weight(seed, COPY_FOFF + i))
+      return 0;
+  }
+  for (uint32_t i = 0; i < EXT_SIZE; i++)
+  {
+    if (ext[i] != weight(seed, EXT_FOFF + i))
+      return 0;
+  }
+  return 1;
+}
+
+/* Inference of the selected model: both SW blocks run on its relocated data, with its R9 */
+static void run_inference(LL_ATON_RT_Resident_TypeDef *resident)
+{
+  uint32_t blocks = sw_blocks, epochs = epochs_started;
+
+  LL_ATON_RT_Resident_Run(resident);
+  CHECK_EQ(sw_blocks - blocks, 2);
+  CHECK_EQ(misplaced_sw_blocks, 0);
+  CHECK_EQ(epochs_started - epochs, 4);
+  CHECK(last_r9 == (uintptr_t) instance_data(resident->nn_instance));
+}
+
+static void test_relocation(void)
+{
+  static LL_ATON_RT_Resident_TypeDef resident;
+  const uint8_t *bin = slot_addr(SLOT_A);
+  const uint8_t *weights = &bin[WEIGHTS_OFF];
+  const struct ai_reloc_rt_ctx *ctx;
+  const Image_Data_t *data;
+  NN_Instance_TypeDef *instance;
+  uintptr_t file_ptr;
+  int bss_dirty = 0;
+
+  ModelManager_Init();
+  instance = ModelManager_Select(0, &resident, epoch_trace);
+  CHECK(instance != NULL && resident.nn_instance == instance);
+  CHECK_EQ(ModelManager_GetActive(), 0);
+  CHECK_EQ(ll_aton_reloc_is_valid(instance), 1);
+  CHECK(ll_aton_reloc_get_file_ptr(instance, &file_ptr) == AI_RELOC_RT_ERR_NONE && file_ptr == (uintptr_t) bin);
+
+  /* Runtime context, XIP: code left in the NOR, data in the exec arena */
+  ctx = (const struct ai_reloc_rt_ctx *) instance->exec_state.inst_reloc;
+  data = instance_data(instance);
+  CHECK((const void *) ctx == (const void *) &data->ctx);
+  CHECK_EQ(ctx->rom_addr, (uint32_t) (uintptr_t) bin);
+  CHECK_EQ(ctx->file_addr, (uint32_t) (uintptr_t) bin);
+  CHECK_EQ(ctx->state, AI_RELOC_RT_STATE_INITIALIZED | AI_RELOC_RT_STATE_XIP_MODE);
+  CHECK(ctx->ll_instance == instance && ctx->cbs != NULL);
+  CHECK((uintptr_t) data % 8 == 0);
+
+  /* Relocation table */
+  CHECK(ctx->c_name == (const char *) &bin[NAME_OFF]);
+  CHECK(ctx->rt_version_desc == (const char *) &bin[DESC_OFF]);
+  CHECK(instance->network == &data->itf && ctx->itf_network == &data->itf);
+  CHECK(strcmp(instance->network->network_name, "pose_a") == 0);
+  CHECK(data->ebs[0].end_epoch_block == (EpochBlock_FuncPtr_t) &bin[TEXT_OFF + NB_ENTRIES * sizeof(uintptr_t)]);
+  CHECK(data->ebs[2].end_epoch_block == data->ebs[0].end_epoch_block);
+  CHECK(data->ebs[1].blob_address == (uintptr_t) &weights[0x100]);
+  CHECK(data->ebs[3].blob_address == data->got[3] + 0x18);
+  CHECK(data->ebs[0].start_epoch_block == NULL);
+  CHECK(ll_aton_reloc_get_internal_buffers_info(instance) == data->buffers);
+  CHECK(strcmp(data->buffers[0].name, "act_pool") == 0);
+  CHECK_EQ(data->buffers[0].addr_base.i, 0x34200000);
+
+  /* GOT */
+  CHECK_EQ(data->got[0], (uint32_t) (uintptr_t) data->ebs);
+  CHECK_EQ(data->got[1], (uint32_t) (uintptr_t) &bin[NAME_OFF]);
+  CHECK_EQ(data->got[2], (uint32_t) (uintptr_t) &weights[16]);
+  CHECK(pools_restored(instance, SLOT_A));
+  CHECK_EQ(data->got[4], 0);
+
+  /* BSS cleared */
+  for (uint32_t i = sizeof(Image_Data_t); i < RW_A; i++)
+    bss_dirty |= ((const uint8_t *) data)[i];
+  CHECK_EQ(bss_dirty, 0);
+
+  /* The runtime goes through the entry points with R9 set */
+  CHECK_EQ(network_inits, 1);
+  CHECK(last_r9 == (uintptr_t) data);
+  run_inference(&resident);
+  run_inference(&resident);
+  LL_ATON_RT_Resident_DeInit(&resident);
+}
+
+static void test_switch(void)
+{
+  static LL_ATON_RT_Resident_TypeDef resident;
+  const ModelManager_Stats_t *stats = ModelManager_GetStats();
+  /* Model selected, then installs, cache hits and evictions expected after it */
+  static const int steps[][4] = {
+    { 0, 1, 0, 0 }, /* A installed at 0 */
+    { 1, 2, 0, 0 }, /* B at 1024 */
+    { 0, 2, 1, 0 },
+    { 1, 2, 2, 0 },
+    { 2, 3, 2, 1 }, /* C does not fit: arena reset, C at 0 */
+    { 0, 4, 2, 1 }, /* A evicted with the others, at 1536 */
+    { 2, 4, 3, 1 },
+    { 1, 5, 3, 2 }, /* B does not fit: arena reset, B at 0 */
+    { 2, 6, 3, 2 }, /* C evicted, at 1024 */
+    { 1, 6, 4, 2 },
+  };
+  const uint8_t slots[] = { SLOT_A, SLOT_B, SLOT_C };
+  const Image_Data_t *data_a = NULL;
+
+  ModelManager_Init();
+  for (size_t n = 0; n < sizeof(steps) / sizeof(steps[0]); n++)
+  {
+    NN_Instance_TypeDef *instance = ModelManager_Select(steps[n][0], &resident, epoch_trace);
+
+    CHECK(instance != NULL && resident.nn_instance == instance);
+    CHECK_EQ(ModelManager_GetActive(), steps[n][0]);
+    CHECK_EQ(stats->nb_installs, steps[n][1]);
+    CHECK_EQ(stats->nb_cache_hits, steps[n][2]);
+    CHECK_EQ(stats->nb_evictions, steps[n][3]);
+    CHECK(pools_restored(instance, slots[steps[n][0]]));
+    CHECK(strcmp(instance->network->network_name, ModelManager_GetInfo(steps[n][0])->c_name) == 0);
+    run_inference(&resident);
+
+    if (n == 0)
+      data_a = instance_data(instance);
+    /* A cached: same relocated data */
+    if (n == 2)
+      CHECK(instance_data(instance) == data_a);
+    /* After the reset, C took the place of A */
+    if (n == 4)
+      CHECK(instance_data(instance) == data_a);
+    if (n == 5)
+      CHECK((const uint8_t *) instance_data(instance) == (const uint8_t *) data_a + RW_C);
+  }
+
+  /* Selecting the active model again changes nothing */
+  {
+    uint32_t installs = stats->nb_installs, hits = stats->nb_cache_hits;
+
+    CHECK(ModelManager_Select(1, &resident, epoch_trace) == resident.nn_instance);
+    CHECK(stats->nb_installs == installs && stats->nb_cache_hits == hits);
+  }
+  CHECK(ModelManager_Select(3, &resident, epoch_trace) == NULL);
+  LL_ATON_RT_Resident_DeInit(&resident);
+}
+
+/* Images the loader must reject at install, none bound afterwards */
+static void test_failures(void)
+{
+  static LL_ATON_RT_Resident_TypeDef resident;
+  Image_Data_t *data = (Image_Data_t *) &slot_addr(SLOT_B)[DATA_OFF];
+
+  for (int variant = 0; variant < 4; variant++)
+  {
+    nor_build();
+    switch (variant)
+    {
+    case 0:
+      /* Runtime version */
+      *(uint32_t *) &data->ctx.rt_version = 0x01000000;
+      break;
+    case 1:
+      /* Address of an unknown section in the relocation table */
+      data->itf.network_name = (const char *) 0x30000010UL;
+      break;
+    case 2:
+      /* Same, in the GOT */
+      data->got[4] = 0x50000000UL;
+      break;
+    case 3:
+      /* NPU-cacheable external pool below the NPU external address range */
+      data->mpools[2].flags |= AI_RELOC_MPOOL_DATTR_CACHEABLE << 8;
+      break;
+    }
+    CHECK_EQ(ModelManager_Init(), 3);
+    CHECK(ModelManager_Select(0, &resident, epoch_trace) != NULL);
+    CHECK(ModelManager_Select(1, &resident, epoch_trace) == NULL);
+    CHECK_EQ(ModelManager_GetActive(), -1);
+    CHECK(resident.nn_instance == NULL);
+    CHECK_EQ(ModelManager_GetStats()->nb_installs, 1);
+    /* The others are still selectable */
+    CHECK(ModelManager_Select(2, &resident, epoch_trace) != NULL);
+    run_inference(&resident);
+    LL_ATON_RT_Resident_DeInit(&resident);
+  }
+  nor_build();
+}
+
+/* Switch time, runtime re-init included: full installs against cache hits */
+static void bench(void)
+{
+  static LL_ATON_RT_Resident_TypeDef resident;
+  const ModelManager_Stats_t *stats = ModelManager_GetStats();
+  const int runs = 2000;
+  uint64_t install_ns = 0, hit_ns = 0;
+
+  for (int n = 0; n < runs; n++)
+  {
+    ModelManager_Init();
+    ModelManager_Select(0, &resident, NULL);
+    install_ns += stats->last_switch_ticks;
+    ModelManager_Select(1, &resident, NULL);
+    install_ns += stats->last_switch_ticks;
+    ModelManager_Select(0, &resident, NULL);
+    hit_ns += stats->last_switch_ticks;
+    ModelManager_Select(1, &resident, NULL);
+    hit_ns += stats->last_switch_ticks;
+  }
+  LL_ATON_RT_Resident_DeInit(&resident);
+  printf("model switch: install %.2f us, cached image %.2f us (%u bytes relocated, %u bytes of pools)\n",
+         install_ns / 2e3 / runs, hit_ns / 2e3 / runs, RW_A, (unsigned) (sizeof(npu_ram) + EXT_SIZE));
+}
+
+int main(int argc, char **argv)
+{
+  test_scan();
+  test_relocation();
+  test_switch();
+  test_failures();
+  if (host_test_bench(argc, argv))
+    bench();
+
+  return host_test_result("test_model_manager");
+}
@@ -0,0 +1,354 @@
+/**
+ ******************************************************************************
+ * @file    test_movenet_pp.c
+ * @brief   Sub-pixel refinement of the MoveNet heatmap maxima, float and int8
+ ******************************************************************************
+ * The heatmaps are synthetic peaks centred on known sub-pixel positions. The
+ * refined keypoints are compared with a double precision reference of the
+ * quadratic and centroid fits written here, and with the true peak centres.
+ ******************************************************************************
+ */
+
+#include <stdlib.h>
+#include "host_test.h"
+#include "spe_movenet_pp_if.h"
+
+#define HM_W 48
+#define HM_H 48
+#define NB_KP 17
+#define HM_SIZE (HM_W * HM_H)
+
+/* Quantization of the int8 heatmaps */
+#define QSCALE (1.0f / 250.0f)
+#define QZERO (-125)
+
+typedef struct {
+  double a;  /* Along index % height */
+  double b;  /* Along index / height */
+} Peak_t;
+
+static float hm_f32[HM_SIZE * NB_KP];
+static int8_t hm_is8[HM_SIZE * NB_KP];
+static spe_pp_outBuffer_t out[NB_KP];
+
+/* Gaussian peak, or an exact paraboloid of the same curvature when `parabola` is set */
+static double peak_value(const Peak_t *p, int a, int b, int parabola)
+{
+  const double s = 1.5;
+  double d2 = (a + 0.5 - p->a) * (a + 0.5 - p->a) + (b + 0.5 - p->b) * (b + 0.5 - p->b);
+
+  if (parabola)
+    return 100.0 - d2;
+  return exp(-d2 / (2 * s * s));
+}
+
+/* Cell (a, b) of keypoint k: interleaved (HWC) or planar (CHW) */
+static int cell(int k, int a, int b, int planar)
+{
+  int index = b * HM_H + a;
+
+  return planar ? k * HM_SIZE + index : index * NB_KP + k;
+}
+
+static void make_heatmaps(const Peak_t *peaks, int planar, int parabola)
+{
+  for (int k = 0; k < NB_KP; k++)
+  {
+    for (int b = 0; b < HM_W; b++)
+    {
+      for (int a = 0; a < HM_H; a++)
+      {
+        double v = peak_value(&peaks[k], a, b, parabola);
+        long q = lround(v / QSCALE) + QZERO;
+
+        hm_f32[cell(k, a, b, planar)] = (float) v;
+        hm_is8[cell(k, a, b, planar)] = (int8_t) (q < -128 ? -128 : q > 127 ? 127 : q);
+      }
+    }
+  }
+}
+
+static void random_peaks(Peak_t *peaks, unsigned seed, int margin)
+{
+  srand(seed);
+  for (int k = 0; k < NB_KP; k++)
+  {
+    peaks[k].a = margin + (HM_H - 2 * margin) * (rand() / (double) RAND_MAX);
+    peaks[k].b = margin + (HM_W - 2 * margin) * (rand() / (double) RAND_MAX);
+  }
+}
+
+static spe_movenet_pp_static_param_t params(uint32_t mode, int planar)
+{
+  spe_movenet_pp_static_param_t p = {
+    .heatmap_width = HM_W,
+    .heatmap_height = HM_H,
+    .nb_keypoints = NB_KP,
+    .refine_mode = mode,
+    .planar_heatmaps = planar,
+    .raw_output_scale = QSCALE,
+    .raw_output_zero_point = QZERO,
+  };
+  return p;
+}
+
+static void run_f32(uint32_t mode, int planar)
+{
+  spe_movenet_pp_static_param_t p = params(mode, planar);
+  spe_movenet_pp_in_t in = { .inBuff = hm_f32 };
+  spe_pp_out_t o = { .pOutBuff = out };
+
+  CHECK_EQ(spe_movenet_pp_process(&in, &o, &p), AI_SPE_POSTPROCESS_ERROR_NO);
+}
+
+static void run_is8(uint32_t mode)
+{
+  spe_movenet_pp_static_param_t p = params(mode, 0);
+  spe_movenet_pp_in_int8_t in = { .inBuff = hm_is8 };
+  spe_pp_out_t o = { .pOutBuff = out };
+
+  CHECK_EQ(spe_movenet_pp_process_is8(&in, &o, &p), AI_SPE_POSTPROCESS_ERROR_NO);
+}
+
+/* Reference fits on the 3x3 neighbourhood n[db + 1][da + 1] of the maximum */
+static double ref_quadratic(double l, double c, double r)
+{
+  double den = l - 2 * c + r;
+
+  if (den >= 0)
+    return 0;
+  return fmin(0.5, fmax(-0.5, 0.5 * (l - r) / den));
+}
+
+static void ref_refine(double n[3][3], uint32_t mode, double *da, double *db)
+{
+  if (mode == AI_SPE_MOVENET_PP_REFINE_QUADRATIC)
+  {
+    *da = ref_quadratic(n[1][0], n[1][1], n[1][2]);
+    *db = ref_quadratic(n[0][1], n[1][1], n[2][1]);
+    return;
+  }
+
+  double vmin = n[0][0], sum = 0, sum_a = 0, sum_b = 0;
+
+  for (int j = 0; j < 3; j++)
+    for (int i = 0; i < 3; i++)
+      vmin = fmin(vmin, n[j][i]);
+  for (int j = 0; j < 3; j++)
+  {
+    for (int i = 0; i < 3; i++)
+    {
+      sum += n[j][i] - vmin;
+      sum_a += (n[j][i] - vmin) * (i - 1);
+      sum_b += (n[j][i] - vmin) * (j - 1);
+    }
+  }
+  *da = sum > 0 ? sum_a / sum : 0;
+  *db = sum > 0 ? sum_b / sum : 0;
+}
+
+/* Reference keypoint of heatmap k, in the output referential of the post-processing */
+static void ref_keypoint(int k, uint32_t mode, int planar, int is8, double *x, double *y, double *proba)
+{
+  int best = 0;
+  double n[3][3];
+  double da = 0, db = 0;
+
+  /* First maximum in scan order, as the arg-max of the library */
+  for (int index = 1; index < HM_SIZE; index++)
+  {
+    int better = is8 ? hm_is8[cell(k, index % HM_H, index / HM_H, planar)] >
+                       hm_is8[cell(k, best % HM_H, best / HM_H, planar)]
+                     : hm_f32[cell(k, index % HM_H, index / HM_H, planar)] >
+                       hm_f32[cell(k, best % HM_H, best / HM_H, planar)];
+    if (better)
+      best = index;
+  }
+
+  int a = best % HM_H, b = best / HM_H;
+
+  if (mode != AI_SPE_MOVENET_PP_REFINE_NONE && a > 0 && a < HM_H - 1 && b > 0 && b < HM_W - 1)
+  {
+    for (int j = 0; j < 3; j++)
+      for (int i = 0; i < 3; i++)
+        n[j][i] = is8 ? hm_is8[cell(k, a + i - 1, b + j - 1, planar)]
+                      : hm_f32[cell(k, a + i - 1, b + j - 1, planar)];
+    ref_refine(n, mode, &da, &db);
+  }
+  *x = (a + 0.5 + da) / HM_H;
+  *y = (b + 0.5 + db) / HM_W;
+  *proba = is8 ? QSCALE * (hm_is8[cell(k, a, b, planar)] - QZERO) : hm_f32[cell(k, a, b, planar)];
+}
+
+static void check_against_reference(uint32_t mode, int planar, int is8, double tol)
+{
+  for (int k = 0; k < NB_KP; k++)
+  {
+    double x, y, proba;
+
+    ref_keypoint(k, mode, planar, is8, &x, &y, &proba);
+    CHECK_NEAR(out[k].x_center, x, tol);
+    CHECK_NEAR(out[k].y_center, y, tol);
+    CHECK_NEAR(out[k].proba, proba, 1e-6);
+  }
+}
+
+/* Mean distance to the true peak centres, in cells */
+static double mean_error(const Peak_t *peaks)
+{
+  double err = 0;
+
+  for (int k = 0; k < NB_KP; k++)
+    err += hypot(out[k].x_center * HM_H - peaks[k].a, out[k].y_center * HM_W - peaks[k].b);
+  return err / NB_KP;
+}
+
+/* An exact paraboloid is recovered by the quadratic fit, in both layouts */
+static void test_parabola(void)
+{
+  Peak_t peaks[NB_KP];
+
+  random_peaks(peaks, 1, 2);
+  for (int planar = 0; planar < 2; planar++)
+  {
+    make_heatmaps(peaks, planar, 1);
+    run_f32(AI_SPE_MOVENET_PP_REFINE_QUADRATIC, planar);
+    for (int k = 0; k < NB_KP; k++)
+    {
+      CHECK_NEAR(out[k].x_center * HM_H, peaks[k].a, 1e-3);
+      CHECK_NEAR(out[k].y_center * HM_W, peaks[k].b, 1e-3);
+    }
+  }
+}
+
+static void test_gaussian(void)
+{
+  static const uint32_t modes[] = {
+    AI_SPE_MOVENET_PP_REFINE_NONE, AI_SPE_MOVENET_PP_REFINE_QUADRATIC, AI_SPE_MOVENET_PP_REFINE_CENTROID
+  };
+  Peak_t peaks[NB_KP];
+  double err_f32[3] = { 0 }, err_is8[3] = { 0 };
+  const int trials = 20;
+
+  for (int t = 0; t < trials; t++)
+  {
+    random_peaks(peaks, 100 + t, 2);
+    /* Interleaved last: the int8 post-processing only takes interleaved heatmaps */
+    for (int planar = 1; planar >= 0; planar--)
+    {
+      make_heatmaps(peaks, planar, 0);
+      for (int m = 0; m < 3; m++)
+      {
+        run_f32(modes[m], planar);
+        check_against_reference(modes[m], planar, 0, 1e-5);
+        err_f32[m] += mean_error(peaks) / (2 * trials);
+      }
+    }
+    /* Int8: Q15 offsets on the quantized neighbourhood */
+    for (int m = 0; m < 3; m++)
+    {
+      run_is8(modes[m]);
+      check_against_reference(modes[m], 0, 1, 2.0 / 32768 / HM_W + 1e-6);
+      err_is8[m] += mean_error(peaks) / trials;
+    }
+  }
+
+  /* Cell centres are off by 0.38 cell on average, the fits bring the keypoints closer to the true peaks */
+  for (int m = 1; m < 3; m++)
+  {
+    CHECK(err_f32[m] < err_f32[0] * 0.5);
+    CHECK(err_is8[m] < err_is8[0] * 0.5);
+    /* Quantization costs a fraction of the refinement gain */
+    CHECK(err_is8[m] < err_f32[m] + 0.05);
+  }
+  printf("mean error (cells): none %.3f/%.3f, quadratic %.3f/%.3f, centroid %.3f/%.3f (f32/int8)\n", err_f32[0],
+         err_is8[0], err_f32[1], err_is8[1], err_f32[2], err_is8[2]);
+}
+
+/* Maxima on the heatmap border keep the centre of their cell, two equal maxima give their midpoint */
+static void test_degenerate(void)
+{
+  static const int border[][2] = { { 0, 10 }, { HM_H - 1, 20 }, { 30, 0 }, { 5, HM_W - 1 }, { 0, 0 } };
+
+  for (uint32_t mode = AI_SPE_MOVENET_PP_REFINE_QUADRATIC; mode <= AI_SPE_MOVENET_PP_REFINE_CENTROID; mode++)
+  {
+    memset(hm_f32, 0, sizeof(hm_f32));
+    memset(hm_is8, QZERO, sizeof(hm_is8));
+    for (int k = 0; k < 5; k++)
+    {
+      int a = border[k][0], b = border[k][1];
+
+      hm_f32[cell(k, a, b, 0)] = 1.0f;
+      hm_is8[cell(k, a, b, 0)] = 100;
+      /* Asymmetric neighbours which would move an interior maximum */
+      if (a + 1 < HM_H)
+      {
+        hm_f32[cell(k, a + 1, b, 0)] = 0.9f;
+        hm_is8[cell(k, a + 1, b, 0)] = 90;
+      }
+      if (b + 1 < HM_W)
+      {
+        hm_f32[cell(k, a, b + 1, 0)] = 0.9f;
+        hm_is8[cell(k, a, b + 1, 0)] = 90;
+      }
+    }
+    hm_f32[cell(5, 20, 20, 0)] = hm_f32[cell(5, 21, 20, 0)] = 0.5f;
+    hm_is8[cell(5, 20, 20, 0)] = hm_is8[cell(5, 21, 20, 0)] = 50;
+
+    for (int is8 = 0; is8 < 2; is8++)
+    {
+      if (is8)
+        run_is8(mode);
+      else
+        run_f32(mode, 0);
+      for (int k = 0; k < 5; k++)
+      {
+        CHECK_NEAR(out[k].x_center, (border[k][0] + 0.5) / HM_H, 1e-6);
+        CHECK_NEAR(out[k].y_center, (border[k][1] + 0.5) / HM_W, 1e-6);
+      }
+      CHECK_NEAR(out[5].x_center, 21.0 / HM_H, 1e-6);
+      CHECK_NEAR(out[5].y_center, 20.5 / HM_W, 1e-6);
+    }
+  }
+}
+
+static void bench(void)
+{
+  const int runs = 2000;
+  Peak_t peaks[NB_KP];
+  uint64_t t0;
+
+  random_peaks(peaks, 7, 2);
+  for (uint32_t mode = AI_SPE_MOVENET_PP_REFINE_NONE; mode <= AI_SPE_MOVENET_PP_REFINE_CENTROID; mode++)
+  {
+    double f32_ns, planar_ns, is8_ns;
+
+    make_heatmaps(peaks, 0, 0);
+    t0 = host_test_ns();
+    for (int i = 0; i < runs; i++)
+      run_f32(mode, 0);
+    f32_ns = (double) (host_test_ns() - t0) / runs;
+    t0 = host_test_ns();
+    for (int i = 0; i < runs; i++)
+      run_is8(mode);
+    is8_ns = (double) (host_test_ns() - t0) / runs;
+    make_heatmaps(peaks, 1, 0);
+    t0 = host_test_ns();
+    for (int i = 0; i < runs; i++)
+      run_f32(mode, 1);
+    planar_ns = (double) (host_test_ns() - t0) / runs;
+    printf("refine mode %u: f32 %.1f us (planar %.1f us), int8 %.1f us per %dx%dx%d heatmaps\n", (unsigned) mode,
+           f32_ns / 1e3, planar_ns / 1e3, is8_ns / 1e3, HM_W, HM_H, NB_KP);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  test_parabola();
+  test_gaussian();
+  test_degenerate();
+  if (host_test_bench(argc, argv))
+    bench();
+
+  return host_test_result("test_movenet_pp");
+}
@@ -0,0 +1,290 @@
+/**
+ ******************************************************************************
+ * @file    test_nn_input.c
+ * @brief   Ownership state machine of the NN input buffers (nn_input.c)
+ ******************************************************************************
+ * The transitions are checked one by one with two buffers and with the single
+ * buffer of a network allocating its input: which buffer is handed out, when
+ * the network input is rebound, a ready frame replaced by a newer one, a
+ * write cancelled. Random interleavings of the camera, CPU and NPU events,
+ * some frames dropped once written, then check the ownership: the buffer
+ * read by the NPU is never handed out for writing nor rebound during the
+ * inference, and each inference reads the latest frame committed.
+ * Illegal transitions must fail their assertion, checked in a child process.
+ ******************************************************************************
+ */
+
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "host_test.h"
+#include "nn_input.h"
+
+#define NB_EVENTS 200000
+
+static uint8_t nn_in[2][64];
+
+/* Network input as last bound */
+static uint8_t *bound;
+static int nb_binds;
+
+static int bind_input(uint8_t *buffer, uint32_t len)
+{
+  CHECK_EQ(len, sizeof(nn_in[0]));
+  bound = buffer;
+  nb_binds++;
+  return 0;
+}
+
+static void test_double(void)
+{
+  NnInput_TypeDef in;
+  uint8_t *a, *b;
+
+  bound = NULL;
+  nb_binds = 0;
+  NnInput_Init(&in, nn_in[0], nn_in[1], sizeof(nn_in[0]), bind_input);
+  CHECK(!NnInput_IsReady(&in));
+  CHECK(NnInput_CanWrite(&in));
+
+  /* First frame, bound at the start of the inference */
+  a = NnInput_AcquireWrite(&in);
+  CHECK(a == nn_in[0]);
+  CHECK(!NnInput_IsReady(&in));
+  NnInput_CommitWrite(&in, a);
+  CHECK(NnInput_IsReady(&in));
+  CHECK(NnInput_StartInference(&in) == a);
+  CHECK(bound == a && nb_binds == 1);
+  CHECK(!NnInput_IsReady(&in));
+
+  /* Next frame written into the other buffer during the inference */
+  CHECK(NnInput_CanWrite(&in));
+  b = NnInput_AcquireWrite(&in);
+  CHECK(b == nn_in[1]);
+  NnInput_CommitWrite(&in, b);
+  /* A newer frame replaces it rather than waiting behind it, the NPU buffer is not handed out */
+  CHECK(NnInput_CanWrite(&in));
+  CHECK(NnInput_AcquireWrite(&in) == b);
+  CHECK(!NnInput_CanWrite(&in));
+  CHECK(NnInput_AcquireWrite(&in) == NULL);
+  NnInput_CommitWrite(&in, b);
+
+  NnInput_InferenceDone(&in);
+  CHECK(NnInput_StartInference(&in) == b);
+  CHECK(bound == b && nb_binds == 2);
+  NnInput_InferenceDone(&in);
+
+  /* Back to the first buffer, rebound, then the same one again, not rebound */
+  a = NnInput_AcquireWrite(&in);
+  CHECK(a == nn_in[0]);
+  NnInput_CommitWrite(&in, a);
+  CHECK(NnInput_StartInference(&in) == a);
+  CHECK(bound == a && nb_binds == 3);
+  NnInput_InferenceDone(&in);
+  CHECK(NnInput_AcquireWrite(&in) == a);
+  NnInput_CommitWrite(&in, a);
+  CHECK(NnInput_StartInference(&in) == a);
+  CHECK_EQ(nb_binds, 3);
+  NnInput_InferenceDone(&in);
+
+  /* A cancelled write frees the buffer, the frame it held included */
+  b = NnInput_AcquireWrite(&in);
+  NnInput_CommitWrite(&in, b);
+  CHECK(NnInput_AcquireWrite(&in) == b);
+  NnInput_CancelWrite(&in, b);
+  CHECK(!NnInput_IsReady(&in));
+  CHECK(NnInput_CanWrite(&in));
+}
+
+static void test_single(void)
+{
+  NnInput_TypeDef in;
+  uint8_t *a;
+
+  NnInput_Init(&in, nn_in[0], NULL, sizeof(nn_in[0]), NULL);
+  a = NnInput_AcquireWrite(&in);
+  CHECK(a == nn_in[0]);
+  NnInput_CommitWrite(&in, a);
+  /* Replaced by a newer frame until the inference starts */
+  CHECK(NnInput_AcquireWrite(&in) == a);
+  NnInput_CommitWrite(&in, a);
+  CHECK(NnInput_StartInference(&in) == a);
+  /* The network input, never rebound: only written once the inference is done */
+  CHECK(!NnInput_CanWrite(&in));
+  CHECK(NnInput_AcquireWrite(&in) == NULL);
+  NnInput_InferenceDone(&in);
+  CHECK(NnInput_AcquireWrite(&in) == a);
+  NnInput_CancelWrite(&in, a);
+  CHECK(!NnInput_IsReady(&in));
+  CHECK(NnInput_AcquireWrite(&in) == a);
+}
+
+/*
+ * Random order of the events of the main loop: a new camera frame, the copy of the latest one when a buffer can be
+ * written (split in acquisition and commit, the NPU possibly starting or ending in between), the start and the end
+ * of an inference. The content of each buffer is the number of the frame copied into it.
+ */
+static void test_random(int nb_buffers)
+{
+  NnInput_TypeDef in;
+  uint8_t *writing = NULL, *npu = NULL;
+  uint32_t camera_frame = 0, copied_frame = 0, npu_frame = 0, nb_inferences = 0;
+  int failures = 0;
+
+  srand(nb_buffers);
+  bound = nb_buffers == 2 ? NULL : nn_in[0];
+  nb_binds = 0;
+  memset(nn_in, 0, sizeof(nn_in));
+  NnInput_Init(&in, nn_in[0], nb_buffers == 2 ? nn_in[1] : NULL, sizeof(nn_in[0]),
+               nb_buffers == 2 ? bind_input : NULL);
+
+  for (int e = 0; e < NB_EVENTS; e++)
+  {
+    switch (rand() % 5)
+    {
+    case 0:
+      camera_frame++;
+      break;
+    case 1:
+      if (writing == NULL && camera_frame > copied_frame && NnInput_CanWrite(&in))
+      {
+        writing = NnInput_AcquireWrite(&in);
+        failures += writing == NULL || writing == npu;
+      }
+      break;
+    case 2:
+      if (writing != NULL)
+      {
+        memcpy(writing, &camera_frame, sizeof(camera_frame));
+        /* One frame in eight dropped once written, e.g. torn */
+        if (rand() % 8 == 0)
+        {
+          NnInput_CancelWrite(&in, writing);
+        }
+        else
+        {
+          copied_frame = camera_frame;
+          NnInput_CommitWrite(&in, writing);
+        }
+        writing = NULL;
+      }
+      break;
+    case 3:
+      if (npu == NULL && NnInput_IsReady(&in))
+      {
+        uint32_t frame;
+
+        npu = NnInput_StartInference(&in);
+        failures += npu != bound;
+        memcpy(&frame, npu, sizeof(frame));
+        /* Latest complete frame, each one inferred once at most */
+        failures += frame != copied_frame || frame <= npu_frame;
+        npu_frame = frame;
+        nb_inferences++;
+      }
+      break;
+    default:
+      if (npu != NULL)
+      {
+        uint32_t frame;
+
+        /* Not written nor rebound during the inference */
+        memcpy(&frame, npu, sizeof(frame));
+        failures += frame != npu_frame || npu != bound;
+        NnInput_InferenceDone(&in);
+        npu = NULL;
+      }
+      break;
+    }
+  }
+  CHECK_EQ(failures, 0);
+  CHECK(nb_inferences > NB_EVENTS / 40);
+  if (nb_buffers == 1)
+    CHECK_EQ(nb_binds, 0);
+}
+
+/* Runs `f` in a child process, returns its termination signal (0 if it exited normally) */
+static int run_child(void (*f)(NnInput_TypeDef *))
+{
+  int status;
+  pid_t pid = fork();
+
+  if (pid == 0)
+  {
+    NnInput_TypeDef in;
+
+    freopen("/dev/null", "w", stderr);
+    NnInput_Init(&in, nn_in[0], nn_in[1], sizeof(nn_in[0]), bind_input);
+    f(&in);
+    _exit(0);
+  }
+  waitpid(pid, &status, 0);
+  return WIFSIGNALED(status) ? WTERMSIG(status) : 0;
+}
+
+static void start_without_frame(NnInput_TypeDef *in)
+{
+  NnInput_StartInference(in);
+}
+
+static void commit_twice(NnInput_TypeDef *in)
+{
+  uint8_t *a = NnInput_AcquireWrite(in);
+
+  NnInput_CommitWrite(in, a);
+  NnInput_CommitWrite(in, a);
+}
+
+static void commit_foreign(NnInput_TypeDef *in)
+{
+  static uint8_t other[64];
+
+  NnInput_AcquireWrite(in);
+  NnInput_CommitWrite(in, other);
+}
+
+static void cancel_committed(NnInput_TypeDef *in)
+{
+  uint8_t *a = NnInput_AcquireWrite(in);
+
+  NnInput_CommitWrite(in, a);
+  NnInput_CancelWrite(in, a);
+}
+
+static void start_twice(NnInput_TypeDef *in)
+{
+  for (int i = 0; i < 2; i++)
+  {
+    uint8_t *a = NnInput_AcquireWrite(in);
+
+    NnInput_CommitWrite(in, a);
+    NnInput_StartInference(in);
+  }
+}
+
+static void done_without_inference(NnInput_TypeDef *in)
+{
+  NnInput_InferenceDone(in);
+}
+
+static void test_illegal(void)
+{
+  CHECK_EQ(run_child(start_without_frame), SIGABRT);
+  CHECK_EQ(run_child(commit_twice), SIGABRT);
+  CHECK_EQ(run_child(commit_foreign), SIGABRT);
+  CHECK_EQ(run_child(cancel_committed), SIGABRT);
+  CHECK_EQ(run_child(start_twice), SIGABRT);
+  CHECK_EQ(run_child(done_without_inference), SIGABRT);
+}
+
+int main(void)
+{
+  test_double();
+  test_single();
+  test_random(2);
+  test_random(1);
+  test_illegal();
+
+  return host_test_result("test_nn_input");
+}
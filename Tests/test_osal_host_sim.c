@@ -0,0 +1,262 @@
+/**
+ ******************************************************************************
+ * @file    test_osal_host_sim.c
+ * @brief   Host simulation OSAL of the ATON runtime and its register-level
+ *          NPU stand-in
+ ******************************************************************************
+ * The stand-in is driven directly through the registers, as the runtime
+ * does: unit versions preset for `LL_ATON_Init()`, a stream engine or an
+ * epoch controller busy for its modelled latency from the rising edge of its
+ * `CTRL.EN`, completion raised in the interrupt controller and delivered by
+ * `host_sim_wfe()` only to an installed and enabled line whose masks are
+ * satisfied, write-to-clear of the handler, jobs aborted by clearing their enable,
+ * posted events, idle waits, busy time accounted once for overlapping jobs,
+ * and the host memory regions backing the target addresses.
+ ******************************************************************************
+ */
+
+#include "host_test.h"
+#include "ll_aton.h"
+
+#define STRENG_NS    200000
+#define EPOCHCTRL_NS 300000
+#define LINE         0
+
+static uint32_t irqs;
+static uint32_t irq_pending;
+
+/* Acknowledges every pending interrupt, as `ATON_STD_IRQHandler()` */
+static void irq_handler(void)
+{
+  irqs++;
+  irq_pending = ATON_INTCTRL_INTREG_GET(0);
+  ATON_INTCTRL_INTCLR_SET(0, irq_pending);
+}
+
+static uint32_t streng_mask(uint32_t id)
+{
+  return 1U << (ATON_STRENG_INT(0) + id);
+}
+
+static void setup(void)
+{
+  host_sim_init();
+  host_sim_reset_stats();
+  host_sim_set_latency(HOST_SIM_UNIT_STRENG, STRENG_NS);
+  host_sim_set_latency(HOST_SIM_UNIT_EPOCHCTRL, EPOCHCTRL_NS);
+  irqs = 0;
+  irq_pending = 0;
+
+  /* Units left enabled by a previous test: a job starts on the next rising edge only */
+  for (uint32_t i = 0; i < 3; i++)
+    ATON_REG_WRITE_FIELD(STRENG, i, CTRL, EN, 0);
+  ATON_REG_WRITE_FIELD(EPOCHCTRL, 0, CTRL, EN, 0);
+
+  ATON_REG_WRITE_FIELD(INTCTRL, 0, CTRL, EN, 1);
+  /* Line: any interrupt unmasked, AND-mask disabled */
+  ATON_INTCTRL_INTORMSK_SET(0, LINE, 0);
+  ATON_INTCTRL_INTANDMSK_SET(0, LINE, 0xFFFFFFFF);
+  host_sim_install_irq(LINE, irq_handler);
+  host_sim_enable_irq(LINE, true);
+}
+
+static void teardown(void)
+{
+  host_sim_uninit();
+  host_sim_set_latency(HOST_SIM_UNIT_STRENG, HOST_SIM_STRENG_LATENCY_NS);
+  host_sim_set_latency(HOST_SIM_UNIT_EPOCHCTRL, HOST_SIM_EPOCHCTRL_LATENCY_NS);
+}
+
+static void test_versions(void)
+{
+  CHECK(host_sim_get_aton_base() != 0);
+  CHECK_EQ(ATON_GET_REG32(ATON_STRENG_VERSION_ADDR(0)), ATON_STRENG_VERSION_DT);
+  CHECK_EQ(ATON_GET_REG32(ATON_STRENG_VERSION_ADDR(ATON_STRENG_NUM - 1)), ATON_STRENG_VERSION_DT);
+  CHECK_EQ(ATON_GET_REG32(ATON_INTCTRL_VERSION_ADDR(0)), ATON_INTCTRL_VERSION_DT);
+}
+
+static void test_completion(void)
+{
+  host_sim_stats_t stats;
+  uint64_t start;
+
+  setup();
+
+  /* Stream engine 2 busy from the rising edge of its enable, not before */
+  start = host_test_ns();
+  ATON_REG_WRITE_FIELD(STRENG, 2, CTRL, EN, 1);
+  CHECK_EQ(ATON_INTCTRL_INTREG_GET(0), 0);
+  host_sim_wfe();
+  CHECK(host_test_ns() - start >= STRENG_NS);
+  CHECK_EQ(irqs, 1);
+  CHECK_EQ(irq_pending, streng_mask(2));
+  /* Cleared by the handler */
+  CHECK_EQ(ATON_INTCTRL_INTREG_GET(0), 0);
+
+  /* Writing the enable again while set starts nothing */
+  ATON_REG_WRITE_FIELD(STRENG, 2, CTRL, EN, 1);
+  host_sim_wfe();
+  CHECK_EQ(irqs, 1);
+
+  /* Epoch controller: its IRQ register is cleared along with its interrupt */
+  ATON_REG_WRITE_FIELD(EPOCHCTRL, 0, CTRL, EN, 1);
+  host_sim_wfe();
+  CHECK_EQ(irqs, 2);
+  CHECK_EQ(irq_pending, (uint32_t) ATON_INT_GET_MASK(ATON_EPOCHCTRL_INT_MASK, 0));
+  CHECK_EQ(ATON_EPOCHCTRL_IRQ_GET(0), 0);
+
+  host_sim_get_stats(&stats);
+  CHECK_EQ(stats.nr_completions[HOST_SIM_UNIT_STRENG], 1);
+  CHECK_EQ(stats.nr_completions[HOST_SIM_UNIT_EPOCHCTRL], 1);
+  CHECK_EQ(stats.nr_irqs, 2);
+  CHECK_EQ(stats.npu_busy_ns, STRENG_NS + EPOCHCTRL_NS);
+
+  teardown();
+}
+
+static uint32_t latency_cb(host_sim_unit_t unit, uint32_t id, uint32_t latency_ns)
+{
+  return (unit == HOST_SIM_UNIT_STRENG) ? latency_ns * (id + 1) : latency_ns;
+}
+
+static void test_order(void)
+{
+  host_sim_stats_t stats;
+
+  setup();
+  host_sim_set_latency_cb(latency_cb);
+
+  /* Engines 0 and 1 overlap: completed shortest first, busy time accounted once */
+  ATON_REG_WRITE_FIELD(STRENG, 1, CTRL, EN, 1);
+  ATON_REG_WRITE_FIELD(STRENG, 0, CTRL, EN, 1);
+  host_sim_wfe();
+  CHECK_EQ(irq_pending, streng_mask(0));
+  host_sim_wfe();
+  CHECK_EQ(irq_pending, streng_mask(1));
+
+  host_sim_get_stats(&stats);
+  CHECK_EQ(stats.nr_completions[HOST_SIM_UNIT_STRENG], 2);
+  /* From the start of engine 0 to the end of engine 1, started just before */
+  CHECK(stats.npu_busy_ns <= 2 * STRENG_NS);
+  CHECK(stats.npu_busy_ns > 3 * STRENG_NS / 2);
+
+  host_sim_set_latency_cb(NULL);
+  teardown();
+}
+
+static void test_masks(void)
+{
+  host_sim_stats_t stats;
+
+  setup();
+
+  /* Line disabled: completed, but the interrupt stays pending */
+  host_sim_enable_irq(LINE, false);
+  ATON_REG_WRITE_FIELD(STRENG, 0, CTRL, EN, 1);
+  host_sim_wfe();
+  CHECK_EQ(irqs, 0);
+  CHECK_EQ(ATON_INTCTRL_INTREG_GET(0), streng_mask(0));
+
+  /* Delivered once enabled */
+  host_sim_enable_irq(LINE, true);
+  host_sim_wfe();
+  CHECK_EQ(irqs, 1);
+  CHECK_EQ(irq_pending, streng_mask(0));
+
+  /* OR-masked: only the AND-mask of engines 0 and 1 together raises the line */
+  ATON_INTCTRL_INTORMSK_SET(0, LINE, 0xFFFFFFFF);
+  ATON_INTCTRL_INTANDMSK_SET(0, LINE, ~(streng_mask(0) | streng_mask(1)));
+  ATON_REG_WRITE_FIELD(STRENG, 0, CTRL, EN, 0);
+  ATON_REG_WRITE_FIELD(STRENG, 0, CTRL, EN, 1);
+  ATON_REG_WRITE_FIELD(STRENG, 1, CTRL, EN, 1);
+  host_sim_wfe();
+  CHECK_EQ(irqs, 2);
+  CHECK_EQ(irq_pending, streng_mask(0) | streng_mask(1));
+
+  /* Interrupt controller disabled: nothing delivered */
+  ATON_INTCTRL_INTORMSK_SET(0, LINE, 0);
+  ATON_INTCTRL_INTANDMSK_SET(0, LINE, 0xFFFFFFFF);
+  ATON_REG_WRITE_FIELD(INTCTRL, 0, CTRL, EN, 0);
+  ATON_REG_WRITE_FIELD(STRENG, 1, CTRL, EN, 0);
+  ATON_REG_WRITE_FIELD(STRENG, 1, CTRL, EN, 1);
+  host_sim_wfe();
+  CHECK_EQ(irqs, 2);
+  CHECK_EQ(ATON_INTCTRL_INTREG_GET(0), streng_mask(1));
+
+  /* Clearing it drops the pending interrupts */
+  ATON_REG_POLL(INTCTRL, 0, CTRL, CLR, 1);
+  CHECK_EQ(ATON_INTCTRL_INTREG_GET(0), 0);
+
+  host_sim_get_stats(&stats);
+  CHECK_EQ(stats.nr_irqs, 2);
+  teardown();
+}
+
+static void test_events(void)
+{
+  host_sim_stats_t stats;
+  uint64_t start;
+
+  setup();
+
+  /* A posted event ends the next wait at once, before any completion */
+  ATON_REG_WRITE_FIELD(STRENG, 0, CTRL, EN, 1);
+  host_sim_post_event();
+  start = host_test_ns();
+  host_sim_wfe();
+  CHECK(host_test_ns() - start < STRENG_NS);
+  CHECK_EQ(irqs, 0);
+
+  /* Cleared unit: its job is aborted, the wait returns idle */
+  ATON_REG_POLL(STRENG, 0, CTRL, EN, 0);
+  host_sim_wfe();
+  CHECK_EQ(irqs, 0);
+  host_sim_get_stats(&stats);
+  CHECK_EQ(stats.nr_idle_wfe, 1);
+  CHECK_EQ(stats.nr_completions[HOST_SIM_UNIT_STRENG], 0);
+
+  /* Critical sections nest */
+  host_sim_enter_cs();
+  host_sim_enter_cs();
+  host_sim_exit_cs();
+  host_sim_exit_cs();
+  ATON_REG_WRITE_FIELD(STRENG, 0, CTRL, EN, 1);
+  host_sim_wfe();
+  CHECK_EQ(irqs, 1);
+
+  teardown();
+}
+
+static void test_mem_regions(void)
+{
+  static uint8_t pool[0x1000];
+  uint32_t i;
+
+  /* Not backed: unchanged */
+  CHECK_EQ(host_sim_phys_to_virt(0x34000010), 0x34000010);
+
+  CHECK_EQ(host_sim_add_mem_region(0x34000000, sizeof(pool), pool), 0);
+  CHECK_EQ(host_sim_phys_to_virt(0x34000000), (uintptr_t) pool);
+  CHECK_EQ(ATON_LIB_PHYSICAL_TO_VIRTUAL_ADDR(0x34000ff0UL), (uintptr_t) &pool[0xff0]);
+  CHECK_EQ(host_sim_phys_to_virt(0x34001000), 0x34001000);
+  CHECK_EQ(host_sim_virt_to_phys((uintptr_t) &pool[0x20]), 0x34000020);
+  CHECK_EQ(ATON_LIB_VIRTUAL_TO_PHYSICAL_ADDR((uintptr_t) &pool[0x20]), 0x34000020);
+
+  /* Up to HOST_SIM_MAX_MEM_REGIONS regions */
+  for (i = 1; i < HOST_SIM_MAX_MEM_REGIONS; i++)
+    CHECK_EQ(host_sim_add_mem_region(0x34100000 + i * 0x1000, 0x100, &pool[i * 0x100]), 0);
+  CHECK_EQ(host_sim_add_mem_region(0x34200000, 0x100, pool), -1);
+  CHECK_EQ(host_sim_phys_to_virt(0x34100000 + 3 * 0x1000 + 4), (uintptr_t) &pool[3 * 0x100 + 4]);
+}
+
+int main(void)
+{
+  test_versions();
+  test_completion();
+  test_order();
+  test_masks();
+  test_events();
+  test_mem_regions();
+
+  return host_test_result("test_osal_host_sim");
+}
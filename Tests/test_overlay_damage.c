@@ -0,0 +1,255 @@
+/**
+ ******************************************************************************
+ * @file    test_overlay_damage.c
+ * @brief   Damage tracking of the overlay frame buffers, on host frame buffers
+ *          cleared and drawn as by the display loop of main.c
+ ******************************************************************************
+ * Two ARGB4444 frame buffers are used in turn. At the start of a frame, only
+ * the damaged rectangles recorded the last time the buffer was drawn are
+ * cleared, then random shapes are drawn and recorded. The buffer must then be
+ * identical to a fully cleared buffer with the same drawing, and every pixel
+ * written must lie in a damaged rectangle (the data cache clean regions).
+ ******************************************************************************
+ */
+
+#include <stdlib.h>
+#include "host_test.h"
+#include "overlay_damage.h"
+
+#define FB_W 800
+#define FB_H 480
+
+static uint16_t fb[2][FB_H][FB_W];
+static uint16_t expected[FB_H][FB_W];
+static OverlayDamage_t damage[2];
+
+static void fill(uint16_t buffer[FB_H][FB_W], int x, int y, int w, int h, uint16_t color)
+{
+  for (int j = y; j < y + h; j++)
+  {
+    for (int i = x; i < x + w; i++)
+    {
+      if (i >= 0 && i < FB_W && j >= 0 && j < FB_H)
+        buffer[j][i] = color;
+    }
+  }
+}
+
+static int damaged(const OverlayDamage_t *d, int x, int y)
+{
+  for (uint32_t i = 0; i < d->nb_rects; i++)
+  {
+    const OverlayRect_t *r = &d->rects[i];
+
+    if (x >= r->x0 && x < r->x1 && y >= r->y0 && y < r->y1)
+      return 1;
+  }
+  return 0;
+}
+
+/* Rectangles within the frame buffer, not empty, neither overlapping nor touching: no pixel is cleared twice */
+static void check_rects(const OverlayDamage_t *d)
+{
+  CHECK(d->nb_rects <= OVERLAY_DAMAGE_MAX_RECTS);
+  for (uint32_t i = 0; i < d->nb_rects; i++)
+  {
+    const OverlayRect_t *a = &d->rects[i];
+
+    CHECK(a->x0 < a->x1 && a->x1 <= d->width);
+    CHECK(a->y0 < a->y1 && a->y1 <= d->height);
+    for (uint32_t j = i + 1; j < d->nb_rects; j++)
+    {
+      const OverlayRect_t *b = &d->rects[j];
+      int apart = a->x1 < b->x0 || b->x1 < a->x0 || a->y1 < b->y0 || b->y1 < a->y0;
+
+      CHECK(apart);
+    }
+  }
+}
+
+static void test_add(void)
+{
+  OverlayDamage_t d;
+
+  OverlayDamage_Init(&d, FB_W, FB_H);
+  CHECK_EQ(OverlayDamage_Area(&d), 0);
+
+  /* Clipped, empty ones ignored */
+  OverlayDamage_Add(&d, -10, -10, 20, 30);
+  CHECK_EQ(d.nb_rects, 1);
+  CHECK(d.rects[0].x0 == 0 && d.rects[0].y0 == 0 && d.rects[0].x1 == 10 && d.rects[0].y1 == 20);
+  OverlayDamage_Add(&d, FB_W - 5, FB_H - 5, 100, 100);
+  CHECK_EQ(OverlayDamage_Area(&d), 10 * 20 + 5 * 5);
+  OverlayDamage_Add(&d, 100, 100, 0, 10);
+  OverlayDamage_Add(&d, FB_W, 0, 10, 10);
+  OverlayDamage_Add(&d, 0, -20, 10, 10);
+  CHECK_EQ(d.nb_rects, 2);
+
+  /* Touching rectangles are merged */
+  OverlayDamage_Add(&d, 10, 0, 10, 20);
+  CHECK_EQ(d.nb_rects, 2);
+  CHECK_EQ(OverlayDamage_Area(&d), 20 * 20 + 5 * 5);
+
+  /* A rectangle bridging two others absorbs both */
+  OverlayDamage_Reset(&d);
+  OverlayDamage_Add(&d, 0, 0, 10, 10);
+  OverlayDamage_Add(&d, 100, 0, 10, 10);
+  OverlayDamage_Add(&d, 5, 5, 100, 2);
+  CHECK_EQ(d.nb_rects, 1);
+  CHECK_EQ(OverlayDamage_Area(&d), 110 * 10);
+
+  OverlayDamage_AddFull(&d);
+  CHECK_EQ(d.nb_rects, 1);
+  CHECK_EQ(OverlayDamage_Area(&d), FB_W * FB_H);
+
+  /* Out of slots: merged with the rectangle growing the least, the result may then reach other rectangles */
+  OverlayDamage_Reset(&d);
+  for (int i = 0; i < OVERLAY_DAMAGE_MAX_RECTS; i++)
+    OverlayDamage_Add(&d, 20 * i, 0, 10, 10);
+  CHECK_EQ(d.nb_rects, OVERLAY_DAMAGE_MAX_RECTS);
+  OverlayDamage_Add(&d, 12, 12, 4, 4);
+  CHECK_EQ(d.nb_rects, OVERLAY_DAMAGE_MAX_RECTS);
+  check_rects(&d);
+  for (int i = 0; i < 100; i++)
+  {
+    OverlayDamage_Add(&d, rand() % FB_W, rand() % FB_H, 1 + rand() % 40, 1 + rand() % 40);
+    check_rects(&d);
+  }
+}
+
+/* Frame type of the display loop */
+static void draw_frame(int n, uint16_t buffer[FB_H][FB_W], OverlayDamage_t *d, uint16_t reference[FB_H][FB_W])
+{
+  int kind = n % 10;
+
+  if (kind == 9)
+  {
+    /* Multi-pose drawing: full buffer damaged */
+    OverlayDamage_AddFull(d);
+  }
+
+  /* Skeleton: small shapes within a bounding box, recorded as a whole */
+  int bx = rand() % FB_W - 50, by = rand() % FB_H - 50, bw = 20 + rand() % 300, bh = 20 + rand() % 300;
+  for (int s = 0; s < 20; s++)
+  {
+    int w = 1 + rand() % 20, h = 1 + rand() % 20;
+    int x = bx + rand() % (bw - w + 1), y = by + rand() % (bh - h + 1);
+    uint16_t color = 0x1000 | (rand() & 0xfff);
+
+    fill(buffer, x, y, w, h, color);
+    fill(reference, x, y, w, h, color);
+  }
+  OverlayDamage_Add(d, bx, by, bw, bh);
+
+  /* Text band */
+  fill(buffer, 100, 300, 600, 100, 0x8888);
+  fill(reference, 100, 300, 600, 100, 0x8888);
+  OverlayDamage_Add(d, 0, 300, FB_W, 100);
+
+  /* Scattered markers, more than the slots */
+  for (int s = 0; s < (kind < 5 ? 3 : 12); s++)
+  {
+    int x = rand() % FB_W, y = rand() % FB_H;
+
+    fill(buffer, x, y, 6, 6, 0xf00f);
+    fill(reference, x, y, 6, 6, 0xf00f);
+    OverlayDamage_Add(d, x, y, 6, 6);
+  }
+}
+
+static void test_display_loop(int bench)
+{
+  static uint16_t written[FB_H][FB_W];
+  uint64_t cleared = 0, cleaned = 0;
+  const int frames = 300;
+
+  srand(17);
+  memset(fb, 0, sizeof(fb));
+  OverlayDamage_Init(&damage[0], FB_W, FB_H);
+  OverlayDamage_Init(&damage[1], FB_W, FB_H);
+  /* Welcome screen in the second buffer */
+  fill(fb[1], 300, 100, 200, 107, 0xffff);
+  OverlayDamage_Add(&damage[1], 300, 100, 200, 107);
+
+  for (int n = 0; n < frames; n++)
+  {
+    int idx = n & 1;
+    OverlayDamage_t *d = &damage[idx];
+
+    /* Display_BeginFrame(): clear the previous drawing of this buffer only */
+    for (uint32_t i = 0; i < d->nb_rects; i++)
+    {
+      const OverlayRect_t *r = &d->rects[i];
+
+      fill(fb[idx], r->x0, r->y0, r->x1 - r->x0, r->y1 - r->y0, 0);
+    }
+    cleared += OverlayDamage_Area(d);
+    OverlayDamage_Reset(d);
+
+    memset(expected, 0, sizeof(expected));
+    memset(written, 0, sizeof(written));
+    draw_frame(n, written, d, expected);
+    check_rects(d);
+
+    /* The frame buffer holds this frame only, every pixel written is in the cleaned regions */
+    for (int y = 0; y < FB_H; y++)
+    {
+      for (int x = 0; x < FB_W; x++)
+      {
+        if (written[y][x])
+          fb[idx][y][x] = written[y][x];
+      }
+    }
+    CHECK(memcmp(fb[idx], expected, sizeof(expected)) == 0);
+    for (int y = 0; y < FB_H; y++)
+    {
+      for (int x = 0; x < FB_W; x++)
+      {
+        if (written[y][x] && !damaged(d, x, y))
+        {
+          CHECK(0);
+          y = FB_H;
+          break;
+        }
+      }
+    }
+    cleaned += OverlayDamage_Area(d);
+  }
+
+  if (bench)
+  {
+    double full = (double) FB_W * FB_H * 2 * frames;
+
+    printf("cleared %.1f%%, cleaned %.1f%% of the frame buffer bytes of a full clear and clean\n",
+           100.0 * cleared * 2 / full, 100.0 * cleaned * 2 / full);
+  }
+}
+
+static void bench_add(void)
+{
+  const int runs = 100000;
+  OverlayDamage_t d;
+  uint64_t t0;
+
+  OverlayDamage_Init(&d, FB_W, FB_H);
+  t0 = host_test_ns();
+  for (int n = 0; n < runs; n++)
+  {
+    OverlayDamage_Reset(&d);
+    for (int s = 0; s < 16; s++)
+      OverlayDamage_Add(&d, (n * 37 + s * 97) % FB_W, (n * 11 + s * 53) % FB_H, 20, 20);
+  }
+  printf("OverlayDamage_Add: %.1f ns per rectangle\n", (double) (host_test_ns() - t0) / runs / 16);
+}
+
+int main(int argc, char **argv)
+{
+  int bench = host_test_bench(argc, argv);
+
+  test_add();
+  test_display_loop(bench);
+  if (bench)
+    bench_add();
+
+  return host_test_result("test_overlay_damage");
+}
@@ -0,0 +1,590 @@
+/**
+ ******************************************************************************
+ * @file    test_overlay_draw.c
+ * @brief   Batched overlay drawing executed by the CPU reference backend, on a
+ *          host ARGB4444 frame buffer
+ ******************************************************************************
+ * Rectangles, thick lines and text are checked pixel for pixel against the
+ * stm32_lcd drawing they replace (thick lines as the overlapping
+ * UTIL_LCD_DrawLine() calls of the former Display_binding()), rendered into a
+ * second frame buffer through a host LCD driver. Circles, bitmaps and the
+ * blending of the masks are checked against per-pixel references.
+ ******************************************************************************
+ */
+
+#include <stdlib.h>
+#include "host_test.h"
+#include "overlay_draw.h"
+
+#define FB_W 800
+#define FB_H 480
+
+static uint16_t fb[FB_H][FB_W];
+static uint16_t ref[FB_H][FB_W];
+static OverlayDraw_t od;
+static uint8_t atlas[OVERLAY_DRAW_GLYPH_ATLAS_SIZE(17, 24)];
+
+/* Host LCD driver of the stm32_lcd, drawing into ref. Pixels out of the buffer are dropped */
+static uint32_t ref_origin;
+
+static void Ref_Set(uint32_t x, uint32_t y, uint32_t color)
+{
+  x -= ref_origin;
+  y -= ref_origin;
+  if (x < FB_W && y < FB_H)
+    ref[y][x] = color;
+}
+
+static int32_t Ref_FillRGBRect(uint32_t instance, uint32_t x, uint32_t y, uint8_t *data, uint32_t w, uint32_t h)
+{
+  const uint16_t *argb4444 = (const uint16_t *) data;
+
+  for (uint32_t j = 0; j < h; j++)
+    for (uint32_t i = 0; i < w; i++)
+      Ref_Set(x + i, y + j, argb4444[j * w + i]);
+  return 0;
+}
+
+static int32_t Ref_FillRect(uint32_t instance, uint32_t x, uint32_t y, uint32_t w, uint32_t h, uint32_t color)
+{
+  for (uint32_t j = 0; j < h; j++)
+    for (uint32_t i = 0; i < w; i++)
+      Ref_Set(x + i, y + j, color);
+  return 0;
+}
+
+static int32_t Ref_DrawHLine(uint32_t instance, uint32_t x, uint32_t y, uint32_t len, uint32_t color)
+{
+  return Ref_FillRect(instance, x, y, len, 1, color);
+}
+
+static int32_t Ref_DrawVLine(uint32_t instance, uint32_t x, uint32_t y, uint32_t len, uint32_t color)
+{
+  return Ref_FillRect(instance, x, y, 1, len, color);
+}
+
+static int32_t Ref_SetPixel(uint32_t instance, uint32_t x, uint32_t y, uint32_t color)
+{
+  Ref_Set(x, y, color);
+  return 0;
+}
+
+static int32_t Ref_GetPixel(uint32_t instance, uint32_t x, uint32_t y, uint32_t *color)
+{
+  *color = (x < FB_W && y < FB_H) ? ref[y][x] : 0;
+  return 0;
+}
+
+static int32_t Ref_GetXSize(uint32_t instance, uint32_t *size)
+{
+  *size = FB_W;
+  return 0;
+}
+
+static int32_t Ref_GetYSize(uint32_t instance, uint32_t *size)
+{
+  *size = FB_H;
+  return 0;
+}
+
+static int32_t Ref_GetFormat(uint32_t instance, uint32_t *format)
+{
+  *format = LCD_PIXEL_FORMAT_ARGB4444;
+  return 0;
+}
+
+static const LCD_UTILS_Drv_t ref_driver = {
+  .FillRGBRect = Ref_FillRGBRect,
+  .DrawHLine = Ref_DrawHLine,
+  .DrawVLine = Ref_DrawVLine,
+  .FillRect = Ref_FillRect,
+  .GetPixel = Ref_GetPixel,
+  .SetPixel = Ref_SetPixel,
+  .GetXSize = Ref_GetXSize,
+  .GetYSize = Ref_GetYSize,
+  .GetFormat = Ref_GetFormat,
+};
+
+/*
+ * Thick line of the former Display_binding(): the line repeated with offsets
+ * along its minor axis. UTIL_LCD_DrawLine() only takes positive coordinates,
+ * lines leaving the frame buffer are drawn with a shifted origin.
+ */
+static void ref_line(int x0, int y0, int x1, int y1, int width, uint32_t color)
+{
+  ref_origin = 1000;
+  x0 += ref_origin;
+  y0 += ref_origin;
+  x1 += ref_origin;
+  y1 += ref_origin;
+  for (int i = -width / 2; i <= width / 2; i++)
+  {
+    if (abs(y1 - y0) > abs(x1 - x0))
+      UTIL_LCD_DrawLine(x0 + i, y0, x1 + i, y1, color);
+    else
+      UTIL_LCD_DrawLine(x0, y0 + i, x1, y1 + i, color);
+  }
+  ref_origin = 0;
+}
+
+/* Pixels whose centre is within radius + 1/2 of the circle centre */
+static int ref_inside(int dx, int dy, int radius)
+{
+  return 4 * (dx * dx + dy * dy) < (2 * radius + 1) * (2 * radius + 1);
+}
+
+static uint16_t ref_argb4444(uint32_t argb8888)
+{
+  return (argb8888 >> 28) << 12 | ((argb8888 >> 20) & 0xf) << 8 | ((argb8888 >> 12) & 0xf) << 4 | ((argb8888 >> 4) & 0xf);
+}
+
+static uint32_t ref_expand(uint16_t argb4444)
+{
+  uint32_t a = argb4444 >> 12, r = (argb4444 >> 8) & 0xf, g = (argb4444 >> 4) & 0xf, b = argb4444 & 0xf;
+
+  return (a * 17) << 24 | (r * 17) << 16 | (g * 17) << 8 | (b * 17);
+}
+
+/* DMA2D blending (reference manual), output converted to ARGB4444 by truncation */
+static uint16_t ref_blend(uint32_t fg, uint32_t alpha_fg, uint32_t bg)
+{
+  uint32_t alpha_bg = bg >> 24;
+  uint32_t mult = alpha_fg * alpha_bg / 255;
+  uint32_t alpha_out = alpha_fg + alpha_bg - mult;
+  uint32_t c[3];
+
+  if (alpha_out == 0)
+    return 0;
+  for (int i = 0; i < 3; i++)
+  {
+    uint32_t c_fg = (fg >> (16 - 8 * i)) & 0xff;
+    uint32_t c_bg = (bg >> (16 - 8 * i)) & 0xff;
+
+    c[i] = (c_fg * alpha_fg + c_bg * alpha_bg - c_bg * mult) / alpha_out;
+  }
+
+  return (alpha_out >> 4) << 12 | (c[0] >> 4) << 8 | (c[1] >> 4) << 4 | (c[2] >> 4);
+}
+
+static void clear(void)
+{
+  memset(fb, 0, sizeof(fb));
+  memset(ref, 0, sizeof(ref));
+}
+
+static void flush(void)
+{
+  OverlayDraw_Flush(&od, NULL, NULL);
+  CHECK(!od.busy);
+  CHECK_EQ(od.nb_dropped, 0);
+  OverlayDraw_Begin(&od, (uint8_t *) fb);
+}
+
+static uint32_t random_color(void)
+{
+  return 0xff000000 | (rand() & 0xffffff);
+}
+
+static void test_rects(void)
+{
+  clear();
+  for (int n = 0; n < 200; n++)
+  {
+    int x = rand() % (FB_W - 60), y = rand() % (FB_H - 60), w = 1 + rand() % 60, h = 1 + rand() % 60;
+    uint32_t color = random_color();
+
+    if (n % 2)
+    {
+      OverlayDraw_FillRect(&od, x, y, w, h, color);
+      UTIL_LCD_FillRect(x, y, w, h, color);
+    }
+    else
+    {
+      OverlayDraw_Rect(&od, x, y, w, h, color);
+      UTIL_LCD_DrawRect(x, y, w, h, color);
+    }
+    /* Queue flushed before it is full */
+    if (od.nb_prims > OVERLAY_DRAW_MAX_PRIMITIVES - 4)
+      flush();
+  }
+  flush();
+  CHECK(memcmp(fb, ref, sizeof(fb)) == 0);
+}
+
+static void test_lines(void)
+{
+  for (int width = 1; width <= 7; width += 2)
+  {
+    clear();
+    for (int n = 0; n < 400; n++)
+    {
+      /* Lines of all slopes, some leaving the frame buffer */
+      int x0 = rand() % (FB_W + 100) - 50, y0 = rand() % (FB_H + 100) - 50;
+      int len = n < 20 ? n % 3 : 1 + rand() % 150;
+      int x1 = x0 + rand() % (2 * len + 1) - len, y1 = y0 + rand() % (2 * len + 1) - len;
+      uint32_t color = random_color();
+
+      OverlayDraw_Line(&od, x0, y0, x1, y1, width, color);
+      ref_line(x0, y0, x1, y1, width, color);
+      if (od.nb_prims == OVERLAY_DRAW_MAX_PRIMITIVES)
+        flush();
+    }
+    flush();
+    CHECK(memcmp(fb, ref, sizeof(fb)) == 0);
+  }
+}
+
+static void test_text(void)
+{
+  static sFONT *fonts[] = { &Font12, &Font16, &Font20, &Font24 };
+  static const struct {
+    OverlayDrawAlign_t align;
+    Text_AlignModeTypdef mode;
+  } aligns[] = {
+    { OVERLAY_DRAW_ALIGN_LEFT, LEFT_MODE },
+    { OVERLAY_DRAW_ALIGN_CENTER, CENTER_MODE },
+    { OVERLAY_DRAW_ALIGN_RIGHT, RIGHT_MODE },
+  };
+  char text[OVERLAY_DRAW_MAX_TEXT_LEN + 1];
+
+  for (size_t f = 0; f < sizeof(fonts) / sizeof(fonts[0]); f++)
+  {
+    sFONT *font = fonts[f];
+
+    OverlayDraw_SetFont(&od, font, atlas, sizeof(atlas));
+    UTIL_LCD_SetFont(font);
+    clear();
+    for (int n = 0; n < 30; n++)
+    {
+      uint32_t text_color = random_color();
+      uint32_t back_color = n % 3 == 0 ? 0 : n % 3 == 1 ? 0x40000000 : random_color();
+      int len = 1 + rand() % 30;
+      int y = rand() % (FB_H - font->Height);
+      int x = rand() % 20;
+
+      /* All the printable characters */
+      for (int i = 0; i < len; i++)
+        text[i] = OVERLAY_DRAW_FIRST_GLYPH + rand() % OVERLAY_DRAW_NB_GLYPHS;
+      text[len] = '\0';
+      /* Strings fitting the width: the stm32_lcd also draws the characters partly out of the screen */
+      if (len * font->Width + x > FB_W)
+        continue;
+
+      OverlayDraw_SetTextColor(&od, text_color);
+      OverlayDraw_SetBackColor(&od, back_color);
+      OverlayDraw_PrintfAt(&od, x, y, aligns[n % 3].align, "%s", text);
+      UTIL_LCD_SetTextColor(text_color);
+      UTIL_LCD_SetBackColor(back_color);
+      UTIL_LCD_DisplayStringAt(x, y, (uint8_t *) text, aligns[n % 3].mode);
+    }
+    flush();
+    CHECK(memcmp(fb, ref, sizeof(fb)) == 0);
+  }
+
+  /* Only the characters fully inside the screen width are drawn */
+  clear();
+  OverlayDraw_SetTextColor(&od, 0xffffffff);
+  OverlayDraw_SetBackColor(&od, 0xff000000);
+  OverlayDraw_PrintfAt(&od, FB_W - 5 * Font24.Width - 3, 10, OVERLAY_DRAW_ALIGN_LEFT, "0123456789");
+  UTIL_LCD_SetTextColor(0xffffffff);
+  UTIL_LCD_SetBackColor(0xff000000);
+  UTIL_LCD_DisplayStringAt(FB_W - 5 * Font24.Width - 3, 10, (uint8_t *) "01234", LEFT_MODE);
+  flush();
+  CHECK(memcmp(fb, ref, sizeof(fb)) == 0);
+}
+
+static void test_circles(void)
+{
+  for (int radius = 0; radius <= 2 * OVERLAY_DRAW_MAX_MASK_RADIUS; radius++)
+  {
+    /* Inside, and clipped by each edge */
+    const int centres[][2] = { { 400, 240 }, { 2, 240 }, { FB_W - 3, 240 }, { 400, 1 }, { 400, FB_H - 2 }, { -3, -2 } };
+    uint32_t color = random_color();
+
+    clear();
+    for (size_t c = 0; c < sizeof(centres) / sizeof(centres[0]); c++)
+    {
+      int xc = centres[c][0], yc = centres[c][1];
+
+      OverlayDraw_FillCircle(&od, xc, yc, radius, color);
+      for (int dy = -radius; dy <= radius; dy++)
+        for (int dx = -radius; dx <= radius; dx++)
+          if (ref_inside(dx, dy, radius))
+            Ref_Set(xc + dx, yc + dy, ref_argb4444(color));
+    }
+    flush();
+    CHECK(memcmp(fb, ref, sizeof(fb)) == 0);
+  }
+}
+
+/* Mask blends over every ARGB4444 background, for foreground alphas from transparent to opaque */
+static void test_blend(void)
+{
+  static uint16_t background[256 * 256];
+  const int radius = OVERLAY_DRAW_MAX_MASK_RADIUS, size = 2 * radius + 1;
+  const uint32_t colors[] = { 0x00ff8040, 0x1012345f, 0x40ffffff, 0x80c0a020, 0xc0000000, 0xfe7f807f, 0xff336699 };
+
+  for (int i = 0; i < 256 * 256; i++)
+    background[i] = i;
+
+  for (size_t c = 0; c < sizeof(colors) / sizeof(colors[0]); c++)
+  {
+    clear();
+    OverlayDraw_Bitmap(&od, 0, 0, 256, 256, (const uint8_t *) background);
+    flush();
+    for (int yc = radius; yc < 256; yc += size)
+    {
+      for (int xc = radius; xc < 256; xc += size)
+      {
+        OverlayDraw_FillCircle(&od, xc, yc, radius, colors[c]);
+        if (od.nb_prims == OVERLAY_DRAW_MAX_PRIMITIVES)
+          flush();
+      }
+    }
+    flush();
+
+    for (int y = 0; y < 256; y++)
+    {
+      for (int x = 0; x < 256; x++)
+      {
+        int dx = (x % size) - radius, dy = (y % size) - radius;
+        uint32_t mask = ref_inside(dx, dy, radius) ? 0xff : 0x00;
+        uint16_t bg = background[y * 256 + x];
+        uint16_t expected = bg;
+
+        /* The whole mask is blended, transparent background pixels outside the disc are cleared */
+        if (x < 256 / size * size && y < 256 / size * size)
+          expected = ref_blend(colors[c], mask * (colors[c] >> 24) / 255, ref_expand(bg));
+
+        if (fb[y][x] != expected)
+        {
+          CHECK_EQ(fb[y][x], expected);
+          y = 256;
+          break;
+        }
+      }
+    }
+  }
+
+  /* Opaque over anything, transparent over anything, anything over transparent */
+  CHECK_EQ(ref_blend(0xff123456, 0xff, 0x80ffffff), 0xf135);
+  CHECK_EQ(ref_blend(0xff123456, 0x00, 0x80ffffff), 0x8fff);
+  CHECK_EQ(ref_blend(0x80123456, 0x80, 0x00ffffff), 0x8135);
+}
+
+static void test_bitmap(void)
+{
+  static uint16_t bitmap[37 * 23];
+  const int positions[][2] = { { 100, 100 }, { -10, -5 }, { FB_W - 30, FB_H - 7 }, { -37, 0 }, { FB_W, 0 } };
+
+  for (int i = 0; i < 37 * 23; i++)
+    bitmap[i] = rand();
+
+  clear();
+  for (size_t p = 0; p < sizeof(positions) / sizeof(positions[0]); p++)
+  {
+    OverlayDraw_Bitmap(&od, positions[p][0], positions[p][1], 37, 23, (const uint8_t *) bitmap);
+    for (int y = 0; y < 23; y++)
+      for (int x = 0; x < 37; x++)
+        Ref_Set(positions[p][0] + x, positions[p][1] + y, bitmap[y * 37 + x]);
+  }
+  flush();
+  CHECK(memcmp(fb, ref, sizeof(fb)) == 0);
+}
+
+static void test_queue(void)
+{
+  char text[64];
+  uint32_t drawn;
+
+  OverlayDraw_SetFont(&od, &Font12, atlas, sizeof(atlas));
+  for (int i = 0; i < OVERLAY_DRAW_MAX_PRIMITIVES + 5; i++)
+    OverlayDraw_FillRect(&od, i, 0, 1, 1, 0xffffffff);
+  CHECK_EQ(od.nb_prims, OVERLAY_DRAW_MAX_PRIMITIVES);
+  CHECK_EQ(od.nb_dropped, 5);
+  OverlayDraw_Flush(&od, NULL, NULL);
+  OverlayDraw_Begin(&od, (uint8_t *) fb);
+  CHECK_EQ(od.nb_dropped, 0);
+
+  /* Text longer than OVERLAY_DRAW_MAX_TEXT_LEN is cut, the pool is shared by the strings of the frame */
+  memset(text, 'a', sizeof(text) - 1);
+  text[sizeof(text) - 1] = '\0';
+  for (drawn = 0; od.nb_dropped == 0; drawn++)
+    OverlayDraw_PrintfAt(&od, 0, 0, OVERLAY_DRAW_ALIGN_LEFT, "%s", text);
+  CHECK(strlen((const char *) od.prims[0].data) == OVERLAY_DRAW_MAX_TEXT_LEN);
+  CHECK(od.text_pool_used <= OVERLAY_DRAW_TEXT_POOL_SIZE);
+  CHECK_EQ(drawn - 1, od.nb_prims);
+  CHECK(od.nb_prims > OVERLAY_DRAW_TEXT_POOL_SIZE / (OVERLAY_DRAW_MAX_TEXT_LEN + 1));
+  OverlayDraw_Flush(&od, NULL, NULL);
+  OverlayDraw_Begin(&od, (uint8_t *) fb);
+  CHECK_EQ(od.text_pool_used, 0);
+}
+
+/* Backend completing its ops later, as the DMA2D interrupt does */
+static uint32_t async_pending;
+static uint32_t async_ops;
+static uint32_t done_calls;
+
+static int Async_Execute(OverlayDraw_t *od, const OverlayOp_t *op)
+{
+  CHECK(!async_pending);
+  OverlayDraw_SwBackend.execute(od, op);
+  async_pending = 1;
+  async_ops++;
+  return 1;
+}
+
+static const OverlayDrawBackend_t async_backend = {
+  .execute = Async_Execute,
+};
+
+static void on_done(void *arg)
+{
+  CHECK(arg == &done_calls);
+  CHECK(!async_pending);
+  done_calls++;
+}
+
+/* Frame of the single pose application: 13 keypoints, 12 limbs, 5 text lines in Font20 */
+static void draw_frame(OverlayDraw_t *o, int seed)
+{
+  srand(seed);
+  for (int i = 0; i < 12; i++)
+  {
+    int x0 = 200 + rand() % 400, y0 = 50 + rand() % 300;
+
+    OverlayDraw_Line(o, x0, y0, x0 + rand() % 161 - 80, y0 + rand() % 161 - 80, 3, random_color());
+  }
+  for (int i = 0; i < 13; i++)
+    OverlayDraw_FillCircle(o, 200 + rand() % 400, 50 + rand() % 300, 5, random_color());
+  OverlayDraw_SetBackColor(o, 0x40000000);
+  for (int i = 0; i < 5; i++)
+    OverlayDraw_PrintfAt(o, 0, 300 + 20 * i, OVERLAY_DRAW_ALIGN_CENTER, "Gesture %d: %s", i, "LEFT ARM SWIPE");
+  OverlayDraw_SetBackColor(o, 0);
+}
+
+static void test_async(void)
+{
+  static OverlayDraw_t async_od;
+
+  clear();
+  OverlayDraw_SetFont(&od, &Font20, atlas, sizeof(atlas));
+  draw_frame(&od, 7);
+  OverlayDraw_Flush(&od, NULL, NULL);
+  memcpy(ref, fb, sizeof(ref));
+  memset(fb, 0, sizeof(fb));
+
+  OverlayDraw_Init(&async_od, &async_backend, FB_W, FB_H);
+  OverlayDraw_SetFont(&async_od, &Font20, atlas, sizeof(atlas));
+  OverlayDraw_Begin(&async_od, (uint8_t *) fb);
+  draw_frame(&async_od, 7);
+  async_ops = 0;
+  done_calls = 0;
+  OverlayDraw_Flush(&async_od, on_done, &done_calls);
+  while (async_od.busy)
+  {
+    CHECK(async_pending);
+    CHECK_EQ(done_calls, 0);
+    async_pending = 0;
+    OverlayDraw_OpDone(&async_od);
+  }
+  CHECK_EQ(done_calls, 1);
+  CHECK(memcmp(fb, ref, sizeof(fb)) == 0);
+  CHECK(async_ops > 12 + 13);
+
+  OverlayDraw_Begin(&od, (uint8_t *) fb);
+}
+
+/* CPU cost of a frame: queueing (all the CPU does with the DMA2D backend), software flush, stm32_lcd drawing */
+static void bench(void)
+{
+  const int runs = 2000;
+  static OverlayDraw_t count_od;
+  uint64_t t0, queue_ns, flush_ns = 0, lcd_ns;
+
+  OverlayDraw_Init(&count_od, &async_backend, FB_W, FB_H);
+  OverlayDraw_SetFont(&count_od, &Font20, atlas, sizeof(atlas));
+  OverlayDraw_Begin(&count_od, (uint8_t *) fb);
+  draw_frame(&count_od, 0);
+  async_ops = 0;
+  OverlayDraw_Flush(&count_od, NULL, NULL);
+  while (count_od.busy)
+  {
+    async_pending = 0;
+    OverlayDraw_OpDone(&count_od);
+  }
+  async_pending = 0;
+
+  OverlayDraw_SetFont(&od, &Font20, atlas, sizeof(atlas));
+  t0 = host_test_ns();
+  for (int n = 0; n < runs; n++)
+  {
+    OverlayDraw_Begin(&od, (uint8_t *) fb);
+    draw_frame(&od, n);
+  }
+  queue_ns = host_test_ns() - t0;
+  for (int n = 0; n < runs; n++)
+  {
+    OverlayDraw_Begin(&od, (uint8_t *) fb);
+    draw_frame(&od, n);
+    t0 = host_test_ns();
+    OverlayDraw_Flush(&od, NULL, NULL);
+    flush_ns += host_test_ns() - t0;
+  }
+
+  UTIL_LCD_SetFont(&Font20);
+  t0 = host_test_ns();
+  for (int n = 0; n < runs; n++)
+  {
+    srand(n);
+    for (int i = 0; i < 12; i++)
+    {
+      int x0 = 200 + rand() % 400, y0 = 50 + rand() % 300;
+      int x1 = x0 + rand() % 161 - 80, y1 = y0 + rand() % 161 - 80;
+
+      ref_line(x0, y0, x1, y1, 3, random_color());
+    }
+    for (int i = 0; i < 13; i++)
+    {
+      int x = 200 + rand() % 400, y = 50 + rand() % 300;
+
+      UTIL_LCD_FillCircle(x, y, 5, random_color());
+    }
+    UTIL_LCD_SetBackColor(0x40000000);
+    for (int i = 0; i < 5; i++)
+    {
+      char text[32];
+
+      snprintf(text, sizeof(text), "Gesture %d: %s", i, "LEFT ARM SWIPE");
+      UTIL_LCD_DisplayStringAt(0, 300 + 20 * i, (uint8_t *) text, CENTER_MODE);
+    }
+  }
+  lcd_ns = host_test_ns() - t0;
+
+  printf("frame of 12 limbs, 13 keypoints and 5 text lines: %u primitives, %u ops\n",
+         count_od.nb_prims, async_ops);
+  printf("queueing %.2f us, software flush %.2f us, stm32_lcd drawing %.2f us per frame\n",
+         queue_ns / 1e3 / runs, flush_ns / 1e3 / runs, lcd_ns / 1e3 / runs);
+}
+
+int main(int argc, char **argv)
+{
+  UTIL_LCD_SetFuncDriver(&ref_driver);
+  OverlayDraw_Init(&od, &OverlayDraw_SwBackend, FB_W, FB_H);
+  OverlayDraw_SetFont(&od, &Font24, atlas, sizeof(atlas));
+  OverlayDraw_Begin(&od, (uint8_t *) fb);
+  srand(11);
+
+  test_rects();
+  test_lines();
+  test_text();
+  test_circles();
+  test_blend();
+  test_bitmap();
+  test_queue();
+  test_async();
+  if (host_test_bench(argc, argv))
+    bench();
+
+  return host_test_result("test_overlay_draw");
+}
@@ -0,0 +1,406 @@
+/**
+ ******************************************************************************
+ * @file    test_pipeline.c
+ * @brief   Frame pipeline of the main loop (pipeline.c) with stub camera,
+ *          copy, NPU and CPU stage timings
+ ******************************************************************************
+ * The scheduler of the application runs on a simulated clock: its actions
+ * (camera, copy, inference, post-processing, drawing) only advance the clock
+ * by their duration, the main loop waits for the next camera frame, end of
+ * inference or end of copy when the scheduler can wait. Frames are either
+ * copied from the two buffers DCMIPP alternates between, by CPU or by an
+ * asynchronous DMA2D, or captured directly into the NN input buffers one
+ * snapshot at a time, with one or two NN input buffers (nn_input.c).
+ *
+ * The pipelined rate is compared with the capture, infer, draw serialization
+ * it replaces, where each frame is a camera snapshot: the slowest of the
+ * camera, NPU and CPU sets the rate of the copied frames, not their sum. A
+ * copy still running when DCMIPP writes its buffer again is torn: no torn
+ * frame may be inferred, a slow copy has its torn frames dropped.
+ ******************************************************************************
+ */
+
+#include "host_test.h"
+#include "pipeline.h"
+
+/* Stage durations in microseconds */
+typedef struct {
+  const char *name;
+  uint32_t camera;      /* Camera frame period */
+  uint32_t crop;        /* Copy into the NN input */
+  uint32_t inference;   /* NPU */
+  uint32_t postprocess;
+  uint32_t draw;        /* Gesture detection and overlay */
+} Timings_t;
+
+typedef enum {
+  MODE_COPY_CPU,
+  MODE_COPY_DMA2D,
+  MODE_DIRECT,
+} Mode_t;
+
+typedef struct {
+  double fps;
+  double latency_ms;    /* From the end of the capture to the end of the drawing */
+  uint32_t nb_torn;     /* Frames dropped by the pipeline */
+} Result_t;
+
+#define SIM_FRAMES 600
+/* Vertical blanking between two camera frames */
+#define BLANKING   1000
+/* Part of the drawing before the pipeline is advanced: gesture detection and debug prints */
+#define DRAW_GESTURE 1000
+
+__thread uint32_t mock_clock;
+
+/* DCMIPP capture buffers and NN input buffers, their content is not simulated */
+static uint8_t dcmipp_out[2][16];
+static uint8_t nn_in[2][16];
+
+static const Timings_t *tm;
+static Mode_t mode;
+static Pipeline_TypeDef pipeline;
+static uint64_t now;
+
+/* Camera: frame k ends at k * camera, its capture starts BLANKING after the end of frame k - 1 */
+static uint32_t last_frame;       /* Last frame returned by frame_get() */
+static uint32_t snapshot_frame;   /* Frame captured into snapshot_buffer, 0 if none */
+static uint8_t *snapshot_buffer;
+
+/* Copy in flight: frame copied, when it started, asynchronous end */
+static uint32_t copy_frame;
+static uint64_t dma2d_end;
+static int dma2d_busy;
+
+/* Frame held by each NN input buffer, then inferred, post-processed and drawn */
+static uint32_t nn_in_frame[2];
+static uint32_t ready_frame, inferred_frame, pp_frame;
+static uint64_t nn_end;
+static int nn_started;
+static uint32_t drawn;
+static uint64_t first_draw, latency;
+static int failures;
+
+static uint32_t frame_at(uint64_t t)
+{
+  return (uint32_t) (t / tm->camera);
+}
+
+static uint8_t *capture_buffer(uint32_t frame)
+{
+  return dcmipp_out[frame % 2];
+}
+
+/* Whether the copy of 'frame' ending at 'end' read it whole: DCMIPP writes frame + 2 into its buffer from then on */
+static int is_whole(uint32_t frame, uint64_t end)
+{
+  return end <= (uint64_t) (frame + 1) * tm->camera + BLANKING;
+}
+
+static void capture_start(uint8_t *buffer)
+{
+  /* The snapshot is the first frame whose capture starts after now */
+  uint64_t start = now + tm->camera - BLANKING;
+
+  snapshot_frame = (uint32_t) ((start + tm->camera - 1) / tm->camera);
+  snapshot_buffer = buffer;
+}
+
+static uint8_t *frame_get(uint32_t *seq, Roi_t *roi)
+{
+  uint32_t frame;
+
+  *roi = Roi_FullFrame;
+  if (mode == MODE_DIRECT)
+  {
+    if (!snapshot_frame || frame_at(now) < snapshot_frame)
+      return NULL;
+    *seq = snapshot_frame;
+    snapshot_frame = 0;
+    return snapshot_buffer;
+  }
+
+  frame = frame_at(now);
+  if (frame == 0 || frame == last_frame)
+    return NULL;
+  last_frame = frame;
+  *seq = frame;
+  return capture_buffer(frame);
+}
+
+/* As set by the frame event: the frame held, 0 once DCMIPP writes the buffer again after the next frame */
+static uint32_t frame_seq(const uint8_t *frame)
+{
+  uint32_t latest = frame_at(now);
+
+  return frame == capture_buffer(latest) ? latest : 0;
+}
+
+static int copy_start(const uint8_t *frame, uint8_t *buffer)
+{
+  (void) buffer;
+  if (mode != MODE_COPY_DMA2D)
+    return -1;
+
+  CHECK(!dma2d_busy);
+  CHECK(frame == capture_buffer(pipeline.nn_in_seq));
+  copy_frame = pipeline.nn_in_seq;
+  dma2d_end = now + tm->crop;
+  dma2d_busy = 1;
+  return 0;
+}
+
+static void copy(const uint8_t *frame, uint8_t *buffer)
+{
+  CHECK(frame == capture_buffer(pipeline.nn_in_seq));
+  copy_frame = pipeline.nn_in_seq;
+  now += tm->crop;
+  /* The torn frames are those the pipeline must drop */
+  nn_in_frame[buffer == nn_in[1]] = is_whole(copy_frame, now) ? copy_frame : 0;
+}
+
+static void commit(uint8_t *buffer)
+{
+  uint32_t frame = nn_in_frame[buffer == nn_in[1]];
+
+  if (mode == MODE_DIRECT)
+    frame = pipeline.nn_in_seq;
+  /* Never a torn frame, each one inferred once at most */
+  failures += frame == 0 || frame <= ready_frame;
+  ready_frame = frame;
+}
+
+static int inference_run(void)
+{
+  if (!nn_started)
+  {
+    /* The ready buffer is always the last one committed */
+    nn_started = 1;
+    inferred_frame = ready_frame;
+    nn_end = now + tm->inference;
+  }
+  if (now < nn_end)
+    return 0;
+  nn_started = 0;
+  return 1;
+}
+
+static void postprocess(const Roi_t *roi)
+{
+  (void) roi;
+  now += tm->postprocess;
+  pp_frame = inferred_frame;
+}
+
+/* DMA2D interrupt, at the end of the copy, handled once the CPU is interruptible */
+static void dma2d_irq(void)
+{
+  uint64_t t = now;
+
+  if (!dma2d_busy || now < dma2d_end)
+    return;
+
+  now = dma2d_end;
+  dma2d_busy = 0;
+  nn_in_frame[pipeline.nn_in_writing == nn_in[1]] = is_whole(copy_frame, now) ? copy_frame : 0;
+  Pipeline_InputWritten(&pipeline, 0);
+  now = t;
+}
+
+static void draw(int is_predicted)
+{
+  CHECK(!is_predicted);
+  /* As the application, the NPU is kept fed once the gesture is detected, before the overlay is drawn */
+  now += DRAW_GESTURE;
+  dma2d_irq();
+  Pipeline_Advance(&pipeline);
+  now += tm->draw - DRAW_GESTURE;
+  /* Steady state only */
+  if (drawn++ == 0)
+    first_draw = now;
+  else
+    latency += now - (uint64_t) pp_frame * tm->camera;
+}
+
+static const Pipeline_Ops_t ops_copy = {
+  .frame_get = frame_get,
+  .frame_seq = frame_seq,
+  .copy_start = copy_start,
+  .copy = copy,
+  .commit = commit,
+  .inference_run = inference_run,
+  .postprocess = postprocess,
+  .draw = draw,
+};
+
+static const Pipeline_Ops_t ops_direct = {
+  .capture_start = capture_start,
+  .frame_get = frame_get,
+  .commit = commit,
+  .inference_run = inference_run,
+  .postprocess = postprocess,
+  .draw = draw,
+};
+
+static int bind_input(uint8_t *buffer, uint32_t len)
+{
+  (void) buffer;
+  (void) len;
+  return 0;
+}
+
+static uint64_t next_frame_end(uint64_t t, uint32_t period)
+{
+  return (t / period + 1) * period;
+}
+
+/* Snapshot capture, inference, post-processing and drawing one after the other */
+static Result_t simulate_serial(const Timings_t *timings)
+{
+  uint64_t t = 0;
+  uint64_t total_latency = 0;
+  Result_t res = { 0 };
+
+  for (int i = 0; i < SIM_FRAMES; i++)
+  {
+    /* The snapshot waits for the start of the next frame, then for its capture */
+    uint64_t captured = next_frame_end(t, timings->camera) + timings->camera;
+
+    t = captured + timings->crop + timings->inference + timings->postprocess + timings->draw;
+    total_latency += t - captured;
+  }
+
+  res.fps = SIM_FRAMES * 1e6 / t;
+  res.latency_ms = total_latency / 1e3 / SIM_FRAMES;
+  return res;
+}
+
+/* Main loop of the application on the simulated clock */
+static Result_t simulate_pipelined(const Timings_t *timings, Mode_t sim_mode, int nb_buffers)
+{
+  NnInput_TypeDef input;
+  Result_t res;
+
+  tm = timings;
+  mode = sim_mode;
+  now = 0;
+  last_frame = 0;
+  snapshot_frame = 0;
+  dma2d_busy = 0;
+  nn_in_frame[0] = nn_in_frame[1] = 0;
+  ready_frame = inferred_frame = pp_frame = 0;
+  nn_started = 0;
+  drawn = 0;
+  latency = 0;
+  failures = 0;
+
+  NnInput_Init(&input, nn_in[0], nb_buffers == 2 ? nn_in[1] : NULL, sizeof(nn_in[0]),
+               nb_buffers == 2 ? bind_input : NULL);
+  Pipeline_Init(&pipeline, mode == MODE_DIRECT ? &ops_direct : &ops_copy, &input, NULL, mode == MODE_DIRECT,
+                sizeof(nn_in[0]), sizeof(nn_in[0]));
+
+  while (drawn < SIM_FRAMES)
+  {
+    uint32_t drawn_before = drawn;
+    uint64_t wake;
+
+    dma2d_irq();
+    mock_clock = (uint32_t) now;
+    Pipeline_Step(&pipeline);
+    if (drawn != drawn_before)
+      continue;
+
+    /* Nothing to do until the next event, whether the loop waits (WFE) or polls */
+    wake = next_frame_end(now, tm->camera);
+    if (nn_started && nn_end > now && nn_end < wake)
+      wake = nn_end;
+    if (dma2d_busy && dma2d_end > now && dma2d_end < wake)
+      wake = dma2d_end;
+    now = wake;
+  }
+
+  CHECK_EQ(failures, 0);
+  res.fps = (SIM_FRAMES - 1) * 1e6 / (now - first_draw);
+  res.latency_ms = latency / 1e3 / (SIM_FRAMES - 1);
+  res.nb_torn = pipeline.nb_torn;
+  return res;
+}
+
+/* Steady state frame rate of copied frames: the camera, the NPU or the CPU work of a frame limits it */
+static double bound_fps(const Timings_t *timings, Mode_t sim_mode, int nb_buffers)
+{
+  uint32_t crop = sim_mode == MODE_COPY_DMA2D ? 0 : timings->crop;
+  uint32_t cpu = crop + timings->postprocess + timings->draw;
+  /* The outputs of an inference are post-processed before the next one overwrites them. With a single input buffer,
+   * the next frame is only copied once the inference is done */
+  uint32_t npu = timings->inference + timings->postprocess + (nb_buffers == 2 ? 0 : timings->crop);
+  uint32_t period = timings->camera;
+
+  if (npu > period)
+    period = npu;
+  if (cpu > period)
+    period = cpu;
+  return 1e6 / period;
+}
+
+int main(int argc, char **argv)
+{
+  static const Timings_t scenarios[] = {
+    /* Default model, 30 fps camera: camera bound once pipelined */
+    { "camera bound", 33333, 400, 21000, 2500, 7000 },
+    /* Faster camera: NPU bound */
+    { "npu bound", 16667, 400, 25000, 2500, 7000 },
+    /* Heavy overlay: CPU bound */
+    { "cpu bound", 16667, 400, 12000, 4000, 15000 },
+  };
+  /* A copy longer than half a frame period, started late in the frame period when the CPU is busy */
+  static const Timings_t slow_copy = { "slow copy", 16667, 12000, 12000, 2500, 9000 };
+  Result_t res;
+
+  (void) argc;
+  (void) argv;
+
+  printf("%-13s %8s %8s %8s %8s %8s %8s %10s %10s\n", "scenario", "serial", "1 buf", "2 bufs", "dma2d", "direct 1",
+         "direct 2", "bound", "latency");
+  for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++)
+  {
+    const Timings_t *timings = &scenarios[i];
+    Result_t serial = simulate_serial(timings);
+    Result_t single = simulate_pipelined(timings, MODE_COPY_CPU, 1);
+    Result_t dual = simulate_pipelined(timings, MODE_COPY_CPU, 2);
+    Result_t dma2d = simulate_pipelined(timings, MODE_COPY_DMA2D, 2);
+    Result_t direct_single = simulate_pipelined(timings, MODE_DIRECT, 1);
+    Result_t direct_dual = simulate_pipelined(timings, MODE_DIRECT, 2);
+
+    printf("%-13s %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f %10.1f %8.1fms\n", timings->name, serial.fps, single.fps,
+           dual.fps, dma2d.fps, direct_single.fps, direct_dual.fps, bound_fps(timings, MODE_COPY_CPU, 2),
+           dual.latency_ms);
+
+    /* Pipelined: the slowest of camera, NPU and CPU sets the rate, not their sum */
+    CHECK_NEAR(single.fps, bound_fps(timings, MODE_COPY_CPU, 1), bound_fps(timings, MODE_COPY_CPU, 1) * 0.05);
+    CHECK_NEAR(dual.fps, bound_fps(timings, MODE_COPY_CPU, 2), bound_fps(timings, MODE_COPY_CPU, 2) * 0.05);
+    /* The copy in the background is only handed over to the NPU once the CPU gets back to the pipeline */
+    CHECK_NEAR(dma2d.fps, bound_fps(timings, MODE_COPY_DMA2D, 2), bound_fps(timings, MODE_COPY_DMA2D, 2) * 0.08);
+    CHECK(dual.fps >= single.fps * 0.99);
+    CHECK(single.fps > serial.fps * 1.4);
+    /* A frame is never drawn later than it was in the serial loop plus one stage of each unit */
+    CHECK(dual.latency_ms < serial.latency_ms + (timings->camera + timings->inference) / 1e3);
+    /* Direct capture: no copy, a snapshot missing the start of a frame waits for the next one */
+    CHECK(direct_single.fps >= serial.fps);
+    CHECK(direct_dual.fps > serial.fps * 1.2);
+    CHECK(direct_dual.fps >= direct_single.fps * 0.99);
+    CHECK(direct_dual.fps <= 1e6 / timings->camera * 1.01);
+    CHECK_EQ(direct_dual.nb_torn, 0);
+  }
+
+  /* Torn frames dropped, the others still inferred */
+  res = simulate_pipelined(&slow_copy, MODE_COPY_CPU, 2);
+  printf("%-13s %8s %8s %8.1f %8s %8s %8s %10s %8.1fms, %u frames torn\n", slow_copy.name, "", "", res.fps, "", "",
+         "", "", res.latency_ms, (unsigned) res.nb_torn);
+  CHECK(res.nb_torn > 0);
+  CHECK(res.fps > 0);
+  res = simulate_pipelined(&slow_copy, MODE_COPY_DMA2D, 2);
+  CHECK(res.fps > 0);
+
+  return host_test_result("test_pipeline");
+}
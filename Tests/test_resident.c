@@ -0,0 +1,143 @@
+/**
+ ******************************************************************************
+ * @file    test_resident.c
+ * @brief   Resident network API of the ATON runtime on the host simulation
+ *          platform
+ ******************************************************************************
+ */
+
+#include "sim_network.h"
+
+static const EpochBlock_ItemTypeDef pose_ebs[] = {
+  SIM_NETWORK_SW_EB(50000),
+  SIM_NETWORK_BLOB_EB(0x34000000),
+  SIM_NETWORK_SW_EB(20000),
+  SIM_NETWORK_BLOB_EB(0x34001000),
+  SIM_NETWORK_LAST_EB,
+};
+SIM_NETWORK_DECLARE(Pose, pose_ebs, sim_network_no_buffers);
+
+static uint32_t runtime_inits;
+static uint32_t epochs_started;
+
+static void runtime_trace(LL_ATON_RT_Callbacktype_t ctype)
+{
+  if (ctype == LL_ATON_RT_Callbacktype_RT_Init)
+    runtime_inits++;
+}
+
+static void epoch_trace(LL_ATON_RT_Callbacktype_t ctype, const NN_Instance_TypeDef *nn_instance,
+                        const EpochBlock_ItemTypeDef *eb)
+{
+  if (ctype == LL_ATON_RT_Callbacktype_PRE_START)
+    epochs_started++;
+}
+
+static void test_counters(void)
+{
+  LL_ATON_RT_Resident_TypeDef resident;
+  const LL_ATON_RT_ResidentStats_t *stats = LL_ATON_RT_Resident_GetStats(&resident);
+  uint64_t total = 0;
+  /* Two blobs of the modelled epoch controller latency and the SW blocks */
+  uint32_t min_ns = 2 * HOST_SIM_EPOCHCTRL_LATENCY_NS + 70000;
+
+  LL_ATON_RT_SetEpochCallback(epoch_trace, &NN_Instance_Pose);
+  LL_ATON_RT_Resident_Init(&resident, &NN_Instance_Pose);
+  CHECK_EQ(sim_network_Pose_inits, 1);
+  CHECK_EQ(runtime_inits, 1);
+  CHECK_EQ(stats->nr_inferences, 0);
+  CHECK(stats->init_ticks > 0);
+  CHECK_EQ(stats->min_inference_ticks, UINT32_MAX);
+
+  for (int i = 0; i < 5; i++)
+  {
+    LL_ATON_RT_Resident_Run(&resident);
+    total += stats->last_inference_ticks;
+    CHECK(stats->last_inference_ticks >= min_ns);
+    /* Re-armed for the next inference, not re-initialized */
+    CHECK(!resident.running);
+    CHECK(NN_Instance_Pose.exec_state.current_epoch_block == pose_ebs);
+  }
+  CHECK_EQ(stats->nr_inferences, 5);
+  CHECK_EQ(epochs_started, 5 * 4);
+  CHECK_EQ(sim_network_sw_blocks, 5 * 2);
+  CHECK_EQ(sim_network_Pose_inits, 1);
+  CHECK_EQ(runtime_inits, 1);
+  CHECK_EQ(stats->total_inference_ticks, total);
+  CHECK(stats->min_inference_ticks <= stats->last_inference_ticks);
+  CHECK(stats->max_inference_ticks >= stats->last_inference_ticks);
+  CHECK(stats->max_inference_ticks * 5ull >= total);
+  CHECK(stats->min_inference_ticks * 5ull <= total);
+  CHECK(stats->last_rearm_ticks < stats->min_inference_ticks);
+
+  /* Stepped by the caller: the inference only counts once done */
+  LL_ATON_RT_RetValues_t ret = LL_ATON_RT_Resident_RunEpochBlock(&resident);
+  CHECK(ret != LL_ATON_RT_DONE);
+  CHECK(resident.running);
+  CHECK_EQ(stats->nr_inferences, 5);
+  while (ret != LL_ATON_RT_DONE)
+  {
+    if (ret == LL_ATON_RT_WFE)
+      LL_ATON_OSAL_WFE();
+    ret = LL_ATON_RT_Resident_RunEpochBlock(&resident);
+  }
+  CHECK_EQ(stats->nr_inferences, 6);
+
+  uint32_t init_ticks = stats->init_ticks;
+  LL_ATON_RT_Resident_ResetStats(&resident);
+  CHECK_EQ(stats->nr_inferences, 0);
+  CHECK_EQ(stats->total_inference_ticks, 0);
+  CHECK_EQ(stats->init_ticks, init_ticks);
+
+  LL_ATON_RT_Resident_DeInit(&resident);
+  LL_ATON_RT_SetEpochCallback(NULL, &NN_Instance_Pose);
+}
+
+/* LL_ATON_RT_Main() initializes the runtime and the network around each inference, the resident network only re-arms
+ * the instance */
+static void test_main(int bench)
+{
+  const int runs = bench ? 10000 : 10;
+  uint32_t inits = sim_network_Pose_inits;
+  uint64_t t0, setup_ns, rearm_ns;
+
+  for (int i = 0; i < 3; i++)
+    LL_ATON_RT_Main(&NN_Instance_Pose);
+  CHECK_EQ(sim_network_Pose_inits - inits, 3);
+  CHECK_EQ(runtime_inits, 1 + 3);
+
+  t0 = host_test_ns();
+  for (int i = 0; i < runs; i++)
+  {
+    LL_ATON_RT_RuntimeInit();
+    LL_ATON_RT_Init_Network(&NN_Instance_Pose);
+    LL_ATON_RT_DeInit_Network(&NN_Instance_Pose);
+    LL_ATON_RT_RuntimeDeInit();
+  }
+  setup_ns = host_test_ns() - t0;
+
+  LL_ATON_RT_RuntimeInit();
+  LL_ATON_RT_Init_Network(&NN_Instance_Pose);
+  t0 = host_test_ns();
+  for (int i = 0; i < runs; i++)
+    LL_ATON_RT_Reset_Network(&NN_Instance_Pose);
+  rearm_ns = host_test_ns() - t0;
+  LL_ATON_RT_DeInit_Network(&NN_Instance_Pose);
+  LL_ATON_RT_RuntimeDeInit();
+
+  if (bench)
+  {
+    printf("per inference setup: LL_ATON_RT_Main %.2f us, resident %.2f us\n", setup_ns / 1e3 / runs,
+           rearm_ns / 1e3 / runs);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  LL_ATON_RT_SetRuntimeCallback(runtime_trace);
+
+  test_counters();
+  test_main(host_test_bench(argc, argv));
+
+  return host_test_result("test_resident");
+}
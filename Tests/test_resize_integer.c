@@ -0,0 +1,328 @@
+/**
+ ******************************************************************************
+ * @file    test_resize_integer.c
+ * @brief   Integer fast path of the int8 bilinear Resize of the ATON software
+ *          fallback, against a model of the generic kernel
+ ******************************************************************************
+ * The generic kernel (forward_resize_bilinear_is8os8) is only delivered in the
+ * target network runtime library: it is replaced here by a stub counting its
+ * calls, and its arithmetic by a model (half-pixel source coordinates clamped
+ * to the input, raw int8 values interpolated in float, rounded half away from
+ * zero). The fast path must match the model bit for bit on the configurations
+ * it takes, and leave all the others to the generic kernel without writing
+ * the output. The Helium blend is checked through a scalar model of its
+ * 16-bit arithmetic.
+ ******************************************************************************
+ */
+
+#include <stdlib.h>
+#include "host_test.h"
+#include "ll_sw.h"
+#include "layers_resize.h"
+
+void ll_sw_forward_resize_integer(void *sw_info_struct);
+
+/* Generic kernels of the network runtime library */
+static uint32_t generic_calls;
+
+void forward_resize_bilinear_is8os8(ai_layer *layer)
+{
+  generic_calls++;
+}
+
+void forward_resize_nearest_is8os8(ai_layer *layer)
+{
+  generic_calls++;
+}
+
+/* Model of the generic kernel, NHWC */
+static void model_resize(const int8_t *in, int8_t *out, int b, int h, int w, int c, int fh, int fw)
+{
+  for (int n = 0; n < b; n++)
+  {
+    for (int oy = 0; oy < h * fh; oy++)
+    {
+      float sy = fmaxf((oy + 0.5f) / fh - 0.5f, 0.0f);
+      int y0 = (int) sy, y1 = y0 + 1 < h ? y0 + 1 : h - 1;
+      float dy = sy - y0;
+
+      for (int ox = 0; ox < w * fw; ox++)
+      {
+        float sx = fmaxf((ox + 0.5f) / fw - 0.5f, 0.0f);
+        int x0 = (int) sx, x1 = x0 + 1 < w ? x0 + 1 : w - 1;
+        float dx = sx - x0;
+
+        for (int k = 0; k < c; k++)
+        {
+          const int8_t *src = in + n * h * w * c + k;
+          float top = src[(y0 * w + x0) * c] * (1 - dx) + src[(y0 * w + x1) * c] * dx;
+          float bottom = src[(y1 * w + x0) * c] * (1 - dx) + src[(y1 * w + x1) * c] * dx;
+
+          out[((n * h * fh + oy) * w * fw + ox) * c + k] = (int8_t) roundf(top * (1 - dy) + bottom * dy);
+        }
+      }
+    }
+  }
+}
+
+/* Operator of a b x h x w x c NHWC tensor upsampled by (fh, fw) */
+typedef struct {
+  Resize_integer_sw_info info;
+  float scales[4];
+  float is, os;
+  int8_t izp, ozp;
+} Resize_t;
+
+static void tensor_nhwc(Tensor_info *t, int8_t *data, int b, int h, int w, int c)
+{
+  memset(t, 0, sizeof(*t));
+  t->dim.tensor_b = b;
+  t->dim.tensor_h = h;
+  t->dim.tensor_w = w;
+  t->dim.tensor_c = c;
+  t->dim.num_elem = b * h * w * c;
+  t->stride.c = 1;
+  t->stride.w = c;
+  t->stride.h = w * c;
+  t->stride.b = h * w * c;
+  t->mem.start_offset = (unsigned char *) data;
+  t->format.is_signed = true;
+}
+
+static void tensor_scalar(Tensor_info *t, void *data, bool is_signed)
+{
+  memset(t, 0, sizeof(*t));
+  t->dim.tensor_b = t->dim.tensor_h = t->dim.tensor_w = t->dim.tensor_c = 1;
+  t->dim.num_elem = 1;
+  t->mem.start_offset = data;
+  t->format.is_signed = is_signed;
+}
+
+static void resize_init(Resize_t *r, int8_t *in, int8_t *out, int b, int h, int w, int c, int fh, int fw)
+{
+  memset(r, 0, sizeof(*r));
+  r->info.general.type = LL_SW_RESIZE;
+  tensor_nhwc(&r->info.general.input, in, b, h, w, c);
+  tensor_nhwc(&r->info.general.output, out, b, h * fh, w * fw, c);
+  r->is = r->os = 0.0234f;
+  r->izp = r->ozp = -7;
+  tensor_scalar(&r->info.is, &r->is, true);
+  tensor_scalar(&r->info.os, &r->os, true);
+  tensor_scalar(&r->info.izp, &r->izp, true);
+  tensor_scalar(&r->info.ozp, &r->ozp, true);
+  r->scales[0] = r->scales[1] = 1.0f;
+  r->scales[2] = fh;
+  r->scales[3] = fw;
+  tensor_scalar(&r->info.scales, r->scales, true);
+  r->info.scales.dim.tensor_c = 4;
+  r->info.scales.dim.num_elem = 4;
+  r->info.mode = RESIZE_LINEAR;
+  r->info.coord_transf_mode = HALF_PIXEL;
+}
+
+#define MAX_ELEMS (2 * 24 * 24 * 4 * 4 * 33)
+
+static int8_t input[MAX_ELEMS];
+static int8_t output[MAX_ELEMS];
+static int8_t expected[MAX_ELEMS];
+
+static void random_input(int n, int extremes)
+{
+  for (int i = 0; i < n; i++)
+    input[i] = extremes ? ((rand() & 1) ? 127 : -128) : (int8_t) rand();
+}
+
+/* Factors 2 and 4 on each axis, odd and even sizes, channel counts around the Helium vector length */
+static void test_fast_path(void)
+{
+  static const int sizes[] = { 1, 2, 3, 5, 6, 7, 12, 17, 24 };
+  static const int channels[] = { 1, 3, 8, 9, 16, 17, 33 };
+  uint32_t cases = 0;
+
+  srand(21);
+  for (int fh = 2; fh <= 4; fh += 2)
+  {
+    for (int fw = 2; fw <= 4; fw += 2)
+    {
+      for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+      {
+        for (size_t k = 0; k < sizeof(channels) / sizeof(channels[0]); k++)
+        {
+          int h = sizes[s], w = sizes[(s * 5 + k) % (sizeof(sizes) / sizeof(sizes[0]))], c = channels[k];
+          int b = 1 + (s + k) % 2;
+          int n_in = b * h * w * c, n_out = n_in * fh * fw;
+          Resize_t r;
+
+          random_input(n_in, (s + k) % 3 == 0);
+          resize_init(&r, input, output, b, h, w, c, fh, fw);
+          /* Both half-pixel transformations are the same for sizes above 1 */
+          r.info.coord_transf_mode = k % 2 ? HALF_PIXEL : PYTORCH_HALF_PIXEL;
+          memset(output, 0x55, n_out + 1);
+          model_resize(input, expected, b, h, w, c, fh, fw);
+          generic_calls = 0;
+
+          ll_sw_forward_resize_integer(&r.info);
+          CHECK_EQ(generic_calls, 0);
+          CHECK(memcmp(output, expected, n_out) == 0);
+          /* Nothing written past the output */
+          CHECK_EQ(output[n_out], 0x55);
+          cases++;
+        }
+      }
+    }
+  }
+  CHECK(cases > 200);
+}
+
+/* Configurations the fast path does not cover go to the generic kernel, the output untouched */
+static void test_fallbacks(void)
+{
+  for (int variant = 0; variant < 10; variant++)
+  {
+    Resize_t r;
+    int fh = 2, fw = 2;
+
+    if (variant == 0)
+      fh = 3;
+    if (variant == 1)
+      fw = 1;
+    resize_init(&r, input, output, 1, 5, 7, 3, fh, fw);
+    switch (variant)
+    {
+    case 2:
+      r.info.mode = RESIZE_NEAREST;
+      break;
+    case 3:
+      r.info.coord_transf_mode = ASYMMETRIC;
+      break;
+    case 4:
+      r.os = 2 * r.is;
+      break;
+    case 5:
+      r.ozp = r.izp + 1;
+      break;
+    case 6:
+      r.info.general.output.format.is_signed = false;
+      break;
+    case 7:
+      /* Scale not matching the output size */
+      r.scales[3] = 2.5f;
+      break;
+    case 8:
+      /* Not channel-contiguous */
+      r.info.general.input.stride.c = 5 * 7;
+      r.info.general.input.stride.w = 1;
+      r.info.general.input.stride.h = 7;
+      break;
+    case 9:
+      /* Per-channel quantization */
+      r.info.is.dim.num_elem = 3;
+      break;
+    }
+    memset(output, 0x55, 5 * 7 * 3 * 16);
+    generic_calls = 0;
+
+    ll_sw_forward_resize_integer(&r.info);
+    CHECK_EQ(generic_calls, 1);
+    for (int i = 0; i < 5 * 7 * 3 * 16; i++)
+    {
+      if (output[i] != 0x55)
+      {
+        CHECK_EQ(output[i], 0x55);
+        break;
+      }
+    }
+  }
+}
+
+/*
+ * Scalar model of the Helium blend: 16-bit lanes, rounding by adding the sign
+ * then half and shifting. Checked against the generic rounding for all the
+ * tap weights of both factors, on extreme and random pixels.
+ */
+static int8_t mve_model_blend(const int8_t p[4], const int16_t w[4], uint32_t shift)
+{
+  int16_t acc = (int16_t) (p[0] * w[0]);
+
+  acc = (int16_t) (acc + p[1] * w[1]);
+  acc = (int16_t) (acc + p[2] * w[2]);
+  acc = (int16_t) (acc + p[3] * w[3]);
+  acc = (int16_t) (acc + (acc >> 15));
+  acc = (int16_t) (acc + (1 << (shift - 1)));
+  return (int8_t) (acc >> shift);
+}
+
+static void test_mve_model(void)
+{
+  srand(4);
+  for (int log2_fh = 1; log2_fh <= 2; log2_fh++)
+  {
+    for (int log2_fw = 1; log2_fw <= 2; log2_fw++)
+    {
+      int den_h = 2 << log2_fh, den_w = 2 << log2_fw;
+      uint32_t shift = log2_fh + 1 + log2_fw + 1;
+
+      for (int wy = 0; wy <= den_h; wy++)
+      {
+        for (int wx = 0; wx <= den_w; wx++)
+        {
+          const int16_t w[4] = { (den_h - wy) * (den_w - wx), (den_h - wy) * wx, wy * (den_w - wx), wy * wx };
+
+          for (int n = 0; n < 2000; n++)
+          {
+            int8_t p[4];
+            float ref;
+
+            for (int i = 0; i < 4; i++)
+              p[i] = n < 16 ? ((n >> i) & 1 ? 127 : -128) : (int8_t) rand();
+            ref = ((p[0] * (1.0f - (float) wx / den_w) + p[1] * ((float) wx / den_w)) * (1.0f - (float) wy / den_h) +
+                   (p[2] * (1.0f - (float) wx / den_w) + p[3] * ((float) wx / den_w)) * ((float) wy / den_h));
+            if (mve_model_blend(p, w, shift) != (int8_t) roundf(ref))
+            {
+              CHECK_EQ(mve_model_blend(p, w, shift), (int8_t) roundf(ref));
+              n = 2000;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+/* Decoder-like shapes of the MoveNet graph, against the float interpolation of the model */
+static void bench(void)
+{
+  static const int shapes[][3] = { { 6, 6, 64 }, { 12, 12, 64 }, { 24, 24, 32 } };
+
+  for (size_t s = 0; s < sizeof(shapes) / sizeof(shapes[0]); s++)
+  {
+    const int h = shapes[s][0], w = shapes[s][1], c = shapes[s][2], runs = 200;
+    const double n_out = 4.0 * h * w * c * runs;
+    uint64_t t0, fast_ns, model_ns;
+    Resize_t r;
+
+    random_input(h * w * c, 0);
+    resize_init(&r, input, output, 1, h, w, c, 2, 2);
+    t0 = host_test_ns();
+    for (int n = 0; n < runs; n++)
+      ll_sw_forward_resize_integer(&r.info);
+    fast_ns = host_test_ns() - t0;
+    t0 = host_test_ns();
+    for (int n = 0; n < runs; n++)
+      model_resize(input, expected, 1, h, w, c, 2, 2);
+    model_ns = host_test_ns() - t0;
+    printf("resize 2x %2dx%2dx%2d: fast path %.2f ns, float interpolation %.2f ns per output element\n", h, w, c,
+           fast_ns / n_out, model_ns / n_out);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  test_fast_path();
+  test_fallbacks();
+  test_mve_model();
+  if (host_test_bench(argc, argv))
+    bench();
+
+  return host_test_result("test_resize_integer");
+}
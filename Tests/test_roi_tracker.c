@@ -0,0 +1,377 @@
+/**
+ ******************************************************************************
+ * @file    test_roi_tracker.c
+ * @brief   Keypoint-driven zoom region of the NN pipe (roi_tracker.c): region
+ *          update, pixel crop and inverse map
+ ******************************************************************************
+ * The crop of app_camerapipeline.c is computed by Roi_ToPixels() on the area
+ * output without zoom, e.g. the 1944 x 1944 centre of the 2592 x 1944 frame
+ * of the IMX335 with ASPECT_RATIO_CROP. Checked here: regions and crops
+ * shifted back inside the frame rather than shrunk near its edges, square
+ * regions giving square crops (the NN input aspect ratio) with
+ * ASPECT_RATIO_CROP and the frame aspect ratio otherwise, the fallback to the
+ * full frame after missed detections, and keypoints inferred on a crop mapped
+ * back to their full frame coordinates, and the dead band of the crop
+ * reprogramming on each of its edges. A closed loop then follows a person
+ * walking across the frame and away from the camera.
+ ******************************************************************************
+ */
+
+#include <stdlib.h>
+#include "host_test.h"
+#include "roi_tracker.h"
+
+#define NB_KP 17
+#define MIN_CONFIDENCE 0.3f
+/* Normalized coordinates of the pixel crops, a fraction of a pixel of the 1944 pixels full area */
+#define PIXEL_TOL (1.0 / 1944)
+
+static const RoiTracker_Params_t params = {
+  .margin = 0.25f,
+  .min_size = 0.25f,
+  .min_confidence = MIN_CONFIDENCE,
+  .shrink_rate = 0.2f,
+  .min_keypoints = 4,
+  .max_missed = 3,
+};
+
+/* Same, the region jumping to its target */
+static const RoiTracker_Params_t jump_params = {
+  .margin = 0.25f,
+  .min_size = 0.25f,
+  .min_confidence = MIN_CONFIDENCE,
+  .shrink_rate = 1.0f,
+  .min_keypoints = 4,
+  .max_missed = 3,
+};
+
+/* Confident keypoints spread over the box (x0, y0)-(x1, y1), a few unconfident ones anywhere */
+static void person(spe_pp_outBuffer_t *kp, float x0, float y0, float x1, float y1)
+{
+  for (int i = 0; i < NB_KP; i++)
+  {
+    kp[i].x_center = x0 + (x1 - x0) * (i % 4) / 3.0f;
+    kp[i].y_center = y0 + (y1 - y0) * (i / 4) / 3.0f;
+    kp[i].proba = 0.9f;
+  }
+  kp[NB_KP - 1].x_center = 0.0f;
+  kp[NB_KP - 1].y_center = 1.0f;
+  kp[NB_KP - 1].proba = MIN_CONFIDENCE / 2;
+}
+
+static void lost(spe_pp_outBuffer_t *kp)
+{
+  person(kp, 0.4f, 0.4f, 0.6f, 0.6f);
+  for (int i = 3; i < NB_KP; i++)
+    kp[i].proba = 0.1f;
+}
+
+static int inside(const Roi_t *roi)
+{
+  return roi->x0 >= 0.0f && roi->y0 >= 0.0f && roi->x0 + roi->width <= 1.0f + 1e-6f &&
+         roi->y0 + roi->height <= 1.0f + 1e-6f;
+}
+
+/* Whether the confident keypoints are in the region */
+static int covers(const Roi_t *roi, const spe_pp_outBuffer_t *kp)
+{
+  for (int i = 0; i < NB_KP; i++)
+  {
+    if (kp[i].proba >= MIN_CONFIDENCE &&
+        (kp[i].x_center < roi->x0 - 1e-6f || kp[i].x_center > roi->x0 + roi->width + 1e-6f ||
+         kp[i].y_center < roi->y0 - 1e-6f || kp[i].y_center > roi->y0 + roi->height + 1e-6f))
+      return 0;
+  }
+  return 1;
+}
+
+static void test_edges(void)
+{
+  spe_pp_outBuffer_t kp[NB_KP];
+  RoiTracker_t tracker;
+  const Roi_t *roi;
+
+  RoiTracker_Init(&tracker, &jump_params);
+
+  /* Box 0.2 wide with 0.25 margins: 0.3, centred when far from the edges */
+  person(kp, 0.4f, 0.3f, 0.6f, 0.5f);
+  roi = RoiTracker_Update(&tracker, kp, NB_KP);
+  CHECK_NEAR(roi->width, 0.3, 1e-6);
+  CHECK_NEAR(roi->x0, 0.35, 1e-6);
+  CHECK_NEAR(roi->y0, 0.25, 1e-6);
+
+  /* In each corner: shifted inside, not shrunk */
+  static const float corners[4][2] = { { 0.0f, 0.0f }, { 0.8f, 0.0f }, { 0.0f, 0.8f }, { 0.8f, 0.8f } };
+  for (int c = 0; c < 4; c++)
+  {
+    RoiTracker_Reset(&tracker);
+    person(kp, corners[c][0], corners[c][1], corners[c][0] + 0.2f, corners[c][1] + 0.2f);
+    roi = RoiTracker_Update(&tracker, kp, NB_KP);
+    CHECK(inside(roi));
+    CHECK(covers(roi, kp));
+    CHECK_NEAR(roi->width, 0.3, 1e-6);
+    CHECK_NEAR(roi->x0, corners[c][0] == 0.0f ? 0.0 : 0.7, 1e-6);
+    CHECK_NEAR(roi->y0, corners[c][1] == 0.0f ? 0.0 : 0.7, 1e-6);
+  }
+
+  /* Smaller than the highest zoom, larger than the frame */
+  RoiTracker_Reset(&tracker);
+  person(kp, 0.95f, 0.5f, 1.0f, 0.52f);
+  roi = RoiTracker_Update(&tracker, kp, NB_KP);
+  CHECK_NEAR(roi->width, params.min_size, 1e-6);
+  CHECK_NEAR(roi->x0, 1.0 - params.min_size, 1e-6);
+  CHECK(inside(roi) && covers(roi, kp));
+  person(kp, 0.0f, 0.1f, 1.0f, 0.9f);
+  roi = RoiTracker_Update(&tracker, kp, NB_KP);
+  CHECK(memcmp(roi, &Roi_FullFrame, sizeof(*roi)) == 0);
+
+  /* Pixel crops at the right and bottom edges: rounding never pushes them out of the frame */
+  Roi_Pixels_t px;
+  Roi_t captured;
+  for (int i = 0; i <= 1000; i++)
+  {
+    Roi_t r = { .width = 0.25f + 0.75f * i / 1000, .height = 0.25f + 0.75f * i / 1000 };
+
+    r.x0 = r.y0 = 1.0f - r.width;
+    Roi_ToPixels(&r, 1944, 1944, 192, 192, &px, &captured);
+    CHECK(px.x0 + px.width <= 1944 && px.y0 + px.height <= 1944);
+    CHECK_NEAR(captured.x0, r.x0, PIXEL_TOL);
+    CHECK_NEAR(captured.width, r.width, PIXEL_TOL);
+  }
+
+  /* Crops below the NN input size are enlarged: the downsize cannot upscale */
+  Roi_t tiny = { .x0 = 0.99f, .y0 = 0.5f, .width = 0.05f, .height = 0.05f };
+  Roi_ToPixels(&tiny, 1944, 1944, 192, 192, &px, &captured);
+  CHECK_EQ(px.width, 192);
+  CHECK_EQ(px.height, 192);
+  CHECK_EQ(px.x0, 1944 - 192);
+  CHECK(inside(&captured));
+}
+
+static void test_aspect_ratio(void)
+{
+  spe_pp_outBuffer_t kp[NB_KP];
+  RoiTracker_t tracker;
+  Roi_Pixels_t px;
+  Roi_t captured;
+  int failures = 0;
+
+  RoiTracker_Init(&tracker, &jump_params);
+  srand(1);
+  for (int i = 0; i < 2000; i++)
+  {
+    float w = 0.02f + 0.9f * rand() / RAND_MAX, h = 0.02f + 0.9f * rand() / RAND_MAX;
+    float x0 = (1.0f - w) * rand() / RAND_MAX, y0 = (1.0f - h) * rand() / RAND_MAX;
+    const Roi_t *roi;
+
+    person(kp, x0, y0, x0 + w, y0 + h);
+    roi = RoiTracker_Update(&tracker, kp, NB_KP);
+    /* Square in full frame coordinates, whatever the box */
+    failures += roi->width != roi->height || !inside(roi);
+
+    /* ASPECT_RATIO_CROP: the area output without zoom is square, so are the crops (the NN input ratio) */
+    Roi_ToPixels(roi, 1944, 1944, 192, 192, &px, &captured);
+    failures += px.width != px.height || px.x0 + px.width > 1944 || px.y0 + px.height > 1944;
+    failures += captured.width != captured.height;
+
+    /* Other modes: the full 4:3 frame, the crops keep its ratio (the NN input distorted as without zoom) */
+    Roi_ToPixels(roi, 2592, 1944, 192, 192, &px, &captured);
+    failures += abs((int) (px.width * 3) - (int) (px.height * 4)) > 4;
+    failures += px.x0 + px.width > 2592 || px.y0 + px.height > 1944;
+  }
+  CHECK_EQ(failures, 0);
+}
+
+static void test_lost(void)
+{
+  spe_pp_outBuffer_t kp[NB_KP], none[NB_KP];
+  RoiTracker_t tracker;
+  Roi_t zoomed;
+
+  RoiTracker_Init(&tracker, &params);
+  person(kp, 0.1f, 0.6f, 0.3f, 0.8f);
+  lost(none);
+  zoomed = *RoiTracker_Update(&tracker, kp, NB_KP);
+  CHECK(zoomed.width < 1.0f);
+
+  /* Kept for max_missed - 1 missed detections, then the full frame */
+  for (int i = 0; i < params.max_missed - 1; i++)
+    CHECK(memcmp(RoiTracker_Update(&tracker, none, NB_KP), &zoomed, sizeof(zoomed)) == 0);
+  CHECK(memcmp(RoiTracker_Update(&tracker, none, NB_KP), &Roi_FullFrame, sizeof(zoomed)) == 0);
+  CHECK(memcmp(RoiTracker_Update(&tracker, none, 0), &Roi_FullFrame, sizeof(zoomed)) == 0);
+
+  /* A detection resets the count of missed ones */
+  RoiTracker_Update(&tracker, kp, NB_KP);
+  for (int i = 0; i < params.max_missed - 1; i++)
+  {
+    RoiTracker_Update(&tracker, none, NB_KP);
+    CHECK(RoiTracker_Update(&tracker, kp, NB_KP)->width < 1.0f);
+  }
+  CHECK_EQ(tracker.missed, 0);
+
+  /* Reset */
+  RoiTracker_Reset(&tracker);
+  CHECK(memcmp(&tracker.roi, &Roi_FullFrame, sizeof(zoomed)) == 0);
+}
+
+static void test_zoom(void)
+{
+  spe_pp_outBuffer_t kp[NB_KP];
+  RoiTracker_t tracker;
+  const Roi_t *roi;
+  float prev;
+
+  /* Zoom in over several frames, the region always containing the keypoints */
+  RoiTracker_Init(&tracker, &params);
+  person(kp, 0.45f, 0.45f, 0.55f, 0.55f);
+  prev = 1.0f;
+  for (int i = 0; i < 10; i++)
+  {
+    roi = RoiTracker_Update(&tracker, kp, NB_KP);
+    CHECK(roi->width < prev && covers(roi, kp) && inside(roi));
+    prev = roi->width;
+  }
+  CHECK_NEAR(RoiTracker_Update(&tracker, kp, NB_KP)->width, params.min_size, 0.1);
+
+  /* Out at once when the keypoints leave the region */
+  person(kp, 0.1f, 0.1f, 0.8f, 0.8f);
+  roi = RoiTracker_Update(&tracker, kp, NB_KP);
+  CHECK(covers(roi, kp));
+  CHECK_NEAR(roi->width, 1.0, 1e-6);
+}
+
+static void test_inverse_map(void)
+{
+  spe_pp_outBuffer_t truth[NB_KP], kp[NB_KP];
+  Roi_Pixels_t px;
+  Roi_t captured;
+  double max_error = 0;
+
+  srand(2);
+  for (int n = 0; n < 1000; n++)
+  {
+    Roi_t roi = { .width = 0.25f + 0.75f * rand() / RAND_MAX };
+
+    roi.height = roi.width;
+    roi.x0 = (1.0f - roi.width) * rand() / RAND_MAX;
+    roi.y0 = (1.0f - roi.height) * rand() / RAND_MAX;
+    Roi_ToPixels(&roi, 1944, 1944, 192, 192, &px, &captured);
+
+    /* Keypoints as inferred on the crop, i.e. relative to the pixels actually captured */
+    for (int i = 0; i < NB_KP; i++)
+    {
+      truth[i].x_center = (px.x0 + (float) rand() / RAND_MAX * px.width) / 1944;
+      truth[i].y_center = (px.y0 + (float) rand() / RAND_MAX * px.height) / 1944;
+      kp[i].x_center = (truth[i].x_center * 1944 - px.x0) / px.width;
+      kp[i].y_center = (truth[i].y_center * 1944 - px.y0) / px.height;
+      kp[i].proba = 1.0f;
+    }
+    Roi_ToFullFrame(&captured, kp, NB_KP);
+    for (int i = 0; i < NB_KP; i++)
+    {
+      max_error = fmax(max_error, fabs(kp[i].x_center - truth[i].x_center));
+      max_error = fmax(max_error, fabs(kp[i].y_center - truth[i].y_center));
+    }
+  }
+  /* float32 rounding only */
+  CHECK(max_error < 1e-6);
+
+  /* Full frame: identity */
+  person(kp, 0.1f, 0.2f, 0.7f, 0.9f);
+  memcpy(truth, kp, sizeof(kp));
+  Roi_ToFullFrame(&Roi_FullFrame, kp, NB_KP);
+  CHECK(memcmp(kp, truth, sizeof(kp)) == 0);
+}
+
+static void test_dead_band(void)
+{
+  const Roi_Pixels_t from = { 100, 200, 400, 400 };
+  Roi_Pixels_t to = from;
+
+  CHECK(!Roi_PixelsMoved(&from, &to, 0));
+  CHECK(!Roi_PixelsMoved(&from, &to, 16));
+
+  /* Each edge on its own, either way */
+  to.x0 = from.x0 + 16;
+  to.width = from.width - 16;
+  CHECK(!Roi_PixelsMoved(&from, &to, 16));
+  CHECK(Roi_PixelsMoved(&from, &to, 15));
+  to = from;
+  to.y0 = from.y0 - 17;
+  to.height = from.height + 17;
+  CHECK(Roi_PixelsMoved(&from, &to, 16));
+  to = from;
+  to.width = from.width + 17;
+  CHECK(Roi_PixelsMoved(&from, &to, 16));
+  to = from;
+  to.height = from.height - 17;
+  CHECK(Roi_PixelsMoved(&from, &to, 16));
+
+  /* Shifted within the band, or zooming in by twice the band around the centre */
+  to.x0 = from.x0 + 10;
+  to.y0 = from.y0 - 10;
+  to.width = from.width;
+  to.height = from.height;
+  CHECK(!Roi_PixelsMoved(&from, &to, 16));
+  to.x0 = from.x0 + 16;
+  to.y0 = from.y0 + 16;
+  to.width = from.width - 32;
+  to.height = from.height - 32;
+  CHECK(!Roi_PixelsMoved(&from, &to, 16));
+  CHECK(Roi_PixelsMoved(&from, &to, 15));
+}
+
+/*
+ * Closed loop: the keypoints are inferred on the crop of the region of the previous frame (those outside the crop
+ * are lost), mapped back to the full frame and fed to the tracker, while the person walks across the frame and away
+ * from the camera
+ */
+static void test_closed_loop(void)
+{
+  spe_pp_outBuffer_t truth[NB_KP], kp[NB_KP];
+  RoiTracker_t tracker;
+  Roi_Pixels_t px;
+  Roi_t captured = Roi_FullFrame;
+  int covered = 0, frames = 300;
+  float min_width = 1.0f;
+
+  RoiTracker_Init(&tracker, &params);
+  for (int f = 0; f < frames; f++)
+  {
+    float size = 0.5f - 0.4f * f / frames, x = 0.05f + 0.8f * f / frames;
+
+    person(truth, x, 0.3f, x + size / 2, 0.3f + size);
+    for (int i = 0; i < NB_KP; i++)
+    {
+      kp[i] = truth[i];
+      kp[i].x_center = (truth[i].x_center - captured.x0) / captured.width;
+      kp[i].y_center = (truth[i].y_center - captured.y0) / captured.height;
+      if (kp[i].x_center < 0.0f || kp[i].x_center > 1.0f || kp[i].y_center < 0.0f || kp[i].y_center > 1.0f)
+        kp[i].proba = 0.0f;
+    }
+    Roi_ToFullFrame(&captured, kp, NB_KP);
+
+    const Roi_t *roi = RoiTracker_Update(&tracker, kp, NB_KP);
+    Roi_ToPixels(roi, 1944, 1944, 192, 192, &px, &captured);
+    covered += covers(&captured, truth);
+    if (captured.width < min_width)
+      min_width = captured.width;
+  }
+  /* Tracked all along, zoomed in on the far person */
+  CHECK(covered >= frames - 2);
+  CHECK(min_width < 0.35f);
+  CHECK_EQ(tracker.missed, 0);
+}
+
+int main(void)
+{
+  test_edges();
+  test_aspect_ratio();
+  test_lost();
+  test_zoom();
+  test_inverse_map();
+  test_dead_band();
+  test_closed_loop();
+
+  return host_test_result("test_roi_tracker");
+}
@@ -0,0 +1,214 @@
+/**
+ ******************************************************************************
+ * @file    test_sched.c
+ * @brief   Cooperative multi-network scheduler of the ATON runtime on the
+ *          host simulation platform
+ ******************************************************************************
+ * Synthetic networks with disjoint memory pools are served together: the
+ * epoch blobs of the networks may never be in flight at the same time, the
+ * SW epoch blocks of one network run while the NPU works for another, and
+ * tasks complete by priority then earliest deadline. Registering a network
+ * whose pools overlap those of a registered one must fail its assertion,
+ * checked in a child process.
+ ******************************************************************************
+ */
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "sim_network.h"
+
+#define HI_SW_NS 100000
+#define LO_SW_NS 300000
+/* Scheduled inferences of both networks, the best one is compared: the host may preempt any of them */
+#define NB_RUNS  10
+
+static const EpochBlock_ItemTypeDef hi_ebs[] = {
+  SIM_NETWORK_SW_EB(HI_SW_NS),
+  SIM_NETWORK_BLOB_EB(0x34000000),
+  SIM_NETWORK_SW_EB(HI_SW_NS),
+  SIM_NETWORK_BLOB_EB(0x34001000),
+  SIM_NETWORK_LAST_EB,
+};
+static const EpochBlock_ItemTypeDef lo_ebs[] = {
+  SIM_NETWORK_SW_EB(LO_SW_NS),
+  SIM_NETWORK_BLOB_EB(0x34100000),
+  SIM_NETWORK_SW_EB(LO_SW_NS),
+  SIM_NETWORK_BLOB_EB(0x34101000),
+  SIM_NETWORK_LAST_EB,
+};
+
+/* Activation pools: Hi and Lo disjoint, Alias shares the last line of the pool of Hi. Parameters may be shared. */
+static const LL_Buffer_InfoTypeDef hi_pools[] = {
+  SIM_NETWORK_BUFFER("hi_act", 0x34200000, 0x34240000),
+  { .name = "weights", .addr_base = { .i = 0x70380000 }, .offset_end = 0x100000, .is_param = 1 },
+  SIM_NETWORK_LAST_BUFFER,
+};
+static const LL_Buffer_InfoTypeDef lo_pools[] = {
+  SIM_NETWORK_BUFFER("lo_act", 0x34240000, 0x34280000),
+  { .name = "weights", .addr_base = { .i = 0x70380000 }, .offset_end = 0x100000, .is_param = 1 },
+  SIM_NETWORK_LAST_BUFFER,
+};
+static const LL_Buffer_InfoTypeDef alias_pools[] = {
+  SIM_NETWORK_BUFFER("alias_act", 0x3423ffe0, 0x34240000),
+  SIM_NETWORK_LAST_BUFFER,
+};
+
+SIM_NETWORK_DECLARE(Hi, hi_ebs, hi_pools);
+SIM_NETWORK_DECLARE(Lo, lo_ebs, lo_pools);
+SIM_NETWORK_DECLARE(Alias, lo_ebs, alias_pools);
+
+/* Epoch blobs in flight, SW blocks of one network started while a blob of the other was */
+static int blobs_in_flight, max_blobs_in_flight;
+static const NN_Instance_TypeDef *blob_owner;
+static uint32_t interleaved_sw_blocks;
+
+static void epoch_trace(LL_ATON_RT_Callbacktype_t ctype, const NN_Instance_TypeDef *nn_instance,
+                        const EpochBlock_ItemTypeDef *eb)
+{
+  if (ctype == LL_ATON_RT_Callbacktype_PRE_START)
+  {
+    if (EpochBlock_IsEpochBlob(eb))
+    {
+      blob_owner = nn_instance;
+      if (++blobs_in_flight > max_blobs_in_flight)
+        max_blobs_in_flight = blobs_in_flight;
+    }
+    else if (blobs_in_flight > 0 && blob_owner != nn_instance)
+    {
+      interleaved_sw_blocks++;
+    }
+  }
+  else if (ctype == LL_ATON_RT_Callbacktype_POST_END && EpochBlock_IsEpochBlob(eb))
+  {
+    blobs_in_flight--;
+  }
+}
+
+static uint32_t alone_ns(NN_Instance_TypeDef *nn_instance)
+{
+  LL_ATON_RT_Resident_TypeDef resident;
+  uint32_t ns;
+
+  LL_ATON_RT_Resident_Init(&resident, nn_instance);
+  for (int i = 0; i < 3; i++)
+    LL_ATON_RT_Resident_Run(&resident);
+  ns = resident.stats.min_inference_ticks;
+  LL_ATON_RT_Resident_DeInit(&resident);
+  return ns;
+}
+
+static void test_interleave(int bench)
+{
+  uint32_t hi_alone = alone_ns(&NN_Instance_Hi), lo_alone = alone_ns(&NN_Instance_Lo);
+  uint32_t min_total = UINT32_MAX, min_hi_response = UINT32_MAX;
+  LL_ATON_RT_Sched_TypeDef sched;
+  LL_ATON_RT_SchedTask_TypeDef hi, lo;
+
+  LL_ATON_RT_SetEpochCallback(epoch_trace, &NN_Instance_Hi);
+  LL_ATON_RT_SetEpochCallback(epoch_trace, &NN_Instance_Lo);
+  LL_ATON_RT_Sched_Init(&sched);
+  /* Registered lowest priority first: the order of service must not depend on it */
+  LL_ATON_RT_Sched_AddTask(&sched, &lo, &NN_Instance_Lo, 1, 0);
+  LL_ATON_RT_Sched_AddTask(&sched, &hi, &NN_Instance_Hi, 2, 0);
+  CHECK_EQ(sched.nr_tasks, 2);
+
+  for (int n = 0; n < NB_RUNS; n++)
+  {
+    uint32_t t0 = host_sim_get_ts();
+
+    interleaved_sw_blocks = 0;
+    LL_ATON_RT_Sched_Release(&lo);
+    LL_ATON_RT_Sched_Release(&hi);
+    LL_ATON_RT_Sched_Run(&sched);
+    CHECK(!hi.released && !lo.released);
+    /* Higher priority completes first */
+    CHECK(hi.last_response_ticks < lo.last_response_ticks);
+    if (hi.last_response_ticks < min_hi_response)
+      min_hi_response = hi.last_response_ticks;
+    /* SW blocks of Lo run while the NPU works for Hi */
+    CHECK(interleaved_sw_blocks >= 1);
+    if (host_sim_get_ts() - t0 < min_total)
+      min_total = host_sim_get_ts() - t0;
+  }
+  /* Delayed at most by a SW block of Lo running when each of the two blobs of Hi ends */
+  CHECK(min_hi_response < hi_alone + 2 * LO_SW_NS);
+  CHECK_EQ(max_blobs_in_flight, 1);
+  CHECK_EQ(blobs_in_flight, 0);
+  CHECK_EQ(hi.resident.stats.nr_inferences, NB_RUNS);
+  CHECK_EQ(lo.resident.stats.nr_inferences, NB_RUNS);
+  CHECK_EQ(hi.nr_deadline_misses + lo.nr_deadline_misses, 0);
+  /* Serving both is shorter than one after the other */
+  CHECK(min_total + LO_SW_NS / 2 < hi_alone + lo_alone);
+  CHECK(sched.npu_busy_ticks > 0 && sched.npu_busy_ticks <= sched.elapsed_ticks);
+
+  if (bench)
+  {
+    printf("Hi %.0f us, Lo %.0f us alone: both %.0f us scheduled (%.0f us one after the other), NPU owned %.0f%%\n",
+           hi_alone / 1e3, lo_alone / 1e3, min_total / 1e3, (hi_alone + lo_alone) / 1e3,
+           100.0 * sched.npu_busy_ticks / sched.elapsed_ticks);
+    LL_ATON_RT_Sched_PrintStats(&sched);
+  }
+
+  /* Same priority: earliest absolute deadline first, whatever the registration and release order */
+  LL_ATON_RT_Sched_DeInit(&sched);
+  LL_ATON_RT_Sched_Init(&sched);
+  LL_ATON_RT_Sched_AddTask(&sched, &hi, &NN_Instance_Hi, 1, 100000000);
+  LL_ATON_RT_Sched_AddTask(&sched, &lo, &NN_Instance_Lo, 1, 50000000);
+  LL_ATON_RT_Sched_Release(&hi);
+  LL_ATON_RT_Sched_Release(&lo);
+  LL_ATON_RT_Sched_Run(&sched);
+  CHECK(lo.last_response_ticks < hi.last_response_ticks);
+
+  /* Deadline misses */
+  lo.deadline_ticks = 1000;
+  LL_ATON_RT_Sched_Release(&lo);
+  LL_ATON_RT_Sched_Run(&sched);
+  CHECK_EQ(lo.nr_deadline_misses, 1);
+  CHECK_EQ(hi.nr_deadline_misses, 0);
+  CHECK(lo.max_response_ticks >= lo.last_response_ticks);
+
+  /* Nothing pending */
+  CHECK_EQ(LL_ATON_RT_Sched_Step(&sched), LL_ATON_RT_DONE);
+  LL_ATON_RT_Sched_DeInit(&sched);
+  LL_ATON_RT_SetEpochCallback(NULL, &NN_Instance_Hi);
+  LL_ATON_RT_SetEpochCallback(NULL, &NN_Instance_Lo);
+}
+
+/* Registers Hi then `other` in a child process, returns its termination signal (0 if it exited normally) */
+static int register_pair(NN_Instance_TypeDef *other)
+{
+  int status;
+  pid_t pid = fork();
+
+  if (pid == 0)
+  {
+    LL_ATON_RT_Sched_TypeDef sched;
+    LL_ATON_RT_SchedTask_TypeDef a, b;
+
+    freopen("/dev/null", "w", stderr);
+    LL_ATON_RT_Sched_Init(&sched);
+    LL_ATON_RT_Sched_AddTask(&sched, &a, &NN_Instance_Hi, 1, 0);
+    LL_ATON_RT_Sched_AddTask(&sched, &b, other, 1, 0);
+    LL_ATON_RT_Sched_DeInit(&sched);
+    _exit(0);
+  }
+  waitpid(pid, &status, 0);
+  return WIFSIGNALED(status) ? WTERMSIG(status) : 0;
+}
+
+static void test_registration(void)
+{
+  CHECK_EQ(register_pair(&NN_Instance_Lo), 0);
+  CHECK_EQ(register_pair(&NN_Instance_Alias), SIGABRT);
+  /* The same instance twice */
+  CHECK_EQ(register_pair(&NN_Instance_Hi), SIGABRT);
+}
+
+int main(int argc, char **argv)
+{
+  test_registration();
+  test_interleave(host_test_bench(argc, argv));
+
+  return host_test_result("test_sched");
+}
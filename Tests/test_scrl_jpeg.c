@@ -0,0 +1,1082 @@
+/**
+ ******************************************************************************
+ * @file    test_scrl_jpeg.c
+ * @brief   MJPEG encoding of the UVC screen (scrl_jpeg.c)
+ ******************************************************************************
+ * The MCU conversion must lay out the frame as the JPEG codec reads it. A
+ * baseline encoder, host model of the codec with its tables and quality
+ * scaling, encodes synthetic 320x240 frames at several qualities: each frame
+ * is decoded by the baseline decoder of this file, written from ISO/IEC
+ * 10918-1 independently of the encoder, and must reach a PSNR threshold against the encoder input and
+ * against the RGB565 frame, with the size and the PSNR growing with the
+ * quality. An encoding larger than its buffer fails without writing past it.
+ * The bitrate control replays a moving scene with the buffers of the screen
+ * library and must bring the frame size near bitrate / 8 / fps, drop the
+ * quality on noisy frames that do not fit and raise it again afterwards.
+ * The benchmark reports the throughput of the conversion and the encoding.
+ ******************************************************************************
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include "host_test.h"
+#include "scrl_jpeg.h"
+#include "scrl_yuv.h"
+
+#define WIDTH       320
+#define HEIGHT      240
+#define FPS         30
+#define MCU_SIZE    (WIDTH * HEIGHT * 2)
+#define JPEG_SIZE   (WIDTH * HEIGHT)
+#define GUARD       0xA5
+#define NB_GUARDS   64
+
+enum {
+  FRAME_GRADIENT,
+  FRAME_SCENE,
+  FRAME_NOISE,
+};
+
+static uint16_t frame[WIDTH * HEIGHT];
+static uint8_t mcu[MCU_SIZE];
+static uint8_t jpeg[JPEG_SIZE * 4 + NB_GUARDS];
+
+/* Decoded planes, chroma at half width */
+static uint8_t dec_y[WIDTH * HEIGHT];
+static uint8_t dec_cb[WIDTH / 2 * HEIGHT];
+static uint8_t dec_cr[WIDTH / 2 * HEIGHT];
+
+static uint32_t rng_state = 0x2545F491;
+
+static uint32_t rng(uint32_t n)
+{
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return rng_state % n;
+}
+
+static uint16_t rgb565(int r, int g, int b)
+{
+  return (uint16_t) ((r >> 3) << 11 | (g >> 2) << 5 | (b >> 3));
+}
+
+/* Camera-like background with the overlay drawn on it, at frame `t` */
+static void make_frame(int type, int t)
+{
+  for (int y = 0; y < HEIGHT; y++)
+  {
+    for (int x = 0; x < WIDTH; x++)
+    {
+      uint16_t *p = &frame[y * WIDTH + x];
+
+      if (type == FRAME_NOISE)
+        *p = (uint16_t) rng(65536);
+      else if (type == FRAME_GRADIENT)
+        *p = rgb565(x * 255 / (WIDTH - 1), y * 255 / (HEIGHT - 1), (x + y) * 255 / (WIDTH + HEIGHT - 2));
+      else
+      {
+        /* Soft shapes moving across, a little sensor noise */
+        int dx = x - (40 + 4 * t) % WIDTH, dy = y - 120;
+        int v = 96 + (int) (64 * sinf(x * 0.05f + t * 0.1f) * cosf(y * 0.04f)) + (int) rng(9) - 4;
+        int blob = dx * dx + dy * dy < 50 * 50;
+
+        *p = rgb565(blob ? 220 : v, blob ? 180 : v + 20, blob ? 150 : 160 - v / 2);
+      }
+    }
+  }
+  if (type != FRAME_SCENE)
+    return;
+
+  /* Overlay: skeleton lines, keypoints and a text box with sharp edges */
+  for (int i = 0; i < 200; i++)
+  {
+    int x = 60 + 4 * t % 100 + i / 2, y = 40 + i;
+
+    if (y < HEIGHT && x < WIDTH - 1)
+      frame[y * WIDTH + x] = frame[y * WIDTH + x + 1] = rgb565(0, 255, 0);
+  }
+  for (int k = 0; k < 12; k++)
+  {
+    int cx = 30 + (k * 53 + 2 * t) % (WIDTH - 60), cy = 30 + (k * 37) % (HEIGHT - 60);
+
+    for (int y = cy - 3; y <= cy + 3; y++)
+      for (int x = cx - 3; x <= cx + 3; x++)
+        frame[y * WIDTH + x] = rgb565(255, 0, 0);
+  }
+  for (int y = 4; y < 20; y++)
+    for (int x = 4; x < 124; x++)
+      frame[y * WIDTH + x] = ((x / 3 + y / 4) % 3) ? rgb565(255, 255, 255) : rgb565(0, 0, 0);
+}
+
+/* Baseline decoder of ISO/IEC 10918-1, for the streams of the encoder: one frame, no restart interval */
+struct huff {
+  int is_set;
+  uint8_t vals[256];
+  int mincode[17];
+  int maxcode[18];
+  int valptr[17];
+};
+
+struct decoder {
+  const uint8_t *p;
+  const uint8_t *end;
+  uint8_t quant[4][64];
+  struct huff huff[2][4];
+  int width;
+  int height;
+  int nb_comps;
+  int comp_h[3];
+  int comp_v[3];
+  int comp_tq[3];
+  int comp_td[3];
+  int comp_ta[3];
+  uint32_t bits;
+  int nb_bits;
+  int is_error;
+};
+
+static const int zigzag[64] = {
+   0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+  12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+  35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+  58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63
+};
+
+static int get_u8(struct decoder *d)
+{
+  if (d->p >= d->end)
+  {
+    d->is_error = 1;
+    return 0;
+  }
+  return *d->p++;
+}
+
+static int get_u16(struct decoder *d)
+{
+  int v = get_u8(d) << 8;
+
+  return v | get_u8(d);
+}
+
+/* Annex C code sizes and Annex F.2.2.3 decoding tables */
+static void parse_dht(struct decoder *d, int len)
+{
+  const uint8_t *seg_end = d->p + len;
+
+  while (d->p < seg_end && !d->is_error)
+  {
+    int tc_th = get_u8(d), tc = tc_th >> 4, th = tc_th & 15;
+    struct huff *h;
+    uint8_t bits[17];
+    int nb = 0, code = 0, k = 0;
+
+    if (tc > 1 || th > 3)
+    {
+      d->is_error = 1;
+      return;
+    }
+    h = &d->huff[tc][th];
+    for (int l = 1; l <= 16; l++)
+      nb += bits[l] = get_u8(d);
+    if (nb > 256)
+    {
+      d->is_error = 1;
+      return;
+    }
+    for (int i = 0; i < nb; i++)
+      h->vals[i] = get_u8(d);
+    for (int l = 1; l <= 16; l++)
+    {
+      if (bits[l])
+      {
+        h->valptr[l] = k;
+        h->mincode[l] = code;
+        code += bits[l];
+        k += bits[l];
+        h->maxcode[l] = code - 1;
+      }
+      else
+        h->maxcode[l] = -1;
+      code <<= 1;
+    }
+    h->maxcode[17] = 0x7fffffff;
+    h->is_set = 1;
+  }
+  if (d->p != seg_end)
+    d->is_error = 1;
+}
+
+static void parse_dqt(struct decoder *d, int len)
+{
+  const uint8_t *seg_end = d->p + len;
+
+  while (d->p < seg_end && !d->is_error)
+  {
+    int pq_tq = get_u8(d);
+
+    if (pq_tq > 3)
+    {
+      d->is_error = 1;
+      return;
+    }
+    for (int i = 0; i < 64; i++)
+      d->quant[pq_tq][zigzag[i]] = get_u8(d);
+  }
+  if (d->p != seg_end)
+    d->is_error = 1;
+}
+
+static void parse_sof0(struct decoder *d)
+{
+  if (get_u8(d) != 8)
+    d->is_error = 1;
+  d->height = get_u16(d);
+  d->width = get_u16(d);
+  d->nb_comps = get_u8(d);
+  if (d->nb_comps != 3)
+  {
+    d->is_error = 1;
+    return;
+  }
+  for (int c = 0; c < 3; c++)
+  {
+    int hv;
+
+    if (get_u8(d) != c + 1)
+      d->is_error = 1;
+    hv = get_u8(d);
+    d->comp_h[c] = hv >> 4;
+    d->comp_v[c] = hv & 15;
+    d->comp_tq[c] = get_u8(d);
+    if (d->comp_tq[c] > 3)
+      d->is_error = 1;
+  }
+}
+
+static void parse_sos(struct decoder *d)
+{
+  if (get_u8(d) != 3)
+    d->is_error = 1;
+  for (int c = 0; c < 3; c++)
+  {
+    int t;
+
+    if (get_u8(d) != c + 1)
+      d->is_error = 1;
+    t = get_u8(d);
+    d->comp_td[c] = t >> 4;
+    d->comp_ta[c] = t & 15;
+    if (d->comp_td[c] > 3 || d->comp_ta[c] > 3)
+      d->is_error = 1;
+  }
+  /* Sequential: whole spectrum, no successive approximation */
+  if (get_u8(d) != 0 || get_u8(d) != 63 || get_u8(d) != 0)
+    d->is_error = 1;
+}
+
+/* Entropy coded data, stuffed 0x00 after 0xff removed, 1 bits past a marker */
+static int get_bit(struct decoder *d)
+{
+  if (!d->nb_bits)
+  {
+    int b = 0xff;
+
+    if (d->p < d->end && (d->p[0] != 0xff || (d->p + 1 < d->end && d->p[1] == 0x00)))
+    {
+      b = *d->p++;
+      if (b == 0xff)
+        d->p++;
+    }
+    else
+      d->is_error = 1;
+    d->bits = b;
+    d->nb_bits = 8;
+  }
+  d->nb_bits--;
+  return (d->bits >> d->nb_bits) & 1;
+}
+
+static int receive(struct decoder *d, int n)
+{
+  int v = 0;
+
+  while (n--)
+    v = (v << 1) | get_bit(d);
+  return v;
+}
+
+/* F.2.2.1 */
+static int extend(int v, int n)
+{
+  return n && v < (1 << (n - 1)) ? v - (1 << n) + 1 : v;
+}
+
+static int decode_symbol(struct decoder *d, const struct huff *h)
+{
+  int code = get_bit(d);
+  int l = 1;
+
+  while (code > h->maxcode[l])
+  {
+    code = (code << 1) | get_bit(d);
+    if (++l > 16)
+    {
+      d->is_error = 1;
+      return 0;
+    }
+  }
+  return h->vals[h->valptr[l] + code - h->mincode[l]];
+}
+
+/* Block of component c into p_dst, rows of `stride` bytes */
+static void decode_block(struct decoder *d, int c, int *dc_pred, uint8_t *p_dst, int stride)
+{
+  const struct huff *dc = &d->huff[0][d->comp_td[c]];
+  const struct huff *ac = &d->huff[1][d->comp_ta[c]];
+  const uint8_t *q = d->quant[d->comp_tq[c]];
+  double coef[64] = { 0 };
+  int t, k;
+
+  t = decode_symbol(d, dc);
+  *dc_pred += extend(receive(d, t), t);
+  coef[0] = *dc_pred * q[0];
+  for (k = 1; k < 64 && !d->is_error;)
+  {
+    int rs = decode_symbol(d, ac), r = rs >> 4, s = rs & 15;
+
+    if (!s)
+    {
+      if (r != 15)
+        break;
+      k += 16;
+      continue;
+    }
+    k += r;
+    if (k > 63)
+    {
+      d->is_error = 1;
+      break;
+    }
+    coef[zigzag[k]] = extend(receive(d, s), s) * q[zigzag[k]];
+    k++;
+  }
+
+  /* A.3.3 inverse DCT */
+  for (int y = 0; y < 8; y++)
+  {
+    for (int x = 0; x < 8; x++)
+    {
+      double s = 0;
+
+      for (int v = 0; v < 8; v++)
+        for (int u = 0; u < 8; u++)
+          s += (u ? 1 : M_SQRT1_2) * (v ? 1 : M_SQRT1_2) * coef[v * 8 + u] *
+               cos((2 * x + 1) * u * M_PI / 16) * cos((2 * y + 1) * v * M_PI / 16);
+      s = round(s / 4 + 128);
+      p_dst[y * stride + x] = s < 0 ? 0 : s > 255 ? 255 : (uint8_t) s;
+    }
+  }
+}
+
+/* Returns 0 when the stream decodes into dec_y, dec_cb and dec_cr as a 4:2:2 frame of WIDTH x HEIGHT */
+static int decode(const uint8_t *p_jpeg, int size)
+{
+  struct decoder d = { .p = p_jpeg, .end = p_jpeg + size };
+  int is_sof = 0;
+
+  if (get_u16(&d) != 0xffd8)
+    return -1;
+
+  for (;;)
+  {
+    int marker = get_u16(&d), len = get_u16(&d) - 2;
+
+    if (d.is_error || len < 0 || d.p + len > d.end)
+      return -1;
+    if (marker == 0xffdb)
+      parse_dqt(&d, len);
+    else if (marker == 0xffc4)
+      parse_dht(&d, len);
+    else if (marker == 0xffc0)
+    {
+      parse_sof0(&d);
+      is_sof = 1;
+    }
+    else if (marker == 0xffda)
+    {
+      parse_sos(&d);
+      break;
+    }
+    else
+      return -1;
+    if (d.is_error)
+      return -1;
+  }
+  if (d.is_error || !is_sof || d.width != WIDTH || d.height != HEIGHT)
+    return -1;
+  if (d.comp_h[0] != 2 || d.comp_v[0] != 1 || d.comp_h[1] != 1 || d.comp_v[1] != 1 || d.comp_h[2] != 1 ||
+      d.comp_v[2] != 1)
+    return -1;
+  for (int c = 0; c < 3; c++)
+    if (!d.huff[0][d.comp_td[c]].is_set || !d.huff[1][d.comp_ta[c]].is_set)
+      return -1;
+
+  int dc_pred[3] = { 0 };
+
+  for (int my = 0; my < HEIGHT / 8 && !d.is_error; my++)
+  {
+    for (int mx = 0; mx < WIDTH / 16 && !d.is_error; mx++)
+    {
+      decode_block(&d, 0, &dc_pred[0], &dec_y[my * 8 * WIDTH + mx * 16], WIDTH);
+      decode_block(&d, 0, &dc_pred[0], &dec_y[my * 8 * WIDTH + mx * 16 + 8], WIDTH);
+      decode_block(&d, 1, &dc_pred[1], &dec_cb[my * 8 * WIDTH / 2 + mx * 8], WIDTH / 2);
+      decode_block(&d, 2, &dc_pred[2], &dec_cr[my * 8 * WIDTH / 2 + mx * 8], WIDTH / 2);
+    }
+  }
+  /* Padding bits are 1s, then EOI ends the stream */
+  while (d.nb_bits)
+    if (!get_bit(&d))
+      return -1;
+  if (d.is_error || d.end - d.p != 2 || d.p[0] != 0xff || d.p[1] != 0xd9)
+    return -1;
+
+  return 0;
+}
+
+/*
+ * Host model of the JPEG codec: baseline encoder with the tables and the quality scaling the codec uses once
+ * initialized by HAL_JPEG_Init(), the headers as written by its header generation
+ */
+/* Sample tables of ISO/IEC 10918-1 Annex K, the ones HAL_JPEG_Init() loads into the codec */
+static const uint8_t lum_quant[64] = {
+  16,  11,  10,  16,  24,  40,  51,  61,
+  12,  12,  14,  19,  26,  58,  60,  55,
+  14,  13,  16,  24,  40,  57,  69,  56,
+  14,  17,  22,  29,  51,  87,  80,  62,
+  18,  22,  37,  56,  68, 109, 103,  77,
+  24,  35,  55,  64,  81, 104, 113,  92,
+  49,  64,  78,  87, 103, 121, 120, 101,
+  72,  92,  95,  98, 112, 100, 103,  99
+};
+
+static const uint8_t chrom_quant[64] = {
+  17,  18,  24,  47,  99,  99,  99,  99,
+  18,  21,  26,  66,  99,  99,  99,  99,
+  24,  26,  56,  99,  99,  99,  99,  99,
+  47,  66,  99,  99,  99,  99,  99,  99,
+  99,  99,  99,  99,  99,  99,  99,  99,
+  99,  99,  99,  99,  99,  99,  99,  99,
+  99,  99,  99,  99,  99,  99,  99,  99,
+  99,  99,  99,  99,  99,  99,  99,  99
+};
+
+static const uint8_t dc_lum_bits[16] = { 0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0 };
+static const uint8_t dc_chrom_bits[16] = { 0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0 };
+static const uint8_t dc_vals[12] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0xa, 0xb };
+
+static const uint8_t ac_lum_bits[16] = { 0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d };
+static const uint8_t ac_lum_vals[162] = {
+  0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12,
+  0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+  0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08,
+  0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+  0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16,
+  0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+  0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39,
+  0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+  0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59,
+  0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+  0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79,
+  0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+  0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98,
+  0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+  0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6,
+  0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+  0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4,
+  0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+  0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea,
+  0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+  0xf9, 0xfa
+};
+
+static const uint8_t ac_chrom_bits[16] = { 0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77 };
+static const uint8_t ac_chrom_vals[162] = {
+  0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21,
+  0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+  0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91,
+  0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+  0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34,
+  0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+  0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38,
+  0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+  0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58,
+  0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+  0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78,
+  0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+  0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96,
+  0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+  0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4,
+  0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+  0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2,
+  0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+  0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9,
+  0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+  0xf9, 0xfa
+};
+
+/* Code and length of each symbol */
+struct codes {
+  uint16_t code[256];
+  uint8_t size[256];
+};
+
+struct writer {
+  uint8_t *p;
+  uint8_t *end;
+  uint32_t bits;
+  int nb_bits;
+  int is_overflow;
+};
+
+struct encoder_tables {
+  int is_init;
+  /* cos[u * 8 + x]: DCT basis with its scale factor */
+  float cos[64];
+  struct codes dc[2];
+  struct codes ac[2];
+};
+
+static struct encoder_tables encoder_tables;
+
+/* Canonical codes of ISO/IEC 10918-1 Annex C */
+static void init_codes(struct codes *codes, const uint8_t *bits, const uint8_t *vals)
+{
+  int code = 0;
+  int k = 0;
+  int l, i;
+
+  for (l = 1; l <= 16; l++)
+  {
+    for (i = 0; i < bits[l - 1]; i++, k++)
+    {
+      codes->code[vals[k]] = code++;
+      codes->size[vals[k]] = l;
+    }
+    code <<= 1;
+  }
+}
+
+static void init_encoder_tables(void)
+{
+  int u, x;
+
+  for (u = 0; u < 8; u++)
+    for (x = 0; x < 8; x++)
+      encoder_tables.cos[u * 8 + x] = (u ? 0.5f : 0.5f / sqrtf(2.0f)) * cosf((2 * x + 1) * u * (float) M_PI / 16);
+
+  init_codes(&encoder_tables.dc[0], dc_lum_bits, dc_vals);
+  init_codes(&encoder_tables.dc[1], dc_chrom_bits, dc_vals);
+  init_codes(&encoder_tables.ac[0], ac_lum_bits, ac_lum_vals);
+  init_codes(&encoder_tables.ac[1], ac_chrom_bits, ac_chrom_vals);
+  encoder_tables.is_init = 1;
+}
+
+/* Same scaling as HAL_JPEG_ConfigEncoding() */
+static void scale_quant(const uint8_t *std, int quality, uint8_t *quant)
+{
+  int scale = quality >= 50 ? 200 - quality * 2 : 5000 / quality;
+  int i, v;
+
+  for (i = 0; i < 64; i++)
+  {
+    v = (std[i] * scale + 50) / 100;
+    quant[i] = v < 1 ? 1 : (v > 255 ? 255 : v);
+  }
+}
+
+static void put_u8(struct writer *w, uint8_t b)
+{
+  if (w->p == w->end)
+  {
+    w->is_overflow = 1;
+    return;
+  }
+  *w->p++ = b;
+}
+
+static void put_u16(struct writer *w, int v)
+{
+  put_u8(w, v >> 8);
+  put_u8(w, v);
+}
+
+/* Entropy coded data, a 0xff byte followed by a stuffed 0x00 */
+static void put_bits(struct writer *w, uint32_t code, int size)
+{
+  uint8_t b;
+
+  w->bits = (w->bits << size) | (code & ((1U << size) - 1));
+  w->nb_bits += size;
+  while (w->nb_bits >= 8)
+  {
+    b = w->bits >> (w->nb_bits - 8);
+    put_u8(w, b);
+    if (b == 0xff)
+      put_u8(w, 0);
+    w->nb_bits -= 8;
+  }
+}
+
+/* Last byte padded with 1 bits */
+static void flush_bits(struct writer *w)
+{
+  if (w->nb_bits)
+    put_bits(w, 0x7f, 8 - w->nb_bits);
+}
+
+/* Huffman code of the size category of v, then the v bits */
+static void put_value(struct writer *w, const struct codes *codes, int run, int v)
+{
+  int a = v < 0 ? -v : v;
+  int category = 0;
+
+  while (a)
+  {
+    category++;
+    a >>= 1;
+  }
+  put_bits(w, codes->code[run << 4 | category], codes->size[run << 4 | category]);
+  if (category)
+    put_bits(w, v < 0 ? v - 1 : v, category);
+}
+
+static void fdct(const uint8_t *p_block, float *coef)
+{
+  const float *c = encoder_tables.cos;
+  float tmp[64];
+  float s;
+  int u, x, y;
+
+  /* Rows, then columns */
+  for (y = 0; y < 8; y++)
+  {
+    for (u = 0; u < 8; u++)
+    {
+      s = 0;
+      for (x = 0; x < 8; x++)
+        s += c[u * 8 + x] * (p_block[y * 8 + x] - 128);
+      tmp[y * 8 + u] = s;
+    }
+  }
+  for (x = 0; x < 8; x++)
+  {
+    for (u = 0; u < 8; u++)
+    {
+      s = 0;
+      for (y = 0; y < 8; y++)
+        s += c[u * 8 + y] * tmp[y * 8 + x];
+      coef[u * 8 + x] = s;
+    }
+  }
+}
+
+static void encode_block(struct writer *w, const uint8_t *p_block, const uint8_t *quant, int *dc_pred,
+                              const struct codes *dc, const struct codes *ac)
+{
+  float coef[64];
+  int v[64];
+  int run = 0;
+  int i;
+
+  fdct(p_block, coef);
+  for (i = 0; i < 64; i++)
+    v[i] = (int) lroundf(coef[zigzag[i]] / quant[zigzag[i]]);
+
+  put_value(w, dc, 0, v[0] - *dc_pred);
+  *dc_pred = v[0];
+
+  for (i = 1; i < 64; i++)
+  {
+    if (!v[i])
+    {
+      run++;
+      continue;
+    }
+    /* Runs of 16 zeros */
+    for (; run > 15; run -= 16)
+      put_bits(w, ac->code[0xf0], ac->size[0xf0]);
+    put_value(w, ac, run, v[i]);
+    run = 0;
+  }
+  /* End of block */
+  if (run)
+    put_bits(w, ac->code[0x00], ac->size[0x00]);
+}
+
+static void put_dht(struct writer *w, int class_id, const uint8_t *bits, const uint8_t *vals, int nb_vals)
+{
+  int i;
+
+  put_u8(w, class_id);
+  for (i = 0; i < 16; i++)
+    put_u8(w, bits[i]);
+  for (i = 0; i < nb_vals; i++)
+    put_u8(w, vals[i]);
+}
+
+/* SOI, DQT, SOF0, DHT and SOS as written by the codec header generation */
+static void put_headers(struct writer *w, const uint8_t quant[2][64], int width, int height)
+{
+  int i, t;
+
+  put_u16(w, 0xffd8);
+
+  put_u16(w, 0xffdb);
+  put_u16(w, 2 + 2 * 65);
+  for (t = 0; t < 2; t++)
+  {
+    put_u8(w, t);
+    for (i = 0; i < 64; i++)
+      put_u8(w, quant[t][zigzag[i]]);
+  }
+
+  /* Y at 2x1, Cb and Cr at 1x1 */
+  put_u16(w, 0xffc0);
+  put_u16(w, 17);
+  put_u8(w, 8);
+  put_u16(w, height);
+  put_u16(w, width);
+  put_u8(w, 3);
+  for (i = 1; i <= 3; i++)
+  {
+    put_u8(w, i);
+    put_u8(w, i == 1 ? 0x21 : 0x11);
+    put_u8(w, i == 1 ? 0 : 1);
+  }
+
+  put_u16(w, 0xffc4);
+  put_u16(w, 2 + 4 * 17 + 2 * 12 + 2 * 162);
+  put_dht(w, 0x00, dc_lum_bits, dc_vals, 12);
+  put_dht(w, 0x10, ac_lum_bits, ac_lum_vals, 162);
+  put_dht(w, 0x01, dc_chrom_bits, dc_vals, 12);
+  put_dht(w, 0x11, ac_chrom_bits, ac_chrom_vals, 162);
+
+  put_u16(w, 0xffda);
+  put_u16(w, 12);
+  put_u8(w, 3);
+  for (i = 1; i <= 3; i++)
+  {
+    put_u8(w, i);
+    put_u8(w, i == 1 ? 0x00 : 0x11);
+  }
+  put_u8(w, 0);
+  put_u8(w, 63);
+  put_u8(w, 0);
+}
+
+/* Encodes the MCUs of SCRJ_Cvt_Rgb565_To_Mcu(), returns the size of the JPEG frame or -1 if it does not fit */
+static int codec_encode(const uint8_t *p_mcu, int width, int height, int quality, uint8_t *p_dst, int dst_size)
+{
+  struct writer w = { p_dst, p_dst + dst_size, 0, 0, 0 };
+  int nb_mcus = (width / SCRJ_MCU_WIDTH) * (height / SCRJ_MCU_HEIGHT);
+  uint8_t quant[2][64];
+  int dc_pred[3] = { 0 };
+  int m, b, c;
+
+  if (!encoder_tables.is_init)
+    init_encoder_tables();
+
+  scale_quant(lum_quant, quality, quant[0]);
+  scale_quant(chrom_quant, quality, quant[1]);
+  put_headers(&w, quant, width, height);
+
+  /* Y0 Y1 Cb Cr */
+  for (m = 0; m < nb_mcus && !w.is_overflow; m++)
+  {
+    for (b = 0; b < 4; b++)
+    {
+      c = b < 2 ? 0 : b - 1;
+      encode_block(&w, p_mcu + b * 64, quant[c != 0], &dc_pred[c], &encoder_tables.dc[c != 0],
+                   &encoder_tables.ac[c != 0]);
+    }
+    p_mcu += SCRJ_MCU_SIZE;
+  }
+  flush_bits(&w);
+  put_u16(&w, 0xffd9);
+
+  return w.is_overflow ? -1 : w.p - p_dst;
+}
+
+static double psnr(double sse, int nb)
+{
+  return sse ? 10 * log10(255.0 * 255.0 * nb / sse) : 99;
+}
+
+/* Decoded planes against the MCUs encoded */
+static double psnr_ycbcr(void)
+{
+  double sse = 0;
+
+  for (int y = 0; y < HEIGHT; y++)
+  {
+    for (int x = 0; x < WIDTH; x++)
+    {
+      const uint8_t *p = &mcu[((y / 8) * (WIDTH / 16) + x / 16) * SCRJ_MCU_SIZE];
+      int d = p[(x % 16 / 8) * 64 + (y % 8) * 8 + x % 8] - dec_y[y * WIDTH + x];
+
+      sse += d * d;
+      if (x % 2)
+        continue;
+      d = p[128 + (y % 8) * 8 + x % 16 / 2] - dec_cb[y * WIDTH / 2 + x / 2];
+      sse += d * d;
+      d = p[192 + (y % 8) * 8 + x % 16 / 2] - dec_cr[y * WIDTH / 2 + x / 2];
+      sse += d * d;
+    }
+  }
+  return psnr(sse, WIDTH * HEIGHT * 2);
+}
+
+/* JFIF conversion of the decoded planes against the RGB565 frame, each component scaled to 8 bits */
+static double psnr_rgb(void)
+{
+  double sse = 0;
+
+  for (int i = 0; i < WIDTH * HEIGHT; i++)
+  {
+    double l = dec_y[i], cb = dec_cb[i / 2] - 128.0, cr = dec_cr[i / 2] - 128.0;
+    double rgb[3] = { l + 1.402 * cr, l - 0.344136 * cb - 0.714136 * cr, l + 1.772 * cb };
+    int src[3] = { frame[i] >> 11, frame[i] >> 5 & 0x3f, frame[i] & 0x1f };
+
+    src[0] = src[0] << 3 | src[0] >> 2;
+    src[1] = src[1] << 2 | src[1] >> 4;
+    src[2] = src[2] << 3 | src[2] >> 2;
+    for (int c = 0; c < 3; c++)
+    {
+      double v = rgb[c] < 0 ? 0 : rgb[c] > 255 ? 255 : round(rgb[c]);
+
+      sse += (v - src[c]) * (v - src[c]);
+    }
+  }
+  return psnr(sse, WIDTH * HEIGHT * 3);
+}
+
+static void test_mcu_layout(void)
+{
+  uint8_t row[WIDTH * 2];
+  int failures = 0;
+
+  make_frame(FRAME_NOISE, 0);
+  SCRJ_Cvt_Rgb565_To_Mcu(mcu, (uint8_t *) frame, WIDTH * 2, WIDTH, HEIGHT);
+  for (int y = 0; y < HEIGHT; y++)
+  {
+    SCRY_Cvt_Rgb565_To_Yuv422_Row(row, (uint8_t *) &frame[y * WIDTH], WIDTH);
+    for (int x = 0; x < WIDTH; x++)
+    {
+      const uint8_t *p = &mcu[((y / 8) * (WIDTH / 16) + x / 16) * SCRJ_MCU_SIZE];
+
+      failures += p[(x % 16 / 8) * 64 + (y % 8) * 8 + x % 8] != row[2 * x];
+      if (x % 2)
+        continue;
+      failures += p[128 + (y % 8) * 8 + x % 16 / 2] != row[2 * x + 1];
+      failures += p[192 + (y % 8) * 8 + x % 16 / 2] != row[2 * x + 3];
+    }
+  }
+  CHECK_EQ(failures, 0);
+}
+
+/* Encodes the frame, returns the size or -1, checking the guard bytes past dst_size */
+static int encode(int quality, int dst_size)
+{
+  int size;
+
+  memset(jpeg, GUARD, dst_size + NB_GUARDS);
+  size = codec_encode(mcu, WIDTH, HEIGHT, quality, jpeg, dst_size);
+  for (int i = dst_size; i < dst_size + NB_GUARDS; i++)
+    CHECK_EQ(jpeg[i], GUARD);
+  CHECK(size <= dst_size);
+
+  return size;
+}
+
+static void test_quality(int type, double min_psnr_ycbcr, double min_psnr_rgb)
+{
+  static const int qualities[] = { 10, 25, 50, 75, 90 };
+  double last_psnr = 0;
+  int last_size = 0;
+
+  make_frame(type, 0);
+  SCRJ_Cvt_Rgb565_To_Mcu(mcu, (uint8_t *) frame, WIDTH * 2, WIDTH, HEIGHT);
+  for (size_t i = 0; i < sizeof(qualities) / sizeof(qualities[0]); i++)
+  {
+    int size = encode(qualities[i], sizeof(jpeg) - NB_GUARDS);
+    double p;
+
+    CHECK(size > 0);
+    CHECK_EQ(decode(jpeg, size), 0);
+    p = psnr_ycbcr();
+    CHECK(p > last_psnr);
+    CHECK(size > last_size);
+    last_psnr = p;
+    last_size = size;
+    if (qualities[i] >= 50)
+    {
+      CHECK(p >= min_psnr_ycbcr);
+      CHECK(psnr_rgb() >= min_psnr_rgb);
+    }
+  }
+}
+
+static void test_overflow(void)
+{
+  int size;
+
+  make_frame(FRAME_NOISE, 0);
+  SCRJ_Cvt_Rgb565_To_Mcu(mcu, (uint8_t *) frame, WIDTH * 2, WIDTH, HEIGHT);
+  size = encode(90, sizeof(jpeg) - NB_GUARDS);
+  CHECK(size > JPEG_SIZE);
+
+  /* In the headers, in the entropy coded data and on the last bytes */
+  CHECK_EQ(encode(90, 100), -1);
+  CHECK_EQ(encode(90, JPEG_SIZE), -1);
+  CHECK_EQ(encode(90, size - 1), -1);
+  CHECK_EQ(encode(90, size), size);
+  CHECK_EQ(decode(jpeg, size), 0);
+}
+
+static void test_adapt_quality(void)
+{
+  /* Fixed quality: kept while the frames fit, lowered when one does not */
+  CHECK_EQ(SCRJ_Adapt_Quality(75, 100000, 0, 0), 75);
+  CHECK_EQ(SCRJ_Adapt_Quality(95, 10, 0, 0), 95);
+  CHECK(SCRJ_Adapt_Quality(75, 0, 0, 1) < 75);
+  CHECK(SCRJ_Adapt_Quality(100, 0, 0, 1) <= SCRJ_QUALITY_MAX);
+  CHECK_EQ(SCRJ_Adapt_Quality(SCRJ_QUALITY_MIN, 0, 0, 1), SCRJ_QUALITY_MIN);
+  CHECK_EQ(SCRJ_Adapt_Quality(5, 0, 0, 1), 5);
+  /* Bitrate control */
+  CHECK_EQ(SCRJ_Adapt_Quality(75, 1000, 1000, 0), 75);
+  CHECK(SCRJ_Adapt_Quality(75, 1500, 1000, 0) < 75);
+  CHECK(SCRJ_Adapt_Quality(75, 500, 1000, 0) > 75);
+  CHECK(SCRJ_Adapt_Quality(75, 0, 1000, 1) < SCRJ_Adapt_Quality(75, 2500, 1000, 0));
+  CHECK_EQ(SCRJ_Adapt_Quality(SCRJ_QUALITY_MIN, 0, 1000, 1), SCRJ_QUALITY_MIN);
+  CHECK_EQ(SCRJ_Adapt_Quality(SCRJ_QUALITY_MAX, 10, 1000, 0), SCRJ_QUALITY_MAX);
+}
+
+/* Frames of `type` through the encoding and the bitrate control of scrl_usb.c, returns the mean size of the last
+ * `nb_last` frames, 0 counted for the ones that did not fit
+ */
+static int run_bitrate(int type, int nb_frames, int nb_last, uint32_t target, uint32_t *quality, int *nb_overflows)
+{
+  int64_t total = 0;
+
+  for (int f = 0; f < nb_frames; f++)
+  {
+    int size;
+
+    make_frame(type, f);
+    SCRJ_Cvt_Rgb565_To_Mcu(mcu, (uint8_t *) frame, WIDTH * 2, WIDTH, HEIGHT);
+    size = encode(*quality, JPEG_SIZE);
+    *quality = SCRJ_Adapt_Quality(*quality, size < 0 ? 0 : size, target, size < 0);
+    *nb_overflows += size < 0;
+    if (f >= nb_frames - nb_last && size > 0)
+      total += size;
+  }
+  return (int) (total / nb_last);
+}
+
+static void test_bitrate(uint32_t bitrate)
+{
+  uint32_t target = bitrate / 8 / FPS;
+  uint32_t quality = 75;
+  int nb_overflows = 0;
+  int mean;
+
+  /* Settles on the scene */
+  mean = run_bitrate(FRAME_SCENE, 60, 20, target, &quality, &nb_overflows);
+  CHECK(mean > target * 3 / 4 && mean < target * 5 / 4);
+  CHECK_EQ(nb_overflows, 0);
+
+  /* Noise does not fit at first, the quality drops until it does */
+  quality = SCRJ_QUALITY_MAX;
+  mean = run_bitrate(FRAME_NOISE, 30, 10, target, &quality, &nb_overflows);
+  CHECK(nb_overflows > 0);
+  CHECK(mean > 0);
+  CHECK(quality < 40);
+
+  /* Back on the scene, the quality goes up again */
+  nb_overflows = 0;
+  mean = run_bitrate(FRAME_SCENE, 60, 20, target, &quality, &nb_overflows);
+  CHECK(mean > target * 3 / 4 && mean < target * 5 / 4);
+  CHECK(quality > 40);
+  CHECK_EQ(nb_overflows, 0);
+}
+
+/* Without bitrate, noise frames that do not fit lower the quality until they do, and it stays there */
+static void test_fixed_quality(void)
+{
+  uint32_t quality = SCRJ_QUALITY_MAX;
+  int nb_overflows = 0;
+  int mean;
+
+  mean = run_bitrate(FRAME_NOISE, 30, 10, 0, &quality, &nb_overflows);
+  CHECK(nb_overflows > 0);
+  CHECK(mean > 0);
+  CHECK(quality < SCRJ_QUALITY_MAX);
+
+  nb_overflows = 0;
+  run_bitrate(FRAME_NOISE, 10, 10, 0, &quality, &nb_overflows);
+  CHECK_EQ(nb_overflows, 0);
+  run_bitrate(FRAME_SCENE, 10, 10, 0, &quality, &nb_overflows);
+  CHECK_EQ(nb_overflows, 0);
+  CHECK(quality < SCRJ_QUALITY_MAX);
+}
+
+/* Best time in ns of `nb_runs` conversions (mode 0) or encodings at quality 75 (mode 1) of the scene */
+static uint64_t bench(int mode)
+{
+  const int nb_runs = 20;
+  uint64_t best = UINT64_MAX;
+
+  make_frame(FRAME_SCENE, 0);
+  SCRJ_Cvt_Rgb565_To_Mcu(mcu, (uint8_t *) frame, WIDTH * 2, WIDTH, HEIGHT);
+  for (int r = 0; r < nb_runs; r++)
+  {
+    uint64_t t0 = host_test_ns(), ns;
+
+    if (mode == 0)
+      SCRJ_Cvt_Rgb565_To_Mcu(mcu, (uint8_t *) frame, WIDTH * 2, WIDTH, HEIGHT);
+    else
+      codec_encode(mcu, WIDTH, HEIGHT, 75, jpeg, JPEG_SIZE);
+    ns = host_test_ns() - t0;
+    if (ns < best)
+      best = ns;
+  }
+  return best;
+}
+
+int main(int argc, char **argv)
+{
+  SCRY_Init();
+
+  test_mcu_layout();
+  test_quality(FRAME_GRADIENT, 40, 30);
+  test_quality(FRAME_SCENE, 32, 24);
+  test_quality(FRAME_NOISE, 20, 12);
+  test_overflow();
+  test_adapt_quality();
+  test_bitrate(4000000);
+  test_bitrate(2000000);
+  test_fixed_quality();
+
+  if (host_test_bench(argc, argv))
+  {
+    uint64_t cvt = bench(0), enc = bench(1);
+
+    printf("%dx%d: MCU conversion %.2f ns/pixel, encoding %.2f ns/pixel (%.1f MB/s of RGB565, %.0f fps)\n",
+           WIDTH, HEIGHT, (double) cvt / (WIDTH * HEIGHT), (double) enc / (WIDTH * HEIGHT),
+           WIDTH * HEIGHT * 2 * 1e3 / enc, 1e9 / (cvt + enc));
+  }
+
+  return host_test_result("test_scrl_jpeg");
+}
@@ -0,0 +1,234 @@
+/**
+ ******************************************************************************
+ * @file    test_scrl_yuv.c
+ * @brief   RGB565 to YUV422 conversion of the UVC screen (scrl_yuv.c)
+ ******************************************************************************
+ * The row conversion must stay within 1 LSB of the scalar LUT conversion over
+ * all RGB565 colors and random pixel pairs, for odd widths and in place,
+ * without writing past the last pixel pair. The test is also built with the
+ * Helium stand-in (arm_mve.h) as test_scrl_yuv_mve, which checks the Q15
+ * arithmetic of the Helium path. The changed rows conversion must leave the
+ * same frame as a full conversion while random pixels change, the last one of
+ * odd widths included, and only convert the rows that changed. The benchmark
+ * reports the time per pixel of the conversions of a 640x480 screen.
+ ******************************************************************************
+ */
+
+#include <stdlib.h>
+#include "host_test.h"
+#include "scrl_yuv.h"
+
+#define NB_PIXELS   65536
+#define NB_FRAMES   300
+#define MAX_WIDTH   67
+#define HEIGHT      23
+#define STRIDE      ((MAX_WIDTH + 5) * 2)
+#define GUARD       0xA5
+#define SCREEN_W    640
+#define SCREEN_H    480
+
+#ifdef __ARM_FEATURE_MVE
+#define TEST_NAME "test_scrl_yuv_mve"
+#else
+#define TEST_NAME "test_scrl_yuv"
+#endif
+
+/* Accessed by 32-bit words as on target */
+static uint16_t pixels[NB_PIXELS];
+static uint8_t ref[NB_PIXELS * 2];
+static uint8_t out[NB_PIXELS * 2 + 16];
+
+static uint16_t frame[HEIGHT * STRIDE / 2];
+static uint8_t prev[HEIGHT * STRIDE];
+static uint8_t cache[HEIGHT * STRIDE];
+static uint8_t expected[HEIGHT * STRIDE];
+
+static uint16_t screen[SCREEN_W * SCREEN_H];
+static uint8_t screen_prev[SCREEN_W * SCREEN_H * 2];
+static uint8_t screen_yuv[SCREEN_W * SCREEN_H * 2];
+
+static uint32_t rng_state = 0x2545F491;
+
+static uint32_t rng(uint32_t n)
+{
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return rng_state % n;
+}
+
+/* Largest difference of `len` bytes */
+static int max_diff(const uint8_t *a, const uint8_t *b, int len)
+{
+  int diff = 0;
+
+  for (int i = 0; i < len; i++)
+  {
+    int d = abs(a[i] - b[i]);
+
+    diff = d > diff ? d : diff;
+  }
+  return diff;
+}
+
+/* Conversion of a row of `width` pixels against the scalar one, returns the largest difference */
+static int check_row(int width)
+{
+  int size = ((width + 1) / 2) * 4;
+
+  SCRY_Cvt_Rgb565_To_Yuv422(ref, (uint8_t *) pixels, width, 1);
+  memset(out, GUARD, sizeof(out));
+  SCRY_Cvt_Rgb565_To_Yuv422_Row(out, (uint8_t *) pixels, width);
+  for (int i = size; i < size + 16; i++)
+    CHECK_EQ(out[i], GUARD);
+
+  return max_diff(out, ref, size);
+}
+
+static void test_colors(void)
+{
+  /* Each color in both pixels of a pair, for the luma and chroma of every color */
+  for (int half = 0; half < 2; half++)
+  {
+    for (int i = 0; i < NB_PIXELS; i += 2)
+      pixels[i] = pixels[i + 1] = (uint16_t) (half * NB_PIXELS / 2 + i / 2);
+    CHECK(check_row(NB_PIXELS) <= 1);
+  }
+
+  /* Random pairs, the chroma of their average */
+  for (int n = 0; n < 16; n++)
+  {
+    for (int i = 0; i < NB_PIXELS; i++)
+      pixels[i] = (uint16_t) rng(NB_PIXELS);
+    CHECK(check_row(NB_PIXELS) <= 1);
+  }
+
+  /* Extreme components, where the Q15 products are the largest */
+  for (int i = 0; i < NB_PIXELS; i++)
+    pixels[i] = (uint16_t) ((rng(2) ? 0x1f : 0) << 11 | (rng(2) ? 0x3f : 0) << 5 | (rng(2) ? 0x1f : 0));
+  CHECK(check_row(NB_PIXELS) <= 1);
+#ifndef __ARM_FEATURE_MVE
+  /* Without Helium the row conversion is the scalar one */
+  CHECK_EQ(check_row(NB_PIXELS), 0);
+#endif
+}
+
+/* Widths around the 8 pixel pairs of the Helium loop, in place included */
+static void test_widths(void)
+{
+  for (int width = 1; width <= 67; width++)
+  {
+    int size = ((width + 1) / 2) * 4;
+
+    for (int i = 0; i < NB_PIXELS; i++)
+      pixels[i] = (uint16_t) rng(NB_PIXELS);
+    CHECK(check_row(width) <= 1);
+
+    /* In place, as the screen buffer without cache */
+    memcpy(out, pixels, size);
+    SCRY_Cvt_Rgb565_To_Yuv422_Row(out, out, width);
+    SCRY_Cvt_Rgb565_To_Yuv422_Row(ref, (uint8_t *) pixels, width);
+    CHECK(memcmp(out, ref, size) == 0);
+  }
+}
+
+/* The layer area of `width` pixels of the frame, converted as a whole into `expected` */
+static void convert_all(int width)
+{
+  memset(expected, GUARD, sizeof(expected));
+  for (int y = 0; y < HEIGHT; y++)
+    SCRY_Cvt_Rgb565_To_Yuv422_Row(expected + y * STRIDE, (uint8_t *) frame + y * STRIDE, width);
+}
+
+static void test_changed(int width)
+{
+  int failures = 0, nb_changed_total = 0;
+
+  for (size_t i = 0; i < sizeof(frame) / 2; i++)
+    frame[i] = (uint16_t) rng(NB_PIXELS);
+  memset(cache, GUARD, sizeof(cache));
+  memset(prev, 0, sizeof(prev));
+
+  /* First frame: every row, whatever the previous buffer holds */
+  CHECK_EQ(SCRY_Cvt_Rgb565_To_Yuv422_Changed(cache, prev, (uint8_t *) frame, STRIDE, width, HEIGHT, 0), HEIGHT);
+  convert_all(width);
+  CHECK(memcmp(cache, expected, sizeof(cache)) == 0);
+
+  for (int f = 0; f < NB_FRAMES; f++)
+  {
+    uint16_t before[sizeof(frame) / 2];
+    int nb_changed = 0, nb;
+
+    memcpy(before, frame, sizeof(frame));
+    /* A few pixels of a few rows, a third of them the last one, or a pixel set to its own value */
+    for (int n = rng(4); n > 0; n--)
+    {
+      int y = rng(HEIGHT);
+      int x = rng(3) == 0 ? width - 1 : (int) rng(width);
+      uint16_t *p = &frame[y * STRIDE / 2 + x];
+
+      *p = rng(4) == 0 ? *p : *p ^ (uint16_t) (1 << rng(16));
+    }
+    for (int y = 0; y < HEIGHT; y++)
+      nb_changed += memcmp(&frame[y * STRIDE / 2], &before[y * STRIDE / 2], width * 2) != 0;
+
+    nb = SCRY_Cvt_Rgb565_To_Yuv422_Changed(cache, prev, (uint8_t *) frame, STRIDE, width, HEIGHT, 1);
+    convert_all(width);
+    failures += nb != nb_changed;
+    failures += memcmp(cache, expected, sizeof(cache)) != 0;
+    nb_changed_total += nb_changed;
+  }
+  CHECK_EQ(failures, 0);
+  CHECK(nb_changed_total > NB_FRAMES / 2);
+}
+
+/* Best time per pixel of `nb_runs` conversions of the screen, `nb_rows` rows changed before each */
+static double bench_screen(int mode, int nb_rows)
+{
+  const int nb_runs = 50;
+  uint64_t best = UINT64_MAX;
+
+  SCRY_Cvt_Rgb565_To_Yuv422_Changed(screen_yuv, screen_prev, (uint8_t *) screen, SCREEN_W * 2, SCREEN_W, SCREEN_H, 0);
+  for (int r = 0; r < nb_runs; r++)
+  {
+    uint64_t t0, ns;
+
+    for (int n = 0; n < nb_rows; n++)
+      screen[rng(SCREEN_H) * SCREEN_W + rng(SCREEN_W)] ^= 1;
+    t0 = host_test_ns();
+    if (mode == 0)
+      SCRY_Cvt_Rgb565_To_Yuv422(screen_yuv, (uint8_t *) screen, SCREEN_W, SCREEN_H);
+    else if (mode == 1)
+      for (int y = 0; y < SCREEN_H; y++)
+        SCRY_Cvt_Rgb565_To_Yuv422_Row(screen_yuv + y * SCREEN_W * 2, (uint8_t *) (screen + y * SCREEN_W), SCREEN_W);
+    else
+      SCRY_Cvt_Rgb565_To_Yuv422_Changed(screen_yuv, screen_prev, (uint8_t *) screen, SCREEN_W * 2, SCREEN_W,
+                                        SCREEN_H, 1);
+    ns = host_test_ns() - t0;
+    if (ns < best)
+      best = ns;
+  }
+  return (double) best / (SCREEN_W * SCREEN_H);
+}
+
+int main(int argc, char **argv)
+{
+  SCRY_Init();
+
+  test_colors();
+  test_widths();
+  test_changed(MAX_WIDTH);
+  test_changed(MAX_WIDTH - 1);
+  test_changed(1);
+
+  if (host_test_bench(argc, argv))
+  {
+    for (size_t i = 0; i < sizeof(screen) / 2; i++)
+      screen[i] = (uint16_t) rng(NB_PIXELS);
+    printf("%dx%d: scalar %.2f ns/pixel, row %.2f ns/pixel, changed rows (none) %.2f ns/pixel, "
+           "(48 rows) %.2f ns/pixel\n", SCREEN_W, SCREEN_H, bench_screen(0, 0), bench_screen(1, 0),
+           bench_screen(2, 0), bench_screen(2, 48));
+  }
+
+  return host_test_result(TEST_NAME);
+}
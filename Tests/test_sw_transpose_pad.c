@@ -0,0 +1,350 @@
+/**
+ ******************************************************************************
+ * @file    test_sw_transpose_pad.c
+ * @brief   SW Transpose and reflect/edge Pad operators of the ATON library,
+ *          against index models of both operators
+ ******************************************************************************
+ * Random transposes of rank 3 to 8 and random reflect and edge pads of rank 1
+ * to 6, negative edge pads included, of 1- to 4-byte elements must match the
+ * models bit for bit, as well as shapes taking the banded transpose. The test
+ * is built three times: with the iterative operators, with the recursive
+ * reference ones (LL_ATON_LIB_SW_OPS_REFERENCE) and with the iterative ones on
+ * the Helium stand-in (arm_mve.h). Pads are kept below the DMA thresholds of
+ * the operator: the DMA helpers of the library are linked but never reached.
+ ******************************************************************************
+ */
+
+#include <stdlib.h>
+#include "host_test.h"
+#include "ll_aton_lib.h"
+
+#define MAX_RANK 8
+#define NB_RANDOM 3000
+
+static uint32_t rng_state = 0x12345678;
+
+static uint32_t rng(uint32_t n)
+{
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return rng_state % n;
+}
+
+static void fill_random(uint8_t *buf, size_t size)
+{
+  for (size_t i = 0; i < size; i++)
+    buf[i] = (uint8_t) rng(256);
+}
+
+/* Dense strides in bytes */
+static size_t strides(const uint32_t *shape, int rank, int nbytes, uint32_t *stride)
+{
+  size_t size = nbytes;
+
+  for (int i = rank - 1; i >= 0; i--)
+  {
+    stride[i] = size;
+    size *= shape[i];
+  }
+  return size;
+}
+
+/* Output index `o` of a padded axis of `n` input items, `start` items added before (cropped when negative) */
+static int model_pad_index(int mode, int o, int start, int n)
+{
+  int i = o - start;
+
+  if (mode == 2)
+    return i < 0 ? 0 : (i >= n ? n - 1 : i);
+
+  /* reflect: ..., 2, 1, 0, 1, 2, ..., n - 1, n - 2, ... */
+  int period = 2 * (n - 1);
+  if (period == 0)
+    return 0;
+  i %= period;
+  if (i < 0)
+    i += period;
+  return i < n ? i : period - i;
+}
+
+/* Transpose of `in_shape` by `perm`: output axis i is input axis perm[i] */
+static int run_transpose(const uint32_t *in_shape, const uint8_t *perm, int rank, int nbytes, uint64_t *ns)
+{
+  uint32_t out_shape[MAX_RANK], in_stride[MAX_RANK], out_stride[MAX_RANK], index[MAX_RANK] = { 0 };
+  size_t size;
+  int ok;
+
+  for (int i = 0; i < rank; i++)
+    out_shape[i] = in_shape[perm[i]];
+  size = strides(in_shape, rank, nbytes, in_stride);
+  strides(out_shape, rank, nbytes, out_stride);
+
+  uint8_t *in = malloc(size + 1), *out = malloc(size + 1), *model = malloc(size + 1);
+  fill_random(in, size);
+  memset(out, 0xa5, size + 1);
+
+  LL_LIB_TensorShape_TypeDef in_t = { .addr_base = { .p = in }, .offset_end = size, .ndims = rank,
+                                      .nbits = 8 * nbytes, .shape = in_shape };
+  LL_LIB_TensorShape_TypeDef out_t = { .addr_base = { .p = out }, .offset_end = size, .ndims = rank,
+                                       .nbits = 8 * nbytes, .shape = out_shape };
+  uint64_t t0 = host_test_ns();
+  CHECK_EQ(LL_ATON_LIB_Transpose(&in_t, in_stride, &out_t, out_stride, perm), LL_ATON_OK);
+  if (ns)
+    *ns = host_test_ns() - t0;
+
+  /* Every output element from its input coordinates */
+  for (size_t e = 0; e < size / nbytes; e++)
+  {
+    size_t in_off = 0, out_off = 0;
+
+    for (int i = 0; i < rank; i++)
+    {
+      in_off += index[i] * in_stride[perm[i]];
+      out_off += index[i] * out_stride[i];
+    }
+    memcpy(model + out_off, in + in_off, nbytes);
+    for (int i = rank - 1; i >= 0 && ++index[i] == out_shape[i]; i--)
+      index[i] = 0;
+  }
+  ok = memcmp(out, model, size) == 0 && out[size] == 0xa5;
+  free(in);
+  free(out);
+  free(model);
+  return ok;
+}
+
+/* Pad of `in_shape` by `start`/`end` items per axis, mode 1 (reflect) or 2 (edge) */
+static int run_pad(const uint32_t *in_shape, const int32_t *start, const int32_t *end, int rank, int mode, int nbytes,
+                   uint64_t *ns)
+{
+  uint32_t out_shape[MAX_RANK], min_shape[MAX_RANK], in_stride[MAX_RANK], out_stride[MAX_RANK];
+  int32_t in_start[MAX_RANK], in_end[MAX_RANK], out_start[MAX_RANK], out_end[MAX_RANK];
+  int32_t out_shape_i[MAX_RANK], out_offsets[MAX_RANK];
+  uint32_t index[MAX_RANK] = { 0 }, consecutive_elems = 1;
+  size_t in_size, out_size;
+  int ok, inner = 0;
+
+  for (int i = 0; i < rank; i++)
+  {
+    out_shape[i] = in_shape[i] + start[i] + end[i];
+    min_shape[i] = in_shape[i] + (start[i] < 0 ? start[i] : 0) + (end[i] < 0 ? end[i] : 0);
+    if (start[i] != 0 || end[i] != 0)
+      inner = i;
+  }
+  in_size = strides(in_shape, rank, nbytes, in_stride);
+  out_size = strides(out_shape, rank, nbytes, out_stride);
+  for (int i = 0; i < rank; i++)
+  {
+    in_start[i] = start[i] * (int32_t) in_stride[i];
+    in_end[i] = end[i] * (int32_t) in_stride[i];
+    out_start[i] = start[i] > 0 ? start[i] * (int32_t) out_stride[i] : 0;
+    out_end[i] = end[i] > 0 ? end[i] * (int32_t) out_stride[i] : 0;
+    out_shape_i[i] = out_shape[i];
+    out_offsets[i] = out_stride[i];
+  }
+  /* Input items copied at once: the innermost padded axis and the ones below it */
+  for (int i = inner; i < rank; i++)
+    consecutive_elems *= min_shape[i];
+
+  uint8_t *in = malloc(in_size), *out = malloc(out_size + 1), *model = malloc(out_size + 1);
+  fill_random(in, in_size);
+  memset(out, 0xa5, out_size + 1);
+
+  uint64_t t0 = host_test_ns();
+  CHECK_EQ(LL_ATON_LIB_Pad(in, out, in + in_size, out + out_size, min_shape, mode, nbytes, out_size / nbytes, 0,
+                           inner, consecutive_elems, in_start, in_end, out_start, out_end, out_shape_i, out_offsets,
+                           rank, 0, 1),
+           LL_ATON_OK);
+  if (ns)
+    *ns = host_test_ns() - t0;
+
+  /* Every output element from the input item it repeats */
+  for (size_t e = 0; e < out_size / nbytes; e++)
+  {
+    size_t in_off = 0, out_off = 0;
+
+    for (int i = 0; i < rank; i++)
+    {
+      in_off += model_pad_index(mode, index[i], start[i], in_shape[i]) * in_stride[i];
+      out_off += index[i] * out_stride[i];
+    }
+    memcpy(model + out_off, in + in_off, nbytes);
+    for (int i = rank - 1; i >= 0 && ++index[i] == out_shape[i]; i--)
+      index[i] = 0;
+  }
+  ok = memcmp(out, model, out_size) == 0 && out[out_size] == 0xa5;
+  free(in);
+  free(out);
+  free(model);
+  return ok;
+}
+
+static void random_perm(uint8_t *perm, int rank)
+{
+  for (int i = 0; i < rank; i++)
+    perm[i] = i;
+  for (int i = rank - 1; i > 0; i--)
+  {
+    int j = rng(i + 1);
+    uint8_t t = perm[i];
+    perm[i] = perm[j];
+    perm[j] = t;
+  }
+}
+
+static void test_transpose(void)
+{
+  uint32_t shape[MAX_RANK];
+  uint8_t perm[MAX_RANK];
+  int failures = 0;
+
+  for (int n = 0; n < NB_RANDOM; n++)
+  {
+    int rank = 3 + rng(MAX_RANK - 2), nbytes = 1 + rng(4);
+    uint32_t elems = 1;
+
+    for (int i = 0; i < rank; i++)
+    {
+      /* Up to ~8k elements, unit axes included */
+      shape[i] = 1 + rng(elems > 1024 ? 2 : (rank > 5 ? 4 : 9));
+      elems *= shape[i];
+    }
+    random_perm(perm, rank);
+    if (!run_transpose(shape, perm, rank, nbytes, NULL))
+    {
+      if (failures++ < 5)
+        printf("transpose mismatch: rank %d, %d bytes, perm %d %d %d ...\n", rank, nbytes, perm[0], perm[1], perm[2]);
+    }
+  }
+  CHECK_EQ(failures, 0);
+
+  /* Contiguous output axis long enough to be copied in bands (full and partial), identity, single element */
+  static const uint32_t chw[] = { 1, 3, 45, 70 }, cw[] = { 5, 33, 7 }, one[] = { 1, 1, 1 };
+  static const uint8_t to_hwc[] = { 0, 2, 3, 1 }, to_whc[] = { 0, 3, 2, 1 }, swap[] = { 0, 2, 1 }, id[] = { 0, 1, 2 };
+  for (int nbytes = 1; nbytes <= 4; nbytes++)
+  {
+    CHECK(run_transpose(chw, to_hwc, 4, nbytes, NULL));
+    CHECK(run_transpose(chw, to_whc, 4, nbytes, NULL));
+    CHECK(run_transpose(cw, swap, 3, nbytes, NULL));
+    CHECK(run_transpose(cw, id, 3, nbytes, NULL));
+    CHECK(run_transpose(one, swap, 3, nbytes, NULL));
+  }
+
+  /* Rank checks */
+  LL_LIB_TensorShape_TypeDef t = { .ndims = 2, .nbits = 8, .shape = one };
+  CHECK_EQ(LL_ATON_LIB_Transpose(&t, NULL, &t, NULL, id), LL_ATON_INVALID_PARAM);
+}
+
+static void test_pad(void)
+{
+  uint32_t shape[MAX_RANK];
+  int32_t start[MAX_RANK], end[MAX_RANK];
+  int failures = 0, runs = 0;
+
+  while (runs < NB_RANDOM)
+  {
+    int rank = 1 + rng(6), nbytes = 1 + rng(4), mode = 1 + rng(2);
+    uint32_t consecutive = nbytes, last = 0;
+
+    for (int i = 0; i < rank; i++)
+    {
+      shape[i] = 1 + rng(rank > 3 ? 4 : 8);
+      start[i] = end[i] = 0;
+      /* Axes left unpadded half of the time, reflect pads up to twice the axis */
+      if (rng(2) == 0)
+        continue;
+      start[i] = rng(2 * shape[i] + 1);
+      end[i] = rng(2 * shape[i] + 1);
+      if (mode == 2 && shape[i] > 1 && rng(2) == 0)
+      {
+        /* Cropping, at least one item left */
+        start[i] = -(int32_t) rng(shape[i]);
+        if (rng(2) == 0)
+          end[i] = -(int32_t) rng(shape[i] + start[i]);
+      }
+    }
+    for (int i = 0; i < rank; i++)
+    {
+      if (start[i] != 0 || end[i] != 0)
+        last = i;
+    }
+    for (int i = last; i < rank; i++)
+      consecutive *= shape[i];
+    /* Below the DMA thresholds of the operator */
+    if (consecutive >= __LL_PAD_FILLING_DMA_MIN_BUFF_LEN)
+      continue;
+
+    if (!run_pad(shape, start, end, rank, mode, nbytes, NULL))
+    {
+      if (failures++ < 5)
+        printf("pad mismatch: rank %d, %d bytes, mode %d\n", rank, nbytes, mode);
+    }
+    runs++;
+  }
+  CHECK_EQ(failures, 0);
+
+  /* Long reflections of a single and of two items, crops on both sides of the inner axis */
+  static const uint32_t s1[] = { 2, 1, 3 }, s2[] = { 3, 2, 5 };
+  static const int32_t p5[] = { 5, 5, 0 }, p7[] = { 1, 7, 7 }, c_start[] = { 0, 1, -2 }, c_end[] = { 2, 0, -2 };
+  for (int nbytes = 1; nbytes <= 4; nbytes++)
+  {
+    CHECK(run_pad(s1, p5, p7, 3, 1, nbytes, NULL));
+    CHECK(run_pad(s2, p7, p5, 3, 1, nbytes, NULL));
+    CHECK(run_pad(s2, c_start, c_end, 3, 2, nbytes, NULL));
+  }
+}
+
+/* Time of the operator in `call` (a run_ function with `&ns`), best of a few runs */
+#define BENCH(label, call) \
+  do { \
+    uint64_t ns, best = UINT64_MAX; \
+    for (int r = 0; r < 20; r++) \
+    { \
+      CHECK(call); \
+      if (ns < best) \
+        best = ns; \
+    } \
+    printf("  %-48s %8.1f us\n", label, best / 1e3); \
+  } while (0)
+
+static void bench(void)
+{
+  static const uint32_t nchw[] = { 1, 32, 48, 48 }, nhwc[] = { 1, 48, 48, 32 }, heatmaps[] = { 1, 17, 48, 48 };
+  static const uint8_t to_nhwc[] = { 0, 2, 3, 1 }, to_nchw[] = { 0, 3, 1, 2 };
+  static const uint32_t nchw6[] = { 1, 2, 16, 2, 24, 24 };
+  static const uint8_t shuffle[] = { 0, 2, 1, 3, 4, 5 };
+  static const uint32_t img[] = { 1, 16, 48, 48 };
+  static const int32_t hw1[] = { 0, 0, 1, 1 }, hw3[] = { 0, 0, 3, 3 };
+
+#if defined(LL_ATON_LIB_SW_OPS_REFERENCE)
+  printf("Recursive reference operators:\n");
+#elif defined(__ARM_FEATURE_MVE)
+  printf("Iterative operators on the Helium stand-in (not representative of the target timings):\n");
+#else
+  printf("Iterative operators:\n");
+#endif
+  BENCH("Transpose 1x32x48x48 NCHW -> NHWC int8", run_transpose(nchw, to_nhwc, 4, 1, &ns));
+  BENCH("Transpose 1x48x48x32 NHWC -> NCHW int8", run_transpose(nhwc, to_nchw, 4, 1, &ns));
+  BENCH("Transpose 1x17x48x48 NCHW -> NHWC float", run_transpose(heatmaps, to_nhwc, 4, 4, &ns));
+  BENCH("Transpose 1x2x16x2x24x24 channel shuffle int8", run_transpose(nchw6, shuffle, 6, 1, &ns));
+  BENCH("Pad reflect 1x16x48x48 by 1 on H, W int8", run_pad(img, hw1, hw1, 4, 1, 1, &ns));
+  BENCH("Pad edge 1x16x48x48 by 3 on H, W int8", run_pad(img, hw3, hw3, 4, 2, 1, &ns));
+  BENCH("Pad reflect 1x16x48x48 by 3 on H, W float", run_pad(img, hw3, hw3, 4, 1, 4, &ns));
+}
+
+int main(int argc, char **argv)
+{
+  test_transpose();
+  test_pad();
+  if (host_test_bench(argc, argv))
+    bench();
+
+#if defined(LL_ATON_LIB_SW_OPS_REFERENCE)
+  return host_test_result("test_sw_transpose_pad_ref");
+#elif defined(__ARM_FEATURE_MVE)
+  return host_test_result("test_sw_transpose_pad_mve");
+#else
+  return host_test_result("test_sw_transpose_pad");
+#endif
+}
@@ -0,0 +1,301 @@
+/**
+ ******************************************************************************
+ * @file    test_weight_prefetch.c
+ * @brief   NPU cache profiling and weight warming of the epoch blocks
+ *          (weight_prefetch.c) on the host simulation platform
+ ******************************************************************************
+ * The weights window is the mocked NOR (mock_nor.h), the DWT cycle counter
+ * the mocked clock (mock_clock.h); the NPU cache monitors and the burst
+ * counters of the debug and trace unit are stubs driven by the test. A
+ * synthetic network alternates epoch blobs and SW blocks, each blob with its
+ * own miss ratio and reads metadata: weight ranges taken in order within
+ * WEIGHT_PREFETCH_MAX_RANGES and WEIGHT_PREFETCH_MAX_BYTES, activations
+ * ignored. After WEIGHT_PREFETCH_PROFILE_RUNS inferences only the blobs
+ * missing enough and reading weights must be cold, the warming copies own
+ * the ATON IP from the SW block before a cold blob (or from
+ * WeightPrefetch_Idle() for the first one) until the blob starts, and the
+ * report must give the averages per epoch block.
+ ******************************************************************************
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "host_test.h"
+#include "mock_nor.h"
+#include "sim_network.h"
+#include "weight_prefetch.h"
+#include "npu_cache.h"
+#include "ll_aton_dbgtrc.h"
+
+__thread uint32_t mock_clock;
+uint32_t SystemCoreClock = 800000000;
+uint8_t mock_nor[MODEL_MANAGER_NB_SLOTS * MODEL_MANAGER_SLOT_SIZE];
+
+#define W(offset) ((uintptr_t) mock_nor + (offset))
+#define ACTIVATIONS 0x34100000UL
+#define NB_EBS (sizeof(ebs) / sizeof(ebs[0]) - 1)
+
+/* Per inference of each block: CPU cycles (100 us per index + 1), NPU cache reads, misses */
+#define EB_TICKS(i) (800U * 100 * ((i) + 1))
+#define EB_READS    1000
+
+static const EpochBlock_ItemTypeDef ebs[] = {
+  SIM_NETWORK_BLOB_EB(0x34000000),
+  SIM_NETWORK_SW_EB(0),
+  SIM_NETWORK_BLOB_EB(0x34001000),
+  SIM_NETWORK_SW_EB(0),
+  SIM_NETWORK_BLOB_EB(0x34002000),
+  SIM_NETWORK_BLOB_EB(0x34003000),
+  SIM_NETWORK_BLOB_EB(0x34004000),
+  SIM_NETWORK_LAST_EB,
+};
+
+/* Blob 0: one range. Blob 2: activations skipped, the second weight range clipped to WEIGHT_PREFETCH_MAX_BYTES.
+ * Blob 4: an empty range skipped, four ranges out of five. Blob 5: no weights. Blob 6: one range */
+static const EpochBlock_MemRangeTypeDef eb0_reads[] = { { W(0x0000), W(0x2000) } };
+static const EpochBlock_MemRangeTypeDef eb2_reads[] = {
+  { ACTIVATIONS, ACTIVATIONS + 0x1000 },
+  { W(0x4000), W(0xe000) },
+  { W(0x10000), W(0x17000) },
+  { W(0x17000), W(0x17400) },
+};
+static const EpochBlock_MemRangeTypeDef eb4_reads[] = {
+  { W(0x400), W(0x400) },
+  { W(0x0000), W(0x0400) }, { W(0x1000), W(0x1400) }, { W(0x2000), W(0x2400) },
+  { W(0x3000), W(0x3400) }, { W(0x4000), W(0x4400) },
+};
+static const EpochBlock_MemRangeTypeDef eb5_reads[] = { { ACTIVATIONS, ACTIVATIONS + 0x1000 } };
+static const EpochBlock_MemRangeTypeDef eb6_reads[] = { { W(0x8000), W(0x8400) } };
+static const EpochBlock_MemRangeTypeDef no_ranges[] = { { 0, 0 } };
+
+#define DEPS(r) { .reads = (r), .writes = no_ranges, .nr_reads = sizeof(r) / sizeof((r)[0]), .nr_writes = 0 }
+
+static const EpochBlock_DepsTypeDef deps[] = {
+  DEPS(eb0_reads), DEPS(no_ranges), DEPS(eb2_reads), DEPS(no_ranges), DEPS(eb4_reads), DEPS(eb5_reads), DEPS(eb6_reads), { 0 },
+};
+
+/* Miss ratio (%) of each blob, blob 4 at WEIGHT_PREFETCH_COLD_MISS_PCT */
+static const uint32_t miss_pct[NB_EBS] = { 50, 0, 30, 0, WEIGHT_PREFETCH_COLD_MISS_PCT, 90, 10 };
+
+static NN_Instance_TypeDef instance = { .exec_state = { .first_epoch_block = ebs } };
+static NN_Instance_TypeDef other_owner;
+
+/* NPU cache monitors and burst counters */
+static uint32_t cache_hits, cache_misses;
+static unsigned int bus_reads, bus_writes;
+
+void npu_cache_monitor_start(void)
+{
+}
+
+void npu_cache_monitor_reset(void)
+{
+  cache_hits = 0;
+  cache_misses = 0;
+}
+
+void npu_cache_monitor_read(uint32_t *read_hits, uint32_t *read_misses)
+{
+  *read_hits = cache_hits;
+  *read_misses = cache_misses;
+}
+
+int LL_Dbgtrc_BurstLenBenchStart(unsigned int counter)
+{
+  return 0;
+}
+
+int LL_Dbgtrc_GetTotalTranfers(unsigned int counter_id, unsigned int *totalWrites, unsigned int *totalReads)
+{
+  *totalWrites = bus_writes;
+  *totalReads = bus_reads;
+  return 0;
+}
+
+/* Owner of the ATON IP once each block has started */
+static NN_Instance_TypeDef *owner_at_start[NB_EBS];
+
+static void run(void)
+{
+  extern NN_Instance_TypeDef *volatile __ll_current_aton_ip_owner;
+
+  for (int i = 0; i < (int) NB_EBS; i++)
+  {
+    uint32_t misses = EpochBlock_IsEpochBlob(&ebs[i]) ? EB_READS * miss_pct[i] / 100 : 0;
+
+    WeightPrefetch_EpochCallback(LL_ATON_RT_Callbacktype_PRE_START, &instance, &ebs[i]);
+    owner_at_start[i] = __ll_current_aton_ip_owner;
+    mock_clock += EB_TICKS(i);
+    if (EpochBlock_IsEpochBlob(&ebs[i]))
+    {
+      cache_hits += EB_READS - misses;
+      cache_misses += misses;
+      /* Byte totals wrap around */
+      bus_reads += EB_READS * 64;
+      bus_writes += 1024;
+    }
+    WeightPrefetch_EpochCallback(LL_ATON_RT_Callbacktype_POST_END, &instance, &ebs[i]);
+  }
+}
+
+static void test_profile(void)
+{
+  WeightPrefetch_EbStats_t stats;
+
+  bus_reads = 0xfffff000;
+  WeightPrefetch_Init(WEIGHT_PREFETCH_PROFILE, deps, W(0), sizeof(mock_nor));
+  for (int r = 0; r < 2 * WEIGHT_PREFETCH_PROFILE_RUNS; r++)
+    run();
+
+  CHECK_EQ(WeightPrefetch_GetNbEb(), NB_EBS);
+  for (int i = 0; i < (int) NB_EBS; i++)
+  {
+    WeightPrefetch_GetStats(i, &stats);
+    CHECK_EQ(stats.count, 2 * WEIGHT_PREFETCH_PROFILE_RUNS);
+    CHECK_EQ(stats.ticks, (uint64_t) EB_TICKS(i) * stats.count);
+    CHECK_EQ(stats.blob, EpochBlock_IsEpochBlob(&ebs[i]));
+    /* Profiling only */
+    CHECK_EQ(stats.cold, 0);
+    CHECK(owner_at_start[i] == NULL);
+    if (stats.blob)
+    {
+      CHECK_EQ(stats.read_misses, (uint64_t) EB_READS * miss_pct[i] / 100 * stats.count);
+      CHECK_EQ(stats.read_hits + stats.read_misses, (uint64_t) EB_READS * stats.count);
+      CHECK_EQ(stats.read_bytes, (uint64_t) EB_READS * 64 * stats.count);
+      CHECK_EQ(stats.write_bytes, 1024ULL * stats.count);
+    }
+    else
+    {
+      CHECK_EQ(stats.read_hits + stats.read_misses + stats.read_bytes, 0);
+    }
+  }
+}
+
+static void test_cold(void)
+{
+  extern NN_Instance_TypeDef *volatile __ll_current_aton_ip_owner;
+  static const uint32_t warm_bytes[NB_EBS] = { 0x2000, 0, 64 * 1024, 0, 0x1000, 0, 0 };
+  WeightPrefetch_EbStats_t stats;
+
+  WeightPrefetch_Init(WEIGHT_PREFETCH_AUTO, deps, W(0), sizeof(mock_nor));
+  for (int r = 0; r < WEIGHT_PREFETCH_PROFILE_RUNS - 1; r++)
+  {
+    run();
+    WeightPrefetch_Idle();
+    CHECK(__ll_current_aton_ip_owner == NULL);
+  }
+  WeightPrefetch_GetStats(0, &stats);
+  CHECK_EQ(stats.cold, 0);
+
+  /* Blobs 0, 2 and 4 miss enough, 6 does not, 5 has no weights; measured again from scratch */
+  run();
+  for (int i = 0; i < (int) NB_EBS; i++)
+  {
+    WeightPrefetch_GetStats(i, &stats);
+    CHECK_EQ(stats.cold, warm_bytes[i] != 0);
+    CHECK_EQ(stats.warm_bytes, warm_bytes[i]);
+    CHECK_EQ(stats.count, 0);
+  }
+
+  /* Blob 0 warmed between inferences, blobs 2 and 4 during the SW block before them, each until it starts */
+  WeightPrefetch_Idle();
+  CHECK(__ll_current_aton_ip_owner != NULL);
+  run();
+  CHECK(owner_at_start[0] == NULL);
+  CHECK(owner_at_start[1] != NULL);
+  CHECK(owner_at_start[2] == NULL);
+  CHECK(owner_at_start[3] != NULL);
+  CHECK(owner_at_start[4] == NULL);
+
+  /* Not while another instance owns the ATON IP */
+  __ll_current_aton_ip_owner = &other_owner;
+  WeightPrefetch_Idle();
+  CHECK(__ll_current_aton_ip_owner == &other_owner);
+  __ll_current_aton_ip_owner = NULL;
+
+  /* Without buffer dependencies nothing is ever warmed */
+  WeightPrefetch_Init(WEIGHT_PREFETCH_AUTO, NULL, W(0), sizeof(mock_nor));
+  for (int r = 0; r < WEIGHT_PREFETCH_PROFILE_RUNS + 1; r++)
+    run();
+  WeightPrefetch_Idle();
+  CHECK(__ll_current_aton_ip_owner == NULL);
+  for (int i = 0; i < (int) NB_EBS; i++)
+  {
+    WeightPrefetch_GetStats(i, &stats);
+    CHECK_EQ(stats.cold, 0);
+  }
+
+  /* Weights window elsewhere: the ranges of blob 0 are outside, only the first weight range of blob 2 is inside */
+  WeightPrefetch_Init(WEIGHT_PREFETCH_AUTO, deps, W(0x4000), 0x10000);
+  for (int r = 0; r < WEIGHT_PREFETCH_PROFILE_RUNS; r++)
+    run();
+  WeightPrefetch_GetStats(0, &stats);
+  CHECK_EQ(stats.cold, 0);
+  WeightPrefetch_GetStats(2, &stats);
+  CHECK_EQ(stats.cold, 1);
+  CHECK_EQ(stats.warm_bytes, 0xa000);
+  WeightPrefetch_Init(WEIGHT_PREFETCH_OFF, NULL, 0, 0);
+}
+
+static void test_report(void)
+{
+  char text[1024], *line;
+  int len, rows = 0;
+
+  WeightPrefetch_Init(WEIGHT_PREFETCH_AUTO, deps, W(0), sizeof(mock_nor));
+  for (int r = 0; r < WEIGHT_PREFETCH_PROFILE_RUNS + 2; r++)
+    run();
+
+  len = WeightPrefetch_Report(text, sizeof(text));
+  CHECK_EQ(len, (int) strlen(text));
+  CHECK(strncmp(text, "eb ", 3) == 0);
+  line = strstr(text, "\r\n");
+  while (line != NULL && line[2] != '\0')
+  {
+    unsigned long us, hit, rd_kb, ext_kb, mbps, warm_kb;
+    uint32_t misses;
+    char kind[8];
+    int i;
+
+    line += 2;
+    CHECK_EQ(sscanf(line, "%d %7s %lu %lu %lu %lu %lu %lu", &i, kind, &us, &hit, &rd_kb, &ext_kb, &mbps, &warm_kb), 8);
+    misses = EB_READS * miss_pct[i] / 100;
+    CHECK_EQ(us, 100UL * (i + 1));
+    CHECK(strcmp(kind, EpochBlock_IsEpochBlob(&ebs[i]) ? "blob" : "sw") == 0);
+    if (EpochBlock_IsEpochBlob(&ebs[i]))
+    {
+      CHECK_EQ(hit, 100 - miss_pct[i]);
+      CHECK_EQ(rd_kb, EB_READS * 64 / 1024);
+      CHECK_EQ(ext_kb, misses * 64 / 1024);
+      CHECK_EQ(mbps, misses * 64 / us);
+    }
+    CHECK_EQ(warm_kb, i == 0 ? 8 : i == 2 ? 64 : i == 4 ? 4 : 0);
+    rows++;
+    line = strstr(line, "\r\n");
+  }
+  CHECK_EQ(rows, NB_EBS);
+
+  /* Truncated */
+  memset(text, 'x', sizeof(text));
+  CHECK_EQ(WeightPrefetch_Report(text, 40), 39);
+  CHECK_EQ(strlen(text), 39);
+
+  /* Blocks not run since the last reset are left out */
+  WeightPrefetch_ResetStats();
+  len = WeightPrefetch_Report(text, sizeof(text));
+  CHECK(strstr(text, "\r\n") == text + len - 2);
+
+  WeightPrefetch_Init(WEIGHT_PREFETCH_OFF, NULL, 0, 0);
+  CHECK_EQ(WeightPrefetch_Report(text, sizeof(text)), 0);
+  run();
+  CHECK_EQ(WeightPrefetch_GetNbEb(), 0);
+}
+
+int main(void)
+{
+  test_profile();
+  test_cold();
+  test_report();
+
+  return host_test_result("test_weight_prefetch");
+}
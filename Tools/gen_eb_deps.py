@@ -0,0 +1,263 @@
+#!/usr/bin/env python3
+"""Buffer dependencies of the epoch blocks of a generated network.c.
+
+Writes the C table returned by LL_ATON_EpochBlockDeps_Default() (see
+Middlewares/AI_Runtime/Npu/ll_aton/ll_aton_eb_deps.h), one entry per epoch
+block of LL_ATON_EpochBlockItems_Default(), used by the SW/HW overlap mode of
+the runtime and by the weight prefetch of the application:
+
+  python3 Tools/gen_eb_deps.py Model/STM32N6570-DK/network.c \
+      -o Model/STM32N6570-DK/network_eb_deps.c
+
+To be run again whenever network.c is generated again: the application checks
+the table against the buffer infos of the network at init.
+
+- Pure SW epoch blocks list every range they access, from the *_sw_info of
+  their node: input and output tensors, other parameters (quantization, roi,
+  sizes, scales) as one range.
+- Epoch blob programs are not decoded: their writes are the buffers of their
+  epochs in the buffer infos (.epoch), their reads only the tensors known to
+  be consumed (the network inputs or the outputs of the SW block before them)
+  and the parameter buffers of their convolutions, in the order of the
+  operators: their .epoch is 0 in the buffer infos, they are assigned by
+  operator number between the nodes of the SW epochs.
+"""
+
+import argparse
+import re
+import sys
+
+# Scalar parameters of the SW operators, counted as 4 bytes whatever their type
+SCALAR_BYTES = 4
+# Non tensor fields of the *_sw_info, named in the comments in this order
+SW_PARAMS = ("roi", "sizes", "scales")
+SW_QUANT_PARAMS = ("is", "izp", "os", "ozp")
+COMMENT_COLUMN = 50
+MAX_NAMES = 2
+
+ADDR = r"ATON_LIB_PHYSICAL_TO_VIRTUAL_ADDR\((0x[0-9a-fA-F]+)UL \+ (\d+)\)"
+
+
+def read_buffers(source):
+    """Returns the buffers of the buffer infos, as dicts."""
+    buffers = []
+    for m in re.finditer(r"\.name = \"(\w+)\",\s*"
+                         r"\.addr_base = \{\(unsigned char \*\)\((0x[0-9a-fA-F]+)UL\)[^}]*\},\s*"
+                         r"\.offset_start = (\d+),\s*\.offset_end = (\d+),\s*\.offset_limit = (\d+),\s*"
+                         r"\.is_user_allocated = \d+,\s*\.is_param = (\d+),\s*\.epoch = (\d+)", source):
+        buffers.append({"name": m.group(1), "base": int(m.group(2), 16), "start": int(m.group(3)),
+                        "end": int(m.group(4)), "param": m.group(6) == "1", "epoch": int(m.group(7))})
+    return buffers
+
+
+def read_sw_nodes(source):
+    """Returns the node and the accessed ranges of each pure SW epoch, by epoch number."""
+    nodes = {}
+    for m in re.finditer(r"/\* scheduling epoch=(\d+).*?\n(.*?)(?=/\* scheduling |// Epoch Controller Blob)",
+                         source, re.S):
+        body = m.group(2)
+        node = re.search(r"/\* kind=\S+ node=(\S+) \*/", body)
+        if not node or "_sw_info" not in body:
+            continue
+        fields = {}
+        for f in re.finditer(r"\.([\w.]+)\.mem\.start_offset = \(\(unsigned char \*\)\(" + ADDR + r"\)\)", body):
+            fields[f.group(1)] = {"base": int(f.group(2), 16), "start": int(f.group(3))}
+        for name, field in fields.items():
+            value = lambda key: re.search(r"\.%s\.%s = (\d+)," % (re.escape(name), key), body)
+            size_b, batch = value("stride.b"), value("dim.tensor_b")
+            elems, stride_c = value("dim.num_elem"), value("stride.c")
+            if size_b and batch:
+                field["end"] = field["start"] + int(size_b.group(1)) * int(batch.group(1))
+            elif elems and stride_c:
+                field["end"] = field["start"] + int(elems.group(1)) * int(stride_c.group(1))
+            else:
+                field["end"] = field["start"] + int(elems.group(1) if elems else 1) * SCALAR_BYTES
+        nodes[int(m.group(1))] = {"node": node.group(1), "fields": fields}
+    return nodes
+
+
+def read_epoch_blocks(source):
+    """Returns the epoch blocks of LL_ATON_EpochBlockItems_Default(), without the last one."""
+    m = re.search(r"LL_ATON_EpochBlockItems_Default\(void\)(.*?)\n\}", source, re.S)
+    if not m:
+        return []
+    blocks = []
+    for entry in re.findall(r"\{(.*?)\n    \}", m.group(1), re.S):
+        if "EpochBlock_Flags_last_eb" in entry:
+            continue
+        first = re.search(r"\.epoch_num = (\d+)", entry)
+        last = re.search(r"\.last_epoch_num = (\d+)", entry)
+        if not first:
+            sys.exit("Epoch numbers missing from the epoch blocks (LL_ATON_EB_DBG_INFO)")
+        blocks.append({"first": int(first.group(1)), "last": int(last.group(1)) if last else int(first.group(1)),
+                       "blob": "EpochBlock_Flags_blob" in entry, "sw": "EpochBlock_Flags_pure_sw" in entry})
+    return blocks
+
+
+def operator_number(name):
+    m = re.match(r"\w+?_(\d+)", name)
+    return int(m.group(1)) if m else None
+
+
+def merge(ranges):
+    """Merges the touching ranges of a list already ordered, joining their names."""
+    merged = []
+    for r in ranges:
+        if merged and merged[-1]["base"] == r["base"] and merged[-1]["end"] == r["start"]:
+            merged[-1]["end"] = r["end"]
+            merged[-1]["names"] += r["names"]
+        else:
+            merged.append(dict(r, names=list(r["names"])))
+    return merged
+
+
+def merge_overlapping(ranges):
+    """Merges the overlapping or touching ranges of a list, in address order."""
+    merged = []
+    for r in sorted(ranges, key=lambda r: (r["base"], r["start"], r["end"])):
+        if merged and merged[-1]["base"] == r["base"] and r["start"] <= merged[-1]["end"]:
+            merged[-1]["end"] = max(merged[-1]["end"], r["end"])
+            merged[-1]["names"] += [n for n in r["names"] if n not in merged[-1]["names"]]
+        else:
+            merged.append(dict(r, names=list(r["names"])))
+    return merged
+
+
+def tensor_name(buffers, field, epoch, is_output):
+    """Buffer of the buffer infos a tensor of a SW node is, produced at its epoch or before."""
+    candidates = [b for b in buffers if not b["param"] and b["base"] == field["base"] and b["start"] == field["start"]
+                  and (b["epoch"] == epoch if is_output else b["epoch"] < epoch)]
+    if not candidates:
+        return None
+    return max(candidates, key=lambda b: b["epoch"])["name"]
+
+
+def sw_ranges(buffers, sw, epoch):
+    fields = sw["fields"]
+    reads, writes = [], []
+    if "general.input" in fields:
+        name = tensor_name(buffers, fields["general.input"], epoch, False)
+        reads.append(dict(fields["general.input"], names=[name] if name else []))
+    params = [fields[f] for f in SW_PARAMS + SW_QUANT_PARAMS if f in fields]
+    if params:
+        names = [f for f in SW_PARAMS if f in fields]
+        if any(f in fields for f in SW_QUANT_PARAMS):
+            names.append("quantization")
+        reads.append({"base": params[0]["base"], "start": min(p["start"] for p in params),
+                      "end": max(p["end"] for p in params), "names": [", ".join(names)]})
+    if "general.output" in fields:
+        name = tensor_name(buffers, fields["general.output"], epoch, True)
+        writes.append(dict(fields["general.output"], names=[name] if name else []))
+    return reads, writes
+
+
+def generate(source):
+    buffers = read_buffers(source)
+    sw_nodes = read_sw_nodes(source)
+    blocks = read_epoch_blocks(source)
+    inputs = re.search(r"LL_ATON_Input_Buffers_Info_Default\(void\)(.*?)\n\}", source, re.S)
+    inputs = read_buffers(inputs.group(1)) if inputs else []
+    # Weights, scales and biases: the quantization parameters of the tensors (atonn_internal) are read by SW nodes
+    conv_params = [b for b in buffers
+                   if b["param"] and b["name"].startswith("Conv2D_") and "_atonn_internal_" not in b["name"]]
+
+    out = []
+    entries = []
+    previous_writes = [dict(b, names=[b["name"]]) for b in inputs if not b["param"]]
+    for i, eb in enumerate(blocks):
+        if eb["sw"]:
+            sw = sw_nodes.get(eb["first"])
+            if sw is None or eb["first"] != eb["last"]:
+                sys.exit("Epoch block %d: pure SW epoch block without a single SW node" % i)
+            out.append("/* Epoch %d: %s */" % (eb["first"], sw["node"]))
+            reads, writes = sw_ranges(buffers, sw, eb["first"])
+            flags = "EB_SW_COMPLETE"
+        else:
+            out.append("/* Epoch blob %d (epochs %d to %d) */" % (eb["first"], eb["first"], eb["last"]))
+            # Parameters of the operators between the SW nodes around the blob
+            low = max([operator_number(sw_nodes[b["first"]]["node"]) for b in blocks[:i] if b["sw"]] or [-1])
+            high = min([operator_number(sw_nodes[b["first"]]["node"]) for b in blocks[i + 1:] if b["sw"]]
+                       or [float("inf")])
+            params = sorted((b for b in conv_params if low < operator_number(b["name"]) < high),
+                            key=lambda b: (operator_number(b["name"]), b["start"]))
+            reads = previous_writes + merge([dict(b, names=[b["name"]]) for b in params])
+            writes = merge_overlapping([dict(b, names=[b["name"]]) for b in buffers
+                                        if not b["param"] and eb["first"] <= b["epoch"] <= eb["last"]])
+            flags = "EpochBlock_Deps_NONE"
+        for kind, ranges in (("reads", reads), ("writes", writes)):
+            out.append("static const EpochBlock_MemRangeTypeDef eb%d_%s[] = {" % (i, kind))
+            for r in ranges:
+                line = "  EB_RANGE(0x%08xUL, %d, %d)," % (r["base"], r["start"], r["end"])
+                if r["names"] and len(r["names"]) <= MAX_NAMES:
+                    line = line.ljust(COMMENT_COLUMN) + "/* %s */" % ", ".join(r["names"])
+                out.append(line)
+            out.append("};")
+        out.append("")
+        entries.append("    EB_DEPS(eb%d_reads, eb%d_writes, %s)," % (i, i, flags))
+        previous_writes = writes if eb["sw"] else []
+
+    return HEADER + "\n".join(out) + "\n" + FOOTER % "\n".join(entries)
+
+
+HEADER = """/**
+  ******************************************************************************
+  * @file    network_eb_deps.c
+  * @brief   Buffer dependencies of the epoch blocks of network.c (`LL_ATON_EpochBlockItems_Default()`)
+  ******************************************************************************
+  * Generated from network.c by Tools/gen_eb_deps.py, do not edit.
+  *
+  * Pure SW epoch blocks list every range they access, taken from their `*_sw_info`
+  * (tensors and quantization parameters). Epoch blob programs are not decoded:
+  * their writes are the buffers of their epochs in the buffer infos (`.epoch`),
+  * their reads only the tensors known to be consumed, so they are partial.
+  * The reads of a blob also list the parameter buffers of its convolutions, in
+  * the order of the operators (their `.epoch` is 0 in the buffer infos: they
+  * are assigned by operator number between the SW epochs). The weight prefetch
+  * warms the first ones.
+  ******************************************************************************
+  */
+
+#include "ll_aton_NN_interface.h"
+#include "ll_aton_platform.h"
+
+#define EB_RANGE(base, start, end)                                                                                     \\
+  { ATON_LIB_PHYSICAL_TO_VIRTUAL_ADDR((uintptr_t)(base) + (start)),                                                    \\
+    ATON_LIB_PHYSICAL_TO_VIRTUAL_ADDR((uintptr_t)(base) + (end)) }
+
+#define EB_DEPS(r, w, f)                                                                                               \\
+  { .reads = (r), .writes = (w), .nr_reads = sizeof(r) / sizeof((r)[0]), .nr_writes = sizeof(w) / sizeof((w)[0]),    \\
+    .flags = (f) }
+
+#define EB_SW_COMPLETE (EpochBlock_Deps_complete_reads | EpochBlock_Deps_complete_writes)
+
+"""
+
+FOOTER = """const EpochBlock_DepsTypeDef *LL_ATON_EpochBlockDeps_Default(void)
+{
+  static const EpochBlock_DepsTypeDef ll_aton_eb_deps_array[] = {
+%s
+    { 0 }, /* last (empty) epoch block */
+  };
+
+  return ll_aton_eb_deps_array;
+}
+"""
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("network", help="generated network.c")
+    parser.add_argument("-o", "--output", help="C file written, stdout if omitted")
+    args = parser.parse_args()
+
+    with open(args.network, encoding="utf-8", errors="replace") as f:
+        table = generate(f.read())
+    if args.output:
+        with open(args.output, "w", encoding="utf-8") as f:
+            f.write(table)
+    else:
+        sys.stdout.write(table)
+
+
+if __name__ == "__main__":
+    main()
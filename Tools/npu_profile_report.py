@@ -0,0 +1,180 @@
+#!/usr/bin/env python3
+"""Per epoch block NPU performance report.
+
+Reads the "npu," CSV lines sent on the ST-LINK virtual COM port by the
+application built with NPU_PROFILER_RUNS (see
+Application/STM32N6570-DK/Inc/npu_profiler.h), then prints a timeline of the
+epoch blocks of an inference and a summary of what bounds each of them.
+
+  python3 Tools/npu_profile_report.py capture.log \
+      --network Model/STM32N6570-DK/network.c --npu-mhz 1000
+
+The capture can be any log of the port (e.g. saved from a terminal); the other
+lines are ignored. With --network, the blocks are named after the epochs and
+the nodes of the generated network.
+"""
+
+import argparse
+import re
+import sys
+
+BURST_LENGTHS = (1, 2, 4, 8)
+# Heuristic thresholds of the bottleneck classification
+MEMORY_BOUND_BYTES_PER_CYCLE = 4.0
+STREAM_BOUND_UTILIZATION = 0.8
+
+
+def read_profile(lines):
+    """Returns the blocks of the last complete report found, as dicts."""
+    header = None
+    blocks = []
+    for line in lines:
+        line = line.strip()
+        start = line.find("npu,")
+        if start < 0:
+            continue
+        fields = line[start:].split(",")[1:]
+        if fields and fields[0] == "eb":
+            header = fields
+            blocks = []
+            continue
+        if header is None or len(fields) != len(header):
+            continue
+        block = {}
+        for name, value in zip(header, fields):
+            block[name] = value if name == "kind" else int(value)
+        blocks.append(block)
+    return blocks
+
+
+def read_network(path):
+    """Returns the description of each epoch block of the generated network.c."""
+    with open(path, encoding="utf-8", errors="replace") as f:
+        source = f.read()
+
+    # Nodes run by the epochs, from the comments of the generated code
+    nodes = {}
+    epoch = None
+    for line in source.splitlines():
+        m = re.match(r"/\* scheduling epoch=(\d+)", line)
+        if m:
+            epoch = int(m.group(1))
+            continue
+        m = re.match(r"/\* kind=(\S+) node=(\S+) \*/", line)
+        if m and epoch is not None:
+            nodes.setdefault(epoch, []).append("%s(%s)" % (m.group(2), m.group(1)))
+
+    m = re.search(r"LL_ATON_EpochBlockItems_Default\(void\)(.*?)\n\}", source, re.S)
+    if not m:
+        return []
+    items = []
+    for entry in re.findall(r"\{(.*?)\n    \}", m.group(1), re.S):
+        first = re.search(r"\.epoch_num = (\d+)", entry)
+        last = re.search(r"\.last_epoch_num = (\d+)", entry)
+        blob = re.search(r"\.blob_address = \(uintptr_t\)\((\w+)\)", entry)
+        if "EpochBlock_Flags_last_eb" in entry or not first:
+            continue
+        first = int(first.group(1))
+        last = int(last.group(1)) if last else first
+        names = []
+        for e in range(first, last + 1):
+            names += nodes.get(e, [])
+        if blob:
+            names.insert(0, blob.group(1))
+        epochs = "%d" % first if first == last else "%d-%d" % (first, last)
+        items.append({"epochs": epochs, "nodes": names})
+    return items
+
+
+def bytes_per_cycle(block):
+    if not block["npu_cycles"]:
+        return 0.0
+    return (block["rd_bytes"] + block["wr_bytes"]) / block["npu_cycles"]
+
+
+def streng_utilization(block):
+    """Highest fraction of the NPU cycles a stream engine is active, and which."""
+    if not block["npu_cycles"]:
+        return 0.0, "-"
+    best, name = 0.0, "-"
+    for key, value in block.items():
+        if re.match(r"(in|out)\d+$", key) and value / block["npu_cycles"] > best:
+            best, name = value / block["npu_cycles"], key
+    return best, name
+
+
+def classify(block):
+    if block["kind"] == "sw":
+        return "cpu"
+    utilization, _ = streng_utilization(block)
+    if bytes_per_cycle(block) >= MEMORY_BOUND_BYTES_PER_CYCLE:
+        return "memory-bound"
+    if utilization >= STREAM_BOUND_UTILIZATION:
+        return "stream-bound"
+    return "compute"
+
+
+def mean_burst(block, direction):
+    bursts = [block["%s_b%d" % (direction, n)] for n in BURST_LENGTHS]
+    if not sum(bursts):
+        return 0.0
+    return sum(n * b for n, b in zip(BURST_LENGTHS, bursts)) / sum(bursts)
+
+
+def print_timeline(blocks, width):
+    end = max(b["start_us"] + b["avg_us"] for b in blocks) or 1
+    print("Timeline of an inference, %d us" % end)
+    for b in blocks:
+        first = b["start_us"] * width // end
+        length = max(1, b["avg_us"] * width // end)
+        bar = " " * first + ("#" if b["kind"] != "sw" else "=") * length
+        print("%3d %-6s |%-*s| %7d us" % (b["eb"], b["kind"], width, bar[:width], b["avg_us"]))
+    print("    # NPU   = CPU")
+    print()
+
+
+def print_summary(blocks, network, npu_mhz):
+    total = sum(b["avg_us"] for b in blocks) or 1
+    print("%3s %-6s %-9s %8s %6s %8s %8s %6s %6s %-10s %-13s %s" % (
+        "eb", "kind", "epochs", "avg_us", "time%", "rd_kB", "wr_kB", "B/cyc", "burst",
+        "streng", "bound", "nodes"))
+    for b in sorted(blocks, key=lambda b: b["avg_us"], reverse=True):
+        info = network[b["eb"]] if b["eb"] < len(network) else {"epochs": "?", "nodes": []}
+        utilization, streng = streng_utilization(b)
+        streng = "%s %3d%%" % (streng, utilization * 100) if b["npu_cycles"] else "-"
+        nodes = " ".join(info["nodes"][:3]) + (" ..." if len(info["nodes"]) > 3 else "")
+        print("%3d %-6s %-9s %8d %5.1f%% %8.1f %8.1f %6.2f %6.2f %-10s %-13s %s" % (
+            b["eb"], b["kind"], info["epochs"], b["avg_us"], 100.0 * b["avg_us"] / total,
+            b["rd_bytes"] / 1024, b["wr_bytes"] / 1024, bytes_per_cycle(b),
+            mean_burst(b, "rd"), streng, classify(b), nodes))
+    if npu_mhz:
+        print()
+        print("NPU busy (cycles / time at %d MHz):" % npu_mhz)
+        for b in blocks:
+            if b["kind"] != "sw" and b["avg_us"]:
+                print("%3d %5.1f%%" % (b["eb"], 100.0 * b["npu_cycles"] / (b["avg_us"] * npu_mhz)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture", nargs="?", help="virtual COM port log, stdin if omitted")
+    parser.add_argument("--network", help="generated network.c, to name the epoch blocks")
+    parser.add_argument("--npu-mhz", type=int, default=0, help="NPU clock, to report how busy the NPU is")
+    parser.add_argument("--width", type=int, default=60, help="timeline width in characters")
+    args = parser.parse_args()
+
+    if args.capture:
+        with open(args.capture, encoding="utf-8", errors="replace") as f:
+            blocks = read_profile(f)
+    else:
+        blocks = read_profile(sys.stdin)
+    if not blocks:
+        sys.exit("No NPU profile found (lines starting with 'npu,')")
+    network = read_network(args.network) if args.network else []
+
+    print_timeline(blocks, args.width)
+    print_summary(blocks, network, args.npu_mhz)
+
+
+if __name__ == "__main__":
+    main()